@@ -3,28 +3,63 @@
 // SPDX-License-Identifier: Apache-2.0
 
 'use strict';
-var internalIO = require('../internalIO/build/Release/internalIO');
-var SctpIn = internalIO.SctpIn;
-var SctpOut = internalIO.SctpOut;
-var InternalIn = internalIO.In;
-var InternalOut = internalIO.Out;
-
 var logger = require('../logger').logger;
 // Logger
 var log = logger.getLogger('InternalConnectionFactory');
 
+// Addon dlopen+init dominates workingNode spawn time, so internalIO (and
+// quicIO where deployed) load on the first connection instead of at require
+// time; agents preload them right after reporting READY (see the warmup
+// hooks in the index files), off the spawn path.
+var SctpIn, SctpOut, InternalIn, InternalOut, MuxIn, MuxOut;
 var quicIO;
-try {
-    quicIO = require('../quicIO/build/Release/quicIO.node');
-} catch (e) {
-    log.info('QUIC is not enabled for internal IO');
+var addonsLoaded = false;
+function loadAddons() {
+    if (addonsLoaded)
+        return;
+    addonsLoaded = true;
+
+    var internalIO = require('../internalIO/build/Release/internalIO');
+    SctpIn = internalIO.SctpIn;
+    SctpOut = internalIO.SctpOut;
+    InternalIn = internalIO.In;
+    InternalOut = internalIO.Out;
+    MuxIn = internalIO.MuxIn;
+    MuxOut = internalIO.MuxOut;
+
+    try {
+        quicIO = require('../quicIO/build/Release/quicIO.node');
+    } catch (e) {
+        log.info('QUIC is not enabled for internal IO');
+    }
 }
 
 var cf = 'leaf_cert.pem';
 var kf = 'leaf_cert.pkcs8';
 
+var os = require('os');
+
+// Destinations on this host take the shared-memory fast path; InternalOut
+// falls back to TCP by itself if the receiver offers no segment.
+function isLocalIp(ip) {
+    if (!ip || ip === 'localhost' || ip.indexOf('127.') === 0 || ip === '::1') {
+        return true;
+    }
+    var interfaces = os.networkInterfaces();
+    for (var name in interfaces) {
+        for (var i in interfaces[name]) {
+            if (interfaces[name][i].address === ip) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // Wrapper object for sctp-connection and tcp/udp-connection
 function InConnection(prot, minport, maxport) {
+    loadAddons();
+
     var conn = null;
     var protocol = "quic";
 
@@ -37,6 +72,10 @@ function InConnection(prot, minport, maxport) {
         case 'quic':
             conn = new quicIO.in(cf, kf);
             break;
+        case 'mux':
+            protocol = prot;
+            conn = new MuxIn();
+            break;
         default:
             prot = "sctp";
             conn = new SctpIn();
@@ -64,6 +103,8 @@ function InConnection(prot, minport, maxport) {
 
 // Wrapper object for sctp-connection and tcp/udp-connection
 function OutConnection(prot, minport, maxport) {
+    loadAddons();
+
     var that = {};
     var conn = null;
     var protocol = "quic";
@@ -72,6 +113,7 @@ function OutConnection(prot, minport, maxport) {
         case 'tcp':
         case 'udp':
         case 'quic':
+        case 'mux':
             protocol = prot;
             break;
         default:
@@ -94,9 +136,14 @@ function OutConnection(prot, minport, maxport) {
         if (protocol === "sctp") {
             conn.connect(connectOpt.ip, connectOpt.port.udp, connectOpt.port.sctp);
         } else if (protocol === 'quic') {
-            conn = new quicIO.out(connectOpt.ip, connectOpt.port);
+            // Audio rides datagram-like delivery unless the stream opts out.
+            conn = new quicIO.out(connectOpt.ip, connectOpt.port, connectOpt.audioDatagrams !== false);
+        } else if (protocol === 'mux') {
+            // connectOpt.port carries the compound {mux, stream} info the
+            // receiver returned from getListeningPort.
+            conn = new MuxOut(connectOpt.ip, connectOpt.port.mux, connectOpt.port.stream);
         } else {
-            conn = new InternalOut(protocol, connectOpt.ip, connectOpt.port);
+            conn = new InternalOut(isLocalIp(connectOpt.ip) ? 'shm' : protocol, connectOpt.ip, connectOpt.port);
         }
     };
 
@@ -116,8 +163,50 @@ function OutConnection(prot, minport, maxport) {
 
 module.exports = function() {
     var preparedSet = {};
+    // Spare connections bound ahead of need, keyed by direction plus the
+    // creation arguments. Binding the listening socket is the only
+    // per-connection cost that can be paid before a session asks for it.
+    var warmPool = {};
+    var warmDepth = 0;
     var that = {};
 
+    var warmKey = function (direction, prot, minport, maxport) {
+        return direction + '/' + prot + ':' + minport + ':' + maxport;
+    };
+
+    var makeConnection = function (direction, prot, minport, maxport) {
+        return (direction === 'in') ? InConnection(prot, minport, maxport) : OutConnection(prot, minport, maxport);
+    };
+
+    var fillPool = function (key, direction, prot, minport, maxport) {
+        warmPool[key] = warmPool[key] || [];
+        while (warmPool[key].length < warmDepth) {
+            warmPool[key].push(makeConnection(direction, prot, minport, maxport));
+        }
+    };
+
+    // Keep up to `depth` pre-bound spares per direction, so the
+    // createInternalConnection RPC during subscribe returns an
+    // already-listening port instead of paying the bind on the session's
+    // critical path. quic and mux connect per node pair at fetch time and
+    // gain nothing from spares. A room running a different protocol than
+    // the warmed one takes the cold path once; the pool re-fills for
+    // whatever create() actually gets asked for.
+    that.prewarm = function (internalOpt, depth) {
+        var prot = internalOpt.protocol;
+        var minport = internalOpt.minport || 0;
+        var maxport = internalOpt.maxport || 0;
+
+        if (prot === 'quic' || prot === 'mux') {
+            return;
+        }
+
+        warmDepth = depth;
+        ['in', 'out'].forEach(function (direction) {
+            fillPool(warmKey(direction, prot, minport, maxport), direction, prot, minport, maxport);
+        });
+    };
+
     // Create the connection and return the port info
     that.create = function (connId, direction, internalOpt) {
         // Get internal connection's arguments
@@ -132,7 +221,20 @@ module.exports = function() {
             // right call sequence in upper layer.
             return preparedSet[connId].connection.getListeningPort();
         }
-        var conn = (direction === 'in')? InConnection(prot, minport, maxport) : OutConnection(prot, minport, maxport);
+
+        var key = warmKey(direction, prot, minport, maxport);
+        var conn;
+        if (warmPool[key] && warmPool[key].length > 0) {
+            conn = warmPool[key].shift();
+        } else {
+            conn = makeConnection(direction, prot, minport, maxport);
+        }
+        // Top the pool back up off the critical path.
+        if (warmDepth > 0 && prot !== 'quic' && prot !== 'mux') {
+            setImmediate(function () {
+                fillPool(key, direction, prot, minport, maxport);
+            });
+        }
 
         preparedSet[connId] = {connection: conn, direction: direction};
         return conn.getListeningPort();
@@ -169,3 +271,7 @@ module.exports = function() {
 
     return that;
 };
+
+// Pull the addon load cost off the first session's path; safe to call any
+// time after spawn.
+module.exports.preload = loadAddons;
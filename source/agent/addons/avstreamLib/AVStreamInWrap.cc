@@ -62,6 +62,7 @@ void AVStreamInWrap::New(const FunctionCallbackInfo<Value>& args)
     Local<String> keyUrl = String::NewFromUtf8(isolate, "url");
     Local<String> keyTransport = String::NewFromUtf8(isolate, "transport");
     Local<String> keyBufferSize = String::NewFromUtf8(isolate, "buffer_size");
+    Local<String> keyOpenTimeout = String::NewFromUtf8(isolate, "open_timeout");
     Local<String> keyAudio = String::NewFromUtf8(isolate, "has_audio");
     Local<String> keyVideo = String::NewFromUtf8(isolate, "has_video");
     owt_base::LiveStreamIn::Options param{};
@@ -72,6 +73,8 @@ void AVStreamInWrap::New(const FunctionCallbackInfo<Value>& args)
         param.transport = std::string(*String::Utf8Value(options->Get(keyTransport)->ToString()));
     if (options->Has(keyBufferSize))
         param.bufferSize = options->Get(keyBufferSize)->Uint32Value();
+    if (options->Has(keyOpenTimeout))
+        param.openTimeoutMs = options->Get(keyOpenTimeout)->Uint32Value();
     if (options->Has(keyAudio))
         param.enableAudio = std::string(*String::Utf8Value(options->Get(keyAudio)->ToString()));
     if (options->Has(keyVideo))
@@ -84,6 +84,8 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
             format = owt_base::LiveStreamOut::STREAMING_FORMAT_HLS;
         } else if (protocol.compare("dash") == 0) {
             format = owt_base::LiveStreamOut::STREAMING_FORMAT_DASH;
+        } else if (protocol.compare("srt") == 0) {
+            format = owt_base::LiveStreamOut::STREAMING_FORMAT_SRT;
         } else {
             isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "Unsupported AVStreamOut type")));
             return;
@@ -107,6 +109,12 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
 
             strncpy(opts.dash_method, std::string(*String::Utf8Value(parameters->Get(String::NewFromUtf8(isolate, "method"))->ToString())).c_str(), sizeof(opts.dash_method) - 1);
             opts.dash_method[sizeof(opts.dash_method) - 1] = '\0';
+        } else if (protocol.compare("srt") == 0) {
+            opts.srt_latency = 0;
+            Local<Value> parametersVal = connection->Get(String::NewFromUtf8(isolate, "parameters"));
+            if (parametersVal->IsObject()) {
+                opts.srt_latency = parametersVal->ToObject()->Get(String::NewFromUtf8(isolate, "srtLatency"))->Int32Value();
+            }
         }
 
         obj->me = new owt_base::LiveStreamOut(url, requireAudio, requireVideo, obj, initializeTimeout, opts);
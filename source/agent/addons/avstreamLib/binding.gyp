@@ -7,6 +7,9 @@
       'AVStreamOutWrap.cc',
       '../../addons/common/NodeEventRegistry.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/PayloadBufferPool.cpp',
+      '../../../core/owt_base/MemoryBudget.cpp',
+      '../../../core/owt_base/IOServicePool.cpp',
       '../../../core/owt_base/AVStreamOut.cpp',
       '../../../core/owt_base/MediaFileOut.cpp',
       '../../../core/owt_base/LiveStreamOut.cpp',
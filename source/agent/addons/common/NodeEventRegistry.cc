@@ -3,10 +3,65 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "NodeEventRegistry.h"
+#include <algorithm>
 #include <list>
 
 using namespace v8;
 
+NodeEventRegistry::SharedAsyncChannel* NodeEventRegistry::SharedAsyncChannel::instance()
+{
+    static SharedAsyncChannel* channel = new SharedAsyncChannel();
+    return channel;
+}
+
+NodeEventRegistry::SharedAsyncChannel::SharedAsyncChannel()
+{
+    m_handle.data = this;
+    uv_async_init(uv_default_loop(), &m_handle, callback);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&m_handle));
+}
+
+void NodeEventRegistry::SharedAsyncChannel::schedule(NodeEventRegistry* registry)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (registry->m_scheduled)
+            return; // uv_async_send for the earlier event covers this one.
+        registry->m_scheduled = true;
+        m_pending.push_back(registry);
+    }
+    uv_async_send(&m_handle);
+}
+
+void NodeEventRegistry::SharedAsyncChannel::remove(NodeEventRegistry* registry)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (registry->m_scheduled) {
+        m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), registry),
+            m_pending.end());
+        registry->m_scheduled = false;
+    }
+}
+
+void NodeEventRegistry::SharedAsyncChannel::callback(uv_async_t* handle)
+{
+    if (handle && handle->data)
+        reinterpret_cast<SharedAsyncChannel*>(handle->data)->drain();
+}
+
+void NodeEventRegistry::SharedAsyncChannel::drain()
+{
+    std::vector<NodeEventRegistry*> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        pending.swap(m_pending);
+        for (size_t i = 0; i < pending.size(); ++i)
+            pending[i]->m_scheduled = false;
+    }
+    for (size_t i = 0; i < pending.size(); ++i)
+        pending[i]->process();
+}
+
 NodeEventRegistry* NodeEventRegistry::New(Isolate* isolate, const Local<Function>& f)
 {
     return (new NodeEventRegistry(isolate, f));
@@ -19,34 +74,24 @@ NodeEventRegistry* NodeEventRegistry::New(const Local<Function>& f)
 
 NodeEventRegistry::NodeEventRegistry()
     : m_store{ Isolate::GetCurrent(), Object::New(Isolate::GetCurrent()) }
-    , m_uvHandle{ reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t))) }
+    , m_channel{ SharedAsyncChannel::instance() }
+    , m_scheduled{ false }
 {
-    if (m_uvHandle) {
-        m_uvHandle->data = this;
-        m_uvHandle->close_cb = closeCallback;
-        uv_async_init(uv_default_loop(), m_uvHandle, callback);
-    }
 }
 
 NodeEventRegistry::NodeEventRegistry(Isolate* isolate, const Local<Function>& f)
     : m_store{ Isolate::GetCurrent(), f }
-    , m_uvHandle{ reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t))) }
+    , m_channel{ SharedAsyncChannel::instance() }
+    , m_scheduled{ false }
 {
-    if (m_uvHandle) {
-        m_uvHandle->data = this;
-        m_uvHandle->close_cb = closeCallback;
-        uv_async_init(uv_default_loop(), m_uvHandle, callback);
-    }
 }
 
 NodeEventRegistry::~NodeEventRegistry()
 {
+    // Drop any pending drain reference before the buffer goes away.
+    m_channel->remove(this);
     std::lock_guard<std::mutex> lock(m_lock);
     m_store.Reset();
-    if (m_uvHandle && !uv_is_closing(reinterpret_cast<uv_handle_t*>(m_uvHandle)))
-        uv_close(reinterpret_cast<uv_handle_t*>(m_uvHandle), closeCallback);
-    if (m_uvHandle)
-        m_uvHandle->data = nullptr;
 }
 
 void NodeEventRegistry::process(const Data& data)
@@ -107,44 +152,23 @@ void NodeEventRegistry::process()
 // other thread
 bool NodeEventRegistry::notifyAsyncEvent(const std::string& event, const std::string& data)
 {
-    if (m_uvHandle && uv_is_active(reinterpret_cast<uv_handle_t*>(m_uvHandle))) {
-        {
-            std::lock_guard<std::mutex> lock(m_lock);
-            m_buffer.push_back(Data{ event, data });
-        }
-        uv_async_send(m_uvHandle);
-        return true;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_buffer.push_back(Data{ event, data });
     }
-    return false;
+    m_channel->schedule(this);
+    return true;
 }
 
 // other thread
 bool NodeEventRegistry::notifyAsyncEventInEmergency(const std::string& event, const std::string& data)
 {
-    if (m_uvHandle && uv_is_active(reinterpret_cast<uv_handle_t*>(m_uvHandle))) {
-        {
-            std::lock_guard<std::mutex> lock(m_lock);
-            m_buffer.push_front(Data{ event, data });
-        }
-        uv_async_send(m_uvHandle);
-        return true;
-    }
-    return false;
-}
-
-void NodeEventRegistry::closeCallback(uv_handle_t* handle)
-{
-    free(handle);
-    handle = nullptr;
-}
-
-void NodeEventRegistry::callback(uv_async_t* handle)
-{
-    if (handle && uv_is_active(reinterpret_cast<uv_handle_t*>(handle)) && handle->data) {
-        NodeEventRegistry* registry = reinterpret_cast<NodeEventRegistry*>(handle->data);
-        if (registry)
-            registry->process();
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_buffer.push_front(Data{ event, data });
     }
+    m_channel->schedule(this);
+    return true;
 }
 
 NodeEventedObjectWrap::NodeEventedObjectWrap()
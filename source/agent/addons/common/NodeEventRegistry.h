@@ -13,6 +13,7 @@
 #include <queue>
 #include <string>
 #include <uv.h>
+#include <vector>
 
 // Implement ::EventRegistry interface
 class NodeEventRegistry : public ::EventRegistry {
@@ -34,13 +35,38 @@ protected:
     v8::Persistent<v8::Object> m_store;
 
 private:
-    uv_async_t* m_uvHandle;
+    // One uv_async shared by every registry in the process. Each instance
+    // keeps its own event buffer; the channel just remembers which instances
+    // have something pending and drains them all in one loop wakeup, so an
+    // event burst spread over many wrapper instances costs one wakeup per
+    // loop iteration instead of one per instance.
+    class SharedAsyncChannel {
+    public:
+        // Must first be called on the loop thread; registry constructors
+        // (which run on the JS thread) guarantee that.
+        static SharedAsyncChannel* instance();
+
+        void schedule(NodeEventRegistry*);
+        void remove(NodeEventRegistry*);
+
+    private:
+        SharedAsyncChannel();
+        static void callback(uv_async_t*);
+        void drain();
+
+        // Lives for the process lifetime; unreferenced so it does not keep
+        // the loop running on its own.
+        uv_async_t m_handle;
+        std::mutex m_lock;
+        std::vector<NodeEventRegistry*> m_pending;
+    };
+
+    SharedAsyncChannel* m_channel;
+    bool m_scheduled; // guarded by the channel lock
     std::mutex m_lock;
     std::deque<Data> m_buffer;
     void process();
     void process(const Data& data);
-    static void closeCallback(uv_handle_t*);
-    static void callback(uv_async_t*);
 };
 
 class NodeEventedObjectWrap : public node::ObjectWrap, public NodeEventRegistry {
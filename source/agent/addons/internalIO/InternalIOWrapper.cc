@@ -31,6 +31,7 @@ void SctpIn::Init(v8::Local<v8::Object> exports) {
   // Prototype
   NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
   NODE_SET_PROTOTYPE_METHOD(tpl, "getListeningPort", getListeningPort);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
   NODE_SET_PROTOTYPE_METHOD(tpl, "connect", connect);
 
   NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
@@ -87,6 +88,24 @@ void SctpIn::getListeningPort(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(portInfo);
 }
 
+void SctpIn::getStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  SctpIn* obj = ObjectWrap::Unwrap<SctpIn>(args.This());
+  owt_base::InternalSctp* me = obj->me;
+
+  if (!me) {
+    // Skip when function close has been called
+    ELOG_WARN("Connection has been closed.");
+    return;
+  }
+
+  std::string stats = me->getStats();
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
+
 void SctpIn::connect(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -181,6 +200,7 @@ void SctpOut::Init(v8::Local<v8::Object> exports) {
   // Prototype
   NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
   NODE_SET_PROTOTYPE_METHOD(tpl, "getListeningPort", getListeningPort);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
   NODE_SET_PROTOTYPE_METHOD(tpl, "connect", connect);
 
 
@@ -235,6 +255,24 @@ void SctpOut::getListeningPort(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(portInfo);
 }
 
+void SctpOut::getStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  SctpOut* obj = ObjectWrap::Unwrap<SctpOut>(args.This());
+  owt_base::InternalSctp* me = obj->me;
+
+  if (!me) {
+    // Skip when function close has been called
+    ELOG_WARN("Connection has been closed.");
+    return;
+  }
+
+  std::string stats = me->getStats();
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
+
 void SctpOut::connect(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
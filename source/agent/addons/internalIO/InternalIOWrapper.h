@@ -32,6 +32,7 @@ private:
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void getListeningPort(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void connect(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -54,6 +55,7 @@ private:
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void getListeningPort(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void connect(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
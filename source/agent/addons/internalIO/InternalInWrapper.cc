@@ -23,6 +23,7 @@ void InternalIn::Init(v8::Local<v8::Object> exports) {
   // Prototype
   NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
   NODE_SET_PROTOTYPE_METHOD(tpl, "getListeningPort", getListeningPort);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
 
@@ -71,6 +72,18 @@ void InternalIn::getListeningPort(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(Number::New(isolate, port));
 }
 
+void InternalIn::getStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  InternalIn* obj = ObjectWrap::Unwrap<InternalIn>(args.This());
+  owt_base::InternalIn* me = obj->me;
+
+  std::string stats = me->getStats();
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
+
 void InternalIn::addDestination(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
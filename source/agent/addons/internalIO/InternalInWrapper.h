@@ -28,6 +28,7 @@ class InternalIn : public FrameSource {
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void getListeningPort(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void removeDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
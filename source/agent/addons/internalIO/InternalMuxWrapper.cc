@@ -0,0 +1,150 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BUILDING_NODE_EXTENSION
+#define BUILDING_NODE_EXTENSION
+#endif
+
+#include "InternalMuxWrapper.h"
+
+using namespace v8;
+
+Persistent<Function> MuxIn::constructor;
+MuxIn::MuxIn() {};
+MuxIn::~MuxIn() {};
+
+void MuxIn::Init(v8::Local<v8::Object> exports) {
+  Isolate* isolate = Isolate::GetCurrent();
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+  tpl->SetClassName(String::NewFromUtf8(isolate, "MuxIn"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  // Prototype
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getListeningPort", getListeningPort);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
+
+  constructor.Reset(isolate, tpl->GetFunction());
+  exports->Set(String::NewFromUtf8(isolate, "MuxIn"), tpl->GetFunction());
+}
+
+void MuxIn::New(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  MuxIn* obj = new MuxIn();
+  obj->me = new owt_base::InternalMuxIn();
+  obj->src = obj->me;
+
+  obj->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+void MuxIn::close(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  MuxIn* obj = ObjectWrap::Unwrap<MuxIn>(args.Holder());
+  owt_base::InternalMuxIn* me = obj->me;
+  delete me;
+}
+
+void MuxIn::getListeningPort(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  MuxIn* obj = ObjectWrap::Unwrap<MuxIn>(args.This());
+  owt_base::InternalMuxIn* me = obj->me;
+
+  // The peer needs both the node-wide mux port and the stream id; they
+  // travel through the signaling as a compound port, like SCTP's udp/sctp
+  // pair.
+  Local<Object> portInfo = Object::New(isolate);
+  portInfo->Set(String::NewFromUtf8(isolate, "mux"), Number::New(isolate, me->getListeningPort()));
+  portInfo->Set(String::NewFromUtf8(isolate, "stream"), Number::New(isolate, me->getStreamId()));
+
+  args.GetReturnValue().Set(portInfo);
+}
+
+void MuxIn::addDestination(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  MuxIn* obj = ObjectWrap::Unwrap<MuxIn>(args.Holder());
+  owt_base::InternalMuxIn* me = obj->me;
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string track = std::string(*param0);
+
+  FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject());
+  owt_base::FrameDestination* dest = param->dest;
+
+  if (track == "audio") {
+    me->addAudioDestination(dest);
+  } else if (track == "video") {
+    me->addVideoDestination(dest);
+  }
+}
+
+void MuxIn::removeDestination(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  MuxIn* obj = ObjectWrap::Unwrap<MuxIn>(args.Holder());
+  owt_base::InternalMuxIn* me = obj->me;
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string track = std::string(*param0);
+
+  FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject());
+  owt_base::FrameDestination* dest = param->dest;
+
+  if (track == "audio") {
+    me->removeAudioDestination(dest);
+  } else if (track == "video") {
+    me->removeVideoDestination(dest);
+  }
+}
+
+Persistent<Function> MuxOut::constructor;
+MuxOut::MuxOut() {};
+MuxOut::~MuxOut() {};
+
+void MuxOut::Init(v8::Local<v8::Object> exports) {
+  Isolate* isolate = Isolate::GetCurrent();
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+  tpl->SetClassName(String::NewFromUtf8(isolate, "MuxOut"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  // Prototype
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+
+  constructor.Reset(isolate, tpl->GetFunction());
+  exports->Set(String::NewFromUtf8(isolate, "MuxOut"), tpl->GetFunction());
+}
+
+void MuxOut::New(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string dest_ip = std::string(*param0);
+  unsigned int dest_port = args[1]->Uint32Value();
+  unsigned int stream_id = args[2]->Uint32Value();
+
+  MuxOut* obj = new MuxOut();
+  obj->me = new owt_base::InternalMuxOut(dest_ip, dest_port, stream_id);
+  obj->dest = obj->me;
+
+  obj->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+void MuxOut::close(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  MuxOut* obj = ObjectWrap::Unwrap<MuxOut>(args.Holder());
+  owt_base::InternalMuxOut* me = obj->me;
+  delete me;
+}
@@ -0,0 +1,51 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef INTERNALMUXWRAPPER_H
+#define INTERNALMUXWRAPPER_H
+
+#include "../../addons/common/MediaFramePipelineWrapper.h"
+#include <InternalMux.h>
+#include <node.h>
+#include <node_object_wrap.h>
+
+/*
+ * Wrapper class of owt_base::InternalMuxIn
+ */
+class MuxIn : public FrameSource {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+  owt_base::InternalMuxIn* me;
+
+ private:
+  MuxIn();
+  ~MuxIn();
+  static v8::Persistent<v8::Function> constructor;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void getListeningPort(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void removeDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+};
+
+/*
+ * Wrapper class of owt_base::InternalMuxOut
+ */
+class MuxOut : public FrameDestination {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+  owt_base::InternalMuxOut* me;
+
+ private:
+  MuxOut();
+  ~MuxOut();
+  static v8::Persistent<v8::Function> constructor;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+};
+
+#endif
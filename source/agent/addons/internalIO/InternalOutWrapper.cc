@@ -22,6 +22,7 @@ void InternalOut::Init(v8::Local<v8::Object> exports) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
   // Prototype
   NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
 
   constructor.Reset(isolate, tpl->GetFunction());
   exports->Set(String::NewFromUtf8(isolate, "Out"), tpl->GetFunction());
@@ -52,3 +53,15 @@ void InternalOut::close(const v8::FunctionCallbackInfo<v8::Value>& args) {
   owt_base::InternalOut* me = obj->me;
   delete me;
 }
+
+void InternalOut::getStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  InternalOut* obj = ObjectWrap::Unwrap<InternalOut>(args.This());
+  owt_base::InternalOut* me = obj->me;
+
+  std::string stats = me->getStats();
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
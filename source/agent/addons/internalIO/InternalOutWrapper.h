@@ -25,6 +25,8 @@ class InternalOut : public FrameDestination {
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif
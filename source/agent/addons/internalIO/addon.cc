@@ -5,6 +5,7 @@
 #include "InternalInWrapper.h"
 #include "InternalOutWrapper.h"
 #include "InternalIOWrapper.h"
+#include "InternalMuxWrapper.h"
 
 #include <node.h>
 
@@ -15,6 +16,8 @@ void InitAll(Handle<Object> exports) {
   InternalOut::Init(exports);
   SctpIn::Init(exports);
   SctpOut::Init(exports);
+  MuxIn::Init(exports);
+  MuxOut::Init(exports);
 }
 
 NODE_MODULE(addon, InitAll)
@@ -6,11 +6,19 @@
       'InternalInWrapper.cc',
       'InternalOutWrapper.cc',
       'InternalIOWrapper.cc',
+      'InternalMuxWrapper.cc',
       '../../../core/owt_base/InternalIn.cpp',
       '../../../core/owt_base/InternalOut.cpp',
       '../../../core/owt_base/InternalSctp.cpp',
+      '../../../core/owt_base/InternalMux.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/PayloadBufferPool.cpp',
+      '../../../core/owt_base/MemoryBudget.cpp',
+      '../../../core/owt_base/IOServicePool.cpp',
       '../../../core/owt_base/RawTransport.cpp',
+      '../../../core/owt_base/HostLoadGovernor.cpp',
+      '../../../core/owt_base/ShmTransport.cpp',
+      '../../../core/owt_base/UringTransport.cpp',
       '../../../core/owt_base/SctpTransport.cpp',
     ],
     'include_dirs': [
@@ -23,7 +31,8 @@
       '-lboost_thread',
       '-llog4cxx',
       '-L$(CORE_HOME)/../../build/libdeps/build/lib',
-      '-lusrsctp'
+      '-lusrsctp',
+      '-lrt'
     ],
     # 'INET', 'INET6' flags must be added for usrsctp lib, otherwise the arguments of receive callback would shift
     'cflags_cc': ['-DINET', '-DINET6'],
@@ -74,6 +83,43 @@
 #        'cflags_cc!': ['-fno-exceptions']
 #      }],
 #    ]
+#  },
+#  {
+#    'target_name': 'TransportBench',
+#    'type' : 'executable',
+#    'sources': [
+#      '../../../core/owt_base/RawTransport.cpp',
+#      '../../../core/owt_base/SctpTransport.cpp',
+#      '../../../core/owt_base/IOServicePool.cpp',
+#      '../../../core/owt_base/HostLoadGovernor.cpp',
+#      '../../../core/owt_base/PayloadBufferPool.cpp',
+#      '../../../core/owt_base/MemoryBudget.cpp',
+#      '../../../core/owt_base/TransportBench.cpp',
+#    ],
+#    'include_dirs': [
+#      '$(CORE_HOME)/common',
+#      '$(CORE_HOME)/owt_base',
+#      '$(CORE_HOME)/../../third_party/usrsctp/usrsctplib'
+#    ],
+#    'libraries': [
+#      '-lboost_system',
+#      '-lboost_thread',
+#      '-llog4cxx',
+#      '-L$(CORE_HOME)/../../third_party/usrsctp/usrsctplib/.libs', '-lusrsctp',
+#    ],
+#    'conditions': [
+#      [ 'OS=="mac"', {
+#        'xcode_settings': {
+#          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+#          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+#          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+#        },
+#      }, { # OS!="mac"
+#        'cflags!':    ['-fno-exceptions'],
+#        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11', '-DINET', '-DINET6'],
+#        'cflags_cc!': ['-fno-exceptions']
+#      }],
+#    ]
 #  }
   ]
 }
@@ -5,7 +5,13 @@
       'addon.cc',
       'MediaFrameMulticasterWrapper.cc',
       '../../../core/owt_base/MediaFrameMulticaster.cpp',
+      '../../../core/owt_base/QueuedFrameDestination.cpp',
+      '../../../core/owt_base/DeliveryThreadPool.cpp',
+      '../../../core/owt_base/KeyFrameRequestGovernor.cpp',
+      '../../../core/owt_base/VP9LayerFilter.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/PayloadBufferPool.cpp',
+      '../../../core/owt_base/MemoryBudget.cpp',
     ],
     'include_dirs': ['$(CORE_HOME)/common',
                       '$(CORE_HOME)/owt_base'],
@@ -21,6 +21,7 @@ void InternalQuicIn::Init(v8::Local<v8::Object> exports) {
   // Prototype
   NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
   NODE_SET_PROTOTYPE_METHOD(tpl, "getListeningPort", getListeningPort);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
 
@@ -67,6 +68,22 @@ void InternalQuicIn::getListeningPort(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(Number::New(isolate, port));
 }
 
+void InternalQuicIn::getStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  InternalQuicIn* obj = ObjectWrap::Unwrap<InternalQuicIn>(args.This());
+  QuicIn* me = obj->me;
+
+  if (!me) {
+    return;
+  }
+
+  std::string stats = me->getStats();
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
+
 void InternalQuicIn::addDestination(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -120,6 +137,7 @@ void InternalQuicOut::Init(v8::Local<v8::Object> exports) {
   tpl->InstanceTemplate()->SetInternalFieldCount(1);
   // Prototype
   NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
 
   constructor.Reset(isolate, tpl->GetFunction());
   exports->Set(String::NewFromUtf8(isolate, "out"), tpl->GetFunction());
@@ -132,9 +150,11 @@ void InternalQuicOut::New(const v8::FunctionCallbackInfo<v8::Value>& args) {
   String::Utf8Value param0(args[0]->ToString());
   std::string ip = std::string(*param0);
   int port = args[1]->Uint32Value();
+  // Optional: audio-datagram delivery semantics (default on); see QuicOut.
+  bool audioDatagrams = args.Length() > 2 ? args[2]->BooleanValue() : true;
 
   InternalQuicOut* obj = new InternalQuicOut();
-  obj->me = new QuicOut(ip, port);
+  obj->me = new QuicOut(ip, port, audioDatagrams);
   obj->dest = obj->me;
 
   obj->Wrap(args.This());
@@ -149,3 +169,19 @@ void InternalQuicOut::close(const v8::FunctionCallbackInfo<v8::Value>& args) {
   obj->me = nullptr;
   obj->dest = nullptr;
 }
+
+void InternalQuicOut::getStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  InternalQuicOut* obj = ObjectWrap::Unwrap<InternalQuicOut>(args.This());
+  QuicOut* me = obj->me;
+
+  if (!me) {
+    return;
+  }
+
+  std::string stats = me->getStats();
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
@@ -29,6 +29,7 @@ class InternalQuicIn : public FrameSource {
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void getListeningPort(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void removeDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
@@ -50,6 +51,8 @@ class InternalQuicOut : public FrameDestination {
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif  // INTERNAL_QUIC_H_
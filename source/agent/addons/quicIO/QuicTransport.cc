@@ -19,7 +19,9 @@ QuicIn::QuicIn(const std::string& cert_file, const std::string& key_file)
         : server_(RQuicFactory::createQuicServer(cert_file.c_str(), key_file.c_str()))
         , m_hasStream(false)
         , m_bufferSize(INIT_BUFF_SIZE)
-        , m_receivedBytes(0) {
+        , m_receivedBytes(0)
+        , m_receivedFrames(0)
+        , m_receivedFrameBytes(0) {
   m_receiveData.buffer.reset(new char[m_bufferSize]);
   server_->setListener(this);
   server_->listen(0);
@@ -42,6 +44,15 @@ unsigned int QuicIn::getListeningPort() {
 
 void QuicIn::onReady() {}
 
+std::string QuicIn::getStats() {
+    char msg[128];
+    snprintf(msg, sizeof(msg),
+        "{\"receivedFrames\":%llu,\"receivedBytes\":%llu}",
+        (unsigned long long)m_receivedFrames.load(std::memory_order_relaxed),
+        (unsigned long long)m_receivedFrameBytes.load(std::memory_order_relaxed));
+    return msg;
+}
+
 void QuicIn::onFeedback(const FeedbackMsg& msg) {
     char sendBuffer[512];
     sendBuffer[0] = TDT_FEEDBACK_MSG;
@@ -55,6 +66,7 @@ void QuicIn::dFrame(char* buf) {
         case TDT_MEDIA_FRAME:
             frame = reinterpret_cast<Frame*>(buf + 1);
             frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
+            frame->buffer = nullptr; // Wire frames carry a stale producer-side pointer; payload lives in the transport buffer.
             deliverFrame(*frame);
             // std::cout << "deliverFrame" << std::endl;
             break;
@@ -71,7 +83,7 @@ void QuicIn::onData(uint32_t session_id, uint32_t stream_id, char* buf, uint32_t
     if (m_receivedBytes + len >= m_bufferSize) {
         m_bufferSize += (m_receivedBytes + len);
         std::cout << "new_bufferSize: " << m_bufferSize << std::endl;
-        boost::shared_array<uint8_t> new_buffer;
+        boost::shared_array<char> new_buffer;
         new_buffer.reset(new char[m_bufferSize]);
         if (new_buffer.get()) {
             memcpy(new_buffer.get(), m_receiveData.buffer.get(), m_receivedBytes);
@@ -94,6 +106,8 @@ void QuicIn::onData(uint32_t session_id, uint32_t stream_id, char* buf, uint32_t
             // std::cout << "receive: " << expectedLen << std::endl;
             m_receivedBytes -= expectedLen;
             char* dpos = m_receiveData.buffer.get() + 4;
+            m_receivedFrames.fetch_add(1, std::memory_order_relaxed);
+            m_receivedFrameBytes.fetch_add(payloadlen, std::memory_order_relaxed);
             dFrame(dpos);
             if (m_receivedBytes > 0) {
                 std::cout << "not zero m_receiveBytes" << std::endl;
@@ -103,14 +117,39 @@ void QuicIn::onData(uint32_t session_id, uint32_t stream_id, char* buf, uint32_t
     }
 }
 
+// Delta frames older than this backlog are dropped rather than queued; the
+// consumer requests a key frame through the regular feedback path.
+const size_t MAX_DELTA_BACKLOG = 64;
+
+// In audio-datagram mode the audio band never holds more than this many
+// frames: a stalled link sheds the oldest audio (worthless once late)
+// instead of delivering it seconds later in order. At a 10-20ms frame
+// cadence this caps queue-added audio latency around 100ms.
+const size_t MAX_AUDIO_BACKLOG = 8;
+
 // QUIC Outgoing
-QuicOut::QuicOut(const std::string& dest_ip, unsigned int dest_port)
-        : client_(RQuicFactory::createQuicClient()) {
+QuicOut::QuicOut(const std::string& dest_ip, unsigned int dest_port, bool audioDatagrams)
+        : client_(RQuicFactory::createQuicClient())
+        , m_audioDatagrams(audioDatagrams)
+        , m_sentFrames(0)
+        , m_sentBytes(0)
+        , m_droppedFrames(0)
+        , m_droppedAudioFrames(0)
+        , m_isClosing(false) {
+    for (int i = 0; i < PRIORITY_COUNT; i++)
+        m_queueDepths[i] = 0;
     client_->setListener(this);
     client_->start(dest_ip.c_str(), dest_port);
+    m_sendThread = boost::thread(&QuicOut::sendLoop, this);
 }
 
 QuicOut::~QuicOut() {
+    {
+        boost::mutex::scoped_lock lock(m_queueMutex);
+        m_isClosing = true;
+        m_queueCond.notify_all();
+    }
+    m_sendThread.join();
     client_->stop();
     client_.reset();
 }
@@ -134,11 +173,77 @@ void QuicOut::onFrame(const Frame& frame) {
     memcpy(data.buffer.get() + 4 + headerLength, payload, payloadLength);
     data.length = headerLength + payloadLength + 4;
 
-    //std::string str(data.buffer.get(), data.length);
     if (data.length > INIT_BUFF_SIZE + 4) {
         std::cout << "sendFrame " << (data.length  - 4)<< std::endl;
     }
-    client_->send(data.buffer.get(), data.length);
+
+    Priority priority = PRIORITY_DELTA_FRAME;
+    if (isAudioFrame(frame)) {
+        priority = PRIORITY_AUDIO;
+    } else if (isVideoFrame(frame) && frame.additionalInfo.video.isKeyFrame) {
+        priority = PRIORITY_KEY_FRAME;
+    }
+
+    boost::mutex::scoped_lock lock(m_queueMutex);
+    if (priority == PRIORITY_DELTA_FRAME && m_queues[priority].size() >= MAX_DELTA_BACKLOG) {
+        // The link is not draining; shed the oldest delta frame instead of
+        // growing the queue behind audio and key frames.
+        m_queues[priority].pop_front();
+        m_queueDepths[priority].fetch_sub(1, std::memory_order_relaxed);
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (priority == PRIORITY_AUDIO && m_audioDatagrams && m_queues[priority].size() >= MAX_AUDIO_BACKLOG) {
+        // Datagram semantics: fresh audio supersedes stale audio.
+        m_queues[priority].pop_front();
+        m_queueDepths[priority].fetch_sub(1, std::memory_order_relaxed);
+        m_droppedAudioFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_queues[priority].push_back(data);
+    m_queueDepths[priority].fetch_add(1, std::memory_order_relaxed);
+    m_queueCond.notify_one();
+}
+
+void QuicOut::sendLoop() {
+    // Drains the priority bands in order so that queued audio always leaves
+    // before video, and key frames before deltas, whenever the link backs up.
+    boost::mutex::scoped_lock lock(m_queueMutex);
+    while (!m_isClosing) {
+        int band = -1;
+        for (int i = 0; i < PRIORITY_COUNT; i++) {
+            if (!m_queues[i].empty()) {
+                band = i;
+                break;
+            }
+        }
+        if (band < 0) {
+            m_queueCond.wait(lock);
+            continue;
+        }
+        TransportData data = m_queues[band].front();
+        m_queues[band].pop_front();
+        m_queueDepths[band].fetch_sub(1, std::memory_order_relaxed);
+        lock.unlock();
+        client_->send(data.buffer.get(), data.length);
+        m_sentFrames.fetch_add(1, std::memory_order_relaxed);
+        m_sentBytes.fetch_add(data.length, std::memory_order_relaxed);
+        lock.lock();
+    }
+}
+
+std::string QuicOut::getStats() {
+    char msg[256];
+    snprintf(msg, sizeof(msg),
+        "{\"sentFrames\":%llu,\"sentBytes\":%llu,\"droppedFrames\":%llu,"
+        "\"droppedAudioFrames\":%llu,"
+        "\"queuedAudio\":%llu,\"queuedKeyFrames\":%llu,\"queuedDeltaFrames\":%llu}",
+        (unsigned long long)m_sentFrames.load(std::memory_order_relaxed),
+        (unsigned long long)m_sentBytes.load(std::memory_order_relaxed),
+        (unsigned long long)m_droppedFrames.load(std::memory_order_relaxed),
+        (unsigned long long)m_droppedAudioFrames.load(std::memory_order_relaxed),
+        (unsigned long long)m_queueDepths[PRIORITY_AUDIO].load(std::memory_order_relaxed),
+        (unsigned long long)m_queueDepths[PRIORITY_KEY_FRAME].load(std::memory_order_relaxed),
+        (unsigned long long)m_queueDepths[PRIORITY_DELTA_FRAME].load(std::memory_order_relaxed));
+    return msg;
 }
 
 void QuicOut::onReady() {}
@@ -10,8 +10,11 @@
 #include "quic_raw_lib.h"
 #include "MediaFramePipeline.h"
 
+#include <atomic>
 #include <boost/asio.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/thread.hpp>
+#include <deque>
 
 /*
  * Wrapper class of TQuicServer
@@ -25,6 +28,9 @@ public:
 
     unsigned int getListeningPort();
 
+    // Counters as a JSON string for the addon layer.
+    std::string getStats();
+
     // Implements FrameSource
     void onFeedback(const owt_base::FeedbackMsg&) override;
 
@@ -44,6 +50,10 @@ private:
     size_t m_bufferSize;
     TransportData m_receiveData;
     uint32_t m_receivedBytes;
+    // Sampled with relaxed loads from getStats(); written only on the
+    // receive path.
+    std::atomic<uint64_t> m_receivedFrames;
+    std::atomic<uint64_t> m_receivedFrameBytes;
 };
 
 /*
@@ -53,9 +63,17 @@ private:
  */
 class QuicOut : public owt_base::FrameDestination, public net::RQuicListener {
 public:
-    QuicOut(const std::string& dest_ip, unsigned int dest_port);
+    // audioDatagrams gives audio datagram-like delivery semantics: the audio
+    // band is kept shallow and stale frames are shed instead of queued, so
+    // audio latency tracks one-way delay when the reliable stream stalls on
+    // loss recovery. The vendored rawquic library only exposes reliable
+    // streams, so the unreliability lives at the sender; the receiver
+    // conceals the gap as it would a lost packet.
+    QuicOut(const std::string& dest_ip, unsigned int dest_port, bool audioDatagrams);
     virtual ~QuicOut();
 
+    std::string getStats();
+
     // Implements FrameDestination
     void onFrame(const owt_base::Frame&) override;
 
@@ -63,13 +81,34 @@ public:
     void onReady() override;
     void onData(uint32_t session_id, uint32_t stream_id, char* data, uint32_t len) override;
 private:
+    // Priority bands for the send queue: audio must never wait behind bulk
+    // video retransmits on a congested link.
+    enum Priority {
+        PRIORITY_AUDIO = 0,
+        PRIORITY_KEY_FRAME,
+        PRIORITY_DELTA_FRAME,
+        PRIORITY_COUNT
+    };
 
     typedef struct {
         boost::shared_array<char> buffer;
         int length;
     } TransportData;
 
+    void sendLoop();
+
     std::shared_ptr<net::RQuicClientInterface> client_;
+    bool m_audioDatagrams;
+    std::atomic<uint64_t> m_sentFrames;
+    std::atomic<uint64_t> m_sentBytes;
+    std::atomic<uint64_t> m_droppedFrames;
+    std::atomic<uint64_t> m_droppedAudioFrames;
+    std::atomic<uint64_t> m_queueDepths[PRIORITY_COUNT];
+    std::deque<TransportData> m_queues[PRIORITY_COUNT];
+    boost::mutex m_queueMutex;
+    boost::condition_variable m_queueCond;
+    bool m_isClosing;
+    boost::thread m_sendThread;
 };
 
 #endif  // INTERNAL_QUIC_H_
@@ -5,11 +5,14 @@
       'addon.cc',
       'QuicTransport.cc',
       'InternalQuic.cc',
-      '../../../core/owt_base/MediaFramePipeline.cpp'
+      '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/PayloadBufferPool.cpp',
+      '../../../core/owt_base/MemoryBudget.cpp'
     ],
     'include_dirs': [
       "<!(node -e \"require('nan')\")",
       '../../../core/owt_base',
+      '../../../core/common',
       '../../../agent/addons/common',
       '../../../../third_party/quic-lib/dist/include'
     ],
@@ -2,9 +2,17 @@
 
 const log = require('../logger').logger.getLogger('AnalyticsAgent');
 const BaseAgent = require('./base-agent');
-const VideoAnalyzer = require('../videoAnalyzer_sw/build/Release/videoAnalyzer-sw');
-const MediaFrameMulticaster = require('../mediaFrameMulticaster/build/Release/mediaFrameMulticaster');
 const EventEmitter = require('events').EventEmitter;
+
+// Addon dlopen+init dominates workingNode spawn time, so the native addons
+// load when the first analytics session starts rather than at require time.
+let VideoAnalyzer, MediaFrameMulticaster;
+function loadAddons() {
+  if (!VideoAnalyzer) {
+    VideoAnalyzer = require('../videoAnalyzer_sw/build/Release/videoAnalyzer-sw');
+    MediaFrameMulticaster = require('../mediaFrameMulticaster/build/Release/mediaFrameMulticaster');
+  }
+}
 const { getVideoParameterForAddon } = require('../mediaUtil');
 
 class AddonEngine {
@@ -16,6 +24,7 @@ class AddonEngine {
       'gaccplugin': false,
       'MFE_timeout': 0
     };
+    loadAddons();
     this.engine = new VideoAnalyzer(config);
   }
 
@@ -126,6 +135,7 @@ class AnalyticsAgent extends BaseAgent {
         if (!this.outputs[newStreamId]) {
           if (this.inputs[connectionId]) {
             this.inputs[connectionId].output = newStreamId;
+            loadAddons();
             this.outputs[newStreamId] = new MediaFrameMulticaster();
 
             // following default arguments are from video transcoder
@@ -240,6 +250,18 @@ class AnalyticsAgent extends BaseAgent {
     return Promise.reject('cutoff failed');
   }
 
+  // Pre-initialize every configured plugin into the addon's warm pool, so a
+  // pipeline attaching to a live stream leases a ready instance instead of
+  // paying model load on its setup path.
+  preloadPlugins() {
+    loadAddons();
+    for (const id in this.algorithms) {
+      if (this.algorithms[id].name) {
+        VideoAnalyzer.preloadPlugin(this.algorithms[id].name, 1);
+      }
+    }
+  }
+
   cleanup() {
     log.debug('cleanup');
     var connectionId;
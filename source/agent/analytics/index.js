@@ -145,5 +145,11 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
         agent.cleanup();
       }
     },
+    // Called by workingNode after READY: plugin dlopen plus PluginInit
+    // compiles and loads models (seconds per plugin), so warm every
+    // configured plugin before the first pipeline asks for one.
+    warmup: function () {
+      agent.preloadPlugins();
+    },
   };
 };
@@ -110,56 +110,48 @@ void AcmDecoder::onFrame(const Frame& frame)
     memset(&rtp_header, 0, sizeof(WebRtcRTPHeader));
     rtp_header.frameType = kAudioFrameSpeech;
 
-    if (frame.additionalInfo.audio.isRtpPacket) {
-        ::RTPHeader *head = reinterpret_cast<::RTPHeader*>(frame.payload);
-
-        rtp_header.header.markerBit                 = head->getMarker();
-        rtp_header.header.payloadType               = head->getPayloadType();
-        rtp_header.header.sequenceNumber            = head->getSeqNumber();
-        rtp_header.header.timestamp                 = head->getTimestamp();
-        rtp_header.header.ssrc                      = head->getSSRC();
-        rtp_header.header.numCSRCs                  = 0;
-        rtp_header.header.paddingLength             = 0;
-        rtp_header.header.headerLength              = head->getHeaderLength();
-        rtp_header.header.payload_type_frequency    = frame.additionalInfo.audio.sampleRate;
-
-        payload = frame.payload + head->getHeaderLength();
-        length = frame.length - head->getHeaderLength();
+    // Frames from AudioFrameConstructor carry the original packet timing,
+    // so NetEq keeps the publisher's sequencing; synthesized frames get a
+    // locally generated sequence. The real sequencing is also what lets
+    // NetEq spot a single loss and decode the next packet's Opus in-band
+    // FEC for it instead of running expand/PLC.
+    if (frame.additionalInfo.audio.hasRtpTiming) {
+        rtp_header.header.markerBit                 = frame.additionalInfo.audio.marker;
+        rtp_header.header.sequenceNumber            = frame.additionalInfo.audio.seqNumber;
+        rtp_header.header.ssrc                      = frame.additionalInfo.audio.ssrc;
     } else {
         rtp_header.header.markerBit                 = false;
-        rtp_header.header.payloadType               = getAudioPltype(frame.format);
         rtp_header.header.sequenceNumber            = m_seqNumber++;
-        rtp_header.header.timestamp                 = frame.timeStamp;
         rtp_header.header.ssrc                      = m_ssrc;
-        rtp_header.header.numCSRCs                  = 0;
-        rtp_header.header.paddingLength             = 0;
-        rtp_header.header.headerLength              = 12;
-        rtp_header.header.payload_type_frequency    = frame.additionalInfo.audio.sampleRate;
-
-        payload = frame.payload;
-        length = frame.length;
     }
+    rtp_header.header.payloadType               = getAudioPltype(frame.format);
+    rtp_header.header.timestamp                 = frame.timeStamp;
+    rtp_header.header.numCSRCs                  = 0;
+    rtp_header.header.paddingLength             = 0;
+    rtp_header.header.headerLength              = 12;
+    rtp_header.header.payload_type_frequency    = frame.additionalInfo.audio.sampleRate;
+
+    payload = frame.payload;
+    length = frame.length;
 
-    ELOG_TRACE_T("onFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%ld), seqNum(%d), %s",
+    ELOG_TRACE_T("onFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%ld), seqNum(%d)",
             getFormatStr(frame.format),
             frame.additionalInfo.audio.sampleRate,
             frame.additionalInfo.audio.channels,
             rtp_header.header.timestamp * 1000 / frame.additionalInfo.audio.sampleRate,
             length,
-            rtp_header.header.sequenceNumber,
-            frame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
+            rtp_header.header.sequenceNumber
             );
 
     ret = m_audioCodingModule->IncomingPacket(payload, length, rtp_header);
     if (ret != 0) {
-        ELOG_ERROR_T("Fail to insert compressed into acm, format(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%ld), seqNum(%d), %s",
+        ELOG_ERROR_T("Fail to insert compressed into acm, format(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%ld), seqNum(%d)",
                 getFormatStr(frame.format),
                 frame.additionalInfo.audio.sampleRate,
                 frame.additionalInfo.audio.channels,
                 rtp_header.header.timestamp * 1000 / frame.additionalInfo.audio.sampleRate,
                 length,
-                rtp_header.header.sequenceNumber,
-                frame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
+                rtp_header.header.sequenceNumber
                 );
     }
 }
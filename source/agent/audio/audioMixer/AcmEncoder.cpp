@@ -18,6 +18,8 @@ AcmEncoder::AcmEncoder(const FrameFormat format)
     : m_format(format)
     , m_rtpSampleRate(0)
     , m_valid(false)
+    , m_vadActive(true)
+    , m_opusDtx(false)
     , m_running(false)
     , m_incomingFrameCount(0)
 {
@@ -71,6 +73,17 @@ bool AcmEncoder::init()
         return false;
     }
 
+    if (m_format == FRAME_FORMAT_OPUS) {
+        int lossRate = getAudioFecPacketLossRate();
+        if (lossRate > 0) {
+            // Not fatal; the stream still flows, just without loss repair.
+            if (m_audioCodingModule->SetCodecFEC(true) != 0)
+                ELOG_WARN_T("Error SetCodecFEC");
+            else if (m_audioCodingModule->SetPacketLossRate(lossRate) != 0)
+                ELOG_WARN_T("Error SetPacketLossRate(%d)", lossRate);
+        }
+    }
+
     switch (m_format) {
         case FRAME_FORMAT_G722_16000_1:
         case FRAME_FORMAT_G722_16000_2:
@@ -103,6 +116,7 @@ bool AcmEncoder::addAudioFrame(const AudioFrame* audioFrame)
     {
         boost::mutex::scoped_lock lock(m_mutex);
 
+        m_vadActive = (audioFrame->vad_activity_ != AudioFrame::kVadPassive);
         m_frame->CopyFrom(*audioFrame);
 
         if (m_incomingFrameCount > 1)
@@ -137,10 +151,40 @@ void AcmEncoder::encodeLoop()
             frame = m_frame;
         }
 
+        bool adapt = EncoderLoadGovernor::enabled() && m_format == FRAME_FORMAT_OPUS;
+
+        timespec encodeStart, encodeEnd;
+        if (adapt)
+            clock_gettime(CLOCK_MONOTONIC, &encodeStart);
+
         int ret = m_audioCodingModule->Add10MsData(*frame.get());
         if (ret < 0) {
             ELOG_ERROR_T("Fail to insert raw into acm");
         }
+
+        if (adapt) {
+            clock_gettime(CLOCK_MONOTONIC, &encodeEnd);
+            int64_t encodeTimeUs = (encodeEnd.tv_sec - encodeStart.tv_sec) * 1000000
+                + (encodeEnd.tv_nsec - encodeStart.tv_nsec) / 1000;
+
+            // Mixed audio arrives in 10ms chunks, so the budget is 100/s.
+            switch (m_loadGovernor.onEncodedFrame(encodeTimeUs, 100)) {
+            case EncoderLoadGovernor::ADAPT_FASTER:
+                if (!m_opusDtx && m_audioCodingModule->EnableOpusDtx() == 0) {
+                    m_opusDtx = true;
+                    ELOG_INFO_T("Overloaded, Opus DTX on");
+                }
+                break;
+            case EncoderLoadGovernor::ADAPT_SLOWER:
+                if (m_opusDtx && m_audioCodingModule->DisableOpusDtx() == 0) {
+                    m_opusDtx = false;
+                    ELOG_INFO_T("Load recovered, Opus DTX off");
+                }
+                break;
+            default:
+                break;
+            }
+        }
     }
 
     ELOG_DEBUG_T("Thread exited!");
@@ -171,17 +215,18 @@ int32_t AcmEncoder::SendData(FrameType frame_type,
     frame.format = m_format;
     frame.additionalInfo.audio.sampleRate = getAudioSampleRate(frame.format);
     frame.additionalInfo.audio.channels = getAudioChannels(frame.format);
+    frame.additionalInfo.audio.voiceActivity = m_vadActive ? 1 : 0;
     frame.payload = const_cast<uint8_t*>(payload_data);
     frame.length = payload_len_bytes;
     frame.timeStamp = timestamp;
+    frame.ingestTimeMs = ingestTimeMs();
 
-    ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d), %s",
+    ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d)",
             getFormatStr(frame.format),
             frame.additionalInfo.audio.sampleRate,
             frame.additionalInfo.audio.channels,
             frame.timeStamp * 1000 / m_rtpSampleRate,
-            frame.length,
-            frame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
+            frame.length
             );
 
     deliverFrame(frame);
@@ -13,6 +13,7 @@
 
 #include <logger.h>
 
+#include "EncoderLoadGovernor.h"
 #include "MediaFramePipeline.h"
 #include "AudioEncoder.h"
 
@@ -48,6 +49,12 @@ private:
     uint32_t m_rtpSampleRate;
 
     bool m_valid;
+    bool m_vadActive;
+
+    // The ACM exposes no runtime complexity knob, so the only load-shedding
+    // step here is Opus DTX; silence then costs (nearly) nothing to encode.
+    EncoderLoadGovernor m_loadGovernor;
+    bool m_opusDtx;
 
     bool m_running;
     boost::thread m_thread;
@@ -104,7 +104,7 @@ int32_t AcmmBroadcastGroup::NeededFrequency()
     return neededFreq;
 }
 
-void AcmmBroadcastGroup::NewMixedAudio(const webrtc::AudioFrame *audioFrame)
+void AcmmBroadcastGroup::NewMixedAudio(const webrtc::AudioFrame *audioFrame, int64_t ingestTimeMs)
 {
     ELOG_TRACE("newAudioFrame, frame id(0x%x), sample_rate(%d), channels(%ld), samples_per_channel(%ld), timestamp(%d)",
             audioFrame->id_,
@@ -116,7 +116,7 @@ void AcmmBroadcastGroup::NewMixedAudio(const webrtc::AudioFrame *audioFrame)
 
     for (auto& it : m_outputMap) {
         boost::shared_ptr<AcmmOutput> output = it.second;
-        output->newAudioFrame(audioFrame);
+        output->newAudioFrame(audioFrame, ingestTimeMs);
     }
 }
 
@@ -32,7 +32,7 @@ public:
     void removeDest(owt_base::FrameDestination* destination);
 
     int32_t NeededFrequency();
-    void NewMixedAudio(const AudioFrame* audioFrame);
+    void NewMixedAudio(const AudioFrame* audioFrame, int64_t ingestTimeMs = 0);
 
 protected:
     bool getFreeOutputId(uint16_t *id);
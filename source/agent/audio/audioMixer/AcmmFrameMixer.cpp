@@ -4,8 +4,143 @@
 
 #include "AcmmFrameMixer.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ThreadAffinity.h>
+
+#include "AudioMixKernel.h"
+#include "AudioTime.h"
+
 namespace mcu {
 
+namespace {
+
+// Worker pool for per-group delivery and encode: groups are the work
+// items, each serialized on its own strand so per-group ordering holds.
+// Delivery stays on the tick thread unless OWT_AUDIO_MIX_THREADS asks for
+// workers.
+class MixPool {
+public:
+    static MixPool& instance()
+    {
+        static MixPool pool;
+        return pool;
+    }
+
+    uint32_t size() const { return m_num; }
+    boost::asio::io_service *service() { return m_srv.get(); }
+
+private:
+    MixPool()
+        : m_num(0)
+    {
+        const char *env = getenv("OWT_AUDIO_MIX_THREADS");
+        int num = env ? atoi(env) : 0;
+        uint32_t nThreads = boost::thread::hardware_concurrency();
+
+        if (num < 0)
+            num = 0;
+        if ((uint32_t)num > nThreads)
+            num = nThreads;
+        m_num = num;
+
+        if (m_num > 0) {
+            m_srv       = boost::make_shared<boost::asio::io_service>();
+            m_srvWork   = boost::make_shared<boost::asio::io_service::work>(*m_srv);
+            m_thrGrp    = boost::make_shared<boost::thread_group>();
+
+            boost::shared_ptr<boost::asio::io_service> srv = m_srv;
+            for (uint32_t i = 0; i < m_num; i++) {
+                m_thrGrp->create_thread([srv]() {
+                    ThreadAffinity::applyRole("audio");
+                    srv->run();
+                });
+            }
+        }
+    }
+
+    // Lives for the process, torn down with it.
+    ~MixPool() {}
+
+    uint32_t m_num;
+    boost::shared_ptr<boost::asio::io_service> m_srv;
+    boost::shared_ptr<boost::asio::io_service::work> m_srvWork;
+    boost::shared_ptr<boost::thread_group> m_thrGrp;
+};
+
+} // namespace
+
+// Opt into the native mixing path (see performNativeMix) instead of the
+// webrtc AudioConferenceMixer module.
+static bool nativeMixEnabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char *env = getenv("OWT_NATIVE_AUDIO_MIX");
+        enabled = (env && env[0] == '1') ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+// SFU-style forwarding for the largest rooms: no decode, mix or encode
+// at all, every group's opus outputs relay the top-ranked foreign
+// speaker's encoded stream instead (see updateForwarding). Non-opus
+// outputs receive nothing in this mode, so it only suits deployments
+// where subscribers take opus and mix client-side.
+static bool forwardModeEnabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char *env = getenv("OWT_AUDIO_FORWARD");
+        enabled = (env && env[0] == '1') ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+// Cap on simultaneously mixed speakers in the native path; 0 mixes all
+// voice-active sources.
+static uint32_t maxActiveSpeakers()
+{
+    static int count = -1;
+    if (count < 0) {
+        const char *env = getenv("OWT_AUDIO_MAX_ACTIVE");
+        count = env ? atoi(env) : 0;
+        if (count < 0)
+            count = 0;
+    }
+    return (uint32_t)count;
+}
+
+// While nobody is speaking, deliver one silent frame per this many ticks
+// instead of encoding silence every 10ms (see performNativeMix).
+static const uint32_t kSilenceKeepaliveTicks = 100;
+
+// The mix runs at the widest source channel count, capped so the frame
+// still fits an AudioFrame at 48k. Downstream encoders take mono/stereo,
+// wider sources fold at mix time (see mixAccumulateChannels).
+static const size_t kMaxMixChannels = 8;
+
+// Per-destination-channel unity gains for the channel-mapping kernels;
+// a pan matrix would slot in per source here.
+static const int32_t kUnityChannelGainsQ8[kMaxMixChannels] = {
+    256, 256, 256, 256, 256, 256, 256, 256
+};
+
+static inline uint64_t tickNowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 static inline AudioConferenceMixer::Frequency convert2Frequency(int32_t freq)
 {
     switch (freq) {
@@ -32,7 +167,15 @@ AcmmFrameMixer::AcmmFrameMixer()
     : m_asyncHandle(NULL)
     , m_vadEnabled(false)
     , m_frequency(0)
+    , m_vadPeriodTicks(0)
+    , m_tickCount(0)
+    , m_statTicks(0)
+    , m_statTotalUs(0)
+    , m_statMaxUs(0)
+    , m_statMisses(0)
 {
+    memset(m_statHist, 0, sizeof(m_statHist));
+
     m_mixerModule.reset(AudioConferenceMixer::Create(0));
     m_mixerModule->RegisterMixedStreamCallback(this);
     m_mixerModule->SetMultipleInputs(true);
@@ -124,6 +267,7 @@ void AcmmFrameMixer::enableVAD(uint32_t period)
 
     m_vadEnabled = true;
     m_mostActiveInput.reset();
+    m_vadPeriodTicks = period / 10;
     m_mixerModule->RegisterMixerVadCallback(this, period / 10);
 }
 
@@ -134,6 +278,7 @@ void AcmmFrameMixer::disableVAD()
 
     m_vadEnabled = false;
     m_mostActiveInput.reset();
+    m_vadPeriodTicks = 0;
     m_mixerModule->UnRegisterMixerVadCallback();
 }
 
@@ -203,7 +348,7 @@ bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStr
             acmmGroup->getOutputs(outputs);
             for(auto& o : outputs) {
                 m_broadcastGroup->removeDest(m_outputInfoMap[o.get()].dest);
-                if (!o->addDest(m_outputInfoMap[o.get()].format, m_outputInfoMap[o.get()].dest)) {
+                if (!o->addDest(m_outputInfoMap[o.get()].format, m_outputInfoMap[o.get()].dest, acmmGroup->sharedEncoders())) {
                     ELOG_ERROR("Fail to reconnect dest");
                     return false;
                 }
@@ -211,6 +356,8 @@ bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStr
         }
     }
 
+    updateFrequency();
+
     statistics();
     return true;
 }
@@ -263,6 +410,8 @@ void AcmmFrameMixer::removeInput(const std::string& group, const std::string& in
     if (m_mostActiveInput == acmmInput)
         m_mostActiveInput.reset();
 
+    updateFrequency();
+
     statistics();
     return;
 }
@@ -310,7 +459,7 @@ void AcmmFrameMixer::setInputActive(const std::string& group, const std::string&
         acmmGroup->getOutputs(outputs);
         for(auto& o : outputs) {
             m_broadcastGroup->removeDest(m_outputInfoMap[o.get()].dest);
-            if (!o->addDest(m_outputInfoMap[o.get()].format, m_outputInfoMap[o.get()].dest)) {
+            if (!o->addDest(m_outputInfoMap[o.get()].format, m_outputInfoMap[o.get()].dest, acmmGroup->sharedEncoders())) {
                 ELOG_ERROR("Fail to reconnect dest");
                 return;
             }
@@ -356,7 +505,7 @@ bool AcmmFrameMixer::addOutput(const std::string& group, const std::string& outS
             acmmOutput->removeDest(m_outputInfoMap[acmmOutput.get()].dest);
             m_outputInfoMap.erase(acmmOutput.get());
 
-            if (!acmmOutput->addDest(format, destination)) {
+            if (!acmmOutput->addDest(format, destination, acmmGroup->sharedEncoders())) {
                 ELOG_ERROR("Fail to update dest");
                 return false;
             }
@@ -390,7 +539,7 @@ bool AcmmFrameMixer::addOutput(const std::string& group, const std::string& outS
                 return false;
             }
         } else {
-            if (!acmmOutput->addDest(format, destination)) {
+            if (!acmmOutput->addDest(format, destination, acmmGroup->sharedEncoders())) {
                 ELOG_ERROR("Fail to add dest");
                 return false;
             }
@@ -458,6 +607,12 @@ void AcmmFrameMixer::removeOutput(const std::string& group, const std::string& o
     return;
 }
 
+// Pick the internal mixing rate from the live population: the highest
+// rate any input decodes at or any output encodes at. When everybody
+// shares a rate - the all-opus-48k room - nothing resamples at all;
+// otherwise the minority parties resample at their own edge while the
+// mix itself stays at the majority's native rate. Re-run on every
+// input/output add and remove so the rate follows the room.
 void AcmmFrameMixer::updateFrequency()
 {
     int32_t maxFreq = m_broadcastGroup->NeededFrequency();
@@ -486,15 +641,495 @@ void AcmmFrameMixer::updateFrequency()
 
 void AcmmFrameMixer::onTimeout()
 {
+    uint64_t start = tickNowUs();
     performMix();
+    uint64_t elapsed = tickNowUs() - start;
+
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    m_statTicks++;
+    m_statTotalUs += elapsed;
+    if (elapsed > m_statMaxUs)
+        m_statMaxUs = elapsed;
+
+    // Buckets: <1, <2, <5, <10, >=10ms; the last one blows the 10ms tick
+    // budget and counts as a deadline miss.
+    if (elapsed >= 10000) {
+        m_statHist[4]++;
+        m_statMisses++;
+        ELOG_DEBUG("Tick overran its deadline, %lu us", (unsigned long)elapsed);
+    } else if (elapsed >= 5000) {
+        m_statHist[3]++;
+    } else if (elapsed >= 2000) {
+        m_statHist[2]++;
+    } else if (elapsed >= 1000) {
+        m_statHist[1]++;
+    } else {
+        m_statHist[0]++;
+    }
+}
+
+// Engage the opus passthrough when exactly one input has been
+// voice-active lately: its encoded frames relay straight to matching opus
+// outputs outside its own group (timestamps rewritten onto the mixed
+// timeline, see AcmmInput::onFrame) and those outputs' encoders idle. A
+// second voice-active input tears it down on the next tick and the
+// decode-mix-encode path resumes.
+void AcmmFrameMixer::updatePassthrough()
+{
+    int64_t now = AudioTime::currentTime();
+    boost::shared_ptr<AcmmInput> soleInput;
+    uint16_t soleGroupId = 0;
+    uint32_t numVoiceActive = 0;
+
+    for (auto& g : m_groups) {
+        std::vector<boost::shared_ptr<AcmmInput>> inputs;
+        g.second->getInputs(inputs);
+        for (auto& input : inputs) {
+            if (input->isVoiceActive(now)) {
+                numVoiceActive++;
+                soleInput = input;
+                soleGroupId = g.first;
+            }
+        }
+    }
+
+    bool engage = (numVoiceActive == 1 && soleInput->srcFormat() == FRAME_FORMAT_OPUS);
+
+    if (m_passthroughInput && (!engage || m_passthroughInput != soleInput)) {
+        m_passthroughInput->clearPassthroughOutputs();
+        for (auto& o : m_passthroughOutputs)
+            o->setPassthrough(false);
+        m_passthroughOutputs.clear();
+        m_passthroughInput.reset();
+    }
+
+    if (!engage)
+        return;
+
+    // The speaker's own group keeps the mixed (near-silent) path, so they
+    // never hear themselves.
+    std::vector<boost::shared_ptr<AcmmOutput>> outputs;
+    for (auto& g : m_groups) {
+        if (g.first == soleGroupId)
+            continue;
+
+        std::vector<boost::shared_ptr<AcmmOutput>> groupOutputs;
+        g.second->getOutputs(groupOutputs);
+        for (auto& o : groupOutputs) {
+            if (o->dstFormat() == FRAME_FORMAT_OPUS)
+                outputs.push_back(o);
+        }
+    }
+
+    if (m_passthroughInput != soleInput || m_passthroughOutputs != outputs) {
+        for (auto& o : m_passthroughOutputs)
+            o->setPassthrough(false);
+        for (auto& o : outputs)
+            o->setPassthrough(true);
+
+        soleInput->setPassthroughOutputs(outputs);
+        m_passthroughInput = soleInput;
+        m_passthroughOutputs.swap(outputs);
+
+        ELOG_DEBUG("Opus passthrough %s: input(%s), outputs(%ld)"
+                , m_passthroughOutputs.empty() ? "off" : "on"
+                , soleInput->name().c_str()
+                , m_passthroughOutputs.size());
+    }
+}
+
+// Forward mode's per-tick routing: rank the voice-active opus inputs -
+// by the sender-reported RFC 6464 level when available, otherwise any
+// voice activity counts - and point each group's opus outputs at the
+// highest-ranked input outside that group, so nobody hears themselves.
+// The relay itself is the existing passthrough machinery: the chosen
+// input forwards its encoded frames to the assigned outputs with
+// timestamps rewritten onto the mixed timeline (see AcmmInput::onFrame),
+// and everything decoder/encoder-shaped stays idle.
+void AcmmFrameMixer::updateForwarding()
+{
+    int64_t now = AudioTime::currentTime();
+
+    struct Ranked {
+        uint16_t groupId;
+        boost::shared_ptr<AcmmInput> input;
+        int32_t score;
+    };
+    std::vector<Ranked> ranked;
+    for (auto& g : m_groups) {
+        std::vector<boost::shared_ptr<AcmmInput>> inputs;
+        g.second->getInputs(inputs);
+        for (auto& input : inputs) {
+            if (input->srcFormat() != FRAME_FORMAT_OPUS)
+                continue;
+
+            if (!input->isVoiceActive(now)) {
+                input->clearPassthroughOutputs();
+                continue;
+            }
+
+            int32_t score = input->reportedScore();
+            ranked.push_back({g.first, input, score >= 0 ? score : 0});
+        }
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(),
+            [](const Ranked &a, const Ranked &b) { return a.score > b.score; });
+
+    std::map<AcmmInput *, std::vector<boost::shared_ptr<AcmmOutput>>> assignments;
+    for (auto& p : m_groups) {
+        std::vector<boost::shared_ptr<AcmmOutput>> outputs;
+        p.second->getOutputs(outputs);
+        if (outputs.empty())
+            continue;
+
+        Ranked *speaker = NULL;
+        for (auto& r : ranked) {
+            if (r.groupId != p.first) {
+                speaker = &r;
+                break;
+            }
+        }
+        if (!speaker)
+            continue;
+
+        for (auto& o : outputs) {
+            if (o->dstFormat() != FRAME_FORMAT_OPUS)
+                continue;
+
+            o->setPassthrough(true);
+            assignments[speaker->input.get()].push_back(o);
+        }
+    }
+
+    for (auto& r : ranked) {
+        std::map<AcmmInput *, std::vector<boost::shared_ptr<AcmmOutput>>>::iterator it =
+                assignments.find(r.input.get());
+        if (it != assignments.end())
+            r.input->setPassthroughOutputs(it->second);
+        else
+            r.input->clearPassthroughOutputs();
+    }
 }
 
 void AcmmFrameMixer::performMix()
 {
+    if (forwardModeEnabled()) {
+        boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
+        updateForwarding();
+        return;
+    }
+
+    {
+        boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
+        updatePassthrough();
+    }
+
+    if (nativeMixEnabled()) {
+        performNativeMix();
+        return;
+    }
+
     boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
     m_mixerModule->Process();
 }
 
+// Native replacement for AudioConferenceMixer::Process(): pulls one 10ms
+// frame per active input at a common frequency (the decoders resample
+// internally), ranks sources by energy and sums the selected ones with the
+// vectorized kernel (see AudioMixKernel.h). Unlike the webrtc module there
+// is no fixed 3-participant mix limit; OWT_AUDIO_MAX_ACTIVE caps the
+// speaker count when set. Sources entering or leaving the mix are
+// gain-ramped across one frame to avoid clicks, and each group with
+// outputs gets the total mix with its own sources subtracted back out.
+void AcmmFrameMixer::performNativeMix()
+{
+    boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
+
+    struct MixSource {
+        uint16_t groupId;
+        AcmmInput *input;
+        uint32_t energy;
+        int32_t gainStart;
+        int32_t gainEnd;
+        AudioFrame frame;
+    };
+
+    int32_t frequency = m_frequency ? m_frequency : 48000;
+    size_t samplesPerChannel = frequency / MIXER_FREQUENCY;
+    size_t channels = 1;
+    int64_t now = AudioTime::currentTime();
+
+    uint32_t maxActive = maxActiveSpeakers();
+
+    struct Candidate {
+        uint16_t groupId;
+        boost::shared_ptr<AcmmInput> input;
+    };
+    std::vector<Candidate> candidates;
+    for (auto& g : m_groups) {
+        std::vector<boost::shared_ptr<AcmmInput>> inputs;
+        g.second->getInputs(inputs);
+        for (auto& input : inputs) {
+            if (!input->isActive())
+                continue;
+
+            // DTX/silent inputs contribute nothing to the sum; skip the
+            // decode pull entirely so a mostly-quiet room only does work
+            // for its speakers.
+            if (!input->isVoiceActive(now))
+                continue;
+
+            candidates.push_back({g.first, input});
+        }
+    }
+
+    // Sender-reported levels (RFC 6464) rank the candidates before any
+    // decode: with the speaker cap on, a reporting input that cannot make
+    // the cut is not decoded at all this tick. Inputs that do not report
+    // levels always decode, since only their samples can tell silence.
+    if (maxActive > 0 && candidates.size() > maxActive) {
+        std::vector<int32_t> reported;
+        for (auto& c : candidates) {
+            int32_t score = c.input->reportedScore();
+            if (score >= 0)
+                reported.push_back(score);
+        }
+
+        if (reported.size() > maxActive) {
+            std::nth_element(reported.begin(), reported.begin() + (maxActive - 1), reported.end(),
+                    [](int32_t a, int32_t b) { return a > b; });
+            int32_t cutoff = reported[maxActive - 1];
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                    [cutoff](const Candidate &c) {
+                        int32_t score = c.input->reportedScore();
+                        return score >= 0 && score < cutoff;
+                    }), candidates.end());
+        }
+    }
+
+    // AudioFrame's sample buffer is large, so the sources live in a list
+    // and never get copied or relocated.
+    std::list<MixSource> sources;
+    for (auto& c : candidates) {
+        sources.emplace_back();
+        MixSource &s = sources.back();
+        s.frame.sample_rate_hz_ = frequency;
+        if (c.input->GetAudioFrame(0, &s.frame) != 0
+                || s.frame.samples_per_channel_ != samplesPerChannel) {
+            sources.pop_back();
+            continue;
+        }
+
+        s.groupId = c.groupId;
+        s.input = c.input.get();
+        // Rank on the smoothed score rather than the raw frame energy:
+        // it is stabler across syllables, and publishing it lets other
+        // threads read per-input activity without the mixer lock.
+        c.input->updateActivityScore(mixEnergy(s.frame.data_, samplesPerChannel * s.frame.num_channels_));
+        s.energy = c.input->activityScore();
+        if (s.frame.num_channels_ > channels)
+            channels = std::min(s.frame.num_channels_, kMaxMixChannels);
+    }
+
+    size_t samples = samplesPerChannel * channels;
+
+    // With nobody speaking every output would encode pure silence each
+    // tick; deliver an occasional flagged keepalive instead and elide the
+    // rest.
+    if (sources.empty()) {
+        m_mixGains.clear();
+        bool keepalive = (m_tickCount % kSilenceKeepaliveTicks) == 0;
+        m_tickCount++;
+
+        if (keepalive) {
+            AudioFrame silentFrame;
+            silentFrame.id_ = -1;
+            silentFrame.sample_rate_hz_ = frequency;
+            silentFrame.num_channels_ = channels;
+            silentFrame.samples_per_channel_ = samplesPerChannel;
+            silentFrame.vad_activity_ = AudioFrame::kVadPassive;
+            memset(silentFrame.data_, 0, samples * sizeof(int16_t));
+
+            for (auto& p : m_groups) {
+                if (p.second->numOfOutputs())
+                    postMixedAudio(p.second, &silentFrame);
+            }
+            m_broadcastGroup->NewMixedAudio(&silentFrame);
+        }
+        return;
+    }
+
+    std::vector<MixSource *> ranked;
+    ranked.reserve(sources.size());
+    for (auto& s : sources)
+        ranked.push_back(&s);
+    std::sort(ranked.begin(), ranked.end(),
+            [](MixSource *a, MixSource *b) { return a->energy > b->energy; });
+
+    size_t numSelected = (maxActive > 0 && ranked.size() > maxActive) ? maxActive : ranked.size();
+
+    // Gains carry over from the previous tick: a source ramps from its last
+    // gain to unity when selected, to silence when not, and a source at
+    // silence on both ends costs nothing below.
+    std::map<void *, int32_t> gains;
+    for (size_t i = 0; i < ranked.size(); i++) {
+        MixSource *s = ranked[i];
+        int32_t target = (i < numSelected) ? 256 : 0;
+        std::map<void *, int32_t>::iterator it = m_mixGains.find(s->input);
+
+        s->gainStart = (it != m_mixGains.end()) ? it->second : 0;
+        s->gainEnd = target;
+        gains[s->input] = target;
+    }
+    m_mixGains.swap(gains);
+
+    int32_t acc[AudioFrame::kMaxDataSizeSamples];
+    memset(acc, 0, samples * sizeof(acc[0]));
+    for (auto& s : sources) {
+        if (s.gainStart == 0 && s.gainEnd == 0)
+            continue;
+
+        // Channel-matched sources take the flat interleaved kernel; a
+        // mismatch (mono into a stereo mix, or a wider source folding
+        // down) goes through the channel-mapping kernel in one pass
+        // instead of rewriting the frame first.
+        if (s.frame.num_channels_ == channels)
+            mixAccumulateRamp(acc, s.frame.data_, samples, s.gainStart, s.gainEnd);
+        else
+            mixAccumulateChannels(acc, s.frame.data_, samplesPerChannel,
+                    s.frame.num_channels_, channels, kUnityChannelGainsQ8,
+                    s.gainStart, s.gainEnd);
+    }
+
+    AudioFrame mixedFrame;
+    mixedFrame.id_ = -1;
+    mixedFrame.sample_rate_hz_ = frequency;
+    mixedFrame.num_channels_ = channels;
+    mixedFrame.samples_per_channel_ = samplesPerChannel;
+    mixedFrame.vad_activity_ = AudioFrame::kVadActive;
+    mixSaturate(mixedFrame.data_, acc, samples);
+
+    size_t contributing = 0;
+    // The mix inherits the oldest ingest stamp among its contributors
+    // (see Frame::ingestTimeMs), so downstream latency reports reflect
+    // the worst path into this tick.
+    int64_t tickIngestMs = 0;
+    for (auto& s : sources) {
+        if (s.gainStart != 0 || s.gainEnd != 0) {
+            contributing++;
+            int64_t ingest = s.input->lastIngestMs();
+            if (ingest && (!tickIngestMs || ingest < tickIngestMs))
+                tickIngestMs = ingest;
+        }
+    }
+
+    AudioFrame uniqueFrame;
+    uniqueFrame.id_ = -1;
+    uniqueFrame.sample_rate_hz_ = frequency;
+    uniqueFrame.num_channels_ = channels;
+    uniqueFrame.samples_per_channel_ = samplesPerChannel;
+
+    int32_t groupAcc[AudioFrame::kMaxDataSizeSamples];
+    for (auto& p : m_groups) {
+        boost::shared_ptr<AcmmGroup> acmmGroup = p.second;
+        if (!acmmGroup->numOfOutputs())
+            continue;
+
+        size_t own = 0;
+        for (auto& s : sources) {
+            if (s.groupId == p.first && (s.gainStart != 0 || s.gainEnd != 0))
+                own++;
+        }
+
+        if (!own) {
+            postMixedAudio(acmmGroup, &mixedFrame, tickIngestMs);
+            continue;
+        }
+
+        // A group holding every mixed source gets pure silence back from
+        // the mix-minus; elide that down to the keepalive cadence too.
+        if (own == contributing && (m_tickCount % kSilenceKeepaliveTicks) != 0)
+            continue;
+
+        uniqueFrame.vad_activity_ = (own == contributing) ? AudioFrame::kVadPassive : AudioFrame::kVadActive;
+
+        // The common steady state is one own speaker at unity gain; fuse
+        // the accumulator copy, subtract and saturate passes into one.
+        MixSource *sole = NULL;
+        if (own == 1) {
+            for (auto& s : sources) {
+                if (s.groupId == p.first && (s.gainStart != 0 || s.gainEnd != 0)) {
+                    sole = &s;
+                    break;
+                }
+            }
+        }
+
+        if (sole && sole->gainStart == 256 && sole->gainEnd == 256
+                && sole->frame.num_channels_ == channels) {
+            mixSubtractSaturate(uniqueFrame.data_, acc, sole->frame.data_, samples);
+        } else {
+            memcpy(groupAcc, acc, samples * sizeof(acc[0]));
+            for (auto& s : sources) {
+                if (s.groupId != p.first || (s.gainStart == 0 && s.gainEnd == 0))
+                    continue;
+
+                // Mirror the accumulate-side kernel choice so the
+                // subtraction replays the exact same arithmetic.
+                if (s.frame.num_channels_ == channels)
+                    mixSubtractRamp(groupAcc, s.frame.data_, samples, s.gainStart, s.gainEnd);
+                else
+                    mixSubtractChannels(groupAcc, s.frame.data_, samplesPerChannel,
+                            s.frame.num_channels_, channels, kUnityChannelGainsQ8,
+                            s.gainStart, s.gainEnd);
+            }
+            mixSaturate(uniqueFrame.data_, groupAcc, samples);
+        }
+        postMixedAudio(acmmGroup, &uniqueFrame, tickIngestMs);
+    }
+
+    m_broadcastGroup->NewMixedAudio(&mixedFrame, tickIngestMs);
+
+    m_tickCount++;
+    if (m_vadEnabled && m_asyncHandle && m_vadPeriodTicks
+            && (m_tickCount % m_vadPeriodTicks) == 0
+            && !ranked.empty() && ranked[0]->energy > 0) {
+        boost::shared_ptr<AcmmInput> activeInput = getInputById(ranked[0]->input->id());
+        if (activeInput && m_mostActiveInput != activeInput) {
+            ELOG_TRACE("Active vad %s -> %s"
+                    , m_mostActiveInput ? m_mostActiveInput->name().c_str() : "NULL"
+                    , activeInput->name().c_str());
+
+            m_mostActiveInput = activeInput;
+            m_asyncHandle->notifyAsyncEvent("vad", m_mostActiveInput->name().c_str());
+        }
+    }
+}
+
+// Hands a group's mixed frame to the worker pool (copy into the group's
+// slot, encode on its strand), or delivers inline when the pool is off.
+// Either way the tick thread's share of the work is attributed to the
+// group for the stats snapshot.
+void AcmmFrameMixer::postMixedAudio(boost::shared_ptr<AcmmGroup> group, const AudioFrame *audioFrame, int64_t ingestTimeMs)
+{
+    uint64_t start = tickNowUs();
+    boost::asio::io_service *service = MixPool::instance().service();
+
+    if (!service) {
+        group->NewMixedAudio(audioFrame, ingestTimeMs);
+    } else {
+        int slot = group->copyPendingFrame(audioFrame, ingestTimeMs);
+        if (slot < 0)
+            return;
+
+        group->strand(*service)->post(boost::bind(&AcmmGroup::deliverPendingFrame, group, slot));
+    }
+
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    m_statGroupUs[group->id()] += tickNowUs() - start;
+}
+
 void AcmmFrameMixer::NewMixedAudio(int32_t id,
         const AudioFrame& generalAudioFrame,
         const AudioFrame** uniqueAudioFrames,
@@ -512,7 +1147,7 @@ void AcmmFrameMixer::NewMixedAudio(int32_t id,
             boost::shared_ptr<AcmmGroup> acmmGroup = m_groups[groupId];
             if (acmmGroup->numOfInputs()) {
                 if (acmmGroup->numOfOutputs()) {
-                    acmmGroup->NewMixedAudio(uniqueAudioFrames[i]);
+                    postMixedAudio(acmmGroup, uniqueAudioFrames[i]);
                 }
 
                 groupMap[groupId] = true;
@@ -524,7 +1159,7 @@ void AcmmFrameMixer::NewMixedAudio(int32_t id,
         boost::shared_ptr<AcmmGroup> acmmGroup = p.second;
         if (groupMap.find(acmmGroup->id()) == groupMap.end()) {
             if (acmmGroup->numOfOutputs()) {
-                acmmGroup->NewMixedAudio(&generalAudioFrame);
+                postMixedAudio(acmmGroup, &generalAudioFrame);
             }
         }
     }
@@ -583,6 +1218,62 @@ void AcmmFrameMixer::VadParticipants(const ParticipantVadStatistics *statistics,
     }
 }
 
+// JSON snapshot of tick timing since the last call, for the agent's stats
+// channel: tick count, average/max duration, deadline misses and the
+// duration histogram from onTimeout, plus per-group delivery time.
+void AcmmFrameMixer::getStatistics(std::string &stats)
+{
+    uint64_t ticks, totalUs, maxUs, misses, hist[5];
+    std::map<uint16_t, uint64_t> groupUs;
+
+    {
+        boost::mutex::scoped_lock lock(m_statsMutex);
+
+        ticks = m_statTicks;
+        totalUs = m_statTotalUs;
+        maxUs = m_statMaxUs;
+        misses = m_statMisses;
+        memcpy(hist, m_statHist, sizeof(hist));
+        groupUs.swap(m_statGroupUs);
+
+        m_statTicks = 0;
+        m_statTotalUs = 0;
+        m_statMaxUs = 0;
+        m_statMisses = 0;
+        memset(m_statHist, 0, sizeof(m_statHist));
+    }
+
+    char head[256];
+    snprintf(head, sizeof(head),
+            "{\"ticks\":%llu,\"avgUs\":%llu,\"maxUs\":%llu,\"deadlineMisses\":%llu,"
+            "\"histUs\":[%llu,%llu,%llu,%llu,%llu],\"groupUs\":{",
+            (unsigned long long)ticks,
+            (unsigned long long)(ticks ? totalUs / ticks : 0),
+            (unsigned long long)maxUs,
+            (unsigned long long)misses,
+            (unsigned long long)hist[0],
+            (unsigned long long)hist[1],
+            (unsigned long long)hist[2],
+            (unsigned long long)hist[3],
+            (unsigned long long)hist[4]);
+    stats = head;
+
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    bool first = true;
+    for (auto& p : m_groupIdMap) {
+        std::map<uint16_t, uint64_t>::iterator it = groupUs.find(p.second);
+        if (it == groupUs.end())
+            continue;
+
+        char entry[160];
+        snprintf(entry, sizeof(entry), "%s\"%s\":%llu",
+                first ? "" : ",", p.first.c_str(), (unsigned long long)it->second);
+        stats += entry;
+        first = false;
+    }
+    stats += "}}";
+}
+
 void AcmmFrameMixer::statistics()
 {
     uint32_t activeCount = 0;
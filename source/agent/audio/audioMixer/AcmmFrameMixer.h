@@ -57,6 +57,8 @@ public:
 
     void setEventRegistry(EventRegistry* handle) override;
 
+    void getStatistics(std::string &stats) override;
+
     // Implements JobTimerListener
     void onTimeout() override;
 
@@ -74,6 +76,11 @@ public:
 
 protected:
     void performMix();
+    void performNativeMix();
+    void updatePassthrough();
+    void updateForwarding();
+
+    void postMixedAudio(boost::shared_ptr<AcmmGroup> group, const AudioFrame *audioFrame, int64_t ingestTimeMs = 0);
 
     bool getFreeGroupId(uint16_t *id);
 
@@ -103,6 +110,28 @@ private:
     bool m_vadEnabled;
     boost::shared_ptr<AcmmInput> m_mostActiveInput;
     int32_t m_frequency;
+
+    // native mix path state (see performNativeMix): per-source Q8 gains
+    // carried across ticks so speakers ramp in and out, and the tick
+    // counter gating VAD notifications.
+    std::map<void *, int32_t> m_mixGains;
+    uint32_t m_vadPeriodTicks;
+    uint32_t m_tickCount;
+
+    // opus passthrough state (see updatePassthrough)
+    boost::shared_ptr<AcmmInput> m_passthroughInput;
+    std::vector<boost::shared_ptr<AcmmOutput>> m_passthroughOutputs;
+
+    // tick instrumentation (see onTimeout): duration histogram, deadline
+    // misses against the 10ms budget, and per-group delivery time.
+    // Snapshot-and-reset on getStatistics.
+    boost::mutex m_statsMutex;
+    uint64_t m_statTicks;
+    uint64_t m_statTotalUs;
+    uint64_t m_statMaxUs;
+    uint64_t m_statMisses;
+    uint64_t m_statHist[5];
+    std::map<uint16_t, uint64_t> m_statGroupUs;
 };
 
 } /* namespace mcu */
@@ -2,8 +2,13 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include "AudioUtilities.h"
+
 #include "AcmmGroup.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace mcu {
 
 using namespace webrtc;
@@ -13,6 +18,9 @@ DEFINE_LOGGER(AcmmGroup, "mcu.media.AcmmGroup");
 
 AcmmGroup::AcmmGroup(uint16_t id)
     : m_groupId(id)
+    , m_pendingIngestMs{0, 0}
+    , m_pendingJobs(0)
+    , m_pendingSlot(0)
 {
     ELOG_DEBUG_T("AcmmGroup(%u)", id);
 
@@ -204,10 +212,20 @@ int32_t AcmmGroup::NeededFrequency()
             neededFreq = freq;
     }
 
+    // Inputs count too: mixing at the native rate of the sources keeps
+    // their decoders resample-free, and outputs below that rate resample
+    // once at encode instead of once per input at decode.
+    for (auto& it : m_inputs) {
+        int32_t freq = getAudioSampleRate(it.second->srcFormat());
+
+        if (neededFreq < freq)
+            neededFreq = freq;
+    }
+
     return neededFreq;
 }
 
-void AcmmGroup::NewMixedAudio(const AudioFrame* audioFrame)
+void AcmmGroup::NewMixedAudio(const AudioFrame* audioFrame, int64_t ingestTimeMs)
 {
     ELOG_TRACE_T("NewMixedAudio, frame id(0x%x), groupId(%u), sample_rate(%d), channels(%ld), samples_per_channel(%ld), timestamp(%d)",
             audioFrame->id_, m_groupId,
@@ -217,10 +235,55 @@ void AcmmGroup::NewMixedAudio(const AudioFrame* audioFrame)
             audioFrame->timestamp_
             );
 
+    // Outputs sharing a format share one encoder (see AcmmOutput::addDest);
+    // feed each encoder once and let its frame fan-out serve every
+    // destination.
+    std::vector<void *> fed;
     for (auto& it : m_outputs) {
         boost::shared_ptr<AcmmOutput> output = it.second;
-        output->newAudioFrame(audioFrame);
+        if (!output->hasDest())
+            continue;
+
+        void *enc = output->encoder();
+        if (enc) {
+            if (std::find(fed.begin(), fed.end(), enc) != fed.end())
+                continue;
+            fed.push_back(enc);
+        }
+
+        output->newAudioFrame(audioFrame, ingestTimeMs);
+    }
+}
+
+int AcmmGroup::copyPendingFrame(const AudioFrame* audioFrame, int64_t ingestTimeMs)
+{
+    // With at most two jobs outstanding and alternating slots, the slot
+    // written here is never one a worker is still encoding from.
+    if (m_pendingJobs.load() >= 2) {
+        ELOG_DEBUG_T("Mix pool behind, dropping frame");
+        return -1;
     }
+
+    int slot = m_pendingSlot;
+    m_pendingSlot ^= 1;
+    m_pendingFrames[slot].CopyFrom(*audioFrame);
+    m_pendingIngestMs[slot] = ingestTimeMs;
+    m_pendingJobs.fetch_add(1);
+    return slot;
+}
+
+void AcmmGroup::deliverPendingFrame(int slot)
+{
+    NewMixedAudio(&m_pendingFrames[slot], m_pendingIngestMs[slot]);
+    m_pendingJobs.fetch_sub(1);
+}
+
+boost::asio::io_service::strand *AcmmGroup::strand(boost::asio::io_service &service)
+{
+    if (!m_strand)
+        m_strand.reset(new boost::asio::io_service::strand(service));
+
+    return m_strand.get();
 }
 
 } /* namespace mcu */
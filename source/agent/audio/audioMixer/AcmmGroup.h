@@ -5,6 +5,9 @@
 #ifndef AcmmGroup_h
 #define AcmmGroup_h
 
+#include <atomic>
+
+#include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -49,11 +52,23 @@ public:
     boost::shared_ptr<AcmmOutput> addOutput(const std::string& outStream);
     void removeOutput(const std::string& outStream);
 
+    // per-format shared-encoder registry handed to AcmmOutput::addDest
+    AcmmOutput::EncoderMap *sharedEncoders() {return &m_sharedEncoders;}
+
     bool allInputsMuted();
     bool anyOutputsConnected();
 
     int32_t NeededFrequency();
-    void NewMixedAudio(const AudioFrame* audioFrame);
+    void NewMixedAudio(const AudioFrame* audioFrame, int64_t ingestTimeMs = 0);
+
+    // Parallel delivery support (see AcmmFrameMixer::postMixedAudio): the
+    // tick thread copies the mixed frame into one of two slots and the
+    // worker pool encodes it later, one strand per group so per-group
+    // ordering holds. Returns the slot, or -1 when both slots are still
+    // pending (pool more than a tick behind) and the frame is dropped.
+    int copyPendingFrame(const AudioFrame* audioFrame, int64_t ingestTimeMs = 0);
+    void deliverPendingFrame(int slot);
+    boost::asio::io_service::strand *strand(boost::asio::io_service &service);
 
 protected:
     bool getFreeInputId(uint16_t *id);
@@ -62,6 +77,12 @@ protected:
 private:
     uint16_t m_groupId;
 
+    boost::scoped_ptr<boost::asio::io_service::strand> m_strand;
+    webrtc::AudioFrame m_pendingFrames[2];
+    int64_t m_pendingIngestMs[2];
+    std::atomic<uint32_t> m_pendingJobs;
+    int m_pendingSlot;
+
     std::vector<bool> m_inputIds;
     std::map<std::string, uint16_t> m_inputIdMap;
     std::map<uint16_t, boost::shared_ptr<AcmmInput>> m_inputs;
@@ -69,6 +90,8 @@ private:
     std::vector<bool> m_outputIds;
     std::map<std::string, uint16_t> m_outputIdMap;
     std::map<uint16_t, boost::shared_ptr<AcmmOutput>> m_outputs;
+
+    AcmmOutput::EncoderMap m_sharedEncoders;
 };
 
 } /* namespace mcu */
@@ -5,8 +5,11 @@
 #include "AcmmInput.h"
 
 #include "AcmDecoder.h"
+#include "AudioCodecWarmPool.h"
 #include "FfDecoder.h"
 
+#include "AudioTime.h"
+
 namespace mcu {
 
 using namespace webrtc;
@@ -36,6 +39,7 @@ bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
 {
     ELOG_DEBUG_T("setSource, format(%s), source(%p)", getFormatStr(format), source);
 
+    bool preInitialized = false;
     switch(format) {
         case FRAME_FORMAT_AAC:
         case FRAME_FORMAT_AAC_48000_2:
@@ -52,20 +56,23 @@ bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
         case FRAME_FORMAT_ILBC:
         case FRAME_FORMAT_G722_16000_1:
         case FRAME_FORMAT_G722_16000_2:
-            m_decoder.reset(new AcmDecoder(format));
+            m_decoder = AudioCodecWarmPool::instance().leaseDecoder(format);
+            preInitialized = !!m_decoder;
+            if (!m_decoder)
+                m_decoder.reset(new AcmDecoder(format));
             break;
         default:
             ELOG_ERROR_T("Unsupported format(%s), %d", getFormatStr(format), format);
             return false;
     }
 
-    if (!m_decoder->init()) {
+    if (!preInitialized && !m_decoder->init()) {
         m_decoder.reset();
         return false;
     }
 
-    source->addAudioDestination(m_decoder.get());
     m_srcFormat = format;
+    source->addAudioDestination(this);
     m_source = source;
     return true;
 }
@@ -74,7 +81,7 @@ void AcmmInput::unsetSource()
 {
     ELOG_DEBUG_T("unsetSource");
 
-    m_source->removeAudioDestination(m_decoder.get());
+    m_source->removeAudioDestination(this);
     m_source = NULL;
     m_srcFormat = FRAME_FORMAT_UNKNOWN;
     m_decoder.reset();
@@ -85,6 +92,83 @@ void AcmmInput::setActive(bool active)
     m_active = active;
 }
 
+bool AcmmInput::isVoiceActive(int64_t nowMs)
+{
+    if (!m_active)
+        return false;
+
+    int64_t last = m_lastVoiceMs.load(std::memory_order_relaxed);
+    return last && (nowMs - last) < kVoiceActiveWindowMs;
+}
+
+void AcmmInput::updateActivityScore(uint32_t energy)
+{
+    // Fast attack, slow decay: a speaker ranks up on the first loud frame
+    // but keeps its rank through short pauses, so the selected set does
+    // not churn on every syllable. Only the tick thread writes.
+    uint32_t score = m_activityScore.load(std::memory_order_relaxed);
+
+    if (energy > score)
+        score = energy;
+    else
+        score -= (score - energy) >> 2;
+
+    m_activityScore.store(score, std::memory_order_relaxed);
+}
+
+void AcmmInput::setPassthroughOutputs(const std::vector<boost::shared_ptr<AcmmOutput>> &outputs)
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_passthroughMutex);
+    m_passthroughOutputs = outputs;
+}
+
+void AcmmInput::clearPassthroughOutputs()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_passthroughMutex);
+    m_passthroughOutputs.clear();
+}
+
+void AcmmInput::onFrame(const owt_base::Frame& frame)
+{
+    // Only opus has DTX here: its filler frames are 2 bytes or less, so
+    // anything bigger is speech. Other formats deliver continuously and
+    // simply count as voice-active while frames flow, which keeps the
+    // passthrough conservative around them.
+    if (frame.format != FRAME_FORMAT_OPUS || frame.length > 2)
+        m_lastVoiceMs.store(AudioTime::currentTime(), std::memory_order_relaxed);
+
+    if (frame.ingestTimeMs)
+        m_lastIngestMs.store(frame.ingestTimeMs, std::memory_order_relaxed);
+
+    // Same fast-attack/slow-decay shape as updateActivityScore, on the
+    // inverted dBov scale so louder is bigger. Only the delivery thread
+    // writes.
+    if (frame.additionalInfo.audio.hasAudioLevel) {
+        int32_t level = 127 - frame.additionalInfo.audio.audioLevel;
+        int32_t score = m_reportedScore.load(std::memory_order_relaxed);
+
+        if (level < score)
+            level = score - ((score - level) >> 2);
+
+        m_reportedScore.store(level, std::memory_order_relaxed);
+    }
+
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_passthroughMutex);
+        if (!m_passthroughOutputs.empty() && frame.format == m_srcFormat
+                && frame.additionalInfo.audio.sampleRate) {
+            Frame outFrame = frame;
+            outFrame.timeStamp = AudioTime::currentTime() * frame.additionalInfo.audio.sampleRate / 1000;
+
+            for (auto& o : m_passthroughOutputs)
+                o->forwardFrame(outFrame);
+        }
+    }
+
+    if (m_decoder)
+        m_decoder->onFrame(frame);
+}
+
 int32_t AcmmInput::GetAudioFrame(int32_t id, AudioFrame* audio_frame)
 {
     if (!m_active)
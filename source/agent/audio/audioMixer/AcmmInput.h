@@ -5,8 +5,12 @@
 #ifndef AcmmInput_h
 #define AcmmInput_h
 
+#include <atomic>
+#include <vector>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include <webrtc/modules/audio_conference_mixer/include/audio_conference_mixer_defines.h>
 
@@ -15,15 +19,21 @@
 #include "MediaFramePipeline.h"
 
 #include "AudioDecoder.h"
+#include "AcmmOutput.h"
 
 namespace mcu {
 
 using namespace owt_base;
 using namespace webrtc;
 
-class AcmmInput : public MixerParticipant {
+class AcmmInput : public MixerParticipant, public owt_base::FrameDestination {
     DECLARE_LOGGER();
 
+    // An input counts as voice-active while speech frames keep arriving
+    // within this window; opus frames of 2 bytes or less are DTX fillers
+    // and do not refresh it.
+    static const int64_t kVoiceActiveWindowMs = 300;
+
 public:
     AcmmInput(int32_t id, const std::string &name);
     ~AcmmInput();
@@ -38,6 +48,34 @@ public:
 
     void setActive(bool active);
 
+    FrameFormat srcFormat() {return m_srcFormat;}
+    bool isVoiceActive(int64_t nowMs);
+
+    // Smoothed activity score for speaker ranking, fed per tick from the
+    // mixed frame's energy and readable lock-free from any thread.
+    uint32_t activityScore() {return m_activityScore.load(std::memory_order_relaxed);}
+    void updateActivityScore(uint32_t energy);
+
+    // Sender-reported loudness (RFC 6464 audio-level extension), smoothed
+    // like the activity score but available before any decode; -1 while
+    // the publisher has never reported a level.
+    int32_t reportedScore() {return m_reportedScore.load(std::memory_order_relaxed);}
+
+    // Ingest wall-clock stamp of the newest frame this input received
+    // (see Frame::ingestTimeMs); the mixer carries the oldest stamp among
+    // a tick's contributors onto the mixed output.
+    int64_t lastIngestMs() {return m_lastIngestMs.load(std::memory_order_relaxed);}
+
+    // Opus passthrough (see AcmmFrameMixer::updatePassthrough): while the
+    // output list is non-empty, incoming encoded frames relay to them
+    // directly with the timestamp rewritten onto the mixed timeline.
+    void setPassthroughOutputs(const std::vector<boost::shared_ptr<AcmmOutput>> &outputs);
+    void clearPassthroughOutputs();
+
+    // Implements FrameDestination, sits between the source and the decoder
+    // for voice-activity tracking and the passthrough relay.
+    void onFrame(const owt_base::Frame& frame) override;
+
     // Implements MixerParticipant
     int32_t GetAudioFrame(int32_t id, AudioFrame* audioFrame) override;
     int32_t NeededFrequency(int32_t id) const override;
@@ -51,6 +89,14 @@ private:
     FrameFormat m_srcFormat;
     FrameSource *m_source;
 
+    std::atomic<int64_t> m_lastVoiceMs{0};
+    std::atomic<int64_t> m_lastIngestMs{0};
+    std::atomic<uint32_t> m_activityScore{0};
+    std::atomic<int32_t> m_reportedScore{-1};
+
+    std::vector<boost::shared_ptr<AcmmOutput>> m_passthroughOutputs;
+    boost::shared_mutex m_passthroughMutex;
+
     boost::shared_ptr<AudioDecoder> m_decoder;
 };
 
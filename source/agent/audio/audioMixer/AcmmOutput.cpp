@@ -7,6 +7,7 @@
 #include "AcmmOutput.h"
 
 #include "AcmEncoder.h"
+#include "AudioCodecWarmPool.h"
 #include "PcmEncoder.h"
 #include "FfEncoder.h"
 
@@ -20,6 +21,7 @@ DEFINE_LOGGER(AcmmOutput, "mcu.media.AcmmOutput");
 AcmmOutput::AcmmOutput(int32_t id)
     : m_id(id)
     , m_dstFormat(FRAME_FORMAT_UNKNOWN)
+    , m_passthrough(false)
 {
     ELOG_DEBUG_T("AcmmOutput(0x%x)", id);
 }
@@ -35,10 +37,15 @@ AcmmOutput::~AcmmOutput()
     m_encoder.reset();
 }
 
-bool AcmmOutput::addDest(FrameFormat format, FrameDestination* destination)
+bool AcmmOutput::addDest(FrameFormat format, FrameDestination* destination, EncoderMap *sharedEncoders)
 {
     ELOG_DEBUG_T("addDest, format(%s), dest(%p)", getFormatStr(format), destination);
 
+    if (format == FRAME_FORMAT_AAC) {
+        ELOG_WARN_T("FRAME_FORMAT_AAC is deprecated for audio output, using FRAME_FORMAT_AAC_48000_2!");
+        format = FRAME_FORMAT_AAC_48000_2;
+    }
+
     if (m_dstFormat != FRAME_FORMAT_UNKNOWN
             && m_dstFormat != format) {
 
@@ -47,43 +54,58 @@ bool AcmmOutput::addDest(FrameFormat format, FrameDestination* destination)
     }
 
     if (m_dstFormat == FRAME_FORMAT_UNKNOWN) {
-        switch(format) {
-            case FRAME_FORMAT_PCM_48000_2:
-                m_encoder.reset(new PcmEncoder(format));
-                break;
-            case FRAME_FORMAT_AAC:
-                ELOG_WARN_T("FRAME_FORMAT_AAC is deprecated for audio output, using FRAME_FORMAT_AAC_48000_2!");
-                format = FRAME_FORMAT_AAC_48000_2;
-                m_encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
-                break;
-            case FRAME_FORMAT_AAC_48000_2:
-                m_encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
-                break;
-            case FRAME_FORMAT_PCMU:
-            case FRAME_FORMAT_PCMA:
-            case FRAME_FORMAT_OPUS:
-            case FRAME_FORMAT_ISAC16:
-            case FRAME_FORMAT_ISAC32:
-            case FRAME_FORMAT_ILBC:
-            case FRAME_FORMAT_G722_16000_1:
-            case FRAME_FORMAT_G722_16000_2:
-                m_encoder.reset(new AcmEncoder(format));
-                break;
-            default:
-                ELOG_ERROR_T("Unsupported format(%s), %d", getFormatStr(format), format);
-                return false;
+        if (sharedEncoders) {
+            EncoderMap::iterator it = sharedEncoders->find(format);
+            if (it != sharedEncoders->end())
+                m_encoder = it->second.lock();
         }
 
-        if (!m_encoder->init()) {
-            m_encoder.reset();
-            return false;
+        if (m_encoder) {
+            ELOG_DEBUG_T("Reuse shared encoder, format(%s)", getFormatStr(format));
+        } else {
+            bool preInitialized = false;
+            switch(format) {
+                case FRAME_FORMAT_PCM_48000_2:
+                    m_encoder.reset(new PcmEncoder(format));
+                    break;
+                case FRAME_FORMAT_AAC_48000_2:
+                    m_encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
+                    break;
+                case FRAME_FORMAT_PCMU:
+                case FRAME_FORMAT_PCMA:
+                case FRAME_FORMAT_OPUS:
+                case FRAME_FORMAT_ISAC16:
+                case FRAME_FORMAT_ISAC32:
+                case FRAME_FORMAT_ILBC:
+                case FRAME_FORMAT_G722_16000_1:
+                case FRAME_FORMAT_G722_16000_2:
+                    m_encoder = AudioCodecWarmPool::instance().leaseEncoder(format);
+                    preInitialized = !!m_encoder;
+                    if (!m_encoder)
+                        m_encoder.reset(new AcmEncoder(format));
+                    break;
+                default:
+                    ELOG_ERROR_T("Unsupported format(%s), %d", getFormatStr(format), format);
+                    return false;
+            }
+
+            if (!preInitialized && !m_encoder->init()) {
+                m_encoder.reset();
+                return false;
+            }
+
+            if (sharedEncoders)
+                (*sharedEncoders)[format] = m_encoder;
         }
 
         m_dstFormat = format;
     }
 
     m_encoder->addAudioDestination(destination);
-    m_destinations.push_back(destination);
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_destMutex);
+        m_destinations.push_back(destination);
+    }
     return true;
 }
 
@@ -91,7 +113,10 @@ void AcmmOutput::removeDest(FrameDestination* destination)
 {
     ELOG_DEBUG_T("removeDest, dst(%p)", destination);
 
-    m_destinations.remove(destination);
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_destMutex);
+        m_destinations.remove(destination);
+    }
     m_encoder->removeAudioDestination(destination);
 }
 
@@ -103,7 +128,7 @@ int32_t AcmmOutput::NeededFrequency()
     return getAudioSampleRate(m_dstFormat);
 }
 
-bool AcmmOutput::newAudioFrame(const webrtc::AudioFrame *audioFrame)
+bool AcmmOutput::newAudioFrame(const webrtc::AudioFrame *audioFrame, int64_t ingestTimeMs)
 {
     if (!m_destinations.size())
         return true;
@@ -116,11 +141,23 @@ bool AcmmOutput::newAudioFrame(const webrtc::AudioFrame *audioFrame)
             audioFrame->timestamp_
             );
 
+    if (m_passthrough.load())
+        return true;
+
     if (m_encoder) {
+        m_encoder->setIngestTimeMs(ingestTimeMs);
         m_encoder->addAudioFrame(audioFrame);
     }
 
     return true;
 }
 
+void AcmmOutput::forwardFrame(const owt_base::Frame& frame)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_destMutex);
+
+    for (auto dst : m_destinations)
+        dst->onFrame(frame);
+}
+
 } /* namespace mcu */
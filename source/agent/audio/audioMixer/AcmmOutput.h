@@ -5,8 +5,11 @@
 #ifndef AcmmOutput_h
 #define AcmmOutput_h
 
+#include <atomic>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include <webrtc/modules/audio_conference_mixer/include/audio_conference_mixer_defines.h>
 
@@ -28,21 +31,43 @@ public:
     AcmmOutput(int32_t id);
     ~AcmmOutput();
 
+    // Outputs of one group carrying the same format share an encoder: the
+    // group's mix is identical for all of them, so encoding it once and
+    // letting the encoder's frame fan-out serve every destination makes
+    // encode cost O(formats) instead of O(subscribers). The registry lives
+    // in the owning group and holds weak references, so an encoder dies
+    // with its last output.
+    typedef std::map<FrameFormat, boost::weak_ptr<AudioEncoder>> EncoderMap;
+
     int32_t id() {return m_id;}
 
-    bool addDest(FrameFormat format, FrameDestination* destination);
+    FrameFormat dstFormat() {return m_dstFormat;}
+    AudioEncoder *encoder() {return m_encoder.get();}
+
+    bool addDest(FrameFormat format, FrameDestination* destination, EncoderMap *sharedEncoders = NULL);
     void removeDest(FrameDestination* destination);
 
     bool hasDest() {return m_destinations.size() > 0;}
 
     int32_t NeededFrequency();
-    bool newAudioFrame(const webrtc::AudioFrame *audioFrame);
+    bool newAudioFrame(const webrtc::AudioFrame *audioFrame, int64_t ingestTimeMs = 0);
+
+    // Opus passthrough (see AcmmFrameMixer::updatePassthrough): while
+    // engaged the mixed frames bypass the encoder and the active input
+    // relays its encoded frames in via forwardFrame.
+    void setPassthrough(bool enabled) {m_passthrough.store(enabled);}
+    void forwardFrame(const owt_base::Frame& frame);
 
 private:
     int32_t m_id;
 
     FrameFormat m_dstFormat;
     std::list<FrameDestination *> m_destinations;
+    // guards m_destinations against forwardFrame, which runs on the
+    // relaying input's source thread
+    boost::shared_mutex m_destMutex;
+
+    std::atomic<bool> m_passthrough;
 
     boost::shared_ptr<AudioEncoder> m_encoder;
 };
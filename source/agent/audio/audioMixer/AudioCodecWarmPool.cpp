@@ -0,0 +1,167 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdlib>
+
+#include "AudioCodecWarmPool.h"
+
+#include "AcmDecoder.h"
+#include "AcmEncoder.h"
+
+namespace mcu {
+
+using namespace owt_base;
+
+DEFINE_LOGGER(AudioCodecWarmPool, "mcu.media.AudioCodecWarmPool");
+
+// The formats SIP/PSTN calls actually negotiate; other formats are rare
+// enough that inline construction is fine.
+static const FrameFormat kWarmFormats[] = {
+    FRAME_FORMAT_PCMU,
+    FRAME_FORMAT_PCMA,
+    FRAME_FORMAT_OPUS,
+    FRAME_FORMAT_G722_16000_1,
+};
+
+static const int kNumWarmFormats = sizeof(kWarmFormats) / sizeof(kWarmFormats[0]);
+static const uint32_t kDefaultDepthPerFormat = 2;
+
+static uint32_t depthPerFormat()
+{
+    static int depth = -1;
+    if (depth < 0) {
+        const char* env = std::getenv("OWT_AUDIO_WARM_CODEC_DEPTH");
+        depth = (env && env[0]) ? std::atoi(env) : kDefaultDepthPerFormat;
+        if (depth < 0)
+            depth = 0;
+    }
+    return depth;
+}
+
+AudioCodecWarmPool& AudioCodecWarmPool::instance()
+{
+    static AudioCodecWarmPool pool;
+    return pool;
+}
+
+AudioCodecWarmPool::AudioCodecWarmPool()
+    : m_depth(depthPerFormat())
+    , m_running(false)
+{
+    ELOG_DEBUG("AudioCodecWarmPool, depth per format(%u)", m_depth);
+
+    if (m_depth > 0) {
+        m_running = true;
+        m_thread = boost::thread(&AudioCodecWarmPool::replenishLoop, this);
+    }
+}
+
+AudioCodecWarmPool::~AudioCodecWarmPool()
+{
+    if (m_running) {
+        {
+            boost::lock_guard<boost::mutex> guard(m_mutex);
+            m_running = false;
+        }
+        m_cond.notify_one();
+        m_thread.join();
+    }
+}
+
+boost::shared_ptr<AudioDecoder> AudioCodecWarmPool::leaseDecoder(FrameFormat format)
+{
+    boost::shared_ptr<AudioDecoder> decoder;
+
+    {
+        boost::lock_guard<boost::mutex> guard(m_mutex);
+        std::list<boost::shared_ptr<AudioDecoder>>& warmed = m_decoders[format];
+        if (!warmed.empty()) {
+            decoder = warmed.front();
+            warmed.pop_front();
+        }
+    }
+
+    if (decoder) {
+        ELOG_DEBUG("leaseDecoder, format(%s)", getFormatStr(format));
+        m_cond.notify_one();
+    }
+    return decoder;
+}
+
+boost::shared_ptr<AudioEncoder> AudioCodecWarmPool::leaseEncoder(FrameFormat format)
+{
+    boost::shared_ptr<AudioEncoder> encoder;
+
+    {
+        boost::lock_guard<boost::mutex> guard(m_mutex);
+        std::list<boost::shared_ptr<AudioEncoder>>& warmed = m_encoders[format];
+        if (!warmed.empty()) {
+            encoder = warmed.front();
+            warmed.pop_front();
+        }
+    }
+
+    if (encoder) {
+        ELOG_DEBUG("leaseEncoder, format(%s)", getFormatStr(format));
+        m_cond.notify_one();
+    }
+    return encoder;
+}
+
+void AudioCodecWarmPool::replenishLoop()
+{
+    while (true) {
+        FrameFormat format = FRAME_FORMAT_UNKNOWN;
+        bool wantDecoder = false;
+
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+            while (m_running && format == FRAME_FORMAT_UNKNOWN) {
+                for (int i = 0; i < kNumWarmFormats; i++) {
+                    if (m_failedFormats.count(kWarmFormats[i]))
+                        continue;
+                    if (m_decoders[kWarmFormats[i]].size() < m_depth) {
+                        format = kWarmFormats[i];
+                        wantDecoder = true;
+                        break;
+                    }
+                    if (m_encoders[kWarmFormats[i]].size() < m_depth) {
+                        format = kWarmFormats[i];
+                        break;
+                    }
+                }
+                if (format == FRAME_FORMAT_UNKNOWN)
+                    m_cond.wait(lock);
+            }
+            if (!m_running)
+                return;
+        }
+
+        // Construct and initialize outside the lock; leases must never block
+        // on codec setup.
+        if (wantDecoder) {
+            boost::shared_ptr<AudioDecoder> decoder(new AcmDecoder(format));
+            if (decoder->init()) {
+                boost::lock_guard<boost::mutex> guard(m_mutex);
+                m_decoders[format].push_back(decoder);
+            } else {
+                ELOG_WARN("Failed to warm decoder, format(%s)", getFormatStr(format));
+                boost::lock_guard<boost::mutex> guard(m_mutex);
+                m_failedFormats.insert(format);
+            }
+        } else {
+            boost::shared_ptr<AudioEncoder> encoder(new AcmEncoder(format));
+            if (encoder->init()) {
+                boost::lock_guard<boost::mutex> guard(m_mutex);
+                m_encoders[format].push_back(encoder);
+            } else {
+                ELOG_WARN("Failed to warm encoder, format(%s)", getFormatStr(format));
+                boost::lock_guard<boost::mutex> guard(m_mutex);
+                m_failedFormats.insert(format);
+            }
+        }
+    }
+}
+
+} /* namespace mcu */
@@ -0,0 +1,63 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AudioCodecWarmPool_h
+#define AudioCodecWarmPool_h
+
+#include <list>
+#include <map>
+#include <set>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <logger.h>
+
+#include "MediaFramePipeline.h"
+#include "AudioDecoder.h"
+#include "AudioEncoder.h"
+
+namespace mcu {
+
+// Keeps a few constructed and initialized ACM codec instances per
+// call-oriented format (G.711, Opus, G.722) so that call setup leases one
+// instead of paying AudioCodingModule creation and codec registration
+// inline. A background thread refills the pool after each lease, off the
+// setup path, which also flattens allocation spikes under bursty call
+// arrival. Used instances are never put back: decoders hold jitter-buffer
+// history and encoders hold codec state from the previous call, so teardown
+// destroys them and the refill thread warms fresh replacements instead.
+class AudioCodecWarmPool {
+    DECLARE_LOGGER();
+
+public:
+    static AudioCodecWarmPool& instance();
+
+    // Both return null when the format is not warmed or the pool is
+    // momentarily empty; the caller falls back to inline construction.
+    // Leased instances are already init()ed.
+    boost::shared_ptr<AudioDecoder> leaseDecoder(owt_base::FrameFormat format);
+    boost::shared_ptr<AudioEncoder> leaseEncoder(owt_base::FrameFormat format);
+
+private:
+    AudioCodecWarmPool();
+    ~AudioCodecWarmPool();
+
+    void replenishLoop();
+
+    uint32_t m_depth;
+    bool m_running;
+    boost::thread m_thread;
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::map<owt_base::FrameFormat, std::list<boost::shared_ptr<AudioDecoder>>> m_decoders;
+    std::map<owt_base::FrameFormat, std::list<boost::shared_ptr<AudioEncoder>>> m_encoders;
+    // Formats whose warm-up failed once are not retried; the refill loop
+    // would otherwise spin on them.
+    std::set<owt_base::FrameFormat> m_failedFormats;
+};
+
+} /* namespace mcu */
+
+#endif /* AudioCodecWarmPool_h */
@@ -5,6 +5,8 @@
 #ifndef AudioEncoder_h
 #define AudioEncoder_h
 
+#include <atomic>
+
 #include <webrtc/modules/include/module_common_types.h>
 #include "MediaFramePipeline.h"
 
@@ -16,6 +18,17 @@ public:
 
     virtual bool init() = 0;
     virtual bool addAudioFrame(const webrtc::AudioFrame *audioFrame) = 0;
+
+    // Ingest wall-clock stamp of the audio behind the next submitted frame
+    // (see Frame::ingestTimeMs); the mixer sets it just before
+    // addAudioFrame and implementations copy it onto their encoded output.
+    void setIngestTimeMs(int64_t ms) {m_ingestTimeMs.store(ms, std::memory_order_relaxed);}
+
+protected:
+    int64_t ingestTimeMs() {return m_ingestTimeMs.load(std::memory_order_relaxed);}
+
+private:
+    std::atomic<int64_t> m_ingestTimeMs{0};
 };
 
 } /* namespace mcu */
@@ -28,6 +28,10 @@ public:
     virtual void removeOutput(const std::string& group, const std::string& outStream) = 0;
 
     virtual void setEventRegistry(EventRegistry* handle) = 0;
+
+    // Fills |stats| with a JSON snapshot of tick timing since the last
+    // call (see AcmmFrameMixer::getStatistics).
+    virtual void getStatistics(std::string &stats) {stats = "{}";}
 };
 
 } /* namespace mcu */
@@ -0,0 +1,382 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AudioMixKernel.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_AVX2_MIX 1
+#endif
+
+namespace mcu {
+
+// Gain at sample |i| of an |n|-sample linear ramp, Q8.
+static inline int32_t rampGain(int32_t gainStartQ8, int32_t gainEndQ8, size_t i, size_t n)
+{
+    return gainStartQ8 + (int32_t)(((int64_t)(gainEndQ8 - gainStartQ8) * (int64_t)i) / (int64_t)n);
+}
+
+static void accumulateUnityC(int32_t *acc, const int16_t *src, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+        acc[i] += src[i];
+}
+
+static void subtractUnityC(int32_t *acc, const int16_t *src, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+        acc[i] -= src[i];
+}
+
+static void saturateC(int16_t *dst, const int32_t *acc, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++) {
+        int32_t v = acc[i];
+        if (v > 32767)
+            v = 32767;
+        else if (v < -32768)
+            v = -32768;
+        dst[i] = (int16_t)v;
+    }
+}
+
+// One source frame's contribution to one mix frame under the channel
+// mapping: mono fans out, matched maps one-to-one, wider folds down by
+// averaging the source channels assigned to each mix channel.
+static inline int32_t channelSample(const int16_t *frame, size_t srcChannels, size_t dstChannels, size_t d)
+{
+    if (srcChannels == dstChannels)
+        return frame[d];
+
+    if (srcChannels == 1)
+        return frame[0];
+
+    int32_t sum = 0;
+    size_t n = 0;
+    for (size_t s = d; s < srcChannels; s += dstChannels, n++)
+        sum += frame[s];
+    return sum / (int32_t)n;
+}
+
+static void mixChannelsC(int32_t *acc, const int16_t *src, size_t samplesPerChannel,
+        size_t srcChannels, size_t dstChannels, const int32_t *channelGainQ8,
+        int32_t gainStartQ8, int32_t gainEndQ8, int32_t sign)
+{
+    for (size_t f = 0; f < samplesPerChannel; f++) {
+        int32_t ramp = rampGain(gainStartQ8, gainEndQ8, f, samplesPerChannel);
+        const int16_t *frame = src + f * srcChannels;
+
+        for (size_t d = 0; d < dstChannels; d++) {
+            int32_t v = channelSample(frame, srcChannels, dstChannels, d);
+            v = (v * channelGainQ8[d]) >> 8;
+            acc[f * dstChannels + d] += sign * ((v * ramp) >> 8);
+        }
+    }
+}
+
+static void subtractSaturateC(int16_t *dst, const int32_t *acc, const int16_t *src, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++) {
+        int32_t v = acc[i] - src[i];
+        if (v > 32767)
+            v = 32767;
+        else if (v < -32768)
+            v = -32768;
+        dst[i] = (int16_t)v;
+    }
+}
+
+#ifdef HAVE_AVX2_MIX
+
+/*
+ * Compiled for AVX2 via the target attribute so the file builds with the
+ * default flags; only ever reached after the runtime CPU check below.
+ */
+__attribute__((target("avx2")))
+static void accumulateUnityAvx2(int32_t *acc, const int16_t *src, size_t samples)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= samples; i += 16) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(s));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1));
+        __m256i a0 = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *)(acc + i + 8));
+
+        _mm256_storeu_si256((__m256i *)(acc + i), _mm256_add_epi32(a0, lo));
+        _mm256_storeu_si256((__m256i *)(acc + i + 8), _mm256_add_epi32(a1, hi));
+    }
+
+    if (i < samples)
+        accumulateUnityC(acc + i, src + i, samples - i);
+}
+
+__attribute__((target("avx2")))
+static void subtractUnityAvx2(int32_t *acc, const int16_t *src, size_t samples)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= samples; i += 16) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(s));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1));
+        __m256i a0 = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *)(acc + i + 8));
+
+        _mm256_storeu_si256((__m256i *)(acc + i), _mm256_sub_epi32(a0, lo));
+        _mm256_storeu_si256((__m256i *)(acc + i + 8), _mm256_sub_epi32(a1, hi));
+    }
+
+    if (i < samples)
+        subtractUnityC(acc + i, src + i, samples - i);
+}
+
+__attribute__((target("avx2")))
+static void saturateAvx2(int16_t *dst, const int32_t *acc, size_t samples)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= samples; i += 16) {
+        __m256i a0 = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *)(acc + i + 8));
+
+        // packs interleaves the two inputs per 128-bit lane; the permute
+        // restores sample order.
+        __m256i p = _mm256_packs_epi32(a0, a1);
+        p = _mm256_permute4x64_epi64(p, 0xd8);
+
+        _mm256_storeu_si256((__m256i *)(dst + i), p);
+    }
+
+    if (i < samples)
+        saturateC(dst + i, acc + i, samples - i);
+}
+
+__attribute__((target("avx2")))
+static void subtractSaturateAvx2(int16_t *dst, const int32_t *acc, const int16_t *src, size_t samples)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= samples; i += 16) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(s));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1));
+        __m256i a0 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(acc + i)), lo);
+        __m256i a1 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(acc + i + 8)), hi);
+
+        // packs interleaves the two inputs per 128-bit lane; the permute
+        // restores sample order.
+        __m256i p = _mm256_packs_epi32(a0, a1);
+        p = _mm256_permute4x64_epi64(p, 0xd8);
+
+        _mm256_storeu_si256((__m256i *)(dst + i), p);
+    }
+
+    if (i < samples)
+        subtractSaturateC(dst + i, acc + i, src + i, samples - i);
+}
+
+// Mono fan-out to a stereo mix with per-channel gains, the hot channel
+// mismatch. Only reached at steady unity ramp, where the scalar version
+// reduces to ((v * channelGain) >> 8) per destination sample; the
+// contribution is computed positively and added or subtracted so the
+// mix-minus replay cancels exactly.
+__attribute__((target("avx2")))
+static void monoToStereoGainAvx2(int32_t *acc, const int16_t *src, size_t frames,
+        const int32_t *channelGainQ8, bool subtract)
+{
+    __m256i idxLo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    __m256i idxHi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    __m256i gains = _mm256_setr_epi32(channelGainQ8[0], channelGainQ8[1],
+            channelGainQ8[0], channelGainQ8[1], channelGainQ8[0], channelGainQ8[1],
+            channelGainQ8[0], channelGainQ8[1]);
+    size_t f = 0;
+
+    for (; f + 8 <= frames; f += 8) {
+        __m256i s = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + f)));
+        __m256i lo = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_permutevar8x32_epi32(s, idxLo), gains), 8);
+        __m256i hi = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_permutevar8x32_epi32(s, idxHi), gains), 8);
+        __m256i a0 = _mm256_loadu_si256((const __m256i *)(acc + 2 * f));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *)(acc + 2 * f + 8));
+
+        if (subtract) {
+            a0 = _mm256_sub_epi32(a0, lo);
+            a1 = _mm256_sub_epi32(a1, hi);
+        } else {
+            a0 = _mm256_add_epi32(a0, lo);
+            a1 = _mm256_add_epi32(a1, hi);
+        }
+
+        _mm256_storeu_si256((__m256i *)(acc + 2 * f), a0);
+        _mm256_storeu_si256((__m256i *)(acc + 2 * f + 8), a1);
+    }
+
+    if (f < frames)
+        mixChannelsC(acc + 2 * f, src + f, frames - f, 1, 2, channelGainQ8,
+                256, 256, subtract ? -1 : 1);
+}
+
+__attribute__((target("avx2")))
+static uint32_t energyAvx2(const int16_t *src, size_t samples)
+{
+    __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 16 <= samples; i += 16) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        // madd against ones widens pairs of |s| to 32 bits while summing;
+        // 3840 samples of magnitudes keep every lane far from overflow.
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_abs_epi16(s), ones));
+    }
+
+    __m128i lo = _mm256_castsi256_si128(sum);
+    __m128i hi = _mm256_extracti128_si256(sum, 1);
+    __m128i t = _mm_add_epi32(lo, hi);
+    t = _mm_add_epi32(t, _mm_srli_si128(t, 8));
+    t = _mm_add_epi32(t, _mm_srli_si128(t, 4));
+
+    uint32_t total = (uint32_t)_mm_cvtsi128_si32(t);
+    for (; i < samples; i++) {
+        int32_t v = src[i];
+        total += (uint32_t)(v < 0 ? -v : v);
+    }
+
+    return total;
+}
+
+#endif /* HAVE_AVX2_MIX */
+
+static bool avx2Supported()
+{
+#ifdef HAVE_AVX2_MIX
+    static int cached = -1;
+    if (cached < 0)
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+    return cached == 1;
+#else
+    return false;
+#endif
+}
+
+void mixAccumulateRamp(int32_t *acc, const int16_t *src, size_t samples, int32_t gainStartQ8, int32_t gainEndQ8)
+{
+    if (gainStartQ8 == gainEndQ8) {
+        if (gainStartQ8 == 0)
+            return;
+
+        if (gainStartQ8 == 256) {
+#ifdef HAVE_AVX2_MIX
+            if (avx2Supported()) {
+                accumulateUnityAvx2(acc, src, samples);
+                return;
+            }
+#endif
+            accumulateUnityC(acc, src, samples);
+            return;
+        }
+    }
+
+    // Ramps only run during speaker transitions, one 10ms frame at a time;
+    // the scalar loop is fine there.
+    for (size_t i = 0; i < samples; i++)
+        acc[i] += (src[i] * rampGain(gainStartQ8, gainEndQ8, i, samples)) >> 8;
+}
+
+void mixSubtractRamp(int32_t *acc, const int16_t *src, size_t samples, int32_t gainStartQ8, int32_t gainEndQ8)
+{
+    if (gainStartQ8 == gainEndQ8) {
+        if (gainStartQ8 == 0)
+            return;
+
+        if (gainStartQ8 == 256) {
+#ifdef HAVE_AVX2_MIX
+            if (avx2Supported()) {
+                subtractUnityAvx2(acc, src, samples);
+                return;
+            }
+#endif
+            subtractUnityC(acc, src, samples);
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < samples; i++)
+        acc[i] -= (src[i] * rampGain(gainStartQ8, gainEndQ8, i, samples)) >> 8;
+}
+
+void mixSaturate(int16_t *dst, const int32_t *acc, size_t samples)
+{
+#ifdef HAVE_AVX2_MIX
+    if (avx2Supported()) {
+        saturateAvx2(dst, acc, samples);
+        return;
+    }
+#endif
+    saturateC(dst, acc, samples);
+}
+
+void mixAccumulateChannels(int32_t *acc, const int16_t *src, size_t samplesPerChannel,
+        size_t srcChannels, size_t dstChannels, const int32_t *channelGainQ8,
+        int32_t gainStartQ8, int32_t gainEndQ8)
+{
+#ifdef HAVE_AVX2_MIX
+    if (avx2Supported() && srcChannels == 1 && dstChannels == 2
+            && gainStartQ8 == 256 && gainEndQ8 == 256) {
+        monoToStereoGainAvx2(acc, src, samplesPerChannel, channelGainQ8, false);
+        return;
+    }
+#endif
+    mixChannelsC(acc, src, samplesPerChannel, srcChannels, dstChannels, channelGainQ8,
+            gainStartQ8, gainEndQ8, 1);
+}
+
+void mixSubtractChannels(int32_t *acc, const int16_t *src, size_t samplesPerChannel,
+        size_t srcChannels, size_t dstChannels, const int32_t *channelGainQ8,
+        int32_t gainStartQ8, int32_t gainEndQ8)
+{
+#ifdef HAVE_AVX2_MIX
+    if (avx2Supported() && srcChannels == 1 && dstChannels == 2
+            && gainStartQ8 == 256 && gainEndQ8 == 256) {
+        monoToStereoGainAvx2(acc, src, samplesPerChannel, channelGainQ8, true);
+        return;
+    }
+#endif
+    mixChannelsC(acc, src, samplesPerChannel, srcChannels, dstChannels, channelGainQ8,
+            gainStartQ8, gainEndQ8, -1);
+}
+
+void mixSubtractSaturate(int16_t *dst, const int32_t *acc, const int16_t *src, size_t samples)
+{
+#ifdef HAVE_AVX2_MIX
+    if (avx2Supported()) {
+        subtractSaturateAvx2(dst, acc, src, samples);
+        return;
+    }
+#endif
+    subtractSaturateC(dst, acc, src, samples);
+}
+
+uint32_t mixEnergy(const int16_t *src, size_t samples)
+{
+    if (!samples)
+        return 0;
+
+#ifdef HAVE_AVX2_MIX
+    if (avx2Supported())
+        return energyAvx2(src, samples) / samples;
+#endif
+
+    // Sum of magnitudes fits: 3840 samples * 32768 < 2^31.
+    uint32_t sum = 0;
+    for (size_t i = 0; i < samples; i++) {
+        int32_t v = src[i];
+        sum += (uint32_t)(v < 0 ? -v : v);
+    }
+
+    return sum / samples;
+}
+
+} /* namespace mcu */
@@ -0,0 +1,56 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AudioMixKernel_h
+#define AudioMixKernel_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mcu {
+
+// Vectorized primitives for the native mixing path (see
+// AcmmFrameMixer::performNativeMix). Samples accumulate in a 32-bit
+// accumulator and are saturated back to 16 bits once per output, so any
+// number of sources can be summed without intermediate clipping.
+
+// Accumulate |samples| 16-bit samples from |src| into |acc|, applying a
+// linear gain ramp from |gainStartQ8| to |gainEndQ8| (Q8 fixed point,
+// 256 == unity).
+void mixAccumulateRamp(int32_t *acc, const int16_t *src, size_t samples, int32_t gainStartQ8, int32_t gainEndQ8);
+
+// Remove a source previously added with the same gains from |acc|. The
+// subtraction replays the identical per-sample products, so the
+// cancellation is exact; the mix-minus pass uses this to carve a group's
+// own sources back out of the total mix.
+void mixSubtractRamp(int32_t *acc, const int16_t *src, size_t samples, int32_t gainStartQ8, int32_t gainEndQ8);
+
+// Saturate the accumulator back to 16-bit samples.
+void mixSaturate(int16_t *dst, const int32_t *acc, size_t samples);
+
+// Fused mix-minus-one: dst = saturate(acc - src) in a single pass, for
+// the steady-state group with exactly one own source at unity gain. |acc|
+// is read-only, so the caller skips the per-group accumulator copy.
+void mixSubtractSaturate(int16_t *dst, const int32_t *acc, const int16_t *src, size_t samples);
+
+// Channel-aware accumulate/subtract for interleaved frames whose channel
+// count differs from the mix's. A mono source fans out to every mix
+// channel, a wider source folds down by averaging, and each destination
+// channel applies its own Q8 gain on top of the shared ramp - the hook
+// for pan matrices. Subtract replays the identical arithmetic so the
+// mix-minus cancellation stays exact.
+void mixAccumulateChannels(int32_t *acc, const int16_t *src, size_t samplesPerChannel,
+        size_t srcChannels, size_t dstChannels, const int32_t *channelGainQ8,
+        int32_t gainStartQ8, int32_t gainEndQ8);
+void mixSubtractChannels(int32_t *acc, const int16_t *src, size_t samplesPerChannel,
+        size_t srcChannels, size_t dstChannels, const int32_t *channelGainQ8,
+        int32_t gainStartQ8, int32_t gainEndQ8);
+
+// Average sample magnitude, used to rank sources for active-speaker
+// selection.
+uint32_t mixEnergy(const int16_t *src, size_t samples);
+
+} /* namespace mcu */
+
+#endif /* AudioMixKernel_h */
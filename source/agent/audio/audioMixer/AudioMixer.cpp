@@ -113,4 +113,9 @@ void AudioMixer::removeOutput(const std::string& endpoint, const std::string& ou
     return;
 }
 
+void AudioMixer::getStatistics(std::string &stats)
+{
+    m_mixer->getStatistics(stats);
+}
+
 } /* namespace mcu */
@@ -30,6 +30,7 @@ void AudioMixer::Init(Handle<Object> exports, Handle<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "setInputActive", setInputActive);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addOutput", addOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeOutput", removeOutput);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStatistics", getStatistics);
 
   constructor.Reset(isolate, tpl->GetFunction());
   module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -176,3 +177,18 @@ void AudioMixer::removeOutput(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   me->removeOutput(endpointID, streamID);
 }
+
+void AudioMixer::getStatistics(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  AudioMixer* obj = ObjectWrap::Unwrap<AudioMixer>(args.Holder());
+  mcu::AudioMixer* me = obj->me;
+  if (me == nullptr)
+    return;
+
+  std::string stats;
+  me->getStatistics(stats);
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
@@ -4,6 +4,11 @@
 
 #include <rtputils.h>
 
+#include <map>
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
 #include "AudioUtilities.h"
 #include "FfDecoder.h"
 
@@ -14,11 +19,90 @@ using namespace owt_base;
 
 DEFINE_LOGGER(FfDecoder, "mcu.media.FfDecoder");
 
+namespace {
+
+// Process-wide pool of warm resampler contexts keyed by the conversion
+// parameters. swr_init computes the polyphase filter tables, which is the
+// expensive part of bringing a resampler up; parking contexts here on
+// decoder teardown lets join/leave churn reuse them instead of recomputing
+// the same tables for every stream.
+class SwrPool {
+public:
+    static SwrPool& instance()
+    {
+        static SwrPool pool;
+        return pool;
+    }
+
+    struct SwrContext *acquire(enum AVSampleFormat inSampleFormat, int inSampleRate, int inChannels,
+            enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels)
+    {
+        std::string key = makeKey(inSampleFormat, inSampleRate, inChannels,
+                outSampleFormat, outSampleRate, outChannels);
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        std::multimap<std::string, struct SwrContext *>::iterator it = m_contexts.find(key);
+        if (it == m_contexts.end())
+            return NULL;
+
+        struct SwrContext *ctx = it->second;
+        m_contexts.erase(it);
+        return ctx;
+    }
+
+    void release(enum AVSampleFormat inSampleFormat, int inSampleRate, int inChannels,
+            enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels,
+            struct SwrContext *ctx)
+    {
+        // Drop whatever of the old stream is still buffered so the next
+        // user starts clean.
+        int64_t delay = swr_get_delay(ctx, outSampleRate);
+        if (delay > 0)
+            swr_drop_output(ctx, delay);
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_contexts.size() >= kMaxPooled) {
+            swr_free(&ctx);
+            return;
+        }
+
+        m_contexts.insert(std::make_pair(makeKey(inSampleFormat, inSampleRate, inChannels,
+                        outSampleFormat, outSampleRate, outChannels), ctx));
+    }
+
+private:
+    static const size_t kMaxPooled = 16;
+
+    SwrPool() {}
+
+    static std::string makeKey(enum AVSampleFormat inSampleFormat, int inSampleRate, int inChannels,
+            enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels)
+    {
+        char key[64];
+        snprintf(key, sizeof(key), "%d-%d-%d/%d-%d-%d",
+                inSampleFormat, inSampleRate, inChannels,
+                outSampleFormat, outSampleRate, outChannels);
+        return key;
+    }
+
+    boost::mutex m_mutex;
+    std::multimap<std::string, struct SwrContext *> m_contexts;
+};
+
+} /* namespace */
+
+static int pooledGetBuffer(AVCodecContext *ctx, AVFrame *frame, int flags)
+{
+    return static_cast<FfDecoder *>(ctx->opaque)->getPooledBuffer(ctx, frame);
+}
+
 FfDecoder::FfDecoder(const FrameFormat format)
     : m_format(format)
     , m_valid(false)
     , m_decCtx(NULL)
     , m_decFrame(NULL)
+    , m_bufferPool(NULL)
+    , m_bufferPoolSize(0)
     , m_needResample(false)
     , m_swrCtx(nullptr)
     , m_swrSamplesData(nullptr)
@@ -67,7 +151,8 @@ FfDecoder::~FfDecoder()
     }
 
     if (m_swrCtx) {
-        swr_free(&m_swrCtx);
+        SwrPool::instance().release(m_inSampleFormat, m_inSampleRate, m_inChannels,
+                m_outSampleFormat, m_outSampleRate, m_outChannels, m_swrCtx);
         m_swrCtx = NULL;
     }
     if (m_swrSamplesData) {
@@ -89,6 +174,11 @@ FfDecoder::~FfDecoder()
         m_decCtx = NULL;
     }
 
+    if (m_bufferPool) {
+        av_buffer_pool_uninit(&m_bufferPool);
+        m_bufferPool = NULL;
+    }
+
     if (m_input) {
         this->removeAudioDestination(m_input.get());
         m_input.reset();
@@ -166,6 +256,8 @@ bool FfDecoder::initDecoder(FrameFormat format, uint32_t sampleRate, uint32_t ch
     m_decCtx->sample_rate       = sampleRate;
     m_decCtx->channels          = channels;
     m_decCtx->channel_layout    = av_get_default_channel_layout(m_decCtx->channels);
+    m_decCtx->opaque            = this;
+    m_decCtx->get_buffer2       = pooledGetBuffer;
 
     ret = avcodec_open2(m_decCtx, dec , NULL);
     if (ret < 0) {
@@ -188,6 +280,45 @@ bool FfDecoder::initDecoder(FrameFormat format, uint32_t sampleRate, uint32_t ch
     return true;
 }
 
+// Serves decoded sample buffers from a pool sized to the codec's frame
+// size; without this every avcodec_receive_frame costs a malloc/free pair,
+// 100 of them per second per stream.
+int FfDecoder::getPooledBuffer(AVCodecContext *ctx, AVFrame *frame)
+{
+    int channels = frame->channels ? frame->channels : ctx->channels;
+    int ret;
+
+    int size = av_samples_get_buffer_size(NULL, channels, frame->nb_samples,
+            (enum AVSampleFormat)frame->format, 0);
+    if (size < 0)
+        return size;
+
+    if (!m_bufferPool || size > m_bufferPoolSize) {
+        if (m_bufferPool) {
+            ELOG_DEBUG_T("Regrow decode buffer pool %d -> %d", m_bufferPoolSize, size);
+            av_buffer_pool_uninit(&m_bufferPool);
+        }
+
+        m_bufferPool = av_buffer_pool_init(size, NULL);
+        if (!m_bufferPool)
+            return AVERROR(ENOMEM);
+
+        m_bufferPoolSize = size;
+    }
+
+    frame->buf[0] = av_buffer_pool_get(m_bufferPool);
+    if (!frame->buf[0])
+        return AVERROR(ENOMEM);
+
+    ret = av_samples_fill_arrays(frame->data, &frame->linesize[0], frame->buf[0]->data,
+            channels, frame->nb_samples, (enum AVSampleFormat)frame->format, 0);
+    if (ret < 0)
+        return ret;
+
+    frame->extended_data = frame->data;
+    return 0;
+}
+
 bool FfDecoder::initResampler(enum AVSampleFormat inSampleFormat, int inSampleRate, int inChannels,
         enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels)
 {
@@ -209,27 +340,33 @@ bool FfDecoder::initResampler(enum AVSampleFormat inSampleFormat, int inSampleRa
             , outChannels
             );
 
-    m_swrCtx = swr_alloc();
-    if (!m_swrCtx) {
-        ELOG_ERROR_T("Could not allocate resampler context");
-        return false;
-    }
+    m_swrCtx = SwrPool::instance().acquire(inSampleFormat, inSampleRate, inChannels,
+            outSampleFormat, outSampleRate, outChannels);
+    if (m_swrCtx) {
+        ELOG_DEBUG_T("Reuse pooled resampler");
+    } else {
+        m_swrCtx = swr_alloc();
+        if (!m_swrCtx) {
+            ELOG_ERROR_T("Could not allocate resampler context");
+            return false;
+        }
 
-    /* set options */
-    av_opt_set_sample_fmt(m_swrCtx, "in_sample_fmt",      inSampleFormat,       0);
-    av_opt_set_int       (m_swrCtx, "in_sample_rate",     inSampleRate,         0);
-    av_opt_set_int       (m_swrCtx, "in_channel_count",   inChannels,           0);
-    av_opt_set_sample_fmt(m_swrCtx, "out_sample_fmt",     outSampleFormat,    0);
-    av_opt_set_int       (m_swrCtx, "out_sample_rate",    outSampleRate,      0);
-    av_opt_set_int       (m_swrCtx, "out_channel_count",  outChannels,        0);
+        /* set options */
+        av_opt_set_sample_fmt(m_swrCtx, "in_sample_fmt",      inSampleFormat,       0);
+        av_opt_set_int       (m_swrCtx, "in_sample_rate",     inSampleRate,         0);
+        av_opt_set_int       (m_swrCtx, "in_channel_count",   inChannels,           0);
+        av_opt_set_sample_fmt(m_swrCtx, "out_sample_fmt",     outSampleFormat,    0);
+        av_opt_set_int       (m_swrCtx, "out_sample_rate",    outSampleRate,      0);
+        av_opt_set_int       (m_swrCtx, "out_channel_count",  outChannels,        0);
 
-    ret = swr_init(m_swrCtx);
-    if (ret < 0) {
-        ELOG_ERROR_T("Fail to initialize the resampling context, %s", ff_err2str(ret));
+        ret = swr_init(m_swrCtx);
+        if (ret < 0) {
+            ELOG_ERROR_T("Fail to initialize the resampling context, %s", ff_err2str(ret));
 
-        swr_free(&m_swrCtx);
-        m_swrCtx = NULL;
-        return false;
+            swr_free(&m_swrCtx);
+            m_swrCtx = NULL;
+            return false;
+        }
     }
 
     m_swrSamplesCount = 2048;
@@ -412,19 +549,17 @@ void FfDecoder::onFrame(const Frame& frame)
             outFrame.format = FRAME_FORMAT_PCM_48000_2;
             outFrame.payload = reinterpret_cast<uint8_t*>(m_audioFrame->data[0]);
             outFrame.length = m_audioFrame->nb_samples * m_outChannels * 2;
-            outFrame.additionalInfo.audio.isRtpPacket = 0;
             outFrame.additionalInfo.audio.sampleRate = m_outSampleRate;
             outFrame.additionalInfo.audio.channels = m_outChannels;
             outFrame.additionalInfo.audio.nbSamples = m_audioFrame->nb_samples;
             outFrame.timeStamp = m_timestamp * outFrame.additionalInfo.audio.sampleRate / 1000;
 
-            ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d), %s",
+            ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d)",
                     getFormatStr(outFrame.format),
                     outFrame.additionalInfo.audio.sampleRate,
                     outFrame.additionalInfo.audio.channels,
                     outFrame.timeStamp * 1000 / outFrame.additionalInfo.audio.sampleRate,
-                    outFrame.length,
-                    outFrame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
+                    outFrame.length
                     );
 
             deliverFrame(outFrame);
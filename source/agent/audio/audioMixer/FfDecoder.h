@@ -45,6 +45,11 @@ public:
     // Implements owt_base::FrameDestination
     void onFrame(const Frame& frame) override;
 
+    // get_buffer2 target (see pooledGetBuffer in FfDecoder.cpp): serves
+    // the decoder's output sample buffers from an AVBufferPool instead of
+    // a malloc/free pair per 10ms frame.
+    int getPooledBuffer(AVCodecContext *ctx, AVFrame *frame);
+
 protected:
     bool initDecoder(FrameFormat format,uint32_t sampleRate, uint32_t channels);
     bool initResampler(enum AVSampleFormat inFormat, int inSampleRate, int inChannels,
@@ -64,6 +69,9 @@ private:
     AVFrame *m_decFrame;
     AVPacket m_packet;
 
+    AVBufferPool *m_bufferPool;
+    int m_bufferPoolSize;
+
     bool m_needResample;
     struct SwrContext *m_swrCtx;
     uint8_t **m_swrSamplesData;
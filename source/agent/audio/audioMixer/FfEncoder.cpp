@@ -30,8 +30,11 @@ FfEncoder::FfEncoder(const FrameFormat format)
     : m_format(format)
     , m_timestampOffset(0)
     , m_valid(false)
+    , m_vadActive(true)
     , m_channels(0)
     , m_sampleRate(0)
+    , m_opusComplexity(10)
+    , m_opusDtx(false)
     , m_audioEnc(NULL)
     , m_audioFifo(NULL)
     , m_audioFrame(NULL)
@@ -47,6 +50,8 @@ FfEncoder::FfEncoder(const FrameFormat format)
 
     m_sampleRate = getAudioSampleRate(format);
     m_channels = getAudioChannels(format);
+
+    memset(&m_packet, 0, sizeof(m_packet));
 }
 
 FfEncoder::~FfEncoder()
@@ -122,6 +127,23 @@ bool FfEncoder::initEncoder(const FrameFormat format)
     m_audioEnc->sample_fmt      = getCodecPreferedSampleFmt(codec, AV_SAMPLE_FMT_S16);
     m_audioEnc->flags           |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
+    if (format == FRAME_FORMAT_OPUS) {
+        // Defaults match libopus (complexity 10, no DTX); the load governor
+        // lowers them under pressure. Ignore failures, the options may not
+        // exist on every opus encoder implementation.
+        av_opt_set_int(m_audioEnc->priv_data, "complexity", m_opusComplexity, 0);
+        av_opt_set_int(m_audioEnc->priv_data, "dtx", m_opusDtx ? 1 : 0, 0);
+
+        // In-band FEC needs both knobs: "fec" switches the redundancy on
+        // and "packet_loss" tells libopus how much bitrate to spend on it.
+        // Older ffmpeg wrappers only expose "packet_loss".
+        int lossRate = getAudioFecPacketLossRate();
+        if (lossRate > 0) {
+            av_opt_set_int(m_audioEnc->priv_data, "fec", 1, 0);
+            av_opt_set_int(m_audioEnc->priv_data, "packet_loss", lossRate, 0);
+        }
+    }
+
     ret = avcodec_open2(m_audioEnc, codec, nullptr);
     if (ret < 0) {
         ELOG_ERROR_T("Cannot open output audio codec, %s", ff_err2str(ret));
@@ -216,8 +238,6 @@ bool FfEncoder::addToFifo(const AudioFrame* audioFrame)
 
 void FfEncoder::encode()
 {
-    AVPacket pkt;
-    memset(&pkt, 0, sizeof(pkt));
     while (av_audio_fifo_size(m_audioFifo) >= m_audioEnc->frame_size) {
         int ret;
         int32_t n;
@@ -234,15 +254,15 @@ void FfEncoder::encode()
             return;
         }
 
-        av_init_packet(&pkt);
-        ret = avcodec_receive_packet(m_audioEnc, &pkt);
+        av_init_packet(&m_packet);
+        ret = avcodec_receive_packet(m_audioEnc, &m_packet);
         if (ret < 0) {
             ELOG_ERROR("avcodec_receive_packet, %s", ff_err2str(ret));
             return;
         }
 
-        sendOut(pkt);
-        av_packet_unref(&pkt);
+        sendOut(m_packet);
+        av_packet_unref(&m_packet);
     }
 }
 
@@ -256,15 +276,16 @@ void FfEncoder::sendOut(AVPacket &pkt)
     frame.additionalInfo.audio.nbSamples = m_audioEnc->frame_size;
     frame.additionalInfo.audio.sampleRate = m_audioEnc->sample_rate;
     frame.additionalInfo.audio.channels = m_audioEnc->channels;
+    frame.additionalInfo.audio.voiceActivity = m_vadActive ? 1 : 0;
     frame.timeStamp = (AudioTime::currentTime()) * frame.additionalInfo.audio.sampleRate / 1000;
+    frame.ingestTimeMs = ingestTimeMs();
 
-    ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d), %s",
+    ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d)",
             getFormatStr(frame.format),
             frame.additionalInfo.audio.sampleRate,
             frame.additionalInfo.audio.channels,
             frame.timeStamp * 1000 / frame.additionalInfo.audio.sampleRate,
-            frame.length,
-            frame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
+            frame.length
             );
 
     deliverFrame(frame);
@@ -279,13 +300,75 @@ bool FfEncoder::addAudioFrame(const AudioFrame* audioFrame)
         return false;
     }
 
+    m_vadActive = (audioFrame->vad_activity_ != AudioFrame::kVadPassive);
+
     if (!addToFifo(audioFrame))
         return false;
 
-    encode();
+    if (EncoderLoadGovernor::enabled() && m_format == FRAME_FORMAT_OPUS) {
+        timespec encodeStart, encodeEnd;
+        clock_gettime(CLOCK_MONOTONIC, &encodeStart);
+
+        encode();
+
+        clock_gettime(CLOCK_MONOTONIC, &encodeEnd);
+        int64_t encodeTimeUs = (encodeEnd.tv_sec - encodeStart.tv_sec) * 1000000
+            + (encodeEnd.tv_nsec - encodeStart.tv_nsec) / 1000;
+
+        // Mixed audio arrives in 10ms chunks, so the budget is 100/s.
+        adaptOpusComplexity(m_loadGovernor.onEncodedFrame(encodeTimeUs, 100));
+    } else {
+        encode();
+    }
+
     return true;
 }
 
+void FfEncoder::adaptOpusComplexity(EncoderLoadGovernor::Adaptation step)
+{
+    int complexity = m_opusComplexity;
+    bool dtx = m_opusDtx;
+
+    switch (step) {
+        case EncoderLoadGovernor::ADAPT_FASTER:
+            if (complexity > 2)
+                complexity -= 2;
+            else
+                dtx = true;
+            break;
+        case EncoderLoadGovernor::ADAPT_SLOWER:
+            if (dtx)
+                dtx = false;
+            else if (complexity < 10)
+                complexity += 2;
+            break;
+        default:
+            return;
+    }
+
+    if (complexity == m_opusComplexity && dtx == m_opusDtx)
+        return;
+
+    m_opusComplexity = complexity;
+    m_opusDtx = dtx;
+
+    // libopus only reads its options at open time; the governor's cooldown
+    // spaces reopens far enough apart that losing the few samples buffered
+    // in the fifo is inaudible.
+    if (m_audioEnc) {
+        avcodec_close(m_audioEnc);
+        m_audioEnc = NULL;
+    }
+
+    if (!initEncoder(m_format)) {
+        ELOG_ERROR_T("Cannot reopen encoder at complexity %d", m_opusComplexity);
+        m_valid = false;
+        return;
+    }
+
+    ELOG_INFO_T("Opus complexity %d, DTX %s", m_opusComplexity, m_opusDtx ? "on" : "off");
+}
+
 
 char *FfEncoder::ff_err2str(int errRet)
 {
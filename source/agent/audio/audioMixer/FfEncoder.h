@@ -12,6 +12,7 @@
 
 #include <logger.h>
 
+#include "EncoderLoadGovernor.h"
 #include "MediaFramePipeline.h"
 #include "AudioEncoder.h"
 
@@ -42,6 +43,7 @@ public:
 protected:
     bool initEncoder(const FrameFormat format);
     bool addToFifo(const AudioFrame* audioFrame);
+    void adaptOpusComplexity(EncoderLoadGovernor::Adaptation step);
     void encode();
     void sendOut(AVPacket &pkt);
     char *ff_err2str(int errRet);
@@ -51,13 +53,21 @@ private:
 
     uint32_t m_timestampOffset;
     bool m_valid;
+    bool m_vadActive;
 
     int32_t m_channels;
     int32_t m_sampleRate;
 
+    // Opus only: libopus reads these at open time, so each governor step
+    // reopens the encoder (see adaptOpusComplexity).
+    EncoderLoadGovernor m_loadGovernor;
+    int m_opusComplexity;
+    bool m_opusDtx;
+
     AVCodecContext* m_audioEnc;
     AVAudioFifo* m_audioFifo;
     AVFrame* m_audioFrame;
+    AVPacket m_packet;
 
     char m_errbuff[500];
 };
@@ -0,0 +1,248 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Scaling benchmark for AcmmFrameMixer: instantiates the mixer with N
+// synthetic Opus inputs and M Opus outputs and sweeps (N, M), reporting
+// per combination the tick-duration stats the mixer already collects
+// (average/max tick, deadline misses against the 10ms budget) plus
+// process CPU from getrusage. The capacity of an audio node per release
+// is then a measured number instead of folklore.
+//
+// Input audio is a tone encoded once per tick by a real AcmEncoder and
+// fanned out to every input, so each input pays its full AcmDecoder
+// cost — the dominant per-input term — while the bench itself stays
+// cheap. Outputs are spread round-robin across the input groups, which
+// reproduces the per-participant mix-minus encode load.
+//
+// Usage:
+//   MixerBench [--inputs 4,16,64] [--outputs 4,16,64] [--seconds 5]
+//
+// Build: uncomment the MixerBench target in binding.gyp.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <webrtc/modules/include/module_common_types.h>
+
+#include "AcmEncoder.h"
+#include "AcmmFrameMixer.h"
+#include "MediaFramePipeline.h"
+
+using namespace mcu;
+using namespace owt_base;
+
+static int64_t monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t cpuUs()
+{
+    rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (int64_t)ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec
+         + (int64_t)ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec;
+}
+
+// FrameSource handing the shared encoded tone to one mixer input.
+class SyntheticSource : public FrameSource {
+public:
+    void push(const Frame& frame) { deliverFrame(frame); }
+};
+
+// Catches the encoder's Opus frames and fans them out to every input.
+class ToneFanout : public FrameDestination {
+public:
+    ToneFanout(std::vector<SyntheticSource>& sources)
+        : m_sources(sources)
+    {
+    }
+
+    void onFrame(const Frame& frame)
+    {
+        for (size_t i = 0; i < m_sources.size(); ++i)
+            m_sources[i].push(frame);
+    }
+
+private:
+    std::vector<SyntheticSource>& m_sources;
+};
+
+// Swallows mixed output frames; the encode work has happened by then.
+class NullSink : public FrameDestination {
+public:
+    NullSink() : m_frames(0) { }
+    void onFrame(const Frame& frame) { m_frames++; }
+    uint64_t frames() const { return m_frames; }
+
+private:
+    uint64_t m_frames;
+};
+
+static std::string groupName(uint32_t i)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "bench%04u", i);
+    return name;
+}
+
+// One (N, M) combination: real mixer, real timer, real codecs. Returns
+// false if setup failed (e.g. codec init), which ends the sweep early.
+static bool runCombination(uint32_t inputs, uint32_t outputs, uint32_t seconds)
+{
+    AcmmFrameMixer mixer;
+    std::vector<SyntheticSource> sources(inputs);
+    ToneFanout fanout(sources);
+    NullSink sink;
+
+    for (uint32_t i = 0; i < inputs; ++i) {
+        if (!mixer.addInput(groupName(i), "in", FRAME_FORMAT_OPUS, &sources[i])) {
+            fprintf(stderr, "addInput %u failed\n", i);
+            return false;
+        }
+    }
+    for (uint32_t j = 0; j < outputs; ++j) {
+        if (!mixer.addOutput(groupName(j % (inputs ? inputs : 1)), "out",
+                FRAME_FORMAT_OPUS, &sink)) {
+            fprintf(stderr, "addOutput %u failed\n", j);
+            return false;
+        }
+    }
+
+    AcmEncoder toneEncoder(FRAME_FORMAT_OPUS);
+    if (!toneEncoder.init()) {
+        fprintf(stderr, "tone encoder init failed\n");
+        return false;
+    }
+    toneEncoder.addAudioDestination(&fanout);
+
+    // discard the first second so codec warm-up does not skew the stats
+    std::string warmup;
+    int64_t start = monotonicUs();
+    int64_t cpuStart = 0;
+    int64_t endAt = start + (int64_t)(seconds + 1) * 1000000;
+
+    static const int kSampleRate = 48000;
+    static const size_t kChannels = 2;
+    static const size_t kSamplesPerChannel = kSampleRate / 100;
+    int16_t samples[kSamplesPerChannel * kChannels];
+    webrtc::AudioFrame audioFrame;
+    uint32_t timestamp = 0;
+    double phase = 0;
+    uint64_t tick = 0;
+
+    while (monotonicUs() < endAt) {
+        // -12dBFS 440Hz tone: loud enough that Opus DTX never engages and
+        // every input carries real speech-like decode load.
+        for (size_t s = 0; s < kSamplesPerChannel; ++s) {
+            int16_t v = (int16_t)(8192.0 * sin(phase));
+            phase += 2.0 * M_PI * 440.0 / kSampleRate;
+            for (size_t c = 0; c < kChannels; ++c)
+                samples[s * kChannels + c] = v;
+        }
+        audioFrame.UpdateFrame(-1, timestamp, samples, kSamplesPerChannel,
+                kSampleRate, webrtc::AudioFrame::kNormalSpeech,
+                webrtc::AudioFrame::kVadActive, kChannels);
+        timestamp += kSamplesPerChannel;
+        toneEncoder.addAudioFrame(&audioFrame);
+
+        tick++;
+        if (tick == 100) {
+            // warm-up over: reset the mixer's counters and CPU baseline
+            mixer.getStatistics(warmup);
+            cpuStart = cpuUs();
+        }
+
+        int64_t due = start + (int64_t)tick * 10000;
+        int64_t ahead = due - monotonicUs();
+        if (ahead > 0)
+            usleep(ahead);
+    }
+
+    int64_t usedCpuUs = cpuUs() - cpuStart;
+    std::string stats;
+    mixer.getStatistics(stats);
+
+    // strip the per-group tail; it is noise at bench group counts
+    size_t cut = stats.find(",\"groupUs\"");
+    if (cut != std::string::npos)
+        stats = stats.substr(0, cut) + "}";
+
+    printf("N=%-4u M=%-4u cpu=%5.1f%%  %s\n", inputs, outputs,
+            100.0 * usedCpuUs / ((int64_t)seconds * 1000000), stats.c_str());
+    fflush(stdout);
+
+    for (uint32_t j = 0; j < outputs; ++j)
+        mixer.removeOutput(groupName(j % (inputs ? inputs : 1)), "out");
+    for (uint32_t i = 0; i < inputs; ++i)
+        mixer.removeInput(groupName(i), "in");
+    toneEncoder.removeAudioDestination(&fanout);
+
+    return true;
+}
+
+static bool parseList(const char* spec, std::vector<uint32_t>& out)
+{
+    out.clear();
+    const char* p = spec;
+    while (*p) {
+        char* end = NULL;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0)
+            return false;
+        out.push_back(n);
+        p = end;
+        if (*p == ',')
+            ++p;
+    }
+    return !out.empty();
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<uint32_t> inputs;
+    std::vector<uint32_t> outputs;
+    uint32_t seconds = 5;
+    parseList("4,16,64", inputs);
+    parseList("4,16,64", outputs);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = false;
+        if (arg == "--inputs" && value) {
+            ok = parseList(value, inputs); ++i;
+        } else if (arg == "--outputs" && value) {
+            ok = parseList(value, outputs); ++i;
+        } else if (arg == "--seconds" && value) {
+            seconds = atoi(value); ok = seconds > 0; ++i;
+        }
+        if (!ok) {
+            fprintf(stderr,
+                "usage: %s [--inputs n,n,...] [--outputs m,m,...] [--seconds s]\n",
+                argv[0]);
+            return 1;
+        }
+    }
+
+    printf("mixer scaling sweep, %us per combination, 10ms tick budget\n", seconds);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        for (size_t j = 0; j < outputs.size(); ++j) {
+            if (!runCombination(inputs[i], outputs[j], seconds))
+                return 1;
+        }
+    }
+
+    return 0;
+}
@@ -79,15 +79,16 @@ bool PcmEncoder::addAudioFrame(const AudioFrame* audioFrame)
     frame.additionalInfo.audio.nbSamples = audioFrame->samples_per_channel_;
     frame.additionalInfo.audio.sampleRate = audioFrame->sample_rate_hz_;
     frame.additionalInfo.audio.channels = audioFrame->num_channels_;
+    frame.additionalInfo.audio.voiceActivity = (audioFrame->vad_activity_ != AudioFrame::kVadPassive) ? 1 : 0;
     frame.timeStamp = (AudioTime::currentTime()) * frame.additionalInfo.audio.sampleRate / 1000;
+    frame.ingestTimeMs = ingestTimeMs();
 
-    ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d), %s",
+    ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d)",
             getFormatStr(frame.format),
             frame.additionalInfo.audio.sampleRate,
             frame.additionalInfo.audio.channels,
             frame.timeStamp * 1000 / frame.additionalInfo.audio.sampleRate,
-            frame.length,
-            frame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
+            frame.length
             );
 
     deliverFrame(frame);
@@ -8,6 +8,7 @@
       'AcmDecoder.cpp',
       'FfDecoder.cpp',
       'AcmEncoder.cpp',
+      'AudioCodecWarmPool.cpp',
       'PcmEncoder.cpp',
       'FfEncoder.cpp',
       'AcmmFrameMixer.cpp',
@@ -15,10 +16,12 @@
       'AcmmGroup.cpp',
       'AcmmInput.cpp',
       'AcmmOutput.cpp',
+      'AudioMixKernel.cpp',
       'AudioTime.cpp',
       '../../addons/common/NodeEventRegistry.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/owt_base/AudioUtilities.cpp',
+      '../../../core/owt_base/EncoderLoadGovernor.cpp',
     ],
     'cflags_cc': [
         '-Wall',
@@ -43,5 +46,53 @@
       '<!@(pkg-config --libs libavformat)',
       '<!@(pkg-config --libs libavutil)',
     ],
-  }]
+  },
+# not build bench target
+#  {
+#    'target_name': 'MixerBench',
+#    'type' : 'executable',
+#    'sources': [
+#      'MixerBench.cpp',
+#      'AcmDecoder.cpp',
+#      'FfDecoder.cpp',
+#      'AcmEncoder.cpp',
+#      'AudioCodecWarmPool.cpp',
+#      'PcmEncoder.cpp',
+#      'FfEncoder.cpp',
+#      'AcmmFrameMixer.cpp',
+#      'AcmmBroadcastGroup.cpp',
+#      'AcmmGroup.cpp',
+#      'AcmmInput.cpp',
+#      'AcmmOutput.cpp',
+#      'AudioMixKernel.cpp',
+#      'AudioTime.cpp',
+#      '../../../core/owt_base/MediaFramePipeline.cpp',
+#      '../../../core/owt_base/AudioUtilities.cpp',
+#      '../../../core/owt_base/EncoderLoadGovernor.cpp',
+#    ],
+#    'cflags_cc': [
+#        '-Wall',
+#        '-O$(OPTIMIZATION_LEVEL)',
+#        '-g',
+#        '-std=c++11',
+#        '-DWEBRTC_POSIX',
+#    ],
+#    'cflags_cc!': [
+#        '-fno-exceptions',
+#    ],
+#    'include_dirs': [ '$(CORE_HOME)/common',
+#                      '$(CORE_HOME)/owt_base',
+#                      '$(CORE_HOME)/../../third_party/webrtc/src',
+#                      '$(CORE_HOME)/../../build/libdeps/build/include',
+#    ],
+#    'libraries': [
+#      '-L$(CORE_HOME)/../../third_party/webrtc', '-lwebrtc',
+#      '-lboost_thread',
+#      '-llog4cxx',
+#      '<!@(pkg-config --libs libavcodec)',
+#      '<!@(pkg-config --libs libavformat)',
+#      '<!@(pkg-config --libs libavutil)',
+#    ],
+#  }
+  ]
 }
@@ -3,11 +3,16 @@
 // SPDX-License-Identifier: Apache-2.0
 
 'use strict';
-var internalIO = require('../internalIO/build/Release/internalIO');
-var InternalIn = internalIO.In;
-var InternalOut = internalIO.Out;
-var MediaFrameMulticaster = require('../mediaFrameMulticaster/build/Release/mediaFrameMulticaster');
-var AudioMixer = require('../audioMixer/build/Release/audioMixer');
+// Addon dlopen+init dominates workingNode spawn time, so the native addons
+// load on first use; warmup below preloads them off the spawn path once the
+// node has reported READY, ahead of the room's init call.
+var MediaFrameMulticaster, AudioMixer;
+function loadAddons() {
+    if (!AudioMixer) {
+        MediaFrameMulticaster = require('../mediaFrameMulticaster/build/Release/mediaFrameMulticaster');
+        AudioMixer = require('../audioMixer/build/Release/audioMixer');
+    }
+}
 
 var logger = require('../logger').logger;
 
@@ -82,6 +87,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
     var addOutput = function (for_whom, codec, on_ok, on_error) {
         var stream_id = Math.random() * 1000000000000000000 + '';
         if (engine) {
+            loadAddons();
             var dispatcher = new MediaFrameMulticaster();
             if (engine.addOutput(for_whom, stream_id, codec, dispatcher)) {
                 outputs[stream_id] = {for_whom: for_whom,
@@ -112,6 +118,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
     };
 
     var initEngine = function (config, belongToRoom, ctrlr, callback) {
+        loadAddons();
         engine = new AudioMixer(JSON.stringify(config));
         belong_to_room = belongToRoom;
         controller = ctrlr;
@@ -283,6 +290,19 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         engine.resetVAD();
     };
 
+    that.getStatistics = function (callback) {
+        if (engine) {
+            try {
+                callback('callback', JSON.parse(engine.getStatistics()));
+            } catch (e) {
+                log.warn('getStatistics failed:', e);
+                callback('callback', 'error', 'Failed to collect statistics.');
+            }
+        } else {
+            callback('callback', 'error', 'Audio-mixer engine is not ready.');
+        }
+    };
+
     that.init = function (service, config, belongToRoom, controller, mixView, callback) {
         var audioConfig = global.config.audio || {};
         log.debug('init, audioConfig:', audioConfig);
@@ -319,5 +339,19 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         }
     };
 
+    // Called by workingNode after READY: an audio node always ends up
+    // mixing, so preload everything before the room's init call arrives.
+    that.warmup = function () {
+        InternalConnectionFactory.preload();
+        loadAddons();
+        // Pre-bind listen sockets for the cluster-default transport so the
+        // first subscribe's create RPC does not pay the bind.
+        internalConnFactory.prewarm({
+            protocol: 'tcp',
+            minport: global.config.internal.minport,
+            maxport: global.config.internal.maxport
+        }, 2);
+    };
+
     return that;
 };
@@ -147,6 +147,25 @@ class BaseAgent {
     return this.connections.cutoffConnection(connectionId);
   }
 
+  /**
+    *@function relink
+    *@param {string} connectionId
+    *@param {string} audioFrom
+    *@param {string} videoFrom
+    */
+  relink(connectionId, audioFrom, videoFrom) {
+    log.debug('relink, connectionId:', connectionId);
+    return this.connections.relinkConnection(connectionId, audioFrom, videoFrom);
+  }
+
+  /**
+    *@function getStatsSummary
+    *@return {object} per-node roll-up of the connections' counters
+    */
+  getStatsSummary() {
+    return this.connections.getStatsSummary();
+  }
+
   cleanup() {
     log.debug('cleanup called');
     var cleans = connections.getIds().map((connId) => {
@@ -367,6 +367,7 @@ var Conference = function (rpcClient, selfRpcId) {
             //log.debug('initializing room:', roomId, 'got config:', JSON.stringify(config));
             room_config = config;
             room_config.internalConnProtocol = global.config.internal.protocol;
+            room_config.spreadTreeFanout = global.config.internal.spread_tree_fanout;
 
             return new Promise(function(resolve, reject) {
               RoomController.create(
@@ -481,18 +482,37 @@ var Conference = function (rpcClient, selfRpcId) {
     }
   };
 
+  // Group the recipients by their portal and send one 'broadcast' rpc per
+  // portal, so a room-wide event costs one message per portal node instead
+  // of one per participant, and the portal can serialize it once for all
+  // of its sockets.
+  const broadcastMsg = function(excludeId, msg, data) {
+    var recipientsByPortal = {};
+    for (var participant_id in participants) {
+      if (participant_id === 'admin' || participant_id === excludeId) {
+        continue;
+      }
+      var portal = participants[participant_id].getPortal();
+      if (portal) {
+        recipientsByPortal[portal] = recipientsByPortal[portal] || [];
+        recipientsByPortal[portal].push(participant_id);
+      }
+    }
+
+    for (var target_portal in recipientsByPortal) {
+      rpcReq.broadcastMsg(target_portal, recipientsByPortal[target_portal], msg, data)
+        .catch(function(reason) {
+          log.debug('broadcastMsg fail:', reason);
+        });
+    }
+  };
+
   const sendMsg = function(from, to, msg, data) {
     log.debug('sendMsg, from:', from, 'to:', to, 'msg:', msg, 'data:', data);
     if (to === 'all') {
-      for (var participant_id in participants) {
-        sendMsgTo(participant_id, msg, data);
-      }
+      broadcastMsg(undefined, msg, data);
     } else if (to === 'others') {
-      for (var participant_id in participants) {
-        if (participant_id !== from) {
-          sendMsgTo(participant_id, msg, data);
-        }
-      }
+      broadcastMsg(from, msg, data);
     } else {
       sendMsgTo(to, msg, data);
     }
@@ -33,6 +33,7 @@ module.exports.load = () => {
     config.capacity = config.capacity || {};
 
     config.internal.protocol = config.internal.protocol || 'tcp';
+    config.internal.spread_tree_fanout = config.internal.spread_tree_fanout || 0;
 
     config.mongo.databaseURL = config.mongo.databaseURL || 'localhost/owtdb';
 
@@ -60,7 +60,10 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
         selfRpcId = spec.selfRpcId,
         enable_audio_transcoding = config.transcoding && !!config.transcoding.audio,
         enable_video_transcoding = config.transcoding && !!config.transcoding.video,
-        internal_conn_protocol = config.internalConnProtocol;
+        internal_conn_protocol = config.internalConnProtocol,
+        // Maximum direct children per node in the spread tree; 0 keeps the
+        // flat star topology where every spread hangs off the origin node.
+        spread_tree_fanout = (config.spreadTreeFanout > 0 ? config.spreadTreeFanout : 0);
 
     /*
     mix_views = {
@@ -105,7 +108,12 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                         subscribers: [terminalID],
                         status: 'active' | 'inactive' | undefined} | undefined,
                         simulcast: [{id: simId, resolution: res, ...}],
-                spread: [NodeRpcID]
+                spread: [{target: NodeRpcID,
+                          parent: NodeRpcID,
+                          addr: {ip: IP, port: Number} | undefined,
+                          media: {audio: Boolean, video: Boolean},
+                          status: 'connecting' | 'connected',
+                          waiting: [{onOK: Function, onError: Function}]}]
                }
      }
     */
@@ -403,6 +411,73 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
         return terminals[terminal_id] && (terminals[terminal_id].type === 'webrtc' || terminals[terminal_id].type === 'streaming' || terminals[terminal_id].type === 'recording' || terminals[terminal_id].type === 'sip');
     };
 
+    // Distribution-tree spreading. With spread_tree_fanout > 0, a stream's
+    // spreads form a multi-level relay tree instead of a star on the origin
+    // node: each new target is fed from the connected node with spare
+    // fan-out capacity, so large fan-outs grow by adding leaves instead of
+    // piling subscriptions onto the origin. A relay hop costs one internal
+    // stream no matter how many children hang below it, because each node's
+    // internal-in connection fans out locally to all of them.
+    var countSpreadChildren = function (stream_id, node) {
+        var count = 0;
+        streams[stream_id] && streams[stream_id].spread.forEach(function (e) {
+            if (e.parent === node) {
+                count += 1;
+            }
+        });
+        return count;
+    };
+
+    // A relay is only a valid parent if its ancestor chain reaches the
+    // origin through connected hops. An orphan of a failed relay still reads
+    // status 'connected' but has no live feed, and two such orphans picking
+    // each other would form a subtree that believes it is connected but
+    // never receives media again.
+    var isFedFromOrigin = function (stream_id, node, original_node, exclude_node) {
+        var hops = 0;
+        while (node && node !== original_node) {
+            if (node === exclude_node || hops++ > streams[stream_id].spread.length) {
+                return false;
+            }
+            var entry = streams[stream_id].spread.find((s) => {return s.target === node;});
+            if (!entry || entry.status !== 'connected') {
+                return false;
+            }
+            node = entry.parent;
+        }
+        return node === original_node;
+    };
+
+    var selectSpreadSource = function (stream_id, original_node, target_node, exclude_node) {
+        if (spread_tree_fanout <= 0) {
+            return original_node;
+        }
+
+        // The origin takes children up to the fan-out limit first; after
+        // that, new targets hang below the connected relay with the fewest
+        // children, widening the tree level by level.
+        if (original_node !== exclude_node && countSpreadChildren(stream_id, original_node) < spread_tree_fanout) {
+            return original_node;
+        }
+
+        var best = null, best_children = Infinity;
+        streams[stream_id].spread.forEach(function (e) {
+            if (e.status !== 'connected' || e.target === target_node || e.target === exclude_node) {
+                return;
+            }
+            if (!isFedFromOrigin(stream_id, e.target, original_node, exclude_node)) {
+                return;
+            }
+            var children = countSpreadChildren(stream_id, e.target);
+            if (children < best_children) {
+                best = e.target;
+                best_children = children;
+            }
+        });
+
+        return best || original_node;
+    };
+
     var spreadStream = function (stream_id, target_node, target_node_type, on_ok, on_error) {
         log.debug('spreadStream, stream_id:', stream_id, 'target_node:', target_node, 'target_node_type:', target_node_type);
 
@@ -439,7 +514,10 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
               }
             }
         }
-        streams[stream_id].spread.push({target: target_node, status: 'connecting', waiting: []});
+        // The node this target is fed from; the origin unless the tree
+        // builder hangs it below an existing relay.
+        var source_node = selectSpreadSource(stream_id, original_node, target_node);
+        streams[stream_id].spread.push({target: target_node, parent: source_node, media: {audio: audio, video: video}, status: 'connecting', waiting: []});
 
         var on_spread_failed = function(reason, cancel_sub, cancel_pub, cancel_out, cancel_in) {
             log.error('spreadStream failed, stream_id:', stream_id, 'reason:', reason);
@@ -451,7 +529,7 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 streams[stream_id].spread.splice(i, 1);
             }
             if (cancel_sub) {
-                makeRPC(rpcClient, original_node, 'unsubscribe', [spread_id]);
+                makeRPC(rpcClient, source_node, 'unsubscribe', [spread_id]);
             }
 
             if (cancel_pub) {
@@ -459,7 +537,7 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
             }
 
             if (cancel_out) {
-                makeRPC(rpcClient, original_node, 'destroyInternalConnection', [spread_id, 'out']);
+                makeRPC(rpcClient, source_node, 'destroyInternalConnection', [spread_id, 'out']);
             }
 
             if (cancel_in) {
@@ -475,69 +553,79 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
         };
         var from, to, has_published, has_subscribed;
 
-        new Promise(function (resolve, reject) {
-            makeRPC(rpcClient, target_node, 'createInternalConnection', [stream_id, 'in', internalOpt], resolve, reject);
-        }).then(function(to_addr) {
-            to = to_addr;
-            return new Promise(function(resolve, reject) {
-                makeRPC(rpcClient, original_node, 'createInternalConnection', [spread_id, 'out', internalOpt], resolve, reject);
-            });
-        }).then(function(from_addr) {
-            from = from_addr;
+        // The in-side and out-side endpoints live on different nodes, and
+        // the publish only needs the out-side address while the subscribe
+        // only needs the in-side one, so each pair of RPCs runs in
+        // parallel; only the linkup has to wait for everything.
+        Promise.all([
+            new Promise(function (resolve, reject) {
+                makeRPC(rpcClient, target_node, 'createInternalConnection', [stream_id, 'in', internalOpt], resolve, reject);
+            }).then(function(to_addr) {
+                to = to_addr;
+            }),
+            new Promise(function(resolve, reject) {
+                makeRPC(rpcClient, source_node, 'createInternalConnection', [spread_id, 'out', internalOpt], resolve, reject);
+            }).then(function(from_addr) {
+                from = from_addr;
+            })
+        ]).then(function() {
             log.debug('spreadStream:', stream_id, 'from:', from, 'to:', to);
 
             // Publish/Subscribe internal connections
-            return new Promise(function(resolve, reject) {
-                if (!terminals[stream_owner]) {
-                    reject('Terminal:', stream_owner, 'not exist');
-                    return;
-                }
-                var publisher = (terminals[stream_owner] ? terminals[stream_owner].owner : 'common');
-                makeRPC(
-                    rpcClient,
-                    target_node,
-                    'publish',
-                    [
-                        stream_id,
-                        'internal',
-                        {
-                            controller: selfRpcId,
-                            publisher: publisher,
-                            audio: (audio ? {codec: streams[stream_id].audio.format} : false),
-                            video: (video ? {codec: streams[stream_id].video.format} : false),
-                            ip: from.ip,
-                            port: from.port,
-                        }
-                    ],
-                    resolve,
-                    reject
-                );
-            });
-        }).then(function () {
-            has_published = true;
-            return new Promise(function(resolve, reject) {
-                makeRPC(
-                    rpcClient,
-                    original_node,
-                    'subscribe',
-                    [
-                        spread_id,
-                        'internal',
-                        {controller: selfRpcId, ip: to.ip, port: to.port}
-                    ],
-                    resolve,
-                    reject
-                );
-            });
+            return Promise.all([
+                new Promise(function(resolve, reject) {
+                    if (!terminals[stream_owner]) {
+                        reject('Terminal:', stream_owner, 'not exist');
+                        return;
+                    }
+                    var publisher = (terminals[stream_owner] ? terminals[stream_owner].owner : 'common');
+                    makeRPC(
+                        rpcClient,
+                        target_node,
+                        'publish',
+                        [
+                            stream_id,
+                            'internal',
+                            {
+                                controller: selfRpcId,
+                                publisher: publisher,
+                                audio: (audio ? {codec: streams[stream_id].audio.format} : false),
+                                video: (video ? {codec: streams[stream_id].video.format} : false),
+                                ip: from.ip,
+                                port: from.port,
+                            }
+                        ],
+                        resolve,
+                        reject
+                    );
+                }).then(function () {
+                    has_published = true;
+                }),
+                new Promise(function(resolve, reject) {
+                    makeRPC(
+                        rpcClient,
+                        source_node,
+                        'subscribe',
+                        [
+                            spread_id,
+                            'internal',
+                            {controller: selfRpcId, ip: to.ip, port: to.port}
+                        ],
+                        resolve,
+                        reject
+                    );
+                }).then(function () {
+                    has_subscribed = true;
+                })
+            ]);
         }).then(function () {
-            has_subscribed = true;
             log.debug('internally publish/subscribe ok');
 
             // Linkup after publish/subscribe ready
             return new Promise(function (resolve, reject) {
                 makeRPC(
                     rpcClient,
-                    original_node,
+                    source_node,
                     'linkup',
                     [spread_id, audio ? stream_id : undefined, video ? stream_id : undefined],
                     resolve,
@@ -549,6 +637,9 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 var i = streams[stream_id].spread.findIndex((s) => {return s.target === target_node;});
                 if (i >= 0) {
                   streams[stream_id].spread[i].status = 'connected';
+                  // Kept for health-based re-parenting: a new parent can feed
+                  // this receiver again without recreating its in-connection.
+                  streams[stream_id].spread[i].addr = to;
                   process.nextTick(() => {
                     streams[stream_id].spread[i].waiting.forEach((e) => {
                       e.onOK();
@@ -577,14 +668,22 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 spread_id = stream_id + '@' + target_node;
 
             if (original_node !== target_node && !isSpreadInUse(stream_id, target_node)) {
+                var parent_node = original_node;
                 var i = streams[stream_id].spread.findIndex((s) => {return s.target === target_node;});
                 if (i !== -1) {
+                    parent_node = streams[stream_id].spread[i].parent || original_node;
                     streams[stream_id].spread.splice(i, 1);
                 }
 
+                // Mid-tree removal: children this relay was feeding re-home
+                // onto surviving nodes before the relay goes away.
+                if (spread_tree_fanout > 0) {
+                    reparentSpreadChildren(stream_id, target_node);
+                }
+
                 makeRPC(
                     rpcClient,
-                    original_node,
+                    parent_node,
                     'unsubscribe',
                     [spread_id]);
 
@@ -597,6 +696,71 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
         }
     };
 
+    // Re-feed one connected spread target from a new parent, reusing the
+    // receiver's existing in-connection (entry.addr). Used when the previous
+    // parent is being removed or has failed.
+    var reparentSpread = function (stream_id, entry, exclude_node) {
+        if (!streams[stream_id] || !terminals[streams[stream_id].owner]) {
+            return;
+        }
+
+        var original_node = terminals[streams[stream_id].owner].locality.node,
+            spread_id = stream_id + '@' + entry.target;
+
+        if (!entry.addr) {
+            log.warn('No receiver address recorded for spread:', spread_id, ', cannot re-parent');
+            return;
+        }
+
+        var media = entry.media || {audio: !!streams[stream_id].audio, video: !!streams[stream_id].video},
+            new_parent = selectSpreadSource(stream_id, original_node, entry.target, exclude_node);
+
+        log.debug('re-parent spread:', spread_id, 'from:', entry.parent, 'to:', new_parent);
+        entry.parent = new_parent;
+        entry.status = 'connecting';
+
+        new Promise(function (resolve, reject) {
+            makeRPC(rpcClient, new_parent, 'createInternalConnection', [spread_id, 'out', {protocol: internal_conn_protocol}], resolve, reject);
+        }).then(function () {
+            return new Promise(function (resolve, reject) {
+                makeRPC(
+                    rpcClient,
+                    new_parent,
+                    'subscribe',
+                    [spread_id, 'internal', {controller: selfRpcId, ip: entry.addr.ip, port: entry.addr.port}],
+                    resolve,
+                    reject);
+            });
+        }).then(function () {
+            return new Promise(function (resolve, reject) {
+                makeRPC(
+                    rpcClient,
+                    new_parent,
+                    'linkup',
+                    [spread_id, media.audio ? stream_id : undefined, media.video ? stream_id : undefined],
+                    resolve,
+                    reject);
+            });
+        }).then(function () {
+            entry.status = 'connected';
+            log.debug('re-parented spread:', spread_id);
+        }).catch(function (err) {
+            log.warn('Failed to re-parent spread:', spread_id, 'reason:', err.message ? err.message : err);
+            var i = (streams[stream_id] ? streams[stream_id].spread.findIndex((s) => {return s.target === entry.target;}) : -1);
+            if (i !== -1) {
+                streams[stream_id].spread.splice(i, 1);
+            }
+        });
+    };
+
+    var reparentSpreadChildren = function (stream_id, dead_node) {
+        streams[stream_id] && streams[stream_id].spread.slice().forEach(function (e) {
+            if (e.parent === dead_node && e.status === 'connected') {
+                reparentSpread(stream_id, e, dead_node);
+            }
+        });
+    };
+
     var isSpreadInUse = function (stream_id, node) {
         var audio_subscribers = (streams[stream_id] && streams[stream_id].audio && streams[stream_id].audio.subscribers) || [],
             video_subscribers = (streams[stream_id] && streams[stream_id].video && streams[stream_id].video.subscribers) || [],
@@ -2336,6 +2500,37 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
         }
     };
 
+    // Health-based re-parenting for the spread tree: when a worker or node
+    // carrying mid-tree relays fails, drop their spread records and re-home
+    // the children they were feeding onto surviving nodes. Node RPC ids are
+    // prefixed with their worker id, which is how worker-level faults map
+    // onto spread records here (same convention as connections.js).
+    var onSpreadFault = function (type, id) {
+        var impacted = function (node) {
+            return !!node && ((type === 'node' && node === id) || (type === 'worker' && node.startsWith(id)));
+        };
+
+        for (var stream_id in streams) {
+            var spread = streams[stream_id].spread;
+            if (!spread || spread.length === 0) {
+                continue;
+            }
+
+            for (var i = spread.length - 1; i >= 0; i--) {
+                if (impacted(spread[i].target)) {
+                    log.debug('Drop spread record on failed node:', spread[i].target, 'of stream:', stream_id);
+                    spread.splice(i, 1);
+                }
+            }
+
+            spread.slice().forEach(function (e) {
+                if (impacted(e.parent) && e.status === 'connected') {
+                    reparentSpread(stream_id, e, e.parent);
+                }
+            });
+        }
+    };
+
     that.onFaultDetected = function (purpose, type, id) {
         log.debug('onFaultDetected, purpose:', purpose, 'type:', type, 'id:', id);
         if (purpose === 'video') {
@@ -2343,6 +2538,11 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
         } else if (purpose === 'audio') {
             onAudioFault(type, id);
         }
+        if (spread_tree_fanout > 0) {
+            // Relay trees can have mid-tree hops on any media node, so this
+            // runs regardless of the failed worker's purpose.
+            onSpreadFault(type, id);
+        }
     };
 
     that.getViewCapability = function (view) {
@@ -62,6 +62,10 @@ var RpcRequest = function(rpcChannel) {
     return rpcChannel.makeRPC(portal, 'notify', [participantId, event, data]);
   };
 
+  that.broadcastMsg = function(portal, participantIds, event, data) {
+    return rpcChannel.makeRPC(portal, 'broadcast', [participantIds, event, data]);
+  };
+
   that.dropUser = function(portal, participantId) {
     return rpcChannel.makeRPC(portal, 'drop', [participantId]);
   };
@@ -64,7 +64,7 @@ module.exports = function Connections () {
                 log.debug('remove video from:', videoFrom);
                 var dest = connections[connectionId].connection.receiver('video');
                 connections[videoFrom].connection.removeDestination('video', dest);
-                connections[connectionId].audioFrom = undefined;
+                connections[connectionId].videoFrom = undefined;
             }
         }
     };
@@ -148,6 +148,43 @@ module.exports = function Connections () {
         return Promise.resolve('ok');
     };
 
+    // Switch an out-connection onto new sources in one pass: detach from
+    // the current feeds and attach to the replacements before returning to
+    // the event loop, so no frame is routed against a half-switched link.
+    // This is the node-local primitive for live migration: the subscriber's
+    // negotiated session stays up while its internal feed moves to the
+    // pipeline stood up on the drain target. The decoder resyncs at the
+    // next keyframe boundary - sources with a GOP cache replay from their
+    // last keyframe on attach, and the others are asked for a fresh one.
+    that.relinkConnection = function (connectionId, audioFrom, videoFrom) {
+        log.debug('relink, connectionId:', connectionId, ', audioFrom:', audioFrom, ', videoFrom:', videoFrom);
+        var conn = connections[connectionId];
+        if (!conn || conn.direction !== 'out') {
+            log.error('Subscription does not exist:' + connectionId);
+            return Promise.reject('Subscription does not exist:' + connectionId);
+        }
+
+        if (audioFrom && connections[audioFrom] === undefined) {
+            log.error('Audio stream does not exist:' + audioFrom);
+            return Promise.reject({type: 'failed', reason: 'Audio stream does not exist:' + audioFrom});
+        }
+
+        if (videoFrom && connections[videoFrom] === undefined) {
+            log.error('Video stream does not exist:' + videoFrom);
+            return Promise.reject({type: 'failed', reason: 'Video stream does not exist:' + videoFrom});
+        }
+
+        cutOffTo(connectionId);
+        return that.linkupConnection(connectionId, audioFrom, videoFrom)
+            .then(function (ok) {
+                var src = videoFrom && connections[videoFrom];
+                if (src && src.connection && typeof src.connection.requestKeyFrame === 'function') {
+                    src.connection.requestKeyFrame();
+                }
+                return ok;
+            });
+    };
+
     that.cutoffConnection = function (connectionId) {
         log.debug('cutoff, connectionId:', connectionId);
         if (connections[connectionId]) {
@@ -171,6 +208,47 @@ module.exports = function Connections () {
         return Object.keys(connections);
     };
 
+    that.getConnectionStats = function (connectionId) {
+        var conn = connections[connectionId];
+        if (conn && conn.connection && typeof conn.connection.getStats === 'function') {
+            try {
+                return JSON.parse(conn.connection.getStats());
+            } catch (e) {
+                log.debug('Failed to parse stats of connection:', connectionId, e);
+            }
+        }
+        return null;
+    };
+
+    // Compact roll-up of every connection's counters for the cluster stats
+    // pipeline: numeric leaves of each connection's getStats() JSON are
+    // summed under dotted keys (e.g. "transport.sentBytes"), so the summary
+    // stays a flat, fixed-size object however many streams the node carries.
+    that.getStatsSummary = function () {
+        var counters = {};
+        var accumulate = function (obj, prefix) {
+            for (var key in obj) {
+                var value = obj[key];
+                var name = prefix ? prefix + '.' + key : key;
+                if (typeof value === 'number') {
+                    counters[name] = (counters[name] || 0) + value;
+                } else if (value && typeof value === 'object') {
+                    accumulate(value, name);
+                }
+            }
+        };
+
+        var count = 0;
+        for (var conn_id in connections) {
+            var stats = that.getConnectionStats(conn_id);
+            if (stats) {
+                accumulate(stats, '');
+            }
+            count += 1;
+        }
+        return {connections: count, counters: counters};
+    };
+
     that.onFaultDetected = function (message) {
         if (message.purpose === 'conference') {
             for (var conn_id in connections) {
@@ -208,6 +208,13 @@ amqper.connect(config.rabbit, function () {
                 process.exit();
             });
             init_manager();
+            // Cluster stats pipeline: fold the nodes' roll-ups into one
+            // summary per worker and cast it to cluster_manager, so
+            // cluster-wide visibility costs O(workers) rather than a poll
+            // of every node's every stream.
+            setInterval(function () {
+                worker && manager && worker.reportStats(manager.collectStats());
+            }, 10000);
         });
     }, function(reason) {
         log.error('Agent as rpc client failed, reason:', reason);
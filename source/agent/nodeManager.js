@@ -55,6 +55,8 @@ module.exports = function (spec, spawnOptions, onNodeAbnormallyQuit, onTaskAdded
   }
   
   var launchNode = function() {
+      // Returns the new node's id so callers claiming under pool exhaustion
+      // can wait on this specific node.
       var id = spec.parentId + '_' + node_index++;
       if (!fs.existsSync('../logs')){
           fs.mkdirSync('../logs');
@@ -126,6 +128,10 @@ module.exports = function (spec, spawnOptions, onNodeAbnormallyQuit, onTaskAdded
               spawn_failed = false;
           } else if (message === 'IMOK') {
             child.alive_count += 1;
+          } else if (message && message.type === 'nodeStats') {
+              // Latest per-node counter roll-up; folded across nodes by
+              // collectStats() for the worker-level report.
+              child.stats = message.stats;
           } else {
               child.READY = false;
               child.kill();
@@ -138,6 +144,7 @@ module.exports = function (spec, spawnOptions, onNodeAbnormallyQuit, onTaskAdded
       processes[id] = child;
       tasks[id] = {};
       idle_nodes.push(id);
+      return id;
   };
   
   var dropNode = function(id) {
@@ -233,12 +240,27 @@ module.exports = function (spec, spawnOptions, onNodeAbnormallyQuit, onTaskAdded
 
   let pickInIdle = () => {
     return new Promise((resolve, reject) => {
-      if (idle_nodes.length < 1) {
+      // Prefer a warm node: one that has finished its spawn+require+addon
+      // load and reported READY can be claimed with no first-stream delay.
+      // Nodes still booting are the fallback, and an exhausted pool spawns
+      // on demand (cold start) rather than failing the allocation.
+      let node_id;
+      let warm_index = idle_nodes.findIndex((id) => processes[id] && processes[id].READY === true);
+      if (warm_index !== -1) {
+        node_id = idle_nodes.splice(warm_index, 1)[0];
+      } else if (idle_nodes.length > 0) {
+        log.debug('No warm node available, claiming a booting one');
+        node_id = idle_nodes.shift();
+      } else if (!spawn_failed && ((spec.maxNodeNum < 0) || (nodes.length < spec.maxNodeNum))) {
+        log.info('Node pool exhausted, spawning on demand');
+        node_id = launchNode();
+        idle_nodes.pop();
+      } else if (spec.reuseNode && nodes.length > 0) {
+        node_id = nodes.shift();
+      } else {
         log.error('getNode error:', 'No available node');
-        reject('No available node');
+        return reject('No available node');
       }
-  
-      let node_id = idle_nodes.shift();
       nodes.push(node_id);
       setTimeout(() => {
         if ((spec.maxNodeNum < 0) || ((nodes.length + idle_nodes.length) < spec.maxNodeNum)) {
@@ -308,6 +330,25 @@ module.exports = function (spec, spawnOptions, onNodeAbnormallyQuit, onTaskAdded
     });
   };
   
+  // Fold the nodes' latest stats roll-ups into one summary for this worker;
+  // nodes that have not reported yet (or carry no connections module) are
+  // counted but contribute no counters.
+  that.collectStats = function () {
+    var summary = {nodes: 0, connections: 0, counters: {}};
+    Object.keys(processes).forEach(function (id) {
+      var stats = processes[id] && processes[id].stats;
+      summary.nodes += 1;
+      if (!stats) {
+        return;
+      }
+      summary.connections += stats.connections || 0;
+      for (var name in stats.counters) {
+        summary.counters[name] = (summary.counters[name] || 0) + stats.counters[name];
+      }
+    });
+    return summary;
+  };
+
   that.dropAllNodes = function(quietly) {
       Object.keys(processes).map(function (k) {
           !quietly && onNodeAbnormallyQuit && onNodeAbnormallyQuit(k, tasksOnNode(k));
@@ -50,6 +50,7 @@ module.exports.load = () => {
     config.recording = config.recording || {};
     config.recording.initializeTimeout = config.recording.initialize_timeout || 3000;
     config.recording.path = config.recording.path || '/tmp'
+    config.recording.uploadUrlBase = config.recording.upload_url_base || '';
     try {
       fs.accessSync(config.recording.path, fs.F_OK);
     } catch (e) {
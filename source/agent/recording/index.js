@@ -4,13 +4,16 @@
 
 'use strict';
 
-var internalIO = require('../internalIO/build/Release/internalIO');
-var InternalIn = internalIO.In;
-var InternalOut = internalIO.Out;
+// Addon dlopen+init dominates workingNode spawn time, so the codec addon
+// loads on the first recording session; internal connections come from the
+// factory, preloaded by warmup below.
+var avstream;
+function getAVStream() {
+    if (!avstream)
+        avstream = require('../avstreamLib/build/Release/avstream');
+    return avstream;
+}
 
-var avstream = require('../avstreamLib/build/Release/avstream');
-var AVStreamIn = avstream.AVStreamIn;
-var AVStreamOut = avstream.AVStreamOut;
 var logger = require('../logger').logger;
 var path = require('path');
 var Connections = require('./connections');
@@ -36,7 +39,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         var avstream_options = {type: 'file',
                                 url: options.url};
 
-        var connection = new AVStreamIn(avstream_options);
+        var connection = new (getAVStream().AVStreamIn)(avstream_options);
         // FIXME: There should be a better chance to start playing.
         setTimeout(function () {connection.startPlay();}, 6000);
         callback('onStatus', {type: 'ready'});
@@ -45,7 +48,11 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
     };
 
     var createFileOut = function (connectionId, options) {
-        var recording_path = path.join(global.config.recording.path, connectionId + '.' + options.connection.container);
+        // With an upload base configured, recordings stream straight to the
+        // object store as they are muxed and never touch the local disk.
+        var recording_path = global.config.recording.uploadUrlBase
+            ? global.config.recording.uploadUrlBase + '/' + connectionId + '.' + options.connection.container
+            : path.join(global.config.recording.path, connectionId + '.' + options.connection.container);
         var avstream_options = {type: 'file',
                                 require_audio: !!options.media.audio,
                                 require_video: !!options.media.video,
@@ -55,7 +62,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                                 interval: 1000/*FIXME: should be removed later*/,
                                 initializeTimeout: global.config.recording.initializeTimeout};
 
-        var connection = new AVStreamOut(avstream_options, function (error) {
+        var connection = new (getAVStream().AVStreamOut)(avstream_options, function (error) {
             if (error) {
                 log.error('media recording init error:', error);
                 notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: error});
@@ -192,6 +199,12 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.cutoffConnection(connectionId).then(onSuccess(callback), onError(callback));
     };
 
+    // Live migration: move a recording onto replacement sources without
+    // restarting the file.
+    that.relink = function (connectionId, audioFrom, videoFrom, callback) {
+        connections.relinkConnection(connectionId, audioFrom, videoFrom).then(onSuccess(callback), onError(callback));
+    };
+
    that.close = function() {
         log.debug('close called');
         var connIds = connections.getIds();
@@ -210,5 +223,23 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.onFaultDetected(message);
     };
 
+    // Per-node counter roll-up for the cluster stats pipeline.
+    that.getStatsSummary = function () {
+        return connections.getStatsSummary();
+    };
+
+    // Called by workingNode after READY: preload the transport addon every
+    // session needs; avstream stays on demand.
+    that.warmup = function () {
+        InternalConnectionFactory.preload();
+        // Pre-bind listen sockets for the cluster-default transport so the
+        // first subscribe's create RPC does not pay the bind.
+        internalConnFactory.prewarm({
+            protocol: 'tcp',
+            minport: global.config.internal.minport,
+            maxport: global.config.internal.maxport
+        }, 2);
+    };
+
     return that;
 };
@@ -3,11 +3,18 @@
 // SPDX-License-Identifier: Apache-2.0
 
 'use strict';
-var InternalIO = require('../internalIO/build/Release/internalIO');
-var SipGateway = require('../sipIn/build/Release/sipIn');
-var SipCallConnection = require('./sipCallConnection').SipCallConnection;
-var InternalIn = InternalIO.In;
-var InternalOut = InternalIO.Out;
+// Addon dlopen+init dominates workingNode spawn time, so the SIP addon
+// (and sipCallConnection, which pulls it in at require time) loads when the
+// gateway is first brought up; internal connections come from the factory,
+// preloaded by warmup below.
+var SipGateway, SipCallConnection;
+function loadAddons() {
+    if (!SipGateway) {
+        SipGateway = require('../sipIn/build/Release/sipIn');
+        SipCallConnection = require('./sipCallConnection').SipCallConnection;
+    }
+}
+
 var logger = require('../logger').logger;
 var rpcClient;
 var path = require('path');
@@ -289,6 +296,8 @@ module.exports = function (rpcC, selfRpcId, parentRpcId, clusterWorkerIP) {
                tmp = {codec: 'pcmu'};
             } else if (info.audio_codec === 'PCMA') {
                tmp = {codec: 'pcma'};
+            } else if (info.audio_codec === 'G722') {
+               tmp = {codec: 'g722', sampleRate: 16000, channelNum: 1};
             }
             audio_info = tmp;
         }
@@ -619,6 +628,7 @@ module.exports = function (rpcC, selfRpcId, parentRpcId, clusterWorkerIP) {
 
         room_id = options.room_id;
 
+        loadAddons();
         gateway = new SipGateway.SipGateway();
 
         gateway.addEventListener('SIPRegisterOK', function() {
@@ -965,6 +975,11 @@ module.exports = function (rpcC, selfRpcId, parentRpcId, clusterWorkerIP) {
         callback('callback', 'ok');
     };
 
+    that.broadcast = function(participantIds, event, data, callback) {
+        //TODO: notify text message to sip end.
+        callback('callback', 'ok');
+    };
+
     that.close = function() {
         if (gateway) {
             this.clean();
@@ -986,5 +1001,18 @@ module.exports = function (rpcC, selfRpcId, parentRpcId, clusterWorkerIP) {
         }
     };
 
+    // Called by workingNode after READY: preload the transport addon; the
+    // SIP stack itself waits for the first gateway init.
+    that.warmup = function () {
+        InternalConnectionFactory.preload();
+        // Pre-bind listen sockets for the cluster-default transport so the
+        // first subscribe's create RPC does not pay the bind.
+        internalConnFactory.prewarm({
+            protocol: 'tcp',
+            minport: global.config.internal.minport,
+            maxport: global.config.internal.maxport
+        }, 2);
+    };
+
     return that;
 };
@@ -14,10 +14,15 @@
       '../../../core/owt_base/AudioFramePacketizer.cpp',
       '../../../core/owt_base/AudioUtilities.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/PayloadBufferPool.cpp',
+'../../../core/owt_base/MemoryBudget.cpp',
       '../../../core/owt_base/VideoFrameConstructor.cpp',
+      '../../../core/owt_base/KeyFrameRequestGovernor.cpp',
       '../../../core/owt_base/VideoFramePacketizer.cpp',
+      '../../../core/owt_base/VideoPacketPacer.cpp',
       '../../../core/owt_base/SsrcGenerator.cc',
       '../../../core/rtc_adapter/VieReceiver.cc',
+      '../../../core/rtc_adapter/TransportCcEstimator.cc',
       '../../../core/rtc_adapter/VieRemb.cc' #20150508
     ],
     'dependencies': ['sipLib'],
@@ -68,6 +73,7 @@
         'sip_gateway',
         'sip_gateway/sipua/include',
         '$(CORE_HOME)/common',
+        '$(CORE_HOME)/owt_base',
         '../../../../third_party/licode/erizo/src/erizo',
         '$(CORE_HOME)/../../build/libdeps/build/include',
     ],
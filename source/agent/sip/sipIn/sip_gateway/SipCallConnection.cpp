@@ -7,6 +7,7 @@
 #include "SipCallConnection.h"
 
 #include <rtputils.h>
+#include <PacketPool.h>
 #include "SipGateway.h"
 
 extern "C" {
@@ -168,7 +169,7 @@ void SipCallConnection::onSipAudioData(char* data, int len)
         if (m_audioCodec == "opus")
             head->setPayloadType(OPUS_48000_PT);
        {
-            audio_sink_->deliverAudioData(std::make_shared<erizo::DataPacket>(0, data, len, erizo::AUDIO_PACKET));
+            audio_sink_->deliverAudioData(owt_base::PacketPool::obtain(0, data, len, erizo::AUDIO_PACKET));
        }
    }
 }
@@ -188,7 +189,7 @@ void SipCallConnection::onSipVideoData(char* data, int len)
           head->setPayloadType(H264_90000_PT);
         }
         {
-           video_sink_->deliverVideoData(std::make_shared<erizo::DataPacket>(0, data, len, erizo::VIDEO_PACKET));
+           video_sink_->deliverVideoData(owt_base::PacketPool::obtain(0, data, len, erizo::VIDEO_PACKET));
         }
     }
 }
@@ -157,13 +157,30 @@ bool SipGateway::onSipIncomingCall(bool requireAudio, bool requireVideo, const s
     return true;
 }
 
+// Formats the internal frame pipeline carries natively. A matching call
+// gets its encoded payload bridged as-is between the SIP RTP path and the
+// room, no decode+encode anywhere; anything else is refused so the peer
+// renegotiates to a bridgeable codec. Note G.722 advertises an 8000Hz RTP
+// clock (RFC 3551) although the audio itself is 16kHz.
+static bool isBridgeableAudioFmt(const std::string &codecName, unsigned int sampleRate)
+{
+    return (codecName == "PCMU" && sampleRate == 8000)
+        || (codecName == "PCMA" && sampleRate == 8000)
+        || (codecName == "G722" && sampleRate == 8000)
+        || (codecName == "opus" && sampleRate == 48000);
+}
+
+static bool isBridgeableVideoFmt(const std::string &codecName, unsigned int rtpClock)
+{
+    return (codecName == "VP8" || codecName == "H264" || codecName == "H265")
+        && rtpClock == 90000;
+}
+
 // The sipua thread
 void SipGateway::onSipAudioFmt(const std::string &peer, const std::string &codecName, unsigned int sampleRate)
 {
     ELOG_DEBUG("onSipAudioFmt:%s-%s-%u", peer.c_str(), codecName.c_str(), sampleRate);
-    if ((codecName == "PCMU" && sampleRate == 8000)
-        || (codecName == "PCMA" && sampleRate == 8000)
-        || (codecName == "opus" && sampleRate == 48000)) {
+    if (isBridgeableAudioFmt(codecName, sampleRate)) {
         insertOrUpdateCallInfoByPeerURI(peer, codecName, sampleRate);
     } else {
       ELOG_ERROR("not support audio fmt");
@@ -173,9 +190,7 @@ void SipGateway::onSipAudioFmt(const std::string &peer, const std::string &codec
 void SipGateway::onSipVideoFmt(const std::string &peer, const std::string& codecName, unsigned int rtpClock, const std::string& fmtp)
 {
     ELOG_DEBUG("onSipVideoFmt:%s-%u[%s]", codecName.c_str(), rtpClock, fmtp.c_str());
-    if ((codecName == "VP8" && rtpClock == 90000)
-    || (codecName == "H264" && rtpClock == 90000)
-    || (codecName == "H265" && rtpClock == 90000)) {
+    if (isBridgeableVideoFmt(codecName, rtpClock)) {
         insertOrUpdateCallInfoByPeerURI(peer, codecName, rtpClock, fmtp);
     } else {
       ELOG_ERROR("not support video fmt");
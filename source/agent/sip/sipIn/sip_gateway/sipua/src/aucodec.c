@@ -86,6 +86,13 @@ static struct aucodec pcma = {
 	NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
+/* G.722 is carried with an 8000Hz RTP clock (RFC 3551 quirk) although the
+ * audio is 16kHz; the payload is bridged, never decoded here. */
+static struct aucodec g722 = {
+	LE_INIT, "9", "G722", 8000, 1, NULL,
+	NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
 static struct aucodec opus = {
 	.name      = "opus",
 	.srate     = 48000,
@@ -103,4 +110,5 @@ void register_audio_codecs(void)
 	aucodec_register(&pcmu);
 	aucodec_register(&pcma);
 	aucodec_register(&opus);
+	aucodec_register(&g722);
 }
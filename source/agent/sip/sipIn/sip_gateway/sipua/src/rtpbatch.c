@@ -0,0 +1,190 @@
+/**
+ * @file rtpbatch.c  Batched RTP socket sends across calls
+ *
+ * One shared queue collects outbound RTP datagrams from every call on
+ * the node and writes them with single sendmmsg calls, mirroring the
+ * batched UDP mode of the internal transports; the per-packet sendto
+ * under every stream_send is what bounds call capacity on busy nodes.
+ *
+ * The queue is fed from a udp helper registered below the encryption
+ * layers, so it sees the final encrypted bytes, and is drained either
+ * when it fills or by a flusher thread whose period bounds the added
+ * latency to about a millisecond.
+ */
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <re/re.h>
+#include <baresip.h>
+#include "core.h"
+#include "rtpbatch.h"
+
+#define DEBUG_MODULE "rtpbatch"
+#define DEBUG_LEVEL 5
+#include <re/re_dbg.h>
+
+
+enum {
+	BATCH_MAX      = 32,    /* flush when this many datagrams queued  */
+	BATCH_PKTSIZE  = 2048,  /* largest datagram taken into the batch  */
+	BATCH_FLUSH_US = 1000,  /* flusher period; bounds added latency   */
+	BATCH_LAYER    = -1000, /* below srtp: send handlers run last     */
+};
+
+struct batch_pkt {
+	int fd;
+	struct sa dst;
+	size_t len;
+	uint8_t buf[BATCH_PKTSIZE];
+};
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_t thread;
+	bool running;
+	struct batch_pkt pkts[BATCH_MAX];
+	unsigned count;
+	uint64_t n_queued;
+	uint64_t n_flush;
+	uint64_t n_fallback;
+} batch = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+
+bool rtpbatch_enabled(void)
+{
+	static int enabled = -1;
+
+	if (enabled < 0) {
+		const char *env = getenv("OWT_SIP_RTP_BATCH");
+		enabled = (env && atoi(env) != 0) ? 1 : 0;
+	}
+
+	return enabled == 1;
+}
+
+
+/* called with batch.lock held */
+static void flush_locked(void)
+{
+	struct mmsghdr msgs[BATCH_MAX];
+	struct iovec iovs[BATCH_MAX];
+	bool taken[BATCH_MAX];
+	unsigned i, j, n;
+
+	if (!batch.count)
+		return;
+
+	memset(taken, 0, sizeof(taken));
+
+	/* one sendmmsg per socket; datagrams of the calls sharing a flush
+	 * window collapse into a few syscalls */
+	for (i = 0; i < batch.count; i++) {
+
+		if (taken[i])
+			continue;
+
+		n = 0;
+		for (j = i; j < batch.count; j++) {
+			struct batch_pkt *pkt = &batch.pkts[j];
+
+			if (taken[j] || pkt->fd != batch.pkts[i].fd)
+				continue;
+
+			memset(&msgs[n], 0, sizeof(msgs[n]));
+			iovs[n].iov_base            = pkt->buf;
+			iovs[n].iov_len             = pkt->len;
+			msgs[n].msg_hdr.msg_name    = &pkt->dst.u.sa;
+			msgs[n].msg_hdr.msg_namelen = pkt->dst.len;
+			msgs[n].msg_hdr.msg_iov     = &iovs[n];
+			msgs[n].msg_hdr.msg_iovlen  = 1;
+			taken[j] = true;
+			n++;
+		}
+
+		if (sendmmsg(batch.pkts[i].fd, msgs, n, 0) < 0)
+			DEBUG_NOTICE("sendmmsg failed (%m)\n", errno);
+
+		batch.n_flush++;
+	}
+
+	batch.count = 0;
+}
+
+
+static void *flusher(void *arg)
+{
+	(void)arg;
+
+	while (batch.running) {
+		usleep(BATCH_FLUSH_US);
+
+		pthread_mutex_lock(&batch.lock);
+		flush_locked();
+		pthread_mutex_unlock(&batch.lock);
+	}
+
+	return NULL;
+}
+
+
+static bool batch_send_handler(int *err, struct sa *dst, struct mbuf *mb,
+			       void *arg)
+{
+	struct udp_sock *us = arg;
+	struct batch_pkt *pkt;
+	int fd;
+	(void)err;
+
+	fd = udp_sock_fd(us, sa_af(dst));
+	if (fd < 0 || mbuf_get_left(mb) > BATCH_PKTSIZE) {
+		pthread_mutex_lock(&batch.lock);
+		batch.n_fallback++;
+		pthread_mutex_unlock(&batch.lock);
+		return false;  /* normal per-packet send */
+	}
+
+	pthread_mutex_lock(&batch.lock);
+
+	pkt = &batch.pkts[batch.count++];
+	pkt->fd  = fd;
+	pkt->dst = *dst;
+	pkt->len = mbuf_get_left(mb);
+	memcpy(pkt->buf, mbuf_buf(mb), pkt->len);
+	batch.n_queued++;
+
+	if (batch.count == BATCH_MAX)
+		flush_locked();
+
+	pthread_mutex_unlock(&batch.lock);
+
+	return true;  /* consumed; the flush writes it out */
+}
+
+
+int rtpbatch_attach(struct udp_helper **uhp, struct udp_sock *us)
+{
+	if (!uhp || !us)
+		return EINVAL;
+
+	pthread_mutex_lock(&batch.lock);
+	if (!batch.running) {
+		batch.running = true;
+		if (pthread_create(&batch.thread, NULL, flusher, NULL)) {
+			batch.running = false;
+			pthread_mutex_unlock(&batch.lock);
+			return ENOMEM;
+		}
+		(void)pthread_detach(batch.thread);
+		info("rtpbatch: batched RTP sends enabled\n");
+	}
+	pthread_mutex_unlock(&batch.lock);
+
+	return udp_register_helper(uhp, us, BATCH_LAYER,
+				   batch_send_handler, NULL, us);
+}
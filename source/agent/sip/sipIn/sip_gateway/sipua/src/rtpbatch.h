@@ -0,0 +1,7 @@
+/**
+ * @file rtpbatch.h  Batched RTP socket sends across calls
+ */
+
+
+bool rtpbatch_enabled(void);
+int  rtpbatch_attach(struct udp_helper **uhp, struct udp_sock *us);
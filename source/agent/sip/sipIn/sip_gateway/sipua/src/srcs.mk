@@ -16,6 +16,7 @@ SRCS    += menc.c
 SRCS	+= net.c
 SRCS	+= realtime.c
 SRCS	+= reg.c
+SRCS	+= rtpbatch.c
 SRCS	+= rtpkeep.c
 SRCS	+= sdp.c
 SRCS	+= sipreq.c
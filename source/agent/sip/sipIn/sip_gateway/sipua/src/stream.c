@@ -8,6 +8,7 @@
 #include <re/re.h>
 #include <baresip.h>
 #include "core.h"
+#include "rtpbatch.h"
 
 #define DEBUG_MODULE "stream"
 #define DEBUG_LEVEL 5
@@ -84,6 +85,7 @@ static void stream_destructor(void *arg)
 	metric_reset(&s->metric_rx);
 
 	list_unlink(&s->le);
+	mem_deref(s->batch_uh);
 	mem_deref(s->rtpkeep);
 	mem_deref(s->sdp);
 	mem_deref(s->mes);
@@ -210,6 +212,12 @@ static int stream_sock_alloc(struct stream *s, int af)
 
 	udp_rxsz_set(rtp_sock(s->rtp), RTP_RECV_SIZE);
 
+	/* Batch outbound RTP from all calls into sendmmsg writes; the
+	   helper sits below the encryption layers so it queues the final
+	   encrypted bytes */
+	if (rtpbatch_enabled())
+		(void)rtpbatch_attach(&s->batch_uh, rtp_sock(s->rtp));
+
 	return 0;
 }
 
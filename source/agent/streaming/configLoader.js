@@ -49,6 +49,7 @@ module.exports.load = () => {
 
     config.avstream = config.avstream || {};
     config.avstream.initializeTimeout = config.avstream.initialize_timeout || 3000;
+    config.avstream.openTimeout = config.avstream.open_timeout || 30000;
 
     return config;
   } catch (e) {
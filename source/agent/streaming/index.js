@@ -4,13 +4,17 @@
 
 'use strict';
 
-var internalIO = require('../internalIO/build/Release/internalIO');
-var InternalIn = internalIO.In;
-var InternalOut = internalIO.Out;
+// Addon dlopen+init dominates workingNode spawn time, so the codec addon
+// loads on the first streaming session: internal connections come from the
+// factory (preloaded by warmup below), and a node that only ever relays
+// never touches avstream at all.
+var avstream;
+function getAVStream() {
+    if (!avstream)
+        avstream = require('../avstreamLib/build/Release/avstream');
+    return avstream;
+}
 
-var avstream = require('../avstreamLib/build/Release/avstream');
-var AVStreamIn = avstream.AVStreamIn;
-var AVStreamOut = avstream.AVStreamOut;
 var logger = require('../logger').logger;
 var path = require('path');
 var Connections = require('./connections');
@@ -38,11 +42,17 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                                 has_video: (options.media.video === 'auto' ? 'auto' : (!!options.media.video ? 'yes' : 'no')),
                                 transport: options.connection.transportProtocol,
                                 buffer_size: options.connection.bufferSize,
+                                open_timeout: global.config.avstream.openTimeout,
                                 url: options.connection.url};
 
-        var connection = new AVStreamIn(avstream_options, function (message) {
+        var connection = new (getAVStream().AVStreamIn)(avstream_options, function (message) {
             log.debug('avstream-in status message:', message);
-            notifyStatus(options.controller, sessionId, 'in', JSON.parse(message));
+            var status = JSON.parse(message);
+            // Progress notes from the native open state machine stay local;
+            // the controller only understands terminal states.
+            if (status.type === 'ready' || status.type === 'failed') {
+                notifyStatus(options.controller, sessionId, 'in', status);
+            }
         });
 
         return connection;
@@ -64,7 +74,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             }
         }
 
-        var connection = new AVStreamOut(avstream_options, function (error) {
+        var connection = new (getAVStream().AVStreamOut)(avstream_options, function (error) {
             if (error) {
                 log.error('avstream-out init error:', error);
                 notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: error});
@@ -203,6 +213,12 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.cutoffConnection(connectionId).then(onSuccess(callback), onError(callback));
     };
 
+    // Live migration: move a subscription onto replacement sources without
+    // touching the outgoing stream.
+    that.relink = function (connectionId, audioFrom, videoFrom, callback) {
+        connections.relinkConnection(connectionId, audioFrom, videoFrom).then(onSuccess(callback), onError(callback));
+    };
+
     that.close = function() {
         log.debug('close called');
         var connIds = connections.getIds();
@@ -221,5 +237,24 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.onFaultDetected(message);
     };
 
+    // Per-node counter roll-up for the cluster stats pipeline.
+    that.getStatsSummary = function () {
+        return connections.getStatsSummary();
+    };
+
+    // Called by workingNode after READY: preload the transport addon every
+    // session needs. avstream stays on demand - a relay-only node never
+    // loads it.
+    that.warmup = function () {
+        InternalConnectionFactory.preload();
+        // Pre-bind listen sockets for the cluster-default transport so the
+        // first subscribe's create RPC does not pay the bind.
+        internalConnFactory.prewarm({
+            protocol: 'tcp',
+            minport: global.config.internal.minport,
+            maxport: global.config.internal.maxport
+        }, 2);
+    };
+
     return that;
 };
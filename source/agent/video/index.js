@@ -4,8 +4,6 @@
 
 'use strict';
 
-var MediaFrameMulticaster = require('../mediaFrameMulticaster/build/Release/mediaFrameMulticaster');
-
 var logger = require('../logger').logger;
 
 // Logger
@@ -24,18 +22,29 @@ var useHardware = global.config.video.hardwareAccelerated,
     MFE_timeout = global.config.video.MFE_timeout || 0,
     supported_codecs = global.config.video.codecs;
 
-var VideoMixer, VideoTranscoder;
-try {
-    if (useHardware) {
-        VideoMixer = require('../videoMixer_msdk/build/Release/videoMixer-msdk');
-        VideoTranscoder = require('../videoTranscoder_msdk/build/Release/videoTranscoder-msdk');
-    } else {
-        VideoMixer = require('../videoMixer_sw/build/Release/videoMixer-sw');
-        VideoTranscoder = require('../videoTranscoder_sw/build/Release/videoTranscoder-sw');
+// Addon dlopen+init dominates workingNode spawn time, so the native addons
+// load on first use; warmup below preloads them off the spawn path once the
+// node has reported READY, ahead of the room's init call. A broken addon
+// still kills the node like the old load-at-require did, just on first use
+// instead of at spawn.
+var MediaFrameMulticaster, VideoMixer, VideoTranscoder;
+function loadAddons() {
+    if (VideoMixer)
+        return;
+
+    try {
+        MediaFrameMulticaster = require('../mediaFrameMulticaster/build/Release/mediaFrameMulticaster');
+        if (useHardware) {
+            VideoMixer = require('../videoMixer_msdk/build/Release/videoMixer-msdk');
+            VideoTranscoder = require('../videoTranscoder_msdk/build/Release/videoTranscoder-msdk');
+        } else {
+            VideoMixer = require('../videoMixer_sw/build/Release/videoMixer-sw');
+            VideoTranscoder = require('../videoTranscoder_sw/build/Release/videoTranscoder-sw');
+        }
+    } catch (e) {
+        log.error(e);
+        process.exit(-2);
     }
-} catch (e) {
-    log.error(e);
-    process.exit(-2);
 }
 
 const colorMap = {
@@ -370,6 +379,7 @@ function VMixer(rpcClient, clusterIP) {
             'MFE_timeout': MFE_timeout
         };
 
+        loadAddons();
         inputManager = new InputManager(videoConfig.maxInput);
         engine = new VideoMixer(config);
         layoutProcessor = new LayoutProcessor(videoConfig.layout.templates);
@@ -613,6 +623,9 @@ function VMixer(rpcClient, clusterIP) {
             }
             //TODO: re-implement the setPrimary method
             layoutProcessor.setPrimary(input.id);
+            // Let the compositor keep the primary speaker's region at full
+            // rate when compose throttling is configured.
+            engine.setActiveInput(input.id);
             input.primaryCount++;
             callback('callback', 'ok');
         } else {
@@ -737,6 +750,19 @@ function VMixer(rpcClient, clusterIP) {
         }
     };
 
+    that.getSnapshot = function (options, callback) {
+        log.debug('getSnapshot, options:', options);
+        var maxWidth = (options && options.width) || 320,
+            maxHeight = (options && options.height) || 180,
+            snapshot = engine && engine.getSnapshot(maxWidth, maxHeight);
+
+        if (snapshot) {
+            callback('callback', {format: 'jpeg', data: snapshot.toString('base64')});
+        } else {
+            callback('callback', 'error', 'No frame available');
+        }
+    };
+
 
     return that;
 };
@@ -875,6 +901,7 @@ function VTranscoder(rpcClient, clusterIP) {
 
         controller = ctrlr;
 
+        loadAddons();
         engine = new VideoTranscoder(config);
 
         motion_factor = (motionFactor || 1.0);
@@ -1074,6 +1101,19 @@ function VTranscoder(rpcClient, clusterIP) {
         }
     };
 
+    that.getSnapshot = function (options, callback) {
+        log.debug('getSnapshot, options:', options);
+        var maxWidth = (options && options.width) || 320,
+            maxHeight = (options && options.height) || 180,
+            snapshot = engine && engine.getSnapshot(maxWidth, maxHeight);
+
+        if (snapshot) {
+            callback('callback', {format: 'jpeg', data: snapshot.toString('base64')});
+        } else {
+            callback('callback', 'error', 'No frame available');
+        }
+    };
+
     return that;
 };
 
@@ -1109,5 +1149,20 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         processor = undefined;
     };
 
+    // Called by workingNode after READY: a video node always ends up mixing
+    // or transcoding, so preload everything before the room's init call
+    // arrives.
+    that.warmup = function () {
+        InternalConnectionFactory.preload();
+        loadAddons();
+        // Pre-bind listen sockets for the cluster-default transport so the
+        // first subscribe's create RPC does not pay the bind.
+        internalConnFactory.prewarm({
+            protocol: 'tcp',
+            minport: global.config.internal.minport,
+            maxport: global.config.internal.maxport
+        }, 2);
+    };
+
     return that;
 };
@@ -17,9 +17,10 @@ namespace mcu {
 
 DEFINE_LOGGER(MsdkAvatarManager, "mcu.media.MsdkVideoCompositor.MsdkAvatarManager");
 
-MsdkAvatarManager::MsdkAvatarManager(uint8_t size, boost::shared_ptr<mfxFrameAllocator> allocator)
+MsdkAvatarManager::MsdkAvatarManager(uint8_t size, boost::shared_ptr<mfxFrameAllocator> allocator, bool crop)
     : m_size(size)
     , m_allocator(allocator)
+    , m_crop(crop)
 {
 }
 
@@ -71,7 +72,7 @@ bool MsdkAvatarManager::getImageSize(const std::string &url, uint32_t *pWidth, u
     return true;
 }
 
-boost::shared_ptr<owt_base::MsdkFrame> MsdkAvatarManager::loadImage(const std::string &url)
+rtc::scoped_refptr<webrtc::I420Buffer> MsdkAvatarManager::loadImage(const std::string &url)
 {
     uint32_t width, height;
 
@@ -102,11 +103,43 @@ boost::shared_ptr<owt_base::MsdkFrame> MsdkAvatarManager::loadImage(const std::s
 
     delete image;
 
+    return i420Buffer;
+}
+
+boost::shared_ptr<owt_base::MsdkFrame> MsdkAvatarManager::scaleToRegion(const rtc::scoped_refptr<webrtc::I420Buffer> &image, uint32_t regionWidth, uint32_t regionHeight)
+{
+    uint32_t width = image->width();
+    uint32_t height = image->height();
+
+    // Pre-scale once to what the vpp would otherwise produce every tick for
+    // this region: crop mode fills the region from a centered crop, non-crop
+    // mode fits within it (applyAspectRatio then only positions the rect).
+    if (regionWidth > 0 && regionHeight > 0) {
+        if (m_crop) {
+            width = regionWidth;
+            height = regionHeight;
+        } else {
+            width = std::min(regionWidth, (uint32_t)(image->width() * regionHeight / image->height()));
+            height = std::min(regionHeight, (uint32_t)(image->height() * regionWidth / image->width()));
+        }
+        width &= ~1;
+        height &= ~1;
+    }
+
+    if (width == 0 || height == 0)
+        return NULL;
+
+    rtc::scoped_refptr<I420Buffer> scaled = image;
+    if (width != (uint32_t)image->width() || height != (uint32_t)image->height()) {
+        scaled = I420Buffer::Create(width, height);
+        scaled->CropAndScaleFrom(*image);
+    }
+
     boost::shared_ptr<owt_base::MsdkFrame> frame(new owt_base::MsdkFrame(width, height, m_allocator));
     if(!frame->init())
         return NULL;
 
-    frame->convertFrom(i420Buffer.get());
+    frame->convertFrom(scaled.get());
     return frame;
 }
 
@@ -132,6 +165,7 @@ bool MsdkAvatarManager::setAvatar(uint8_t index, const std::string &url)
         if (old_url == it2.second)
             return true;
     }
+    m_images.erase(old_url);
     m_frames.erase(old_url);
     return true;
 }
@@ -153,11 +187,12 @@ bool MsdkAvatarManager::unsetAvatar(uint8_t index)
         if (url == it2.second)
             return true;
     }
+    m_images.erase(url);
     m_frames.erase(url);
     return true;
 }
 
-boost::shared_ptr<owt_base::MsdkFrame> MsdkAvatarManager::getAvatarFrame(uint8_t index)
+boost::shared_ptr<owt_base::MsdkFrame> MsdkAvatarManager::getAvatarFrame(uint8_t index, uint32_t regionWidth, uint32_t regionHeight)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
@@ -166,13 +201,27 @@ boost::shared_ptr<owt_base::MsdkFrame> MsdkAvatarManager::getAvatarFrame(uint8_t
         ELOG_WARN("Not valid index(%d)", index);
         return NULL;
     }
-    auto it2 = m_frames.find(it->second);
-    if (it2 != m_frames.end()) {
+
+    uint64_t sizeKey = ((uint64_t)regionWidth << 32) | regionHeight;
+    auto& cache = m_frames[it->second];
+    auto it2 = cache.find(sizeKey);
+    if (it2 != cache.end()) {
         return it2->second;
     }
 
-    boost::shared_ptr<owt_base::MsdkFrame> frame = loadImage(it->second);
-    m_frames[it->second] = frame;
+    rtc::scoped_refptr<webrtc::I420Buffer> image;
+    auto it3 = m_images.find(it->second);
+    if (it3 != m_images.end()) {
+        image = it3->second;
+    } else {
+        image = loadImage(it->second);
+        m_images[it->second] = image;
+    }
+
+    boost::shared_ptr<owt_base::MsdkFrame> frame;
+    if (image)
+        frame = scaleToRegion(image, regionWidth, regionHeight);
+    cache[sizeKey] = frame;
     return frame;
 }
 
@@ -445,7 +494,11 @@ void MsdkVpp::defaultParam(void)
     memset(m_extVppComp.get(), 0, sizeof(mfxExtVPPComposite));
 
     // mfxVideoParam Common
-    m_videoParam->AsyncDepth = 1;
+    // Two composite jobs in flight: the tick thread can submit the next
+    // frame's composition while the previous one still runs on the GPU,
+    // instead of spinning on DEVICE_BUSY until it drains. Consumers sync
+    // lazily through the frame's sync point.
+    m_videoParam->AsyncDepth = 2;
     m_videoParam->IOPattern = MFX_IOPATTERN_IN_VIDEO_MEMORY | MFX_IOPATTERN_OUT_VIDEO_MEMORY;
     m_videoParam->NumExtParam = 0;
     m_videoParam->ExtParam = (mfxExtBuffer **)&m_extVppComp;
@@ -977,7 +1030,20 @@ boost::shared_ptr<MsdkFrame> MsdkFrameGenerator::layout()
 {
     std::vector<boost::shared_ptr<owt_base::MsdkFrame>> inputFrames;
     for (auto& l : m_layout) {
-        boost::shared_ptr<MsdkFrame> src = m_owner->getInputFrame(l.input);
+        // Region pixel size with the same rounding as convertToCompInputStream,
+        // so cached avatar surfaces match the composition rect exactly.
+        const Rectangle& rect = l.region.area.rect;
+        uint32_t offsetWidth = (uint64_t)m_size.width * rect.left.numerator / rect.left.denominator;
+        uint32_t offsetHeight = (uint64_t)m_size.height * rect.top.numerator / rect.top.denominator;
+        uint32_t regionWidth = (uint64_t)m_size.width * rect.width.numerator / rect.width.denominator;
+        uint32_t regionHeight = (uint64_t)m_size.height * rect.height.numerator / rect.height.denominator;
+
+        if (offsetWidth + regionWidth > m_size.width)
+            regionWidth = m_size.width - offsetWidth;
+        if (offsetHeight + regionHeight > m_size.height)
+            regionHeight = m_size.height - offsetHeight;
+
+        boost::shared_ptr<MsdkFrame> src = m_owner->getInputFrame(l.input, regionWidth, regionHeight);
         inputFrames.push_back(src);
     }
 
@@ -1007,7 +1073,7 @@ MsdkVideoCompositor::MsdkVideoCompositor(uint32_t maxInput, VideoSize rootSize,
     ELOG_TRACE("---MsdkInput");
 
     ELOG_TRACE("+++MsdkAvatarManager");
-    m_avatarManager.reset(new MsdkAvatarManager(maxInput, m_allocator));
+    m_avatarManager.reset(new MsdkAvatarManager(maxInput, m_allocator, crop));
     ELOG_TRACE("---MsdkAvatarManager");
 
     ELOG_TRACE("+++MsdkFrameGenerator");
@@ -1101,6 +1167,13 @@ void MsdkVideoCompositor::deActivateInput(int input)
     m_inputs[input]->deActivate();
 }
 
+void MsdkVideoCompositor::setActiveInput(int input)
+{
+    // The hardware path composes all inputs in one VPP job; there is no
+    // per-region cadence to throttle.
+    ELOG_TRACE("setActiveInput = %d", input);
+}
+
 bool MsdkVideoCompositor::setAvatar(int input, const std::string& avatar)
 {
     ELOG_DEBUG("setAvatar(%d) = %s", input, avatar.c_str());
@@ -1170,7 +1243,7 @@ void MsdkVideoCompositor::flush()
 #endif
 }
 
-boost::shared_ptr<owt_base::MsdkFrame> MsdkVideoCompositor::getInputFrame(int index)
+boost::shared_ptr<owt_base::MsdkFrame> MsdkVideoCompositor::getInputFrame(int index, uint32_t regionWidth, uint32_t regionHeight)
 {
     boost::shared_ptr<owt_base::MsdkFrame> src;
 
@@ -1178,7 +1251,7 @@ boost::shared_ptr<owt_base::MsdkFrame> MsdkVideoCompositor::getInputFrame(int in
     if (input->isActivate()) {
         src = input->popInput();
     } else {
-        src = m_avatarManager->getAvatarFrame(index);
+        src = m_avatarManager->getAvatarFrame(index, regionWidth, regionHeight);
     }
 
     return src;
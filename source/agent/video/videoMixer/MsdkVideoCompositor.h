@@ -35,24 +35,30 @@ class MsdkAvatarManager {
     DECLARE_LOGGER();
 
 public:
-    MsdkAvatarManager(uint8_t size, boost::shared_ptr<mfxFrameAllocator> allocator);
+    MsdkAvatarManager(uint8_t size, boost::shared_ptr<mfxFrameAllocator> allocator, bool crop);
     ~MsdkAvatarManager();
 
     bool setAvatar(uint8_t index, const std::string &url);
     bool unsetAvatar(uint8_t index);
 
-    boost::shared_ptr<owt_base::MsdkFrame> getAvatarFrame(uint8_t index);
+    // Avatar surface pre-scaled to the given region size (0x0 for native size),
+    // cached across ticks so composition blits it 1:1.
+    boost::shared_ptr<owt_base::MsdkFrame> getAvatarFrame(uint8_t index, uint32_t regionWidth, uint32_t regionHeight);
 
 protected:
     bool getImageSize(const std::string &url, uint32_t *pWidth, uint32_t *pHeight);
-    boost::shared_ptr<owt_base::MsdkFrame> loadImage(const std::string &url);
+    rtc::scoped_refptr<webrtc::I420Buffer> loadImage(const std::string &url);
+    boost::shared_ptr<owt_base::MsdkFrame> scaleToRegion(const rtc::scoped_refptr<webrtc::I420Buffer> &image, uint32_t regionWidth, uint32_t regionHeight);
 
 private:
     uint8_t m_size;
     boost::shared_ptr<mfxFrameAllocator> m_allocator;
+    bool m_crop;
 
     std::map<uint8_t, std::string> m_inputs;
-    std::map<std::string, boost::shared_ptr<owt_base::MsdkFrame>> m_frames;
+    // decoded images (url) and persistent video memory surfaces (url, region size)
+    std::map<std::string, rtc::scoped_refptr<webrtc::I420Buffer>> m_images;
+    std::map<std::string, std::map<uint64_t, boost::shared_ptr<owt_base::MsdkFrame>>> m_frames;
 
     boost::shared_mutex m_mutex;
 };
@@ -99,7 +105,8 @@ class MsdkVpp
 {
     DECLARE_LOGGER();
 
-    const uint8_t NumOfMixedFrames = 3;
+    // Two in flight (AsyncDepth) plus frames still referenced downstream.
+    const uint8_t NumOfMixedFrames = 4;
 
 public:
     MsdkVpp(owt_base::VideoSize &size, owt_base::YUVColor &bgColor, const bool crop);
@@ -234,6 +241,7 @@ public:
 
     bool activateInput(int input);
     void deActivateInput(int input);
+    void setActiveInput(int input);
     bool setAvatar(int input, const std::string& avatar);
     bool unsetAvatar(int input);
     void pushInput(int input, const owt_base::Frame& frame);
@@ -250,7 +258,7 @@ public:
 
 protected:
     void createAllocator();
-    boost::shared_ptr<owt_base::MsdkFrame> getInputFrame(int index);
+    boost::shared_ptr<owt_base::MsdkFrame> getInputFrame(int index, uint32_t regionWidth, uint32_t regionHeight);
     void flush(void);
 
 private:
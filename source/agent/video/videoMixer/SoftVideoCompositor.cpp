@@ -4,11 +4,17 @@
 
 #include "SoftVideoCompositor.h"
 
+#include <PipelineTracer.h>
+#include <ThreadAffinity.h>
+
 #include "libyuv/convert.h"
 #include "libyuv/scale.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <iterator>
 
 #include <boost/make_shared.hpp>
 
@@ -17,6 +23,73 @@ using namespace owt_base;
 
 namespace mcu {
 
+namespace {
+
+// One compositor worker pool for the whole process: every generator posts
+// its per-region tasks here, so the two generators of a compositor (or
+// several rooms hosted on one node) share workers instead of each spawning
+// their own thread group. The shared queue balances the load by itself --
+// an idle worker simply pulls the next region off it.
+class ComposePool {
+public:
+    static ComposePool& instance()
+    {
+        static ComposePool pool;
+        return pool;
+    }
+
+    uint32_t size() const { return m_num; }
+    boost::asio::io_service& service() { return *m_srv; }
+
+private:
+    ComposePool()
+        : m_num(0)
+    {
+        uint32_t nThreads = boost::thread::hardware_concurrency();
+        m_num = nThreads / 2;
+        if (m_num > 16)
+            m_num = 16;
+
+        if (m_num > 1) {
+            m_srv       = boost::make_shared<boost::asio::io_service>();
+            m_srvWork   = boost::make_shared<boost::asio::io_service::work>(*m_srv);
+            m_thrGrp    = boost::make_shared<boost::thread_group>();
+
+            boost::shared_ptr<boost::asio::io_service> srv = m_srv;
+            for (uint32_t i = 0; i < m_num; i++) {
+                m_thrGrp->create_thread([srv]() {
+                    ThreadAffinity::applyRole("compositor");
+                    srv->run();
+                });
+            }
+        }
+    }
+
+    // Lives for the process, torn down with it.
+    ~ComposePool() {}
+
+    uint32_t m_num;
+    boost::shared_ptr<boost::asio::io_service> m_srv;
+    boost::shared_ptr<boost::asio::io_service::work> m_srvWork;
+    boost::shared_ptr<boost::thread_group> m_thrGrp;
+};
+
+// Refresh rate for regions of participants other than the primary speaker,
+// 0 keeps every region at full rate.
+static uint32_t composeThrottleFps()
+{
+    static int fps = -1;
+    if (fps < 0) {
+        const char *env = getenv("OWT_COMPOSE_THROTTLE_FPS");
+        fps = env ? atoi(env) : 0;
+        if (fps < 0)
+            fps = 0;
+    }
+    return (uint32_t)fps;
+}
+
+} // namespace
+
 DEFINE_LOGGER(AvatarManager, "mcu.media.SoftVideoCompositor.AvatarManager");
 
 AvatarManager::AvatarManager(uint8_t size)
@@ -117,6 +190,7 @@ bool AvatarManager::setAvatar(uint8_t index, const std::string &url)
     auto it = m_inputs.find(index);
     if (it == m_inputs.end()) {
         m_inputs[index] = url;
+        m_seq.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 
@@ -125,6 +199,7 @@ bool AvatarManager::setAvatar(uint8_t index, const std::string &url)
     }
     std::string old_url = it->second;
     it->second = url;
+    m_seq.fetch_add(1, std::memory_order_relaxed);
 
     //delete
     for (auto& it2 : m_inputs) {
@@ -146,6 +221,7 @@ bool AvatarManager::unsetAvatar(uint8_t index)
     }
     std::string url = it->second;
     m_inputs.erase(it);
+    m_seq.fetch_add(1, std::memory_order_relaxed);
 
     //delete
     for (auto& it2 : m_inputs) {
@@ -179,6 +255,7 @@ DEFINE_LOGGER(SoftInput, "mcu.media.SoftVideoCompositor.SoftInput");
 
 SoftInput::SoftInput()
     : m_active(false)
+    , m_lowMotionToggle(false)
 {
     m_bufferManager.reset(new I420BufferManager(3));
     m_converter.reset(new owt_base::FrameConverter());
@@ -190,23 +267,74 @@ SoftInput::~SoftInput()
 
 void SoftInput::setActive(bool active)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-    m_active = active;
-    if (!m_active)
-        m_busyFrame.reset();
+    m_active.store(active);
+    // Clear the slot on both edges: on deactivation to drop the last frame,
+    // on activation to discard a straggler a writer may have published after
+    // losing the race with a deactivate.
+    boost::atomic_store(&m_busyFrame, boost::shared_ptr<webrtc::VideoFrame>());
+    m_seq.fetch_add(1, std::memory_order_relaxed);
 }
 
 bool SoftInput::isActive(void)
 {
-    return m_active;
+    return m_active.load();
 }
 
+// Sampled sum of absolute luma differences over a sparse grid, cheap enough
+// to run on every pushed frame (under a thousand taps at 1080p).
+static uint32_t sampledLumaSad(const webrtc::VideoFrameBuffer *a, const webrtc::VideoFrameBuffer *b, uint32_t *samples)
+{
+    const int kGridStep = 16;
+
+    uint32_t sad = 0;
+    uint32_t n = 0;
+    for (int y = kGridStep / 2; y < a->height(); y += kGridStep) {
+        const uint8_t *rowA = a->DataY() + y * a->StrideY();
+        const uint8_t *rowB = b->DataY() + y * b->StrideY();
+        for (int x = kGridStep / 2; x < a->width(); x += kGridStep) {
+            sad += abs((int)rowA[x] - (int)rowB[x]);
+            n++;
+        }
+    }
+
+    *samples = n;
+    return sad;
+}
+
+// Per-sample thresholds classifying an incoming frame against the last
+// published one. Identical content (shared slides, frozen cameras) scores
+// zero; camera noise alone typically lands well above kStaticSadPerSample.
+static const uint32_t kStaticSadPerSample = 1;
+static const uint32_t kLowMotionSadPerSample = 3;
+
 void SoftInput::pushInput(webrtc::VideoFrame *videoFrame)
 {
-    {
-        boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-        if (!m_active)
-            return;
+    if (!m_active.load())
+        return;
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> srcI420Buffer = videoFrame->video_frame_buffer();
+
+    // Classify motion against the last published frame. Static frames are
+    // dropped right here, before the copy: the sequence does not move, so
+    // generators keep reusing the region they already scaled (see
+    // SoftFrameGenerator::layout). Low-motion frames publish at half rate.
+    boost::shared_ptr<webrtc::VideoFrame> lastFrame = boost::atomic_load(&m_busyFrame);
+    if (lastFrame) {
+        rtc::scoped_refptr<webrtc::VideoFrameBuffer> lastBuffer = lastFrame->video_frame_buffer();
+        if (lastBuffer->width() == srcI420Buffer->width()
+                && lastBuffer->height() == srcI420Buffer->height()) {
+            uint32_t samples = 0;
+            uint32_t sad = sampledLumaSad(srcI420Buffer.get(), lastBuffer.get(), &samples);
+            if (samples > 0 && sad < samples * kStaticSadPerSample) {
+                m_lowMotionToggle = false;
+                return;
+            }
+            if (samples > 0 && sad < samples * kLowMotionSadPerSample) {
+                m_lowMotionToggle = !m_lowMotionToggle;
+                if (m_lowMotionToggle)
+                    return;
+            }
+        }
     }
 
     rtc::scoped_refptr<webrtc::I420Buffer> dstBuffer = m_bufferManager->getFreeBuffer(videoFrame->width(), videoFrame->height());
@@ -215,27 +343,26 @@ void SoftInput::pushInput(webrtc::VideoFrame *videoFrame)
         return;
     }
 
-    rtc::scoped_refptr<webrtc::VideoFrameBuffer> srcI420Buffer = videoFrame->video_frame_buffer();
     if (!m_converter->convert(srcI420Buffer, dstBuffer.get())) {
         ELOG_ERROR("I420Copy failed");
         return;
     }
 
-    {
-        boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-        if (m_active)
-            m_busyFrame.reset(new webrtc::VideoFrame(dstBuffer, webrtc::kVideoRotation_0, 0));
+    if (m_active.load()) {
+        // Publish before bumping the sequence, so a generator that sees the
+        // new sequence is guaranteed to fetch at least this frame.
+        boost::atomic_store(&m_busyFrame,
+                boost::shared_ptr<webrtc::VideoFrame>(new webrtc::VideoFrame(dstBuffer, webrtc::kVideoRotation_0, 0)));
+        m_seq.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
 boost::shared_ptr<VideoFrame> SoftInput::popInput()
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-
-    if(!m_active)
+    if (!m_active.load())
         return NULL;
 
-    return m_busyFrame;
+    return boost::atomic_load(&m_busyFrame);
 }
 
 DEFINE_LOGGER(SoftFrameGenerator, "mcu.media.SoftVideoCompositor.SoftFrameGenerator");
@@ -253,10 +380,14 @@ SoftFrameGenerator::SoftFrameGenerator(
     , m_minSupportedFps(minFps)
     , m_counter(0)
     , m_counterMax(0)
+    , m_tickCount(0)
+    , m_shedLevel(0)
     , m_size(size)
     , m_bgColor(bgColor)
     , m_crop(crop)
     , m_configureChanged(false)
+    , m_fullRedrawNeeded(true)
+    , m_textEnabled(false)
     , m_parallelNum(0)
 {
     ELOG_DEBUG_T("Support fps max(%d), min(%d)", m_maxSupportedFps, m_minSupportedFps);
@@ -281,47 +412,26 @@ SoftFrameGenerator::SoftFrameGenerator(
 
     m_outputs.resize(m_maxSupportedFps / m_minSupportedFps);
 
-    m_bufferManager.reset(new I420BufferManager(1));
-
     // parallet composition
-    uint32_t nThreads = boost::thread::hardware_concurrency();
-    m_parallelNum = nThreads / 2;
-    if (m_parallelNum > 16)
-        m_parallelNum = 16;
-
-    ELOG_DEBUG_T("hardware concurrency %d, parallel composition num %d", nThreads, m_parallelNum);
+    m_parallelNum = ComposePool::instance().size();
 
-    if (m_parallelNum > 1) {
-        m_srv       = boost::make_shared<boost::asio::io_service>();
-        m_srvWork   = boost::make_shared<boost::asio::io_service::work>(*m_srv);
-        m_thrGrp    = boost::make_shared<boost::thread_group>();
-
-        for (uint32_t i = 0; i < m_parallelNum; i++)
-            m_thrGrp->create_thread(boost::bind(&boost::asio::io_service::run, m_srv));
-    }
+    ELOG_DEBUG_T("parallel composition num %d", m_parallelNum);
 
     m_textDrawer.reset(new owt_base::FFmpegDrawText());
 
     m_jobTimer.reset(new JobTimer(m_maxSupportedFps, this));
     m_jobTimer->start();
+
+    if (owt_base::HostLoadGovernor::enabled())
+        owt_base::HostLoadGovernor::instance().addShedder(this);
 }
 
 SoftFrameGenerator::~SoftFrameGenerator()
 {
     ELOG_DEBUG_T("Exit");
 
-    if (m_srvWork)
-        m_srvWork.reset();
-
-    if (m_srv) {
-        m_srv->stop();
-        m_srv.reset();
-    }
-
-    if (m_thrGrp) {
-        m_thrGrp->join_all();
-        m_thrGrp.reset();
-    }
+    if (owt_base::HostLoadGovernor::enabled())
+        owt_base::HostLoadGovernor::instance().removeShedder(this);
 
     m_jobTimer->stop();
 
@@ -382,8 +492,22 @@ bool SoftFrameGenerator::removeOutput(owt_base::FrameDestination *dst) {
     return false;
 }
 
+void SoftFrameGenerator::onShedLevel(uint32_t level)
+{
+    m_shedLevel = level;
+}
+
 void SoftFrameGenerator::onTimeout()
 {
+    // Host-wide shedding: compose on every (level + 1)th tick, cutting the
+    // effective rate of all outputs together.
+    if (m_shedLevel && (m_tickCount++ % (m_shedLevel + 1)) != 0)
+        return;
+
+    timespec composeStart, composeEnd;
+    if (owt_base::HostLoadGovernor::enabled())
+        clock_gettime(CLOCK_MONOTONIC, &composeStart);
+
     bool hasValidOutput = false;
     {
         boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
@@ -399,6 +523,8 @@ void SoftFrameGenerator::onTimeout()
     }
 
     if (hasValidOutput) {
+        int64_t tickStartUs = owt_base::PipelineTracer::enabled() ? owt_base::PipelineTracer::nowUs() : 0;
+
         rtc::scoped_refptr<webrtc::VideoFrameBuffer> compositeBuffer = generateFrame();
         if (compositeBuffer) {
             webrtc::VideoFrame compositeFrame(
@@ -419,8 +545,93 @@ void SoftFrameGenerator::onTimeout()
 
             m_textDrawer->drawFrame(frame);
 
+            m_owner->setSnapshotBuffer(compositeBuffer);
+
             {
                 boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
+
+                // One-pass pyramid: the canvas was composed once at full
+                // size, and every distinct lower output resolution due this
+                // tick is derived by a cascaded downscale, each rung from
+                // the nearest larger one. An encoder that receives an
+                // exactly sized frame skips its own scale, its converter
+                // degenerates to a copy.
+                std::vector<std::pair<uint32_t, uint32_t>> sizes;
+                for (uint32_t i = 0; i < m_outputs.size(); i++) {
+                    for (auto it = m_outputs[i].begin(); it != m_outputs[i].end(); ++it) {
+                        if (it->width == 0 || it->height == 0)
+                            continue;
+                        if (it->width > m_size.width || it->height > m_size.height)
+                            continue;
+                        if (it->width == m_size.width && it->height == m_size.height)
+                            continue;
+                        if (m_counter % (i + 1))
+                            continue;
+
+                        std::pair<uint32_t, uint32_t> size(it->width, it->height);
+                        if (std::find(sizes.begin(), sizes.end(), size) == sizes.end())
+                            sizes.push_back(size);
+                    }
+                }
+                std::sort(sizes.begin(), sizes.end(),
+                        [](const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b) {
+                            return (uint64_t)a.first * a.second > (uint64_t)b.first * b.second;
+                        });
+
+                struct Rung {
+                    uint32_t width;
+                    uint32_t height;
+                    rtc::scoped_refptr<webrtc::I420Buffer> buffer;
+                    boost::shared_ptr<webrtc::VideoFrame> videoFrame;
+                    owt_base::Frame frame;
+                };
+                std::vector<Rung> rungs;
+                for (auto &size : sizes) {
+                    uint64_t key = ((uint64_t)size.first << 32) | size.second;
+                    rtc::scoped_refptr<webrtc::I420Buffer> &buffer = m_pyramidBuffers[key];
+                    if (!buffer)
+                        buffer = webrtc::I420Buffer::Create(size.first, size.second);
+                    if (!buffer)
+                        continue;
+
+                    // Smallest already produced rung covering this one; the
+                    // sizes are sorted by area, so walk from the back.
+                    const webrtc::VideoFrameBuffer *source = compositeBuffer.get();
+                    for (auto r = rungs.rbegin(); r != rungs.rend(); ++r) {
+                        if (r->width >= size.first && r->height >= size.second) {
+                            source = r->buffer.get();
+                            break;
+                        }
+                    }
+
+                    int ret = libyuv::I420Scale(
+                            source->DataY(), source->StrideY(),
+                            source->DataU(), source->StrideU(),
+                            source->DataV(), source->StrideV(),
+                            source->width(), source->height(),
+                            buffer->MutableDataY(), buffer->StrideY(),
+                            buffer->MutableDataU(), buffer->StrideU(),
+                            buffer->MutableDataV(), buffer->StrideV(),
+                            size.first, size.second,
+                            libyuv::kFilterBox);
+                    if (ret != 0) {
+                        ELOG_ERROR_T("I420Scale failed, ret %d", ret);
+                        continue;
+                    }
+
+                    Rung rung;
+                    rung.width = size.first;
+                    rung.height = size.second;
+                    rung.buffer = buffer;
+                    rung.videoFrame.reset(new webrtc::VideoFrame(buffer, webrtc::kVideoRotation_0, compositeFrame.timestamp_us()));
+                    rung.videoFrame->set_timestamp(compositeFrame.timestamp());
+                    rung.frame = frame;
+                    rung.frame.payload = reinterpret_cast<uint8_t*>(rung.videoFrame.get());
+                    rung.frame.additionalInfo.video.width = size.first;
+                    rung.frame.additionalInfo.video.height = size.second;
+                    rungs.push_back(rung);
+                }
+
                 for (uint32_t i = 0; i <  m_outputs.size(); i++) {
                     if (m_counter % (i + 1))
                         continue;
@@ -429,14 +640,53 @@ void SoftFrameGenerator::onTimeout()
                         ELOG_TRACE_T("+++deliverFrame(%d), dst(%p), fps(%d), timestamp(%d)"
                                 , m_counter, it->dest, m_maxSupportedFps / (i + 1), frame.timeStamp / 90);
 
-                        it->dest->onFrame(frame);
+                        const owt_base::Frame *deliverFrame = &frame;
+                        for (auto &rung : rungs) {
+                            if (rung.width == it->width && rung.height == it->height) {
+                                deliverFrame = &rung.frame;
+                                break;
+                            }
+                        }
+                        it->dest->onFrame(*deliverFrame);
                     }
                 }
+
+                // Drop buffers for resolutions no longer requested by any
+                // output, regardless of which tick they are due on.
+                for (auto it = m_pyramidBuffers.begin(); it != m_pyramidBuffers.end();) {
+                    bool wanted = false;
+                    for (uint32_t i = 0; i < m_outputs.size() && !wanted; i++) {
+                        for (auto o = m_outputs[i].begin(); o != m_outputs[i].end(); ++o) {
+                            if ((((uint64_t)o->width << 32) | o->height) == it->first) {
+                                wanted = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (wanted)
+                        ++it;
+                    else
+                        it = m_pyramidBuffers.erase(it);
+                }
             }
+
+            if (tickStartUs)
+                owt_base::PipelineTracer::instance().complete("video", "composite_tick", tickStartUs, frame.timeStamp);
         }
     }
 
     m_counter = (m_counter + 1) % m_counterMax;
+
+    if (owt_base::HostLoadGovernor::enabled()) {
+        clock_gettime(CLOCK_MONOTONIC, &composeEnd);
+        int64_t composeTimeUs = (composeEnd.tv_sec - composeStart.tv_sec) * 1000000
+            + (composeEnd.tv_nsec - composeStart.tv_nsec) / 1000;
+
+        // A tick that overruns its interval starves the ones behind it on
+        // the shared timer thread; that is the pressure signal.
+        if (composeTimeUs * (int64_t)m_maxSupportedFps > 1000000)
+            owt_base::HostLoadGovernor::instance().reportOverrun();
+    }
 }
 
 rtc::scoped_refptr<webrtc::VideoFrameBuffer> SoftFrameGenerator::generateFrame()
@@ -451,13 +701,6 @@ void SoftFrameGenerator::layout_regions(SoftFrameGenerator *t, rtc::scoped_refpt
     uint32_t composite_height = compositeBuffer->height();
 
     for (LayoutSolution::const_iterator it = regions.begin(); it != regions.end(); ++it) {
-        boost::shared_ptr<webrtc::VideoFrame> inputFrame = t->m_owner->getInputFrame(it->input);
-        if (inputFrame == NULL) {
-            continue;
-        }
-
-        rtc::scoped_refptr<webrtc::VideoFrameBuffer> inputBuffer = inputFrame->video_frame_buffer();
-
         Region region = it->region;
         uint32_t dst_x      = (uint64_t)composite_width * region.area.rect.left.numerator / region.area.rect.left.denominator;
         uint32_t dst_y      = (uint64_t)composite_height * region.area.rect.top.numerator / region.area.rect.top.denominator;
@@ -470,6 +713,28 @@ void SoftFrameGenerator::layout_regions(SoftFrameGenerator *t, rtc::scoped_refpt
         if (dst_y + dst_height > composite_height)
             dst_height = composite_height - dst_y;
 
+        // Full region rect, used to repaint background where the input does
+        // not cover it; the canvas persists across ticks, so stale pixels
+        // would linger otherwise.
+        uint32_t region_x       = dst_x & ~1;
+        uint32_t region_y       = dst_y & ~1;
+        uint32_t region_width   = dst_width & ~1;
+        uint32_t region_height  = dst_height & ~1;
+
+        bool fromAvatar = false;
+        boost::shared_ptr<webrtc::VideoFrame> inputFrame = t->m_owner->getInputFrame(it->input, fromAvatar);
+        if (inputFrame == NULL) {
+            libyuv::I420Rect(
+                    compositeBuffer->MutableDataY(), compositeBuffer->StrideY(),
+                    compositeBuffer->MutableDataU(), compositeBuffer->StrideU(),
+                    compositeBuffer->MutableDataV(), compositeBuffer->StrideV(),
+                    region_x, region_y, region_width, region_height,
+                    t->m_bgColor.y, t->m_bgColor.cb, t->m_bgColor.cr);
+            continue;
+        }
+
+        rtc::scoped_refptr<webrtc::VideoFrameBuffer> inputBuffer = inputFrame->video_frame_buffer();
+
         uint32_t cropped_dst_width;
         uint32_t cropped_dst_height;
         uint32_t src_x;
@@ -506,6 +771,36 @@ void SoftFrameGenerator::layout_regions(SoftFrameGenerator *t, rtc::scoped_refpt
         cropped_dst_width   &= ~1;
         cropped_dst_height  &= ~1;
 
+        // Repaint the letterbox bars when the input does not fill the
+        // region, previous content may have.
+        if (cropped_dst_width != region_width || cropped_dst_height != region_height) {
+            libyuv::I420Rect(
+                    compositeBuffer->MutableDataY(), compositeBuffer->StrideY(),
+                    compositeBuffer->MutableDataU(), compositeBuffer->StrideU(),
+                    compositeBuffer->MutableDataV(), compositeBuffer->StrideV(),
+                    region_x, region_y, region_width, region_height,
+                    t->m_bgColor.y, t->m_bgColor.cb, t->m_bgColor.cr);
+        }
+
+        // Avatars never change between updates, blit the cached pre-scaled
+        // variant instead of rescaling the decoded image every compose.
+        if (fromAvatar) {
+            rtc::scoped_refptr<webrtc::I420Buffer> scaled = t->getScaledAvatar(
+                    inputBuffer, src_x, src_y, src_width, src_height,
+                    cropped_dst_width, cropped_dst_height);
+            if (scaled) {
+                libyuv::I420Copy(
+                        scaled->DataY(), scaled->StrideY(),
+                        scaled->DataU(), scaled->StrideU(),
+                        scaled->DataV(), scaled->StrideV(),
+                        compositeBuffer->MutableDataY() + dst_y * compositeBuffer->StrideY() + dst_x, compositeBuffer->StrideY(),
+                        compositeBuffer->MutableDataU() + (dst_y * compositeBuffer->StrideU() + dst_x) / 2, compositeBuffer->StrideU(),
+                        compositeBuffer->MutableDataV() + (dst_y * compositeBuffer->StrideV() + dst_x) / 2, compositeBuffer->StrideV(),
+                        cropped_dst_width, cropped_dst_height);
+                continue;
+            }
+        }
+
         int ret = libyuv::I420Scale(
                 inputBuffer->DataY() + src_y * inputBuffer->StrideY() + src_x, inputBuffer->StrideY(),
                 inputBuffer->DataU() + (src_y * inputBuffer->StrideU() + src_x) / 2, inputBuffer->StrideU(),
@@ -521,55 +816,135 @@ void SoftFrameGenerator::layout_regions(SoftFrameGenerator *t, rtc::scoped_refpt
     }
 }
 
-rtc::scoped_refptr<webrtc::VideoFrameBuffer> SoftFrameGenerator::layout()
+rtc::scoped_refptr<webrtc::I420Buffer> SoftFrameGenerator::getScaledAvatar(
+        rtc::scoped_refptr<webrtc::VideoFrameBuffer> srcBuffer,
+        uint32_t srcX, uint32_t srcY, uint32_t srcWidth, uint32_t srcHeight,
+        uint32_t dstWidth, uint32_t dstHeight)
 {
-    rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer = m_bufferManager->getFreeBuffer(m_size.width, m_size.height);
-    if (!compositeBuffer) {
-        ELOG_ERROR("No valid composite buffer");
-        return NULL;
+    ScaledAvatarKey key(srcBuffer.get(), srcX, srcY, srcWidth, srcHeight, dstWidth, dstHeight);
+
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_scaledAvatarMutex);
+        auto found = m_scaledAvatars.find(key);
+        if (found != m_scaledAvatars.end())
+            return found->second;
     }
 
-    // Set the background color
-    libyuv::I420Rect(
-            compositeBuffer->MutableDataY(), compositeBuffer->StrideY(),
-            compositeBuffer->MutableDataU(), compositeBuffer->StrideU(),
-            compositeBuffer->MutableDataV(), compositeBuffer->StrideV(),
-            0, 0, compositeBuffer->width(), compositeBuffer->height(),
-            m_bgColor.y, m_bgColor.cb, m_bgColor.cr);
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled = webrtc::I420Buffer::Create(dstWidth, dstHeight);
+    if (!scaled)
+        return NULL;
 
-    bool isParallelFrameComposition = m_parallelNum > 1 && m_layout.size() > 4;
+    int ret = libyuv::I420Scale(
+            srcBuffer->DataY() + srcY * srcBuffer->StrideY() + srcX, srcBuffer->StrideY(),
+            srcBuffer->DataU() + (srcY * srcBuffer->StrideU() + srcX) / 2, srcBuffer->StrideU(),
+            srcBuffer->DataV() + (srcY * srcBuffer->StrideV() + srcX) / 2, srcBuffer->StrideV(),
+            srcWidth, srcHeight,
+            scaled->MutableDataY(), scaled->StrideY(),
+            scaled->MutableDataU(), scaled->StrideU(),
+            scaled->MutableDataV(), scaled->StrideV(),
+            dstWidth, dstHeight,
+            libyuv::kFilterBox);
+    if (ret != 0) {
+        ELOG_ERROR("I420Scale failed, ret %d", ret);
+        return NULL;
+    }
 
-    if (isParallelFrameComposition) {
-        int nParallelRegions = (m_layout.size() + m_parallelNum - 1) / m_parallelNum;
-        int nRegions = m_layout.size();
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_scaledAvatarMutex);
+        // Entries keyed by buffers of replaced avatars go stale but unused;
+        // bound them here, layout changes clear the cache outright.
+        if (m_scaledAvatars.size() >= 128)
+            m_scaledAvatars.clear();
+        m_scaledAvatars[key] = scaled;
+    }
 
-        LayoutSolution::iterator regions_begin = m_layout.begin();
-        LayoutSolution::iterator regions_end = m_layout.begin();
+    return scaled;
+}
 
-        std::vector<boost::shared_ptr<boost::packaged_task<void>>> tasks;
-        while (nRegions > 0) {
-            if (nRegions < nParallelRegions)
-                nParallelRegions = nRegions;
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> SoftFrameGenerator::layout()
+{
+    // The canvas persists across ticks, pixels of unchanged regions are
+    // simply delivered again.
+    if (!m_canvas) {
+        m_canvas = webrtc::I420Buffer::Create(m_size.width, m_size.height);
+        if (!m_canvas) {
+            ELOG_ERROR("No valid composite buffer");
+            return NULL;
+        }
+        m_fullRedrawNeeded = true;
+    }
+    rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer = m_canvas;
+
+    // The text drawer writes onto the delivered canvas after composition,
+    // so while text is (or until just after it was) shown, the pixels under
+    // it cannot be reused.
+    bool fullRedraw = m_fullRedrawNeeded || m_textEnabled;
+    m_fullRedrawNeeded = false;
+
+    if (fullRedraw) {
+        // Set the background color
+        libyuv::I420Rect(
+                compositeBuffer->MutableDataY(), compositeBuffer->StrideY(),
+                compositeBuffer->MutableDataU(), compositeBuffer->StrideU(),
+                compositeBuffer->MutableDataV(), compositeBuffer->StrideV(),
+                0, 0, compositeBuffer->width(), compositeBuffer->height(),
+                m_bgColor.y, m_bgColor.cb, m_bgColor.cr);
+    }
+
+    // Only regions whose input sequence moved since they were last composed
+    // need a re-blit; static slides and near-still webcams skip their
+    // scale+copy entirely. The sequence is captured before composing, a
+    // frame racing in mid-compose shows up as dirty again next tick.
+    //
+    // With compose throttling on, regions of participants other than the
+    // primary speaker refresh only on their phase slot; skipped ones stay
+    // marked dirty and catch up on their next slot.
+    m_tickCount++;
+    uint32_t throttleFps = composeThrottleFps();
+    uint64_t throttleDiv = (throttleFps > 0 && throttleFps < m_maxSupportedFps)
+            ? m_maxSupportedFps / throttleFps : 1;
+    int activeInput = m_owner->m_activeInput.load(std::memory_order_relaxed);
+
+    LayoutSolution dirtyRegions;
+    for (LayoutSolution::iterator it = m_layout.begin(); it != m_layout.end(); ++it) {
+        uint64_t seq = m_owner->getInputSequence(it->input);
+        uint64_t &composed = m_composedInputSeq[it->input];
+        if (!fullRedraw && composed == seq)
+            continue;
+        if (!fullRedraw && throttleDiv > 1 && it->input != activeInput
+                && (m_tickCount % throttleDiv) != (uint64_t)(it->input % (int)throttleDiv))
+            continue;
+        dirtyRegions.push_back(*it);
+        composed = seq;
+    }
 
-            regions_begin = regions_end;
-            advance(regions_end, nParallelRegions);
+    bool isParallelFrameComposition = m_parallelNum > 1 && dirtyRegions.size() > 1;
 
+    if (isParallelFrameComposition) {
+        // One task per region: idle workers pull the next region off the
+        // shared queue, so one large region does not leave the rest of the
+        // canvas waiting behind it the way fixed per-thread chunks did. The
+        // first region runs on this thread instead of idling on the waits.
+        std::vector<boost::shared_ptr<boost::packaged_task<void>>> tasks;
+        LayoutSolution::iterator it = dirtyRegions.begin();
+        LayoutSolution firstRegion(it, std::next(it));
+        for (++it; it != dirtyRegions.end(); ++it) {
             boost::shared_ptr<boost::packaged_task<void>> task = boost::make_shared<boost::packaged_task<void>>(
                     boost::bind(SoftFrameGenerator::layout_regions,
                         this,
                         compositeBuffer,
-                        LayoutSolution(regions_begin, regions_end))
+                        LayoutSolution(it, std::next(it)))
                     );
-            m_srv->post(boost::bind(&boost::packaged_task<void>::operator(), task));
+            ComposePool::instance().service().post(boost::bind(&boost::packaged_task<void>::operator(), task));
             tasks.push_back(task);
-
-            nRegions -= nParallelRegions;
         }
 
+        layout_regions(this, compositeBuffer, firstRegion);
+
         for (auto& task : tasks)
             task->get_future().wait();
     } else {
-        layout_regions(this, compositeBuffer, m_layout);
+        layout_regions(this, compositeBuffer, dirtyRegions);
     }
 
     return compositeBuffer;
@@ -584,6 +959,16 @@ void SoftFrameGenerator::reconfigureIfNeeded()
 
         m_layout = m_newLayout;
         m_configureChanged = false;
+
+        // Region geometry moved, the whole canvas has to be repainted and
+        // the per-input compose history restarted.
+        m_fullRedrawNeeded = true;
+        m_composedInputSeq.clear();
+
+        {
+            boost::unique_lock<boost::shared_mutex> cacheLock(m_scaledAvatarMutex);
+            m_scaledAvatars.clear();
+        }
     }
 
     ELOG_DEBUG_T("reconfigure");
@@ -593,17 +978,22 @@ void SoftFrameGenerator::drawText(const std::string& textSpec)
 {
     m_textDrawer->setText(textSpec);
     m_textDrawer->enable(true);
+    m_textEnabled = true;
 }
 
 void SoftFrameGenerator::clearText()
 {
     m_textDrawer->enable(false);
+    m_textEnabled = false;
+    // One repaint to take the last rendered text off the canvas.
+    m_fullRedrawNeeded = true;
 }
 
 DEFINE_LOGGER(SoftVideoCompositor, "mcu.media.SoftVideoCompositor");
 
 SoftVideoCompositor::SoftVideoCompositor(uint32_t maxInput, VideoSize rootSize, YUVColor bgColor, bool crop)
     : m_maxInput(maxInput)
+    , m_activeInput(-1)
 {
     m_inputs.resize(m_maxInput);
     for (auto& input : m_inputs) {
@@ -654,6 +1044,11 @@ void SoftVideoCompositor::deActivateInput(int input)
     m_inputs[input]->setActive(false);
 }
 
+void SoftVideoCompositor::setActiveInput(int input)
+{
+    m_activeInput.store(input, std::memory_order_relaxed);
+}
+
 bool SoftVideoCompositor::setAvatar(int input, const std::string& avatar)
 {
     return m_avatarManager->setAvatar(input, avatar);
@@ -700,20 +1095,29 @@ bool SoftVideoCompositor::removeOutput(owt_base::FrameDestination *dst)
     return false;
 }
 
-boost::shared_ptr<webrtc::VideoFrame> SoftVideoCompositor::getInputFrame(int index)
+boost::shared_ptr<webrtc::VideoFrame> SoftVideoCompositor::getInputFrame(int index, bool &fromAvatar)
 {
     boost::shared_ptr<webrtc::VideoFrame> src;
 
+    fromAvatar = false;
     auto& input = m_inputs[index];
     if (input->isActive()) {
         src = input->popInput();
     } else {
         src = m_avatarManager->getAvatarFrame(index);
+        fromAvatar = (src != NULL);
     }
 
     return src;
 }
 
+uint64_t SoftVideoCompositor::getInputSequence(int index)
+{
+    // Both counters only ever increment, any new frame, activation change
+    // or avatar change moves the sum.
+    return m_inputs[index]->sequence() + m_avatarManager->sequence();
+}
+
 void SoftVideoCompositor::drawText(const std::string& textSpec)
 {
     for (auto& generator : m_generators) {
@@ -728,4 +1132,16 @@ void SoftVideoCompositor::clearText()
     }
 }
 
+void SoftVideoCompositor::setSnapshotBuffer(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer)
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_snapshotMutex);
+    m_snapshotBuffer = buffer;
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> SoftVideoCompositor::getSnapshotBuffer()
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_snapshotMutex);
+    return m_snapshotBuffer;
+}
+
 }
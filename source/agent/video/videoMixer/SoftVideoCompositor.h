@@ -5,6 +5,8 @@
 #ifndef SoftVideoCompositor_h
 #define SoftVideoCompositor_h
 
+#include <atomic>
+#include <tuple>
 #include <vector>
 
 #include <boost/scoped_ptr.hpp>
@@ -20,6 +22,7 @@
 #include "JobTimer.h"
 #include "MediaFramePipeline.h"
 #include "FrameConverter.h"
+#include "HostLoadGovernor.h"
 #include "VideoFrameMixer.h"
 #include "VideoLayout.h"
 #include "I420BufferManager.h"
@@ -40,6 +43,10 @@ public:
 
     boost::shared_ptr<webrtc::VideoFrame> getAvatarFrame(uint8_t index);
 
+    // Bumped on every avatar change, part of the input sequence the
+    // generators use for dirty-region tracking.
+    uint64_t sequence() { return m_seq.load(std::memory_order_relaxed); }
+
 protected:
     bool getImageSize(const std::string &url, uint32_t *pWidth, uint32_t *pHeight);
     boost::shared_ptr<webrtc::VideoFrame> loadImage(const std::string &url);
@@ -50,6 +57,8 @@ private:
     std::map<uint8_t, std::string> m_inputs;
     std::map<std::string, boost::shared_ptr<webrtc::VideoFrame>> m_frames;
 
+    std::atomic<uint64_t> m_seq{0};
+
     boost::shared_mutex m_mutex;
 };
 
@@ -66,17 +75,30 @@ public:
     void pushInput(webrtc::VideoFrame *videoFrame);
     boost::shared_ptr<webrtc::VideoFrame> popInput();
 
+    // Bumped on every new frame and on activation changes, so a generator
+    // can tell whether this input changed since it last composed it.
+    uint64_t sequence() { return m_seq.load(std::memory_order_relaxed); }
+
 private:
-    bool m_active;
+    std::atomic<bool> m_active;
+    // Latest-frame slot, published and fetched with boost's atomic
+    // shared_ptr accessors so the writer and the compose threads never
+    // block each other. The pixel storage behind it is triple-buffered by
+    // m_bufferManager, which never hands a buffer still referenced by a
+    // reader back to the writer.
     boost::shared_ptr<webrtc::VideoFrame> m_busyFrame;
-    boost::shared_mutex m_mutex;
+    std::atomic<uint64_t> m_seq{0};
+
+    // motion classification state: low-motion inputs publish every other
+    // frame, static ones not at all (see pushInput)
+    bool m_lowMotionToggle;
 
     boost::scoped_ptr<owt_base::I420BufferManager> m_bufferManager;
 
     boost::scoped_ptr<owt_base::FrameConverter> m_converter;
 };
 
-class SoftFrameGenerator : public JobTimerListener
+class SoftFrameGenerator : public JobTimerListener, public owt_base::HostLoadShedder
 {
     DECLARE_LOGGER();
 
@@ -112,11 +134,19 @@ public:
 
     void onTimeout() override;
 
+    // Implements owt_base::HostLoadShedder.
+    void onShedLevel(uint32_t level) override;
+
 protected:
     rtc::scoped_refptr<webrtc::VideoFrameBuffer> generateFrame();
     rtc::scoped_refptr<webrtc::VideoFrameBuffer> layout();
     static void layout_regions(SoftFrameGenerator *t, rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer, const LayoutSolution &regions);
 
+    rtc::scoped_refptr<webrtc::I420Buffer> getScaledAvatar(
+            rtc::scoped_refptr<webrtc::VideoFrameBuffer> srcBuffer,
+            uint32_t srcX, uint32_t srcY, uint32_t srcWidth, uint32_t srcHeight,
+            uint32_t dstWidth, uint32_t dstHeight);
+
     void reconfigureIfNeeded();
 
 private:
@@ -128,6 +158,11 @@ private:
 
     uint32_t m_counter;
     uint32_t m_counterMax;
+    uint64_t m_tickCount;
+
+    // Under host-wide shedding, compose on every (level + 1)th tick; only
+    // touched on the shared timer thread.
+    uint32_t m_shedLevel;
 
     std::vector<std::list<Output_t>>    m_outputs;
     boost::shared_mutex                 m_outputMutex;
@@ -143,15 +178,34 @@ private:
     bool                        m_configureChanged;
     boost::shared_mutex         m_configMutex;
 
-    boost::scoped_ptr<owt_base::I420BufferManager> m_bufferManager;
+    // dirty-region compositing: the canvas persists across ticks and only
+    // regions whose input sequence moved since they were last composed get
+    // re-blitted; everything else keeps its pixels.
+    rtc::scoped_refptr<webrtc::I420Buffer> m_canvas;
+    std::map<int, uint64_t>     m_composedInputSeq;
+    bool                        m_fullRedrawNeeded;
+    bool                        m_textEnabled;
+
+    // pre-scaled avatar cache: an avatar never changes between avatar or
+    // layout updates, so its crop+scale result per region geometry is
+    // computed once and blitted with a plain copy afterwards. Keyed by the
+    // source buffer pointer, which AvatarManager keeps stable for the
+    // lifetime of a loaded avatar.
+    typedef std::tuple<const void *, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t> ScaledAvatarKey;
+    std::map<ScaledAvatarKey, rtc::scoped_refptr<webrtc::I420Buffer>> m_scaledAvatars;
+    boost::shared_mutex         m_scaledAvatarMutex;
+
+    // output pyramid: persistent per-size buffers the composed canvas is
+    // cascaded into before delivery, so each distinct lower output
+    // resolution costs one downscale instead of one inside every encoder.
+    // Touched only on the tick thread under m_outputMutex.
+    std::map<uint64_t, rtc::scoped_refptr<webrtc::I420Buffer>> m_pyramidBuffers;
 
     boost::scoped_ptr<JobTimer> m_jobTimer;
 
-    // parallel composition
+    // parallel composition, workers come from the process-wide pool shared
+    // by all generators (see ComposePool in SoftVideoCompositor.cpp)
     uint32_t m_parallelNum;
-    boost::shared_ptr<boost::asio::io_service> m_srv;
-    boost::shared_ptr<boost::asio::io_service::work> m_srvWork;
-    boost::shared_ptr<boost::thread_group> m_thrGrp;
 
     boost::shared_ptr<owt_base::FFmpegDrawText> m_textDrawer;
 };
@@ -171,6 +225,7 @@ public:
 
     bool activateInput(int input);
     void deActivateInput(int input);
+    void setActiveInput(int input);
     bool setAvatar(int input, const std::string& avatar);
     bool unsetAvatar(int input);
     void pushInput(int input, const owt_base::Frame&);
@@ -185,8 +240,15 @@ public:
     void drawText(const std::string& textSpec);
     void clearText();
 
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> getSnapshotBuffer() override;
+
 protected:
-    boost::shared_ptr<webrtc::VideoFrame> getInputFrame(int index);
+    boost::shared_ptr<webrtc::VideoFrame> getInputFrame(int index, bool &fromAvatar);
+    uint64_t getInputSequence(int index);
+    // Called by the generators on every composed tick. The canvas persists
+    // and is composed in place, so a concurrent snapshot may observe a
+    // partially updated tick - acceptable for previews.
+    void setSnapshotBuffer(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer);
 
 private:
     uint32_t m_maxInput;
@@ -195,6 +257,14 @@ private:
 
     std::vector<boost::shared_ptr<SoftInput>> m_inputs;
     boost::scoped_ptr<AvatarManager> m_avatarManager;
+
+    // the current primary speaker, fed from the controller's setPrimary;
+    // generators keep its region at full rate when compose throttling is on
+    std::atomic<int> m_activeInput;
+
+    // the most recently composed canvas, retained for on-demand previews
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> m_snapshotBuffer;
+    boost::shared_mutex m_snapshotMutex;
 };
 
 }
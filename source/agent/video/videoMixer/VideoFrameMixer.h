@@ -8,6 +8,8 @@
 #include "VideoLayout.h"
 #include <MediaFramePipeline.h>
 
+#include <webrtc/api/video/video_frame_buffer.h>
+
 namespace mcu {
 
 // VideoFrameCompositor accepts the raw I420VideoFrame from multiple inputs and
@@ -17,6 +19,7 @@ class VideoFrameCompositor : public owt_base::FrameSource {
 public:
     virtual bool activateInput(int input) = 0;
     virtual void deActivateInput(int input) = 0;
+    virtual void setActiveInput(int input) = 0;
     virtual bool setAvatar(int input, const std::string& avatar) = 0;
     virtual bool unsetAvatar(int input) = 0;
     virtual void pushInput(int input, const owt_base::Frame&) = 0;
@@ -27,6 +30,11 @@ public:
 
     virtual void drawText(const std::string& textSpec) = 0;
     virtual void clearText() = 0;
+
+    // The most recently composed frame, for on-demand previews; null when
+    // nothing has been composed yet or the compositor cannot hand its
+    // surfaces out as raw buffers (hardware path).
+    virtual rtc::scoped_refptr<webrtc::VideoFrameBuffer> getSnapshotBuffer() { return nullptr; }
 };
 
 // VideoFrameMixer accepts frames from multiple inputs and mixes them.
@@ -36,6 +44,7 @@ public:
     virtual bool addInput(int input, owt_base::FrameFormat, owt_base::FrameSource*, const std::string& avatar) = 0;
     virtual void removeInput(int input) = 0;
     virtual void setInputActive(int input, bool active) = 0;
+    virtual void setActiveInput(int input) = 0;
 
     virtual bool addOutput(int output,
             owt_base::FrameFormat,
@@ -54,6 +63,10 @@ public:
 
     virtual void drawText(const std::string& textSpec) = 0;
     virtual void clearText() = 0;
+
+    // On-demand JPEG thumbnail of the most recent composed frame; polled by
+    // dashboards instead of subscribing a video output per preview tile.
+    virtual bool getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg) = 0;
 };
 
 }
@@ -7,6 +7,7 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <map>
 #include <MediaUtilities.h>
@@ -18,6 +19,7 @@
 #include <VCMFrameEncoder.h>
 
 #include <FFmpegFrameDecoder.h>
+#include <SnapshotEncoder.h>
 
 #ifdef ENABLE_MSDK
 #include "MsdkVideoCompositor.h"
@@ -29,6 +31,10 @@
 #include <SVTHEVCEncoder.h>
 #endif
 
+#ifdef ENABLE_SVT_AV1_ENCODER
+#include <SVTAV1Encoder.h>
+#endif
+
 namespace mcu {
 
 class CompositeIn : public owt_base::FrameDestination
@@ -61,6 +67,7 @@ public:
     bool addInput(int input, owt_base::FrameFormat, owt_base::FrameSource*, const std::string& avatar);
     void removeInput(int input);
     void setInputActive(int input, bool active);
+    void setActiveInput(int input);
 
     bool addOutput(int output,
             owt_base::FrameFormat,
@@ -79,6 +86,8 @@ public:
     void drawText(const std::string& textSpec);
     void clearText();
 
+    bool getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg);
+
 private:
     struct Input {
         owt_base::FrameSource* source;
@@ -100,6 +109,10 @@ private:
     boost::shared_mutex m_outputMutex;
 
     bool m_useSimulcast;
+
+    // Created on the first snapshot poll; rooms nobody previews pay nothing.
+    boost::scoped_ptr<owt_base::SnapshotEncoder> m_snapshotEncoder;
+    boost::mutex m_snapshotMutex;
 };
 
 VideoFrameMixerImpl::VideoFrameMixerImpl(uint32_t maxInput, owt_base::VideoSize rootSize, owt_base::YUVColor bgColor, bool useSimulcast, bool crop)
@@ -204,6 +217,11 @@ inline void VideoFrameMixerImpl::setInputActive(int input, bool active)
     }
 }
 
+inline void VideoFrameMixerImpl::setActiveInput(int input)
+{
+    m_compositor->setActiveInput(input);
+}
+
 inline void VideoFrameMixerImpl::updateLayoutSolution(LayoutSolution& solution)
 {
     m_compositor->updateLayoutSolution(solution);
@@ -261,6 +279,11 @@ inline bool VideoFrameMixerImpl::addOutput(int output,
             encoder.reset(new owt_base::SVTHEVCEncoder(format, profile, m_useSimulcast));
 #endif
 
+#if ENABLE_SVT_AV1_ENCODER
+        if (!encoder && format == owt_base::FRAME_FORMAT_AV1)
+            encoder.reset(new owt_base::SVTAV1Encoder(format, profile, m_useSimulcast));
+#endif
+
         if (!encoder && owt_base::VCMFrameEncoder::supportFormat(format))
             encoder.reset(new owt_base::VCMFrameEncoder(format, profile, m_useSimulcast));
 
@@ -305,5 +328,18 @@ inline void VideoFrameMixerImpl::clearText()
     m_compositor->clearText();
 }
 
+inline bool VideoFrameMixerImpl::getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg)
+{
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer = m_compositor->getSnapshotBuffer();
+    if (!buffer)
+        return false;
+
+    boost::lock_guard<boost::mutex> guard(m_snapshotMutex);
+    if (!m_snapshotEncoder)
+        m_snapshotEncoder.reset(new owt_base::SnapshotEncoder());
+
+    return m_snapshotEncoder->encode(buffer, maxWidth, maxHeight, jpeg);
+}
+
 }
 #endif
@@ -56,11 +56,10 @@ VideoMixer::VideoMixer(const VideoMixerConfig& config)
     }
 
 #ifdef ENABLE_MSDK
-    MsdkBase *msdkBase = MsdkBase::get();
-    if(msdkBase != NULL) {
-        msdkBase->setConfigHevcEncoderGaccPlugin(config.useGacc);
-        msdkBase->setConfigMFETimeout(config.MFE_timeout);
-    }
+    // Record the config only; MsdkBase::get() opens the DRM device and
+    // initializes VA, which is deferred to the first stream that needs the
+    // GPU so a freshly spawned agent starts in milliseconds.
+    MsdkBase::configure(config.useGacc, config.MFE_timeout);
 #endif
 
     ELOG_INFO("Init maxInput(%u), rootSize(%u, %u), bgColor(%u, %u, %u)", m_maxInputCount, rootSize.width, rootSize.height, bgColor.y, bgColor.cb, bgColor.cr);
@@ -115,6 +114,15 @@ void VideoMixer::setInputActive(const int inputIndex, bool active)
     }
 }
 
+void VideoMixer::setActiveInput(const int inputIndex)
+{
+    if (m_inputs.find(inputIndex) != m_inputs.end()) {
+        m_frameMixer->setActiveInput(inputIndex);
+    } else {
+        ELOG_WARN("setActiveInput no such input:%d", inputIndex);
+    }
+}
+
 bool VideoMixer::addOutput(
     const std::string& outStreamID
     , const std::string& codec
@@ -209,6 +217,11 @@ void VideoMixer::clearText()
     m_frameMixer->clearText();
 }
 
+bool VideoMixer::getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg)
+{
+    return m_frameMixer->getSnapshot(maxWidth, maxHeight, jpeg);
+}
+
 void VideoMixer::closeAll()
 {
     ELOG_DEBUG("closeAll");
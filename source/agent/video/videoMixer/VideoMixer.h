@@ -41,6 +41,7 @@ public:
     bool addInput(const int inputIndex, const std::string& codec, owt_base::FrameSource* source, const std::string& avatar);
     void removeInput(const int inputIndex);
     void setInputActive(const int inputIndex, bool active);
+    void setActiveInput(const int inputIndex);
     bool addOutput(const std::string& outStreamID
             , const std::string& codec
             , const owt_base::VideoCodecProfile profile
@@ -58,6 +59,9 @@ public:
     void drawText(const std::string& textSpec);
     void clearText();
 
+    // On-demand JPEG thumbnail of the most recent composed frame.
+    bool getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg);
+
 private:
     void closeAll();
 
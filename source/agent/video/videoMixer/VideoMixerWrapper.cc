@@ -8,6 +8,7 @@
 
 #include "VideoMixerWrapper.h"
 #include "VideoLayout.h"
+#include <node_buffer.h>
 
 using namespace v8;
 
@@ -26,12 +27,14 @@ void VideoMixer::Init(Handle<Object> exports, Handle<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "addInput", addInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeInput", removeInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "setInputActive", setInputActive);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "setActiveInput", setActiveInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addOutput", addOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeOutput", removeOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "updateLayoutSolution", updateLayoutSolution);
   NODE_SET_PROTOTYPE_METHOD(tpl, "forceKeyFrame", forceKeyFrame);
   NODE_SET_PROTOTYPE_METHOD(tpl, "drawText", drawText);
   NODE_SET_PROTOTYPE_METHOD(tpl, "clearText", clearText);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getSnapshot", getSnapshot);
 
   constructor.Reset(isolate, tpl->GetFunction());
   module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -126,6 +129,18 @@ void VideoMixer::setInputActive(const v8::FunctionCallbackInfo<v8::Value>& args)
   me->setInputActive(inputIndex, active);
 }
 
+void VideoMixer::setActiveInput(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoMixer* obj = ObjectWrap::Unwrap<VideoMixer>(args.Holder());
+  mcu::VideoMixer* me = obj->me;
+
+  int inputIndex = args[0]->Int32Value();
+
+  me->setActiveInput(inputIndex);
+}
+
 void VideoMixer::addOutput(const v8::FunctionCallbackInfo<v8::Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -275,3 +290,22 @@ void VideoMixer::clearText(const v8::FunctionCallbackInfo<v8::Value>& args) {
   me->clearText();
 }
 
+void VideoMixer::getSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoMixer* obj = ObjectWrap::Unwrap<VideoMixer>(args.Holder());
+  mcu::VideoMixer* me = obj->me;
+
+  unsigned int maxWidth = args[0]->Uint32Value();
+  unsigned int maxHeight = args[1]->Uint32Value();
+
+  std::vector<uint8_t> jpeg;
+  if (me->getSnapshot(maxWidth, maxHeight, jpeg)) {
+    args.GetReturnValue().Set(
+        node::Buffer::Copy(isolate, reinterpret_cast<const char*>(jpeg.data()), jpeg.size()).ToLocalChecked());
+  } else {
+    args.GetReturnValue().Set(Undefined(isolate));
+  }
+}
+
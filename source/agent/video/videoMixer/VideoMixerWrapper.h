@@ -30,6 +30,7 @@ class VideoMixer : public node::ObjectWrap {
   static void addInput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void removeInput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void setInputActive(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void setActiveInput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addOutput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void removeOutput(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -38,6 +39,8 @@ class VideoMixer : public node::ObjectWrap {
 
   static void drawText(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void clearText(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void getSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif
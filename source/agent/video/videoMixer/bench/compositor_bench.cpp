@@ -0,0 +1,265 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Standalone compose-throughput benchmark for the video mixer.
+//
+// Drives a compositor through the VideoFrameCompositor interface with
+// synthetic inputs across grid layouts (1/4/9/25/49 tiles) and root
+// resolutions, and reports delivered frames/sec plus CPU microseconds per
+// composed tile. The numbers include the input-side convert copies, the
+// same work the real agent pays per pushed frame.
+//
+// Build with the Makefile in this directory (the full agent build
+// environment is required); MSDK=1 adds the hardware compositor, selected
+// at runtime with --msdk.
+//
+// Usage: ./compositor_bench [--msdk] [--static] [--seconds N]
+//   --static  push one frame per input and stop, measuring how cheap
+//             unchanged regions are, instead of full-motion 30fps feeds.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MediaFramePipeline.h"
+#include "SoftVideoCompositor.h"
+#include "VideoFrameMixer.h"
+#include "VideoLayout.h"
+
+#ifdef ENABLE_MSDK
+#include "MsdkVideoCompositor.h"
+#endif
+
+using namespace mcu;
+
+namespace {
+
+const uint32_t kInputWidth = 640;
+const uint32_t kInputHeight = 360;
+const uint32_t kInputFps = 30;
+const uint32_t kOutputFps = 30;
+const uint32_t kMaxInput = 49;
+
+class FrameCounter : public owt_base::FrameDestination {
+public:
+    FrameCounter() : m_count(0) {}
+
+    void onFrame(const owt_base::Frame&) override
+    {
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() { return m_count.load(std::memory_order_relaxed); }
+    void reset() { m_count.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_count;
+};
+
+// One synthetic source per input: a diagonal gradient that shifts every
+// frame, so no stage can shortcut on identical content.
+class Feeder {
+public:
+    Feeder(VideoFrameCompositor *compositor, int input, bool oneShot)
+        : m_compositor(compositor)
+        , m_input(input)
+        , m_oneShot(oneShot)
+        , m_running(true)
+        , m_thread(&Feeder::run, this)
+    {
+    }
+
+    ~Feeder()
+    {
+        m_running = false;
+        m_thread.join();
+    }
+
+private:
+    void run()
+    {
+        rtc::scoped_refptr<webrtc::I420Buffer> buffer =
+            webrtc::I420Buffer::Create(kInputWidth, kInputHeight);
+        uint32_t tick = 0;
+
+        while (m_running) {
+            fill(buffer, tick++);
+
+            webrtc::VideoFrame videoFrame(buffer, webrtc::kVideoRotation_0, 0);
+
+            owt_base::Frame frame;
+            memset(&frame, 0, sizeof(frame));
+            frame.format = owt_base::FRAME_FORMAT_I420;
+            frame.payload = reinterpret_cast<uint8_t*>(&videoFrame);
+            frame.additionalInfo.video.width = kInputWidth;
+            frame.additionalInfo.video.height = kInputHeight;
+
+            m_compositor->pushInput(m_input, frame);
+
+            if (m_oneShot)
+                break;
+
+            usleep(1000000 / kInputFps);
+        }
+
+        while (m_running)
+            usleep(10000);
+    }
+
+    static void fill(rtc::scoped_refptr<webrtc::I420Buffer> &buffer, uint32_t tick)
+    {
+        for (uint32_t y = 0; y < kInputHeight; y++) {
+            uint8_t *row = buffer->MutableDataY() + y * buffer->StrideY();
+            for (uint32_t x = 0; x < kInputWidth; x++)
+                row[x] = (uint8_t)(x + y + tick * 4);
+        }
+        memset(buffer->MutableDataU(), 128, buffer->StrideU() * ((kInputHeight + 1) / 2));
+        memset(buffer->MutableDataV(), 128, buffer->StrideV() * ((kInputHeight + 1) / 2));
+    }
+
+    VideoFrameCompositor *m_compositor;
+    int m_input;
+    bool m_oneShot;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+LayoutSolution gridLayout(uint32_t tiles)
+{
+    uint32_t n = 1;
+    while (n * n < tiles)
+        n++;
+
+    LayoutSolution solution;
+    for (uint32_t i = 0; i < tiles; i++) {
+        InputRegion r;
+        r.input = (int)i;
+        r.region.id = std::to_string(i);
+        r.region.shape = "rectangle";
+        r.region.area.rect.left = Rational{i % n, n};
+        r.region.area.rect.top = Rational{i / n, n};
+        r.region.area.rect.width = Rational{1, n};
+        r.region.area.rect.height = Rational{1, n};
+        solution.push_back(r);
+    }
+    return solution;
+}
+
+uint64_t nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t cpuUs()
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t)ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec
+         + (uint64_t)ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec;
+}
+
+void runScenario(VideoFrameCompositor *compositor, const owt_base::VideoSize &rootSize,
+        uint32_t tiles, bool oneShot, uint32_t seconds)
+{
+    LayoutSolution solution = gridLayout(tiles);
+    compositor->updateLayoutSolution(solution);
+    for (uint32_t i = 0; i < tiles; i++)
+        compositor->activateInput((int)i);
+
+    std::vector<std::unique_ptr<Feeder>> feeders;
+    for (uint32_t i = 0; i < tiles; i++)
+        feeders.emplace_back(new Feeder(compositor, (int)i, oneShot));
+
+    // Let the layout settle and every input deliver at least once, so
+    // startup costs stay out of the numbers.
+    usleep(500000);
+
+    FrameCounter counter;
+    uint64_t wall0 = nowUs();
+    uint64_t cpu0 = cpuUs();
+
+    // The output resolution equals the root size, delivered at full rate.
+    compositor->addOutput(rootSize.width, rootSize.height, kOutputFps, &counter);
+    sleep(seconds);
+    uint64_t frames = counter.count();
+    compositor->removeOutput(&counter);
+
+    uint64_t wallUs = nowUs() - wall0;
+    uint64_t cpuUsed = cpuUs() - cpu0;
+
+    double fps = (double)frames * 1000000.0 / wallUs;
+    double perTile = frames ? (double)cpuUsed / ((double)frames * tiles) : 0.0;
+
+    printf("%6u | %9.2f | %13.1f | %8.1f\n", tiles, fps, perTile, (double)cpuUsed / 1000000.0);
+
+    feeders.clear();
+    for (uint32_t i = 0; i < tiles; i++)
+        compositor->deActivateInput((int)i);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool useMsdk = false;
+    bool oneShot = false;
+    uint32_t seconds = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--msdk"))
+            useMsdk = true;
+        else if (!strcmp(argv[i], "--static"))
+            oneShot = true;
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = (uint32_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--msdk] [--static] [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+#ifndef ENABLE_MSDK
+    if (useMsdk) {
+        fprintf(stderr, "built without MSDK support, rebuild with MSDK=1\n");
+        return 1;
+    }
+#endif
+
+    const uint32_t tileSteps[] = {1, 4, 9, 25, 49};
+    const owt_base::VideoSize rootSizes[] = {{1280, 720}, {1920, 1080}};
+    owt_base::YUVColor bgColor = {0x00, 0x80, 0x80};
+
+    for (auto& rootSize : rootSizes) {
+        boost::shared_ptr<VideoFrameCompositor> compositor;
+#ifdef ENABLE_MSDK
+        if (useMsdk)
+            compositor.reset(new MsdkVideoCompositor(kMaxInput, rootSize, bgColor, false));
+#endif
+        if (!compositor)
+            compositor.reset(new SoftVideoCompositor(kMaxInput, rootSize, bgColor, false));
+
+        printf("\n%s %ux%u, inputs %ux%u@%u, %s feeds, %us per layout\n",
+                useMsdk ? "msdk" : "soft", rootSize.width, rootSize.height,
+                kInputWidth, kInputHeight, kInputFps,
+                oneShot ? "static" : "full-motion", seconds);
+        printf(" tiles |       fps | cpu us/tile   | cpu sec\n");
+        printf("-------+-----------+---------------+---------\n");
+
+        for (uint32_t tiles : tileSteps)
+            runScenario(compositor.get(), rootSize, tiles, oneShot, seconds);
+    }
+
+    return 0;
+}
@@ -11,11 +11,19 @@
       '../../../../core/owt_base/FrameConverter.cpp',
       '../../../../core/owt_base/VCMFrameDecoder.cpp',
       '../../../../core/owt_base/VCMFrameEncoder.cpp',
+      '../../../../core/owt_base/ContentClassifier.cpp',
+      '../../../../core/owt_base/SnapshotEncoder.cpp',
+      '../../../../core/owt_base/EncoderLoadGovernor.cpp',
+      '../../../../core/owt_base/HostLoadGovernor.cpp',
+      '../../../../core/owt_base/EncodeThreadPool.cpp',
+      '../../../../core/owt_base/PayloadBufferPool.cpp',
+'../../../../core/owt_base/MemoryBudget.cpp',
       '../../../../core/owt_base/FFmpegFrameDecoder.cpp',
       '../../../../core/owt_base/MsdkFrameDecoder.cpp',
       '../../../../core/owt_base/MsdkFrameEncoder.cpp',
       '../../../../core/owt_base/MsdkBase.cpp',
       '../../../../core/owt_base/MsdkFrame.cpp',
+      '../../../../core/owt_base/StagingBufferPool.cpp',
       '../../../../core/owt_base/MsdkScaler.cpp',
       '../../../../core/owt_base/FastCopy.cpp',
       '../../../../../third_party/mediasdk/samples/sample_common/src/base_allocator.cpp',
@@ -52,5 +60,18 @@
       '<!@(pkg-config --libs libavcodec)',
       '<!@(pkg-config --libs libavformat)',
     ],
+    'variables': {
+      # GPL opt-in: build with OWT_BUILD_X264=1 to compile the x264 H.264
+      # backend (see core/owt_base/X264VideoEncoder.cpp); linking libx264
+      # makes the resulting addon GPL.
+      'build_x264%': '<!(echo ${OWT_BUILD_X264:-0})',
+    },
+    'conditions': [
+      ['build_x264=="1"', {
+        'sources': [ '../../../../core/owt_base/X264VideoEncoder.cpp' ],
+        'cflags_cc': [ '-DENABLE_X264_ENCODER' ],
+        'libraries': [ '<!@(pkg-config --libs x264)' ],
+      }],
+    ],
   }]
 }
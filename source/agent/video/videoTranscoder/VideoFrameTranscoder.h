@@ -43,6 +43,10 @@ public:
     virtual void drawText(const std::string& textSpec) = 0;
     virtual void clearText() = 0;
 #endif
+
+    // On-demand JPEG thumbnail of the most recent decoded frame; polled by
+    // dashboards instead of subscribing a full video output per preview.
+    virtual bool getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg) = 0;
 };
 
 }
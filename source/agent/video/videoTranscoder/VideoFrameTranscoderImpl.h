@@ -7,10 +7,13 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <map>
+#include <JobTimer.h>
 #include <MediaUtilities.h>
 #include <MediaFramePipeline.h>
+#include <SceneRateGovernor.h>
 #include <VideoFrameTranscoder.h>
 
 #include <VCMFrameDecoder.h>
@@ -19,6 +22,7 @@
 #include <FFmpegFrameDecoder.h>
 
 #include <FrameProcesser.h>
+#include <SnapshotEncoder.h>
 #ifdef BUILD_FOR_ANALYTICS
 #include <FrameAnalyzer.h>
 #endif
@@ -32,9 +36,13 @@
 #include <SVTHEVCEncoder.h>
 #endif
 
+#ifdef ENABLE_SVT_AV1_ENCODER
+#include <SVTAV1Encoder.h>
+#endif
+
 namespace mcu {
 
-class VideoFrameTranscoderImpl : public VideoFrameTranscoder, public owt_base::FrameSource, public owt_base::FrameDestination {
+class VideoFrameTranscoderImpl : public VideoFrameTranscoder, public owt_base::FrameSource, public owt_base::FrameDestination, public JobTimerListener {
 public:
     VideoFrameTranscoderImpl();
     ~VideoFrameTranscoderImpl();
@@ -71,14 +79,47 @@ public:
     void clearText();
 #endif
 
-    void onFrame(const owt_base::Frame& frame) {deliverFrame(frame);}
+    void onFrame(const owt_base::Frame& frame)
+    {
+        // Retain the newest decoded picture for on-demand previews; a
+        // refcount bump, the pixels are not copied. The hardware (MSDK)
+        // format stays on GPU surfaces and is not retained.
+        if (frame.format == owt_base::FRAME_FORMAT_I420) {
+            webrtc::VideoFrame* videoFrame = reinterpret_cast<webrtc::VideoFrame*>(frame.payload);
+            boost::lock_guard<boost::mutex> guard(m_snapshotMutex);
+            m_snapshotBuffer = videoFrame->video_frame_buffer();
+        }
+        deliverFrame(frame);
+    }
+
+    bool getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg);
+
+    // Implements the JobTimerListener; drives the decode idle countdown.
+    void onTimeout();
 
 private:
     struct Input {
         owt_base::FrameSource* source;
         boost::shared_ptr<owt_base::VideoFrameDecoder> decoder;
+        // Whether the source currently feeds the decoder. Inputs are kept
+        // unlinked while no output consumes decoded frames, so a
+        // passthrough-only transcoder burns no decode CPU.
+        bool linked;
+        // Complexity tap for the scene rate governor; attached for the
+        // input's whole lifetime (it only reads frame sizes), independent
+        // of the decoder link above. Null when the governor is disabled.
+        boost::shared_ptr<owt_base::SceneRateGovernor::InputTap> tap;
     };
 
+    // Links every input's source to its decoder; called when the first
+    // output appears. Takes m_inputMutex only - callers may hold
+    // m_outputMutex (that order is the rule everywhere here).
+    void activateDecode();
+    // Starts the idle countdown once the last output is gone; the decoders
+    // are unlinked after kDecodeIdleTimeoutSec so a brief
+    // unsubscribe/resubscribe does not cost a decoder warm-up.
+    void startIdleCountdown();
+
     struct Output {
         boost::shared_ptr<owt_base::VideoFrameProcesser> processer;
 #ifdef BUILD_FOR_ANALYTICS
@@ -86,28 +127,55 @@ private:
 #endif
         boost::shared_ptr<owt_base::VideoFrameEncoder> encoder;
         int streamId;
+        // Handle from the scene rate governor, -1 when not registered.
+        int rateHandle;
     };
 
+    static const uint32_t kDecodeIdleTimeoutSec = 30;
+
     std::map<int, Input> m_inputs;
     boost::shared_mutex m_inputMutex;
 
     std::map<int, Output> m_outputs;
     boost::shared_mutex m_outputMutex;
+
+    // Guarded by m_inputMutex.
+    bool m_decodeActive;
+    bool m_countingIdle;
+    uint32_t m_idleSeconds;
+    // Created lazily on the first idle period and kept until destruction;
+    // destroying it from its own callback would deadlock on the shared
+    // timing thread's drain barrier.
+    boost::scoped_ptr<JobTimer> m_idleTimer;
+
+    // The newest decoded picture and the preview encoder serving it; the
+    // encoder is created on the first snapshot poll.
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> m_snapshotBuffer;
+    boost::mutex m_snapshotMutex;
+    boost::scoped_ptr<owt_base::SnapshotEncoder> m_snapshotEncoder;
 };
 
 VideoFrameTranscoderImpl::VideoFrameTranscoderImpl()
+    : m_decodeActive(false)
+    , m_countingIdle(false)
+    , m_idleSeconds(0)
 {
 }
 
 VideoFrameTranscoderImpl::~VideoFrameTranscoderImpl()
 {
+    m_idleTimer.reset();
+
     {
         boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
         for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+            if (it->second.rateHandle >= 0)
+                owt_base::SceneRateGovernor::instance().unregisterRung(it->second.rateHandle);
             this->removeVideoDestination(it->second.processer.get());
 #ifdef BUILD_FOR_ANALYTICS
             it->second.processer->removeVideoDestination(it->second.analyzer.get());
             it->second.analyzer->removeVideoDestination(it->second.encoder.get());
+            it->second.analyzer->removeRoiConsumer(it->second.encoder.get());
 #else
             it->second.processer->removeVideoDestination(it->second.encoder.get());
 #endif
@@ -119,7 +187,10 @@ VideoFrameTranscoderImpl::~VideoFrameTranscoderImpl()
     {
         boost::unique_lock<boost::shared_mutex> lock(m_inputMutex);
         for (auto it = m_inputs.begin(); it != m_inputs.end(); ++it) {
-            it->second.source->removeVideoDestination(it->second.decoder.get());
+            if (it->second.linked)
+                it->second.source->removeVideoDestination(it->second.decoder.get());
+            if (it->second.tap)
+                it->second.source->removeVideoDestination(it->second.tap.get());
             it->second.decoder->removeVideoDestination(this);
             m_inputs.erase(it);
         }
@@ -154,9 +225,17 @@ inline bool VideoFrameTranscoderImpl::setInput(int input, owt_base::FrameFormat
 
     if (decoder->init(format)) {
         decoder->addVideoDestination(this);
-        source->addVideoDestination(decoder.get());
         boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
-        Input in{.source = source, .decoder = decoder};
+        // Feed the decoder only while some output consumes decoded frames;
+        // until then the source keeps the compressed stream to itself.
+        if (m_decodeActive)
+            source->addVideoDestination(decoder.get());
+        boost::shared_ptr<owt_base::SceneRateGovernor::InputTap> tap;
+        if (owt_base::SceneRateGovernor::enabled()) {
+            tap.reset(new owt_base::SceneRateGovernor::InputTap(this));
+            source->addVideoDestination(tap.get());
+        }
+        Input in{.source = source, .decoder = decoder, .linked = m_decodeActive, .tap = tap};
         m_inputs[input] = in;
         return true;
     }
@@ -168,13 +247,60 @@ inline void VideoFrameTranscoderImpl::unsetInput(int input)
     boost::upgrade_lock<boost::shared_mutex> lock(m_inputMutex);
     auto it = m_inputs.find(input);
     if (it != m_inputs.end()) {
-        it->second.source->removeVideoDestination(it->second.decoder.get());
+        if (it->second.linked)
+            it->second.source->removeVideoDestination(it->second.decoder.get());
+        if (it->second.tap)
+            it->second.source->removeVideoDestination(it->second.tap.get());
         it->second.decoder->removeVideoDestination(this);
         boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
         m_inputs.erase(it);
     }
 }
 
+inline void VideoFrameTranscoderImpl::activateDecode()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_inputMutex);
+    m_countingIdle = false;
+    m_idleSeconds = 0;
+    if (m_decodeActive)
+        return;
+    for (auto it = m_inputs.begin(); it != m_inputs.end(); ++it) {
+        if (!it->second.linked) {
+            it->second.source->addVideoDestination(it->second.decoder.get());
+            it->second.linked = true;
+        }
+    }
+    m_decodeActive = true;
+}
+
+inline void VideoFrameTranscoderImpl::startIdleCountdown()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_inputMutex);
+    if (!m_decodeActive)
+        return;
+    m_countingIdle = true;
+    m_idleSeconds = 0;
+    if (!m_idleTimer)
+        m_idleTimer.reset(new JobTimer(1, this));
+}
+
+inline void VideoFrameTranscoderImpl::onTimeout()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_inputMutex);
+    if (!m_countingIdle)
+        return;
+    if (++m_idleSeconds < kDecodeIdleTimeoutSec)
+        return;
+    for (auto it = m_inputs.begin(); it != m_inputs.end(); ++it) {
+        if (it->second.linked) {
+            it->second.source->removeVideoDestination(it->second.decoder.get());
+            it->second.linked = false;
+        }
+    }
+    m_decodeActive = false;
+    m_countingIdle = false;
+}
+
 #ifndef BUILD_FOR_ANALYTICS
 inline bool VideoFrameTranscoderImpl::addOutput(int output,
                                            owt_base::FrameFormat format,
@@ -205,6 +331,28 @@ inline bool VideoFrameTranscoderImpl::addOutput(int output,
     boost::upgrade_lock<boost::shared_mutex> lock(m_outputMutex);
     int32_t streamId = -1;
 
+#ifndef BUILD_FOR_ANALYTICS
+    // An output already encoding the identical ladder rung can absorb this
+    // subscriber: the shared encoder fans one encoded stream out to every
+    // destination, so N identical requests cost one encode.
+    for (auto sit = m_outputs.begin(); sit != m_outputs.end(); ++sit) {
+        if (!sit->second.encoder->canShareStream(format, profile, rootSize.width, rootSize.height, framerateFPS, bitrateKbps, keyFrameIntervalSeconds))
+            continue;
+        streamId = sit->second.encoder->generateStream(rootSize.width, rootSize.height, framerateFPS, bitrateKbps, keyFrameIntervalSeconds, dest);
+        if (streamId < 0)
+            break;
+        boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+        int rateHandle = -1;
+        if (owt_base::SceneRateGovernor::enabled())
+            rateHandle = owt_base::SceneRateGovernor::instance().registerRung(this, sit->second.encoder.get(), streamId, bitrateKbps);
+        Output out{.processer = sit->second.processer, .encoder = sit->second.encoder, .streamId = streamId, .rateHandle = rateHandle};
+        m_outputs[output] = out;
+        activateDecode();
+        return true;
+    }
+    streamId = -1;
+#endif
+
 #ifdef ENABLE_MSDK
     if (!encoder && owt_base::MsdkFrameEncoder::supportFormat(format)) {
         encoder.reset(new owt_base::MsdkFrameEncoder(format, profile, false));
@@ -216,6 +364,11 @@ inline bool VideoFrameTranscoderImpl::addOutput(int output,
         encoder.reset(new owt_base::SVTHEVCEncoder(format, profile));
 #endif
 
+#if ENABLE_SVT_AV1_ENCODER
+    if (!encoder && format == owt_base::FRAME_FORMAT_AV1)
+        encoder.reset(new owt_base::SVTAV1Encoder(format, profile));
+#endif
+
     if (!encoder && owt_base::VCMFrameEncoder::supportFormat(format))
         encoder.reset(new owt_base::VCMFrameEncoder(format, profile, false));
 
@@ -242,17 +395,23 @@ inline bool VideoFrameTranscoderImpl::addOutput(int output,
         return false;
     processer->addVideoDestination(analyzer.get());
     analyzer->addVideoDestination(encoder.get());
+    // Feed the plugin's detections back to the encoder as ROI hints.
+    analyzer->addRoiConsumer(encoder.get());
 #else
     processer->addVideoDestination(encoder.get());
 #endif
 
     boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+    int rateHandle = -1;
+    if (owt_base::SceneRateGovernor::enabled())
+        rateHandle = owt_base::SceneRateGovernor::instance().registerRung(this, encoder.get(), streamId, bitrateKbps);
 #ifdef BUILD_FOR_ANALYTICS
-    Output out{.processer = processer, .analyzer = analyzer, .encoder = encoder, .streamId = streamId};
+    Output out{.processer = processer, .analyzer = analyzer, .encoder = encoder, .streamId = streamId, .rateHandle = rateHandle};
 #else
-    Output out{.processer = processer, .encoder = encoder, .streamId = streamId};
+    Output out{.processer = processer, .encoder = encoder, .streamId = streamId, .rateHandle = rateHandle};
 #endif
     m_outputs[output] = out;
+    activateDecode();
     return true;
 }
 
@@ -261,18 +420,25 @@ inline void VideoFrameTranscoderImpl::removeOutput(int32_t output)
     boost::upgrade_lock<boost::shared_mutex> lock(m_outputMutex);
     auto it = m_outputs.find(output);
     if (it != m_outputs.end()) {
+        // Unregister before the stream goes away; the governor may be
+        // mid-tick holding a pointer to this encoder.
+        if (it->second.rateHandle >= 0)
+            owt_base::SceneRateGovernor::instance().unregisterRung(it->second.rateHandle);
         it->second.encoder->degenerateStream(it->second.streamId);
         if (it->second.encoder->isIdle()) {
             this->removeVideoDestination(it->second.processer.get());
 #ifdef BUILD_FOR_ANALYTICS
             it->second.processer->removeVideoDestination(it->second.analyzer.get());
             it->second.analyzer->removeVideoDestination(it->second.encoder.get());
+            it->second.analyzer->removeRoiConsumer(it->second.encoder.get());
 #else
             it->second.processer->removeVideoDestination(it->second.encoder.get());
 #endif
         }
         boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
         m_outputs.erase(output);
+        if (m_outputs.empty())
+            startIdleCountdown();
     }
 }
 
@@ -300,5 +466,20 @@ inline void VideoFrameTranscoderImpl::clearText()
 }
 #endif
 
+inline bool VideoFrameTranscoderImpl::getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg)
+{
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
+    {
+        boost::lock_guard<boost::mutex> guard(m_snapshotMutex);
+        buffer = m_snapshotBuffer;
+        if (!m_snapshotEncoder)
+            m_snapshotEncoder.reset(new owt_base::SnapshotEncoder());
+    }
+    if (!buffer)
+        return false;
+
+    return m_snapshotEncoder->encode(buffer, maxWidth, maxHeight, jpeg);
+}
+
 }
 #endif
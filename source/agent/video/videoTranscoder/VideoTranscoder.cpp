@@ -46,11 +46,10 @@ VideoTranscoder::VideoTranscoder(const VideoTranscoderConfig& config)
         m_freeInputIndexes.push_back(true);
 
 #ifdef ENABLE_MSDK
-    MsdkBase *msdkBase = MsdkBase::get();
-    if(msdkBase != NULL) {
-        msdkBase->setConfigHevcEncoderGaccPlugin(config.useGacc);
-        msdkBase->setConfigMFETimeout(config.MFE_timeout);
-    }
+    // Record the config only; MsdkBase::get() opens the DRM device and
+    // initializes VA, which is deferred to the first stream that needs the
+    // GPU so a freshly spawned agent starts in milliseconds.
+    MsdkBase::configure(config.useGacc, config.MFE_timeout);
 #endif
 
     ELOG_INFO("Init");
@@ -206,6 +205,11 @@ void VideoTranscoder::clearText()
 }
 #endif
 
+bool VideoTranscoder::getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg)
+{
+    return m_frameTranscoder->getSnapshot(maxWidth, maxHeight, jpeg);
+}
+
 void VideoTranscoder::closeAll()
 {
     ELOG_DEBUG("CloseAll");
@@ -58,6 +58,9 @@ public:
     void clearText();
 #endif
 
+    // On-demand JPEG thumbnail of the most recent decoded frame.
+    bool getSnapshot(uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg);
+
 protected:
     int useAFreeInputIndex();
     void closeAll();
@@ -7,6 +7,10 @@
 #endif
 
 #include "VideoTranscoderWrapper.h"
+#include <node_buffer.h>
+#ifdef BUILD_FOR_ANALYTICS
+#include <AnalyticsPluginPool.h>
+#endif
 
 using namespace v8;
 
@@ -31,6 +35,12 @@ void VideoTranscoder::Init(Handle<Object> exports, Handle<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "drawText", drawText);
   NODE_SET_PROTOTYPE_METHOD(tpl, "clearText", clearText);
 #endif
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getSnapshot", getSnapshot);
+
+#ifdef BUILD_FOR_ANALYTICS
+  tpl->GetFunction()->Set(String::NewFromUtf8(isolate, "preloadPlugin"),
+      FunctionTemplate::New(isolate, preloadPlugin)->GetFunction());
+#endif
 
   constructor.Reset(isolate, tpl->GetFunction());
   module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -201,3 +211,35 @@ void VideoTranscoder::clearText(const v8::FunctionCallbackInfo<v8::Value>& args)
 }
 #endif
 
+#ifdef BUILD_FOR_ANALYTICS
+void VideoTranscoder::preloadPlugin(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string pluginName = std::string(*param0);
+  unsigned int depth = (args.Length() > 1) ? args[1]->Uint32Value() : 1;
+
+  owt_base::AnalyticsPluginPool::instance().preload(pluginName, depth);
+}
+#endif
+
+void VideoTranscoder::getSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoTranscoder* obj = ObjectWrap::Unwrap<VideoTranscoder>(args.Holder());
+  mcu::VideoTranscoder* me = obj->me;
+
+  unsigned int maxWidth = args[0]->Uint32Value();
+  unsigned int maxHeight = args[1]->Uint32Value();
+
+  std::vector<uint8_t> jpeg;
+  if (me->getSnapshot(maxWidth, maxHeight, jpeg)) {
+    args.GetReturnValue().Set(
+        node::Buffer::Copy(isolate, reinterpret_cast<const char*>(jpeg.data()), jpeg.size()).ToLocalChecked());
+  } else {
+    args.GetReturnValue().Set(Undefined(isolate));
+  }
+}
+
@@ -37,6 +37,14 @@ class VideoTranscoder : public node::ObjectWrap {
   static void drawText(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void clearText(const v8::FunctionCallbackInfo<v8::Value>& args);
 #endif
+
+  static void getSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+#ifdef BUILD_FOR_ANALYTICS
+  // Module-level entry (on the exported constructor): warms the analytics
+  // plugin pool without constructing an engine.
+  static void preloadPlugin(const v8::FunctionCallbackInfo<v8::Value>& args);
+#endif
 };
 
 #endif
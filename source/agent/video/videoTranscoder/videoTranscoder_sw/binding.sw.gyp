@@ -10,10 +10,20 @@
       '../../../../core/owt_base/I420BufferManager.cpp',
       '../../../../core/owt_base/VCMFrameDecoder.cpp',
       '../../../../core/owt_base/VCMFrameEncoder.cpp',
+      '../../../../core/owt_base/ContentClassifier.cpp',
+      '../../../../core/owt_base/SnapshotEncoder.cpp',
+      '../../../../core/owt_base/EncoderLoadGovernor.cpp',
+      '../../../../core/owt_base/SceneRateGovernor.cpp',
+      '../../../../core/owt_base/HostLoadGovernor.cpp',
+      '../../../../core/owt_base/EncodeThreadPool.cpp',
+      '../../../../core/owt_base/PayloadBufferPool.cpp',
+'../../../../core/owt_base/MemoryBudget.cpp',
       '../../../../core/owt_base/FFmpegFrameDecoder.cpp',
       '../../../../core/owt_base/FrameProcesser.cpp',
       '../../../../core/owt_base/FFmpegDrawText.cpp',
       '../../../../core/owt_base/SVTHEVCEncoder.cpp',
+      '../../../../core/owt_base/SVTCoreBudget.cpp',
+      '../../../../core/owt_base/SVTAV1Encoder.cpp',
     ],
     'cflags_cc': [
         '-Wall',
@@ -22,6 +32,7 @@
         '-std=c++11',
         '-DWEBRTC_POSIX',
         '-DENABLE_SVT_HEVC_ENCODER',
+        '-DENABLE_SVT_AV1_ENCODER',
     ],
     'cflags_cc!': [
         '-fno-exceptions',
@@ -42,7 +53,20 @@
       '<!@(pkg-config --libs libavcodec)',
       '<!@(pkg-config --libs libavformat)',
       '<!@(pkg-config --libs libavfilter)',
-      '-L$(CORE_HOME)/../../build/libdeps/build/lib', '-lSvtHevcEnc',
+      '-L$(CORE_HOME)/../../build/libdeps/build/lib', '-lSvtHevcEnc', '-lSvtAv1Enc',
+    ],
+    'variables': {
+      # GPL opt-in: build with OWT_BUILD_X264=1 to compile the x264 H.264
+      # backend (see core/owt_base/X264VideoEncoder.cpp); linking libx264
+      # makes the resulting addon GPL.
+      'build_x264%': '<!(echo ${OWT_BUILD_X264:-0})',
+    },
+    'conditions': [
+      ['build_x264=="1"', {
+        'sources': [ '../../../../core/owt_base/X264VideoEncoder.cpp' ],
+        'cflags_cc': [ '-DENABLE_X264_ENCODER' ],
+        'libraries': [ '<!@(pkg-config --libs x264)' ],
+      }],
     ],
   }]
 }
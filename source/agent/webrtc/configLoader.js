@@ -4,6 +4,7 @@
 
 'use strict';
 var fs = require('fs');
+var os = require('os');
 var toml = require('toml');
 var networkHelper = require('./networkHelper');
 
@@ -57,7 +58,13 @@ module.exports.load = () => {
     config.webrtc.keystorePath = config.webrtc.keystorePath || '';
     config.webrtc.num_workers = config.webrtc.num_workers || 24;
     config.webrtc.use_nicer = config.webrtc.use_nicer || false;
-    config.webrtc.io_workers = config.webrtc.io_workers || 1;
+    config.webrtc.ice_lite = config.webrtc.ice_lite || false;
+    // The IO pool carries ICE connectivity checks and DTLS record
+    // processing for every connection on the node; one thread does not
+    // hold up on connection-dense nodes, so size it to the host unless
+    // the deployment pins a number.
+    config.webrtc.io_workers = config.webrtc.io_workers ||
+        Math.max(2, Math.floor(os.cpus().length / 4));
     config.webrtc.network_interfaces = config.webrtc.network_interfaces || [];
 
     config.webrtc.network_interfaces.forEach(item => {
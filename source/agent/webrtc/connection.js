@@ -50,6 +50,11 @@ const WARN_BAD_CONNECTION = 502;
 
 const mediaConfig = require('./mediaConfig');
 
+// The media config never changes at runtime and is passed to the addon for
+// every connection and stream on the join path; serialize it once instead of
+// per construction.
+let cachedMediaConfigJson = null;
+
 class Connection extends EventEmitter {
   constructor (id, threadPool, ioThreadPool, options = {}) {
     super();
@@ -70,21 +75,28 @@ class Connection extends EventEmitter {
   }
 
   _getMediaConfiguration(mediaConfiguration = 'default') {
+    if (cachedMediaConfigJson) {
+      return cachedMediaConfigJson;
+    }
     if (mediaConfig && mediaConfig.default) {
-        return JSON.stringify(mediaConfig.default);
+      cachedMediaConfigJson = JSON.stringify(mediaConfig.default);
     } else {
       log.warn(
         'message: Bad media config file. You need to specify a default codecConfiguration.'
       );
-      return JSON.stringify({});
+      cachedMediaConfigJson = JSON.stringify({});
     }
+    return cachedMediaConfigJson;
   }
 
   _createWrtc() {
+    // An ice-lite server answers with host candidates only, so skip the
+    // server-reflexive gathering round-trips against the STUN server.
+    const iceLite = global.config.webrtc.ice_lite;
     var wrtc = new addon.WebRtcConnection(
       this.threadPool, this.ioThreadPool, this.id,
-      global.config.webrtc.stunserver,
-      global.config.webrtc.stunport,
+      iceLite ? '' : global.config.webrtc.stunserver,
+      iceLite ? 0 : global.config.webrtc.stunport,
       global.config.webrtc.minport,
       global.config.webrtc.maxport,
       false, //this.trickleIce,
@@ -5,7 +5,6 @@
 'use strict';
 var path = require('path');
 
-var WrtcConnection = require('./wrtcConnection');
 var Connections = require('./connections');
 var InternalConnectionFactory = require('./InternalConnectionFactory');
 var logger = require('../logger').logger;
@@ -13,17 +12,31 @@ var logger = require('../logger').logger;
 // Logger
 var log = logger.getLogger('WebrtcNode');
 
-var addon = require('../webrtcLib/build/Release/webrtc');
+// Addon dlopen+init dominates workingNode spawn time, so the webrtc addon
+// (and wrtcConnection, which pulls it in at require time) loads on first
+// use; warmup below preloads it and starts the thread pools off the spawn
+// path once the node has reported READY.
+var WrtcConnection;
+var threadPool, ioThreadPool;
+function loadAddons() {
+    if (WrtcConnection)
+        return;
 
-var threadPool = new addon.ThreadPool(global.config.webrtc.num_workers || 24);
-threadPool.start();
+    var addon = require('../webrtcLib/build/Release/webrtc');
 
-// We don't use Nicer connection now
-var ioThreadPool = new addon.IOThreadPool(global.config.webrtc.io_workers || 1);
+    threadPool = new addon.ThreadPool(global.config.webrtc.num_workers || 24);
+    threadPool.start();
 
-if (global.config.webrtc.use_nicer) {
-  log.info('Starting ioThreadPool');
-  ioThreadPool.start();
+    // Shared across every WebRtcConnection on this node: ICE connectivity
+    // checks and DTLS record processing run here instead of per-connection
+    // thread arrangements. Each connection is assigned one worker at
+    // construction and sticks to it, which keeps per-connection ordering.
+    ioThreadPool = new addon.IOThreadPool(global.config.webrtc.io_workers || 1);
+
+    log.info('Starting ioThreadPool with ' + global.config.webrtc.io_workers + ' workers');
+    ioThreadPool.start();
+
+    WrtcConnection = require('./wrtcConnection');
 }
 
 module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
@@ -75,6 +88,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
     };
 
     var createWebRTCConnection = function (connectionId, direction, options, callback) {
+        loadAddons();
         var connection = new WrtcConnection({
             connectionId: connectionId,
             threadPool: threadPool,
@@ -220,6 +234,13 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.cutoffConnection(connectionId).then(onSuccess(callback), onError(callback));
     };
 
+    // Live migration: move a subscription onto replacement sources without
+    // touching the negotiated session.
+    that.relink = function (connectionId, audioFrom, videoFrom, callback) {
+        log.debug('relink, connectionId:', connectionId, 'audioFrom:', audioFrom, 'videoFrom:', videoFrom);
+        connections.relinkConnection(connectionId, audioFrom, videoFrom).then(onSuccess(callback), onError(callback));
+    };
+
     that.onSessionSignaling = function (connectionId, msg, callback) {
         log.debug('onSessionSignaling, connection id:', connectionId, 'msg:', msg);
         var conn = connections.getConnection(connectionId);
@@ -297,5 +318,25 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.onFaultDetected(message);
     };
 
+    // Per-node counter roll-up for the cluster stats pipeline.
+    that.getStatsSummary = function () {
+        return connections.getStatsSummary();
+    };
+
+    // Called by workingNode after READY: every session on this node needs
+    // the webrtc addon and the thread pools, so bring them up before the
+    // first connection request arrives.
+    that.warmup = function () {
+        InternalConnectionFactory.preload();
+        loadAddons();
+        // Pre-bind listen sockets for the cluster-default transport so the
+        // first subscribe's create RPC does not pay the bind.
+        internalConnFactory.prewarm({
+            protocol: 'tcp',
+            minport: global.config.internal.minport,
+            maxport: global.config.internal.maxport
+        }, 2);
+    };
+
     return that;
 };
@@ -35,7 +35,7 @@ const extMappings = [
   'urn:ietf:params:rtp-hdrext:toffset',
   'http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time',
   // 'urn:3gpp:video-orientation',
-  // 'http://www.webrtc.org/experiments/rtp-hdrext/playout-delay',
+  'http://www.webrtc.org/experiments/rtp-hdrext/playout-delay',
 ];
 
 const vp8 = {
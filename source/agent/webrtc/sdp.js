@@ -229,15 +229,17 @@ function filterVideoPayload(sdpObj, videoPreference = {}) {
           }
         }
       }
-      // TODO: uncomment following code after register rtx in video receiver
-      // if (!mediaInfo.simulcast) {
-      //   for (i = 0; i < mediaInfo.fmtp.length; i++) {
-      //     fmtp = mediaInfo.fmtp[i];
-      //     if (fmtp.config.indexOf(`apt=${selectedPayload}`) > -1) {
-      //       relatedPayloads.add(fmtp.payload);
-      //     }
-      //   }
-      // }
+      // Keep the RTX payload paired with the selected codec; the video
+      // receiver registers it through setRtxInfo. Simulcast still goes
+      // without RTX (per-rid ssrc mapping is not wired for it).
+      if (!mediaInfo.simulcast) {
+        for (i = 0; i < mediaInfo.fmtp.length; i++) {
+          fmtp = mediaInfo.fmtp[i];
+          if (fmtp.config.indexOf(`apt=${selectedPayload}`) > -1) {
+            relatedPayloads.add(fmtp.payload);
+          }
+        }
+      }
 
       relatedPayloads.add(selectedPayload);
       // Remove non-selected video payload
@@ -472,7 +474,7 @@ exports.addAudioSSRC = function (sdp, ssrc) {
   return transform.write(sdpObj);
 };
 
-exports.addVideoSSRC = function (sdp, ssrc) {
+exports.addVideoSSRC = function (sdp, ssrc, rtxSsrc) {
   const sdpObj = transform.parse(sdp);
   if (sdpObj.msidSemantic) {
     const msid = sdpObj.msidSemantic.token;
@@ -485,9 +487,67 @@ exports.addVideoSSRC = function (sdp, ssrc) {
             {id: ssrc, attribute: 'mslabel', value: msid},
             {id: ssrc, attribute: 'label', value: `${msid}v0`},
           ];
+          if (rtxSsrc) {
+            // RFC 4588: announce the retransmission ssrc and pair it with
+            // the media ssrc so the receiver demuxes RTX packets.
+            media.ssrcs.push(
+              {id: rtxSsrc, attribute: 'cname', value: 'o/i14u9pJrxRKAsu'},
+              {id: rtxSsrc, attribute: 'msid', value: `${msid} v0`});
+            media.ssrcGroups = [
+              {semantics: 'FID', ssrcs: `${ssrc} ${rtxSsrc}`},
+            ];
+          }
+        }
+      }
+    }
+  }
+  return transform.write(sdpObj);
+};
+
+// Returns the negotiated RFC 4588 retransmission parameters of the video
+// m-line: the rtx payload type, the media payload it protects (from its
+// fmtp apt) and the rtx ssrc from the FID ssrc-group (0 when the peer did
+// not announce one). Null when rtx was not negotiated.
+exports.getVideoRtx = function (sdp) {
+  const sdpObj = transform.parse(sdp);
+  for (const media of sdpObj.media) {
+    if (media.type !== 'video' || !media.rtp) {
+      continue;
+    }
+    for (const rtp of media.rtp) {
+      if (rtp.codec.toLowerCase() !== 'rtx') {
+        continue;
+      }
+      let apt = 0;
+      for (const fmtp of (media.fmtp || [])) {
+        if (fmtp.payload === rtp.payload) {
+          const m = fmtp.config.match(/apt=(\d+)/);
+          if (m) {
+            apt = parseInt(m[1]);
+          }
         }
       }
+      let rtxSsrc = 0;
+      for (const group of (media.ssrcGroups || [])) {
+        const ids = group.ssrcs.split(' ');
+        if (group.semantics === 'FID' && ids.length === 2) {
+          rtxSsrc = parseInt(ids[1]);
+        }
+      }
+      if (apt > 0) {
+        return { payloadType: rtp.payload, apt, ssrc: rtxSsrc };
+      }
     }
   }
+  return null;
+};
+
+// Advertise ice-lite at the session level (RFC 5245 section 2.7). The
+// client then takes the controlling role, drives all connectivity checks
+// and nominates; this side only responds. Only correct when the server
+// answers with directly reachable host candidates.
+exports.addIceLite = function (sdp) {
+  const sdpObj = transform.parse(sdp);
+  sdpObj.icelite = 'ice-lite';
   return transform.write(sdpObj);
 };
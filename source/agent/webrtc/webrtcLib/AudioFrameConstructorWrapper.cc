@@ -37,7 +37,8 @@ NAN_MODULE_INIT(AudioFrameConstructor::Init) {
 NAN_METHOD(AudioFrameConstructor::New) {
   if (info.IsConstructCall()) {
     AudioFrameConstructor* obj = new AudioFrameConstructor();
-    obj->me = new owt_base::AudioFrameConstructor();
+    int audioLevelExt = (info.Length() >= 1) ? info[0]->IntegerValue() : 0;
+    obj->me = new owt_base::AudioFrameConstructor(audioLevelExt > 0 ? audioLevelExt : 0);
     obj->src = obj->me;
     obj->msink = obj->me;
 
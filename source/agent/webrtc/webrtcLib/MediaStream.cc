@@ -33,6 +33,7 @@
 #include "MediaStream.h"
 #include "WebRtcConnection.h"
 
+#include <chrono>  // NOLINT
 #include <future>  // NOLINT
 
 #include <json.hpp>
@@ -49,8 +50,71 @@ using json = nlohmann::json;
 
 DEFINE_LOGGER(MediaStream, "MediaStreamWrapper");
 
-StatCallWorker::StatCallWorker(Nan::Callback *callback, std::weak_ptr<erizo::MediaStream> weak_stream)
-    : Nan::AsyncWorker{callback}, weak_stream_{weak_stream}, stat_{""} {
+// Serve polls from a snapshot this old or younger without touching the
+// stream; older snapshots trigger a background refresh for the next poll.
+static const int64_t kStatsCacheStaleMs = 1000;
+
+StatsCache::StatsCache()
+    : seq_{0}, length_{0}, updated_ms_{0}, refresh_inflight_{false} {
+}
+
+int64_t StatsCache::nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void StatsCache::update(const std::string& stats) {
+  if (stats.size() >= kMaxSnapshotSize) {
+    // A truncated JSON snapshot is worse than a stale one.
+    return;
+  }
+  boost::mutex::scoped_lock lock(write_mutex_);
+  seq_.fetch_add(1, std::memory_order_release);  // Odd: write in progress.
+  memcpy(snapshot_, stats.data(), stats.size());
+  length_ = stats.size();
+  seq_.fetch_add(1, std::memory_order_release);
+  updated_ms_.store(nowMs(), std::memory_order_relaxed);
+}
+
+bool StatsCache::read(std::string* stats, int64_t* age_ms) {
+  for (int retry = 0; retry < 8; ++retry) {
+    uint32_t before = seq_.load(std::memory_order_acquire);
+    if (before == 0) {
+      return false;  // Never written.
+    }
+    if (before & 1) {
+      continue;  // Writer active.
+    }
+    size_t length = length_;
+    if (length >= kMaxSnapshotSize) {
+      continue;
+    }
+    std::string copy(snapshot_, length);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != before) {
+      continue;  // Torn read, retry.
+    }
+    stats->swap(copy);
+    if (age_ms) {
+      *age_ms = nowMs() - updated_ms_.load(std::memory_order_relaxed);
+    }
+    return true;
+  }
+  return false;
+}
+
+bool StatsCache::markRefreshInflight() {
+  bool expected = false;
+  return refresh_inflight_.compare_exchange_strong(expected, true);
+}
+
+void StatsCache::clearRefreshInflight() {
+  refresh_inflight_.store(false);
+}
+
+StatCallWorker::StatCallWorker(Nan::Callback *callback, std::weak_ptr<erizo::MediaStream> weak_stream,
+                               std::shared_ptr<StatsCache> cache)
+    : Nan::AsyncWorker{callback}, weak_stream_{weak_stream}, cache_{cache}, stat_{""} {
 }
 
 void StatCallWorker::Execute() {
@@ -63,6 +127,9 @@ void StatCallWorker::Execute() {
   }
   stat_future.wait();
   stat_ = stat_future.get();
+  if (cache_) {
+    cache_->update(stat_);
+  }
 }
 
 void StatCallWorker::HandleOKCallback() {
@@ -72,6 +139,28 @@ void StatCallWorker::HandleOKCallback() {
   callback->Call(1, argv);
 }
 
+StatRefreshWorker::StatRefreshWorker(std::weak_ptr<erizo::MediaStream> weak_stream,
+                                     std::shared_ptr<StatsCache> cache)
+    : Nan::AsyncWorker{nullptr}, weak_stream_{weak_stream}, cache_{cache} {
+}
+
+void StatRefreshWorker::Execute() {
+  if (auto stream = weak_stream_.lock()) {
+    std::promise<std::string> stat_promise;
+    std::future<std::string> stat_future = stat_promise.get_future();
+    stream->getJSONStats([&stat_promise] (std::string stats) {
+      stat_promise.set_value(stats);
+    });
+    stat_future.wait();
+    cache_->update(stat_future.get());
+  }
+  cache_->clearRefreshInflight();
+}
+
+void StatRefreshWorker::HandleOKCallback() {
+  // Nothing to deliver to JS; the result lives in the cache.
+}
+
 void destroyAsyncHandle(uv_handle_t *handle) {
   delete handle;
 }
@@ -79,6 +168,7 @@ void destroyAsyncHandle(uv_handle_t *handle) {
 Nan::Persistent<Function> MediaStream::constructor;
 
 MediaStream::MediaStream() : closed_{false}, id_{"undefined"} {
+  stats_cache = std::make_shared<StatsCache>();
   async_stats_ = new uv_async_t;
   async_event_ = new uv_async_t;
   uv_async_init(uv_default_loop(), async_stats_, &MediaStream::statsCallback);
@@ -394,8 +484,25 @@ NAN_METHOD(MediaStream::getStats) {
   if (!obj->me || info.Length() != 1) {
     return;
   }
+
+  std::string cached;
+  int64_t age_ms = 0;
+  if (obj->stats_cache->read(&cached, &age_ms)) {
+    // Serve the poll from the snapshot without a round trip into the
+    // stream worker; once the snapshot goes stale, refresh it in the
+    // background so the next poll sees current data.
+    if (age_ms > kStatsCacheStaleMs && obj->stats_cache->markRefreshInflight()) {
+      AsyncQueueWorker(new StatRefreshWorker(obj->me, obj->stats_cache));
+    }
+    Nan::Callback callback(info[0].As<Function>());
+    Local<Value> argv[] = {Nan::New<v8::String>(cached).ToLocalChecked()};
+    callback.Call(1, argv);
+    return;
+  }
+
+  // First poll on this stream: marshal synchronously and seed the cache.
   Nan::Callback *callback = new Nan::Callback(info[0].As<Function>());
-  AsyncQueueWorker(new StatCallWorker(callback, obj->me));
+  AsyncQueueWorker(new StatCallWorker(callback, obj->me, obj->stats_cache));
 }
 
 NAN_METHOD(MediaStream::getPeriodicStats) {
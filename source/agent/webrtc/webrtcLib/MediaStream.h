@@ -33,13 +33,49 @@
 #include <MediaStream.h>
 #include <logger.h>
 #include "MediaDefinitions.h"
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <string>
 #include <future>  // NOLINT
 
+/*
+ * Cache of the last marshalled stats snapshot for a stream. The snapshot
+ * is published under a seqlock: readers copy the buffer and retry if a
+ * write overlapped, so polling never blocks the threads that refresh the
+ * stats. Writers (the refresh workers) serialize on a mutex readers never
+ * touch.
+ */
+class StatsCache {
+ public:
+  StatsCache();
+
+  void update(const std::string& stats);
+  // Returns false until the first update; on success copies the snapshot
+  // and reports its age in milliseconds.
+  bool read(std::string* stats, int64_t* age_ms);
+
+  // Claims the right to kick one background refresh; further claims fail
+  // until the running refresh completes.
+  bool markRefreshInflight();
+  void clearRefreshInflight();
+
+ private:
+  static const size_t kMaxSnapshotSize = 16384;
+  static int64_t nowMs();
+
+  std::atomic<uint32_t> seq_;
+  char snapshot_[kMaxSnapshotSize];
+  size_t length_;
+  std::atomic<int64_t> updated_ms_;
+  std::atomic<bool> refresh_inflight_;
+  boost::mutex write_mutex_;
+};
+
 class StatCallWorker : public Nan::AsyncWorker {
  public:
-  StatCallWorker(Nan::Callback *callback, std::weak_ptr<erizo::MediaStream> weak_stream);
+  StatCallWorker(Nan::Callback *callback, std::weak_ptr<erizo::MediaStream> weak_stream,
+                 std::shared_ptr<StatsCache> cache);
 
   void Execute();
 
@@ -47,9 +83,28 @@ class StatCallWorker : public Nan::AsyncWorker {
 
  private:
   std::weak_ptr<erizo::MediaStream> weak_stream_;
+  std::shared_ptr<StatsCache> cache_;
   std::string stat_;
 };
 
+/*
+ * Refreshes the stats cache off the polling path; carries no JS callback,
+ * the result is only published into the cache for the next getStats call.
+ */
+class StatRefreshWorker : public Nan::AsyncWorker {
+ public:
+  StatRefreshWorker(std::weak_ptr<erizo::MediaStream> weak_stream,
+                    std::shared_ptr<StatsCache> cache);
+
+  void Execute();
+
+  void HandleOKCallback();
+
+ private:
+  std::weak_ptr<erizo::MediaStream> weak_stream_;
+  std::shared_ptr<StatsCache> cache_;
+};
+
 /*
  * Wrapper class of erizo::MediaStream
  *
@@ -62,6 +117,7 @@ class MediaStream : public MediaSink, public erizo::MediaStreamStatsListener, pu
     static NAN_MODULE_INIT(Init);
 
     std::shared_ptr<erizo::MediaStream> me;
+    std::shared_ptr<StatsCache> stats_cache;
     std::queue<std::string> stats_messages;
     std::queue<std::pair<std::string, std::string>> event_messages;
 
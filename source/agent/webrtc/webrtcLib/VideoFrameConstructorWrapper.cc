@@ -29,6 +29,7 @@ NAN_MODULE_INIT(VideoFrameConstructor::Init) {
   Nan::SetPrototypeMethod(tpl, "addDestination", addDestination);
   Nan::SetPrototypeMethod(tpl, "removeDestination", removeDestination);
   Nan::SetPrototypeMethod(tpl, "setBitrate", setBitrate);
+  Nan::SetPrototypeMethod(tpl, "setRtxInfo", setRtxInfo);
   Nan::SetPrototypeMethod(tpl, "requestKeyFrame", requestKeyFrame);
 
   constructor.Reset(tpl->GetFunction());
@@ -38,11 +39,12 @@ NAN_MODULE_INIT(VideoFrameConstructor::Init) {
 NAN_METHOD(VideoFrameConstructor::New) {
   if (info.IsConstructCall()) {
     VideoFrameConstructor* obj = new VideoFrameConstructor();
-    int transportccExt = (info.Length() == 2) ? info[1]->IntegerValue() : -1;
+    int transportccExt = (info.Length() >= 2) ? info[1]->IntegerValue() : -1;
+    bool lowLatency = (info.Length() >= 3) ? info[2]->BooleanValue() : false;
     if (transportccExt > 0) {
-      obj->me = new owt_base::VideoFrameConstructor(obj, transportccExt);
+      obj->me = new owt_base::VideoFrameConstructor(obj, transportccExt, lowLatency);
     } else {
-      obj->me = new owt_base::VideoFrameConstructor(obj);
+      obj->me = new owt_base::VideoFrameConstructor(obj, 0, lowLatency);
     }
     obj->src = obj->me;
     obj->msink = obj->me;
@@ -119,6 +121,17 @@ NAN_METHOD(VideoFrameConstructor::setBitrate) {
   me->setBitrate(bitrate);
 }
 
+NAN_METHOD(VideoFrameConstructor::setRtxInfo) {
+  VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
+  owt_base::VideoFrameConstructor* me = obj->me;
+
+  uint32_t rtxSsrc = info[0]->Uint32Value();
+  int rtxPayloadType = info[1]->IntegerValue();
+  int associatedPayloadType = info[2]->IntegerValue();
+
+  me->setRtxInfo(rtxSsrc, rtxPayloadType, associatedPayloadType);
+}
+
 NAN_METHOD(VideoFrameConstructor::requestKeyFrame) {
   VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
   owt_base::VideoFrameConstructor* me = obj->me;
@@ -46,6 +46,8 @@ class VideoFrameConstructor : public MediaSink, public owt_base::VideoInfoListen
 
   static NAN_METHOD(setBitrate);
 
+  static NAN_METHOD(setRtxInfo);
+
   static NAN_METHOD(requestKeyFrame);
 
   static Nan::Persistent<v8::Function> constructor;
@@ -31,6 +31,7 @@ void VideoFramePacketizer::Init(v8::Local<v8::Object> exports) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "unbindTransport", unbindTransport);
   NODE_SET_PROTOTYPE_METHOD(tpl, "enable", enable);
   NODE_SET_PROTOTYPE_METHOD(tpl, "ssrc", getSsrc);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "rtxSsrc", getRtxSsrc);
 
   constructor.Reset(isolate, tpl->GetFunction());
   exports->Set(String::NewFromUtf8(isolate, "VideoFramePacketizer"), tpl->GetFunction());
@@ -43,9 +44,14 @@ void VideoFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
   bool supportRED = (args[0]->ToBoolean())->BooleanValue();
   bool supportULPFEC = (args[1]->ToBoolean())->BooleanValue();
   VideoFramePacketizer* obj = new VideoFramePacketizer();
-  int transportccExt = (args.Length() == 3) ? args[2]->IntegerValue() : -1;
+  int transportccExt = (args.Length() >= 3) ? args[2]->IntegerValue() : -1;
+  int playoutDelayExt = (args.Length() >= 4) ? args[3]->IntegerValue() : 0;
+  int rtxPayloadType = (args.Length() >= 5) ? args[4]->IntegerValue() : 0;
   if (transportccExt > 0) {
-    obj->me = new owt_base::VideoFramePacketizer(supportRED, supportULPFEC, true, false, transportccExt);
+    obj->me = new owt_base::VideoFramePacketizer(supportRED, supportULPFEC, true, false, transportccExt,
+        playoutDelayExt > 0 ? playoutDelayExt : 0, rtxPayloadType);
+  } else if (playoutDelayExt > 0 || rtxPayloadType > 0) {
+    obj->me = new owt_base::VideoFramePacketizer(supportRED, supportULPFEC, true, false, 2, playoutDelayExt, rtxPayloadType);
   } else {
     obj->me = new owt_base::VideoFramePacketizer(supportRED, supportULPFEC);
   }
@@ -111,3 +117,14 @@ void VideoFramePacketizer::getSsrc(const v8::FunctionCallbackInfo<v8::Value>& ar
   args.GetReturnValue().Set(Number::New(isolate, ssrc));
 }
 
+void VideoFramePacketizer::getRtxSsrc(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoFramePacketizer* obj = ObjectWrap::Unwrap<VideoFramePacketizer>(args.Holder());
+  owt_base::VideoFramePacketizer* me = obj->me;
+
+  uint32_t ssrc = me->getRtxSsrc();
+  args.GetReturnValue().Set(Number::New(isolate, ssrc));
+}
+
@@ -31,6 +31,7 @@ class VideoFramePacketizer : public FrameDestination {
 
   static void enable(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void getSsrc(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getRtxSsrc(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif
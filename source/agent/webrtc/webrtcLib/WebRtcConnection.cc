@@ -53,6 +53,97 @@ std::string getString(v8::Local<v8::Value> value) {
   return std::string(*value_str);
 }
 
+// Every connection on a node is constructed with the same media config
+// string, but parsing it and rebuilding the rtp/ext mapping tables used to
+// happen per connection on the join path. Parse each distinct config once
+// and hand out the precomputed tables.
+struct ParsedMediaConfig {
+  std::vector<erizo::RtpMap> rtp_mappings;
+  std::vector<erizo::ExtMap> ext_mappings;
+};
+
+static std::shared_ptr<const ParsedMediaConfig> parseMediaConfig(const std::string& media_config_string) {
+  static boost::mutex cache_mutex;
+  static std::map<std::string, std::shared_ptr<const ParsedMediaConfig>> cache;
+
+  {
+    boost::mutex::scoped_lock lock(cache_mutex);
+    auto found = cache.find(media_config_string);
+    if (found != cache.end()) {
+      return found->second;
+    }
+  }
+
+  auto parsed = std::make_shared<ParsedMediaConfig>();
+  json media_config = json::parse(media_config_string);
+
+  if (media_config.find("rtpMappings") != media_config.end()) {
+    json rtp_map_json = media_config["rtpMappings"];
+    for (json::iterator it = rtp_map_json.begin(); it != rtp_map_json.end(); ++it) {
+      erizo::RtpMap rtp_map;
+      if (it.value()["payloadType"].is_number()) {
+        rtp_map.payload_type = it.value()["payloadType"];
+      } else {
+        continue;
+      }
+      if (it.value()["encodingName"].is_string()) {
+        rtp_map.encoding_name = it.value()["encodingName"];
+      } else {
+        continue;
+      }
+      if (it.value()["mediaType"].is_string()) {
+        if (it.value()["mediaType"] == "video") {
+          rtp_map.media_type = erizo::VIDEO_TYPE;
+        } else if (it.value()["mediaType"] == "audio") {
+          rtp_map.media_type = erizo::AUDIO_TYPE;
+        } else {
+          continue;
+        }
+      } else {
+        continue;
+      }
+      if (it.value()["clockRate"].is_number()) {
+        rtp_map.clock_rate = it.value()["clockRate"];
+      }
+      if (rtp_map.media_type == erizo::AUDIO_TYPE) {
+        if (it.value()["channels"].is_number()) {
+          rtp_map.channels = it.value()["channels"];
+        }
+      }
+      if (it.value()["formatParameters"].is_object()) {
+        json format_params_json = it.value()["formatParameters"];
+        for (json::iterator params_it = format_params_json.begin();
+            params_it != format_params_json.end(); ++params_it) {
+          std::string value = params_it.value();
+          std::string key = params_it.key();
+          rtp_map.format_parameters.insert(rtp_map.format_parameters.begin(),
+              std::pair<std::string, std::string> (key, value));
+        }
+      }
+      if (it.value()["feedbackTypes"].is_array()) {
+        json feedback_types_json = it.value()["feedbackTypes"];
+        for (json::iterator feedback_it = feedback_types_json.begin();
+            feedback_it != feedback_types_json.end(); ++feedback_it) {
+            rtp_map.feedback_types.push_back(*feedback_it);
+        }
+      }
+      parsed->rtp_mappings.push_back(rtp_map);
+    }
+  }
+
+  unsigned int value = 0;
+  if (media_config.find("extMappings") != media_config.end()) {
+    json ext_map_json = media_config["extMappings"];
+    for (json::iterator ext_map_it = ext_map_json.begin(); ext_map_it != ext_map_json.end(); ++ext_map_it) {
+      parsed->ext_mappings.push_back({value++, *ext_map_it});
+    }
+  }
+
+  boost::mutex::scoped_lock lock(cache_mutex);
+  cache[media_config_string] = parsed;
+  return parsed;
+}
+
 Nan::Persistent<Function> WebRtcConnection::constructor;
 
 WebRtcConnection::WebRtcConnection() {
@@ -113,71 +204,7 @@ NAN_METHOD(WebRtcConnection::New) {
     v8::String::Utf8Value json_param(Nan::To<v8::String>(info[8]).ToLocalChecked());
     bool use_nicer = (info[9]->ToBoolean())->BooleanValue();
     std::string media_config_string = std::string(*json_param);
-    json media_config = json::parse(media_config_string);
-    std::vector<erizo::RtpMap> rtp_mappings;
-
-    if (media_config.find("rtpMappings") != media_config.end()) {
-      json rtp_map_json = media_config["rtpMappings"];
-      for (json::iterator it = rtp_map_json.begin(); it != rtp_map_json.end(); ++it) {
-        erizo::RtpMap rtp_map;
-        if (it.value()["payloadType"].is_number()) {
-          rtp_map.payload_type = it.value()["payloadType"];
-        } else {
-          continue;
-        }
-        if (it.value()["encodingName"].is_string()) {
-          rtp_map.encoding_name = it.value()["encodingName"];
-        } else {
-          continue;
-        }
-        if (it.value()["mediaType"].is_string()) {
-          if (it.value()["mediaType"] == "video") {
-            rtp_map.media_type = erizo::VIDEO_TYPE;
-          } else if (it.value()["mediaType"] == "audio") {
-            rtp_map.media_type = erizo::AUDIO_TYPE;
-          } else {
-            continue;
-          }
-        } else {
-          continue;
-        }
-        if (it.value()["clockRate"].is_number()) {
-          rtp_map.clock_rate = it.value()["clockRate"];
-        }
-        if (rtp_map.media_type == erizo::AUDIO_TYPE) {
-          if (it.value()["channels"].is_number()) {
-            rtp_map.channels = it.value()["channels"];
-          }
-        }
-        if (it.value()["formatParameters"].is_object()) {
-          json format_params_json = it.value()["formatParameters"];
-          for (json::iterator params_it = format_params_json.begin();
-              params_it != format_params_json.end(); ++params_it) {
-            std::string value = params_it.value();
-            std::string key = params_it.key();
-            rtp_map.format_parameters.insert(rtp_map.format_parameters.begin(),
-                std::pair<std::string, std::string> (key, value));
-          }
-        }
-        if (it.value()["feedbackTypes"].is_array()) {
-          json feedback_types_json = it.value()["feedbackTypes"];
-          for (json::iterator feedback_it = feedback_types_json.begin();
-              feedback_it != feedback_types_json.end(); ++feedback_it) {
-              rtp_map.feedback_types.push_back(*feedback_it);
-          }
-        }
-        rtp_mappings.push_back(rtp_map);
-      }
-    }
-
-    std::vector<erizo::ExtMap> ext_mappings;
-    unsigned int value = 0;
-    if (media_config.find("extMappings") != media_config.end()) {
-      json ext_map_json = media_config["extMappings"];
-      for (json::iterator ext_map_it = ext_map_json.begin(); ext_map_it != ext_map_json.end(); ++ext_map_it) {
-        ext_mappings.push_back({value++, *ext_map_it});
-      }
-    }
+    std::shared_ptr<const ParsedMediaConfig> parsed_config = parseMediaConfig(media_config_string);
 
     erizo::IceConfig iceConfig;
     if (info.Length() == 16) {
@@ -220,7 +247,8 @@ NAN_METHOD(WebRtcConnection::New) {
 
     WebRtcConnection* obj = new WebRtcConnection();
     obj->me = std::make_shared<erizo::WebRtcConnection>(worker, io_worker, wrtcId, iceConfig,
-                                                        rtp_mappings, ext_mappings, obj);
+                                                        parsed_config->rtp_mappings,
+                                                        parsed_config->ext_mappings, obj);
 
     uv_async_init(uv_default_loop(), &obj->async_, &WebRtcConnection::eventsCallback);
     obj->Wrap(info.This());
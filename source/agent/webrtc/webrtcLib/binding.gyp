@@ -43,10 +43,17 @@
       '../../../core/owt_base/AudioFramePacketizer.cpp',
       '../../../core/owt_base/AudioUtilities.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/PayloadBufferPool.cpp',
+      '../../../core/owt_base/MemoryBudget.cpp',
       '../../../core/owt_base/VideoFrameConstructor.cpp',
+      '../../../core/owt_base/KeyFrameRequestGovernor.cpp',
+      '../../../core/owt_base/VP9LayerFilter.cpp',
+      '../../../core/owt_base/SimulcastLayerSelector.cpp',
+      '../../../core/owt_base/VideoPacketPacer.cpp',
       '../../../core/owt_base/VideoFramePacketizer.cpp',
       '../../../core/owt_base/SsrcGenerator.cc',
       '../../../core/rtc_adapter/VieReceiver.cc',
+      '../../../core/rtc_adapter/TransportCcEstimator.cc',
       '../../../core/rtc_adapter/VieRemb.cc' #20150508
     ],
     'cflags_cc': ['-DWEBRTC_POSIX', '-DWEBRTC_LINUX', '-DLINUX', '-DNOLINUXIF', '-DNO_REG_RPC=1', '-DHAVE_VFPRINTF=1', '-DRETSIGTYPE=void', '-DNEW_STDIO', '-DHAVE_STRDUP=1', '-DHAVE_STRLCPY=1', '-DHAVE_LIBM=1', '-DHAVE_SYS_TIME_H=1', '-DTIME_WITH_SYS_TIME_H=1'],
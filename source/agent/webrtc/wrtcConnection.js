@@ -27,12 +27,17 @@ const {
   filterExt,
   addAudioSSRC,
   addVideoSSRC,
+  getVideoRtx,
+  addIceLite,
 } = require('./sdp');
 
 var addon = require('../webrtcLib/build/Release/webrtc');
 
 const TransportSeqNumUri =
     'http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01';
+const PlayoutDelayUri =
+    'http://www.webrtc.org/experiments/rtp-hdrext/playout-delay';
+const AudioLevelUri = 'urn:ietf:params:rtp-hdrext:ssrc-audio-level';
 
 /*
  * WrtcStream represents a stream object
@@ -150,6 +155,10 @@ module.exports = function (spec, on_status, on_mediaUpdate) {
     networkInterfaces = spec.network_interfaces,
     audio = !!spec.media.audio,
     video = !!spec.media.video,
+    // Low-latency stream mode: emit the playout-delay extension toward
+    // subscribers and strip receive-side buffering from publishers, for
+    // sub-100ms use cases that accept reduced jitter resilience.
+    lowLatency = !!(spec.media.video && spec.media.video.lowLatency),
     formatPreference = spec.formatPreference,
     audio_fmt,
     video_fmt,
@@ -163,6 +172,7 @@ module.exports = function (spec, on_status, on_mediaUpdate) {
     ridStreamMap = new Map(),
     isSimulcast = false,
     transportSeqNumExt = -1,
+    videoRtxPt = 0,
     wrtc;
 
   /*
@@ -177,13 +187,18 @@ module.exports = function (spec, on_status, on_mediaUpdate) {
             message = message.replace(new RegExp(i.ip_address, 'g'), i.replaced_ip_address);
           }
         });
+        if (global.config.webrtc.ice_lite) {
+          // The client becomes controlling and drives the checks; we only
+          // answer. See the ice_lite item in agent.toml.
+          message = addIceLite(message);
+        }
         if (audioFramePacketizer) {
           const aSsrc = audioFramePacketizer.ssrc();
           message = addAudioSSRC(message, aSsrc);
         }
         if (videoFramePacketizer) {
           const vSsrc = videoFramePacketizer.ssrc();
-          message = addVideoSSRC(message, vSsrc);
+          message = addVideoSSRC(message, vSsrc, videoRtxPt ? videoFramePacketizer.rtxSsrc() : 0);
         }
         if (isSimulcast) {
           // TODO: enable transport-cc for simulcast if bandwidth works
@@ -350,12 +365,18 @@ module.exports = function (spec, on_status, on_mediaUpdate) {
       }
 
       if (audio) {
-        audioFrameConstructor = new AudioFrameConstructor();
+        audioFrameConstructor = new AudioFrameConstructor(getExtId(sdp, AudioLevelUri));
         audioFrameConstructor.bindTransport(wrtc.getMediaStream(wrtcId));
       }
       if (video) {
-        videoFrameConstructor = new VideoFrameConstructor(on_mediaUpdate, transportSeqNumExt);
+        videoFrameConstructor = new VideoFrameConstructor(on_mediaUpdate, transportSeqNumExt, lowLatency);
         videoFrameConstructor.bindTransport(wrtc.getMediaStream(wrtcId));
+        if (!isSimulcast) {
+          const rtxInfo = getVideoRtx(sdp);
+          if (rtxInfo) {
+            videoFrameConstructor.setRtxInfo(rtxInfo.ssrc, rtxInfo.payloadType, rtxInfo.apt);
+          }
+        }
       }
 
       if (processLegacySimulcast(sdp)) {
@@ -375,7 +396,10 @@ module.exports = function (spec, on_status, on_mediaUpdate) {
         const hasRed = hasCodec(sdp, 'red');
         const hasUlpfec = hasCodec(sdp, 'ulpfec');
         transportSeqNumExt = getExtId(sdp, TransportSeqNumUri);
-        videoFramePacketizer = new VideoFramePacketizer(hasRed, hasUlpfec, transportSeqNumExt);
+        const playoutDelayExt = lowLatency ? getExtId(sdp, PlayoutDelayUri) : 0;
+        const rtxInfo = getVideoRtx(sdp);
+        videoRtxPt = rtxInfo ? rtxInfo.payloadType : 0;
+        videoFramePacketizer = new VideoFramePacketizer(hasRed, hasUlpfec, transportSeqNumExt, playoutDelayExt, videoRtxPt);
         videoFramePacketizer.bindTransport(wrtc.getMediaStream(wrtcId));
       }
     }
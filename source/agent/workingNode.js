@@ -27,6 +27,131 @@ function init_controller() {
 
     global.config = nodeConfig;
 
+    // Export thread-placement config to the native addons (see
+    // source/core/common/ThreadAffinity.h). Each entry under [affinity] in
+    // agent.toml maps a worker role to a CPU list, e.g. compositor = "8-15".
+    if (nodeConfig.affinity && typeof nodeConfig.affinity === 'object') {
+        for (var role in nodeConfig.affinity) {
+            process.env['OWT_THREAD_AFFINITY_' + role.toUpperCase()] = String(nodeConfig.affinity[role]);
+        }
+    }
+
+    // Opt internal UDP transports into the io_uring backend (see
+    // source/core/owt_base/UringTransport.cpp); it falls back to the asio
+    // path on kernels without io_uring.
+    if (nodeConfig.internal && nodeConfig.internal.io_uring) {
+        process.env['OWT_UDP_IOURING'] = '1';
+    }
+
+    // Forward pure relay connections (InternalIn feeding only InternalOuts)
+    // as raw wire buffers instead of parsed frames (see
+    // source/core/owt_base/InternalIn.cpp).
+    if (nodeConfig.internal && nodeConfig.internal.relay_fastpath) {
+        process.env['OWT_RELAY_FASTPATH'] = '1';
+    }
+
+    // Size the shared software-encode worker pool (see
+    // source/core/owt_base/EncodeThreadPool.cpp); defaults to half the
+    // hardware threads when unset.
+    if (nodeConfig.video && nodeConfig.video.encode_threads) {
+        process.env['OWT_ENCODE_THREADS'] = String(nodeConfig.video.encode_threads);
+    }
+
+    // Offload ffmpeg software decode to VAAPI (see
+    // source/core/owt_base/FFmpegFrameDecoder.cpp); falls back to software
+    // when no usable VAAPI device is present.
+    if (nodeConfig.video && nodeConfig.video.ffmpeg_vaapi) {
+        process.env['OWT_FFMPEG_VAAPI'] = '1';
+    }
+
+    // Step encoders to faster settings under sustained CPU overload (see
+    // source/core/owt_base/EncoderLoadGovernor.cpp), degrading quality
+    // smoothly instead of dropping subscribers.
+    if (nodeConfig.video && nodeConfig.video.encode_adaptive) {
+        process.env['OWT_ENCODE_ADAPT'] = '1';
+    }
+
+    // Coordinate load shedding across all media agents on this host (see
+    // source/core/owt_base/HostLoadGovernor.cpp); priority is the host
+    // pressure this agent tolerates before shedding, so lower-priority
+    // agents degrade first.
+    if (nodeConfig.host_shed && nodeConfig.host_shed.enabled) {
+        process.env['OWT_HOST_SHED'] = '1';
+        if (nodeConfig.host_shed.priority !== undefined) {
+            process.env['OWT_SHED_PRIORITY'] = String(nodeConfig.host_shed.priority);
+        }
+    }
+
+    // Trim buffer pool caches before the process RSS reaches the container
+    // memory limit (see source/core/owt_base/MemoryBudget.cpp); the budget
+    // is in MB, or 'auto' to read the cgroup limit.
+    if (nodeConfig.memory_budget && nodeConfig.memory_budget.limit_mb) {
+        process.env['OWT_MEMORY_BUDGET_MB'] = String(nodeConfig.memory_budget.limit_mb);
+    }
+
+    // Repair losses on hardware H.264 streams with long-term reference
+    // P-frames instead of full IDRs (see
+    // source/core/owt_base/MsdkFrameEncoder.cpp).
+    if (nodeConfig.video && nodeConfig.video.h264_ltr) {
+        process.env['OWT_H264_LTR'] = '1';
+    }
+
+    // Encode H.264 with x264 instead of OpenH264 (see
+    // source/core/owt_base/X264VideoEncoder.cpp); only effective in builds
+    // compiled with the GPL x264 backend.
+    if (nodeConfig.video && nodeConfig.video.h264_x264) {
+        process.env['OWT_H264_X264'] = '1';
+    }
+
+    // Divide the machine's cores across live SVT-HEVC encoder instances
+    // (see source/core/owt_base/SVTCoreBudget.cpp) so concurrent HEVC
+    // encodes do not oversubscribe.
+    if (nodeConfig.video && nodeConfig.video.svt_core_budget) {
+        process.env['OWT_SVT_CORE_BUDGET'] = '1';
+    }
+
+    // Classify streams as screen content from sampled luma statistics and
+    // flip matching encoders into a content-tuned mode (see
+    // source/core/owt_base/ContentClassifier.cpp).
+    if (nodeConfig.video && nodeConfig.video.screen_content) {
+        process.env['OWT_SCREEN_CONTENT'] = '1';
+    }
+
+    // Size hardware decoder surface pools from observed in-flight depth
+    // (see source/core/owt_base/MsdkFrame.cpp) instead of worst case.
+    if (nodeConfig.video && nodeConfig.video.msdk_adaptive_surfaces) {
+        process.env['OWT_MSDK_ADAPTIVE_SURFACES'] = '1';
+    }
+
+    // Batch outbound SIP RTP from all calls into sendmmsg writes (see
+    // source/agent/sip/sipIn/sip_gateway/sipua/src/rtpbatch.c).
+    if (nodeConfig.media && nodeConfig.media.rtp_batch) {
+        process.env['OWT_SIP_RTP_BATCH'] = '1';
+    }
+
+    // Refresh non-primary speakers' regions at a reduced rate in the
+    // software mixer (see
+    // source/agent/video/videoMixer/SoftVideoCompositor.cpp).
+    if (nodeConfig.video && nodeConfig.video.compose_throttle_fps) {
+        process.env['OWT_COMPOSE_THROTTLE_FPS'] = String(nodeConfig.video.compose_throttle_fps);
+    }
+
+    // Mix audio with the native vectorized kernel instead of the webrtc
+    // conference mixer module (see
+    // source/agent/audio/audioMixer/AcmmFrameMixer.cpp).
+    if (nodeConfig.audio && nodeConfig.audio.native_mix) {
+        process.env['OWT_NATIVE_AUDIO_MIX'] = '1';
+    }
+    if (nodeConfig.audio && nodeConfig.audio.max_active_speakers) {
+        process.env['OWT_AUDIO_MAX_ACTIVE'] = String(nodeConfig.audio.max_active_speakers);
+    }
+
+    // Spread per-group audio encode over a worker pool (see
+    // source/agent/audio/audioMixer/AcmmFrameMixer.cpp).
+    if (nodeConfig.audio && nodeConfig.audio.mix_threads) {
+        process.env['OWT_AUDIO_MIX_THREADS'] = String(nodeConfig.audio.mix_threads);
+    }
+
     log.info('Connecting to rabbitMQ server...');
     rpc.connect(global.config.rabbit, function () {
         rpc.asRpcClient(function(rpcClient) {
@@ -44,9 +169,29 @@ function init_controller() {
                 }, function (monitor) {
                     log.info(rpcID + ' as monitor ready');
                     process.send('READY');
+                    // Native addons load on first use (see the agent index
+                    // files), which is what made READY this fast; give the
+                    // ones every session needs a head start now that spawn
+                    // latency no longer matters.
+                    if (typeof controller.warmup === 'function') {
+                        setImmediate(function () { controller.warmup(); });
+                    }
                     setInterval(() => {
                       process.send('IMOK');
                     }, 1000);
+                    // Feed the cluster stats pipeline: controllers that can
+                    // summarize their connections push a compact per-node
+                    // roll-up to the agent, which folds its nodes together
+                    // and reports one summary per worker to cluster_manager.
+                    if (typeof controller.getStatsSummary === 'function') {
+                      setInterval(() => {
+                        try {
+                          process.send({type: 'nodeStats', stats: controller.getStatsSummary()});
+                        } catch (e) {
+                          log.debug('Failed to report node stats:', e);
+                        }
+                      }, 10000);
+                    }
                 }, function(reason) {
                     process.send('ERROR');
                     log.error(reason);
@@ -85,6 +85,38 @@ var ClusterManager = function (clusterName, selfId, spec) {
         data_synchronizer && data_synchronizer({type: 'worker_load', payload: {worker: worker, load: load}});
     };
 
+    var reportStats = function (worker, stats) {
+        if (workers[worker]) {
+            workers[worker].stats = stats;
+            workers[worker].stats_update = Date.now();
+        }
+        data_synchronizer && data_synchronizer({type: 'worker_stats', payload: {worker: worker, stats: stats}});
+    };
+
+    // Roll the per-worker summaries up by purpose. Only summaries from the
+    // last few report intervals count; a worker that stopped reporting
+    // keeps its scheduling state but drops out of the stats view.
+    var getClusterStats = function (on_ok) {
+        var stale_after = 30 * 1000;
+        var now = Date.now();
+        var result = {};
+        for (var worker in workers) {
+            var record = workers[worker];
+            if (!record.stats || now - record.stats_update > stale_after) {
+                continue;
+            }
+            var purpose = record.purpose;
+            result[purpose] = result[purpose] || {workers: 0, nodes: 0, connections: 0, counters: {}};
+            result[purpose].workers += 1;
+            result[purpose].nodes += record.stats.nodes || 0;
+            result[purpose].connections += record.stats.connections || 0;
+            for (var name in record.stats.counters) {
+                result[purpose].counters[name] = (result[purpose].counters[name] || 0) + record.stats.counters[name];
+            }
+        }
+        on_ok(result);
+    };
+
     var pickUpTasks = function (worker, tasks) {
         workers[worker] && schedulers[workers[worker].purpose] && schedulers[workers[worker].purpose].pickUpTasks(worker, tasks);
         data_synchronizer && data_synchronizer({type: 'worker_pickup', payload: {worker: worker, tasks: tasks}});
@@ -138,7 +170,12 @@ var ClusterManager = function (clusterName, selfId, spec) {
                        port: worker_info.info.port || 0,
                        keepAlive: workers[worker].alive_count});
             } else {
-                on_ok(info);
+                on_ok({id: worker,
+                       purpose: workers[worker].purpose,
+                       state: worker_info.state,
+                       load: worker_info.load,
+                       tasks: worker_info.tasks.length,
+                       keepAlive: workers[worker].alive_count});
             }
         } else {
             on_error('Worker [' + worker + '] does NOT exist.');
@@ -160,7 +197,7 @@ var ClusterManager = function (clusterName, selfId, spec) {
     };
 
     var getTasks = function (worker, on_ok) {
-        return workers[worker] && schedulers[workers[worker].purpose] ? schedulers[workers[worker].purpose].getTasks(worker) : [];
+        on_ok(workers[worker] && schedulers[workers[worker].purpose] ? schedulers[workers[worker].purpose].getTasks(worker) : []);
     };
 
     var getScheduled = function (purpose, task, on_ok, on_error) {
@@ -213,6 +250,9 @@ var ClusterManager = function (clusterName, selfId, spec) {
         case 'worker_load':
             reportLoad(data.payload.worker, data.payload.load);
             break;
+        case 'worker_stats':
+            reportStats(data.payload.worker, data.payload.stats);
+            break;
         case 'worker_pickup':
             pickUpTasks(data.payload.worker, data.payload.tasks);
             break;
@@ -265,6 +305,14 @@ var ClusterManager = function (clusterName, selfId, spec) {
         reportLoad: function (worker, load) {
             reportLoad(worker, load);
         },
+        reportStats: function (worker, stats) {
+            reportStats(worker, stats);
+        },
+        getClusterStats: function (callback) {
+            getClusterStats(function (stats) {
+                callback('callback', stats);
+            });
+        },
         pickUpTasks: function (worker, tasks) {
             pickUpTasks(worker, tasks);
         },
@@ -11,9 +11,55 @@ var Strategy = require('./strategy');
 var log = logger.getLogger('Scheduler');
 
 var isWorkerAvailable = function (worker) {
-    return worker.load < worker.info.max_load && (worker.state === undefined || worker.state === 2);
+    return (worker.load + (worker.pending_load || 0)) < worker.info.max_load && (worker.state === undefined || worker.state === 2);
 };
 
+// Predicted load one newly placed task adds to a worker, per agent purpose.
+// Workers report real telemetry (cpu/gpu collectors in loadCollector.js)
+// only every report period; without charging placements in between, a burst
+// of schedule calls all land on the momentarily least-loaded node and drive
+// it to saturation before its next report. The estimates only need to be
+// roughly proportionate - they are discarded as soon as a real report
+// arrives and folds the placed streams into measured load.
+var defaultTaskLoadEstimation = {
+    video: 0.15,
+    analytics: 0.15,
+    audio: 0.04,
+    streaming: 0.05,
+    recording: 0.05,
+    sip: 0.05,
+    webrtc: 0.02,
+    conference: 0.02
+};
+
+
+// 32-bit FNV-1a, good enough spread for rendezvous hashing below.
+var fnv1a = function (str) {
+    var hash = 2166136261;
+    for (var i = 0; i < str.length; i++) {
+        hash ^= str.charCodeAt(i);
+        hash = Math.imul(hash, 16777619) >>> 0;
+    }
+    return hash >>> 0;
+};
+
+// Rendezvous (highest-random-weight) pick: every scheduler instance maps the
+// same task key to the same worker as long as that worker is up, and when a
+// worker joins or leaves only the keys owned by that worker move. This is
+// what gives rooms node affinity across reconnects that outlive the
+// task-reservation window, so they land back on warm state (encoder caches,
+// buffer pools, inter-node sessions) instead of an arbitrary node.
+var rendezvousPick = function (key, candidates) {
+    var best = undefined, bestScore = -1;
+    for (var i in candidates) {
+        var score = fnv1a(key + '@' + candidates[i]);
+        if (score > bestScore) {
+            bestScore = score;
+            best = candidates[i];
+        }
+    }
+    return best;
+};
 
 exports.Scheduler = function(spec) {
     var that = {};
@@ -30,7 +76,10 @@ exports.Scheduler = function(spec) {
 
     var matcher = Matcher.create(spec.purpose),
         strategy = Strategy.create(spec.strategy),
-        schedule_reserve_time = spec.scheduleReserveTime;
+        schedule_reserve_time = spec.scheduleReserveTime,
+        task_load_estimation = (spec.taskLoadEstimation !== undefined)
+            ? spec.taskLoadEstimation
+            : (defaultTaskLoadEstimation[spec.purpose] || 0.05);
 
     var reserveWorkerForTask = function (task, worker, time) {
         if (tasks[task]) {
@@ -100,6 +149,7 @@ exports.Scheduler = function(spec) {
         }
         workers[worker] = {state: undefined,
                            load: info.max_load || 1.0,
+                           pending_load: 0,
                            info: info,
                            tasks: []};
     };
@@ -122,7 +172,12 @@ exports.Scheduler = function(spec) {
     };
 
     that.updateLoad = function (worker, load) {
-        workers[worker] && (workers[worker].load = load);
+        if (workers[worker]) {
+            // Fresh telemetry supersedes the predictions made since the
+            // last report; the placed streams now show up in measured load.
+            workers[worker].load = load;
+            workers[worker].pending_load = 0;
+        }
     };
 
     that.pickUpTasks = function (worker, tasks) {
@@ -169,8 +224,23 @@ exports.Scheduler = function(spec) {
 
         if (candidates.length < 1) {
             return on_error('No worker matches the preference.');
-        } else {
+        }
+
+        // Affinity only wins while its node has clear headroom; a loaded
+        // affinity target falls through to the configured strategy so warm
+        // state is never bought with an overloaded placement.
+        var preferred = rendezvousPick(task, candidates);
+        if (preferred !== undefined
+            && (workers[preferred].load + (workers[preferred].pending_load || 0) + task_load_estimation)
+               < workers[preferred].info.max_load * 0.85) {
+            workers[preferred].pending_load = (workers[preferred].pending_load || 0) + task_load_estimation;
+            reserveWorkerForTask(task, preferred, (reserveTime && reserveTime > 0 ? reserveTime : schedule_reserve_time));
+            return on_ok(preferred, workers[preferred].info);
+        }
+
+        {
             strategy.allocate(workers, candidates, function (worker) {
+                workers[worker].pending_load = (workers[worker].pending_load || 0) + task_load_estimation;
                 reserveWorkerForTask(task, worker, (reserveTime && reserveTime > 0 ? reserveTime : schedule_reserve_time));
                 on_ok(worker, workers[worker].info);
             }, on_error);
@@ -8,13 +8,20 @@ var logger = require('./logger').logger;
 // Logger
 var log = logger.getLogger('Strategy');
 
+// Reported load plus the scheduler's predicted load for placements made
+// since the worker's last telemetry report, so back-to-back allocations
+// spread out instead of piling onto one momentarily idle node.
+var effectiveLoad = function (worker) {
+    return worker.load + (worker.pending_load || 0);
+};
+
 var leastUsed = function () {
     this.allocate = function (workers, candidates, on_ok, on_error) {
-        var least = 1.0, found = undefined;
+        var least = Number.POSITIVE_INFINITY, found = undefined;
         for (var i in candidates) {
             var id = candidates[i];
-            if (workers[id].load < least) {
-                least = workers[id].load;
+            if (effectiveLoad(workers[id]) < least) {
+                least = effectiveLoad(workers[id]);
                 found = id;
             }
         }
@@ -28,8 +35,8 @@ var mostUsed = function () {
         var most = 0, found = undefined;
         for (var i in candidates) {
             var id = candidates[i];
-            if (workers[id].load >= most) {
-                most = workers[id].load;
+            if (effectiveLoad(workers[id]) >= most) {
+                most = effectiveLoad(workers[id]);
                 found = id;
             }
         }
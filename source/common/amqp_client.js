@@ -7,6 +7,7 @@ var fs = require('fs');
 var amqp = require('amqp');
 var log = require('./logger').logger.getLogger('AmqpClient');
 var cipher = require('./cipher');
+var localRpc = require('./localRpc');
 var TIMEOUT = 2000;
 var REMOVAL_TIMEOUT = 7 * 24 * 3600 * 1000;
 
@@ -33,6 +34,34 @@ var rpcClient = function(bus, conn, on_ready, on_failure) {
     // save its first binding name to avoid lost when reconnecting.
     var queueBindingName;
 
+    // Replies arrive either on the reply queue (broker path) or on the
+    // same-host socket (local fast path); both funnel into the one call_map.
+    var onReply = function (message) {
+        try {
+            log.debug('New message received', message);
+
+            if(call_map[message.corrID] !== undefined) {
+                log.debug('Callback', message.type, ' - ', message.data);
+                clearTimeout(call_map[message.corrID].timer);
+                call_map[message.corrID].fn[message.type].call({}, message.data, message.err);
+                if (call_map[message.corrID].fn['onStatus']) {
+                //FIXME: if the rpc contains a 'onStatus' callback, it will not be deleted immediately, but wait for a time span of REMOVAL_TIMEOUT then delete, which will lead to the issue that the status update would not be observed by the caller thereafter.
+                    setTimeout(function() {
+                        (call_map[message.corrID] !== undefined) &&  (delete call_map[message.corrID]);
+                    }, REMOVAL_TIMEOUT);
+                } else {
+                    (call_map[message.corrID] !== undefined) && (delete call_map[message.corrID]);
+                }
+            } else {
+              log.warn('Late rpc reply:', message);
+            }
+        } catch(err) {
+            log.error('Error processing response: ', err);
+        }
+    };
+
+    var local_client = localRpc.client(onReply);
+
     declareExchange(conn, 'owtRpc', 'direct', true, function (exc_got) {
         exc = exc_got;
 
@@ -42,29 +71,7 @@ var rpcClient = function(bus, conn, on_ready, on_failure) {
             queueBindingName = q.name;
 
             reply_q.bind(exc.name, queueBindingName, function () {
-                reply_q.subscribe(function (message) {
-                    try {
-                        log.debug('New message received', message);
-
-                        if(call_map[message.corrID] !== undefined) {
-                            log.debug('Callback', message.type, ' - ', message.data);
-                            clearTimeout(call_map[message.corrID].timer);
-                            call_map[message.corrID].fn[message.type].call({}, message.data, message.err);
-                            if (call_map[message.corrID].fn['onStatus']) {
-                            //FIXME: if the rpc contains a 'onStatus' callback, it will not be deleted immediately, but wait for a time span of REMOVAL_TIMEOUT then delete, which will lead to the issue that the status update would not be observed by the caller thereafter.
-                                setTimeout(function() {
-                                    (call_map[message.corrID] !== undefined) &&  (delete call_map[message.corrID]);
-                                }, REMOVAL_TIMEOUT);
-                            } else {
-                                (call_map[message.corrID] !== undefined) && (delete call_map[message.corrID]);
-                            }
-                        } else {
-                          log.warn('Late rpc reply:', message);
-                        }
-                    } catch(err) {
-                        log.error('Error processing response: ', err);
-                    }
-                });
+                reply_q.subscribe(onReply);
                 ready = true;
                 on_ready();
             });
@@ -87,7 +94,12 @@ var rpcClient = function(bus, conn, on_ready, on_failure) {
                 }
             }, timeout || TIMEOUT);
 
-            exc.publish(to, {method: method, args: args, corrID: corr_id, replyTo: queueBindingName});
+            var payload = {method: method, args: args, corrID: corr_id, replyTo: queueBindingName};
+            // Same-host fast path: if the callee exposes a local socket,
+            // skip the broker round-trip; a failed dial republishes via AMQP.
+            if (!local_client.send(to, payload, function (msg) { exc && exc.publish(to, msg); })) {
+                exc.publish(to, payload);
+            }
         } else {
             for (var i in callbacks) {
                 (typeof callbacks[i] === 'function' ) && callbacks[i]('error', 'rpc client is not ready');
@@ -96,7 +108,10 @@ var rpcClient = function(bus, conn, on_ready, on_failure) {
     };
 
     handler.remoteCast = function(to, method, args) {
-        exc && exc.publish(to, {method: method, args: args});
+        var payload = {method: method, args: args};
+        if (!local_client.send(to, payload, function (msg) { exc && exc.publish(to, msg); })) {
+            exc && exc.publish(to, payload);
+        }
     };
 
     handler.close = function() {
@@ -104,6 +119,7 @@ var rpcClient = function(bus, conn, on_ready, on_failure) {
              clearTimeout(call_map[i].timer);
         }
         call_map = {};
+        local_client.close();
         reply_q && reply_q.destroy();
         reply_q = undefined;
         exc && exc.destroy(true);
@@ -118,6 +134,35 @@ var rpcServer = function(bus, conn, id, methods, on_ready, on_failure) {
 
     var exc, request_q;
 
+    // sendReply is bound to whichever transport the request arrived on:
+    // the reply queue for broker requests, the socket for local ones.
+    var processMessage = function (message, sendReply) {
+        try {
+            log.debug('New message received', message);
+            message.args = message.args || [];
+            if (sendReply && message.corrID !== undefined) {
+                message.args.push(function(type, result, err) {
+                    sendReply({data: result, corrID: message.corrID, type: type, err: err});
+                });
+            }
+            if (typeof methods[message.method] === 'function') {
+                methods[message.method].apply(methods, message.args);
+            } else {
+                log.warn('RPC server does not support this method:', message.method);
+                if (sendReply && message.corrID !== undefined) {
+                    sendReply({data: 'error', corrID: message.corrID, type: 'callback', err: 'Not support method'});
+                }
+            }
+        } catch (error) {
+            log.error('message:', message);
+            log.error('Error processing call: ', error);
+        }
+    };
+
+    // Same-host callers connect to this socket directly and get their
+    // replies back on it, bypassing the broker entirely.
+    var local_server = localRpc.server(id, processMessage);
+
     declareExchange(conn, 'owtRpc', 'direct', true, function (exc_got) {
         exc = exc_got;
         var ready = false;
@@ -127,26 +172,9 @@ var rpcServer = function(bus, conn, id, methods, on_ready, on_failure) {
 
             request_q.bind(exc.name, id, function() {
                 request_q.subscribe(function (message) {
-                    try {
-                        log.debug('New message received', message);
-                        message.args = message.args || [];
-                        if (message.replyTo && message.corrID !== undefined) {
-                            message.args.push(function(type, result, err) {
-                                exc.publish(message.replyTo, {data: result, corrID: message.corrID, type: type, err: err});
-                            });
-                        }
-                        if (typeof methods[message.method] === 'function') {
-                            methods[message.method].apply(methods, message.args);
-                        } else {
-                            log.warn('RPC server does not support this method:', message.method);
-                            if (message.replyTo && message.corrID !== undefined) {
-                                exc.publish(message.replyTo, {data: 'error', corrID: message.corrID, type: 'callback', err: 'Not support method'});
-                            }
-                        }
-                    } catch (error) {
-                        log.error('message:', message);
-                        log.error('Error processing call: ', error);
-                    }
+                    processMessage(message, message.replyTo ? function (reply) {
+                        exc.publish(message.replyTo, reply);
+                    } : undefined);
                 });
                 ready = true;
                 on_ready();
@@ -155,6 +183,8 @@ var rpcServer = function(bus, conn, id, methods, on_ready, on_failure) {
     }, on_failure);
 
     handler.close = function() {
+        local_server && local_server.close();
+        local_server = undefined;
         request_q && request_q.destroy();
         request_q = undefined;
         exc && exc.destroy(true);
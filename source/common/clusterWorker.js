@@ -208,6 +208,18 @@ module.exports = function (spec) {
         load_collector && load_collector.stop();
     };
 
+    // Per-worker stats summary for the cluster stats pipeline; a cast like
+    // reportLoad since the roll-up is advisory and a lost interval is
+    // replaced by the next one.
+    that.reportStats = function (stats) {
+        if (state === 'registered') {
+            rpcClient.remoteCast(
+                cluster_name,
+                'reportStats',
+                [id, stats]);
+        }
+    };
+
     that.reportState = function (st) {
         if (state === 'registered') {
             rpcClient.remoteCast(
@@ -0,0 +1,197 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+var log = require('./logger').logger.getLogger('LocalRpc');
+
+// Same-host RPC fast path over unix domain sockets.
+//
+// Every rpc server additionally listens on a socket named after its rpc id;
+// a client that finds the callee's socket on the local filesystem talks to
+// it directly instead of taking the round-trip through the message broker,
+// which cuts intra-host control latency from milliseconds to microseconds.
+// The socket's presence in SOCKET_DIR is itself the same-host check: remote
+// peers never see it and keep using AMQP. All failures (stale socket after
+// a crash, peer gone away, dial refused) fall back to the broker path, so
+// callers observe identical semantics either way.
+//
+// Framing is newline-delimited JSON, matching the message shapes that
+// amqp_client.js already puts on the wire.
+
+var SOCKET_DIR = process.env.OWT_LOCAL_RPC_DIR || '/tmp/owt-local-rpc';
+
+// After a failed dial, skip local attempts to that target for a while so a
+// crashed peer's stale socket file does not tax every call with a connect.
+var RETRY_SUPPRESS_MS = 5000;
+
+var socketPath = function (id) {
+    return path.join(SOCKET_DIR, id.replace(/[^\w.@-]/g, '_') + '.sock');
+};
+
+var ensureDir = function () {
+    try {
+        fs.mkdirSync(SOCKET_DIR);
+    } catch (e) {
+        // Already exists.
+    }
+};
+
+var makeLineParser = function (onLine) {
+    var buffered = '';
+    return function (chunk) {
+        buffered += chunk;
+        var nl;
+        while ((nl = buffered.indexOf('\n')) >= 0) {
+            var line = buffered.slice(0, nl);
+            buffered = buffered.slice(nl + 1);
+            if (line.length > 0) {
+                onLine(line);
+            }
+        }
+    };
+};
+
+exports.server = function (id, onMessage) {
+    var that = {};
+
+    ensureDir();
+    var sock_path = socketPath(id);
+    try {
+        // Remove a stale socket left by a previous unclean exit; rpc ids are
+        // unique cluster-wide so the path cannot belong to a live peer.
+        fs.unlinkSync(sock_path);
+    } catch (e) {
+        // No stale socket.
+    }
+
+    var srv = net.createServer(function (connection) {
+        connection.setEncoding('utf8');
+        connection.on('data', makeLineParser(function (line) {
+            var message;
+            try {
+                message = JSON.parse(line);
+            } catch (err) {
+                log.warn('Invalid local rpc message:', line);
+                return;
+            }
+            onMessage(message, function (reply) {
+                connection.writable && connection.write(JSON.stringify(reply) + '\n');
+            });
+        }));
+        connection.on('error', function (err) {
+            log.debug('Local rpc connection error:', err);
+        });
+    });
+
+    srv.on('error', function (err) {
+        log.warn('Local rpc server error:', err, '- callers will use the broker path');
+    });
+
+    srv.listen(sock_path, function () {
+        log.debug('Local rpc server for [' + id + '] listening on', sock_path);
+    });
+
+    that.close = function () {
+        srv.close();
+        try {
+            fs.unlinkSync(sock_path);
+        } catch (e) {
+            // Already gone.
+        }
+    };
+
+    return that;
+};
+
+exports.client = function (onReply) {
+    var that = {};
+
+    var connections = {}; // {to: {socket, connected, pending: [{msg, fallback}]}}
+    var suppressed = {}; // {to: timestamp until which local attempts are skipped}
+
+    var openConnection = function (to) {
+        var conn = {socket: undefined, connected: false, pending: []};
+        var socket = net.connect(socketPath(to));
+        socket.setEncoding('utf8');
+
+        socket.on('connect', function () {
+            conn.connected = true;
+            conn.pending.forEach(function (p) {
+                socket.write(JSON.stringify(p.msg) + '\n');
+            });
+            conn.pending = [];
+        });
+
+        socket.on('data', makeLineParser(function (line) {
+            try {
+                onReply(JSON.parse(line));
+            } catch (err) {
+                log.warn('Invalid local rpc reply:', line);
+            }
+        }));
+
+        socket.on('error', function (err) {
+            log.debug('Local rpc connection to [' + to + '] error:', err);
+        });
+
+        socket.on('close', function () {
+            var unsent = conn.pending;
+            conn.pending = [];
+            delete connections[to];
+            if (!conn.connected) {
+                // Dial failed - most likely a stale socket file.
+                suppressed[to] = Date.now() + RETRY_SUPPRESS_MS;
+            }
+            // Messages queued while dialing have not touched the wire;
+            // resend them on the broker path so the caller never notices.
+            unsent.forEach(function (p) {
+                p.fallback(p.msg);
+            });
+        });
+
+        conn.socket = socket;
+        return conn;
+    };
+
+    // Try to deliver msg over the local socket of `to`. Returns false when
+    // no local path is (believed to be) available, in which case the caller
+    // must publish through the broker itself; returns true when the message
+    // was sent, or queued with `fallback` to be invoked should the dial fail.
+    that.send = function (to, msg, fallback) {
+        if (suppressed[to]) {
+            if (Date.now() < suppressed[to]) {
+                return false;
+            }
+            delete suppressed[to];
+        }
+
+        var conn = connections[to];
+        if (!conn) {
+            if (!fs.existsSync(socketPath(to))) {
+                return false;
+            }
+            conn = connections[to] = openConnection(to);
+        }
+
+        if (conn.connected) {
+            conn.socket.write(JSON.stringify(msg) + '\n');
+        } else {
+            conn.pending.push({msg: msg, fallback: fallback});
+        }
+        return true;
+    };
+
+    that.close = function () {
+        for (var to in connections) {
+            connections[to].pending = [];
+            connections[to].socket.destroy();
+        }
+        connections = {};
+    };
+
+    return that;
+};
@@ -0,0 +1,195 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AsyncLogSink_h
+#define AsyncLogSink_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <log4cxx/logger.h>
+
+namespace owt_log {
+
+// Asynchronous backend for the ELOG macros, enabled by OWT_ASYNC_LOG=1.
+//
+// The macros already snprintf the message on the calling thread (cheap,
+// bounded); what can block is the log4cxx appender I/O behind it - a stalled
+// disk inside a media loop stalls the loop. With this sink enabled the hot
+// path instead copies the formatted record into a per-thread single-producer
+// ring (one atomic load, one memcpy, one release store - no locks, no
+// allocation, no syscalls) and a single background thread hands the records
+// to log4cxx, taking the appender I/O with it. A full ring drops the record
+// and bumps a counter which the flush thread reports periodically, so
+// overload is visible instead of back-pressuring media threads.
+//
+// Trade-offs, deliberate: messages are truncated to kMaxMessage bytes (the
+// 30000-byte ELOG buffer exists for pathological cases; real lines fit), and
+// the log4cxx timestamp is taken at flush time, so it can lag the call site
+// by up to the flush interval plus any appender stall.
+class AsyncLogSink {
+public:
+    enum Level { kTrace, kDebug, kInfo, kWarn, kError, kFatal };
+
+    static const size_t kMaxMessage = 480;
+    static const size_t kRingSlots = 256; // power of two, per thread
+
+    static bool enabled()
+    {
+        static int state = -1;
+        if (state < 0) {
+            const char* env = std::getenv("OWT_ASYNC_LOG");
+            state = (env && env[0] == '1') ? 1 : 0;
+        }
+        return state == 1;
+    }
+
+    static AsyncLogSink& instance()
+    {
+        static AsyncLogSink* sink = new AsyncLogSink(); // leaked: flushes until process exit
+        return *sink;
+    }
+
+    void write(const log4cxx::LoggerPtr& logger, Level level, const char* message)
+    {
+        Ring* ring = threadRing();
+        uint32_t head = ring->head.load(std::memory_order_relaxed);
+        uint32_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head - tail >= kRingSlots) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Record& rec = ring->slots[head & (kRingSlots - 1)];
+        rec.logger = &(*logger);
+        rec.level = level;
+        size_t len = strnlen(message, kMaxMessage - 1);
+        memcpy(rec.message, message, len);
+        rec.message[len] = '\0';
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+private:
+    struct Record {
+        log4cxx::Logger* logger; // raw: DECLARE_LOGGER statics keep loggers alive for the process
+        Level level;
+        char message[kMaxMessage];
+    };
+
+    struct Ring {
+        std::atomic<uint32_t> head;
+        std::atomic<uint32_t> tail;
+        std::atomic<uint64_t> dropped;
+        std::atomic<bool> retired;
+        Record slots[kRingSlots];
+
+        Ring()
+            : head(0)
+            , tail(0)
+            , dropped(0)
+            , retired(false)
+        {
+        }
+    };
+
+    // Marks the ring retired when its producer thread exits; the flush
+    // thread drains and frees it once it is the only side left.
+    struct RingHandle {
+        Ring* ring;
+
+        ~RingHandle()
+        {
+            if (ring)
+                ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    AsyncLogSink()
+        : m_reportedDrops(0)
+    {
+        std::thread(&AsyncLogSink::flushLoop, this).detach();
+    }
+
+    Ring* threadRing()
+    {
+        static thread_local RingHandle handle = {nullptr};
+        if (!handle.ring) {
+            handle.ring = new Ring();
+            std::lock_guard<std::mutex> guard(m_ringsMutex);
+            m_rings.push_back(handle.ring);
+        }
+        return handle.ring;
+    }
+
+    static log4cxx::LevelPtr toLevel(Level level)
+    {
+        switch (level) {
+        case kTrace: return log4cxx::Level::getTrace();
+        case kDebug: return log4cxx::Level::getDebug();
+        case kInfo: return log4cxx::Level::getInfo();
+        case kWarn: return log4cxx::Level::getWarn();
+        case kError: return log4cxx::Level::getError();
+        default: return log4cxx::Level::getFatal();
+        }
+    }
+
+    // Consumer side of every ring; the only place log4cxx appenders run.
+    void flushLoop()
+    {
+        uint32_t cycles = 0;
+        for (;;) {
+            std::vector<Ring*> rings;
+            {
+                std::lock_guard<std::mutex> guard(m_ringsMutex);
+                rings = m_rings;
+            }
+
+            uint64_t totalDropped = 0;
+            for (Ring* ring : rings) {
+                uint32_t head = ring->head.load(std::memory_order_acquire);
+                uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+                while (tail != head) {
+                    Record& rec = ring->slots[tail & (kRingSlots - 1)];
+                    rec.logger->forcedLog(toLevel(rec.level), rec.message);
+                    ++tail;
+                }
+                ring->tail.store(tail, std::memory_order_release);
+                totalDropped += ring->dropped.load(std::memory_order_relaxed);
+
+                if (ring->retired.load(std::memory_order_acquire)
+                    && ring->head.load(std::memory_order_acquire) == tail) {
+                    std::lock_guard<std::mutex> guard(m_ringsMutex);
+                    m_rings.erase(std::find(m_rings.begin(), m_rings.end(), ring));
+                    delete ring;
+                }
+            }
+
+            // Roughly once a second; a burst that overflows rings shows up
+            // here instead of silently vanishing.
+            if (++cycles % 500 == 0 && totalDropped > m_reportedDrops) {
+                log4cxx::Logger::getLogger("owt.AsyncLogSink")->forcedLog(
+                    log4cxx::Level::getWarn(),
+                    "Dropped " + std::to_string(totalDropped - m_reportedDrops) + " log records under overload");
+                m_reportedDrops = totalDropped;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    std::mutex m_ringsMutex;
+    std::vector<Ring*> m_rings;
+    uint64_t m_reportedDrops;
+};
+
+} /* namespace owt_log */
+
+#endif /* AsyncLogSink_h */
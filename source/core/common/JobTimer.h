@@ -8,12 +8,56 @@
 #include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread.hpp>
+#include <future>
 
 class JobTimerListener {
 public:
     virtual void onTimeout() = 0;
 };
 
+// All JobTimer instances in the process share one timing thread. A node runs
+// hundreds of periodic jobs (mixer ticks, stats, keepalives); giving each its
+// own io_service thread wasted a thread and its wakeups per instance.
+class SharedTimerService {
+public:
+    static SharedTimerService& instance()
+    {
+        static SharedTimerService service;
+        return service;
+    }
+
+    boost::asio::io_service& service() { return m_ioService; }
+
+    // Runs an empty handler on the timing thread and waits for it; since the
+    // thread executes handlers in order, any handler queued before the
+    // barrier has finished when this returns.
+    void barrier()
+    {
+        std::promise<void> done;
+        m_ioService.post([&done]() { done.set_value(); });
+        done.get_future().wait();
+    }
+
+private:
+    SharedTimerService()
+        : m_work(new boost::asio::io_service::work(m_ioService))
+    {
+        m_thread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService)));
+    }
+
+    ~SharedTimerService()
+    {
+        m_work.reset();
+        m_ioService.stop();
+        if (m_thread)
+            m_thread->join();
+    }
+
+    boost::asio::io_service m_ioService;
+    boost::scoped_ptr<boost::asio::io_service::work> m_work;
+    boost::scoped_ptr<boost::thread> m_thread;
+};
+
 class JobTimer {
 public:
     JobTimer(unsigned int frequency, JobTimerListener* listener)
@@ -22,8 +66,8 @@ public:
         , m_interval(1000 / frequency)
         , m_listener(listener)
     {
-        m_timer.reset(new boost::asio::deadline_timer(m_ioService, boost::posix_time::milliseconds(m_interval)));
-        m_timer->async_wait(boost::bind(&JobTimer::onTimeout, this, boost::asio::placeholders::error));
+        m_timer.reset(new boost::asio::deadline_timer(SharedTimerService::instance().service(),
+            boost::posix_time::milliseconds(m_interval)));
         start();
     }
 
@@ -35,20 +79,22 @@ public:
     void start()
     {
         if (!m_isRunning) {
-            m_timingThread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService)));
+            m_isClosing = false;
+            m_timer->expires_from_now(boost::posix_time::milliseconds(m_interval));
+            m_timer->async_wait(boost::bind(&JobTimer::onTimeout, this, boost::asio::placeholders::error));
             m_isRunning = true;
         }
     }
 
     void stop()
     {
-        m_timer->cancel();
-
         if (m_isRunning) {
             m_isClosing = true;
-            m_timingThread->join();
+            m_timer->cancel();
+            // Wait until any in-flight callback has drained off the shared
+            // timing thread; after this, onTimeout can no longer fire.
+            SharedTimerService::instance().barrier();
             m_isRunning = false;
-            m_isClosing = false;
         }
     }
 
@@ -77,8 +123,6 @@ private:
     unsigned int m_interval;
     JobTimerListener* m_listener;
 
-    boost::scoped_ptr<boost::thread> m_timingThread;
-    boost::asio::io_service m_ioService;
     boost::scoped_ptr<boost::asio::deadline_timer> m_timer;
 };
 
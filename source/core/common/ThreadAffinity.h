@@ -0,0 +1,84 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ThreadAffinity_h
+#define ThreadAffinity_h
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string>
+
+// Thread-placement facility shared by the C++ agents.
+//
+// On dual-socket nodes, letting compositor/encoder/transport workers float
+// across sockets costs real throughput to cross-NUMA traffic. Agents export
+// per-role CPU lists from their agent.toml ([affinity] section) through the
+// environment - OWT_THREAD_AFFINITY_<ROLE>, e.g.
+// OWT_THREAD_AFFINITY_COMPOSITOR="8-15,24-31" - and native code calls
+// ThreadAffinity::applyRole("compositor") on each worker thread it starts.
+// Roles with no configured list are left to the scheduler, so everything
+// keeps working without configuration.
+namespace ThreadAffinity {
+
+// Parses a Linux-style CPU list ("0-3,8,10-11") into a cpu_set_t.
+// Returns false if the string contains nothing usable.
+inline bool parseCpuList(const std::string& list, cpu_set_t* set)
+{
+    CPU_ZERO(set);
+    bool any = false;
+    const char* p = list.c_str();
+    while (*p) {
+        char* end = NULL;
+        long first = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1)
+                break;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+            if (cpu >= 0) {
+                CPU_SET(cpu, set);
+                any = true;
+            }
+        }
+        if (*p == ',')
+            ++p;
+    }
+    return any;
+}
+
+// Pins the given thread to the CPUs configured for `role`, or does nothing
+// if the role has no configuration. Returns true if an affinity was applied.
+inline bool applyRole(const std::string& role, pthread_t thread)
+{
+    std::string envName = "OWT_THREAD_AFFINITY_";
+    for (size_t i = 0; i < role.size(); ++i)
+        envName += toupper(role[i]);
+
+    const char* list = getenv(envName.c_str());
+    if (!list || !list[0])
+        return false;
+
+    cpu_set_t set;
+    if (!parseCpuList(list, &set))
+        return false;
+
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+// Convenience overload for the calling thread.
+inline bool applyRole(const std::string& role)
+{
+    return applyRole(role, pthread_self());
+}
+
+} /* namespace ThreadAffinity */
+
+#endif /* ThreadAffinity_h */
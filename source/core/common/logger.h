@@ -31,6 +31,8 @@
 #include <log4cxx/logger.h>
 #include <log4cxx/helpers/exception.h>
 
+#include "AsyncLogSink.h"
+
  #define DECLARE_LOGGER() \
  static log4cxx::LoggerPtr logger;
 
@@ -46,49 +48,59 @@
     char buffer[ELOG_MAX_BUFFER_SIZE]; \
     snprintf( buffer, ELOG_MAX_BUFFER_SIZE, fmt, ##args );
 
+// Route one preformatted record either straight to the log4cxx appenders
+// or, when OWT_ASYNC_LOG=1, into the calling thread's lock-free ring so
+// appender I/O never runs on media threads (see AsyncLogSink.h).
+#define OWT_ELOG_EMIT(logger, asyncLevel, LOG4CXX_MACRO, msg) \
+    if (owt_log::AsyncLogSink::enabled()) { \
+        owt_log::AsyncLogSink::instance().write( logger, owt_log::AsyncLogSink::asyncLevel, msg ); \
+    } else { \
+        LOG4CXX_MACRO( logger, msg ); \
+    }
+
 // older versions of log4cxx don't support tracing
 #ifdef LOG4CXX_TRACE
 #define ELOG_TRACE2(logger, fmt, args...) \
     if (logger->isTraceEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_TRACE( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kTrace, LOG4CXX_TRACE, __tmp ); \
     }
 #else
 #define ELOG_TRACE2(logger, fmt, args...) \
     if (logger->isDebugEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_DEBUG( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kDebug, LOG4CXX_DEBUG, __tmp ); \
     }
 #endif
 
 #define ELOG_DEBUG2(logger, fmt, args...) \
     if (logger->isDebugEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_DEBUG( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kDebug, LOG4CXX_DEBUG, __tmp ); \
     }
 
 #define ELOG_INFO2(logger, fmt, args...) \
     if (logger->isInfoEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_INFO( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kInfo, LOG4CXX_INFO, __tmp ); \
     }
 
 #define ELOG_WARN2(logger, fmt, args...) \
     if (logger->isWarnEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_WARN( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kWarn, LOG4CXX_WARN, __tmp ); \
     }
 
 #define ELOG_ERROR2(logger, fmt, args...) \
     if (logger->isErrorEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_ERROR( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kError, LOG4CXX_ERROR, __tmp ); \
     }
 
 #define ELOG_FATAL2(logger, fmt, args...) \
     if (logger->isFatalEnabled()) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_FATAL( logger, __tmp ); \
+        OWT_ELOG_EMIT( logger, kFatal, LOG4CXX_FATAL, __tmp ); \
     }
 
 
@@ -75,6 +75,7 @@ struct redheader {
 #define ISAC_32000_PT       104 // ISAC Audio Codec
 #define PCMU_8000_PT        0   // PCMU Audio Codec
 #define OPUS_48000_PT       120 // Opus Audio Codec
+#define RED_48000_PT        118 // REDundant audio data (RFC 2198)
 #define PCMA_8000_PT        8   // PCMA Audio Codec
 #define CN_8000_PT          13  // CN Audio Codec
 #define CN_16000_PT         105 // CN Audio Codec
@@ -3,8 +3,237 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "AVStreamOut.h"
 
+#include <ThreadAffinity.h>
+
+#include <boost/bind.hpp>
+#include <stdlib.h>
+#include <vector>
+
 namespace owt_base {
 
+// Process-wide pool of writer io_services shared by every AsyncFileWriter
+// (OWT_FILE_WRITER_THREADS, default 4, affinity role "writer"). Modeled on
+// IOServicePool, but separate from it: disk writes block, and must not
+// stall the transport threads. Each writer is assigned one service
+// round-robin at construction, which keeps its jobs single-threaded.
+class FileWriterPool {
+public:
+    static FileWriterPool& instance()
+    {
+        static FileWriterPool pool;
+        return pool;
+    }
+
+    boost::asio::io_service& get()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        boost::asio::io_service& service = *m_services[m_next];
+        m_next = (m_next + 1) % m_services.size();
+        return service;
+    }
+
+private:
+    FileWriterPool()
+        : m_next(0)
+    {
+        size_t count = 4;
+        const char* env = getenv("OWT_FILE_WRITER_THREADS");
+        if (env && env[0]) {
+            long n = strtol(env, NULL, 10);
+            if (n > 0 && n <= 64)
+                count = n;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            boost::shared_ptr<boost::asio::io_service> service(new boost::asio::io_service());
+            m_services.push_back(service);
+            m_works.push_back(boost::shared_ptr<boost::asio::io_service::work>(
+                new boost::asio::io_service::work(*service)));
+            m_threads.create_thread([service]() {
+                ThreadAffinity::applyRole("writer");
+                service->run();
+            });
+        }
+    }
+
+    ~FileWriterPool()
+    {
+        m_works.clear();
+        for (size_t i = 0; i < m_services.size(); ++i)
+            m_services[i]->stop();
+        m_threads.join_all();
+    }
+
+    std::vector<boost::shared_ptr<boost::asio::io_service>> m_services;
+    std::vector<boost::shared_ptr<boost::asio::io_service::work>> m_works;
+    boost::thread_group m_threads;
+    boost::mutex m_mutex;
+    size_t m_next;
+};
+
+// Muxer-side coalescing buffer for async file writes; muxed bytes are
+// batched into chunks of this size before they are handed to the writer
+// thread.
+static uint32_t asyncWriteBufferSize()
+{
+    static uint32_t size = 0;
+    if (size == 0) {
+        const char* env = getenv("OWT_RECORDING_WRITE_BUFFER_KB");
+        long kb = (env && env[0]) ? strtol(env, NULL, 10) : 0;
+        if (kb < 4 || kb > 16384)
+            kb = 256;
+        size = kb * 1024;
+    }
+    return size;
+}
+
+// Depth of the ring between the muxer and the writer thread; with the
+// default 256KB chunks, 64 entries absorb a multi-second disk stall.
+static uint32_t asyncWriteQueueDepth()
+{
+    static uint32_t depth = 0;
+    if (depth == 0) {
+        const char* env = getenv("OWT_RECORDING_WRITE_QUEUE");
+        long n = (env && env[0]) ? strtol(env, NULL, 10) : 0;
+        if (n < 4 || n > 1024)
+            n = 64;
+        depth = n;
+    }
+    return depth;
+}
+
+static int asyncWritePacket(void *opaque, uint8_t *buf, int buf_size)
+{
+    return static_cast<AsyncFileWriter *>(opaque)->write(buf, buf_size);
+}
+
+static int64_t asyncSeekPacket(void *opaque, int64_t offset, int whence)
+{
+    return static_cast<AsyncFileWriter *>(opaque)->seek(offset, whence);
+}
+
+DEFINE_LOGGER(MediaFrameQueue, "owt.MediaFrameQueue");
+
+DEFINE_LOGGER(AsyncFileWriter, "owt.AsyncFileWriter");
+
+AsyncFileWriter::AsyncFileWriter(AVIOContext *fileContext, uint32_t maxPendingChunks)
+    : m_fileContext(fileContext)
+    , m_maxPendingChunks(maxPendingChunks)
+    , m_service(FileWriterPool::instance().get())
+    , m_running(true)
+    , m_writing(false)
+    , m_ioError(false)
+    , m_congested(false)
+{
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    stop();
+}
+
+int AsyncFileWriter::write(const uint8_t *data, int size)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (!m_running || m_ioError)
+        return AVERROR(EIO);
+
+    while (m_running && !m_ioError && m_queue.size() >= m_maxPendingChunks) {
+        // The disk is persistently behind, not just jittery; block until
+        // the writer frees a slot.
+        if (!m_congested) {
+            ELOG_WARN("Write ring full(%d chunks), disk cannot keep up", m_maxPendingChunks);
+            m_congested = true;
+        }
+        m_spaceCond.wait(lock);
+    }
+
+    if (!m_running || m_ioError)
+        return AVERROR(EIO);
+
+    Chunk chunk;
+    chunk.data.reset(new uint8_t[size]);
+    chunk.size = size;
+    memcpy(chunk.data.get(), data, size);
+
+    m_queue.push_back(chunk);
+    // One drain job at a time: it runs until the ring is empty, so only
+    // the first chunk after an idle period posts to the pool.
+    if (!m_writing) {
+        m_writing = true;
+        m_service.post(boost::bind(&AsyncFileWriter::writeJob, this));
+    }
+
+    return size;
+}
+
+int64_t AsyncFileWriter::seek(int64_t offset, int whence)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    waitDrained(lock);
+
+    if (m_ioError)
+        return AVERROR(EIO);
+
+    return avio_seek(m_fileContext, offset, whence);
+}
+
+void AsyncFileWriter::stop()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    // Let the queued tail reach the disk before shutting down. Once the
+    // drain job has cleared m_writing nothing on the pool references this
+    // writer any more.
+    waitDrained(lock);
+
+    m_running = false;
+    m_spaceCond.notify_all();
+
+    // An I/O error ends waitDrained early; anything still queued is
+    // discarded - the file is already damaged.
+    m_queue.clear();
+}
+
+void AsyncFileWriter::waitDrained(boost::mutex::scoped_lock &lock)
+{
+    while (m_running && !m_ioError && (!m_queue.empty() || m_writing))
+        m_drainCond.wait(lock);
+}
+
+// Runs on the shared writer pool, draining the ring until it is empty.
+void AsyncFileWriter::writeJob()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    while (m_running && !m_queue.empty()) {
+        Chunk chunk = m_queue.front();
+        m_queue.pop_front();
+        if (m_congested && m_queue.size() <= m_maxPendingChunks / 2) {
+            ELOG_DEBUG("Write ring recovered(%zu pending)", m_queue.size());
+            m_congested = false;
+        }
+        m_spaceCond.notify_one();
+
+        lock.unlock();
+        avio_write(m_fileContext, chunk.data.get(), chunk.size);
+        bool failed = (m_fileContext->error < 0);
+        lock.lock();
+
+        if (failed && !m_ioError) {
+            ELOG_ERROR("Cannot write to file, error %d", m_fileContext->error);
+            m_ioError = true;
+            m_queue.clear();
+            m_spaceCond.notify_all();
+            break;
+        }
+    }
+
+    m_writing = false;
+    m_drainCond.notify_all();
+}
+
 inline AVCodecID frameFormat2AVCodecID(int frameFormat)
 {
     switch (frameFormat) {
@@ -94,16 +323,19 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
         }
 
         if (m_audioFormat == FRAME_FORMAT_UNKNOWN) {
-            ELOG_INFO("Initial audio options format(%s), sample rate(%d), channels(%d), isRtpPacket(%d)"
+            ELOG_INFO("Initial audio options format(%s), sample rate(%d), channels(%d)"
                     , getFormatStr(frame.format)
                     , frame.additionalInfo.audio.sampleRate
                     , frame.additionalInfo.audio.channels
-                    , frame.additionalInfo.audio.isRtpPacket
                     );
 
             m_sampleRate    = frame.additionalInfo.audio.sampleRate;
             m_channels      = frame.additionalInfo.audio.channels;
             m_audioFormat   = frame.format;
+
+            uint32_t bundleMs = getAudioBundleMs();
+            if (bundleMs)
+                m_frameQueue.setAudioBundling(bundleMs);
         }
 
         if (m_audioFormat != frame.format) {
@@ -123,6 +355,12 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
             notifyAsyncEvent("fatal", "Invalid audio frame channels or sample rate");
             return;
         }
+
+        if (frame.ingestTimeMs > 0) {
+            int64_t ageMs = ingestWallClockMs() - frame.ingestTimeMs;
+            if (ageMs >= 0)
+                m_e2eLatency.record(ageMs * 1000);
+        }
         m_frameQueue.pushFrame(frame);
     } else if (isVideoFrame(frame)) {
         if (!m_hasVideo) {
@@ -197,6 +435,11 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
             return;
 #endif
 
+        if (frame.ingestTimeMs > 0) {
+            int64_t ageMs = ingestWallClockMs() - frame.ingestTimeMs;
+            if (ageMs >= 0)
+                m_e2eLatency.record(ageMs * 1000);
+        }
         m_frameQueue.pushFrame(frame);
     } else {
         ELOG_WARN("Unsupported frame format: %s(%d)", getFormatStr(frame.format), frame.format);
@@ -283,6 +526,12 @@ reconnect:
 
 exit:
     m_status = AVStreamOut::Context_CLOSED;
+
+    uint32_t droppedAudio, droppedVideo;
+    m_frameQueue.getDropCounts(droppedAudio, droppedVideo);
+    if (droppedAudio || droppedVideo)
+        ELOG_WARN("Egress could not keep up, dropped frames audio %d, video %d", droppedAudio, droppedVideo);
+
     ELOG_DEBUG("Thread exited!");
 }
 
@@ -297,7 +546,11 @@ bool AVStreamOut::connect()
     }
 
     if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
-        int ret = avio_open(&m_context->pb, m_context->url, AVIO_FLAG_WRITE);
+        AVDictionary *ioOptions = NULL;
+        getProtocolOpt(m_url, &ioOptions);
+
+        int ret = avio_open2(&m_context->pb, m_context->url, AVIO_FLAG_WRITE, NULL, &ioOptions);
+        av_dict_free(&ioOptions);
         if (ret < 0) {
             ELOG_ERROR("Cannot open avio, %s", ff_err2str(ret));
 
@@ -305,6 +558,22 @@ bool AVStreamOut::connect()
             m_context = NULL;
             return false;
         }
+
+        if (useAsyncWrite()) {
+            uint32_t bufferSize = asyncWriteBufferSize();
+            uint8_t *buffer = (uint8_t *)av_malloc(bufferSize);
+
+            m_asyncWriter.reset(new AsyncFileWriter(m_context->pb, asyncWriteQueueDepth()));
+            m_context->pb = avio_alloc_context(buffer, bufferSize, 1, m_asyncWriter.get(),
+                    NULL, asyncWritePacket, asyncSeekPacket);
+            // The wrapper must not claim more seekability than the real
+            // sink: the mp4 muxer decides whether to seek based on this,
+            // and a streaming http upload cannot rewind.
+            m_context->pb->seekable = m_asyncWriter->fileContext()->seekable;
+
+            ELOG_DEBUG("Async buffered writes enabled, coalescing %d bytes, ring %d chunks",
+                    bufferSize, asyncWriteQueueDepth());
+        }
     }
 
     return true;
@@ -313,6 +582,17 @@ bool AVStreamOut::connect()
 void AVStreamOut::disconnect()
 {
     if (m_context) {
+        if (m_asyncWriter) {
+            // Flush the coalescing buffer, drain the ring, then restore
+            // the real file handle before closing it.
+            AVIOContext *wrapper = m_context->pb;
+            avio_flush(wrapper);
+            m_asyncWriter->stop();
+            m_context->pb = m_asyncWriter->fileContext();
+            av_freep(&wrapper->buffer);
+            avio_context_free(&wrapper);
+            m_asyncWriter.reset();
+        }
         if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
             avio_close(m_context->pb);
         }
@@ -324,6 +604,8 @@ void AVStreamOut::disconnect()
 void AVStreamOut::close()
 {
     ELOG_INFO("Close %s", m_url.c_str());
+    if (m_e2eLatency.count())
+        ELOG_INFO("ingest-to-egress latency %s", m_e2eLatency.report().c_str());
 
     m_status = AVStreamOut::Context_CLOSED;
     m_frameQueue.cancel();
@@ -442,6 +724,8 @@ bool AVStreamOut::writeHeader()
     }
 
     ret = avformat_write_header(m_context, options != NULL ? &options : NULL);
+    if (options)
+        av_dict_free(&options);
     if (ret < 0) {
         ELOG_ERROR("Cannot write header, %s", ff_err2str(ret));
         return false;
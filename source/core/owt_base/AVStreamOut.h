@@ -5,7 +5,13 @@
 #ifndef AVStreamOut_h
 #define AVStreamOut_h
 
+#include <stdlib.h>
+
+#include <deque>
 #include <queue>
+#include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_array.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -14,7 +20,9 @@
 #include <EventRegistry.h>
 #include <rtputils.h>
 
+#include "LatencyHistogram.h"
 #include "MediaFramePipeline.h"
+#include "PayloadBuffer.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -29,6 +37,21 @@ static inline int64_t currentTimeMs()
     return ((time.tv_sec * 1000) + (time.tv_usec / 1000));
 }
 
+// Upper bound on frames buffered toward a slow egress before codec-aware
+// shedding kicks in; roughly 7s of typical a/v at the default.
+static inline uint32_t configuredMaxQueuedFrames()
+{
+    static uint32_t limit = 0;
+    if (limit == 0) {
+        const char* env = getenv("OWT_STREAMOUT_QUEUE_LIMIT");
+        long n = (env && env[0]) ? strtol(env, NULL, 10) : 0;
+        if (n < 50 || n > 10000)
+            n = 600;
+        limit = n;
+    }
+    return limit;
+}
+
 class MediaFrame {
 public:
     MediaFrame(const owt_base::Frame& frame, int64_t timeStamp = 0)
@@ -40,26 +63,27 @@ public:
             uint8_t *payload = frame.payload;
             uint32_t length = frame.length;
 
-            if (isAudioFrame(frame) && frame.additionalInfo.audio.isRtpPacket) {
-                RTPHeader* rtp = reinterpret_cast<RTPHeader*>(payload);
-                uint32_t headerLength = rtp->getHeaderLength();
-                assert(length >= headerLength);
-                payload += headerLength;
-                length -= headerLength;
-                m_frame.additionalInfo.audio.isRtpPacket = false;
-                m_frame.length = length;
+            if (retainFramePayload(frame)) {
+                // Buffer-backed frame: share the payload zero-copy, our
+                // reference keeps it alive until this MediaFrame is destroyed.
+                m_frame.payload = payload;
+            } else {
+                m_frame.payload = (uint8_t *)malloc(length);
+                memcpy(m_frame.payload, payload, length);
             }
-
-            m_frame.payload = (uint8_t *)malloc(length);
-            memcpy(m_frame.payload, payload, length);
         } else {
             m_frame.payload = NULL;
+            m_frame.buffer = NULL;
         }
     }
 
     ~MediaFrame()
     {
-        if (m_frame.payload) {
+        if (m_frame.buffer) {
+            m_frame.buffer->release();
+            m_frame.buffer = NULL;
+            m_frame.payload = NULL;
+        } else if (m_frame.payload) {
             free(m_frame.payload);
             m_frame.payload = NULL;
         }
@@ -71,10 +95,17 @@ public:
 };
 
 class MediaFrameQueue {
+    DECLARE_LOGGER();
+
 public:
     MediaFrameQueue()
         : m_valid(true)
         , m_startTimeOffset(currentTimeMs())
+        , m_maxQueuedFrames(configuredMaxQueuedFrames())
+        , m_droppedAudioFrames(0)
+        , m_droppedVideoFrames(0)
+        , m_audioBundleMs(0)
+        , m_pendingAudioMs(0)
     {
     }
 
@@ -121,9 +152,37 @@ public:
             m_lastVideoFrame = mediaFrame;
         }
 
-        m_queue.push(lastFrame);
-        if (m_queue.size() == 1)
+        m_queue.push_back(lastFrame);
+        if (m_queue.size() > m_maxQueuedFrames)
+            shedFrames();
+
+        if (m_audioBundleMs) {
+            // Bundled mode: let audio pool up to about a bundle's worth and
+            // wake the consumer once for the lot; anything else (video,
+            // bundle complete) wakes it immediately. The consumer drains
+            // the queue without further wakeups once running.
+            if (isAudioFrame(lastFrame->m_frame)) {
+                m_pendingAudioMs += lastFrame->m_duration;
+                if (m_pendingAudioMs < m_audioBundleMs)
+                    return;
+            }
+            m_pendingAudioMs = 0;
+            m_cond.notify_one();
+        } else if (m_queue.size() == 1) {
             m_cond.notify_one();
+        }
+    }
+
+    // For latency-insensitive consumers (recording, rtmp push): defer the
+    // consumer wakeup until about bundleMs of audio has queued since the
+    // last one, so a 10ms-granularity audio stream costs a few send-thread
+    // wakeups per second instead of a hundred. Frames are still queued and
+    // muxed individually - packet boundaries belong to the codec bitstream
+    // and cannot be merged here.
+    void setAudioBundling(uint32_t bundleMs)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_audioBundleMs = bundleMs;
     }
 
     boost::shared_ptr<MediaFrame> popFrame(int timeout = 0)
@@ -140,7 +199,7 @@ public:
 
         if (m_queue.size() > 0) {
             mediaFrame = m_queue.front();
-            m_queue.pop();
+            m_queue.pop_front();
         }
 
         return mediaFrame;
@@ -153,8 +212,49 @@ public:
         m_cond.notify_all();
     }
 
+    void getDropCounts(uint32_t &audioFrames, uint32_t &videoFrames)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        audioFrames = m_droppedAudioFrames;
+        videoFrames = m_droppedVideoFrames;
+    }
+
 private:
-    std::queue<boost::shared_ptr<MediaFrame>> m_queue;
+    // Called with m_mutex held once the queue outgrows its bound. A slow
+    // egress sheds the oldest delta video frames first - audio and
+    // keyframes survive so sound stays continuous and the decoder can
+    // resync at the next sync point; only past the 2x hard cap does the
+    // oldest frame go regardless of kind.
+    void shedFrames()
+    {
+        while (m_queue.size() > m_maxQueuedFrames) {
+            std::deque<boost::shared_ptr<MediaFrame>>::iterator it = m_queue.begin();
+            for (; it != m_queue.end(); ++it) {
+                const owt_base::Frame& frame = (*it)->m_frame;
+                if (isVideoFrame(frame) && !frame.additionalInfo.video.isKeyFrame)
+                    break;
+            }
+
+            if (it != m_queue.end()) {
+                m_queue.erase(it);
+                m_droppedVideoFrames++;
+            } else if (m_queue.size() > 2 * m_maxQueuedFrames) {
+                if (isAudioFrame(m_queue.front()->m_frame))
+                    m_droppedAudioFrames++;
+                else
+                    m_droppedVideoFrames++;
+                m_queue.pop_front();
+            } else {
+                break;
+            }
+
+            if (((m_droppedAudioFrames + m_droppedVideoFrames) % 500) == 1)
+                ELOG_WARN("Queue full(%zu), dropped frames audio %d, video %d",
+                        m_queue.size(), m_droppedAudioFrames, m_droppedVideoFrames);
+        }
+    }
+
+    std::deque<boost::shared_ptr<MediaFrame>> m_queue;
     boost::mutex m_mutex;
     boost::condition_variable m_cond;
 
@@ -163,6 +263,62 @@ private:
 
     bool m_valid;
     int64_t m_startTimeOffset;
+
+    uint32_t m_maxQueuedFrames;
+    uint32_t m_droppedAudioFrames;
+    uint32_t m_droppedVideoFrames;
+
+    uint32_t m_audioBundleMs;
+    int64_t m_pendingAudioMs;
+};
+
+// Moves file disk I/O off the mux thread. The muxer's byte output is
+// queued as pre-muxed chunks on a bounded ring and drained by write jobs
+// on a shared writer pool, so a transient disk stall is absorbed by the
+// ring instead of delaying writeFrame, and a node recording many files
+// runs a handful of disk threads instead of one per file. All of one
+// writer's jobs land on the same single-threaded service, so its chunks
+// reach the file in order, and an I/O error poisons only that writer.
+// Seeks (header/trailer fixups) drain the ring and then run
+// synchronously. A full ring blocks the producer rather than dropping
+// chunks - a hole in the muxed byte stream would corrupt the file.
+class AsyncFileWriter {
+    DECLARE_LOGGER();
+
+public:
+    AsyncFileWriter(AVIOContext *fileContext, uint32_t maxPendingChunks);
+    virtual ~AsyncFileWriter();
+
+    int write(const uint8_t *data, int size);
+    int64_t seek(int64_t offset, int whence);
+    void stop();
+
+    AVIOContext *fileContext() {return m_fileContext;}
+
+private:
+    struct Chunk {
+        boost::shared_array<uint8_t> data;
+        int size;
+    };
+
+    void writeJob();
+    void waitDrained(boost::mutex::scoped_lock &lock);
+
+    AVIOContext *m_fileContext;
+    uint32_t m_maxPendingChunks;
+    boost::asio::io_service& m_service;
+
+    bool m_running;
+    // True while a drain job is posted or running; stop() waits for it to
+    // clear, so no job can outlive the writer.
+    bool m_writing;
+    bool m_ioError;
+    bool m_congested;
+
+    std::deque<Chunk> m_queue;
+    boost::mutex m_mutex;
+    boost::condition_variable m_spaceCond;
+    boost::condition_variable m_drainCond;
 };
 
 class AVStreamOut : public owt_base::FrameDestination, public EventRegistry {
@@ -189,9 +345,16 @@ protected:
     virtual const char *getFormatName(std::string& url) = 0;
     virtual uint32_t getKeyFrameInterval(void) = 0;
     virtual uint32_t getReconnectCount(void) = 0;
+    virtual bool useAsyncWrite(void) {return false;}
+    // Non-zero opts this output into audio wakeup bundling (see
+    // MediaFrameQueue::setAudioBundling); interactive outputs keep 0.
+    virtual uint32_t getAudioBundleMs(void) {return 0;}
 
     virtual bool writeHeader(void);
     virtual bool getHeaderOpt(std::string& url, AVDictionary **options) = 0;
+    // Options for the protocol layer (avio_open2), e.g. http method and
+    // chunked transfer for streaming uploads; the default needs none.
+    virtual bool getProtocolOpt(std::string& url, AVDictionary **options) {return true;}
 
     // EventRegistry
     virtual bool notifyAsyncEvent(const std::string& event, const std::string& data)
@@ -248,11 +411,16 @@ private:
     MediaFrameQueue m_frameQueue;
 
     AVFormatContext *m_context;
+    boost::scoped_ptr<AsyncFileWriter> m_asyncWriter;
     AVStream *m_audioStream;
     AVStream *m_videoStream;
 
     int64_t m_lastKeyFrameTimestamp;
 
+    // Ingest-to-egress latency of accepted frames carrying an ingest
+    // stamp (see Frame::ingestTimeMs); dumped at close().
+    LatencyHistogram m_e2eLatency;
+
     char m_errbuff[500];
 
     boost::thread m_thread;
@@ -57,10 +57,41 @@ struct AnalyticsBuffer {
  int width;
  int height;
 
- AnalyticsBuffer() : buffer(nullptr), width(0), height(0) {}
+ // GPU surface handoff: for plugins that declare "GpuSurfaceSupport" the
+ // pipeline leaves buffer null and passes the decoded VAAPI surface instead;
+ // va_display is the VADisplay and va_surface_id the VASurfaceID.
+ // native_owner is an opaque pipeline-side handle that pins the surface for
+ // the lifetime of this struct and is dropped by the destructor through
+ // native_release, so plugins must finish reading the surface before they
+ // destroy the buffer.
+ void* va_display;
+ unsigned int va_surface_id;
+ void* native_owner;
+ void (*native_release)(void* native_owner);
+
+ // Detections the plugin wants the encoder to prioritize, filled on the
+ // frame it returns through OnPluginFrame in that frame's pixel space.
+ // The pipeline forwards them to downstream encoders as region-of-interest
+ // QP hints; num_rois 0 (the default) clears earlier hints.
+ enum { kMaxRois = 8 };
+ struct Roi {
+  int x;
+  int y;
+  int width;
+  int height;
+ };
+ Roi rois[kMaxRois];
+ int num_rois;
+
+ AnalyticsBuffer()
+     : buffer(nullptr), width(0), height(0)
+     , va_display(nullptr), va_surface_id(0)
+     , native_owner(nullptr), native_release(nullptr)
+     , num_rois(0) { memset(rois, 0, sizeof(rois)); }
 
  ~AnalyticsBuffer() {
    if (buffer != nullptr) {delete [] buffer; buffer = nullptr; }
+   if (native_release != nullptr) { native_release(native_owner); native_owner = nullptr; }
  }
 };
 
@@ -7,6 +7,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include <webrtc/api/video/i420_buffer.h>
 
@@ -17,6 +18,13 @@ class rvaFrameCallback {
   virtual ~rvaFrameCallback() {}
   /// Frame callback to send back VideoFrame to MCU
   virtual void OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer) {};
+  /// Batched variant: results for frames submitted via ProcessFramesAsync,
+  /// in submission order. The default forwards each result to OnPluginFrame,
+  /// so plugins may always report through this one.
+  virtual void OnPluginFrames(std::vector<std::unique_ptr<owt::analytics::AnalyticsBuffer>> buffers) {
+    for (auto& buffer : buffers)
+      OnPluginFrame(std::move(buffer));
+  }
 };
 
 class rvaEventCallback {
@@ -60,10 +68,35 @@ class rvaPlugin {
   /**
    @brief MCU pushes a video frame to the plugin for processing. Note this processing
           must be asynchronous on other thread and should return immediately to caller.
+          Plugins reporting "GpuSurfaceSupport" from GetPluginParams receive frames
+          as VAAPI surface handles instead of system-memory I420 when the pipeline
+          decodes on GPU; see AnalyticsBuffer in AnalyticsCommon.h.
    @param frame the video frame for processing
-   @return RVA_ERR_OK if no issue. Other return code if any failure. 
+   @return RVA_ERR_OK if no issue. Other return code if any failure.
   */
   virtual rvaStatus ProcessFrameAsync(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer) = 0;
+  /**
+   @brief MCU pushes a batch of video frames to the plugin in one call, so
+          GPU-backed inference can run at its batched throughput. The MCU only
+          batches when the plugin advertises it: report "BatchSize" (frames per
+          batch, > 1) and optionally "BatchWindowMs" (max time the MCU may hold
+          frames while filling a batch, default 33) from GetPluginParams. A
+          partial batch is flushed when the window expires, so plugins must
+          accept fewer than BatchSize frames. Results come back through
+          rvaFrameCallback::OnPluginFrames. The default implementation feeds
+          the frames one by one to ProcessFrameAsync, keeping existing plugins
+          working unmodified.
+   @param buffers the video frames for processing, oldest first
+   @return RVA_ERR_OK if no issue. Other return code if any failure.
+  */
+  virtual rvaStatus ProcessFramesAsync(std::vector<std::unique_ptr<owt::analytics::AnalyticsBuffer>> buffers) {
+    for (auto& buffer : buffers) {
+      rvaStatus status = ProcessFrameAsync(std::move(buffer));
+      if (status != RVA_ERR_OK)
+        return status;
+    }
+    return RVA_ERR_OK;
+  }
   /**
    @brief Register a callback on the plugin for receiving frames from the plugin.
    @param pCallback the frame callback function registered by MCU.
@@ -0,0 +1,136 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AnalyticsPluginPool.h"
+
+#include <dlfcn.h>
+#include <unordered_map>
+
+namespace owt_base {
+
+DEFINE_LOGGER(AnalyticsPluginPool, "owt.AnalyticsPluginPool");
+
+AnalyticsPluginPool& AnalyticsPluginPool::instance()
+{
+    static AnalyticsPluginPool pool;
+    return pool;
+}
+
+AnalyticsPluginPool::AnalyticsPluginPool()
+    : m_running(false)
+{
+}
+
+AnalyticsPluginPool::~AnalyticsPluginPool()
+{
+    // Process-lifetime singleton; warm instances are reclaimed by process
+    // teardown. Stop the filler so it does not touch the maps during exit.
+    if (m_running) {
+        {
+            boost::lock_guard<boost::mutex> guard(m_mutex);
+            m_running = false;
+        }
+        m_cond.notify_one();
+        m_fillThread.join();
+    }
+}
+
+void AnalyticsPluginPool::preload(const std::string& pluginName, uint32_t depth)
+{
+    if (pluginName.empty() || depth == 0)
+        return;
+
+    boost::lock_guard<boost::mutex> guard(m_mutex);
+    m_targetDepth[pluginName] = depth;
+    if (!m_running) {
+        m_running = true;
+        m_fillThread = boost::thread(&AnalyticsPluginPool::fillLoop, this);
+    }
+    m_cond.notify_one();
+}
+
+bool AnalyticsPluginPool::lease(const std::string& pluginName, WarmPlugin& out)
+{
+    boost::lock_guard<boost::mutex> guard(m_mutex);
+    auto it = m_warm.find(pluginName);
+    if (it == m_warm.end() || it->second.empty())
+        return false;
+
+    out = it->second.front();
+    it->second.pop_front();
+    // Wake the filler to replace the instance just taken.
+    m_cond.notify_one();
+
+    ELOG_DEBUG("Leased warm instance of %s, %zu left", pluginName.c_str(), it->second.size());
+    return true;
+}
+
+bool AnalyticsPluginPool::loadOne(const std::string& pluginName, WarmPlugin& out)
+{
+    out.handle = dlopen(pluginName.c_str(), RTLD_LAZY);
+    if (out.handle == nullptr) {
+        ELOG_WARN("Failed to open the plugin for warming.(%s)", pluginName.c_str());
+        return false;
+    }
+
+    out.create = (rva_create_t*)dlsym(out.handle, "CreatePlugin");
+    out.destroy = (rva_destroy_t*)dlsym(out.handle, "DestroyPlugin");
+    if (out.create == nullptr || out.destroy == nullptr) {
+        ELOG_WARN("Failed to get plugin interface for warming.(%s)", pluginName.c_str());
+        dlclose(out.handle);
+        return false;
+    }
+
+    out.plugin = out.create();
+    if (out.plugin == nullptr) {
+        ELOG_WARN("Failed to create the plugin for warming.(%s)", pluginName.c_str());
+        dlclose(out.handle);
+        return false;
+    }
+
+    // Same init arguments FrameAnalyzer uses on the cold path; this is
+    // where models get compiled/loaded and device contexts come up.
+    std::unordered_map<std::string, std::string> plugin_config_map(
+      {{"AnalyticsVersion", "1"}});
+    out.plugin->PluginInit(plugin_config_map);
+
+    return true;
+}
+
+void AnalyticsPluginPool::fillLoop()
+{
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (m_running) {
+        std::string pending;
+        for (auto& entry : m_targetDepth) {
+            if (m_warm[entry.first].size() < entry.second) {
+                pending = entry.first;
+                break;
+            }
+        }
+
+        if (pending.empty()) {
+            m_cond.wait(lock);
+            continue;
+        }
+
+        // The load runs unlocked: PluginInit can take seconds and lease()
+        // must stay responsive meanwhile.
+        lock.unlock();
+        WarmPlugin warm;
+        bool ok = loadOne(pending, warm);
+        lock.lock();
+
+        if (ok) {
+            m_warm[pending].push_back(warm);
+            ELOG_INFO("Warmed instance of %s, %zu ready", pending.c_str(), m_warm[pending].size());
+        } else {
+            // Do not spin on a plugin that cannot load; the cold path will
+            // surface the error to the session that asks for it.
+            m_targetDepth.erase(pending);
+        }
+    }
+}
+
+} /* namespace owt_base */
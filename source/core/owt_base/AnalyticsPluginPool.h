@@ -0,0 +1,73 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AnalyticsPluginPool_h
+#define AnalyticsPluginPool_h
+
+#include <list>
+#include <map>
+#include <string>
+
+#include <boost/thread.hpp>
+
+#include <logger.h>
+
+#include "AnalyticsPlugin.h"
+
+namespace owt_base {
+
+// An already-initialized plugin instance handed out by the pool. The frame
+// callback is NOT registered yet; the leasing FrameAnalyzer attaches itself
+// before any frame is submitted.
+struct WarmPlugin {
+    void* handle;
+    rvaPlugin* plugin;
+    rva_create_t* create;
+    rva_destroy_t* destroy;
+};
+
+/**
+ * Process-wide pool of pre-initialized analytics plugins. dlopen plus
+ * PluginInit compiles and loads models and can take seconds per plugin, all
+ * of which used to land on the first pipeline's setup path. The agent warms
+ * every configured plugin right after it reports READY; FrameAnalyzer then
+ * leases an initialized instance and is analyzing within the first frames.
+ *
+ * All loading happens on one background thread, so warming several plugins
+ * never competes with live pipelines for more than a single core, and the
+ * pool tops itself back up after each lease.
+ */
+class AnalyticsPluginPool {
+    DECLARE_LOGGER();
+
+public:
+    static AnalyticsPluginPool& instance();
+
+    // Keep `depth` initialized instances of `pluginName` ready; loading
+    // starts in the background and this returns immediately.
+    void preload(const std::string& pluginName, uint32_t depth);
+
+    // Hand out a warm instance if one is ready. Returns false when the
+    // caller must do a cold load (unwarmed plugin, or the pool is still
+    // filling).
+    bool lease(const std::string& pluginName, WarmPlugin& out);
+
+private:
+    AnalyticsPluginPool();
+    ~AnalyticsPluginPool();
+
+    bool loadOne(const std::string& pluginName, WarmPlugin& out);
+    void fillLoop();
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::map<std::string, uint32_t> m_targetDepth;
+    std::map<std::string, std::list<WarmPlugin>> m_warm;
+    bool m_running;
+    boost::thread m_fillThread;
+};
+
+} /* namespace owt_base */
+
+#endif /* AnalyticsPluginPool_h */
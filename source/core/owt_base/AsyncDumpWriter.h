@@ -0,0 +1,167 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AsyncDumpWriter_h
+#define AsyncDumpWriter_h
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include <boost/thread.hpp>
+
+namespace owt_base {
+
+// Double-buffered file writer behind the raw media dump paths. The
+// delivery thread appends into the fill buffer and swaps it with the
+// flush buffer once the batch size is reached; a worker thread does the
+// actual fwrite, so enabling a debug/analytics dump on a live stream
+// costs a memcpy instead of blocking disk I/O. The batch size comes
+// from OWT_DUMP_BATCH_KB (default 1024); if the disk falls more than 4
+// batches behind, further dump data is dropped rather than growing the
+// buffer without bound.
+class AsyncDumpWriter {
+public:
+    AsyncDumpWriter()
+        : m_fp(NULL)
+        , m_batchBytes(batchBytes())
+        , m_running(true)
+        , m_flushPending(false)
+        , m_droppedBytes(0)
+    {
+        m_fillBuffer.reserve(m_batchBytes);
+        m_flushBuffer.reserve(m_batchBytes);
+        m_thread = boost::thread(&AsyncDumpWriter::flushLoop, this);
+    }
+
+    ~AsyncDumpWriter()
+    {
+        reset(NULL);
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_running = false;
+            m_cond.notify_all();
+        }
+        m_thread.join();
+    }
+
+    // Adopt a new file, flushing and closing the previous one first.
+    void reset(FILE *fp)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        flushLocked(lock);
+        if (m_fp)
+            fclose(m_fp);
+        m_fp = fp;
+        m_droppedBytes = 0;
+    }
+
+    bool isOpen()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_fp != NULL;
+    }
+
+    void write(const uint8_t *data, size_t length)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (!m_fp)
+            return;
+
+        if (m_fillBuffer.size() >= 4 * m_batchBytes) {
+            m_droppedBytes += length;
+            return;
+        }
+
+        m_fillBuffer.insert(m_fillBuffer.end(), data, data + length);
+        if (m_fillBuffer.size() >= m_batchBytes && !m_flushPending) {
+            m_fillBuffer.swap(m_flushBuffer);
+            m_flushPending = true;
+            m_cond.notify_one();
+        }
+    }
+
+    uint64_t droppedBytes()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_droppedBytes;
+    }
+
+private:
+    static size_t batchBytes()
+    {
+        const char* env = getenv("OWT_DUMP_BATCH_KB");
+        long kb = (env && env[0]) ? strtol(env, NULL, 10) : 0;
+        if (kb < 16 || kb > 65536)
+            kb = 1024;
+        return (size_t)kb * 1024;
+    }
+
+    // Called with m_mutex held: wait out any in-flight flush and push
+    // the fill buffer to disk synchronously.
+    void flushLocked(boost::mutex::scoped_lock &lock)
+    {
+        while (m_flushPending)
+            m_doneCond.wait(lock);
+
+        if (m_fp && !m_fillBuffer.empty()) {
+            fwrite(m_fillBuffer.data(), 1, m_fillBuffer.size(), m_fp);
+            m_fillBuffer.clear();
+        }
+    }
+
+    void flushLoop()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        while (m_running) {
+            while (m_running && !m_flushPending)
+                m_cond.wait(lock);
+
+            if (!m_running)
+                break;
+
+            FILE *fp = m_fp;
+
+            lock.unlock();
+            if (fp)
+                fwrite(m_flushBuffer.data(), 1, m_flushBuffer.size(), fp);
+            lock.lock();
+
+            m_flushBuffer.clear();
+            m_flushPending = false;
+
+            // The fill side may have reached another batch while this
+            // one was on disk.
+            if (m_fp && m_fillBuffer.size() >= m_batchBytes) {
+                m_fillBuffer.swap(m_flushBuffer);
+                m_flushPending = true;
+            }
+
+            m_doneCond.notify_all();
+        }
+    }
+
+    FILE *m_fp;
+    size_t m_batchBytes;
+
+    bool m_running;
+    bool m_flushPending;
+    uint64_t m_droppedBytes;
+
+    std::vector<uint8_t> m_fillBuffer;
+    std::vector<uint8_t> m_flushBuffer;
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    boost::condition_variable m_doneCond;
+    boost::thread m_thread;
+};
+
+}
+
+#endif // AsyncDumpWriter_h
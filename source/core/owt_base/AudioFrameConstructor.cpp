@@ -4,6 +4,7 @@
 
 #include "AudioFrameConstructor.h"
 #include "AudioUtilities.h"
+#include "PayloadBuffer.h"
 
 #include <rtputils.h>
 
@@ -11,9 +12,24 @@ namespace owt_base {
 
 DEFINE_LOGGER(AudioFrameConstructor, "owt.AudioFrameConstructor");
 
-AudioFrameConstructor::AudioFrameConstructor()
+// The reorder window never grows past this many packets, so a wildly
+// jittered path adds at most ~a third of a second before the drain kicks
+// in; and after this many consecutive in-order packets the window shrinks
+// by one, letting a path that stopped reordering fall back to pass-through.
+static const uint32_t kMaxReorderWindow = 16;
+static const uint32_t kReorderDecayPackets = 512;
+
+AudioFrameConstructor::AudioFrameConstructor(uint32_t audioLevelExtId)
   : m_enabled(true)
+  , m_audioLevelExtId(audioLevelExtId)
   , m_transport(nullptr)
+  , m_lastDeliveredTs(0)
+  , m_hasDelivered(false)
+  , m_seqInit(false)
+  , m_nextSeqExt(0)
+  , m_reorderSsrc(0)
+  , m_reorderWindow(0)
+  , m_inOrderStreak(0)
 {
     sink_fb_source_ = this;
 }
@@ -39,6 +55,10 @@ void AudioFrameConstructor::unbindTransport()
         setFeedbackSink(nullptr);
         m_transport = nullptr;
     }
+    // Anything still parked behind a gap dies with the stream; the next
+    // bind re-anchors the sequence tracking from its first packet.
+    m_reorderQueue.clear();
+    m_seqInit = false;
 }
 
 int AudioFrameConstructor::deliverVideoData_(std::shared_ptr<erizo::DataPacket> video_packet)
@@ -52,27 +72,237 @@ int AudioFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket>
     if (audio_packet->length <= 0)
       return 0;
 
-    FrameFormat frameFormat;
-    Frame frame;
-    memset(&frame, 0, sizeof(frame));
+    return reorderDeliver(audio_packet);
+}
+
+int AudioFrameConstructor::reorderDeliver(std::shared_ptr<erizo::DataPacket> audio_packet)
+{
     RTPHeader* head = (RTPHeader*) (audio_packet->data);
+    uint16_t seq = head->getSeqNumber();
+    uint32_t ssrc = head->getSSRC();
+
+    if (!m_seqInit || ssrc != m_reorderSsrc) {
+        m_reorderQueue.clear();
+        m_reorderSsrc = ssrc;
+        m_nextSeqExt = seq;
+        m_seqInit = true;
+    }
+
+    // Extend the 16-bit sequence number onto a wrap-free scale anchored
+    // at the next expected packet.
+    int64_t ext = m_nextSeqExt + (int16_t)(seq - (uint16_t)m_nextSeqExt);
+
+    if (ext < m_nextSeqExt) {
+        // Arrived after we moved past it: the path does reorder. Widen
+        // the window to what would have caught this one, and deliver it
+        // anyway - the decoder's own buffer still knows what to do with
+        // a late packet.
+        int64_t distance = m_nextSeqExt - ext;
+        if ((uint32_t)distance > m_reorderWindow)
+            m_reorderWindow = (distance < kMaxReorderWindow) ? distance : kMaxReorderWindow;
+        m_inOrderStreak = 0;
+        return processAudioPacket(audio_packet);
+    }
+
+    if (ext == m_nextSeqExt) {
+        m_nextSeqExt++;
+        int ret = processAudioPacket(audio_packet);
+        flushContiguous();
+
+        if (m_reorderWindow && ++m_inOrderStreak >= kReorderDecayPackets) {
+            m_reorderWindow--;
+            m_inOrderStreak = 0;
+        }
+        return ret;
+    }
+
+    // A gap ahead of us. Until reordering is proven the stage stays
+    // pass-through: a real loss must not add delay waiting for a packet
+    // that will never come.
+    if (!m_reorderWindow) {
+        m_nextSeqExt = ext + 1;
+        return processAudioPacket(audio_packet);
+    }
 
-    frameFormat = getAudioFrameFormat(head->getPayloadType());
-    if (frameFormat == FRAME_FORMAT_UNKNOWN)
+    m_reorderQueue[ext] = audio_packet;
+
+    // Accelerated drain: once the packets waiting behind the gap span the
+    // window, declare the missing ones lost, jump to the oldest buffered
+    // packet and release the contiguous run. Packets keep arriving at
+    // frame cadence, so the wait is bounded by window frames.
+    while (!m_reorderQueue.empty()
+            && (m_reorderQueue.rbegin()->first - m_nextSeqExt >= (int64_t)m_reorderWindow
+                || m_reorderQueue.size() >= kMaxReorderWindow)) {
+        m_nextSeqExt = m_reorderQueue.begin()->first;
+        flushContiguous();
+    }
+
+    return audio_packet->length;
+}
+
+void AudioFrameConstructor::flushContiguous()
+{
+    while (!m_reorderQueue.empty() && m_reorderQueue.begin()->first == m_nextSeqExt) {
+        std::shared_ptr<erizo::DataPacket> packet = m_reorderQueue.begin()->second;
+        m_reorderQueue.erase(m_reorderQueue.begin());
+        m_nextSeqExt++;
+        processAudioPacket(packet);
+    }
+}
+
+int AudioFrameConstructor::processAudioPacket(std::shared_ptr<erizo::DataPacket> audio_packet)
+{
+    RTPHeader* head = (RTPHeader*) (audio_packet->data);
+
+    if (head->getPayloadType() == RED_48000_PT)
+        return processRedPacket(audio_packet);
+
+    // The single RTP parse on the path: everything downstream consumes the
+    // codec payload plus the timing fields below, nobody re-reads the wire
+    // header.
+    int headerLength = head->getHeaderLength();
+    if (audio_packet->length <= headerLength)
         return 0;
 
+    deliverPayload(head->getPayloadType(), head->getTimestamp(), head->getSeqNumber(),
+        head->getMarker(), head->getSSRC(),
+        reinterpret_cast<uint8_t*>(audio_packet->data) + headerLength,
+        audio_packet->length - headerLength,
+        extractAudioLevel(reinterpret_cast<uint8_t*>(audio_packet->data), audio_packet->length));
+    return audio_packet->length;
+}
+
+int AudioFrameConstructor::extractAudioLevel(const uint8_t* data, uint32_t length)
+{
+    if (!m_audioLevelExtId)
+        return -1;
+
+    // Fixed header plus CSRCs, then the one-byte extension block (0xBEDE).
+    if (length < 12 || !(data[0] & 0x10))
+        return -1;
+
+    uint32_t pos = 12 + (data[0] & 0x0F) * 4;
+    if (pos + 4 > length)
+        return -1;
+
+    uint16_t profile = ((uint16_t)data[pos] << 8) | data[pos + 1];
+    uint32_t extBytes = (((uint32_t)data[pos + 2] << 8) | data[pos + 3]) * 4;
+    pos += 4;
+    if (profile != 0xBEDE || pos + extBytes > length)
+        return -1;
+
+    uint32_t end = pos + extBytes;
+    while (pos < end) {
+        uint8_t id = data[pos] >> 4;
+        uint8_t len = (data[pos] & 0x0F) + 1;
+        if (id == 0) { // padding byte
+            pos++;
+            continue;
+        }
+        if (id == 15 || pos + 1 + len > end)
+            break;
+        if (id == m_audioLevelExtId)
+            return data[pos + 1] & 0x7F; // top bit is the V flag
+        pos += 1 + len;
+    }
+
+    return -1;
+}
+
+void AudioFrameConstructor::deliverPayload(int payloadType, uint32_t timeStamp, uint16_t seqNumber,
+    uint8_t marker, uint32_t ssrc, const uint8_t* data, uint32_t length, int audioLevel)
+{
+    FrameFormat frameFormat = getAudioFrameFormat(payloadType);
+    if (frameFormat == FRAME_FORMAT_UNKNOWN || length == 0)
+        return;
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
     frame.additionalInfo.audio.sampleRate = getAudioSampleRate(frameFormat);
     frame.additionalInfo.audio.channels = getAudioChannels(frameFormat);
+    frame.additionalInfo.audio.hasRtpTiming = 1;
+    frame.additionalInfo.audio.marker = marker;
+    frame.additionalInfo.audio.seqNumber = seqNumber;
+    frame.additionalInfo.audio.ssrc = ssrc;
+    if (audioLevel >= 0) {
+        frame.additionalInfo.audio.hasAudioLevel = 1;
+        frame.additionalInfo.audio.audioLevel = audioLevel;
+    }
 
     frame.format = frameFormat;
-    frame.payload = reinterpret_cast<uint8_t*>(audio_packet->data);
-    frame.length = audio_packet->length;
-    frame.timeStamp = head->getTimestamp();
-    frame.additionalInfo.audio.isRtpPacket = 1;
+    frame.timeStamp = timeStamp;
+    frame.length = length;
+    frame.ingestTimeMs = ingestWallClockMs();
+
+    // One copy into a pooled refcounted buffer; every destination that
+    // queues or fans the frame out shares this payload instead of copying
+    // it once per subscription.
+    PayloadBuffer* payload = PayloadBuffer::create(length);
+    memcpy(payload->data(), data, length);
+    attachPayloadBuffer(frame, payload);
 
     if (m_enabled) {
         deliverFrame(frame);
     }
+    payload->release();
+
+    m_lastDeliveredTs = timeStamp;
+    m_hasDelivered = true;
+}
+
+int AudioFrameConstructor::processRedPacket(std::shared_ptr<erizo::DataPacket> audio_packet)
+{
+    RTPHeader* head = (RTPHeader*) (audio_packet->data);
+    int headerLength = head->getHeaderLength();
+    if (audio_packet->length <= headerLength)
+        return 0;
+    const uint8_t* payload = reinterpret_cast<uint8_t*>(audio_packet->data) + headerLength;
+    uint32_t length = audio_packet->length - headerLength;
+
+    // Walk the chain of 4-byte block headers; the 1-byte header with the
+    // F bit clear describes the primary block.
+    static const size_t kMaxRedBlocks = 8;
+    struct Block {
+        int payloadType;
+        uint32_t tsOffset;
+        uint32_t length;
+    } blocks[kMaxRedBlocks];
+    size_t blockCount = 0;
+    uint32_t pos = 0;
+    uint32_t redundantBytes = 0;
+    while (pos < length && (payload[pos] & 0x80)) {
+        if (pos + 4 > length || blockCount == kMaxRedBlocks)
+            return 0;
+        blocks[blockCount].payloadType = payload[pos] & 0x7F;
+        blocks[blockCount].tsOffset = ((uint32_t)payload[pos + 1] << 6) | (payload[pos + 2] >> 2);
+        blocks[blockCount].length = ((uint32_t)(payload[pos + 2] & 0x3) << 8) | payload[pos + 3];
+        redundantBytes += blocks[blockCount].length;
+        blockCount++;
+        pos += 4;
+    }
+    if (pos >= length)
+        return 0;
+    int primaryPt = payload[pos] & 0x7F;
+    pos++;
+    if (pos + redundantBytes >= length)
+        return 0;
+
+    // A redundant block is only interesting when its primary never made
+    // it downstream; otherwise it would play twice.
+    for (size_t i = 0; i < blockCount; ++i) {
+        uint32_t ts = head->getTimestamp() - blocks[i].tsOffset;
+        if (!m_hasDelivered || (int32_t)(ts - m_lastDeliveredTs) > 0) {
+            ELOG_DEBUG("Repairing lost audio frame from RED block (ts %u)", ts);
+            deliverPayload(blocks[i].payloadType, ts,
+                head->getSeqNumber() - (uint16_t)(blockCount - i), 0, head->getSSRC(),
+                payload + pos, blocks[i].length);
+        }
+        pos += blocks[i].length;
+    }
+
+    deliverPayload(primaryPt, head->getTimestamp(), head->getSeqNumber(),
+        head->getMarker(), head->getSSRC(), payload + pos, length - pos,
+        extractAudioLevel(reinterpret_cast<uint8_t*>(audio_packet->data), audio_packet->length));
     return audio_packet->length;
 }
 
@@ -11,6 +11,8 @@
 #include <MediaDefinitions.h>
  #include <MediaDefinitionExtra.h>
 
+#include <map>
+
 
 namespace owt_base {
 
@@ -24,7 +26,9 @@ class AudioFrameConstructor : public erizo::MediaSink,
     DECLARE_LOGGER();
 
 public:
-    AudioFrameConstructor();
+    // audioLevelExtId is the negotiated id of the RFC 6464 ssrc-audio-level
+    // header extension, or 0 when the publisher does not send it.
+    AudioFrameConstructor(uint32_t audioLevelExtId = 0);
     virtual ~AudioFrameConstructor();
 
     void bindTransport(erizo::MediaSource* source, erizo::FeedbackSink* fbSink);
@@ -39,10 +43,49 @@ public:
     void onFeedback(const FeedbackMsg& msg);
 
 private:
+    // Lightweight adaptive reorder stage ahead of frame delivery. An
+    // in-order stream passes straight through with no buffering or added
+    // delay; once a late packet proves the path reorders, out-of-order
+    // arrivals are held back up to a window sized to the observed reorder
+    // distance and released in sequence, so the decoders downstream see a
+    // clean cadence instead of paying concealment for every swap.
+    int reorderDeliver(std::shared_ptr<erizo::DataPacket> audio_packet);
+    // Hands one RTP packet past the reorder stage to frame construction.
+    int processAudioPacket(std::shared_ptr<erizo::DataPacket> audio_packet);
+    // Releases the run of buffered packets contiguous with m_nextSeqExt.
+    void flushContiguous();
+
+    // Unpacks an RFC 2198 RED packet: redundant blocks whose primaries
+    // never arrived are delivered first, then the primary block.
+    int processRedPacket(std::shared_ptr<erizo::DataPacket> audio_packet);
+    void deliverPayload(int payloadType, uint32_t timeStamp, uint16_t seqNumber,
+        uint8_t marker, uint32_t ssrc, const uint8_t* data, uint32_t length,
+        int audioLevel = -1);
+    // Returns the RFC 6464 level from the packet's one-byte header
+    // extensions, or -1 when absent.
+    int extractAudioLevel(const uint8_t* data, uint32_t length);
+
     bool m_enabled;
+    uint32_t m_audioLevelExtId;
     erizo::MediaSource* m_transport;
     boost::shared_mutex m_transport_mutex;
 
+    // Timestamp of the newest frame handed downstream; a redundant block
+    // older than this was already delivered as a primary and is dropped.
+    uint32_t m_lastDeliveredTs;
+    bool m_hasDelivered;
+
+    // reorder stage state (see reorderDeliver): next expected sequence
+    // number on an extended (wrap-free) scale, the packets waiting behind
+    // a gap keyed by that scale, and the adaptive window in packets
+    // (0 = pass-through).
+    bool m_seqInit;
+    int64_t m_nextSeqExt;
+    uint32_t m_reorderSsrc;
+    uint32_t m_reorderWindow;
+    uint32_t m_inOrderStreak;
+    std::map<int64_t, std::shared_ptr<erizo::DataPacket>> m_reorderQueue;
+
     ////////////// NEW INTERFACE ///////////
     int deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet) override;
     int deliverVideoData_(std::shared_ptr<erizo::DataPacket> video_packet) override;
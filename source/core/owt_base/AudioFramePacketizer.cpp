@@ -4,8 +4,10 @@
 
 #include "AudioFramePacketizer.h"
 #include "AudioUtilities.h"
+#include "PacketPool.h"
 
 #include "WebRTCTaskRunner.h"
+#include <rtputils.h>
 
 using namespace webrtc;
 
@@ -13,11 +15,33 @@ namespace owt_base {
 
 DEFINE_LOGGER(AudioFramePacketizer, "owt.AudioFramePacketizer");
 
+// RFC 2198 limits: 14-bit timestamp offset, 10-bit block length.
+static const uint32_t kMaxRedTsOffset = 0x3FFF;
+static const size_t kMaxRedBlockLength = 0x3FF;
+static const size_t kMaxRedPayloadSize = 4096;
+static const int kMaxRedDistance = 3;
+
+// RED redundancy distance taken from OWT_AUDIO_RED; 0 (the default) keeps
+// RED off since it costs bitrate and the receiving side must understand
+// the payload type.
+static uint32_t audioRedDistance()
+{
+    static int distance = -1;
+    if (distance < 0) {
+        const char* env = getenv("OWT_AUDIO_RED");
+        distance = (env && env[0]) ? atoi(env) : 0;
+        if (distance < 0)
+            distance = 0;
+        if (distance > kMaxRedDistance)
+            distance = kMaxRedDistance;
+    }
+    return distance;
+}
+
 AudioFramePacketizer::AudioFramePacketizer()
     : m_enabled(true)
+    , m_redDistance(audioRedDistance())
     , m_frameFormat(FRAME_FORMAT_UNKNOWN)
-    , m_lastOriginSeqNo(0)
-    , m_seqNo(0)
     , m_ssrc(0)
     , m_ssrc_generator(SsrcGenerator::GetSsrcGenerator())
 {
@@ -25,15 +49,13 @@ AudioFramePacketizer::AudioFramePacketizer()
     m_ssrc = m_ssrc_generator->CreateSsrc();
     m_ssrc_generator->RegisterSsrc(m_ssrc);
     m_audioTransport.reset(new WebRTCTransport<erizoExtra::AUDIO>(this, nullptr));
-    m_taskRunner.reset(new owt_base::WebRTCTaskRunner("AudioFramePacketizer"));
-    m_taskRunner->Start();
+    m_taskRunner = WebRTCTaskRunner::SharedInstance("AudioFramePacketizer");
     init();
 }
 
 AudioFramePacketizer::~AudioFramePacketizer()
 {
     close();
-    m_taskRunner->Stop();
     m_ssrc_generator->ReturnSsrc(m_ssrc);
     SsrcGenerator::ReturnSsrcGenerator();
     boost::unique_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
@@ -71,7 +93,7 @@ void AudioFramePacketizer::receiveRtpData(char* buf, int len, erizoExtra::DataTy
     }
 
     assert(type == erizoExtra::AUDIO);
-    audio_sink_->deliverAudioData(std::make_shared<erizo::DataPacket>(0, buf, len, erizo::AUDIO_PACKET));
+    audio_sink_->deliverAudioData(PacketPool::obtain(0, buf, len, erizo::AUDIO_PACKET));
 }
 
 
@@ -94,22 +116,77 @@ void AudioFramePacketizer::onFrame(const Frame& frame)
         setSendCodec(m_frameFormat);
     }
 
-    if (frame.additionalInfo.audio.isRtpPacket) { // FIXME: Temporarily use Frame to carry rtp-packets due to the premature AudioFrameConstructor implementation.
-        updateSeqNo(frame.payload);
-        audio_sink_->deliverAudioData(std::make_shared<erizo::DataPacket>(0, reinterpret_cast<char*>(frame.payload), frame.length, erizo::AUDIO_PACKET));
-        return;
-    }
     lock1.unlock();
 
     int payloadType = getAudioPltype(frame.format);
     if (payloadType == INVALID_PT)
         return;
 
+    // RED only pays off for Opus: its frames are small enough that the
+    // redundant copies fit the 10-bit block length, and concealment of the
+    // narrowband codecs is considered good enough.
+    if (m_redDistance > 0 && frame.format == FRAME_FORMAT_OPUS) {
+        sendRedFrame(frame, payloadType);
+        return;
+    }
+
     boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
     // FIXME: The frame type information is lost. We treat every frame a kAudioFrameSpeech frame for now.
     m_rtpRtcp->SendOutgoingData(webrtc::kAudioFrameSpeech, payloadType, frame.timeStamp, -1, frame.payload, frame.length, nullptr, nullptr, nullptr);
 }
 
+void AudioFramePacketizer::sendRedFrame(const Frame& frame, int payloadType)
+{
+    // RFC 2198 layout: one 4-byte header per redundant block (oldest
+    // first), a 1-byte header for the primary, then the block data in the
+    // same order. Blocks that overflow the header fields are dropped from
+    // this packet but stay in the history.
+    uint8_t buf[kMaxRedPayloadSize];
+    size_t headerBytes = 0;
+    size_t dataBytes = frame.length;
+    std::vector<const RedundantFrame*> blocks;
+    for (std::deque<RedundantFrame>::const_iterator it = m_redHistory.begin();
+         it != m_redHistory.end(); ++it) {
+        uint32_t tsOffset = frame.timeStamp - it->timeStamp;
+        if (tsOffset > kMaxRedTsOffset || it->payload.size() > kMaxRedBlockLength)
+            continue;
+        blocks.push_back(&(*it));
+        headerBytes += 4;
+        dataBytes += it->payload.size();
+    }
+
+    size_t total = headerBytes + 1 + dataBytes;
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    if (total > kMaxRedPayloadSize) {
+        m_rtpRtcp->SendOutgoingData(webrtc::kAudioFrameSpeech, payloadType, frame.timeStamp, -1, frame.payload, frame.length, nullptr, nullptr, nullptr);
+    } else {
+        size_t pos = 0;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            uint32_t tsOffset = frame.timeStamp - blocks[i]->timeStamp;
+            uint32_t length = blocks[i]->payload.size();
+            buf[pos++] = 0x80 | (payloadType & 0x7F);
+            buf[pos++] = (tsOffset >> 6) & 0xFF;
+            buf[pos++] = ((tsOffset & 0x3F) << 2) | ((length >> 8) & 0x3);
+            buf[pos++] = length & 0xFF;
+        }
+        buf[pos++] = payloadType & 0x7F;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            memcpy(buf + pos, &blocks[i]->payload[0], blocks[i]->payload.size());
+            pos += blocks[i]->payload.size();
+        }
+        memcpy(buf + pos, frame.payload, frame.length);
+        pos += frame.length;
+        m_rtpRtcp->SendOutgoingData(webrtc::kAudioFrameSpeech, RED_48000_PT, frame.timeStamp, -1, buf, pos, nullptr, nullptr, nullptr);
+    }
+    lock.unlock();
+
+    m_redHistory.push_back(RedundantFrame());
+    m_redHistory.back().payload.assign(frame.payload, frame.payload + frame.length);
+    m_redHistory.back().timeStamp = frame.timeStamp;
+    while (m_redHistory.size() > m_redDistance)
+        m_redHistory.pop_front();
+}
+
 bool AudioFramePacketizer::init()
 {
     RtpRtcp::Configuration configuration;
@@ -136,6 +213,13 @@ bool AudioFramePacketizer::setSendCodec(FrameFormat format)
 
     boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
     m_rtpRtcp->RegisterSendPayload(codec);
+
+    if (m_redDistance > 0 && format == FRAME_FORMAT_OPUS) {
+        webrtc::CodecInst red = codec;
+        strcpy(red.plname, "red");
+        red.pltype = RED_48000_PT;
+        m_rtpRtcp->RegisterSendPayload(red);
+    }
     return true;
 }
 
@@ -145,21 +229,6 @@ void AudioFramePacketizer::close()
     m_taskRunner->DeRegisterModule(m_rtpRtcp.get());
 }
 
-void AudioFramePacketizer::updateSeqNo(uint8_t* rtp) {
-    uint16_t originSeqNo = *(reinterpret_cast<uint16_t*>(&rtp[2]));
-    if ((m_lastOriginSeqNo == m_seqNo) && (m_seqNo == 0)) {
-    } else {
-        uint16_t step = ((originSeqNo < m_lastOriginSeqNo) ? (UINT16_MAX - m_lastOriginSeqNo + originSeqNo + 1) : (originSeqNo - m_lastOriginSeqNo));
-        if ((step == 1) || (step > 10)) {
-          m_seqNo += 1;
-        } else {
-          m_seqNo += step;
-        }
-    }
-    m_lastOriginSeqNo = originSeqNo;
-    *(reinterpret_cast<uint16_t*>(&rtp[2])) = htons(m_seqNo);
-}
-
 int AudioFramePacketizer::sendPLI() {
     return 0;
 }
@@ -14,6 +14,8 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <deque>
+#include <vector>
 #include <MediaDefinitions.h>
 #include <MediaDefinitionExtra.h>
 #include <webrtc/modules/rtp_rtcp/include/rtp_rtcp.h>
@@ -51,9 +53,20 @@ private:
     bool init();
     bool setSendCodec(FrameFormat format);
     void close();
-    void updateSeqNo(uint8_t* rtp);
+    // Wraps the frame and the last OWT_AUDIO_RED frames into an RFC 2198
+    // RED payload and sends it under the audio RED payload type.
+    void sendRedFrame(const Frame& frame, int payloadType);
 
     bool m_enabled;
+    // RFC 2198 redundancy distance (0 = RED off); each Opus packet then
+    // repeats this many previous frames so a lost packet is repaired from
+    // its successor without the round trip NACK would cost.
+    uint32_t m_redDistance;
+    struct RedundantFrame {
+        std::vector<uint8_t> payload;
+        uint32_t timeStamp;
+    };
+    std::deque<RedundantFrame> m_redHistory;
     boost::scoped_ptr<webrtc::RtpRtcp> m_rtpRtcp;
     boost::shared_mutex m_rtpRtcpMutex;
 
@@ -62,8 +75,6 @@ private:
     FrameFormat m_frameFormat;
     boost::shared_mutex m_transport_mutex;
 
-    uint16_t m_lastOriginSeqNo;
-    uint16_t m_seqNo;
     uint32_t m_ssrc;
     SsrcGenerator* const m_ssrc_generator;
 
@@ -33,7 +33,6 @@ DEFINE_LOGGER(AudioFrameWriter, "owt.AudioFrameWriter");
 
 AudioFrameWriter::AudioFrameWriter(const std::string& name)
     : m_name(name)
-    , m_fp(NULL)
     , m_index(0)
     , m_sampleRate(0)
     , m_channels(0)
@@ -44,10 +43,8 @@ AudioFrameWriter::AudioFrameWriter(const std::string& name)
 
 AudioFrameWriter::~AudioFrameWriter()
 {
-    if (m_fp) {
-        fclose(m_fp);
-        m_fp = NULL;
-    }
+    if (m_file.droppedBytes())
+        ELOG_WARN_T("Disk could not keep up, dropped %lu dump bytes", m_file.droppedBytes());
 
     if (m_context) {
         av_write_trailer(m_context);
@@ -174,16 +171,6 @@ void AudioFrameWriter::writeCompressedFrame(const Frame& frame)
     uint8_t *payload = frame.payload;
     uint32_t length = frame.length;
 
-    if (frame.additionalInfo.audio.isRtpPacket) {
-        ELOG_INFO_T("isRtpPacket");
-
-        ::RTPHeader* rtp = reinterpret_cast<::RTPHeader*>(payload);
-        uint32_t headerLength = rtp->getHeaderLength();
-        assert(length >= headerLength);
-        payload += headerLength;
-        length -= headerLength;
-    }
-
     av_init_packet(&pkt);
 
     pkt.data = payload;
@@ -228,32 +215,29 @@ void AudioFrameWriter::write(const Frame& frame)
     }
 }
 
-FILE *AudioFrameWriter::getAudioFp(const webrtc::AudioFrame *audioFrame)
+bool AudioFrameWriter::ensureAudioFile(const webrtc::AudioFrame *audioFrame)
 {
     if (m_sampleRate != audioFrame->sample_rate_hz_
             || m_channels != (int32_t)audioFrame->num_channels_) {
-        if (m_fp) {
-            fclose(m_fp);
-            m_fp = NULL;
-        }
-
         m_index++;
 
         char fileName[128];
         snprintf(fileName, 128, "/tmp/%s-%d-%d-%ld.pcm16", m_name.c_str(), m_index, audioFrame->sample_rate_hz_, audioFrame->num_channels_);
-        m_fp = fopen(fileName, "wb");
-        if (!m_fp) {
+        FILE *fp = fopen(fileName, "wb");
+        if (!fp) {
             ELOG_ERROR_T("Can not open dump file, %s", fileName);
-            return NULL;
+            m_file.reset(NULL);
+            return false;
         }
 
         ELOG_INFO_T("Dump: %s", fileName);
+        m_file.reset(fp);
 
         m_sampleRate = audioFrame->sample_rate_hz_;
         m_channels = audioFrame->num_channels_;
     }
 
-    return m_fp;
+    return m_file.isOpen();
 }
 
 void AudioFrameWriter::write(const webrtc::AudioFrame *audioFrame)
@@ -268,13 +252,13 @@ void AudioFrameWriter::write(const webrtc::AudioFrame *audioFrame)
         return;
     }
 
-    FILE *fp = getAudioFp(audioFrame);
-    if (!fp) {
-        ELOG_ERROR_T("NULL fp");
+    if (!ensureAudioFile(audioFrame)) {
+        ELOG_ERROR_T("No dump file");
         return;
     }
 
-    fwrite(audioFrame->data(), 1, audioFrame->samples_per_channel_* audioFrame->num_channels_ * 2, fp);
+    m_file.write(reinterpret_cast<const uint8_t *>(audioFrame->data()),
+            audioFrame->samples_per_channel_ * audioFrame->num_channels_ * 2);
 }
 
 } /* namespace mcu */
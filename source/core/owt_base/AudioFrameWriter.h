@@ -11,6 +11,7 @@
 
 #include <webrtc/modules/include/module_common_types.h>
 
+#include "AsyncDumpWriter.h"
 #include "MediaFramePipeline.h"
 
 extern "C" {
@@ -30,7 +31,7 @@ public:
     void write(const webrtc::AudioFrame *audioFrame);
 
 protected:
-    FILE *getAudioFp(const webrtc::AudioFrame *audioFrame);
+    bool ensureAudioFile(const webrtc::AudioFrame *audioFrame);
 
     void writeCompressedFrame(const Frame& frame);
     bool addAudioStream(FrameFormat format, uint32_t sampleRate, uint32_t channels);
@@ -38,7 +39,7 @@ protected:
 private:
     std::string m_name;
 
-    FILE *m_fp;
+    AsyncDumpWriter m_file;
     uint32_t m_index;
 
     int32_t m_sampleRate;
@@ -2,9 +2,12 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <stdlib.h>
+
 #include <webrtc/common_types.h>
 
 #include "rtputils.h"
+#include "FormatTraits.h"
 #include "MediaFramePipeline.h"
 
 using namespace webrtc;
@@ -120,6 +123,13 @@ static const AudioCodecInsMap codecInsDB[] = {
 
 static const int numCodecIns = sizeof(codecInsDB) / sizeof(codecInsDB[0]);
 
+// The constexpr traits in FormatTraits.h mirror this table; keep them in
+// sync. Spot-check the hot format at compile time.
+static_assert(FormatTraitsOf<FRAME_FORMAT_OPUS>::payloadType == OPUS_48000_PT
+    && FormatTraitsOf<FRAME_FORMAT_OPUS>::sampleRate == 48000
+    && FormatTraitsOf<FRAME_FORMAT_OPUS>::channels == 2,
+    "FormatTraits out of sync with codecInsDB");
+
 bool getAudioCodecInst(owt_base::FrameFormat format, CodecInst& audioCodec)
 {
     for (size_t i = 0; i < numCodecIns; i++) {
@@ -132,15 +142,29 @@ bool getAudioCodecInst(owt_base::FrameFormat format, CodecInst& audioCodec)
     return false;
 }
 
-int getAudioPltype(owt_base::FrameFormat format)
+// Expected packet loss percentage for Opus in-band FEC, taken from
+// OWT_AUDIO_FEC; 0 (the default) keeps FEC off since the redundancy is
+// paid for in bitrate. libopus quantizes the hint, so values beyond 20
+// buy nothing extra.
+int getAudioFecPacketLossRate()
 {
-    for (size_t i = 0; i < numCodecIns; i++) {
-        if (codecInsDB[i].format == format) {
-            return codecInsDB[i].codec.pltype;
-        }
+    static int lossRate = -1;
+    if (lossRate < 0) {
+        const char* env = getenv("OWT_AUDIO_FEC");
+        lossRate = (env && env[0]) ? atoi(env) : 0;
+        if (lossRate < 0)
+            lossRate = 0;
+        if (lossRate > 20)
+            lossRate = 20;
     }
+    return lossRate;
+}
 
-    return INVALID_PT;
+int getAudioPltype(owt_base::FrameFormat format)
+{
+    // Constexpr traits chain (FormatTraits.h), ordered with the hot formats
+    // first; no table scan on the per-frame path.
+    return audioPayloadType(format);
 }
 
 FrameFormat getAudioFrameFormat(int pltype)
@@ -155,45 +179,11 @@ FrameFormat getAudioFrameFormat(int pltype)
 }
 
 int32_t getAudioSampleRate(const owt_base::FrameFormat format) {
-    switch (format) {
-        case owt_base::FRAME_FORMAT_AAC_48000_2:
-            return 48000;
-        case owt_base::FRAME_FORMAT_AAC:
-        case owt_base::FRAME_FORMAT_AC3:
-        case owt_base::FRAME_FORMAT_NELLYMOSER:
-            return 0;
-        default:
-            break;
-    }
-
-    for (size_t i = 0; i < numCodecIns; i++) {
-        if (codecInsDB[i].format == format) {
-            return codecInsDB[i].codec.plfreq;
-        }
-    }
-
-    return 0;
+    return audioSampleRate(format);
 }
 
 uint32_t getAudioChannels(const owt_base::FrameFormat format) {
-    switch (format) {
-        case owt_base::FRAME_FORMAT_AAC_48000_2:
-            return 2;
-        case owt_base::FRAME_FORMAT_AAC:
-        case owt_base::FRAME_FORMAT_AC3:
-        case owt_base::FRAME_FORMAT_NELLYMOSER:
-            return 0;
-        default:
-            break;
-    }
-
-    for (size_t i = 0; i < numCodecIns; i++) {
-        if (codecInsDB[i].format == format) {
-            return codecInsDB[i].codec.channels;
-        }
-    }
-
-    return 0;
+    return audioChannels(format);
 }
 
 } /* namespace owt_base */
@@ -20,6 +20,7 @@ static inline int64_t currentTimeMs()
 
 FrameFormat getAudioFrameFormat(int pltype);
 bool getAudioCodecInst(owt_base::FrameFormat format, webrtc::CodecInst& audioCodec);
+int getAudioFecPacketLossRate();
 int getAudioPltype(owt_base::FrameFormat format);
 int32_t getAudioSampleRate(const owt_base::FrameFormat format);
 uint32_t getAudioChannels(const owt_base::FrameFormat format);
@@ -0,0 +1,113 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ContentClassifier.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(ContentClassifier, "owt.ContentClassifier");
+
+// A frame votes "screen" when flat samples dominate and mid-range
+// gradients - the signature of camera sensor noise - almost vanish.
+static const double kFlatFractionMin = 0.5;
+static const double kMidFractionMax = 0.15;
+// Samples within this distance of the previous frame's count as
+// unchanged; a frame almost entirely unchanged is a static repeat.
+static const int kStaticDelta = 2;
+static const double kStaticFractionMin = 0.995;
+// Hysteresis: at one vote up / two votes down per frame, engaging takes
+// a couple of seconds of screen-like content and releasing about one.
+static const int kScoreMax = 60;
+static const int kScoreEngage = 45;
+static const int kScoreRelease = 15;
+
+bool ContentClassifier::enabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_SCREEN_CONTENT");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+ContentClassifier::ContentClassifier()
+    : m_haveSamples(false)
+    , m_width(0)
+    , m_height(0)
+    , m_score(0)
+    , m_screen(false)
+    , m_lastStatic(false)
+{
+    memset(m_samples, 0, sizeof(m_samples));
+}
+
+void ContentClassifier::analyze(const webrtc::VideoFrameBuffer* buffer)
+{
+    if (!buffer)
+        return;
+
+    const int width = buffer->width();
+    const int height = buffer->height();
+    const uint8_t* luma = buffer->DataY();
+    const int stride = buffer->StrideY();
+
+    if (width < kGridSize || height < kGridSize)
+        return;
+
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_haveSamples = false;
+        m_lastStatic = false;
+    }
+
+    uint8_t samples[kGridSize * kGridSize];
+    int flat = 0, mid = 0, unchanged = 0;
+
+    for (int gy = 0; gy < kGridSize; gy++) {
+        const uint8_t* row = luma + (size_t)(gy * height / kGridSize) * stride;
+        for (int gx = 0; gx < kGridSize; gx++) {
+            int i = gy * kGridSize + gx;
+            samples[i] = row[gx * width / kGridSize];
+
+            if (gx > 0) {
+                int grad = abs((int)samples[i] - (int)samples[i - 1]);
+                if (grad <= 2)
+                    flat++;
+                else if (grad < 48)
+                    mid++;
+            }
+            if (m_haveSamples && abs((int)samples[i] - (int)m_samples[i]) <= kStaticDelta)
+                unchanged++;
+        }
+    }
+
+    const int total = kGridSize * (kGridSize - 1);
+    bool screenLike = (flat > total * kFlatFractionMin) && (mid < total * kMidFractionMax);
+
+    m_lastStatic = m_haveSamples
+        && unchanged >= (int)(kGridSize * kGridSize * kStaticFractionMin);
+    // Unchanged frames carry no gradient evidence either way; let them
+    // keep the current verdict instead of voting.
+    if (!m_lastStatic)
+        m_score = screenLike ? std::min(m_score + 1, kScoreMax) : std::max(m_score - 2, 0);
+
+    if (!m_screen && m_score >= kScoreEngage) {
+        m_screen = true;
+        ELOG_DEBUG("Classified as screen content (%dx%d)", width, height);
+    } else if (m_screen && m_score <= kScoreRelease) {
+        m_screen = false;
+        ELOG_DEBUG("Classified as camera video (%dx%d)", width, height);
+    }
+
+    memcpy(m_samples, samples, sizeof(samples));
+    m_haveSamples = true;
+}
+
+} /* namespace owt_base */
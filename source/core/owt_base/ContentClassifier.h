@@ -0,0 +1,63 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ContentClassifier_h
+#define ContentClassifier_h
+
+#include <stdint.h>
+
+#include <webrtc/api/video/video_frame_buffer.h>
+
+#include "logger.h"
+
+namespace owt_base {
+
+/**
+ * Classifies a raw video stream as camera video or screen content from
+ * cheap sampled-luma statistics, so encoders can flip matching streams
+ * into a content-tuned mode. Screen shares are bimodal - large flat
+ * regions plus razor-sharp edges, with long runs of identical frames -
+ * while camera video carries sensor noise and mid-range gradients in
+ * every frame. The classification carries hysteresis, so brief stills
+ * on a camera or scrolling on a share do not flap the encoder.
+ */
+class ContentClassifier {
+    DECLARE_LOGGER();
+
+public:
+    // Gates content classification on OWT_SCREEN_CONTENT, set by the agent
+    // from the screen_content item in agent.toml.
+    static bool enabled();
+
+    ContentClassifier();
+
+    // Feed the luma plane of the next frame; costs a few thousand pixel
+    // reads per call.
+    void analyze(const webrtc::VideoFrameBuffer* buffer);
+
+    bool isScreenContent() const { return m_screen; }
+    // Whether the last analyzed frame was (near-)identical to the one
+    // before it, which is what screen shares are most of the time.
+    bool lastFrameStatic() const { return m_lastStatic; }
+
+private:
+    // 48x48 sample grid: dense enough to see text regions at any input
+    // resolution, cheap enough to run on every frame.
+    static const int kGridSize = 48;
+
+    uint8_t m_samples[kGridSize * kGridSize];
+    bool m_haveSamples;
+    int m_width;
+    int m_height;
+
+    // Hysteresis counter in [0, kScoreMax]; screen mode engages near the
+    // top and releases near the bottom.
+    int m_score;
+    bool m_screen;
+    bool m_lastStatic;
+};
+
+} /* namespace owt_base */
+
+#endif /* ContentClassifier_h */
@@ -0,0 +1,45 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DeliveryThreadPool_h
+#define DeliveryThreadPool_h
+
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace owt_base {
+
+// Process-wide worker pool for queued frame delivery.
+//
+// Each QueuedFrameDestination used to run a private delivery thread, so a
+// multicaster feeding 500 subscribers spawned 500 mostly-idle threads. The
+// pool runs one io_service with OWT_DELIVERY_THREADS workers (default: half
+// the hardware threads, at least 2); destinations submit through a
+// per-instance strand, which keeps each destination's frames ordered and
+// non-concurrent while delivery to different destinations spreads across
+// the workers.
+class DeliveryThreadPool {
+public:
+    static DeliveryThreadPool& instance();
+
+    // The shared io_service; wrap it in a strand per destination.
+    boost::asio::io_service& service();
+
+    // Runs an empty handler on `strand` and waits for it, so a destination
+    // being destroyed can let its in-flight delivery job finish first.
+    void drain(boost::asio::io_service::strand& strand);
+
+private:
+    DeliveryThreadPool();
+    ~DeliveryThreadPool();
+
+    boost::shared_ptr<boost::asio::io_service> m_service;
+    boost::shared_ptr<boost::asio::io_service::work> m_work;
+    boost::thread_group m_threads;
+};
+
+} /* namespace owt_base */
+
+#endif /* DeliveryThreadPool_h */
@@ -0,0 +1,66 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "EncodeThreadPool.h"
+
+#include <ThreadAffinity.h>
+
+#include <future>
+#include <stdlib.h>
+
+namespace owt_base {
+
+static size_t configuredWorkerCount()
+{
+    const char* env = getenv("OWT_ENCODE_THREADS");
+    if (env && env[0]) {
+        long n = strtol(env, NULL, 10);
+        if (n > 0 && n <= 64)
+            return n;
+    }
+    size_t cores = boost::thread::hardware_concurrency();
+    return cores > 4 ? cores / 2 : 2;
+}
+
+EncodeThreadPool& EncodeThreadPool::instance()
+{
+    static EncodeThreadPool pool;
+    return pool;
+}
+
+EncodeThreadPool::EncodeThreadPool()
+{
+    m_service.reset(new boost::asio::io_service());
+    m_work.reset(new boost::asio::io_service::work(*m_service));
+
+    size_t count = configuredWorkerCount();
+    for (size_t i = 0; i < count; ++i) {
+        boost::shared_ptr<boost::asio::io_service> service = m_service;
+        m_threads.create_thread([service]() {
+            ThreadAffinity::applyRole("encode");
+            service->run();
+        });
+    }
+}
+
+EncodeThreadPool::~EncodeThreadPool()
+{
+    m_work.reset();
+    m_service->stop();
+    m_threads.join_all();
+}
+
+boost::asio::io_service& EncodeThreadPool::service()
+{
+    return *m_service;
+}
+
+void EncodeThreadPool::drain(boost::asio::io_service::strand& strand)
+{
+    std::promise<void> done;
+    strand.post([&done]() { done.set_value(); });
+    done.get_future().wait();
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,46 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EncodeThreadPool_h
+#define EncodeThreadPool_h
+
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace owt_base {
+
+// Process-wide worker pool for software video encoding.
+//
+// Each VCMFrameEncoder used to run a private io_service thread, so 20
+// encoders on a 32-core node pinned 20 threads while the scheduler juggled
+// them against the pipeline threads. The pool runs one io_service with
+// OWT_ENCODE_THREADS workers (default: half the hardware threads, at least
+// 2); whichever worker is idle picks up the next queued encode, so
+// throughput scales with cores. Encoders submit through a per-instance
+// strand, which keeps each encoder's jobs ordered and non-concurrent -- the
+// same guarantee the private thread gave.
+class EncodeThreadPool {
+public:
+    static EncodeThreadPool& instance();
+
+    // The shared io_service; wrap it in a strand per encoder.
+    boost::asio::io_service& service();
+
+    // Runs an empty handler on `strand` and waits for it, so an encoder
+    // being destroyed can let its queued jobs finish first.
+    void drain(boost::asio::io_service::strand& strand);
+
+private:
+    EncodeThreadPool();
+    ~EncodeThreadPool();
+
+    boost::shared_ptr<boost::asio::io_service> m_service;
+    boost::shared_ptr<boost::asio::io_service::work> m_work;
+    boost::thread_group m_threads;
+};
+
+} /* namespace owt_base */
+
+#endif /* EncodeThreadPool_h */
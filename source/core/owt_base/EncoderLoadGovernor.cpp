@@ -0,0 +1,107 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "EncoderLoadGovernor.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(EncoderLoadGovernor, "owt.EncoderLoadGovernor");
+
+// Spacing between steps, and how long each watermark must hold.
+static const int64_t kStepCooldownMs = 5000;
+static const uint32_t kOverloadHoldSeconds = 1;
+static const uint32_t kUnderloadHoldSeconds = 30;
+
+static uint32_t envPercent(const char* name, uint32_t defaultPercent)
+{
+    const char* env = getenv(name);
+    if (!env)
+        return defaultPercent;
+
+    long value = atol(env);
+    if (value < 1)
+        value = 1;
+    if (value > 100)
+        value = 100;
+    return (uint32_t)value;
+}
+
+static int64_t nowMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+bool EncoderLoadGovernor::enabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_ENCODE_ADAPT");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+EncoderLoadGovernor::EncoderLoadGovernor()
+    : m_avgEncodeUs(0)
+    , m_overloadedFrames(0)
+    , m_underloadedFrames(0)
+    , m_lastStepMs(nowMs())
+    , m_highLoadPercent(envPercent("OWT_ENCODE_LOAD_HIGH", 85))
+    , m_lowLoadPercent(envPercent("OWT_ENCODE_LOAD_LOW", 50))
+{
+}
+
+EncoderLoadGovernor::Adaptation EncoderLoadGovernor::onEncodedFrame(int64_t encodeTimeUs, uint32_t frameRate)
+{
+    if (!enabled() || frameRate == 0)
+        return ADAPT_NONE;
+
+    // Exponential moving average so one slow frame does not trigger a step.
+    if (m_avgEncodeUs == 0)
+        m_avgEncodeUs = encodeTimeUs;
+    else
+        m_avgEncodeUs += (encodeTimeUs - m_avgEncodeUs) / 8;
+
+    int64_t frameIntervalUs = 1000000 / frameRate;
+
+    if (m_avgEncodeUs * 100 > frameIntervalUs * m_highLoadPercent) {
+        m_overloadedFrames++;
+        m_underloadedFrames = 0;
+    } else if (m_avgEncodeUs * 100 < frameIntervalUs * m_lowLoadPercent) {
+        m_underloadedFrames++;
+        m_overloadedFrames = 0;
+    } else {
+        m_overloadedFrames = 0;
+        m_underloadedFrames = 0;
+    }
+
+    int64_t now = nowMs();
+    if (now - m_lastStepMs < kStepCooldownMs)
+        return ADAPT_NONE;
+
+    if (m_overloadedFrames >= frameRate * kOverloadHoldSeconds) {
+        ELOG_DEBUG("Overloaded, avg encode %ld(us) of %ld(us) budget, step faster",
+            m_avgEncodeUs, frameIntervalUs);
+        m_overloadedFrames = 0;
+        m_lastStepMs = now;
+        return ADAPT_FASTER;
+    }
+
+    if (m_underloadedFrames >= frameRate * kUnderloadHoldSeconds) {
+        ELOG_DEBUG("Underloaded, avg encode %ld(us) of %ld(us) budget, step slower",
+            m_avgEncodeUs, frameIntervalUs);
+        m_underloadedFrames = 0;
+        m_lastStepMs = now;
+        return ADAPT_SLOWER;
+    }
+
+    return ADAPT_NONE;
+}
+
+} /* namespace owt_base */
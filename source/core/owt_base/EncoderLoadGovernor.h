@@ -0,0 +1,54 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EncoderLoadGovernor_h
+#define EncoderLoadGovernor_h
+
+#include <stdint.h>
+
+#include <logger.h>
+
+namespace owt_base {
+
+/**
+ * Watches per-frame encode wall time against the frame interval and tells
+ * the owning encoder when to step to a faster (or back to a slower) setting,
+ * so a loaded node degrades quality smoothly instead of dropping streams.
+ *
+ * Disabled unless OWT_ENCODE_ADAPT=1. The watermarks are percentages of the
+ * frame interval: sustained encode time above OWT_ENCODE_LOAD_HIGH (default
+ * 85) for about a second recommends ADAPT_FASTER; staying below
+ * OWT_ENCODE_LOAD_LOW (default 50) for about thirty seconds recommends
+ * ADAPT_SLOWER. Steps are spaced by a cooldown so the encoder settles
+ * between adjustments.
+ */
+class EncoderLoadGovernor {
+    DECLARE_LOGGER();
+
+public:
+    enum Adaptation {
+        ADAPT_NONE = 0,
+        ADAPT_FASTER,
+        ADAPT_SLOWER,
+    };
+
+    EncoderLoadGovernor();
+
+    static bool enabled();
+
+    // Record one frame's encode wall time, return the recommended step.
+    Adaptation onEncodedFrame(int64_t encodeTimeUs, uint32_t frameRate);
+
+private:
+    int64_t m_avgEncodeUs;
+    uint32_t m_overloadedFrames;
+    uint32_t m_underloadedFrames;
+    int64_t m_lastStepMs;
+
+    uint32_t m_highLoadPercent;
+    uint32_t m_lowLoadPercent;
+};
+
+} /* namespace owt_base */
+#endif /* EncoderLoadGovernor_h */
@@ -4,6 +4,10 @@
 
 #include "FFmpegDrawText.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 #include <libyuv/convert.h>
 #include <libyuv/planar_functions.h>
 #include <libyuv/scale.h>
@@ -27,6 +31,11 @@ FFmpegDrawText::FFmpegDrawText()
     , m_reconfigured(false)
     , m_validConfig(false)
     , m_enabled(false)
+    , m_overlayX(0)
+    , m_overlayY(0)
+    , m_overlayW(0)
+    , m_overlayH(0)
+    , m_overlayValid(false)
 {
 }
 
@@ -215,8 +224,6 @@ int FFmpegDrawText::setText(std::string arg)
 
 int FFmpegDrawText::drawFrame(Frame& frame)
 {
-    return 0;//disable
-
     int ret;
 
     switch (frame.format) {
@@ -253,10 +260,15 @@ int FFmpegDrawText::drawFrame(Frame& frame)
 
         m_width = frame.additionalInfo.video.width;
         m_height = frame.additionalInfo.video.height;
+
+        // The buffer source and the cached banner are both frame sized.
+        deinit();
+        init(m_width, m_height);
+        m_reconfigured = true;
     }
 
     if (m_reconfigured) {
-        if (configure(m_filter_desc))
+        if (configure(m_filter_desc) && rebuildOverlay())
             m_validConfig = true;
         else {
             m_validConfig = false;
@@ -268,116 +280,179 @@ int FFmpegDrawText::drawFrame(Frame& frame)
         m_reconfigured = false;
     }
 
-    if (!m_enabled || !m_validConfig) {
+    if (!m_enabled || !m_validConfig || !m_overlayValid) {
         return 1;
     }
 
-    if (!m_filter_graph) {
-        ELOG_TRACE_T("filter graph not ready!");
+    ELOG_TRACE_T("do drawFrame");
+
+    // Per frame the filter graph is not involved at all, just an alpha
+    // blend of the cached banner over its bounding box.
+    VideoFrame *videoFrame = reinterpret_cast<VideoFrame*>(frame.payload);
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> i420Buffer = videoFrame->video_frame_buffer();
+
+    uint8_t *dstY = const_cast<uint8_t*>(i420Buffer->DataY()) + m_overlayY * i420Buffer->StrideY() + m_overlayX;
+    uint8_t *dstU = const_cast<uint8_t*>(i420Buffer->DataU()) + (m_overlayY * i420Buffer->StrideU() + m_overlayX) / 2;
+    uint8_t *dstV = const_cast<uint8_t*>(i420Buffer->DataV()) + (m_overlayY * i420Buffer->StrideV() + m_overlayX) / 2;
+
+    ret = libyuv::I420Blend(
+            m_overlay->DataY() + m_overlayY * m_overlay->StrideY() + m_overlayX, m_overlay->StrideY(),
+            m_overlay->DataU() + (m_overlayY * m_overlay->StrideU() + m_overlayX) / 2, m_overlay->StrideU(),
+            m_overlay->DataV() + (m_overlayY * m_overlay->StrideV() + m_overlayX) / 2, m_overlay->StrideV(),
+            dstY, i420Buffer->StrideY(),
+            dstU, i420Buffer->StrideU(),
+            dstV, i420Buffer->StrideV(),
+            &m_overlayAlpha[(size_t)m_overlayY * m_width + m_overlayX], m_width,
+            dstY, i420Buffer->StrideY(),
+            dstU, i420Buffer->StrideU(),
+            dstV, i420Buffer->StrideV(),
+            m_overlayW, m_overlayH);
+    if (ret != 0) {
+        ELOG_ERROR_T("libyuv::I420Blend failed(%d)", ret);
         return 0;
     }
 
-    ELOG_TRACE_T("do drawFrame");
+    return 1;
+}
 
-    if (!copyFrame(m_input_frame, frame)) {
-        return 0;
+bool FFmpegDrawText::renderOnBackground(uint8_t backgroundLuma, rtc::scoped_refptr<webrtc::I420Buffer> &out)
+{
+    int ret;
+
+    if (!m_filter_graph || !m_input_frame) {
+        ELOG_TRACE_T("filter graph not ready!");
+        return false;
+    }
+
+    ret = av_frame_make_writable(m_input_frame);
+    if (ret < 0) {
+        ELOG_ERROR_T("av_frame_make_writable error: %s", ff_err2str(ret));
+        return false;
+    }
+
+    for (int y = 0; y < m_height; y++)
+        memset(m_input_frame->data[0] + y * m_input_frame->linesize[0], backgroundLuma, m_width);
+    for (int y = 0; y < (m_height + 1) / 2; y++) {
+        memset(m_input_frame->data[1] + y * m_input_frame->linesize[1], 128, (m_width + 1) / 2);
+        memset(m_input_frame->data[2] + y * m_input_frame->linesize[2], 128, (m_width + 1) / 2);
     }
 
     if (av_buffersrc_add_frame_flags(m_buffersrc_ctx, m_input_frame, AV_BUFFERSRC_FLAG_KEEP_REF) < 0) {
         ELOG_ERROR_T("Error while feeding the filtergraph");
-        return 0;
+        return false;
     }
 
     ret = av_buffersink_get_frame(m_buffersink_ctx, m_filt_frame);
     if (ret < 0) {
         ELOG_ERROR_T("av_buffersink_get_frame error");
-        return 0;
+        return false;
     }
 
-    if (!copyFrame(frame, m_filt_frame)) {
-        return 0;
+    out = webrtc::I420Buffer::Create(m_width, m_height);
+    if (!out) {
+        av_frame_unref(m_filt_frame);
+        return false;
     }
 
-    av_frame_unref(m_filt_frame);
+    libyuv::I420Copy(
+            m_filt_frame->data[0], m_filt_frame->linesize[0],
+            m_filt_frame->data[1], m_filt_frame->linesize[1],
+            m_filt_frame->data[2], m_filt_frame->linesize[2],
+            out->MutableDataY(), out->StrideY(),
+            out->MutableDataU(), out->StrideU(),
+            out->MutableDataV(), out->StrideV(),
+            m_width, m_height);
 
-    return 1;
+    av_frame_unref(m_filt_frame);
+    return true;
 }
 
-int FFmpegDrawText::copyFrame(AVFrame *dstAVFrame, Frame &srcFrame)
+bool FFmpegDrawText::rebuildOverlay()
 {
-    int ret;
-    VideoFrame *videoFrame = reinterpret_cast<VideoFrame*>(srcFrame.payload);
-    rtc::scoped_refptr<webrtc::VideoFrameBuffer> i420Buffer = videoFrame->video_frame_buffer();
-
-    if (i420Buffer->width() == dstAVFrame->width && i420Buffer->height() == dstAVFrame->height) {
-        ret = libyuv::I420Copy(
-                i420Buffer->DataY(), i420Buffer->StrideY(),
-                i420Buffer->DataU(), i420Buffer->StrideU(),
-                i420Buffer->DataV(), i420Buffer->StrideV(),
-                dstAVFrame->data[0], dstAVFrame->linesize[0],
-                dstAVFrame->data[1], dstAVFrame->linesize[1],
-                dstAVFrame->data[2], dstAVFrame->linesize[2],
-                i420Buffer->width(), i420Buffer->height());
-        if (ret != 0) {
-            ELOG_ERROR_T("libyuv::I420Copy failed(%d)", ret);
-            return false;
-        }
-    } else {
-        ret = libyuv::I420Scale(
-                i420Buffer->DataY(), i420Buffer->StrideY(),
-                i420Buffer->DataU(), i420Buffer->StrideU(),
-                i420Buffer->DataV(), i420Buffer->StrideV(),
-                i420Buffer->width(), i420Buffer->height(),
-                dstAVFrame->data[0], dstAVFrame->linesize[0],
-                dstAVFrame->data[1], dstAVFrame->linesize[1],
-                dstAVFrame->data[2], dstAVFrame->linesize[2],
-                dstAVFrame->width,   dstAVFrame->height,
-                libyuv::kFilterBox);
-        if (ret != 0) {
-            ELOG_ERROR_T("libyuv::I420Scale failed(%d)", ret);
-            return false;
+    m_overlayValid = false;
+
+    // Rendering the same text over black and over white recovers both the
+    // text color and its coverage: out = (a * T + (255 - a) * bg) / 255
+    // gives a = 255 - (outWhite - outBlack) and T = 255 * outBlack / a.
+    rtc::scoped_refptr<webrtc::I420Buffer> onBlack;
+    rtc::scoped_refptr<webrtc::I420Buffer> onWhite;
+    if (!renderOnBackground(0, onBlack) || !renderOnBackground(255, onWhite))
+        return false;
+
+    if (!m_overlay || m_overlay->width() != m_width || m_overlay->height() != m_height)
+        m_overlay = webrtc::I420Buffer::Create(m_width, m_height);
+    if (!m_overlay)
+        return false;
+
+    m_overlayAlpha.assign((size_t)m_width * m_height, 0);
+
+    int minX = m_width;
+    int minY = m_height;
+    int maxX = -1;
+    int maxY = -1;
+    for (int y = 0; y < m_height; y++) {
+        const uint8_t *black = onBlack->DataY() + y * onBlack->StrideY();
+        const uint8_t *white = onWhite->DataY() + y * onWhite->StrideY();
+        uint8_t *alpha = &m_overlayAlpha[(size_t)y * m_width];
+        uint8_t *text = m_overlay->MutableDataY() + y * m_overlay->StrideY();
+        for (int x = 0; x < m_width; x++) {
+            int d = (int)white[x] - (int)black[x];
+            d = std::max(0, std::min(255, d));
+            int a = 255 - d;
+            alpha[x] = (uint8_t)a;
+            text[x] = a ? (uint8_t)std::min(255, (int)black[x] * 255 / a) : 0;
+            if (a) {
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
         }
     }
 
-    return true;
-}
-
-int FFmpegDrawText::copyFrame(Frame &dstFrame, AVFrame *srcAVFrame)
-{
-    int ret;
-    VideoFrame *videoFrame = reinterpret_cast<VideoFrame*>(dstFrame.payload);
-    rtc::scoped_refptr<webrtc::VideoFrameBuffer> i420Buffer = videoFrame->video_frame_buffer();
-
-    if (i420Buffer->width() == srcAVFrame->width && i420Buffer->height() == srcAVFrame->height) {
-        ret = libyuv::I420Copy(
-                srcAVFrame->data[0], srcAVFrame->linesize[0],
-                srcAVFrame->data[1], srcAVFrame->linesize[1],
-                srcAVFrame->data[2], srcAVFrame->linesize[2],
-                const_cast< uint8_t*>(i420Buffer->DataY()), i420Buffer->StrideY(),
-                const_cast< uint8_t*>(i420Buffer->DataU()), i420Buffer->StrideU(),
-                const_cast< uint8_t*>(i420Buffer->DataV()), i420Buffer->StrideV(),
-                i420Buffer->width(), i420Buffer->height());
-        if (ret != 0) {
-            ELOG_ERROR_T("libyuv::I420Copy failed(%d)", ret);
-            return false;
-        }
-    } else {
-        ret = libyuv::I420Scale(
-                srcAVFrame->data[0], srcAVFrame->linesize[0],
-                srcAVFrame->data[1], srcAVFrame->linesize[1],
-                srcAVFrame->data[2], srcAVFrame->linesize[2],
-                srcAVFrame->width, srcAVFrame->height,
-                const_cast< uint8_t*>(i420Buffer->DataY()), i420Buffer->StrideY(),
-                const_cast< uint8_t*>(i420Buffer->DataU()), i420Buffer->StrideU(),
-                const_cast< uint8_t*>(i420Buffer->DataV()), i420Buffer->StrideV(),
-                i420Buffer->width(), i420Buffer->height(),
-                libyuv::kFilterBox);
-        if (ret != 0) {
-            ELOG_ERROR_T("libyuv::I420Scale failed(%d)", ret);
-            return false;
+    if (maxX < 0) {
+        // The text renders to nothing (e.g. an empty string).
+        return true;
+    }
+
+    // Chroma from the black render, undoing the blend against the neutral
+    // background with the subsampled alpha.
+    int chromaWidth = (m_width + 1) / 2;
+    int chromaHeight = (m_height + 1) / 2;
+    for (int y = 0; y < chromaHeight; y++) {
+        const uint8_t *blackU = onBlack->DataU() + y * onBlack->StrideU();
+        const uint8_t *blackV = onBlack->DataV() + y * onBlack->StrideV();
+        uint8_t *textU = m_overlay->MutableDataU() + y * m_overlay->StrideU();
+        uint8_t *textV = m_overlay->MutableDataV() + y * m_overlay->StrideV();
+        for (int x = 0; x < chromaWidth; x++) {
+            int x0 = 2 * x;
+            int x1 = std::min(2 * x + 1, m_width - 1);
+            int y0 = 2 * y;
+            int y1 = std::min(2 * y + 1, m_height - 1);
+            int a = ((int)m_overlayAlpha[(size_t)y0 * m_width + x0]
+                    + (int)m_overlayAlpha[(size_t)y0 * m_width + x1]
+                    + (int)m_overlayAlpha[(size_t)y1 * m_width + x0]
+                    + (int)m_overlayAlpha[(size_t)y1 * m_width + x1] + 2) / 4;
+            if (a) {
+                int u = (255 * (int)blackU[x] - (255 - a) * 128) / a;
+                int v = (255 * (int)blackV[x] - (255 - a) * 128) / a;
+                textU[x] = (uint8_t)std::max(0, std::min(255, u));
+                textV[x] = (uint8_t)std::max(0, std::min(255, v));
+            } else {
+                textU[x] = 128;
+                textV[x] = 128;
+            }
         }
     }
 
+    // Even-aligned bounding box, the per-frame blend covers only this rect.
+    m_overlayX = minX & ~1;
+    m_overlayY = minY & ~1;
+    m_overlayW = std::min(m_width - m_overlayX, (maxX - m_overlayX + 2) & ~1);
+    m_overlayH = std::min(m_height - m_overlayY, (maxY - m_overlayY + 2) & ~1);
+    m_overlayValid = true;
+
+    ELOG_DEBUG_T("overlay rebuilt: %dx%d at (%d, %d)", m_overlayW, m_overlayH, m_overlayX, m_overlayY);
     return true;
 }
 
@@ -5,6 +5,8 @@
 #ifndef FFmpegDrawText_h
 #define FFmpegDrawText_h
 
+#include <vector>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <logger.h>
@@ -41,8 +43,8 @@ protected:
     int configure(std::string arg);
     void deinit();
 
-    int copyFrame(AVFrame *dstAVFrame, Frame &srcFrame);
-    int copyFrame(Frame &dstFrame, AVFrame *srcAVFrame);
+    bool renderOnBackground(uint8_t backgroundLuma, rtc::scoped_refptr<webrtc::I420Buffer> &out);
+    bool rebuildOverlay();
 
 private:
     AVFilterGraph *m_filter_graph;
@@ -64,6 +66,17 @@ private:
 
     bool m_enabled;
 
+    // cached banner: the filter graph renders the text only when it (or the
+    // frame size) changes, per frame the cached rendering is alpha-blended
+    // over its bounding box with libyuv.
+    rtc::scoped_refptr<webrtc::I420Buffer> m_overlay;
+    std::vector<uint8_t> m_overlayAlpha;
+    int m_overlayX;
+    int m_overlayY;
+    int m_overlayW;
+    int m_overlayH;
+    bool m_overlayValid;
+
     char m_errbuff[500];
     char *ff_err2str(int errRet);
 };
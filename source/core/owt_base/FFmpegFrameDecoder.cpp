@@ -4,8 +4,21 @@
 
 #include "FFmpegFrameDecoder.h"
 
+#include <libyuv/convert.h>
+
+#include "FrameConverter.h"
+
 namespace owt_base {
 
+// VAAPI offload is opt-in (OWT_FFMPEG_VAAPI, exported from agent.toml like the
+// affinity settings); any failure before or during decode falls back to the
+// software path so ingest keeps working on machines without a usable driver.
+static bool vaapiRequested()
+{
+    const char* env = getenv("OWT_FFMPEG_VAAPI");
+    return env && env[0] == '1';
+}
+
 DEFINE_LOGGER(FFmpegFrameDecoder, "owt.FFmpegFrameDecoder");
 
 int FFmpegFrameDecoder::AVGetBuffer(AVCodecContext *s, AVFrame *frame, int flags)
@@ -14,6 +27,11 @@ int FFmpegFrameDecoder::AVGetBuffer(AVCodecContext *s, AVFrame *frame, int flags
     int width = frame->width;
     int height = frame->height;
 
+    // 10-bit content (HEVC Main10 and friends) does not fit the 8-bit I420
+    // pool planes; let ffmpeg allocate, onFrame narrows it afterwards.
+    if (s->pix_fmt == AV_PIX_FMT_YUV420P10LE || s->pix_fmt == AV_PIX_FMT_YUV420P10BE)
+        return avcodec_default_get_buffer2(s, frame, flags);
+
     avcodec_align_dimensions(s, &width, &height);
 
     rtc::scoped_refptr<webrtc::I420Buffer> frame_buffer = FFmpegDecoder->m_bufferManager->getFreeBuffer(width, height);
@@ -57,9 +75,25 @@ void FFmpegFrameDecoder::AVFreeBuffer(void* opaque, uint8_t* data)
     return;
 }
 
+enum AVPixelFormat FFmpegFrameDecoder::AVGetFormat(AVCodecContext *s, const enum AVPixelFormat *pix_fmts)
+{
+    for (const enum AVPixelFormat *p = pix_fmts; *p != AV_PIX_FMT_NONE; p++) {
+        if (*p == AV_PIX_FMT_VAAPI)
+            return *p;
+    }
+
+    // The driver declined this stream (profile/resolution); let ffmpeg pick
+    // a software format and continue through the normal path.
+    ELOG_WARN("VAAPI not offered for this stream, decoding in software");
+    return pix_fmts[0];
+}
+
 FFmpegFrameDecoder::FFmpegFrameDecoder()
     : m_decCtx(NULL)
     , m_decFrame(NULL)
+    , m_lastIngestMs(0)
+    , m_hwDeviceCtx(NULL)
+    , m_hwTransferFrame(NULL)
 {
 }
 
@@ -70,10 +104,19 @@ FFmpegFrameDecoder::~FFmpegFrameDecoder()
         m_decFrame = NULL;
     }
 
+    if (m_hwTransferFrame) {
+        av_frame_free(&m_hwTransferFrame);
+        m_hwTransferFrame = NULL;
+    }
+
     if (m_decCtx) {
         avcodec_close(m_decCtx);
         m_decCtx = NULL;
     }
+
+    if (m_hwDeviceCtx) {
+        av_buffer_unref(&m_hwDeviceCtx);
+    }
 }
 
 bool FFmpegFrameDecoder::init(FrameFormat format)
@@ -118,6 +161,19 @@ bool FFmpegFrameDecoder::init(FrameFormat format)
         return false;
     }
 
+    // VP8 has no VAAPI decode profile on the platforms we target.
+    if (vaapiRequested() && codec_id != AV_CODEC_ID_VP8) {
+        ret = av_hwdevice_ctx_create(&m_hwDeviceCtx, AV_HWDEVICE_TYPE_VAAPI, NULL, NULL, 0);
+        if (ret < 0) {
+            ELOG_WARN("OWT_FFMPEG_VAAPI set but no VAAPI device available, %s; decoding in software", ff_err2str(ret));
+            m_hwDeviceCtx = NULL;
+        } else {
+            m_decCtx->hw_device_ctx = av_buffer_ref(m_hwDeviceCtx);
+            m_decCtx->get_format = AVGetFormat;
+            ELOG_DEBUG_T("VAAPI decode enabled for %s", avcodec_get_name(codec_id));
+        }
+    }
+
     m_decCtx->get_buffer2 = AVGetBuffer;
     m_decCtx->opaque = this;
     ret = avcodec_open2(m_decCtx, dec , NULL);
@@ -146,6 +202,7 @@ void FFmpegFrameDecoder::onFrame(const Frame& frame)
     av_init_packet(&m_packet);
     m_packet.data = frame.payload;
     m_packet.size = frame.length;
+    m_lastIngestMs = frame.ingestTimeMs;
 
     ret = avcodec_send_packet(m_decCtx, &m_packet);
     if (ret < 0) {
@@ -162,6 +219,16 @@ void FFmpegFrameDecoder::onFrame(const Frame& frame)
         return;
     }
 
+    if (m_decFrame->format == AV_PIX_FMT_VAAPI) {
+        deliverHwFrame();
+        return;
+    }
+
+    if (m_decFrame->format == AV_PIX_FMT_YUV420P10LE) {
+        deliver10BitFrame();
+        return;
+    }
+
     webrtc::VideoFrame *video_frame = static_cast<webrtc::VideoFrame*>(
             av_buffer_get_opaque(m_decFrame->buf[0]));
 
@@ -174,6 +241,7 @@ void FFmpegFrameDecoder::onFrame(const Frame& frame)
         frame.timeStamp = video_frame->timestamp();
         frame.additionalInfo.video.width = video_frame->width();
         frame.additionalInfo.video.height = video_frame->height();
+        frame.ingestTimeMs = m_lastIngestMs;
 
         ELOG_TRACE_T("deliverFrame, %dx%d, timeStamp %d",
                 frame.additionalInfo.video.width,
@@ -183,6 +251,130 @@ void FFmpegFrameDecoder::onFrame(const Frame& frame)
     }
 }
 
+void FFmpegFrameDecoder::deliverHwFrame()
+{
+    int ret;
+
+    if (!m_hwTransferFrame) {
+        m_hwTransferFrame = av_frame_alloc();
+        if (!m_hwTransferFrame) {
+            ELOG_ERROR_T("Could not allocate hw transfer frame");
+            return;
+        }
+    }
+
+    // One readback per frame: the VAAPI surface comes back as NV12, which we
+    // repack into a pooled I420 buffer for the rest of the pipeline.
+    av_frame_unref(m_hwTransferFrame);
+    ret = av_hwframe_transfer_data(m_hwTransferFrame, m_decFrame, 0);
+    if (ret < 0) {
+        ELOG_ERROR_T("Error while transfer hw frame, %s", ff_err2str(ret));
+        return;
+    }
+
+    rtc::scoped_refptr<webrtc::I420Buffer> frame_buffer =
+        m_bufferManager->getFreeBuffer(m_hwTransferFrame->width, m_hwTransferFrame->height);
+    if (!frame_buffer) {
+        ELOG_ERROR_T("No free video buffer");
+        return;
+    }
+
+    if (m_hwTransferFrame->format == AV_PIX_FMT_NV12) {
+        ret = libyuv::NV12ToI420(
+                m_hwTransferFrame->data[0], m_hwTransferFrame->linesize[0],
+                m_hwTransferFrame->data[1], m_hwTransferFrame->linesize[1],
+                frame_buffer->MutableDataY(), frame_buffer->StrideY(),
+                frame_buffer->MutableDataU(), frame_buffer->StrideU(),
+                frame_buffer->MutableDataV(), frame_buffer->StrideV(),
+                m_hwTransferFrame->width, m_hwTransferFrame->height);
+        if (ret != 0) {
+            ELOG_ERROR_T("libyuv::NV12ToI420 failed(%d)", ret);
+            return;
+        }
+    } else if (m_hwTransferFrame->format == AV_PIX_FMT_P010LE) {
+        // Main10 surfaces read back as P010; narrow in-process instead of
+        // bouncing through an external preprocessor. linesize is in bytes.
+        if (!FrameConverter::convertP010ToI420(
+                reinterpret_cast<const uint16_t*>(m_hwTransferFrame->data[0]),
+                m_hwTransferFrame->linesize[0] / 2,
+                reinterpret_cast<const uint16_t*>(m_hwTransferFrame->data[1]),
+                m_hwTransferFrame->linesize[1] / 2,
+                m_hwTransferFrame->width, m_hwTransferFrame->height,
+                frame_buffer)) {
+            ELOG_ERROR_T("P010 -> I420 conversion failed");
+            return;
+        }
+    } else {
+        ELOG_ERROR_T("Unexpected hw transfer format %d", m_hwTransferFrame->format);
+        return;
+    }
+
+    webrtc::VideoFrame video_frame(frame_buffer,
+            0 /* timestamp */,
+            0 /* render_time_ms */,
+            webrtc::kVideoRotation_0);
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_I420;
+    frame.payload = reinterpret_cast<uint8_t*>(&video_frame);
+    frame.length = 0;
+    frame.timeStamp = video_frame.timestamp();
+    frame.additionalInfo.video.width = video_frame.width();
+    frame.additionalInfo.video.height = video_frame.height();
+    frame.ingestTimeMs = m_lastIngestMs;
+
+    ELOG_TRACE_T("deliverFrame(vaapi), %dx%d, timeStamp %d",
+            frame.additionalInfo.video.width,
+            frame.additionalInfo.video.height,
+            frame.timeStamp);
+    deliverFrame(frame);
+}
+
+void FFmpegFrameDecoder::deliver10BitFrame()
+{
+    // Software-decoded Main10 arrives as yuv420p10le in ffmpeg's own
+    // buffers (AVGetBuffer routed it past the I420 pool); narrow it into a
+    // pooled buffer once, here, rather than in an external preprocessor.
+    rtc::scoped_refptr<webrtc::I420Buffer> frame_buffer =
+        m_bufferManager->getFreeBuffer(m_decFrame->width, m_decFrame->height);
+    if (!frame_buffer) {
+        ELOG_ERROR_T("No free video buffer");
+        return;
+    }
+
+    if (!FrameConverter::convertI010ToI420(
+            reinterpret_cast<const uint16_t*>(m_decFrame->data[0]), m_decFrame->linesize[0] / 2,
+            reinterpret_cast<const uint16_t*>(m_decFrame->data[1]), m_decFrame->linesize[1] / 2,
+            reinterpret_cast<const uint16_t*>(m_decFrame->data[2]), m_decFrame->linesize[2] / 2,
+            m_decFrame->width, m_decFrame->height,
+            frame_buffer)) {
+        ELOG_ERROR_T("I010 -> I420 conversion failed");
+        return;
+    }
+
+    webrtc::VideoFrame video_frame(frame_buffer,
+            0 /* timestamp */,
+            0 /* render_time_ms */,
+            webrtc::kVideoRotation_0);
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_I420;
+    frame.payload = reinterpret_cast<uint8_t*>(&video_frame);
+    frame.length = 0;
+    frame.timeStamp = video_frame.timestamp();
+    frame.additionalInfo.video.width = video_frame.width();
+    frame.additionalInfo.video.height = video_frame.height();
+    frame.ingestTimeMs = m_lastIngestMs;
+
+    ELOG_TRACE_T("deliverFrame(10bit), %dx%d, timeStamp %d",
+            frame.additionalInfo.video.width,
+            frame.additionalInfo.video.height,
+            frame.timeStamp);
+    deliverFrame(frame);
+}
+
 char *FFmpegFrameDecoder::ff_err2str(int errRet)
 {
     av_strerror(errRet, (char*)(&m_errbuff), 500);
@@ -14,6 +14,7 @@
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
 }
 
 namespace owt_base {
@@ -33,13 +34,25 @@ public:
 protected:
     static int AVGetBuffer(AVCodecContext *s, AVFrame *frame, int flags);
     static void AVFreeBuffer(void* opaque, uint8_t* data);
+    static enum AVPixelFormat AVGetFormat(AVCodecContext *s, const enum AVPixelFormat *pix_fmts);
+
+    void deliverHwFrame();
+    void deliver10BitFrame();
 
 private:
     AVCodecContext *m_decCtx;
     AVFrame *m_decFrame;
 
+    // VAAPI hwaccel state; NULL/unused when decoding in software.
+    AVBufferRef *m_hwDeviceCtx;
+    AVFrame *m_hwTransferFrame;
+
     AVPacket m_packet;
 
+    // Ingest stamp of the packet last sent to the codec, copied onto the
+    // decoded output (the codec may hold a frame of delay).
+    int64_t m_lastIngestMs;
+
     boost::scoped_ptr<owt_base::I420BufferManager> m_bufferManager;
 
     char m_errbuff[500];
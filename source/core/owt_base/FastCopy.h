@@ -9,4 +9,14 @@
  */
 #include <boost/shared_ptr.hpp>
 
+/*
+ * Preferred entry point. Picks the widest streaming-load variant the CPU
+ * offers at runtime (AVX-512 when available, SSE4.1 otherwise) and, for
+ * surfaces above a size threshold, splits the copy into tiles spread over a
+ * small worker pool (OWT_FASTCOPY_THREADS overrides the worker count; 0
+ * keeps the copy serial).
+ */
+void *memcpy_from_uswc(boost::shared_ptr<uint8_t> dst, void *src, size_t size);
+
+/* Serial SSE4.1 variant, kept for callers that must not touch the pool. */
 void *memcpy_from_uswc_sse4(boost::shared_ptr<uint8_t> dst, void *src, size_t size);
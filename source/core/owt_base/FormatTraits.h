@@ -0,0 +1,112 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FormatTraits_h
+#define FormatTraits_h
+
+#include <rtputils.h>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+// Compile-time traits per frame format: RTP payload type, audio clock rate
+// and channel count (mirroring the codec table in AudioUtilities.cpp), and
+// whether the codec has keyframe semantics.
+//
+// FormatTraitsOf<F> serves stages that are specialized for one format - the
+// traits are constants, so format-conditional branches vanish. The
+// constexpr functions below serve runtime-format callers; they are chained
+// selects ordered by hotness (Opus first, it is the passthrough audio
+// format), so the common case resolves in one compare and calls with a
+// compile-time format fold to a constant.
+
+template <FrameFormat F> struct FormatTraitsOf;
+
+#define OWT_DEFINE_AUDIO_FORMAT_TRAITS(FORMAT, PT, RATE, CHANNELS) \
+    template <> struct FormatTraitsOf<FORMAT> {                    \
+        static constexpr bool isAudio = true;                      \
+        static constexpr bool isVideo = false;                     \
+        static constexpr bool hasKeyFrames = false;                \
+        static constexpr int payloadType = PT;                     \
+        static constexpr int32_t sampleRate = RATE;                \
+        static constexpr uint32_t channels = CHANNELS;             \
+    };
+
+#define OWT_DEFINE_VIDEO_FORMAT_TRAITS(FORMAT, PT)                 \
+    template <> struct FormatTraitsOf<FORMAT> {                    \
+        static constexpr bool isAudio = false;                     \
+        static constexpr bool isVideo = true;                      \
+        static constexpr bool hasKeyFrames = true;                 \
+        static constexpr int payloadType = PT;                     \
+        static constexpr int32_t sampleRate = 0;                   \
+        static constexpr uint32_t channels = 0;                    \
+    };
+
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_OPUS, OPUS_48000_PT, 48000, 2)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_PCMU, PCMU_8000_PT, 8000, 1)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_PCMA, PCMA_8000_PT, 8000, 1)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_ISAC16, ISAC_16000_PT, 16000, 1)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_ISAC32, ISAC_32000_PT, 32000, 1)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_ILBC, ILBC_8000_PT, 8000, 1)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_G722_16000_1, G722_16000_1_PT, 16000, 1)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_G722_16000_2, G722_16000_2_PT, 16000, 2)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_PCM_48000_2, L16_48000_PT, 48000, 2)
+OWT_DEFINE_AUDIO_FORMAT_TRAITS(FRAME_FORMAT_AAC_48000_2, INVALID_PT, 48000, 2)
+
+OWT_DEFINE_VIDEO_FORMAT_TRAITS(FRAME_FORMAT_VP8, VP8_90000_PT)
+OWT_DEFINE_VIDEO_FORMAT_TRAITS(FRAME_FORMAT_VP9, VP9_90000_PT)
+OWT_DEFINE_VIDEO_FORMAT_TRAITS(FRAME_FORMAT_H264, H264_90000_PT)
+OWT_DEFINE_VIDEO_FORMAT_TRAITS(FRAME_FORMAT_H265, H265_90000_PT)
+
+#undef OWT_DEFINE_AUDIO_FORMAT_TRAITS
+#undef OWT_DEFINE_VIDEO_FORMAT_TRAITS
+
+constexpr int audioPayloadType(FrameFormat format)
+{
+    return format == FRAME_FORMAT_OPUS ? OPUS_48000_PT
+        : format == FRAME_FORMAT_PCMU ? PCMU_8000_PT
+        : format == FRAME_FORMAT_PCMA ? PCMA_8000_PT
+        : format == FRAME_FORMAT_ISAC16 ? ISAC_16000_PT
+        : format == FRAME_FORMAT_ISAC32 ? ISAC_32000_PT
+        : format == FRAME_FORMAT_ILBC ? ILBC_8000_PT
+        : format == FRAME_FORMAT_G722_16000_1 ? G722_16000_1_PT
+        : format == FRAME_FORMAT_G722_16000_2 ? G722_16000_2_PT
+        : format == FRAME_FORMAT_PCM_48000_2 ? L16_48000_PT
+        : INVALID_PT;
+}
+
+constexpr int32_t audioSampleRate(FrameFormat format)
+{
+    return format == FRAME_FORMAT_OPUS ? 48000
+        : format == FRAME_FORMAT_PCMU ? 8000
+        : format == FRAME_FORMAT_PCMA ? 8000
+        : format == FRAME_FORMAT_ISAC16 ? 16000
+        : format == FRAME_FORMAT_ISAC32 ? 32000
+        : format == FRAME_FORMAT_ILBC ? 8000
+        : format == FRAME_FORMAT_G722_16000_1 ? 16000
+        : format == FRAME_FORMAT_G722_16000_2 ? 16000
+        : format == FRAME_FORMAT_PCM_48000_2 ? 48000
+        : format == FRAME_FORMAT_AAC_48000_2 ? 48000
+        : 0;
+}
+
+constexpr uint32_t audioChannels(FrameFormat format)
+{
+    return format == FRAME_FORMAT_OPUS ? 2
+        : format == FRAME_FORMAT_PCMU ? 1
+        : format == FRAME_FORMAT_PCMA ? 1
+        : format == FRAME_FORMAT_ISAC16 ? 1
+        : format == FRAME_FORMAT_ISAC32 ? 1
+        : format == FRAME_FORMAT_ILBC ? 1
+        : format == FRAME_FORMAT_G722_16000_1 ? 1
+        : format == FRAME_FORMAT_G722_16000_2 ? 2
+        : format == FRAME_FORMAT_PCM_48000_2 ? 2
+        : format == FRAME_FORMAT_AAC_48000_2 ? 2
+        : 0;
+}
+
+} /* namespace owt_base */
+
+#endif /* FormatTraits_h */
@@ -3,9 +3,16 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "FrameAnalyzer.h"
+#include "AnalyticsPluginPool.h"
+#ifdef ENABLE_MSDK
+#include "MsdkBase.h"
+#include <vaapi_allocator.h>
+#endif
 #include <dlfcn.h>
 #include <unistd.h>
 #include <string.h>
+#include <algorithm>
+#include <cstdlib>
 #include <unordered_map>
 
 using namespace webrtc;
@@ -22,6 +29,23 @@ FrameAnalyzer::FrameAnalyzer()
     , m_outHeight(-1)
     , m_outFrameRate(-1)
     , m_clock(NULL)
+    , m_lastIngestMs(0)
+    , m_frameStride(0)
+    , m_analysisFps(0)
+    , m_forwardSkipped(false)
+    , m_frameCounter(0)
+    , m_lastAnalyzedMs(0)
+    , m_gpuHandoff(false)
+    , m_roiQpOffset(-6)
+    , m_roiSeen(false)
+    , m_batchSize(1)
+    , m_batchWindowMs(0)
+    , m_batchStartMs(0)
+    , m_execRunning(false)
+    , m_flushRequested(false)
+    , m_execQueueDepth(4)
+    , m_analyzedFrames(0)
+    , m_droppedFrames(0)
 {
 }
 
@@ -30,6 +54,18 @@ FrameAnalyzer::~FrameAnalyzer()
     if (m_outFrameRate > 0) {
         m_jobTimer->stop();
     }
+    if (m_batchFlushTimer) {
+        m_batchFlushTimer->stop();
+    }
+    if (m_execRunning) {
+        {
+            boost::lock_guard<boost::mutex> guard(m_execMutex);
+            m_execRunning = false;
+        }
+        m_execCond.notify_one();
+        m_execThread.join();
+        ELOG_DEBUG_T("Plugin executor stats: analyzed(%u), dropped(%u)", m_analyzedFrames, m_droppedFrames);
+    }
     if (plugin_ != nullptr && plugin_handle_ != nullptr) {
          destroy_plugin(plugin_);
          dlclose(plugin_handle_);
@@ -52,42 +88,104 @@ bool FrameAnalyzer::init(FrameFormat format, const uint32_t width, const uint32_
     m_outHeight = height;
     m_outFrameRate = frameRate;
 
-//    m_plugin.reset(new rvaPlugin());
-    plugin_handle_ = dlopen(plugin_name_.c_str(), RTLD_LAZY);
-    if (plugin_handle_ == nullptr) {
-        ELOG_ERROR_T("Failed to open the plugin.(%s)", plugin_name_.c_str());
-        return false;
-    }
+    // dlopen+PluginInit compiles and loads models and can take seconds;
+    // adopt a pre-initialized instance when the agent warmed one at start
+    // (the pool leaves the frame callback for us to attach).
+    WarmPlugin warm;
+    if (AnalyticsPluginPool::instance().lease(plugin_name_, warm)) {
+        plugin_handle_ = warm.handle;
+        create_plugin = warm.create;
+        destroy_plugin = warm.destroy;
+        plugin_ = warm.plugin;
+
+        plugin_->RegisterFrameCallback(this);
+    } else {
+//        m_plugin.reset(new rvaPlugin());
+        plugin_handle_ = dlopen(plugin_name_.c_str(), RTLD_LAZY);
+        if (plugin_handle_ == nullptr) {
+            ELOG_ERROR_T("Failed to open the plugin.(%s)", plugin_name_.c_str());
+            return false;
+        }
 
-    create_plugin = (rva_create_t*)dlsym(plugin_handle_, "CreatePlugin");
-    destroy_plugin = (rva_destroy_t*)dlsym(plugin_handle_, "DestroyPlugin");
+        create_plugin = (rva_create_t*)dlsym(plugin_handle_, "CreatePlugin");
+        destroy_plugin = (rva_destroy_t*)dlsym(plugin_handle_, "DestroyPlugin");
 
-    if (create_plugin == nullptr || destroy_plugin == nullptr) {
-        ELOG_ERROR_T("Failed to get plugin interface.");
-        dlclose(plugin_handle_);
-        return false;
-    }
+        if (create_plugin == nullptr || destroy_plugin == nullptr) {
+            ELOG_ERROR_T("Failed to get plugin interface.");
+            dlclose(plugin_handle_);
+            return false;
+        }
 
-    plugin_ = create_plugin();
-    if (plugin_ == nullptr) {
-        ELOG_ERROR_T("Failed to create the plugin.");
-        dlclose(plugin_handle_);
-        return false;
+        plugin_ = create_plugin();
+        if (plugin_ == nullptr) {
+            ELOG_ERROR_T("Failed to create the plugin.");
+            dlclose(plugin_handle_);
+            return false;
+        }
+
+        // Register frame callback
+        plugin_->RegisterFrameCallback(this);
+
+        std::unordered_map<std::string, std::string> plugin_config_map(
+          {{"AnalyticsVersion", "1"}});
+        plugin_->PluginInit(plugin_config_map);
     }
 
-    // Register frame callback
-    plugin_->RegisterFrameCallback(this);
+    m_clock = Clock::GetRealTimeClock();
+
+    // Plugins advertise batched inference through their params; see the
+    // ProcessFramesAsync contract in AnalyticsPlugin.h.
+    std::unordered_map<std::string, std::string> plugin_params;
+    if (plugin_->GetPluginParams(plugin_params) == RVA_ERR_OK) {
+        auto it = plugin_params.find("BatchSize");
+        if (it != plugin_params.end())
+            m_batchSize = std::max(atoi(it->second.c_str()), 1);
+        it = plugin_params.find("BatchWindowMs");
+        if (it != plugin_params.end())
+            m_batchWindowMs = std::max(atoi(it->second.c_str()), 1);
+        it = plugin_params.find("FrameStride");
+        if (it != plugin_params.end())
+            m_frameStride = std::max(atoi(it->second.c_str()), 0);
+        it = plugin_params.find("AnalysisFps");
+        if (it != plugin_params.end())
+            m_analysisFps = std::max(atoi(it->second.c_str()), 0);
+        it = plugin_params.find("ForwardSkipped");
+        if (it != plugin_params.end())
+            m_forwardSkipped = (it->second == "true" || it->second == "1");
+#ifdef ENABLE_MSDK
+        it = plugin_params.find("GpuSurfaceSupport");
+        if (it != plugin_params.end())
+            m_gpuHandoff = (it->second == "true" || it->second == "1");
+#endif
+        it = plugin_params.find("QueueDepth");
+        if (it != plugin_params.end())
+            m_execQueueDepth = std::max(atoi(it->second.c_str()), 1);
+        it = plugin_params.find("RoiQpOffset");
+        if (it != plugin_params.end())
+            m_roiQpOffset = std::min(std::max(atoi(it->second.c_str()), -51), 51);
+
+        if (m_frameStride > 1 || m_analysisFps > 0)
+            ELOG_DEBUG_T("Decimation enabled, frameStride(%u), analysisFps(%u), forwardSkipped(%d)",
+                    m_frameStride, m_analysisFps, m_forwardSkipped);
+    }
+    if (m_batchSize > 1) {
+        if (m_batchWindowMs == 0)
+            m_batchWindowMs = 33;
+        ELOG_DEBUG_T("Plugin batching enabled, batchSize(%u), batchWindowMs(%u)", m_batchSize, m_batchWindowMs);
+
+        // Flushes a partial batch when no further frames arrive to fill it
+        // within the window.
+        m_batchFlushTimer.reset(new JobTimer(std::max(1000 / m_batchWindowMs, (uint32_t)1), this));
+        m_batchFlushTimer->start();
+    }
 
-    std::unordered_map<std::string, std::string> plugin_config_map(
-      {{"AnalyticsVersion", "1"}});
-    plugin_->PluginInit(plugin_config_map);
+    m_execRunning = true;
+    m_execThread = boost::thread(&FrameAnalyzer::executorLoop, this);
 
     if (m_format == FRAME_FORMAT_I420)
         m_bufferManager.reset(new I420BufferManager(3));
 
     if (m_outFrameRate != 0) {
-        m_clock = Clock::GetRealTimeClock();
-
         m_jobTimer.reset(new JobTimer(m_outFrameRate, this));
         m_jobTimer->start();
     }
@@ -133,10 +231,53 @@ void FrameAnalyzer::onFrame(const Frame& frame)
         }
     }
 
+    if (plugin_ && !shouldAnalyze()) {
+        if (m_forwardSkipped)
+            deliverFrame(frame);
+        return;
+    }
+
+    m_lastIngestMs = frame.ingestTimeMs;
+
     uint32_t width = (m_outWidth == 0 ? frame.additionalInfo.video.width : m_outWidth);
     uint32_t height = (m_outHeight == 0 ? frame.additionalInfo.video.height : m_outHeight);
 
 
+#ifdef ENABLE_MSDK
+    if (m_format == FRAME_FORMAT_MSDK && m_gpuHandoff) {
+        if (frame.format == FRAME_FORMAT_MSDK && plugin_) {
+            MsdkFrameHolder* holder = reinterpret_cast<MsdkFrameHolder*>(frame.payload);
+            if (!holder || !holder->frame || holder->cmd != MsdkCmd_NONE)
+                return;
+
+            // Make sure the decode op on the surface has completed before a
+            // plugin reads it from another VA context.
+            holder->frame->sync();
+
+            mfxFrameSurface1* surface = holder->frame->getSurface();
+            vaapiMemId* memId = reinterpret_cast<vaapiMemId*>(surface->Data.MemId);
+            if (!memId || !memId->m_surface) {
+                ELOG_ERROR_T("No VA surface behind MSDK frame");
+                return;
+            }
+
+            std::unique_ptr<owt::analytics::AnalyticsBuffer> newFrame(new owt::analytics::AnalyticsBuffer());
+            newFrame->width = holder->frame->getVideoWidth();
+            newFrame->height = holder->frame->getVideoHeight();
+            newFrame->va_display = MsdkBase::get()->getVaDisplay();
+            newFrame->va_surface_id = *memId->m_surface;
+            // Pin the MsdkFrame until the plugin destroys the buffer, so the
+            // decoder cannot recycle the surface under the inference run.
+            newFrame->native_owner = new boost::shared_ptr<MsdkFrame>(holder->frame);
+            newFrame->native_release = [](void* owner) {
+                delete static_cast<boost::shared_ptr<MsdkFrame>*>(owner);
+            };
+            submitToPlugin(std::move(newFrame));
+        }
+        return;
+    }
+#endif
+
     if (m_format == FRAME_FORMAT_I420) {
         if (frame.format == FRAME_FORMAT_I420) {
             VideoFrame *srcFrame = (reinterpret_cast<VideoFrame *>(frame.payload));
@@ -150,7 +291,7 @@ void FrameAnalyzer::onFrame(const Frame& frame)
             memcpy(newFrame->buffer + height * width , i420Buffer->DataU(), height * width / 4);
             memcpy(newFrame->buffer + height * width * 5 / 4, i420Buffer->DataV(), height * width / 4);
             if (plugin_) {
-                plugin_->ProcessFrameAsync(std::move(newFrame));
+                submitToPlugin(std::move(newFrame));
                 return;
             }
         }
@@ -165,9 +306,123 @@ void FrameAnalyzer::onFrame(const Frame& frame)
     return;
 }
 
+bool FrameAnalyzer::shouldAnalyze()
+{
+    if (m_frameStride > 1) {
+        return (m_frameCounter++ % m_frameStride) == 0;
+    }
+
+    if (m_analysisFps > 0) {
+        int64_t nowMs = m_clock->TimeInMilliseconds();
+        if (nowMs - m_lastAnalyzedMs < 1000 / (int64_t)m_analysisFps)
+            return false;
+        m_lastAnalyzedMs = nowMs;
+        return true;
+    }
+
+    return true;
+}
+
+void FrameAnalyzer::submitToPlugin(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer)
+{
+    {
+        boost::lock_guard<boost::mutex> guard(m_execMutex);
+        if (!m_execRunning)
+            return;
+        if (m_execQueue.size() >= m_execQueueDepth) {
+            // Newest frame wins: the stalest pending frame is the least
+            // valuable one to analyze.
+            m_execQueue.pop_front();
+            if ((++m_droppedFrames % 100) == 1)
+                ELOG_WARN_T("Plugin executor queue full, dropped(%u) so far", m_droppedFrames);
+        }
+        m_execQueue.push_back(std::move(buffer));
+    }
+    m_execCond.notify_one();
+}
+
+void FrameAnalyzer::deliverToPlugin(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer)
+{
+    m_analyzedFrames++;
+
+    if (m_batchSize <= 1) {
+        plugin_->ProcessFrameAsync(std::move(buffer));
+        return;
+    }
+
+    {
+        boost::lock_guard<boost::mutex> guard(m_batchMutex);
+        if (m_pendingBatch.empty())
+            m_batchStartMs = m_clock->TimeInMilliseconds();
+        m_pendingBatch.push_back(std::move(buffer));
+    }
+    flushBatch(false);
+}
+
+void FrameAnalyzer::executorLoop()
+{
+    while (true) {
+        std::unique_ptr<owt::analytics::AnalyticsBuffer> item;
+        bool flush = false;
+
+        {
+            boost::unique_lock<boost::mutex> lock(m_execMutex);
+            while (m_execRunning && m_execQueue.empty() && !m_flushRequested)
+                m_execCond.wait(lock);
+            if (!m_execRunning && m_execQueue.empty())
+                break;
+            if (!m_execQueue.empty()) {
+                item = std::move(m_execQueue.front());
+                m_execQueue.pop_front();
+            }
+            flush = m_flushRequested;
+            m_flushRequested = false;
+        }
+
+        if (item)
+            deliverToPlugin(std::move(item));
+        if (flush)
+            flushBatch(false);
+    }
+
+    // Teardown: hand over whatever the batcher still holds.
+    flushBatch(true);
+}
+
+void FrameAnalyzer::flushBatch(bool force)
+{
+    std::vector<std::unique_ptr<owt::analytics::AnalyticsBuffer>> batch;
+
+    {
+        boost::lock_guard<boost::mutex> guard(m_batchMutex);
+        if (m_pendingBatch.empty())
+            return;
+        if (!force
+                && m_pendingBatch.size() < m_batchSize
+                && m_clock->TimeInMilliseconds() - m_batchStartMs < m_batchWindowMs)
+            return;
+        batch.swap(m_pendingBatch);
+    }
+
+    ELOG_TRACE_T("flushBatch, frames(%ld)", batch.size());
+    plugin_->ProcessFramesAsync(std::move(batch));
+}
+
+void FrameAnalyzer::addRoiConsumer(VideoFrameEncoder* encoder)
+{
+    boost::lock_guard<boost::mutex> guard(m_roiMutex);
+    m_roiConsumers.push_back(encoder);
+}
+
+void FrameAnalyzer::removeRoiConsumer(VideoFrameEncoder* encoder)
+{
+    boost::lock_guard<boost::mutex> guard(m_roiMutex);
+    m_roiConsumers.remove(encoder);
+}
+
 void FrameAnalyzer::OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffer> pluginFrame) {
     int width = pluginFrame->width;
-    int height = pluginFrame->height; 
+    int height = pluginFrame->height;
     rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(width, height);
     if (!i420Buffer) {
         ELOG_ERROR_T("No valid i420Buffer");
@@ -177,7 +432,37 @@ void FrameAnalyzer::OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffe
     memcpy(i420Buffer->MutableDataY(), pluginFrame->buffer, width * height);
     memcpy(i420Buffer->MutableDataU(), pluginFrame->buffer + width * height, width * height / 4);
     memcpy(i420Buffer->MutableDataV(), pluginFrame->buffer + width * height * 5 / 4, width * height / 4);
-    SendFrame(i420Buffer, kMsToRtpTimestamp * m_clock->TimeInMilliseconds()); 
+
+    // Hand the plugin's detections to downstream encoders as ROI hints.
+    // Forwarding only starts once the plugin has reported a region at all,
+    // so the empty lists of a plugin that never detects stay free while an
+    // empty list from a detecting plugin clears its previous hints.
+    if (pluginFrame->num_rois > 0 || m_roiSeen) {
+        m_roiSeen = true;
+
+        std::vector<RoiRegion> regions;
+        int count = std::min(pluginFrame->num_rois, (int)owt::analytics::AnalyticsBuffer::kMaxRois);
+        for (int i = 0; i < count; i++) {
+            const owt::analytics::AnalyticsBuffer::Roi& roi = pluginFrame->rois[i];
+            if (roi.width <= 0 || roi.height <= 0
+                    || roi.x < 0 || roi.y < 0
+                    || roi.x + roi.width > width || roi.y + roi.height > height)
+                continue;
+            RoiRegion region;
+            region.x = roi.x;
+            region.y = roi.y;
+            region.width = roi.width;
+            region.height = roi.height;
+            region.qpOffset = m_roiQpOffset;
+            regions.push_back(region);
+        }
+
+        boost::lock_guard<boost::mutex> guard(m_roiMutex);
+        for (auto it = m_roiConsumers.begin(); it != m_roiConsumers.end(); ++it)
+            (*it)->setRoiRegions(regions, width, height);
+    }
+
+    SendFrame(i420Buffer, kMsToRtpTimestamp * m_clock->TimeInMilliseconds());
     return;
 }
 
@@ -194,6 +479,7 @@ void FrameAnalyzer::SendFrame(rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer,
     outFrame.additionalInfo.video.width = i420Frame.width();
     outFrame.additionalInfo.video.height = i420Frame.height();
     outFrame.timeStamp = timeStamp;
+    outFrame.ingestTimeMs = m_lastIngestMs;
 
     ELOG_TRACE_T("sendI420Frame, %dx%d",
             outFrame.additionalInfo.video.width,
@@ -204,6 +490,21 @@ void FrameAnalyzer::SendFrame(rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer,
 
 void FrameAnalyzer::onTimeout()
 {
+    // Both the output pacing timer and the batch flush timer land here; a
+    // stale partial batch is flushed no matter which one fired. The flush
+    // itself runs on the executor thread so a slow plugin cannot hold up the
+    // shared timer thread.
+    if (m_batchSize > 1) {
+        {
+            boost::lock_guard<boost::mutex> guard(m_execMutex);
+            m_flushRequested = true;
+        }
+        m_execCond.notify_one();
+    }
+
+    if (!m_outFrameRate)
+        return;
+
     uint32_t timeStamp = kMsToRtpTimestamp * m_clock->TimeInMilliseconds();
 
     if (m_format == FRAME_FORMAT_I420) {
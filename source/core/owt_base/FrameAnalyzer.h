@@ -5,9 +5,12 @@
 #ifndef FrameAnalyzer_h
 #define FrameAnalyzer_h
 
+#include <deque>
+#include <list>
 #include <vector>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 #include <logger.h>
 
 #include <webrtc/api/video/video_frame.h>
@@ -16,7 +19,9 @@
 #include <JobTimer.h>
 #include "MediaFramePipeline.h"
 
-// TODO: enable MSDK for analyzer
+#ifdef ENABLE_MSDK
+#include "MsdkFrame.h"
+#endif
 
 #include "I420BufferManager.h"
 
@@ -40,9 +45,25 @@ public:
 
     void OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer);
 
+    void addRoiConsumer(VideoFrameEncoder* encoder);
+    void removeRoiConsumer(VideoFrameEncoder* encoder);
+
 protected:
     bool filterFrame(const Frame& frame);
     void SendFrame(rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer, uint32_t timeStamp);
+    // Hands the buffer to the executor thread; drops the oldest queued frame
+    // when the bounded queue is full so a slow plugin sheds analysis work
+    // instead of stalling the decode pipeline.
+    void submitToPlugin(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer);
+    // Runs on the executor thread only: batches or forwards to the plugin.
+    void deliverToPlugin(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer);
+    void executorLoop();
+    // Decimation gate ahead of plugin delivery; true when this frame is due
+    // for analysis under the configured stride or target fps.
+    bool shouldAnalyze();
+    // Hands the pending batch to the plugin once it is full or, when force is
+    // set, whenever it is non-empty (window expiry).
+    void flushBatch(bool force);
 
 private:
     uint32_t m_lastWidth;
@@ -56,6 +77,10 @@ private:
     boost::scoped_ptr<I420BufferManager> m_bufferManager;
     rtc::scoped_refptr<webrtc::I420Buffer> m_activeI420Buffer;
 
+    // Ingest stamp of the newest analyzed input; SendFrame copies it onto
+    // the output (plugin latency can skew it by the analysis depth).
+    int64_t m_lastIngestMs;
+
     boost::shared_mutex m_mutex;
 
     const webrtc::Clock *m_clock;
@@ -67,6 +92,53 @@ private:
     rva_create_t* create_plugin;
     rva_destroy_t* destroy_plugin;
     boost::scoped_ptr<JobTimer> m_jobTimer;
+
+    // Decimation: detection models rarely need the source frame rate, so the
+    // plugin can request "FrameStride" (analyze every Nth frame) or
+    // "AnalysisFps" (sample down to a target rate); "ForwardSkipped" keeps
+    // the output stream at full rate by passing skipped frames through
+    // unanalyzed. All default to off.
+    uint32_t m_frameStride;
+    uint32_t m_analysisFps;
+    bool m_forwardSkipped;
+    uint32_t m_frameCounter;
+    int64_t m_lastAnalyzedMs;
+
+    // True when the plugin declared "GpuSurfaceSupport": MSDK-decoded frames
+    // are handed over as VAAPI surface handles instead of being downloaded to
+    // system memory first.
+    bool m_gpuHandoff;
+
+    // Batched inference: sized from the plugin's "BatchSize"/"BatchWindowMs"
+    // params, 1/disabled when the plugin does not advertise batching.
+    uint32_t m_batchSize;
+    uint32_t m_batchWindowMs;
+    int64_t m_batchStartMs;
+    std::vector<std::unique_ptr<owt::analytics::AnalyticsBuffer>> m_pendingBatch;
+    boost::mutex m_batchMutex;
+    boost::scoped_ptr<JobTimer> m_batchFlushTimer;
+
+    // Encoders fed from this analyzer's output. OnPluginFrame forwards the
+    // plugin's detections to them as region-QP hints with the offset from
+    // the "RoiQpOffset" plugin param; forwarding begins with the plugin's
+    // first reported region, so non-detecting plugins cost nothing.
+    std::list<VideoFrameEncoder*> m_roiConsumers;
+    boost::mutex m_roiMutex;
+    int m_roiQpOffset;
+    bool m_roiSeen;
+
+    // All plugin calls run on this dedicated thread behind a bounded queue
+    // ("QueueDepth" plugin param, newest frame wins), so inference latency
+    // never back-pressures onFrame callers.
+    bool m_execRunning;
+    bool m_flushRequested;
+    uint32_t m_execQueueDepth;
+    uint32_t m_analyzedFrames;
+    uint32_t m_droppedFrames;
+    std::deque<std::unique_ptr<owt::analytics::AnalyticsBuffer>> m_execQueue;
+    boost::mutex m_execMutex;
+    boost::condition_variable m_execCond;
+    boost::thread m_execThread;
 };
 
 } /* namespace owt_base */
@@ -4,14 +4,330 @@
 
 #include "FrameConverter.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
 #include <libyuv/convert.h>
 #include <libyuv/planar_functions.h>
 #include <libyuv/scale.h>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace owt_base {
 
 DEFINE_LOGGER(FrameConverter, "owt.FrameConverter");
 
+namespace {
+
+// Conversions touching at least this many destination pixels are sliced
+// across the pool; smaller ones are not worth the hand-off.
+static const uint32_t kSlicedConvertPixelThreshold = 1920 * 1080;
+
+struct SliceCompletion {
+    boost::mutex mutex;
+    boost::condition_variable done;
+    size_t remaining;
+};
+
+/*
+ * Small shared pool for conversion slices, deliberately separate from
+ * EncodeThreadPool: converts run on encode workers (VCMFrameEncoder), and a
+ * blocking fork-join onto the same pool could deadlock it. Workers never
+ * block on each other, so the joining caller always makes progress.
+ */
+class ConvertSlicePool {
+public:
+    static ConvertSlicePool& instance()
+    {
+        static ConvertSlicePool pool;
+        return pool;
+    }
+
+    size_t workers() { return m_workers; }
+
+    // Runs all tasks, the first one on the calling thread, and returns when
+    // every one of them has finished.
+    void run(std::vector<boost::function<void()> >& tasks)
+    {
+        if (tasks.empty())
+            return;
+
+        if (m_workers == 0 || tasks.size() == 1) {
+            for (size_t i = 0; i < tasks.size(); i++)
+                tasks[i]();
+            return;
+        }
+
+        SliceCompletion completion;
+        completion.remaining = tasks.size();
+
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            for (size_t i = 1; i < tasks.size(); i++)
+                m_tasks.push_back(boost::bind(&ConvertSlicePool::runOne, tasks[i], &completion));
+            m_wake.notify_all();
+        }
+
+        runOne(tasks[0], &completion);
+
+        boost::mutex::scoped_lock lock(completion.mutex);
+        while (completion.remaining > 0)
+            completion.done.wait(lock);
+    }
+
+private:
+    ConvertSlicePool()
+        : m_workers(configuredWorkers())
+        , m_shutdown(false)
+    {
+        for (size_t i = 0; i < m_workers; i++)
+            m_threads.create_thread(boost::bind(&ConvertSlicePool::workLoop, this));
+    }
+
+    ~ConvertSlicePool()
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_shutdown = true;
+            m_wake.notify_all();
+        }
+        m_threads.join_all();
+    }
+
+    static size_t configuredWorkers()
+    {
+        const char* env = getenv("OWT_CONVERT_THREADS");
+        if (env) {
+            int n = atoi(env);
+            if (n < 0)
+                n = 0;
+            if (n > 16)
+                n = 16;
+            return (size_t) n;
+        }
+        unsigned cores = boost::thread::hardware_concurrency();
+        return cores >= 8 ? 2 : 0;
+    }
+
+    static void runOne(boost::function<void()>& task, SliceCompletion* completion)
+    {
+        task();
+
+        boost::mutex::scoped_lock lock(completion->mutex);
+        if (--completion->remaining == 0)
+            completion->done.notify_one();
+    }
+
+    void workLoop()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        while (!m_shutdown) {
+            if (m_tasks.empty()) {
+                m_wake.wait(lock);
+                continue;
+            }
+            boost::function<void()> task = m_tasks.front();
+            m_tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    size_t m_workers;
+    boost::thread_group m_threads;
+    boost::mutex m_mutex;
+    boost::condition_variable m_wake;
+    std::deque<boost::function<void()> > m_tasks;
+    bool m_shutdown;
+};
+
+static void copyBand(webrtc::VideoFrameBuffer* src, webrtc::I420Buffer* dst, int y0, int height)
+{
+    libyuv::I420Copy(
+            src->DataY() + y0 * src->StrideY(),            src->StrideY(),
+            src->DataU() + (y0 / 2) * src->StrideU(),      src->StrideU(),
+            src->DataV() + (y0 / 2) * src->StrideV(),      src->StrideV(),
+            dst->MutableDataY() + y0 * dst->StrideY(),     dst->StrideY(),
+            dst->MutableDataU() + (y0 / 2) * dst->StrideU(), dst->StrideU(),
+            dst->MutableDataV() + (y0 / 2) * dst->StrideV(), dst->StrideV(),
+            dst->width(), height);
+}
+
+static void scalePlaneTask(const uint8_t* src, int srcStride, int srcWidth, int srcHeight,
+    uint8_t* dst, int dstStride, int dstWidth, int dstHeight)
+{
+    libyuv::ScalePlane(src, srcStride, srcWidth, srcHeight,
+        dst, dstStride, dstWidth, dstHeight,
+        libyuv::kFilterBox);
+}
+
+#ifdef ENABLE_MSDK
+/*
+ * Per-(src,dst)-geometry scaler backend selection, calibrated against real
+ * traffic: while a geometry is undecided its conversions alternate between
+ * the VPP and the libyuv path, and once each side has enough samples the
+ * faster average wins for the rest of the process. A static config choice
+ * was frequently wrong - the VPP wins large geometries but loses small ones
+ * to surface map/unmap overhead, and the balance shifts per SKU.
+ * OWT_SCALER_BACKEND=vpp|sw skips calibration and forces one side.
+ */
+class ScalerDispatch {
+public:
+    static ScalerDispatch& instance()
+    {
+        static ScalerDispatch dispatch;
+        return dispatch;
+    }
+
+    // Whether this conversion should run on the VPP. While the geometry is
+    // undecided the answer alternates; call report() with the elapsed time
+    // so the measurement completes.
+    bool chooseVpp(uint32_t srcW, uint32_t srcH, uint32_t dstW, uint32_t dstH)
+    {
+        if (m_forced >= 0)
+            return m_forced == 1;
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        Entry& e = m_entries[key(srcW, srcH, dstW, dstH)];
+        if (e.decided)
+            return e.useVpp;
+        return e.vppSamples <= e.swSamples;
+    }
+
+    void report(uint32_t srcW, uint32_t srcH, uint32_t dstW, uint32_t dstH, bool vpp, uint64_t usecs)
+    {
+        if (m_forced >= 0)
+            return;
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        Entry& e = m_entries[key(srcW, srcH, dstW, dstH)];
+        if (e.decided)
+            return;
+
+        if (vpp) {
+            e.vppSamples++;
+            e.vppTotalUsecs += usecs;
+        } else {
+            e.swSamples++;
+            e.swTotalUsecs += usecs;
+        }
+
+        if (e.vppSamples >= kSamplesPerBackend && e.swSamples >= kSamplesPerBackend) {
+            // Compare averages without dividing.
+            e.useVpp = e.vppTotalUsecs * e.swSamples < e.swTotalUsecs * e.vppSamples;
+            e.decided = true;
+        }
+    }
+
+    // The driver declined this geometry; stop offering it to the VPP.
+    void disqualifyVpp(uint32_t srcW, uint32_t srcH, uint32_t dstW, uint32_t dstH)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        Entry& e = m_entries[key(srcW, srcH, dstW, dstH)];
+        e.decided = true;
+        e.useVpp = false;
+    }
+
+private:
+    static const uint32_t kSamplesPerBackend = 8;
+
+    struct Entry {
+        uint32_t vppSamples = 0;
+        uint32_t swSamples = 0;
+        uint64_t vppTotalUsecs = 0;
+        uint64_t swTotalUsecs = 0;
+        bool decided = false;
+        bool useVpp = false;
+    };
+
+    ScalerDispatch()
+        : m_forced(-1)
+    {
+        const char* env = getenv("OWT_SCALER_BACKEND");
+        if (env) {
+            if (!strcmp(env, "vpp"))
+                m_forced = 1;
+            else if (!strcmp(env, "sw"))
+                m_forced = 0;
+        }
+    }
+
+    static uint64_t key(uint32_t srcW, uint32_t srcH, uint32_t dstW, uint32_t dstH)
+    {
+        return ((uint64_t)srcW << 48) | ((uint64_t)srcH << 32) | ((uint64_t)dstW << 16) | dstH;
+    }
+
+    int m_forced;
+    boost::mutex m_mutex;
+    std::map<uint64_t, Entry> m_entries;
+};
+
+static uint64_t elapsedUsecs(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+#endif
+
+// Narrows one 16-bit plane to 8 bits by dropping `shift` low bits. The AVX2
+// path handles 32 pixels per iteration; the scalar tail also serves as the
+// whole-row fallback on builds without -mavx2 and is simple enough for the
+// compiler to auto-vectorize.
+static void narrowPlane(const uint16_t* src, int srcStride,
+    uint8_t* dst, int dstStride, int width, int height, int shift)
+{
+    for (int y = 0; y < height; y++) {
+        const uint16_t* s = src + y * srcStride;
+        uint8_t* d = dst + y * dstStride;
+        int x = 0;
+#ifdef __AVX2__
+        for (; x + 32 <= width; x += 32) {
+            __m256i a = _mm256_srli_epi16(_mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(s + x)), shift);
+            __m256i b = _mm256_srli_epi16(_mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(s + x + 16)), shift);
+            // packus interleaves the 128-bit lanes; restore row order.
+            __m256i packed = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(a, b), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + x), packed);
+        }
+#endif
+        for (; x < width; x++)
+            d[x] = (uint8_t)(s[x] >> shift);
+    }
+}
+
+// Splits a biplanar 16-bit chroma plane into 8-bit U and V while narrowing.
+// width/height are chroma dimensions.
+static void narrowSplitUVPlane(const uint16_t* srcUV, int srcStride,
+    uint8_t* dstU, int dstStrideU, uint8_t* dstV, int dstStrideV,
+    int width, int height, int shift)
+{
+    for (int y = 0; y < height; y++) {
+        const uint16_t* s = srcUV + y * srcStride;
+        uint8_t* du = dstU + y * dstStrideU;
+        uint8_t* dv = dstV + y * dstStrideV;
+        for (int x = 0; x < width; x++) {
+            du[x] = (uint8_t)(s[2 * x] >> shift);
+            dv[x] = (uint8_t)(s[2 * x + 1] >> shift);
+        }
+    }
+}
+
+} /* namespace */
+
 FrameConverter::FrameConverter(bool useMsdkVpp)
 {
     m_bufferManager.reset(new I420BufferManager(2));
@@ -58,10 +374,27 @@ bool FrameConverter::convert(MsdkFrame *srcMsdkFrame, webrtc::I420Buffer *dstI42
 
 bool FrameConverter::convert(MsdkFrame *srcMsdkFrame, MsdkFrame *dstMsdkFrame)
 {
-    if (m_scaler)
-        return m_scaler->convert(srcMsdkFrame, dstMsdkFrame);
-    else {
-        rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(srcMsdkFrame->getVideoWidth(), srcMsdkFrame->getVideoHeight());
+    uint32_t srcW = srcMsdkFrame->getVideoWidth();
+    uint32_t srcH = srcMsdkFrame->getVideoHeight();
+    uint32_t dstW = dstMsdkFrame->getVideoWidth();
+    uint32_t dstH = dstMsdkFrame->getVideoHeight();
+
+    ScalerDispatch& dispatch = ScalerDispatch::instance();
+
+    if (m_scaler && dispatch.chooseVpp(srcW, srcH, dstW, dstH)) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (m_scaler->convert(srcMsdkFrame, dstMsdkFrame)) {
+            dispatch.report(srcW, srcH, dstW, dstH, true, elapsedUsecs(start));
+            return true;
+        }
+        ELOG_WARN("VPP declined %ux%u -> %ux%u, falling back to sw scale", srcW, srcH, dstW, dstH);
+        dispatch.disqualifyVpp(srcW, srcH, dstW, dstH);
+    }
+
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(srcW, srcH);
         if (!i420Buffer) {
             ELOG_ERROR("No valid i420Buffer");
             return false;
@@ -77,6 +410,10 @@ bool FrameConverter::convert(MsdkFrame *srcMsdkFrame, MsdkFrame *dstMsdkFrame)
             return false;
         }
 
+        // Only a meaningful sample when a VPP exists to compete with.
+        if (m_scaler)
+            dispatch.report(srcW, srcH, dstW, dstH, false, elapsedUsecs(start));
+
         return true;
     }
 }
@@ -114,6 +451,12 @@ bool FrameConverter::convert(webrtc::VideoFrameBuffer *srcBuffer, webrtc::I420Bu
 {
     int ret;
 
+    uint32_t dstPixels = dstI420Buffer->width() * dstI420Buffer->height();
+    if (dstPixels >= kSlicedConvertPixelThreshold
+        && ConvertSlicePool::instance().workers() > 0) {
+        return convertSliced(srcBuffer, dstI420Buffer);
+    }
+
     if (srcBuffer->width() == dstI420Buffer->width() && srcBuffer->height() == dstI420Buffer->height()) {
         ret = libyuv::I420Copy(
                 srcBuffer->DataY(), srcBuffer->StrideY(),
@@ -147,4 +490,85 @@ bool FrameConverter::convert(webrtc::VideoFrameBuffer *srcBuffer, webrtc::I420Bu
     return true;
 }
 
+bool FrameConverter::convertI010ToI420(const uint16_t* srcY, int srcStrideY,
+        const uint16_t* srcU, int srcStrideU,
+        const uint16_t* srcV, int srcStrideV,
+        int width, int height, webrtc::I420Buffer *dstI420Buffer)
+{
+    if (width != dstI420Buffer->width() || height != dstI420Buffer->height()) {
+        ELOG_ERROR("convertI010ToI420 size mismatch, %dx%d -> %dx%d",
+            width, height, dstI420Buffer->width(), dstI420Buffer->height());
+        return false;
+    }
+
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+
+    narrowPlane(srcY, srcStrideY, dstI420Buffer->MutableDataY(), dstI420Buffer->StrideY(), width, height, 2);
+    narrowPlane(srcU, srcStrideU, dstI420Buffer->MutableDataU(), dstI420Buffer->StrideU(), chromaWidth, chromaHeight, 2);
+    narrowPlane(srcV, srcStrideV, dstI420Buffer->MutableDataV(), dstI420Buffer->StrideV(), chromaWidth, chromaHeight, 2);
+    return true;
+}
+
+bool FrameConverter::convertP010ToI420(const uint16_t* srcY, int srcStrideY,
+        const uint16_t* srcUV, int srcStrideUV,
+        int width, int height, webrtc::I420Buffer *dstI420Buffer)
+{
+    if (width != dstI420Buffer->width() || height != dstI420Buffer->height()) {
+        ELOG_ERROR("convertP010ToI420 size mismatch, %dx%d -> %dx%d",
+            width, height, dstI420Buffer->width(), dstI420Buffer->height());
+        return false;
+    }
+
+    narrowPlane(srcY, srcStrideY, dstI420Buffer->MutableDataY(), dstI420Buffer->StrideY(), width, height, 8);
+    narrowSplitUVPlane(srcUV, srcStrideUV,
+        dstI420Buffer->MutableDataU(), dstI420Buffer->StrideU(),
+        dstI420Buffer->MutableDataV(), dstI420Buffer->StrideV(),
+        (width + 1) / 2, (height + 1) / 2, 8);
+    return true;
+}
+
+bool FrameConverter::convertSliced(webrtc::VideoFrameBuffer *srcBuffer, webrtc::I420Buffer *dstI420Buffer)
+{
+    std::vector<boost::function<void()> > tasks;
+
+    if (srcBuffer->width() == dstI420Buffer->width() && srcBuffer->height() == dstI420Buffer->height()) {
+        // Plain copy slices into horizontal bands; band heights stay even so
+        // the chroma planes split on the same rows.
+        const int kBands = 4;
+        int height = dstI420Buffer->height();
+        int bandHeight = ((height + kBands - 1) / kBands + 1) & ~1;
+
+        for (int y0 = 0; y0 < height; y0 += bandHeight) {
+            int h = (y0 + bandHeight <= height) ? bandHeight : (height - y0);
+            tasks.push_back(boost::bind(&copyBand, srcBuffer, dstI420Buffer, y0, h));
+        }
+    } else {
+        // Scaling filters read across band edges, so a scale splits per
+        // plane instead: exactly the three ScalePlane calls I420Scale makes,
+        // run concurrently. Y dominates, so it stays on the calling thread.
+        int srcHalfWidth = (srcBuffer->width() + 1) / 2;
+        int srcHalfHeight = (srcBuffer->height() + 1) / 2;
+        int dstHalfWidth = (dstI420Buffer->width() + 1) / 2;
+        int dstHalfHeight = (dstI420Buffer->height() + 1) / 2;
+
+        tasks.push_back(boost::bind(&scalePlaneTask,
+            srcBuffer->DataY(), srcBuffer->StrideY(), srcBuffer->width(), srcBuffer->height(),
+            dstI420Buffer->MutableDataY(), dstI420Buffer->StrideY(),
+            dstI420Buffer->width(), dstI420Buffer->height()));
+        tasks.push_back(boost::bind(&scalePlaneTask,
+            srcBuffer->DataU(), srcBuffer->StrideU(), srcHalfWidth, srcHalfHeight,
+            dstI420Buffer->MutableDataU(), dstI420Buffer->StrideU(),
+            dstHalfWidth, dstHalfHeight));
+        tasks.push_back(boost::bind(&scalePlaneTask,
+            srcBuffer->DataV(), srcBuffer->StrideV(), srcHalfWidth, srcHalfHeight,
+            dstI420Buffer->MutableDataV(), dstI420Buffer->StrideV(),
+            dstHalfWidth, dstHalfHeight));
+    }
+
+    ConvertSlicePool::instance().run(tasks);
+
+    return true;
+}
+
 }//namespace owt_base
@@ -37,7 +37,23 @@ public:
 #endif
     bool convert(webrtc::VideoFrameBuffer *srcBuffer, webrtc::I420Buffer *dstI420Buffer);
 
+    // 10-to-8-bit boundary kernels for HDR sources. Strides are in 16-bit
+    // elements, not bytes; the destination must match the source size -
+    // narrow first, then scale with the regular convert(). I010 keeps the
+    // ten significant bits at the low end of each word (ffmpeg yuv420p10le),
+    // P010 keeps them MSB-aligned with interleaved chroma.
+    static bool convertI010ToI420(const uint16_t* srcY, int srcStrideY,
+            const uint16_t* srcU, int srcStrideU,
+            const uint16_t* srcV, int srcStrideV,
+            int width, int height, webrtc::I420Buffer *dstI420Buffer);
+    static bool convertP010ToI420(const uint16_t* srcY, int srcStrideY,
+            const uint16_t* srcUV, int srcStrideUV,
+            int width, int height, webrtc::I420Buffer *dstI420Buffer);
+
 protected:
+    // Large conversions split across the shared slice pool; see the pool in
+    // FrameConverter.cpp for the engagement rules.
+    bool convertSliced(webrtc::VideoFrameBuffer *srcBuffer, webrtc::I420Buffer *dstI420Buffer);
 
 private:
 #ifdef ENABLE_MSDK
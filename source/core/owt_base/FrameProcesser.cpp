@@ -17,12 +17,21 @@ FrameProcesser::FrameProcesser()
     , m_outWidth(-1)
     , m_outHeight(-1)
     , m_outFrameRate(-1)
+    , m_shedLevel(0)
+    , m_tickCount(0)
+    , m_pendingWidth(0)
+    , m_pendingHeight(0)
+    , m_pendingIngestMs(0)
+    , m_lastIngestMs(0)
     , m_clock(NULL)
 {
 }
 
 FrameProcesser::~FrameProcesser()
 {
+    if (HostLoadGovernor::enabled())
+        HostLoadGovernor::instance().removeShedder(this);
+
     if (m_outFrameRate > 0) {
         m_jobTimer->stop();
     }
@@ -72,9 +81,17 @@ bool FrameProcesser::init(FrameFormat format, const uint32_t width, const uint32
         m_jobTimer->start();
     }
 
+    if (HostLoadGovernor::enabled())
+        HostLoadGovernor::instance().addShedder(this);
+
     return true;
 }
 
+void FrameProcesser::onShedLevel(uint32_t level)
+{
+    m_shedLevel = level;
+}
+
 bool FrameProcesser::filterFrame(const Frame& frame)
 {
 #ifdef ENABLE_MSDK
@@ -161,6 +178,48 @@ void FrameProcesser::onFrame(const Frame& frame)
         }
     }
 
+    if (m_format != FRAME_FORMAT_I420
+#ifdef ENABLE_MSDK
+            && m_format != FRAME_FORMAT_MSDK
+#endif
+            ) {
+        ELOG_ERROR_T("Invalid format, input %d(%s), output %d(%s)"
+                , frame.format, getFormatStr(frame.format)
+                , m_format, getFormatStr(m_format)
+                );
+        return;
+    }
+
+    // Timer-paced operation: just park a reference to the newest source
+    // buffer (the underlying buffers are refcounted, so this is a pointer
+    // swap) and let onTimeout() convert at most once per tick. Inputs
+    // replaced before a tick fires are dropped without ever being
+    // converted, and duplicated ticks re-deliver the already-converted
+    // active buffer.
+    if (m_outFrameRate) {
+        boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+        if (frame.format == FRAME_FORMAT_I420) {
+            VideoFrame *srcFrame = (reinterpret_cast<VideoFrame *>(frame.payload));
+            m_pendingI420Source = srcFrame->video_frame_buffer();
+#ifdef ENABLE_MSDK
+            m_pendingMsdkSource.reset();
+#endif
+        }
+#ifdef ENABLE_MSDK
+        else {
+            MsdkFrameHolder *holder = (MsdkFrameHolder *)frame.payload;
+            m_pendingMsdkSource = holder->frame;
+            m_pendingI420Source = nullptr;
+        }
+#endif
+        m_pendingWidth = frame.additionalInfo.video.width;
+        m_pendingHeight = frame.additionalInfo.video.height;
+        m_pendingIngestMs = frame.ingestTimeMs;
+        return;
+    }
+
+    m_lastIngestMs = frame.ingestTimeMs;
+
     uint32_t width = (m_outWidth == 0 ? frame.additionalInfo.video.width : m_outWidth);
     uint32_t height = (m_outHeight == 0 ? frame.additionalInfo.video.height : m_outHeight);
 
@@ -189,59 +248,36 @@ void FrameProcesser::onFrame(const Frame& frame)
             }
         }
 
-        if (!m_outFrameRate) {
-            SendFrame(msdkFrame, frame.timeStamp);
-        } else {
-            boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-            m_activeMsdkFrame = msdkFrame;
-        }
-
+        SendFrame(msdkFrame, frame.timeStamp);
         return;
     }
 #endif
 
-    if (m_format == FRAME_FORMAT_I420) {
-        rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(width, height);
-        if (!i420Buffer) {
-            ELOG_ERROR_T("No valid i420Buffer");
-            return;
-        }
+    rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(width, height);
+    if (!i420Buffer) {
+        ELOG_ERROR_T("No valid i420Buffer");
+        return;
+    }
 
-        if (frame.format == FRAME_FORMAT_I420) {
-            VideoFrame *srcFrame = (reinterpret_cast<VideoFrame *>(frame.payload));
-            if (!m_converter->convert(srcFrame->video_frame_buffer().get(), i420Buffer.get())) {
-                ELOG_ERROR_T("Failed to convert frame");
-                return;
-            }
+    if (frame.format == FRAME_FORMAT_I420) {
+        VideoFrame *srcFrame = (reinterpret_cast<VideoFrame *>(frame.payload));
+        if (!m_converter->convert(srcFrame->video_frame_buffer().get(), i420Buffer.get())) {
+            ELOG_ERROR_T("Failed to convert frame");
+            return;
         }
+    }
 #ifdef ENABLE_MSDK
-        else {
-            MsdkFrameHolder *holder = (MsdkFrameHolder *)frame.payload;
-            boost::shared_ptr<MsdkFrame> srcMsdkFrame = holder->frame;
-            if (!m_converter->convert(srcMsdkFrame.get(), i420Buffer.get())) {
-                ELOG_ERROR_T("Failed to convert frame");
-                return;
-            }
+    else {
+        MsdkFrameHolder *holder = (MsdkFrameHolder *)frame.payload;
+        boost::shared_ptr<MsdkFrame> srcMsdkFrame = holder->frame;
+        if (!m_converter->convert(srcMsdkFrame.get(), i420Buffer.get())) {
+            ELOG_ERROR_T("Failed to convert frame");
+            return;
         }
+    }
 #endif
 
-        if (!m_outFrameRate) {
-            SendFrame(i420Buffer, frame.timeStamp);
-        } else {
-            boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-            m_activeI420Buffer = i420Buffer;
-        }
-
-        return;
-    } else {
-        ELOG_ERROR_T("Invalid format, input %d(%s), output %d(%s)"
-                , frame.format, getFormatStr(frame.format)
-                , m_format, getFormatStr(m_format)
-                );
-
-        return;
-    }
-    return;
+    SendFrame(i420Buffer, frame.timeStamp);
 }
 
 #ifdef ENABLE_MSDK
@@ -260,6 +296,7 @@ void FrameProcesser::SendFrame(boost::shared_ptr<owt_base::MsdkFrame> msdkFrame,
     outFrame.additionalInfo.video.width = msdkFrame->getVideoWidth();
     outFrame.additionalInfo.video.height = msdkFrame->getVideoHeight();
     outFrame.timeStamp = timeStamp;
+    outFrame.ingestTimeMs = m_lastIngestMs;
 
     ELOG_TRACE_T("sendMsdkFrame, %dx%d",
             outFrame.additionalInfo.video.width,
@@ -282,6 +319,7 @@ void FrameProcesser::SendFrame(rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer
     outFrame.additionalInfo.video.width = i420Frame.width();
     outFrame.additionalInfo.video.height = i420Frame.height();
     outFrame.timeStamp = timeStamp;
+    outFrame.ingestTimeMs = m_lastIngestMs;
 
     m_textDrawer->drawFrame(outFrame);
 
@@ -305,29 +343,84 @@ void FrameProcesser::clearText()
 
 void FrameProcesser::onTimeout()
 {
+    // Host-wide shedding: drop to 1/2, 1/3, 1/4 of the output rate.
+    if (m_shedLevel && (m_tickCount++ % (m_shedLevel + 1)) != 0)
+        return;
+
     uint32_t timeStamp = kMsToRtpTimestamp * m_clock->TimeInMilliseconds();;
 
+    // Take over the parked source, if any; the active buffer is only
+    // touched on this thread.
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> i420Source;
+#ifdef ENABLE_MSDK
+    boost::shared_ptr<owt_base::MsdkFrame> msdkSource;
+#endif
+    uint32_t width = m_outWidth;
+    uint32_t height = m_outHeight;
+    bool hasSource = false;
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+        i420Source = m_pendingI420Source;
+        m_pendingI420Source = nullptr;
+        hasSource = (i420Source != nullptr);
+#ifdef ENABLE_MSDK
+        msdkSource = m_pendingMsdkSource;
+        m_pendingMsdkSource.reset();
+        hasSource = hasSource || msdkSource;
+#endif
+        if (width == 0)
+            width = m_pendingWidth;
+        if (height == 0)
+            height = m_pendingHeight;
+        if (hasSource)
+            m_lastIngestMs = m_pendingIngestMs;
+    }
+
 #ifdef ENABLE_MSDK
     if (m_format == FRAME_FORMAT_MSDK) {
-        boost::shared_ptr<owt_base::MsdkFrame> msdkFrame;
-        {
-            boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-            msdkFrame = m_activeMsdkFrame;
+        if (hasSource) {
+            boost::shared_ptr<owt_base::MsdkFrame> msdkFrame = getMsdkFrame(width, height);
+            if (msdkFrame) {
+                bool converted = i420Source
+                    ? m_converter->convert(i420Source.get(), msdkFrame.get())
+                    : m_converter->convert(msdkSource.get(), msdkFrame.get());
+                if (converted)
+                    m_activeMsdkFrame = msdkFrame;
+                else
+                    ELOG_ERROR_T("Failed to convert frame");
+            } else {
+                ELOG_ERROR_T("No valid msdkFrame");
+            }
         }
-        if (msdkFrame)
-            SendFrame(msdkFrame, timeStamp);
+
+        if (m_activeMsdkFrame)
+            SendFrame(m_activeMsdkFrame, timeStamp);
         return;
     }
 #endif
 
     if (m_format == FRAME_FORMAT_I420) {
-        rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer;
-        {
-            boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-            i420Buffer = m_activeI420Buffer;
+        if (hasSource) {
+            rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(width, height);
+            if (i420Buffer) {
+                bool converted = false;
+                if (i420Source)
+                    converted = m_converter->convert(i420Source.get(), i420Buffer.get());
+#ifdef ENABLE_MSDK
+                else
+                    converted = m_converter->convert(msdkSource.get(), i420Buffer.get());
+#endif
+                if (converted)
+                    m_activeI420Buffer = i420Buffer;
+                else
+                    ELOG_ERROR_T("Failed to convert frame");
+            } else {
+                ELOG_ERROR_T("No valid i420Buffer");
+            }
         }
-        if (i420Buffer)
-            SendFrame(i420Buffer, timeStamp);
+
+        if (m_activeI420Buffer)
+            SendFrame(m_activeI420Buffer, timeStamp);
         return;
     }
 }
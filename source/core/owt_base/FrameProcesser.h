@@ -25,10 +25,11 @@
 
 #include "FrameConverter.h"
 #include "FFmpegDrawText.h"
+#include "HostLoadGovernor.h"
 
 namespace owt_base {
 
-class FrameProcesser : public VideoFrameProcesser, public JobTimerListener {
+class FrameProcesser : public VideoFrameProcesser, public JobTimerListener, public HostLoadShedder {
     DECLARE_LOGGER();
 
     const uint32_t kMsToRtpTimestamp = 90;
@@ -42,6 +43,9 @@ public:
 
     void onTimeout();
 
+    // Implements HostLoadShedder.
+    void onShedLevel(uint32_t level);
+
     void drawText(const std::string& textSpec);
     void clearText();
 
@@ -63,6 +67,11 @@ private:
     uint32_t m_outHeight;
     uint32_t m_outFrameRate;
 
+    // Under host-wide shedding, deliver every (level + 1)th tick; both are
+    // only touched on the shared timer thread.
+    uint32_t m_shedLevel;
+    uint32_t m_tickCount;
+
 #ifdef ENABLE_MSDK
     boost::shared_ptr<mfxFrameAllocator> m_allocator;
     std::vector<boost::shared_ptr<owt_base::MsdkFrame>> m_framePool;
@@ -72,6 +81,23 @@ private:
     boost::scoped_ptr<I420BufferManager> m_bufferManager;
     rtc::scoped_refptr<webrtc::I420Buffer> m_activeI420Buffer;
 
+    // Timer-paced operation: onFrame() only parks a reference to the newest
+    // source buffer (plus its geometry) under m_mutex; onTimeout() converts
+    // it at most once per tick and keeps the result as the active buffer
+    // for duplicated ticks. Inputs replaced between ticks are thus dropped
+    // for the cost of a pointer swap, never converted.
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> m_pendingI420Source;
+#ifdef ENABLE_MSDK
+    boost::shared_ptr<owt_base::MsdkFrame> m_pendingMsdkSource;
+#endif
+    uint32_t m_pendingWidth;
+    uint32_t m_pendingHeight;
+    int64_t m_pendingIngestMs;
+
+    // Ingest stamp of the source behind the frame being delivered; both
+    // SendFrame() variants copy it onto the output.
+    int64_t m_lastIngestMs;
+
     boost::shared_mutex m_mutex;
 
     const webrtc::Clock *m_clock;
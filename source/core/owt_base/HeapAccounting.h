@@ -0,0 +1,106 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef HeapAccounting_h
+#define HeapAccounting_h
+
+#include <atomic>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+
+namespace owt_base {
+
+// Per-subsystem allocation accounting for the long-lived buffer owners in
+// the media path. When an agent's RSS creeps up over days this attributes
+// the growth: each hooked allocator adds its live bytes under a tag, and
+// the totals ride out through the addon stats surface (see
+// InternalIn/InternalOut::getStats), so the numbers are inspectable in
+// production without a restart or special build.
+//
+// add()/sub() are single relaxed atomic ops, cheap enough for allocation
+// paths. Only allocators that own memory for meaningful lifetimes are worth
+// hooking (pools, caches, codec buffers) - transient per-call allocations
+// add noise, not attribution.
+//
+// Independent of the tag counters, jemallocProfiling() flips jemalloc's
+// prof.active when OWT_HEAP_PROF=1 and the process runs under jemalloc
+// (LD_PRELOAD or linked), resolved via dlsym so there is no build-time
+// dependency; profiles are then dumped with jemalloc's own knobs.
+class HeapAccounting {
+public:
+    enum Tag {
+        kTransport = 0, // receive buffer pools of the internal transports
+        kPayloadBuffers, // frame payload storage (PayloadBufferPool)
+        kMixer,
+        kEncoder, // encoder bitstream buffers
+        kDecoder,
+        kNumTags
+    };
+
+    static void add(Tag tag, size_t bytes)
+    {
+        counters()[tag].bytes.fetch_add(bytes, std::memory_order_relaxed);
+        counters()[tag].allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void sub(Tag tag, size_t bytes)
+    {
+        counters()[tag].bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        counters()[tag].frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::string report()
+    {
+        static const char* kTagNames[kNumTags] = {
+            "transport", "payloadBuffers", "mixer", "encoder", "decoder"
+        };
+        std::ostringstream os;
+        os << "{\"jemallocProf\":\"" << jemallocProfiling() << "\"";
+        for (int i = 0; i < kNumTags; ++i) {
+            const Counter& c = counters()[i];
+            os << ",\"" << kTagNames[i] << "\":{\"bytes\":" << c.bytes.load(std::memory_order_relaxed)
+               << ",\"allocs\":" << c.allocs.load(std::memory_order_relaxed)
+               << ",\"frees\":" << c.frees.load(std::memory_order_relaxed) << "}";
+        }
+        os << "}";
+        return os.str();
+    }
+
+    static const char* jemallocProfiling()
+    {
+        static const char* state = []() -> const char* {
+            const char* env = std::getenv("OWT_HEAP_PROF");
+            if (!env || env[0] != '1')
+                return "off";
+            typedef int (*mallctl_t)(const char*, void*, size_t*, void*, size_t);
+            mallctl_t mallctl = (mallctl_t)dlsym(RTLD_DEFAULT, "mallctl");
+            if (!mallctl)
+                return "requested-but-no-jemalloc";
+            bool active = true;
+            return mallctl("prof.active", nullptr, nullptr, &active, sizeof(active)) == 0
+                ? "active" : "requested-but-prof-disabled";
+        }();
+        return state;
+    }
+
+private:
+    struct Counter {
+        std::atomic<int64_t> bytes{0};
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> frees{0};
+    };
+
+    static Counter* counters()
+    {
+        static Counter c[kNumTags];
+        return c;
+    }
+};
+
+} /* namespace owt_base */
+
+#endif /* HeapAccounting_h */
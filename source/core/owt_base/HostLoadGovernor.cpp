@@ -0,0 +1,189 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "HostLoadGovernor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(HostLoadGovernor, "owt.HostLoadGovernor");
+
+// Pressure units per event; 100 is a fully pressed second.
+static const uint32_t kOverrunWeight = 10;
+static const uint32_t kBackpressureWeight = 20;
+
+// Fast down, slow up: step harder after a few pressed seconds, recover a
+// step only after a long quiet stretch (host pressure below half the
+// tolerance), so shed levels do not oscillate with the load they remove.
+static const uint32_t kRaiseAfterSecs = 3;
+static const uint32_t kLowerAfterSecs = 30;
+
+HostLoadGovernor& HostLoadGovernor::instance()
+{
+    static HostLoadGovernor governor;
+    return governor;
+}
+
+bool HostLoadGovernor::enabled()
+{
+    static bool enabled = []() {
+        const char* env = getenv("OWT_HOST_SHED");
+        return env && env[0] == '1';
+    }();
+    return enabled;
+}
+
+HostLoadGovernor::HostLoadGovernor()
+    : m_table(NULL)
+    , m_slot(NULL)
+    , m_overruns(0)
+    , m_backpressures(0)
+    , m_priority(50)
+    , m_level(0)
+    , m_pressedSecs(0)
+    , m_quietSecs(0)
+{
+    const char* env = getenv("OWT_SHED_PRIORITY");
+    if (env && env[0]) {
+        long priority = strtol(env, NULL, 10);
+        if (priority >= 0 && priority <= 100)
+            m_priority = (uint32_t)priority;
+    }
+
+    // A plain file under /dev/shm rather than shm_open(), so no librt
+    // dependency on older glibc; same layout discipline as the GPU session
+    // registry in MsdkBase.cpp.
+    int fd = open("/dev/shm/owt-host-load", O_CREAT | O_RDWR, 0666);
+    if (fd >= 0) {
+        if (ftruncate(fd, sizeof(Table)) == 0) {
+            void* map = mmap(NULL, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED)
+                m_table = reinterpret_cast<Table*>(map);
+        }
+        close(fd);
+    }
+
+    if (m_table) {
+        int32_t self = (int32_t)getpid();
+        for (int i = 0; i < kSlots; i++) {
+            int32_t pid = m_table->slots[i].pid;
+            if (pid > 0 && !(kill(pid, 0) != 0 && errno == ESRCH))
+                continue;
+            if (__sync_bool_compare_and_swap(&m_table->slots[i].pid, pid, self)) {
+                m_table->slots[i].pressure = 0;
+                m_slot = &m_table->slots[i];
+                break;
+            }
+        }
+        if (!m_slot)
+            ELOG_WARN("Host load table full, shedding on local pressure only");
+    } else {
+        ELOG_WARN("Cannot map host load table, shedding on local pressure only");
+    }
+
+    m_timer.reset(new JobTimer(1, this));
+}
+
+void HostLoadGovernor::reportOverrun()
+{
+    __sync_add_and_fetch(&m_overruns, 1);
+}
+
+void HostLoadGovernor::reportBackpressure()
+{
+    __sync_add_and_fetch(&m_backpressures, 1);
+}
+
+void HostLoadGovernor::addShedder(HostLoadShedder* shedder)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_shedders.insert(shedder);
+    shedder->onShedLevel(m_level);
+}
+
+void HostLoadGovernor::removeShedder(HostLoadShedder* shedder)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_shedders.erase(shedder);
+}
+
+void HostLoadGovernor::publishLocalPressure(uint32_t pressure)
+{
+    if (m_slot)
+        m_slot->pressure = (int32_t)pressure;
+}
+
+uint32_t HostLoadGovernor::hostPressure()
+{
+    if (!m_table)
+        return 0;
+
+    uint32_t worst = 0;
+    for (int i = 0; i < kSlots; i++) {
+        int32_t pid = m_table->slots[i].pid;
+        if (pid <= 0)
+            continue;
+        if (kill(pid, 0) != 0 && errno == ESRCH) {
+            // Reclaim the slot of a dead process.
+            if (__sync_bool_compare_and_swap(&m_table->slots[i].pid, pid, 0))
+                m_table->slots[i].pressure = 0;
+            continue;
+        }
+        if ((uint32_t)m_table->slots[i].pressure > worst)
+            worst = (uint32_t)m_table->slots[i].pressure;
+    }
+    return worst;
+}
+
+void HostLoadGovernor::applyLevelLocked()
+{
+    for (auto it = m_shedders.begin(); it != m_shedders.end(); ++it)
+        (*it)->onShedLevel(m_level);
+}
+
+void HostLoadGovernor::onTimeout()
+{
+    uint32_t overruns = __sync_lock_test_and_set(&m_overruns, 0);
+    uint32_t backpressures = __sync_lock_test_and_set(&m_backpressures, 0);
+
+    uint32_t local = overruns * kOverrunWeight + backpressures * kBackpressureWeight;
+    if (local > 100)
+        local = 100;
+    publishLocalPressure(local);
+
+    uint32_t host = hostPressure();
+    if (local > host)
+        host = local;
+
+    if (host > m_priority) {
+        m_quietSecs = 0;
+        if (++m_pressedSecs >= kRaiseAfterSecs && m_level < kMaxShedLevel) {
+            m_pressedSecs = 0;
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_level++;
+            ELOG_INFO("Host pressure %u over %u, shed level %u", host, m_priority, m_level);
+            applyLevelLocked();
+        }
+    } else if (host < m_priority / 2) {
+        m_pressedSecs = 0;
+        if (++m_quietSecs >= kLowerAfterSecs && m_level > 0) {
+            m_quietSecs = 0;
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_level--;
+            ELOG_INFO("Host pressure %u recovered, shed level %u", host, m_level);
+            applyLevelLocked();
+        }
+    } else {
+        m_pressedSecs = 0;
+        m_quietSecs = 0;
+    }
+}
+
+} /* namespace owt_base */
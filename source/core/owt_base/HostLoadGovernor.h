@@ -0,0 +1,107 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef HostLoadGovernor_h
+#define HostLoadGovernor_h
+
+#include <set>
+#include <stdint.h>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+
+#include <JobTimer.h>
+
+namespace owt_base {
+
+// Implemented by components that can trade quality for CPU when the host
+// saturates. Level 0 is full quality; each level up sheds harder, up to
+// HostLoadGovernor::kMaxShedLevel. Called from the shared timer thread.
+class HostLoadShedder {
+public:
+    virtual void onShedLevel(uint32_t level) = 0;
+};
+
+/**
+ * Coordinates load shedding across every media agent process on a host.
+ * Without it a saturated host degrades one subsystem at a time in whatever
+ * order the schedulers happen to pick; with it the whole host steps down in
+ * ranked, predictable increments.
+ *
+ * Each process publishes a per-second pressure score (tick and encode
+ * overruns, transport backpressure) to a pid-slotted table under /dev/shm,
+ * mirroring the GPU session registry in MsdkBase.cpp. The governor derives
+ * the host pressure from the worst live score and drives the registered
+ * shedders: output rate in FrameProcesser, compose rate in the software
+ * mixer, and rung bitrates through SceneRateGovernor.
+ *
+ * Disabled unless OWT_HOST_SHED=1. OWT_SHED_PRIORITY (0..100, default 50,
+ * from [host_shed] in agent.toml) is the host pressure this process
+ * tolerates before stepping down, so lower-priority agents shed first and
+ * recover last. Levels rise after a few seconds of sustained pressure and
+ * fall only after a long quiet stretch, matching the encoder governor's
+ * fast-down/slow-up shape.
+ */
+class HostLoadGovernor : public JobTimerListener {
+    DECLARE_LOGGER();
+
+public:
+    static const uint32_t kMaxShedLevel = 3;
+
+    static HostLoadGovernor& instance();
+    static bool enabled();
+
+    // A tick or encode ran past its interval.
+    void reportOverrun();
+    // A transport send queue stalled past its watermark.
+    void reportBackpressure();
+
+    // The current level is applied to a shedder as soon as it registers.
+    void addShedder(HostLoadShedder* shedder);
+    void removeShedder(HostLoadShedder* shedder);
+
+    uint32_t shedLevel() { return m_level; }
+
+    // Implements JobTimerListener.
+    void onTimeout();
+
+private:
+    static const int kSlots = 64;
+
+    struct Slot {
+        int32_t pid;
+        int32_t pressure;
+    };
+
+    struct Table {
+        Slot slots[kSlots];
+    };
+
+    HostLoadGovernor();
+
+    void publishLocalPressure(uint32_t pressure);
+    uint32_t hostPressure();
+    void applyLevelLocked();
+
+    Table* m_table;
+    Slot* m_slot;
+
+    // Bumped from media threads, swapped out once a second on the timer.
+    volatile uint32_t m_overruns;
+    volatile uint32_t m_backpressures;
+
+    uint32_t m_priority;
+    volatile uint32_t m_level;
+    uint32_t m_pressedSecs;
+    uint32_t m_quietSecs;
+
+    std::set<HostLoadShedder*> m_shedders;
+    boost::mutex m_mutex;
+    boost::scoped_ptr<JobTimer> m_timer;
+};
+
+} /* namespace owt_base */
+#endif /* HostLoadGovernor_h */
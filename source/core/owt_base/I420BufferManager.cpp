@@ -11,15 +11,22 @@ DEFINE_LOGGER(I420BufferManager, "owt.I420BufferManager");
 I420BufferManager::I420BufferManager(uint32_t maxFrames)
 {
     m_bufferPool.reset(new webrtc::I420BufferPool(false, maxFrames));
+
+    if (MemoryBudget::enabled())
+        MemoryBudget::instance().addTrimmer("i420Buffers", this);
 }
 
 I420BufferManager::~I420BufferManager()
 {
+    if (MemoryBudget::enabled())
+        MemoryBudget::instance().removeTrimmer(this);
+
     m_bufferPool->Release();
 }
 
 rtc::scoped_refptr<webrtc::I420Buffer> I420BufferManager::getFreeBuffer(uint32_t width, uint32_t height)
 {
+    boost::mutex::scoped_lock lock(m_poolMutex);
     rtc::scoped_refptr<webrtc::I420Buffer> buffer = m_bufferPool->CreateBuffer(width, height);
     if (!buffer.get()) {
         return NULL;
@@ -28,4 +35,16 @@ rtc::scoped_refptr<webrtc::I420Buffer> I420BufferManager::getFreeBuffer(uint32_t
     return buffer;
 }
 
+size_t I420BufferManager::onTrimMemory(uint32_t level)
+{
+    if (level < 2)
+        return 0;
+
+    boost::mutex::scoped_lock lock(m_poolMutex);
+    // Buffers still referenced by in-flight frames survive until their last
+    // reference drops; Release() only detaches them from the pool.
+    m_bufferPool->Release();
+    return 0;
+}
+
 } /* namespace owt_base */
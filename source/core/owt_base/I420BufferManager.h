@@ -9,6 +9,7 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 #include <webrtc/common_video/include/i420_buffer_pool.h>
@@ -16,9 +17,11 @@
 
 #include "logger.h"
 
+#include "MemoryBudget.h"
+
 namespace owt_base {
 
-class I420BufferManager {
+class I420BufferManager : public MemoryTrimmer {
     DECLARE_LOGGER();
 
 public:
@@ -26,8 +29,19 @@ public:
     ~I420BufferManager();
 
     rtc::scoped_refptr<webrtc::I420Buffer> getFreeBuffer(uint32_t width, uint32_t height);
+
+    // Implements MemoryTrimmer. Raw frame buffers are the biggest caches in
+    // the process but also the warmest, so only a critical-level trim
+    // releases them; the pool refills on the next frame. The underlying
+    // webrtc pool does not expose its size, so the released bytes report as
+    // 0.
+    size_t onTrimMemory(uint32_t level) override;
+
 private:
     boost::scoped_ptr<webrtc::I420BufferPool> m_bufferPool;
+    // Serializes the budget timer's Release() against the owning media
+    // thread's CreateBuffer(); uncontended outside trims.
+    boost::mutex m_poolMutex;
 };
 
 }
@@ -0,0 +1,71 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "IOServicePool.h"
+
+#include <ThreadAffinity.h>
+
+#include <boost/bind.hpp>
+#include <future>
+#include <stdlib.h>
+
+namespace owt_base {
+
+static size_t configuredThreadCount()
+{
+    const char* env = getenv("OWT_TRANSPORT_IO_THREADS");
+    if (env && env[0]) {
+        long n = strtol(env, NULL, 10);
+        if (n > 0 && n <= 64)
+            return n;
+    }
+    return 4;
+}
+
+IOServicePool& IOServicePool::instance()
+{
+    static IOServicePool pool;
+    return pool;
+}
+
+IOServicePool::IOServicePool()
+    : m_next(0)
+{
+    size_t count = configuredThreadCount();
+    for (size_t i = 0; i < count; ++i) {
+        boost::shared_ptr<boost::asio::io_service> service(new boost::asio::io_service());
+        m_services.push_back(service);
+        m_works.push_back(boost::shared_ptr<boost::asio::io_service::work>(
+            new boost::asio::io_service::work(*service)));
+        m_threads.create_thread([service]() {
+            ThreadAffinity::applyRole("transport");
+            service->run();
+        });
+    }
+}
+
+IOServicePool::~IOServicePool()
+{
+    m_works.clear();
+    for (size_t i = 0; i < m_services.size(); ++i)
+        m_services[i]->stop();
+    m_threads.join_all();
+}
+
+boost::asio::io_service& IOServicePool::get()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    boost::asio::io_service& service = *m_services[m_next];
+    m_next = (m_next + 1) % m_services.size();
+    return service;
+}
+
+void IOServicePool::drain(boost::asio::io_service& service)
+{
+    std::promise<void> done;
+    service.post([&done]() { done.set_value(); });
+    done.get_future().wait();
+}
+
+} /* namespace owt_base */
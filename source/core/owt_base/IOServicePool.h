@@ -0,0 +1,49 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef IOServicePool_h
+#define IOServicePool_h
+
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <vector>
+
+namespace owt_base {
+
+// Process-wide pool of io_service instances for the internal transports.
+//
+// An agent bridging hundreds of internal streams used to run one transport
+// thread per connection, mostly parked in epoll_wait. Instead, a fixed set of
+// io_services (one thread each, OWT_TRANSPORT_IO_THREADS, default 4) is
+// shared by all transports; each transport is assigned one io_service
+// round-robin at construction, which preserves the single-threaded execution
+// of its handlers.
+class IOServicePool {
+public:
+    static IOServicePool& instance();
+
+    // Returns the io_service for the next transport (round-robin). The
+    // reference stays valid for the process lifetime.
+    boost::asio::io_service& get();
+
+    // Runs an empty handler on `service` and waits for it. Transports use
+    // this while closing to drain their already-queued handlers, replacing
+    // the old stop()/join() of a private io_service.
+    void drain(boost::asio::io_service& service);
+
+private:
+    IOServicePool();
+    ~IOServicePool();
+
+    std::vector<boost::shared_ptr<boost::asio::io_service>> m_services;
+    std::vector<boost::shared_ptr<boost::asio::io_service::work>> m_works;
+    boost::thread_group m_threads;
+    boost::mutex m_mutex;
+    size_t m_next;
+};
+
+} /* namespace owt_base */
+
+#endif /* IOServicePool_h */
@@ -4,12 +4,32 @@
 
 #include "InternalIn.h"
 
+#include <sstream>
+#include <stdlib.h>
+
+#include "HeapAccounting.h"
+#include "InternalOut.h"
+#include "MemoryBudget.h"
+#include "PayloadBuffer.h"
+#include "PayloadBufferPool.h"
+#include "PipelineTracer.h"
+#include "UringTransport.h"
+
 namespace owt_base {
 
+static std::string shmSegmentName(unsigned int port)
+{
+    std::ostringstream name;
+    name << "/owt_internal_" << port;
+    return name.str();
+}
+
 InternalIn::InternalIn(const std::string& protocol, unsigned int minPort, unsigned int maxPort)
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
+    else if (UringTransport::enabled())
+        m_transport.reset(new owt_base::UringTransport(this));
     else
         m_transport.reset(new owt_base::RawTransport<UDP>(this, 64 * 1024));
 
@@ -18,13 +38,80 @@ InternalIn::InternalIn(const std::string& protocol, unsigned int minPort, unsign
     } else {
         m_transport->listenTo(0);
     }
+
+    // Offer the same-host shared-memory fast path in parallel; local senders
+    // detect the segment by the listening port and attach instead of
+    // connecting through loopback.
+    m_shmTransport.reset(new ShmTransport(this));
+    if (!m_shmTransport->listenTo(shmSegmentName(m_transport->getListeningPort())))
+        m_shmTransport.reset();
 }
 
 InternalIn::~InternalIn()
 {
+    if (m_shmTransport)
+        m_shmTransport->close();
     m_transport->close();
 }
 
+bool InternalIn::relayEnabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_RELAY_FASTPATH");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+void InternalIn::addAudioDestination(FrameDestination* dest)
+{
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_relayMutex);
+        InternalOut* relay = relayEnabled() ? dynamic_cast<InternalOut*>(dest) : nullptr;
+        if (relay)
+            m_audioRelay.relays.push_back(relay);
+        else
+            m_audioRelay.others++;
+    }
+    FrameSource::addAudioDestination(dest);
+}
+
+void InternalIn::removeAudioDestination(FrameDestination* dest)
+{
+    FrameSource::removeAudioDestination(dest);
+    boost::unique_lock<boost::shared_mutex> lock(m_relayMutex);
+    InternalOut* relay = relayEnabled() ? dynamic_cast<InternalOut*>(dest) : nullptr;
+    if (relay)
+        m_audioRelay.relays.remove(relay);
+    else if (m_audioRelay.others > 0)
+        m_audioRelay.others--;
+}
+
+void InternalIn::addVideoDestination(FrameDestination* dest)
+{
+    {
+        boost::unique_lock<boost::shared_mutex> lock(m_relayMutex);
+        InternalOut* relay = relayEnabled() ? dynamic_cast<InternalOut*>(dest) : nullptr;
+        if (relay)
+            m_videoRelay.relays.push_back(relay);
+        else
+            m_videoRelay.others++;
+    }
+    FrameSource::addVideoDestination(dest);
+}
+
+void InternalIn::removeVideoDestination(FrameDestination* dest)
+{
+    FrameSource::removeVideoDestination(dest);
+    boost::unique_lock<boost::shared_mutex> lock(m_relayMutex);
+    InternalOut* relay = relayEnabled() ? dynamic_cast<InternalOut*>(dest) : nullptr;
+    if (relay)
+        m_videoRelay.relays.remove(relay);
+    else if (m_videoRelay.others > 0)
+        m_videoRelay.others--;
+}
+
 unsigned int InternalIn::getListeningPort()
 {
     return m_transport->getListeningPort();
@@ -35,7 +122,21 @@ void InternalIn::onFeedback(const FeedbackMsg& msg)
     char sendBuffer[512];
     sendBuffer[0] = TDT_FEEDBACK_MSG;
     memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<FeedbackMsg*>(&msg)), sizeof(FeedbackMsg));
-    m_transport->sendData((char*)sendBuffer, sizeof(FeedbackMsg) + 1);
+    // Feedback goes back the way media comes in: over the shm reverse ring
+    // when a local sender is attached, over the socket otherwise.
+    if (m_shmTransport && m_shmTransport->hasPeer())
+        m_shmTransport->sendData((char*)sendBuffer, sizeof(FeedbackMsg) + 1);
+    else
+        m_transport->sendData((char*)sendBuffer, sizeof(FeedbackMsg) + 1);
+}
+
+std::string InternalIn::getStats()
+{
+    std::string transportStats = m_transport ? m_transport->getStats() : "{}";
+    return "{\"transport\":" + transportStats
+        + ",\"bufferPool\":" + PayloadBufferPool::report()
+        + ",\"heap\":" + HeapAccounting::report()
+        + ",\"memoryBudget\":" + MemoryBudget::report() + "}";
 }
 
 void InternalIn::onTransportData(char* buf, int len)
@@ -45,7 +146,31 @@ void InternalIn::onTransportData(char* buf, int len)
         case TDT_MEDIA_FRAME:
             frame = reinterpret_cast<Frame*>(buf + 1);
             frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
-            deliverFrame(*frame);
+            frame->buffer = nullptr; // Wire frames carry a stale producer-side pointer; payload lives in the transport buffer.
+            if (PipelineTracer::enabled())
+                PipelineTracer::instance().instant(isAudioFrame(*frame) ? "audio" : "video", "internal_recv", frame->timeStamp);
+            {
+                // Pure relay pairing: every destination on this track is an
+                // InternalOut, so the received buffer already is the exact
+                // wire image the next hop needs. Hand it over verbatim and
+                // skip the pooled-buffer re-home and re-serialization.
+                boost::shared_lock<boost::shared_mutex> relayLock(m_relayMutex);
+                RelayTrack& track = isAudioFrame(*frame) ? m_audioRelay : m_videoRelay;
+                if (!track.relays.empty() && track.others == 0) {
+                    for (std::list<InternalOut*>::iterator it = track.relays.begin(); it != track.relays.end(); ++it)
+                        (*it)->relayData(buf, len);
+                    break;
+                }
+            }
+            {
+                // Re-home the payload into a pooled refcounted buffer before
+                // fan-out: with several destinations attached (e.g. parallel
+                // RTMP pushes of one stream) each queues a reference instead
+                // of its own copy of the bitstream.
+                Frame owned = makeOwnedFrame(*frame);
+                deliverFrame(owned);
+                releaseOwnedFrame(owned);
+            }
             break;
         default:
             break;
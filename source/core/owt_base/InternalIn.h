@@ -7,16 +7,36 @@
 
 #include "MediaFramePipeline.h"
 #include "RawTransport.h"
+#include "ShmTransport.h"
 
 namespace owt_base {
 
+class InternalOut;
+
 class InternalIn : public FrameSource, public RawTransportListener {
 public:
     InternalIn(const std::string& protocol, unsigned int minPort = 0, unsigned int maxPort = 0);
     virtual ~InternalIn();
 
+    // Forward received wire buffers verbatim to destinations that are
+    // themselves InternalOuts, instead of re-homing and re-serializing
+    // every frame. Pure relay pairings (common on cascade nodes) then
+    // cost one buffer scan per hop. Enabled via OWT_RELAY_FASTPATH.
+    static bool relayEnabled();
+
+    // Shadow FrameSource to learn which destinations are relays; all of
+    // them still go through the base class for the ordinary path.
+    void addAudioDestination(FrameDestination*);
+    void removeAudioDestination(FrameDestination*);
+    void addVideoDestination(FrameDestination*);
+    void removeVideoDestination(FrameDestination*);
+
     unsigned int getListeningPort();
 
+    // Counters sampled from the underlying transport plus buffer-pool
+    // pressure, as a JSON string for the addon layer.
+    std::string getStats();
+
     // Implements FrameSource
     void onFeedback(const FeedbackMsg&);
 
@@ -27,6 +47,21 @@ public:
 
 private:
     boost::shared_ptr<owt_base::RawTransportInterface> m_transport;
+    // Same-host fast path: a shared-memory segment named after the listening
+    // port, which local senders attach to instead of going through loopback.
+    boost::shared_ptr<owt_base::ShmTransport> m_shmTransport;
+
+    // The fast path applies per track only while every destination on that
+    // track is a relay; one mixed-in consumer falls the track back to the
+    // ordinary parse/re-home delivery.
+    struct RelayTrack {
+        std::list<InternalOut*> relays;
+        uint32_t others;
+        RelayTrack() : others(0) { }
+    };
+    RelayTrack m_audioRelay;
+    RelayTrack m_videoRelay;
+    boost::shared_mutex m_relayMutex;
 };
 
 } /* namespace owt_base */
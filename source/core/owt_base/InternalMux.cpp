@@ -0,0 +1,500 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "InternalMux.h"
+
+#include "IOServicePool.h"
+
+#include <boost/bind.hpp>
+#include <netinet/in.h>
+#include <sstream>
+
+namespace owt_base {
+
+DEFINE_LOGGER(MuxServer, "owt.MuxServer");
+DEFINE_LOGGER(MuxClient, "owt.MuxClient");
+
+static const int kMuxHeaderSize = 5; // type + stream id.
+// Per-stream flow control: the receiver grants this much up front and tops
+// the window up as it delivers. Sized for a couple of seconds of HD video so
+// normal streams never block, while a stuck consumer bounds its share of the
+// shared connection.
+static const int64_t kInitialWindow = 4 * 1024 * 1024;
+static const uint32_t kCreditQuantum = 512 * 1024;
+static const uint32_t kMaxMuxRecord = 4 * 1024 * 1024;
+
+static void packMuxHeader(char* buf, uint8_t type, uint32_t streamId)
+{
+    buf[0] = (char)type;
+    uint32_t id = htonl(streamId);
+    memcpy(buf + 1, &id, sizeof(id));
+}
+
+// One accepted connection from a peer node. All socket work runs on the
+// server's io_service, which has a single thread; cross-thread sends are
+// posted onto it.
+class MuxServer::PeerConnection : public boost::enable_shared_from_this<MuxServer::PeerConnection> {
+public:
+    explicit PeerConnection(MuxServer* server)
+        : m_server(server)
+        , m_socket(server->m_ioService)
+        , m_bufferSize(64 * 1024)
+        , m_buffer(new char[m_bufferSize])
+        , m_isWriting(false)
+    {
+    }
+
+    boost::asio::ip::tcp::socket& socket() { return m_socket; }
+
+    void start()
+    {
+        boost::asio::ip::tcp::no_delay option(true);
+        boost::system::error_code ec;
+        m_socket.set_option(option, ec);
+        readHeader();
+    }
+
+    void send(const boost::shared_array<char>& data, int len)
+    {
+        boost::shared_ptr<PeerConnection> self = shared_from_this();
+        m_server->m_ioService.post([self, data, len]() {
+            self->m_writeQueue.push_back(std::make_pair(data, len));
+            if (!self->m_isWriting)
+                self->writeNext();
+        });
+    }
+
+    void close()
+    {
+        boost::system::error_code ec;
+        m_socket.close(ec);
+    }
+
+private:
+    void readHeader()
+    {
+        boost::shared_ptr<PeerConnection> self = shared_from_this();
+        boost::asio::async_read(m_socket, boost::asio::buffer(m_lengthPrefix, 4),
+            [self](const boost::system::error_code& ec, std::size_t) {
+                if (ec) {
+                    self->m_server->dropConnection(self.get());
+                    return;
+                }
+                uint32_t length = ntohl(*(reinterpret_cast<uint32_t*>(self->m_lengthPrefix)));
+                if (length < kMuxHeaderSize || length > kMaxMuxRecord) {
+                    ELOG_WARN2(logger, "corrupt mux record length %u, closing connection", length);
+                    self->m_server->dropConnection(self.get());
+                    return;
+                }
+                if (length > self->m_bufferSize) {
+                    while (self->m_bufferSize < length)
+                        self->m_bufferSize *= 2;
+                    self->m_buffer.reset(new char[self->m_bufferSize]);
+                }
+                self->readBody(length);
+            });
+    }
+
+    void readBody(uint32_t length)
+    {
+        boost::shared_ptr<PeerConnection> self = shared_from_this();
+        boost::asio::async_read(m_socket, boost::asio::buffer(m_buffer.get(), length),
+            [self, length](const boost::system::error_code& ec, std::size_t) {
+                if (ec) {
+                    self->m_server->dropConnection(self.get());
+                    return;
+                }
+                uint8_t type = (uint8_t)self->m_buffer[0];
+                uint32_t streamId = ntohl(*(reinterpret_cast<uint32_t*>(self->m_buffer.get() + 1)));
+                self->m_server->onRecord(self, type, streamId,
+                    self->m_buffer.get() + kMuxHeaderSize, length - kMuxHeaderSize);
+                self->readHeader();
+            });
+    }
+
+    void writeNext()
+    {
+        if (m_writeQueue.empty()) {
+            m_isWriting = false;
+            return;
+        }
+        m_isWriting = true;
+        std::pair<boost::shared_array<char>, int>& front = m_writeQueue.front();
+        boost::shared_ptr<PeerConnection> self = shared_from_this();
+        boost::asio::async_write(m_socket, boost::asio::buffer(front.first.get(), front.second),
+            [self](const boost::system::error_code& ec, std::size_t) {
+                if (ec) {
+                    self->m_server->dropConnection(self.get());
+                    return;
+                }
+                self->m_writeQueue.pop_front();
+                self->writeNext();
+            });
+    }
+
+    DECLARE_LOGGER();
+
+    MuxServer* m_server;
+    boost::asio::ip::tcp::socket m_socket;
+    char m_lengthPrefix[4];
+    uint32_t m_bufferSize;
+    boost::shared_array<char> m_buffer;
+    bool m_isWriting;
+    std::deque<std::pair<boost::shared_array<char>, int>> m_writeQueue;
+};
+
+DEFINE_LOGGER(MuxServer::PeerConnection, "owt.MuxServer");
+
+MuxServer& MuxServer::instance()
+{
+    static MuxServer server;
+    return server;
+}
+
+MuxServer::MuxServer()
+    : m_ioService(IOServicePool::instance().get())
+    , m_acceptor(m_ioService)
+    , m_port(0)
+    , m_nextStreamId(1)
+{
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), 0);
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen();
+    m_port = m_acceptor.local_endpoint().port();
+    acceptNext();
+    ELOG_INFO("mux server listening on port %u", m_port);
+}
+
+MuxServer::~MuxServer()
+{
+    boost::system::error_code ec;
+    m_acceptor.close(ec);
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (auto& it : m_connections)
+        it.second->close();
+    m_connections.clear();
+    m_routes.clear();
+}
+
+void MuxServer::acceptNext()
+{
+    boost::shared_ptr<PeerConnection> conn(new PeerConnection(this));
+    m_acceptor.async_accept(conn->socket(), [this, conn](const boost::system::error_code& ec) {
+        if (ec)
+            return;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_connections[conn.get()] = conn;
+        }
+        conn->start();
+        acceptNext();
+    });
+}
+
+uint32_t MuxServer::addStream(MuxStreamSink* sink)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    uint32_t id = m_nextStreamId++;
+    m_sinks[id] = sink;
+    return id;
+}
+
+void MuxServer::removeStream(uint32_t streamId)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_sinks.erase(streamId);
+        m_routes.erase(streamId);
+    }
+    // onRecord resolves the sink under m_mutex but invokes it unlocked on the
+    // io thread, so a delivery in flight right now may still hold the raw
+    // pointer. Rendezvous with the io thread (the service is single-threaded,
+    // so the posted drain marker runs only after any current handler has
+    // finished) before returning: callers destroy the sink the moment we
+    // return, as ~InternalMuxIn does.
+    IOServicePool::instance().drain(m_ioService);
+}
+
+void MuxServer::sendToStreamPeer(uint32_t streamId, uint8_t type, const char* payload, int len)
+{
+    boost::shared_ptr<PeerConnection> conn;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_routes.find(streamId);
+        if (it == m_routes.end())
+            return;
+        conn = it->second;
+    }
+
+    int total = 4 + kMuxHeaderSize + len;
+    boost::shared_array<char> buffer(new char[total]);
+    *(reinterpret_cast<uint32_t*>(buffer.get())) = htonl(kMuxHeaderSize + len);
+    packMuxHeader(buffer.get() + 4, type, streamId);
+    if (len > 0)
+        memcpy(buffer.get() + 4 + kMuxHeaderSize, payload, len);
+    conn->send(buffer, total);
+}
+
+void MuxServer::onRecord(const boost::shared_ptr<PeerConnection>& from, uint8_t type, uint32_t streamId, char* payload, int len)
+{
+    MuxStreamSink* sink = nullptr;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        switch (type) {
+        case MUX_OPEN:
+            if (m_sinks.find(streamId) == m_sinks.end()) {
+                ELOG_WARN("peer opened unknown stream %u", streamId);
+                return;
+            }
+            m_routes[streamId] = from;
+            return;
+        case MUX_CLOSE:
+            m_routes.erase(streamId);
+            return;
+        case MUX_DATA: {
+            auto it = m_sinks.find(streamId);
+            if (it != m_sinks.end())
+                sink = it->second;
+            break;
+        }
+        default:
+            ELOG_DEBUG("unexpected mux record type %u", type);
+            return;
+        }
+    }
+    if (sink)
+        sink->onMuxRecord(payload, len);
+}
+
+void MuxServer::dropConnection(PeerConnection* conn)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (auto it = m_routes.begin(); it != m_routes.end();) {
+        if (it->second.get() == conn)
+            it = m_routes.erase(it);
+        else
+            ++it;
+    }
+    m_connections.erase(conn);
+}
+
+boost::mutex MuxClient::s_registryMutex;
+std::map<std::string, boost::weak_ptr<MuxClient>> MuxClient::s_registry;
+
+boost::shared_ptr<MuxClient> MuxClient::get(const std::string& ip, unsigned int port)
+{
+    std::ostringstream key;
+    key << ip << ":" << port;
+
+    boost::mutex::scoped_lock lock(s_registryMutex);
+    auto it = s_registry.find(key.str());
+    if (it != s_registry.end()) {
+        boost::shared_ptr<MuxClient> existing = it->second.lock();
+        if (existing)
+            return existing;
+    }
+    boost::shared_ptr<MuxClient> client(new MuxClient(ip, port));
+    s_registry[key.str()] = client;
+    return client;
+}
+
+MuxClient::MuxClient(const std::string& ip, unsigned int port)
+    : m_connected(false)
+{
+    m_transport.reset(new RawTransport<TCP>(this));
+    m_transport->createConnection(ip, port);
+}
+
+MuxClient::~MuxClient()
+{
+    m_transport->close();
+}
+
+void MuxClient::openStream(uint32_t streamId, MuxStreamSink* sink)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    StreamState state = { sink, kInitialWindow };
+    m_streams[streamId] = state;
+    if (m_connected) {
+        lock.unlock();
+        sendControl(MUX_OPEN, streamId);
+    } else {
+        m_pendingOpens.push_back(streamId);
+    }
+}
+
+void MuxClient::closeStream(uint32_t streamId)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_streams.erase(streamId);
+    }
+    if (m_connected)
+        sendControl(MUX_CLOSE, streamId);
+}
+
+bool MuxClient::consumeCredit(uint32_t streamId, uint32_t bytes)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end())
+        return false;
+    if (it->second.window < (int64_t)bytes)
+        return false;
+    it->second.window -= bytes;
+    return true;
+}
+
+void MuxClient::sendControl(uint8_t type, uint32_t streamId)
+{
+    char header[kMuxHeaderSize];
+    packMuxHeader(header, type, streamId);
+    m_transport->sendData(header, kMuxHeaderSize, nullptr, 0);
+}
+
+void MuxClient::sendFrame(uint32_t streamId, const char* tdtHeader, int headerLength, const Frame& frame)
+{
+    if (!m_connected)
+        return;
+    if (!consumeCredit(streamId, headerLength + frame.length)) {
+        // Out of credit: the consumer on the other node is not draining this
+        // stream; shed here instead of clogging the shared connection.
+        ELOG_DEBUG("stream %u out of credit, frame dropped", streamId);
+        return;
+    }
+
+    char header[kMuxHeaderSize + sizeof(Frame) + 1];
+    packMuxHeader(header, MUX_DATA, streamId);
+    memcpy(header + kMuxHeaderSize, tdtHeader, headerLength);
+    m_transport->sendFrame(header, kMuxHeaderSize + headerLength, frame);
+}
+
+void MuxClient::onTransportData(char* buf, int len)
+{
+    if (len < kMuxHeaderSize)
+        return;
+
+    uint8_t type = (uint8_t)buf[0];
+    uint32_t streamId = ntohl(*(reinterpret_cast<uint32_t*>(buf + 1)));
+
+    if (type == MUX_CREDIT && len >= kMuxHeaderSize + 4) {
+        uint32_t grant = ntohl(*(reinterpret_cast<uint32_t*>(buf + kMuxHeaderSize)));
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_streams.find(streamId);
+        if (it != m_streams.end())
+            it->second.window += grant;
+        return;
+    }
+
+    if (type == MUX_DATA) {
+        MuxStreamSink* sink = nullptr;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            auto it = m_streams.find(streamId);
+            if (it != m_streams.end())
+                sink = it->second.sink;
+        }
+        if (sink)
+            sink->onMuxRecord(buf + kMuxHeaderSize, len - kMuxHeaderSize);
+    }
+}
+
+void MuxClient::onTransportError()
+{
+    ELOG_WARN("mux connection error");
+    m_connected = false;
+}
+
+void MuxClient::onTransportConnected()
+{
+    m_connected = true;
+    std::deque<uint32_t> pending;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        pending.swap(m_pendingOpens);
+    }
+    for (uint32_t streamId : pending)
+        sendControl(MUX_OPEN, streamId);
+}
+
+InternalMuxIn::InternalMuxIn()
+    : m_bytesSinceCredit(0)
+{
+    m_streamId = MuxServer::instance().addStream(this);
+}
+
+InternalMuxIn::~InternalMuxIn()
+{
+    MuxServer::instance().removeStream(m_streamId);
+}
+
+void InternalMuxIn::onFeedback(const FeedbackMsg& msg)
+{
+    char sendBuffer[512];
+    sendBuffer[0] = TDT_FEEDBACK_MSG;
+    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<FeedbackMsg*>(&msg)), sizeof(FeedbackMsg));
+    MuxServer::instance().sendToStreamPeer(m_streamId, MUX_DATA, sendBuffer, sizeof(FeedbackMsg) + 1);
+}
+
+void InternalMuxIn::onMuxRecord(char* buf, int len)
+{
+    Frame* frame = nullptr;
+    switch (buf[0]) {
+        case TDT_MEDIA_FRAME:
+            frame = reinterpret_cast<Frame*>(buf + 1);
+            frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
+            frame->buffer = nullptr; // Wire frames carry a stale producer-side pointer.
+            deliverFrame(*frame);
+            break;
+        default:
+            break;
+    }
+
+    // Replenish the sender's window for what was just delivered.
+    m_bytesSinceCredit += len;
+    if (m_bytesSinceCredit >= kCreditQuantum) {
+        uint32_t grant = htonl(m_bytesSinceCredit);
+        MuxServer::instance().sendToStreamPeer(m_streamId, MUX_CREDIT,
+            reinterpret_cast<char*>(&grant), sizeof(grant));
+        m_bytesSinceCredit = 0;
+    }
+}
+
+InternalMuxOut::InternalMuxOut(const std::string& dest_ip, unsigned int dest_port, uint32_t streamId)
+    : m_streamId(streamId)
+{
+    m_client = MuxClient::get(dest_ip, dest_port);
+    m_client->openStream(m_streamId, this);
+}
+
+InternalMuxOut::~InternalMuxOut()
+{
+    m_client->closeStream(m_streamId);
+}
+
+void InternalMuxOut::onFrame(const Frame& frame)
+{
+    char sendBuffer[sizeof(Frame) + 1];
+    size_t header_len = sizeof(Frame);
+
+    sendBuffer[0] = TDT_MEDIA_FRAME;
+    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
+    m_client->sendFrame(m_streamId, sendBuffer, header_len + 1, frame);
+}
+
+void InternalMuxOut::onMuxRecord(char* buf, int len)
+{
+    switch (buf[0]) {
+        case TDT_FEEDBACK_MSG:
+            if (len >= (int)(sizeof(FeedbackMsg) + 1))
+                deliverFeedbackMsg(*(reinterpret_cast<FeedbackMsg*>(buf + 1)));
+            break;
+        default:
+            break;
+    }
+}
+
+} /* namespace owt_base */
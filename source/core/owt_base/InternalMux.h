@@ -0,0 +1,175 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef InternalMux_h
+#define InternalMux_h
+
+#include <boost/asio.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <deque>
+#include <logger.h>
+#include <map>
+#include <string>
+
+#include "MediaFramePipeline.h"
+#include "RawTransport.h"
+
+namespace owt_base {
+
+// Multiplexed internal connections.
+//
+// A cascade between two nodes used to hold one TCP connection per internal
+// stream, so 200 spread streams meant 200 sockets each ramping through slow
+// start. The mux layer frames all logical streams between a node pair over
+// one connection: each process runs one MuxServer on a single port, and the
+// sending side keeps one MuxClient per destination node.
+//
+// On the wire every record (inside the usual 4-byte length framing) is
+// [1-byte type][4-byte stream id][payload]; DATA payloads are the same TDT
+// records the per-stream transports exchange. Streams are flow controlled
+// with byte credits so one congested consumer cannot fill the shared
+// connection: the receiver grants an initial window and replenishes it as it
+// delivers, and the sender drops frames for streams that are out of credit.
+
+static const uint8_t MUX_DATA = 0x01;
+static const uint8_t MUX_OPEN = 0x02;
+static const uint8_t MUX_CLOSE = 0x03;
+static const uint8_t MUX_CREDIT = 0x04;
+
+// Demuxed record consumer; implemented by the per-stream endpoints.
+class MuxStreamSink {
+public:
+    virtual ~MuxStreamSink() { }
+    virtual void onMuxRecord(char* data, int len) = 0;
+};
+
+// Accepts connections from every peer node and routes records between
+// registered streams and the connection their sender lives on.
+class MuxServer {
+    DECLARE_LOGGER();
+
+public:
+    static MuxServer& instance();
+
+    unsigned short getListeningPort() { return m_port; }
+
+    // Registers a receiving stream and returns its id; the id travels to the
+    // sending node through the regular connection signaling.
+    uint32_t addStream(MuxStreamSink* sink);
+    void removeStream(uint32_t streamId);
+
+    // Sends a record (feedback or credit) back over the connection the
+    // stream's sender opened it on. Dropped if the sender has not opened the
+    // stream yet.
+    void sendToStreamPeer(uint32_t streamId, uint8_t type, const char* payload, int len);
+
+private:
+    class PeerConnection;
+    friend class PeerConnection;
+
+    MuxServer();
+    ~MuxServer();
+
+    void acceptNext();
+    void onRecord(const boost::shared_ptr<PeerConnection>& from, uint8_t type, uint32_t streamId, char* payload, int len);
+    void dropConnection(PeerConnection* conn);
+
+    boost::asio::io_service& m_ioService;
+    boost::asio::ip::tcp::acceptor m_acceptor;
+    unsigned short m_port;
+
+    boost::mutex m_mutex;
+    uint32_t m_nextStreamId;
+    std::map<uint32_t, MuxStreamSink*> m_sinks;
+    std::map<uint32_t, boost::shared_ptr<PeerConnection>> m_routes;
+    std::map<PeerConnection*, boost::shared_ptr<PeerConnection>> m_connections;
+};
+
+// One shared connection to a destination node, multiplexing every outgoing
+// stream headed there. Instances are shared through a registry keyed by
+// "ip:port" and go away with their last stream.
+class MuxClient : public RawTransportListener, public boost::enable_shared_from_this<MuxClient> {
+    DECLARE_LOGGER();
+
+public:
+    static boost::shared_ptr<MuxClient> get(const std::string& ip, unsigned int port);
+    ~MuxClient();
+
+    void openStream(uint32_t streamId, MuxStreamSink* sink);
+    void closeStream(uint32_t streamId);
+
+    // Vectored send of a framed media frame on a stream; silently drops when
+    // the stream is out of credit or the connection is not up yet.
+    void sendFrame(uint32_t streamId, const char* tdtHeader, int headerLength, const Frame& frame);
+
+    // Implements RawTransportListener.
+    void onTransportData(char* buf, int len);
+    void onTransportError();
+    void onTransportConnected();
+
+private:
+    MuxClient(const std::string& ip, unsigned int port);
+
+    bool consumeCredit(uint32_t streamId, uint32_t bytes);
+    void sendControl(uint8_t type, uint32_t streamId);
+
+    boost::shared_ptr<RawTransportInterface> m_transport;
+    std::atomic<bool> m_connected;
+
+    struct StreamState {
+        MuxStreamSink* sink;
+        int64_t window;
+    };
+    boost::mutex m_mutex;
+    std::map<uint32_t, StreamState> m_streams;
+    std::deque<uint32_t> m_pendingOpens; // Queued until the connection is up.
+
+    static boost::mutex s_registryMutex;
+    static std::map<std::string, boost::weak_ptr<MuxClient>> s_registry;
+};
+
+// Receiving end of one logical stream; the mux-protocol counterpart of
+// InternalIn.
+class InternalMuxIn : public FrameSource, public MuxStreamSink {
+public:
+    InternalMuxIn();
+    virtual ~InternalMuxIn();
+
+    unsigned int getListeningPort() { return MuxServer::instance().getListeningPort(); }
+    uint32_t getStreamId() { return m_streamId; }
+
+    // Implements FrameSource.
+    void onFeedback(const FeedbackMsg&);
+
+    // Implements MuxStreamSink.
+    void onMuxRecord(char* data, int len);
+
+private:
+    uint32_t m_streamId;
+    uint32_t m_bytesSinceCredit;
+};
+
+// Sending end of one logical stream; the mux-protocol counterpart of
+// InternalOut.
+class InternalMuxOut : public FrameDestination, public MuxStreamSink {
+public:
+    InternalMuxOut(const std::string& dest_ip, unsigned int dest_port, uint32_t streamId);
+    virtual ~InternalMuxOut();
+
+    // Implements FrameDestination.
+    void onFrame(const Frame&);
+
+    // Implements MuxStreamSink.
+    void onMuxRecord(char* data, int len);
+
+private:
+    boost::shared_ptr<MuxClient> m_client;
+    uint32_t m_streamId;
+};
+
+} /* namespace owt_base */
+
+#endif /* InternalMux_h */
@@ -4,31 +4,87 @@
 
 #include "InternalOut.h"
 
+#include <sstream>
+
+#include "HeapAccounting.h"
+#include "MemoryBudget.h"
+#include "PayloadBufferPool.h"
+#include "PipelineTracer.h"
+#include "UringTransport.h"
+
 namespace owt_base {
 
+static std::string shmSegmentName(unsigned int port)
+{
+    std::ostringstream name;
+    name << "/owt_internal_" << port;
+    return name.str();
+}
+
 InternalOut::InternalOut(const std::string& protocol, const std::string& dest_ip, unsigned int dest_port)
 {
-    if (protocol == "tcp")
-        m_transport.reset(new owt_base::RawTransport<TCP>(this));
-    else
-        m_transport.reset(new owt_base::RawTransport<UDP>(this));
+    if (protocol == "shm") {
+        // Negotiated by the connection factory for same-host connections;
+        // fall back to TCP if the receiver offers no segment (e.g. it is an
+        // older node).
+        m_shmTransport.reset(new ShmTransport(this));
+        if (!m_shmTransport->connectTo(shmSegmentName(dest_port)))
+            m_shmTransport.reset();
+    }
 
-    m_transport->createConnection(dest_ip, dest_port);
+    if (!m_shmTransport) {
+        if (protocol == "udp" && UringTransport::enabled())
+            m_transport.reset(new owt_base::UringTransport(this));
+        else if (protocol == "udp")
+            m_transport.reset(new owt_base::RawTransport<UDP>(this));
+        else
+            m_transport.reset(new owt_base::RawTransport<TCP>(this));
+
+        m_transport->createConnection(dest_ip, dest_port);
+    }
 }
 
 InternalOut::~InternalOut()
 {
-    m_transport->close();
+    if (m_shmTransport)
+        m_shmTransport->close();
+    if (m_transport)
+        m_transport->close();
 }
 
 void InternalOut::onFrame(const Frame& frame)
 {
+    // The matching "internal_recv" in InternalIn carries the same RTP
+    // timestamp; traces from both processes line up on it.
+    if (PipelineTracer::enabled())
+        PipelineTracer::instance().instant(isAudioFrame(frame) ? "audio" : "video", "internal_send", frame.timeStamp);
+
     char sendBuffer[sizeof(Frame) + 1];
     size_t header_len = sizeof(Frame);
 
     sendBuffer[0] = TDT_MEDIA_FRAME;
     memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
-    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length);
+    if (m_shmTransport)
+        m_shmTransport->sendData(sendBuffer, header_len + 1, reinterpret_cast<const char*>(frame.payload), frame.length);
+    else
+        m_transport->sendFrame(sendBuffer, header_len + 1, frame);
+}
+
+void InternalOut::relayData(char* buf, int len)
+{
+    if (m_shmTransport)
+        m_shmTransport->sendData(buf, len);
+    else
+        m_transport->sendData(buf, len);
+}
+
+std::string InternalOut::getStats()
+{
+    std::string transportStats = m_transport ? m_transport->getStats() : "{}";
+    return "{\"transport\":" + transportStats
+        + ",\"bufferPool\":" + PayloadBufferPool::report()
+        + ",\"heap\":" + HeapAccounting::report()
+        + ",\"memoryBudget\":" + MemoryBudget::report() + "}";
 }
 
 void InternalOut::onTransportData(char* buf, int len)
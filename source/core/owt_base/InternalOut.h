@@ -7,6 +7,7 @@
 
 #include "MediaFramePipeline.h"
 #include "RawTransport.h"
+#include "ShmTransport.h"
 
 namespace owt_base {
 
@@ -15,14 +16,22 @@ public:
     InternalOut(const std::string& protocol, const std::string& dest_ip, unsigned int dest_port);
     virtual ~InternalOut();
 
+    std::string getStats();
+
     void onFrame(const Frame&);
 
+    // Relay fast path (see InternalIn::relayEnabled()): sends an
+    // already-framed wire buffer exactly as received from the previous
+    // hop, bypassing the onFrame() serialization.
+    void relayData(char* buf, int len);
+
     void onTransportData(char*, int len);
     void onTransportError() { }
     void onTransportConnected() { }
 
 private:
     boost::shared_ptr<owt_base::RawTransportInterface> m_transport;
+    boost::shared_ptr<owt_base::ShmTransport> m_shmTransport;
 };
 
 } /* namespace owt_base */
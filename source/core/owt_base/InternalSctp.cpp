@@ -4,6 +4,8 @@
 
 #include "InternalSctp.h"
 
+#include "PayloadBufferPool.h"
+
 namespace owt_base {
 
 InternalSctp::InternalSctp()
@@ -29,7 +31,7 @@ void InternalSctp::onFrame(const Frame& frame)
 
     sendBuffer[0] = TDT_MEDIA_FRAME;
     memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
-    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length);
+    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length, laneForFrame(frame));
 }
 
 void InternalSctp::onFeedback(const FeedbackMsg& msg)
@@ -40,6 +42,12 @@ void InternalSctp::onFeedback(const FeedbackMsg& msg)
     m_transport->sendData((char*)sendBuffer, sizeof(FeedbackMsg) + 1);
 }
 
+std::string InternalSctp::getStats()
+{
+    return "{\"transport\":" + m_transport->getStats()
+        + ",\"bufferPool\":" + PayloadBufferPool::report() + "}";
+}
+
 void InternalSctp::onTransportData(char* buf, int len)
 {
     Frame* frame = nullptr;
@@ -47,6 +55,7 @@ void InternalSctp::onTransportData(char* buf, int len)
         case TDT_MEDIA_FRAME:
             frame = reinterpret_cast<Frame*>(buf + 1);
             frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
+            frame->buffer = nullptr; // Wire frames carry a stale producer-side pointer; payload lives in the transport buffer.
             deliverFrame(*frame);
             break;
         case TDT_FEEDBACK_MSG:
@@ -18,6 +18,7 @@ public:
 
     unsigned int getLocalUdpPort() { return m_transport->getLocalUdpPort(); }
     unsigned int getLocalSctpPort() { return m_transport->getLocalSctpPort(); }
+    std::string getStats();
 
     void connect(const std::string &ip, unsigned int udpPort, unsigned int sctpPort);
 
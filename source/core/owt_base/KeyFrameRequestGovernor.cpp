@@ -0,0 +1,99 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "KeyFrameRequestGovernor.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(KeyFrameRequestGovernor, "owt.KeyFrameRequestGovernor");
+
+static uint32_t envMs(const char* name, uint32_t defaultMs, uint32_t maxMs)
+{
+    const char* env = getenv(name);
+    if (!env)
+        return defaultMs;
+
+    long value = atol(env);
+    if (value < 0)
+        value = 0;
+    if (value > (long)maxMs)
+        value = maxMs;
+    return (uint32_t)value;
+}
+
+KeyFrameRequestGovernor::KeyFrameRequestGovernor()
+    : m_windowMs(envMs("OWT_KEYFRAME_COALESCE_MS", 1000, 30000))
+    , m_minIntervalMs(envMs("OWT_KEYFRAME_MIN_INTERVAL_MS", 0, 30000))
+    , m_windowRequests(0)
+    , m_windowStartMs(nowMs())
+    , m_lastForwardMs(0)
+    , m_totalRequests(0)
+    , m_forwardedRequests(0)
+{
+}
+
+uint64_t KeyFrameRequestGovernor::nowMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+bool KeyFrameRequestGovernor::onRequest()
+{
+    uint64_t now = nowMs();
+
+    m_totalRequests.fetch_add(1, std::memory_order_relaxed);
+
+    // The first request in a window goes through right away so a fresh
+    // subscriber is not kept waiting; the rest ride on that key frame.
+    if (m_windowRequests.fetch_add(1, std::memory_order_relaxed) == 0
+        && now - m_lastForwardMs >= m_minIntervalMs) {
+        m_lastForwardMs = now;
+        m_forwardedRequests.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+bool KeyFrameRequestGovernor::onTick()
+{
+    uint64_t now = nowMs();
+
+    if (now - m_windowStartMs < m_windowMs)
+        return false;
+
+    uint32_t windowRequests = m_windowRequests.exchange(0, std::memory_order_relaxed);
+    uint64_t windowStartMs = m_windowStartMs;
+    m_windowStartMs = now;
+
+    // A lone request can also be left over when the rate floor blocked the
+    // immediate forward; it must not be dropped on the floor.
+    bool pendingUnserved = windowRequests > 1
+        || (windowRequests == 1 && m_lastForwardMs < windowStartMs);
+
+    if (windowRequests > 1) {
+        ELOG_DEBUG("Coalesced %u key frame requests in the last window"
+            ", forwarded %zu of %zu since start",
+            windowRequests - 1,
+            (size_t)m_forwardedRequests.load(std::memory_order_relaxed),
+            (size_t)m_totalRequests.load(std::memory_order_relaxed));
+    }
+
+    // One follow-up per window covers requests that raced in after the
+    // immediate forward, still honoring the per-stream rate floor.
+    if (pendingUnserved && now - m_lastForwardMs >= m_minIntervalMs) {
+        m_lastForwardMs = now;
+        m_forwardedRequests.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,59 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef KeyFrameRequestGovernor_h
+#define KeyFrameRequestGovernor_h
+
+#include <atomic>
+#include <stdint.h>
+
+#include <logger.h>
+
+namespace owt_base {
+
+/**
+ * Coalesces and rate-limits downstream key frame requests before they reach
+ * the encoder or publisher. The owner keeps its existing 1Hz feedback timer
+ * and asks the governor on every request and every tick whether one should
+ * actually go upstream; everything else is counted as suppressed.
+ *
+ * Defaults reproduce the historical behavior (forward the first request
+ * immediately, at most one coalesced follow-up per one-second window).
+ * OWT_KEYFRAME_COALESCE_MS adjusts the window and
+ * OWT_KEYFRAME_MIN_INTERVAL_MS enforces a floor between forwarded requests.
+ */
+class KeyFrameRequestGovernor {
+    DECLARE_LOGGER();
+
+public:
+    KeyFrameRequestGovernor();
+
+    // Called for every downstream request; returns true when the caller
+    // should forward one upstream now.
+    bool onRequest();
+
+    // Called from the owner's feedback timer; returns true when a coalesced
+    // follow-up request should be forwarded for the window just closed.
+    bool onTick();
+
+    uint64_t forwardedRequests() const { return m_forwardedRequests; }
+    uint64_t suppressedRequests() const { return m_totalRequests - m_forwardedRequests; }
+
+private:
+    static uint64_t nowMs();
+
+    uint32_t m_windowMs;
+    uint32_t m_minIntervalMs;
+
+    std::atomic<uint32_t> m_windowRequests;
+    uint64_t m_windowStartMs;
+    uint64_t m_lastForwardMs;
+
+    std::atomic<uint64_t> m_totalRequests;
+    std::atomic<uint64_t> m_forwardedRequests;
+};
+
+} /* namespace owt_base */
+
+#endif /* KeyFrameRequestGovernor_h */
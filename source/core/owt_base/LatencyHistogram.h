@@ -0,0 +1,89 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LatencyHistogram_h
+#define LatencyHistogram_h
+
+#include <atomic>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+
+namespace owt_base {
+
+// Fixed-bucket, lock-free latency histogram for the media pipeline hot path.
+// record() is two relaxed atomic adds; readers assemble a consistent-enough
+// snapshot without stopping writers. Bucket bounds are chosen around the
+// 150ms glass-to-glass budget.
+class LatencyHistogram {
+public:
+    static const uint32_t kNumBuckets = 10;
+
+    LatencyHistogram()
+        : m_count(0)
+        , m_totalUs(0)
+    {
+        for (uint32_t i = 0; i < kNumBuckets; ++i)
+            m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t micros)
+    {
+        m_buckets[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_totalUs.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    uint64_t averageUs() const
+    {
+        uint64_t n = m_count.load(std::memory_order_relaxed);
+        return n ? m_totalUs.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    // JSON-ish dump suitable for forwarding through the addon stats surface.
+    std::string report() const
+    {
+        static const char* kLabels[kNumBuckets] = {
+            "<1ms", "<2ms", "<5ms", "<10ms", "<20ms",
+            "<50ms", "<100ms", "<150ms", "<300ms", ">=300ms"
+        };
+        std::ostringstream os;
+        os << "{\"count\":" << count() << ",\"avgUs\":" << averageUs();
+        for (uint32_t i = 0; i < kNumBuckets; ++i)
+            os << ",\"" << kLabels[i] << "\":" << m_buckets[i].load(std::memory_order_relaxed);
+        os << "}";
+        return os.str();
+    }
+
+    static uint64_t nowUs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    }
+
+private:
+    static uint32_t bucketFor(uint64_t micros)
+    {
+        static const uint64_t kBoundsUs[kNumBuckets - 1] = {
+            1000, 2000, 5000, 10000, 20000, 50000, 100000, 150000, 300000
+        };
+        for (uint32_t i = 0; i < kNumBuckets - 1; ++i) {
+            if (micros < kBoundsUs[i])
+                return i;
+        }
+        return kNumBuckets - 1;
+    }
+
+    std::atomic<uint64_t> m_buckets[kNumBuckets];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_totalUs;
+};
+
+} /* namespace owt_base */
+
+#endif /* LatencyHistogram_h */
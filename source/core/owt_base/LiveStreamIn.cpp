@@ -5,11 +5,17 @@
 #include "LiveStreamIn.h"
 
 #include <cstdio>
+#include <fcntl.h>
 #include <rtputils.h>
 #include <sstream>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <unistd.h>
 #include <memory>
 
+#include "IOServicePool.h"
 #include "MediaUtilities.h"
 
 static inline int64_t timeRescale(uint32_t time, AVRational in, AVRational out)
@@ -164,6 +170,7 @@ JitterBuffer::JitterBuffer(std::string name, SyncMode syncMode, JitterBufferList
     , m_lastInterval(5)
     , m_isFirstFramePacket(true)
     , m_listener(listener)
+    , m_ioService(IOServicePool::instance().get())
     , m_syncTimestamp(AV_NOPTS_VALUE)
     , m_firstTimestamp(AV_NOPTS_VALUE)
     , m_maxBufferingMs(maxBufferingMs)
@@ -183,7 +190,6 @@ void JitterBuffer::start(uint32_t delay)
         m_timer.reset(new boost::asio::deadline_timer(m_ioService));
         m_timer->expires_from_now(boost::posix_time::milliseconds(delay));
         m_timer->async_wait(boost::bind(&JitterBuffer::onTimeout, this, boost::asio::placeholders::error));
-        m_timingThread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService)));
         m_isRunning = true;
     }
 }
@@ -193,12 +199,15 @@ void JitterBuffer::stop()
     if (m_isRunning) {
         ELOG_DEBUG_T("(%s)stop", m_name.c_str());
 
-        m_timer->cancel();
-
+        // Two drain passes make the shared service safe to leave: the
+        // first lets any in-flight handleJob finish (it will not re-arm
+        // once m_isClosing is set), the second flushes the aborted-wait
+        // callback from the cancel so nothing still references us.
         m_isClosing = true;
-        m_timingThread->join();
+        IOServicePool::instance().drain(m_ioService);
+        m_timer->cancel();
+        IOServicePool::instance().drain(m_ioService);
         m_buffer.clear();
-        m_ioService.reset();
         m_isRunning = false;
         m_isClosing = false;
 
@@ -398,7 +407,151 @@ void JitterBuffer::handleJob()
 
     ELOG_TRACE_T("(%s)buffer size %d, next time %d", m_name.c_str(), m_buffer.size(), interval);
 
-    m_timer->async_wait(boost::bind(&JitterBuffer::onTimeout, this, boost::asio::placeholders::error));
+    if (!m_isClosing)
+        m_timer->async_wait(boost::bind(&JitterBuffer::onTimeout, this, boost::asio::placeholders::error));
+}
+
+static bool mmapInputEnabled()
+{
+    const char* env = getenv("OWT_FILE_MMAP");
+    return !(env && env[0] == '0');
+}
+
+static int64_t readaheadWindowBytes()
+{
+    static int64_t bytes = 0;
+    if (bytes == 0) {
+        const char* env = getenv("OWT_FILE_READAHEAD_MB");
+        long n = (env && env[0]) ? strtol(env, NULL, 10) : 0;
+        if (n < 1 || n > 256)
+            n = 8;
+        bytes = n * 1024 * 1024;
+    }
+    return bytes;
+}
+
+static int mmapReadPacket(void *opaque, uint8_t *buf, int buf_size)
+{
+    return static_cast<MmapFileReader *>(opaque)->read(buf, buf_size);
+}
+
+static int64_t mmapSeekPacket(void *opaque, int64_t offset, int whence)
+{
+    return static_cast<MmapFileReader *>(opaque)->seek(offset, whence);
+}
+
+DEFINE_LOGGER(MmapFileReader, "owt.MmapFileReader");
+
+MmapFileReader::MmapFileReader(const std::string &path)
+    : m_fd(-1)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_offset(0)
+    , m_advisedEnd(0)
+    , m_readaheadBytes(readaheadWindowBytes())
+{
+    struct stat st;
+
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        ELOG_WARN("Cannot open %s for mmap input", path.c_str());
+        return;
+    }
+
+    if (fstat(m_fd, &st) < 0 || st.st_size <= 0) {
+        ELOG_WARN("Cannot stat %s for mmap input", path.c_str());
+        close(m_fd);
+        m_fd = -1;
+        return;
+    }
+    m_size = st.st_size;
+
+    void *data = mmap(NULL, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        ELOG_WARN("Cannot map %s, falling back to buffered I/O", path.c_str());
+        close(m_fd);
+        m_fd = -1;
+        return;
+    }
+    m_data = static_cast<uint8_t *>(data);
+
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+    readahead();
+
+    ELOG_DEBUG("Mapped %s, %ld bytes, readahead window %ld", path.c_str(), m_size, m_readaheadBytes);
+}
+
+MmapFileReader::~MmapFileReader()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+int MmapFileReader::read(uint8_t *buf, int size)
+{
+    if (m_offset >= m_size)
+        return AVERROR_EOF;
+
+    if (size > m_size - m_offset)
+        size = m_size - m_offset;
+
+    readahead();
+    memcpy(buf, m_data + m_offset, size);
+    m_offset += size;
+
+    return size;
+}
+
+int64_t MmapFileReader::seek(int64_t offset, int whence)
+{
+    switch (whence) {
+        case SEEK_SET:
+            break;
+        case SEEK_CUR:
+            offset += m_offset;
+            break;
+        case SEEK_END:
+            offset += m_size;
+            break;
+        case AVSEEK_SIZE:
+            return m_size;
+        default:
+            return AVERROR(EINVAL);
+    }
+
+    if (offset < 0 || offset > m_size)
+        return AVERROR(EINVAL);
+
+    m_offset = offset;
+    // Re-arm readahead at the new position.
+    m_advisedEnd = offset;
+    readahead();
+
+    return m_offset;
+}
+
+// Advise the kernel about the window ahead of the read offset, re-issued
+// once the offset crosses the middle of the previously advised window.
+void MmapFileReader::readahead()
+{
+    if (m_offset + m_readaheadBytes / 2 < m_advisedEnd)
+        return;
+
+    int64_t end = m_offset + m_readaheadBytes;
+    if (end > m_size)
+        end = m_size;
+
+    if (end > m_advisedEnd) {
+        madvise(m_data + m_offset, end - m_offset, MADV_WILLNEED);
+        m_advisedEnd = end;
+    }
 }
 
 DEFINE_LOGGER(LiveStreamIn, "owt.LiveStreamIn");
@@ -411,8 +564,10 @@ LiveStreamIn::LiveStreamIn(const Options& options, EventRegistry* handle)
     , m_options(nullptr)
     , m_running(false)
     , m_keyFrameRequest(false)
+    , m_deliverService(IOServicePool::instance().get())
     , m_context(nullptr)
     , m_timeoutHandler(nullptr)
+    , m_openTimeoutMs(options.openTimeoutMs > 0 ? options.openTimeoutMs : DEFAULT_OPEN_TIMEOUT_MS)
     , m_videoStreamIndex(-1)
     , m_videoFormat(FRAME_FORMAT_UNKNOWN)
     , m_videoWidth(0)
@@ -425,6 +580,7 @@ LiveStreamIn::LiveStreamIn(const Options& options, EventRegistry* handle)
     , m_audioSampleRate(0)
     , m_audioChannels(0)
     , m_isFileInput(false)
+    , m_customIo(nullptr)
     , m_timstampOffset(0)
     , m_lastTimstamp(0)
     , m_enableVideoExtradata(false)
@@ -486,6 +642,11 @@ LiveStreamIn::~LiveStreamIn()
     }
     m_thread.join();
 
+    // Flush deliver jobs already posted to the shared io_service; no new
+    // ones can appear once the demux thread has joined.
+    IOServicePool::instance().drain(m_deliverService);
+    m_deliverQueue.clear();
+
     if (m_videoJitterBuffer) {
         m_videoJitterBuffer->stop();
         m_videoJitterBuffer.reset();
@@ -509,11 +670,7 @@ LiveStreamIn::~LiveStreamIn()
         m_sps_pps_buffer_length = 0;
     }
 
-    if (m_context) {
-        avformat_close_input(&m_context);
-        avformat_free_context(m_context);
-        m_context = NULL;
-    }
+    closeContext();
 
     av_dict_free(&m_options);
     if (m_timeoutHandler) {
@@ -529,6 +686,74 @@ void LiveStreamIn::requestKeyFrame()
     ELOG_DEBUG_T("requestKeyFrame");
     if (!m_keyFrameRequest)
         m_keyFrameRequest = true;
+
+    // A pull input cannot ask its source for a keyframe; replay the cached
+    // one so a late subscriber renders now instead of waiting out the GOP.
+    replayKeyFrame();
+}
+
+// Queue the cached keyframe for delivery, stamped at the current timeline
+// position. The packet was cached after bitstream filtering, so it carries
+// its own SPS/PPS and decodes standalone.
+void LiveStreamIn::replayKeyFrame()
+{
+    boost::mutex::scoped_lock lock(m_keyFrameMutex);
+
+    if (!m_lastKeyFramePacket)
+        return;
+
+    AVPacket *pkt = m_lastKeyFramePacket->getAVPacket();
+    pkt->dts = m_lastTimstamp;
+    pkt->pts = m_lastTimstamp;
+
+    ELOG_DEBUG_T("Replay cached keyframe, dts %ld, size %d", pkt->dts, pkt->size);
+
+    boost::shared_ptr<FramePacket> framePacket(new FramePacket(pkt));
+    m_deliverQueue.pushPacket(framePacket);
+}
+
+// Attach a memory-mapped reader for file inputs; failures fall back
+// silently to FFmpeg's own buffered I/O.
+void LiveStreamIn::setupMmapInput()
+{
+    if (!m_isFileInput || !mmapInputEnabled())
+        return;
+
+    std::string path(m_url);
+    if (path.compare(0, 7, "file://") == 0)
+        path = path.substr(7);
+
+    m_mmapReader.reset(new MmapFileReader(path));
+    if (!m_mmapReader->isValid()) {
+        m_mmapReader.reset();
+        return;
+    }
+
+    int bufferSize = 64 * 1024;
+    uint8_t *buffer = (uint8_t *)av_malloc(bufferSize);
+
+    m_customIo = avio_alloc_context(buffer, bufferSize, 0, m_mmapReader.get(),
+            mmapReadPacket, NULL, mmapSeekPacket);
+    m_context->pb = m_customIo;
+    m_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+}
+
+// avformat_close_input leaves a custom pb to its owner, so the mmap io
+// context is released here in all teardown paths.
+void LiveStreamIn::closeContext()
+{
+    if (m_context) {
+        avformat_close_input(&m_context);
+        avformat_free_context(m_context);
+        m_context = NULL;
+    }
+
+    if (m_customIo) {
+        av_freep(&m_customIo->buffer);
+        avio_context_free(&m_customIo);
+    }
+
+    m_mmapReader.reset();
 }
 
 bool LiveStreamIn::connect()
@@ -538,9 +763,12 @@ bool LiveStreamIn::connect()
     m_context = avformat_alloc_context();
     m_context->interrupt_callback = {&TimeoutHandler::checkInterrupt, m_timeoutHandler};
     //m_context->max_analyze_duration = 3 * AV_TIME_BASE;
+    setupMmapInput();
+
+    ::notifyAsyncEvent(m_asyncHandle, "status", "{\"type\":\"connecting\"}");
 
     ELOG_DEBUG_T("Opening input");
-    m_timeoutHandler->reset(30000);
+    m_timeoutHandler->reset(m_openTimeoutMs);
     res = avformat_open_input(&m_context, m_url.c_str(), nullptr, m_options != NULL ? &m_options : NULL);
     if (res != 0) {
         ELOG_ERROR_T("Error opening input %s", ff_err2str(res));
@@ -550,6 +778,8 @@ bool LiveStreamIn::connect()
         return false;
     }
 
+    ::notifyAsyncEvent(m_asyncHandle, "status", "{\"type\":\"probing\"}");
+
     ELOG_DEBUG_T("Finding stream info");
     m_timeoutHandler->reset(10000);
     m_context->fps_probe_size = 0;
@@ -788,20 +1018,19 @@ bool LiveStreamIn::reconnect()
         m_sps_pps_buffer_length = 0;
     }
 
-    if (m_context) {
-        avformat_close_input(&m_context);
-        avformat_free_context(m_context);
-        m_context = NULL;
-    }
+    closeContext();
 
     m_timeoutHandler->reset(10000);
 
     m_context = avformat_alloc_context();
     m_context->interrupt_callback = {&TimeoutHandler::checkInterrupt, m_timeoutHandler};
     //m_context->max_analyze_duration = 3 * AV_TIME_BASE;
+    setupMmapInput();
 
     ELOG_DEBUG_T("Opening input");
-    m_timeoutHandler->reset(60000);
+    // Reconnects get double the first-open budget: the stream was known
+    // good, so riding out a longer server hiccup beats failing the session.
+    m_timeoutHandler->reset(m_openTimeoutMs * 2);
     res = avformat_open_input(&m_context, m_url.c_str(), nullptr, &m_options);
     if (res != 0) {
         ELOG_ERROR_T("Error opening input %s", ff_err2str(res));
@@ -920,6 +1149,9 @@ void LiveStreamIn::receiveLoop()
                 ::notifyAsyncEvent(m_asyncHandle, "status", "{\"type\":\"failed\",\"reason\":\"reopening input url error\"}");
                 break;
             }
+
+            // Bridge the gap until the source's next keyframe arrives.
+            replayKeyFrame();
             continue;
         }
 
@@ -931,13 +1163,19 @@ void LiveStreamIn::receiveLoop()
             ELOG_TRACE_T("Receive video frame packet, dts %ld, size %d"
                     , m_avPacket.dts, m_avPacket.size);
 
+            // Bitstream filtering stays on this thread because it works on
+            // AVStream state that reconnect() replaces; delivery is handed
+            // off so a slow consumer cannot back up av_read_frame.
             if (filterVBS(video_st, &m_avPacket)) {
                 filterPS(video_st, &m_avPacket);
 
-                if (m_videoJitterBuffer)
-                    m_videoJitterBuffer->insert(m_avPacket);
-                else
-                    deliverVideoFrame(&m_avPacket);
+                if (m_deliverQueue.size() >= MAX_PENDING_PACKETS) {
+                    ELOG_WARN_T("Deliver queue full, dropping video packet");
+                } else {
+                    boost::shared_ptr<FramePacket> framePacket(new FramePacket(&m_avPacket));
+                    m_deliverQueue.pushPacket(framePacket);
+                    m_deliverService.post(boost::bind(&LiveStreamIn::deliverJob, this));
+                }
             }
         } else if (m_avPacket.stream_index == m_audioStreamIndex) { //packet is audio
             AVStream *audio_st = m_context->streams[m_audioStreamIndex];
@@ -947,10 +1185,13 @@ void LiveStreamIn::receiveLoop()
             ELOG_TRACE_T("Receive audio frame packet, dts %ld, duration %ld, size %d"
                     , m_avPacket.dts, m_avPacket.duration, m_avPacket.size);
 
-            if (m_audioJitterBuffer)
-                m_audioJitterBuffer->insert(m_avPacket);
-            else
-                deliverAudioFrame(&m_avPacket);
+            if (m_deliverQueue.size() >= MAX_PENDING_PACKETS) {
+                ELOG_WARN_T("Deliver queue full, dropping audio packet");
+            } else {
+                boost::shared_ptr<FramePacket> framePacket(new FramePacket(&m_avPacket));
+                m_deliverQueue.pushPacket(framePacket);
+                m_deliverService.post(boost::bind(&LiveStreamIn::deliverJob, this));
+            }
         }
         m_lastTimstamp = m_avPacket.dts;
         av_packet_unref(&m_avPacket);
@@ -959,6 +1200,34 @@ void LiveStreamIn::receiveLoop()
     ELOG_DEBUG_T("Thread exited!");
 }
 
+// Drains one parsed packet onto the jitter buffers or straight to the
+// destinations. Demux and delivery used to share one thread, so a hiccup
+// in a consumer's onFrame backed all the way up into av_read_frame and
+// the socket; with the bounded queue in between, ingest keeps pace with
+// the network and a persistently slow consumer costs dropped packets
+// here instead of a stalled demuxer. The demux thread posts one job per
+// queued packet to a shared io_service; all of a stream's jobs land on
+// the same single-threaded service, so delivery order is preserved.
+void LiveStreamIn::deliverJob()
+{
+    boost::shared_ptr<FramePacket> framePacket = m_deliverQueue.popPacket();
+    if (!framePacket)
+        return;
+
+    AVPacket *pkt = framePacket->getAVPacket();
+    if (pkt->stream_index == m_videoStreamIndex) {
+        if (m_videoJitterBuffer)
+            m_videoJitterBuffer->insert(*pkt);
+        else
+            deliverVideoFrame(pkt);
+    } else if (pkt->stream_index == m_audioStreamIndex) {
+        if (m_audioJitterBuffer)
+            m_audioJitterBuffer->insert(*pkt);
+        else
+            deliverAudioFrame(pkt);
+    }
+}
+
 void LiveStreamIn::checkVideoBitstream(AVStream *st, const AVPacket *pkt)
 {
     int ret;
@@ -1235,6 +1504,11 @@ void LiveStreamIn::deliverNullVideoFrame()
 
 void LiveStreamIn::deliverVideoFrame(AVPacket *pkt)
 {
+    if (pkt->flags & AV_PKT_FLAG_KEY) {
+        boost::mutex::scoped_lock lock(m_keyFrameMutex);
+        m_lastKeyFramePacket.reset(new FramePacket(pkt));
+    }
+
     Frame frame;
     memset(&frame, 0, sizeof(frame));
     frame.format = m_videoFormat;
@@ -1244,6 +1518,7 @@ void LiveStreamIn::deliverVideoFrame(AVPacket *pkt)
     frame.additionalInfo.video.width = m_videoWidth;
     frame.additionalInfo.video.height = m_videoHeight;
     frame.additionalInfo.video.isKeyFrame = (pkt->flags & AV_PKT_FLAG_KEY);
+    frame.ingestTimeMs = ingestWallClockMs();
     deliverFrame(frame);
 
     ELOG_TRACE_T("deliver video frame, timestamp %ld(%ld), size %4d, %s"
@@ -1262,10 +1537,10 @@ void LiveStreamIn::deliverAudioFrame(AVPacket *pkt)
     frame.payload = reinterpret_cast<uint8_t*>(pkt->data);
     frame.length = pkt->size;
     frame.timeStamp = timeRescale(pkt->dts, m_msTimeBase, m_audioTimeBase);
-    frame.additionalInfo.audio.isRtpPacket = 0;
     frame.additionalInfo.audio.sampleRate = m_audioSampleRate;
     frame.additionalInfo.audio.channels = m_audioChannels;
     frame.additionalInfo.audio.nbSamples = frame.length / frame.additionalInfo.audio.channels /2;
+    frame.ingestTimeMs = ingestWallClockMs();
     deliverFrame(frame);
 
     ELOG_TRACE_T("deliver audio frame, timestamp %ld(%ld), size %4d"
@@ -101,6 +101,35 @@ public:
     virtual void onSyncTimeChanged(JitterBuffer *jitterBuffer, int64_t syncTimestamp) = 0;
 };
 
+// Serves file inputs from a memory mapping instead of buffered read()
+// I/O. The whole file is mapped once and madvise readahead runs a
+// window ahead of the read offset - reads advance at playback rate, so
+// the advised window tracks it and steady-state playout does not take
+// cold page faults. Seeks re-arm the window at the new position so VoD
+// start offsets warm up before the demuxer gets there.
+class MmapFileReader {
+    DECLARE_LOGGER();
+
+public:
+    MmapFileReader(const std::string &path);
+    virtual ~MmapFileReader();
+
+    bool isValid() {return m_data != nullptr;}
+
+    int read(uint8_t *buf, int size);
+    int64_t seek(int64_t offset, int whence);
+
+private:
+    void readahead();
+
+    int m_fd;
+    uint8_t *m_data;
+    int64_t m_size;
+    int64_t m_offset;
+    int64_t m_advisedEnd;
+    int64_t m_readaheadBytes;
+};
+
 class JitterBuffer {
     DECLARE_LOGGER();
 public:
@@ -137,8 +166,10 @@ private:
 
     FramePacketBuffer m_buffer;
 
-    boost::scoped_ptr<boost::thread> m_timingThread;
-    boost::asio::io_service m_ioService;
+    // Timer work runs on a shared io_service from IOServicePool (one
+    // thread per service keeps the handlers single-threaded) instead of
+    // a dedicated timing thread per buffer.
+    boost::asio::io_service& m_ioService;
     boost::scoped_ptr<boost::asio::deadline_timer> m_timer;
 
     boost::scoped_ptr<boost::posix_time::ptime> m_syncLocalTime;
@@ -154,6 +185,14 @@ class LiveStreamIn : public FrameSource, public JitterBufferListener {
     DECLARE_LOGGER();
 
     static const uint32_t DEFAULT_UDP_BUF_SIZE = 8 * 1024 * 1024;
+    // Default wall-clock budget for avformat_open_input on the first
+    // connect; a dead source fails within this bound instead of hanging
+    // on the demuxer's own (much longer) timeouts.
+    static const uint32_t DEFAULT_OPEN_TIMEOUT_MS = 30000;
+    // Cap on packets queued between the demux and deliver threads; at this
+    // depth the consumer is persistently behind and packets are dropped
+    // rather than backing up av_read_frame.
+    static const uint32_t MAX_PENDING_PACKETS = 512;
 public:
     struct Options {
         std::string url;
@@ -161,7 +200,8 @@ public:
         uint32_t bufferSize;
         std::string enableAudio;
         std::string enableVideo;
-        Options() : url{""}, transport{"tcp"}, bufferSize{DEFAULT_UDP_BUF_SIZE}, enableAudio{"no"}, enableVideo{"no"} { }
+        uint32_t openTimeoutMs;
+        Options() : url{""}, transport{"tcp"}, bufferSize{DEFAULT_UDP_BUF_SIZE}, enableAudio{"no"}, enableVideo{"no"}, openTimeoutMs{DEFAULT_OPEN_TIMEOUT_MS} { }
     };
 
     LiveStreamIn (const Options&, EventRegistry*);
@@ -193,8 +233,14 @@ private:
     bool m_running;
     bool m_keyFrameRequest;
     boost::thread m_thread;
+    // Packet delivery runs as jobs posted to a shared io_service (see
+    // deliverJob) rather than on a dedicated thread per stream; only the
+    // blocking FFmpeg demux keeps its own thread.
+    boost::asio::io_service& m_deliverService;
+    FramePacketBuffer m_deliverQueue;
     AVFormatContext* m_context;
     TimeoutHandler* m_timeoutHandler;
+    uint32_t m_openTimeoutMs;
     AVPacket m_avPacket;
 
     int m_videoStreamIndex;
@@ -218,6 +264,8 @@ private:
     boost::shared_ptr<JitterBuffer> m_audioJitterBuffer;
 
     bool m_isFileInput;
+    boost::scoped_ptr<MmapFileReader> m_mmapReader;
+    AVIOContext *m_customIo;
     int64_t m_timstampOffset;
     int64_t m_lastTimstamp;
 
@@ -225,6 +273,12 @@ private:
     boost::shared_array<uint8_t> m_sps_pps_buffer;
     int m_sps_pps_buffer_length;
 
+    // Most recent delivered keyframe, already bitstream-filtered so it
+    // carries its SPS/PPS; replayed on reconnect and keyframe requests
+    // (see replayKeyFrame).
+    boost::shared_ptr<FramePacket> m_lastKeyFramePacket;
+    boost::mutex m_keyFrameMutex;
+
     char m_errbuff[500];
     char *ff_err2str(int errRet);
 
@@ -235,10 +289,15 @@ private:
             || m_url.compare(0, 1, "/") == 0 || m_url.compare(0, 1, ".") == 0);}
 
     void requestKeyFrame();
+    void replayKeyFrame();
+
+    void setupMmapInput();
+    void closeContext();
 
     bool connect();
     bool reconnect();
     void receiveLoop();
+    void deliverJob();
 
     void checkVideoBitstream(AVStream *st, const AVPacket *pkt);
     bool parse_avcC(AVPacket *pkt);
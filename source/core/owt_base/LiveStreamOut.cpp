@@ -4,6 +4,8 @@
 
 #include "LiveStreamOut.h"
 
+#include <stdlib.h>
+
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavutil/avstring.h>
@@ -13,8 +15,40 @@ namespace owt_base {
 
 DEFINE_LOGGER(LiveStreamOut, "owt.LiveStreamOut");
 
+// CMAF mode for HLS egress: fragmented-MP4 segments instead of MPEG-TS.
+// Segments become decodable as their fragments land rather than after a
+// full TS segment closes, and no remux hop through an external packager
+// is needed for fMP4 players.
+static bool cmafHlsEnabled()
+{
+    const char* env = getenv("OWT_HLS_CMAF");
+    return (env && env[0] == '1');
+}
+
+// SRT tuning has to ride the url query string - the avio for network
+// outputs is opened from the plain url without an options dict. The
+// latency budget bounds how long lost packets may be retransmitted
+// before the receiver gives up on them; ffmpeg expects it in
+// microseconds.
+static std::string applySrtOptions(const std::string& url, const LiveStreamOut::StreamingOptions& options)
+{
+    if (options.format != LiveStreamOut::STREAMING_FORMAT_SRT)
+        return url;
+
+    if (url.compare(0, 6, "srt://") != 0 || url.find("latency=") != std::string::npos)
+        return url;
+
+    uint32_t latencyMs = options.srt_latency > 0 ? options.srt_latency : 120;
+
+    char query[64];
+    snprintf(query, sizeof(query), "%slatency=%u",
+            url.find('?') == std::string::npos ? "?" : "&", latencyMs * 1000);
+
+    return url + query;
+}
+
 LiveStreamOut::LiveStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int streamingTimeout, StreamingOptions& options)
-    : AVStreamOut(url, hasAudio, hasVideo, handle, streamingTimeout)
+    : AVStreamOut(applySrtOptions(url, options), hasAudio, hasVideo, handle, streamingTimeout)
     , m_options(options)
 {
     switch(m_options.format) {
@@ -44,6 +78,10 @@ LiveStreamOut::LiveStreamOut(const std::string& url, bool hasAudio, bool hasVide
                     );
             break;
 
+        case STREAMING_FORMAT_SRT:
+            ELOG_DEBUG("format %s, latency %dms", "srt", m_options.srt_latency);
+            break;
+
         default:
             ELOG_ERROR("Invalid streaming format");
             break;
@@ -87,12 +125,27 @@ const char *LiveStreamOut::getFormatName(std::string& url)
             return "hls";
         case STREAMING_FORMAT_DASH:
             return "dash";
+        case STREAMING_FORMAT_SRT:
+            return "mpegts";
         default:
             ELOG_ERROR("Invalid format for url(%s)", url.c_str());
             return NULL;
     }
 }
 
+uint32_t LiveStreamOut::getKeyFrameInterval()
+{
+    // Segmented formats cut on keyframes; request them at the segment
+    // cadence so actual segment duration tracks the configured target.
+    if (m_options.format == STREAMING_FORMAT_HLS && m_options.hls_time > 0)
+        return m_options.hls_time * 1000;
+
+    if (m_options.format == STREAMING_FORMAT_DASH && m_options.dash_seg_duration > 0)
+        return m_options.dash_seg_duration * 1000;
+
+    return 2000;
+}
+
 bool LiveStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
 {
     if (m_options.format == STREAMING_FORMAT_HLS) {
@@ -113,17 +166,34 @@ bool LiveStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
             return false;
         }
 
+        std::string basename(url.substr(pos1 + 1, pos2 - pos1 - 1));
         std::string segment_uri(url.substr(0, pos1));
         segment_uri.append("/");
-        segment_uri.append(url.substr(pos1 + 1, pos2 - pos1 - 1));
-        segment_uri.append("_%05d.ts");
+        segment_uri.append(basename);
+
+        if (cmafHlsEnabled()) {
+            segment_uri.append("_%05d.m4s");
+
+            std::string init_uri(basename);
+            init_uri.append("_init.mp4");
+
+            av_dict_set(options, "hls_segment_type", "fmp4", 0);
+            av_dict_set(options, "hls_fmp4_init_filename", init_uri.c_str(), 0);
+            // Independent segments start on keyframes, so players can
+            // join on any segment in the window.
+            av_dict_set(options, "hls_flags", "delete_segments+independent_segments", 0);
+
+            ELOG_DEBUG("init url %s", init_uri.c_str());
+        } else {
+            segment_uri.append("_%05d.ts");
+
+            av_dict_set(options, "hls_flags", "delete_segments", 0);
+        }
 
         ELOG_DEBUG("index url %s", url.c_str());
         ELOG_DEBUG("segment url %s", segment_uri.c_str());
         av_dict_set(options, "hls_segment_filename", segment_uri.c_str(), 0);
 
-        av_dict_set(options, "hls_flags", "delete_segments", 0);
-
         av_dict_set_int(options, "hls_time", m_options.hls_time, 0);
         av_dict_set_int(options, "hls_list_size", m_options.hls_list_size, 0);
 
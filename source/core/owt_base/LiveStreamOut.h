@@ -22,6 +22,7 @@ public:
         STREAMING_FORMAT_RTMP,
         STREAMING_FORMAT_HLS,
         STREAMING_FORMAT_DASH,
+        STREAMING_FORMAT_SRT,
     };
 
     struct StreamingOptions {
@@ -39,6 +40,10 @@ public:
                 uint32_t    dash_window_size;
                 char        dash_method[16];
             };
+
+            struct {
+                uint32_t    srt_latency; //ms
+            };
         };
     };
 
@@ -52,8 +57,11 @@ protected:
     const char *getFormatName(std::string& url) override;
     bool getHeaderOpt(std::string& url, AVDictionary **options) override;
 
-    uint32_t getKeyFrameInterval(void) override {return 2000;}
+    uint32_t getKeyFrameInterval(void) override;
     uint32_t getReconnectCount(void) override {return 1;}
+    // Viewers already sit behind seconds of CDN buffering; 50ms of added
+    // mux latency is invisible.
+    uint32_t getAudioBundleMs(void) override {return 50;}
 
 private:
     StreamingOptions m_options;
@@ -4,13 +4,68 @@
 
 #include "MediaFileOut.h"
 
+#include <stdlib.h>
+
 namespace owt_base {
 
+static bool asyncWriteEnabled()
+{
+    const char* env = getenv("OWT_RECORDING_ASYNC_WRITE");
+    return !(env && env[0] == '0');
+}
+
+// Fragmented-MP4 recording: the moov is written up front and media lands
+// in self-contained fragments, so the file is playable while recording
+// still runs, survives a recorder crash, and close() no longer spikes
+// I/O rewriting the whole moov at session end.
+static bool fmp4Enabled()
+{
+    const char* env = getenv("OWT_RECORDING_FMP4");
+    return (env && env[0] == '1');
+}
+
+static uint32_t fmp4FragmentMs()
+{
+    static uint32_t ms = 0;
+    if (ms == 0) {
+        const char* env = getenv("OWT_RECORDING_FRAG_MS");
+        long n = (env && env[0]) ? strtol(env, NULL, 10) : 0;
+        if (n < 500 || n > 60000)
+            n = 2000;
+        ms = n;
+    }
+    return ms;
+}
+
+static bool isHttpUrl(const std::string& url)
+{
+    return url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+}
+
+// Presigned upload URLs carry their signature in the query string; the
+// container format comes from the path alone.
+static std::string urlPath(const std::string& url)
+{
+    size_t q = url.find('?');
+    return (q == std::string::npos) ? url : url.substr(0, q);
+}
+
+static bool isMp4Url(const std::string& url)
+{
+    std::string path = urlPath(url);
+    size_t pos = path.rfind(".mp4");
+    return (pos != std::string::npos && pos > 0 && pos == (path.length() - strlen(".mp4")));
+}
+
 DEFINE_LOGGER(MediaFileOut, "owt.media.MediaFileOut");
 
 MediaFileOut::MediaFileOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int recordingTimeout)
     : AVStreamOut(url, hasAudio, hasVideo, handle, recordingTimeout)
+    , m_fmp4((fmp4Enabled() || isHttpUrl(url)) && isMp4Url(url))
+    , m_httpUpload(isHttpUrl(url))
 {
+    if (m_httpUpload)
+        ELOG_INFO("Streaming upload recording to %s", urlPath(url).c_str());
 }
 
 MediaFileOut::~MediaFileOut()
@@ -47,25 +102,68 @@ bool MediaFileOut::isVideoFormatSupported(FrameFormat format)
 
 const char *MediaFileOut::getFormatName(std::string& url)
 {
+    std::string path = urlPath(url);
     size_t pos;
 
-    if ((pos = url.rfind(".mkv")) != std::string::npos) {
-        if (pos > 0 && pos == (url.length() - strlen(".mkv")))
+    if ((pos = path.rfind(".mkv")) != std::string::npos) {
+        if (pos > 0 && pos == (path.length() - strlen(".mkv")))
             return "matroska";
-    } else if ((pos = url.rfind(".mp4")) != std::string::npos) {
-        if (pos > 0 && pos == (url.length() - strlen(".mp4")))
+    } else if ((pos = path.rfind(".mp4")) != std::string::npos) {
+        if (pos > 0 && pos == (path.length() - strlen(".mp4")))
             return "mp4";
     }
 
-    ELOG_ERROR("Invalid format for url(%s)", url.c_str());
+    ELOG_ERROR("Invalid format for url(%s)", path.c_str());
     return NULL;
 }
 
 bool MediaFileOut::getHeaderOpt(std::string& url, AVDictionary **options)
 {
+    if (m_fmp4) {
+        char fragDuration[32];
+
+        // Each fragment is self-contained; everything written so far
+        // stays decodable if the process dies mid-recording.
+        av_dict_set(options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+        snprintf(fragDuration, sizeof(fragDuration), "%u", fmp4FragmentMs() * 1000);
+        av_dict_set(options, "frag_duration", fragDuration, 0);
+
+        ELOG_DEBUG("Fragmented MP4 recording, fragment duration %ums", fmp4FragmentMs());
+    }
+
+    return true;
+}
+
+bool MediaFileOut::getProtocolOpt(std::string& url, AVDictionary **options)
+{
+    if (m_httpUpload) {
+        // One long chunked PUT: each muxed fragment goes onto the wire as
+        // soon as the writer ring drains it, so the recording is durable
+        // at the store within seconds and never touches local disk.
+        av_dict_set(options, "method", "PUT", 0);
+        av_dict_set(options, "chunked_post", "1", 0);
+        av_dict_set(options, "content_type",
+                isMp4Url(url) ? "video/mp4" : "video/x-matroska", 0);
+    }
+
     return true;
 }
 
+uint32_t MediaFileOut::getKeyFrameInterval()
+{
+    // Rotate fragments on sync samples: keyframe requests follow the
+    // fragment cadence so each fragment opens seekable.
+    if (m_fmp4)
+        return fmp4FragmentMs();
+
+    return 120000; //120s
+}
+
+bool MediaFileOut::useAsyncWrite()
+{
+    return asyncWriteEnabled();
+}
+
 void MediaFileOut::onVideoSourceChanged()
 {
     ELOG_DEBUG("onVideoSourceChanged");
@@ -25,9 +25,20 @@ protected:
     bool isVideoFormatSupported(FrameFormat format) override;
     const char *getFormatName(std::string& url) override;
     bool getHeaderOpt(std::string& url, AVDictionary **options) override;
+    bool getProtocolOpt(std::string& url, AVDictionary **options) override;
 
-    uint32_t getKeyFrameInterval(void) override {return 120000;} //120s
+    uint32_t getKeyFrameInterval(void) override;
     uint32_t getReconnectCount(void) override {return 0;}
+    bool useAsyncWrite(void) override;
+    // A recording never renders live; wake the writer per ~50ms of audio.
+    uint32_t getAudioBundleMs(void) override {return 50;}
+
+private:
+    bool m_fmp4;
+    // Output goes to an http(s) endpoint (presigned object-store URL or
+    // an upload gateway) as one streaming chunked PUT instead of a local
+    // file; forces fragmented MP4 since the sink cannot seek.
+    bool m_httpUpload;
 };
 
 } /* namespace owt_base */
@@ -4,10 +4,12 @@
 
 #include "MediaFrameMulticaster.h"
 
+#include "PayloadBuffer.h"
+
 namespace owt_base {
 
 MediaFrameMulticaster::MediaFrameMulticaster()
-    : m_pendingKeyFrameRequests(0)
+    : m_gopCacheBytes(0)
 {
     m_feedbackTimer.reset(new JobTimer(1, this));
 }
@@ -15,31 +17,126 @@ MediaFrameMulticaster::MediaFrameMulticaster()
 MediaFrameMulticaster::~MediaFrameMulticaster()
 {
     m_feedbackTimer->stop();
+
+    boost::mutex::scoped_lock lock(m_gopCacheMutex);
+    clearGopCacheLocked();
+}
+
+void MediaFrameMulticaster::addAudioDestination(FrameDestination* dest)
+{
+    boost::mutex::scoped_lock lock(m_queuedDestsMutex);
+    boost::shared_ptr<QueuedFrameDestination> queued(new QueuedFrameDestination(dest, true));
+    m_queuedDests[dest] = queued;
+    FrameSource::addAudioDestination(queued.get());
+}
+
+void MediaFrameMulticaster::removeAudioDestination(FrameDestination* dest)
+{
+    boost::mutex::scoped_lock lock(m_queuedDestsMutex);
+    auto it = m_queuedDests.find(dest);
+    if (it != m_queuedDests.end()) {
+        FrameSource::removeAudioDestination(it->second.get());
+        m_queuedDests.erase(it);
+    }
+}
+
+void MediaFrameMulticaster::addVideoDestination(FrameDestination* dest)
+{
+    boost::mutex::scoped_lock lock(m_queuedDestsMutex);
+    boost::shared_ptr<QueuedFrameDestination> queued(
+        new QueuedFrameDestination(dest, false, kGopCacheMaxFrames + 64));
+    m_queuedDests[dest] = queued;
+
+    // Replay the cached GOP and attach under the cache lock: onFrame()
+    // updates the cache and fans out under the same lock, so the joiner
+    // sees every frame exactly once - replayed or live, never both.
+    boost::mutex::scoped_lock cacheLock(m_gopCacheMutex);
+    replayGopCacheLocked(queued.get());
+    FrameSource::addVideoDestination(queued.get());
+}
+
+void MediaFrameMulticaster::removeVideoDestination(FrameDestination* dest)
+{
+    boost::mutex::scoped_lock lock(m_queuedDestsMutex);
+    auto it = m_queuedDests.find(dest);
+    if (it != m_queuedDests.end()) {
+        FrameSource::removeVideoDestination(it->second.get());
+        m_queuedDests.erase(it);
+    }
 }
 
 void MediaFrameMulticaster::onFeedback(const FeedbackMsg& msg)
 {
     if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_KEY_FRAME) {
-        if (!m_pendingKeyFrameRequests) {
+        if (m_keyFrameGovernor.onRequest()) {
             FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_KEY_FRAME};
             deliverFeedbackMsg(msg);
         }
-        ++m_pendingKeyFrameRequests;
     }
 }
 
 void MediaFrameMulticaster::onFrame(const Frame& frame)
 {
+    // Cache compressed video and fan out under one lock so a concurrent
+    // join replays a consistent prefix (see addVideoDestination). Fan-out
+    // only enqueues into per-destination queues, so the section stays
+    // short; audio and raw frames skip the lock entirely.
+    if (isVideoFrame(frame) && frame.length > 0
+        && frame.format != FRAME_FORMAT_I420 && frame.format != FRAME_FORMAT_MSDK) {
+        boost::mutex::scoped_lock lock(m_gopCacheMutex);
+        updateGopCacheLocked(frame);
+        deliverFrame(frame);
+        return;
+    }
+
     deliverFrame(frame);
 }
 
+void MediaFrameMulticaster::updateGopCacheLocked(const Frame& frame)
+{
+    if (frame.additionalInfo.video.isKeyFrame) {
+        clearGopCacheLocked();
+        m_gopCache.push_back(makeOwnedFrame(frame));
+        m_gopCacheBytes = frame.length;
+        return;
+    }
+
+    // No keyframe cached yet; deltas alone are not replayable.
+    if (m_gopCache.empty())
+        return;
+
+    if (m_gopCache.size() >= kGopCacheMaxFrames
+        || m_gopCacheBytes + frame.length > kGopCacheMaxBytes) {
+        // Over-long GOP: stay bounded and give up on this one; the cache
+        // restarts at the next keyframe and joiners fall back to waiting.
+        clearGopCacheLocked();
+        return;
+    }
+
+    m_gopCache.push_back(makeOwnedFrame(frame));
+    m_gopCacheBytes += frame.length;
+}
+
+void MediaFrameMulticaster::replayGopCacheLocked(QueuedFrameDestination* queued)
+{
+    for (auto it = m_gopCache.begin(); it != m_gopCache.end(); ++it)
+        queued->onFrame(*it);
+}
+
+void MediaFrameMulticaster::clearGopCacheLocked()
+{
+    for (auto it = m_gopCache.begin(); it != m_gopCache.end(); ++it)
+        releaseOwnedFrame(*it);
+    m_gopCache.clear();
+    m_gopCacheBytes = 0;
+}
+
 void MediaFrameMulticaster::onTimeout()
 {
-    if (m_pendingKeyFrameRequests > 1) {
+    if (m_keyFrameGovernor.onTick()) {
         FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_KEY_FRAME};
         deliverFeedbackMsg(msg);
     }
-    m_pendingKeyFrameRequests = 0;
 }
 
 } /* namespace owt_base */
@@ -5,9 +5,16 @@
 #ifndef MediaFrameMulticaster_h
 #define MediaFrameMulticaster_h
 
+#include "KeyFrameRequestGovernor.h"
 #include "MediaFramePipeline.h"
+#include "QueuedFrameDestination.h"
 #include <JobTimer.h>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <map>
+
 namespace owt_base {
 
 class MediaFrameMulticaster : public FrameSource, public FrameDestination, public JobTimerListener {
@@ -15,6 +22,14 @@ public:
     MediaFrameMulticaster();
     virtual ~MediaFrameMulticaster();
 
+    // Each destination is decoupled behind a QueuedFrameDestination so a
+    // stalled subscriber degrades only its own stream; these shadow the
+    // FrameSource methods of the same name.
+    void addAudioDestination(FrameDestination*);
+    void removeAudioDestination(FrameDestination*);
+    void addVideoDestination(FrameDestination*);
+    void removeVideoDestination(FrameDestination*);
+
     // Implements FrameSource.
     void onFeedback(const FeedbackMsg&);
 
@@ -25,8 +40,30 @@ public:
     void onTimeout();
 
 private:
+    // The GOP cache may replay this many frames into a joiner's queue, so
+    // video queues are sized to hold a full replay on top of the steady-state
+    // bound; otherwise the queue would shed the replayed deltas right away.
+    static const size_t kGopCacheMaxFrames = 300;
+    static const size_t kGopCacheMaxBytes = 16 * 1024 * 1024;
+
+    // All three called with m_gopCacheMutex held.
+    void updateGopCacheLocked(const Frame& frame);
+    void replayGopCacheLocked(QueuedFrameDestination* queued);
+    void clearGopCacheLocked();
+
     boost::scoped_ptr<JobTimer> m_feedbackTimer;
-    uint32_t m_pendingKeyFrameRequests;
+    KeyFrameRequestGovernor m_keyFrameGovernor;
+
+    std::map<FrameDestination*, boost::shared_ptr<QueuedFrameDestination>> m_queuedDests;
+    boost::mutex m_queuedDestsMutex;
+
+    // Last keyframe plus the deltas after it, payload-shared via
+    // PayloadBuffer references; replayed to late joiners so they render
+    // immediately instead of waiting out a screen-share GOP or costing the
+    // publisher a keyframe request.
+    std::deque<Frame> m_gopCache;
+    size_t m_gopCacheBytes;
+    boost::mutex m_gopCacheMutex;
 };
 
 } /* namespace owt_base */
@@ -3,36 +3,46 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "MediaFramePipeline.h"
+#include "PayloadBuffer.h"
+#include "PipelineTracer.h"
+
+#include <utility>
 
 namespace owt_base {
 
 FrameSource::~FrameSource()
 {
     {
-        boost::upgrade_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-        for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
-            (*it)->unsetAudioSource();
+        boost::unique_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
+        std::shared_ptr<const DestinationList> dests = std::atomic_load(&m_audio_dests);
+        if (dests) {
+            for (auto it = dests->begin(); it != dests->end(); ++it) {
+                (*it)->unsetAudioSource();
+            }
         }
-
-        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
-        m_audio_dests.clear();
+        std::atomic_store(&m_audio_dests, std::shared_ptr<const DestinationList>());
     }
 
     {
-        boost::upgrade_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-        for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
-            (*it)->unsetVideoSource();
+        boost::unique_lock<boost::shared_mutex> lock(m_video_dests_mutex);
+        std::shared_ptr<const DestinationList> dests = std::atomic_load(&m_video_dests);
+        if (dests) {
+            for (auto it = dests->begin(); it != dests->end(); ++it) {
+                (*it)->unsetVideoSource();
+            }
         }
-
-        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
-        m_video_dests.clear();
+        std::atomic_store(&m_video_dests, std::shared_ptr<const DestinationList>());
     }
 }
 
 void FrameSource::addAudioDestination(FrameDestination* dest)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-    m_audio_dests.push_back(dest);
+    std::shared_ptr<const DestinationList> old = std::atomic_load(&m_audio_dests);
+    std::shared_ptr<DestinationList> updated =
+        old ? std::make_shared<DestinationList>(*old) : std::make_shared<DestinationList>();
+    updated->push_back(dest);
+    std::atomic_store(&m_audio_dests, std::shared_ptr<const DestinationList>(updated));
     lock.unlock();
     dest->setAudioSource(this);
 }
@@ -40,7 +50,11 @@ void FrameSource::addAudioDestination(FrameDestination* dest)
 void FrameSource::addVideoDestination(FrameDestination* dest)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-    m_video_dests.push_back(dest);
+    std::shared_ptr<const DestinationList> old = std::atomic_load(&m_video_dests);
+    std::shared_ptr<DestinationList> updated =
+        old ? std::make_shared<DestinationList>(*old) : std::make_shared<DestinationList>();
+    updated->push_back(dest);
+    std::atomic_store(&m_video_dests, std::shared_ptr<const DestinationList>(updated));
     lock.unlock();
     dest->setVideoSource(this);
 }
@@ -48,7 +62,12 @@ void FrameSource::addVideoDestination(FrameDestination* dest)
 void FrameSource::removeAudioDestination(FrameDestination* dest)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-    m_audio_dests.remove(dest);
+    std::shared_ptr<const DestinationList> old = std::atomic_load(&m_audio_dests);
+    if (old) {
+        std::shared_ptr<DestinationList> updated = std::make_shared<DestinationList>(*old);
+        updated->remove(dest);
+        std::atomic_store(&m_audio_dests, std::shared_ptr<const DestinationList>(updated));
+    }
     lock.unlock();
     dest->unsetAudioSource();
 }
@@ -56,22 +75,109 @@ void FrameSource::removeAudioDestination(FrameDestination* dest)
 void FrameSource::removeVideoDestination(FrameDestination* dest)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-    m_video_dests.remove(dest);
+    std::shared_ptr<const DestinationList> old = std::atomic_load(&m_video_dests);
+    if (old) {
+        std::shared_ptr<DestinationList> updated = std::make_shared<DestinationList>(*old);
+        updated->remove(dest);
+        std::atomic_store(&m_video_dests, std::shared_ptr<const DestinationList>(updated));
+    }
     lock.unlock();
     dest->unsetVideoSource();
 }
 
 void FrameSource::deliverFrame(const Frame& frame)
 {
+    if (PipelineTracer::enabled())
+        PipelineTracer::instance().instant(isAudioFrame(frame) ? "audio" : "video", "deliver_frame", frame.timeStamp);
+
+    // Lock-free traversal: the snapshot we load stays alive (and immutable)
+    // for as long as we hold the shared_ptr, even if a writer swaps in a new
+    // list concurrently.
     if (isAudioFrame(frame)) {
-        boost::shared_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-        for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
-            (*it)->onFrame(frame);
+        std::shared_ptr<const DestinationList> dests = std::atomic_load(&m_audio_dests);
+        if (dests) {
+            for (auto it = dests->begin(); it != dests->end(); ++it) {
+                uint64_t start = LatencyHistogram::nowUs();
+                (*it)->onFrame(frame);
+                (*it)->onFrameLatency().record(LatencyHistogram::nowUs() - start);
+            }
         }
     } else if (isVideoFrame(frame)) {
-        boost::shared_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-        for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
-            (*it)->onFrame(frame);
+        std::shared_ptr<const DestinationList> dests = std::atomic_load(&m_video_dests);
+        if (dests) {
+            for (auto it = dests->begin(); it != dests->end(); ++it) {
+                uint64_t start = LatencyHistogram::nowUs();
+                (*it)->onFrame(frame);
+                (*it)->onFrameLatency().record(LatencyHistogram::nowUs() - start);
+            }
+        }
+    } else {
+        //TODO: log error here.
+    }
+}
+
+void FrameSource::deliverFrame(Frame&& frame)
+{
+    std::shared_ptr<const DestinationList> dests;
+    if (isAudioFrame(frame)) {
+        dests = std::atomic_load(&m_audio_dests);
+    } else if (isVideoFrame(frame)) {
+        dests = std::atomic_load(&m_video_dests);
+    }
+
+    if (!dests || dests->empty()) {
+        releaseOwnedFrame(frame);
+        return;
+    }
+
+    if (dests->size() == 1) {
+        // The fan-out path below goes through the const-ref overload, which
+        // emits its own event; only this branch bypasses it.
+        if (PipelineTracer::enabled())
+            PipelineTracer::instance().instant(isAudioFrame(frame) ? "audio" : "video", "deliver_frame", frame.timeStamp);
+
+        FrameDestination* dest = dests->front();
+        uint64_t start = LatencyHistogram::nowUs();
+        dest->onFrame(std::move(frame));
+        dest->onFrameLatency().record(LatencyHistogram::nowUs() - start);
+        return;
+    }
+
+    // Fan-out: fall back to shared const-ref delivery, then drop the
+    // ownership we were handed.
+    deliverFrame(static_cast<const Frame&>(frame));
+    releaseOwnedFrame(frame);
+}
+
+void FrameSource::deliverFrames(const Frame* frames, uint32_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // One event per batch, stamped with the first frame, keeps the trace
+    // readable at audio packet rates.
+    if (PipelineTracer::enabled())
+        PipelineTracer::instance().instant(isAudioFrame(frames[0]) ? "audio" : "video", "deliver_frames", frames[0].timeStamp);
+
+    // Batches are homogeneous; classify once on the first frame.
+    if (isAudioFrame(frames[0])) {
+        std::shared_ptr<const DestinationList> dests = std::atomic_load(&m_audio_dests);
+        if (dests) {
+            for (auto it = dests->begin(); it != dests->end(); ++it) {
+                uint64_t start = LatencyHistogram::nowUs();
+                (*it)->onFrames(frames, count);
+                (*it)->onFrameLatency().record(LatencyHistogram::nowUs() - start);
+            }
+        }
+    } else if (isVideoFrame(frames[0])) {
+        std::shared_ptr<const DestinationList> dests = std::atomic_load(&m_video_dests);
+        if (dests) {
+            for (auto it = dests->begin(); it != dests->end(); ++it) {
+                uint64_t start = LatencyHistogram::nowUs();
+                (*it)->onFrames(frames, count);
+                (*it)->onFrameLatency().record(LatencyHistogram::nowUs() - start);
+            }
         }
     } else {
         //TODO: log error here.
@@ -80,6 +186,12 @@ void FrameSource::deliverFrame(const Frame& frame)
 
 //=========================================================================================
 
+void FrameDestination::onFrame(Frame&& frame)
+{
+    onFrame(static_cast<const Frame&>(frame));
+    releaseOwnedFrame(frame);
+}
+
 void FrameDestination::setAudioSource(FrameSource* src)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_audio_src_mutex);
@@ -123,4 +235,3 @@ void FrameDestination::deliverFeedbackMsg(const FeedbackMsg& msg) {
 }
 
 }
-
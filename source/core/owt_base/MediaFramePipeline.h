@@ -5,11 +5,16 @@
 #ifndef MediaFramePipeline_h
 #define MediaFramePipeline_h
 
+#include "LatencyHistogram.h"
+
 #include <boost/thread/shared_mutex.hpp>
 #include <list>
 #include <map>
+#include <memory>
 #include <stdint.h>
 #include <string>
+#include <time.h>
+#include <vector>
 
 namespace owt_base {
 
@@ -17,11 +22,18 @@ enum FrameFormat {
     FRAME_FORMAT_UNKNOWN    = 0,
 
     FRAME_FORMAT_I420       = 100,
+    // 10-bit raw carriers for HDR content. I010 is planar with the ten
+    // significant bits in the low end of each 16-bit word (ffmpeg's
+    // yuv420p10le); P010 is biplanar with them MSB-aligned (VAAPI/MSDK
+    // surface readback).
+    FRAME_FORMAT_I010,
+    FRAME_FORMAT_P010,
 
     FRAME_FORMAT_VP8        = 200,
     FRAME_FORMAT_VP9,
     FRAME_FORMAT_H264,
     FRAME_FORMAT_H265,
+    FRAME_FORMAT_AV1,
 
     FRAME_FORMAT_MSDK       = 300,
 
@@ -58,14 +70,31 @@ struct VideoFrameSpecificInfo {
     uint16_t width;
     uint16_t height;
     bool isKeyFrame;
+    // VP9 SVC layering, filled by VideoFrameConstructor when the encoder
+    // signals it; all zero for codecs/streams without layers.
+    uint8_t spatialLayerId;
+    uint8_t temporalLayerId;
+    bool temporalUpSwitch;
 };
 
 struct AudioFrameSpecificInfo {
-    /*AudioFrameSpecificInfo() : isRtpPacket(false) {}*/
-    uint8_t isRtpPacket; // FIXME: Temporarily use Frame to carry rtp-packets due to the premature AudioFrameConstructor implementation.
     uint32_t nbSamples;
     uint32_t sampleRate;
     uint8_t channels;
+    uint8_t voiceActivity; // 1 when the frame carries speech, 0 for silence/comfort-noise keepalives
+    // RTP arrival metadata, filled by AudioFrameConstructor so jitter-buffer
+    // consumers keep the original packet timing without re-parsing a wire
+    // header. hasRtpTiming stays 0 for synthesized frames (mixer output,
+    // file/stream ingest); such consumers generate their own sequencing.
+    uint8_t hasRtpTiming;
+    uint8_t marker;
+    uint16_t seqNumber;
+    uint32_t ssrc;
+    // Sender-reported audio level (RFC 6464), in -dBov so 0 is loudest and
+    // 127 is silence. Lets the mixer rank speakers without decoding;
+    // hasAudioLevel stays 0 when the extension was not negotiated.
+    uint8_t hasAudioLevel;
+    uint8_t audioLevel;
 };
 
 typedef union MediaSpecInfo {
@@ -73,14 +102,34 @@ typedef union MediaSpecInfo {
     AudioFrameSpecificInfo audio;
 } MediaSpecInfo;
 
+class PayloadBuffer;
+
 struct Frame {
     FrameFormat     format;
     uint8_t*        payload;
     uint32_t        length;
     uint32_t        timeStamp;
     MediaSpecInfo   additionalInfo;
+    PayloadBuffer*  buffer; // Optional refcounted payload storage (see PayloadBuffer.h); null for raw-payload frames.
+    // Wall-clock ms at which this frame's media entered the deployment
+    // (stamped by the frame constructors and LiveStreamIn; 0 = unknown).
+    // Transcoders and the mixer carry it forward, so egress stages can
+    // report true ingest-to-egress latency. It crosses the internal
+    // transports with the rest of the header; cross-node readings are as
+    // good as the hosts' clock sync.
+    int64_t         ingestTimeMs;
 };
 
+// Wall clock for Frame::ingestTimeMs. The rest of the pipeline runs on
+// monotonic time, but ingest stamps must compare across processes and
+// hosts, which only the realtime clock can do.
+inline int64_t ingestWallClockMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
 inline FrameFormat getFormat(const std::string& codec) {
     if (codec == "vp8") {
         return owt_base::FRAME_FORMAT_VP8;
@@ -90,6 +139,8 @@ inline FrameFormat getFormat(const std::string& codec) {
         return owt_base::FRAME_FORMAT_VP9;
     } else if (codec == "h265") {
         return owt_base::FRAME_FORMAT_H265;
+    } else if (codec == "av1" || codec == "av1x") {
+        return owt_base::FRAME_FORMAT_AV1;
     } else if (codec == "pcm_48000_2" || codec == "pcm_raw") {
         return owt_base::FRAME_FORMAT_PCM_48000_2;
     } else if (codec == "pcmu") {
@@ -128,6 +179,10 @@ inline const char *getFormatStr(const FrameFormat &format) {
             return "UNKNOWN";
         case FRAME_FORMAT_I420:
             return "I420";
+        case FRAME_FORMAT_I010:
+            return "I010";
+        case FRAME_FORMAT_P010:
+            return "P010";
         case FRAME_FORMAT_MSDK:
             return "MSDK";
         case FRAME_FORMAT_VP8:
@@ -138,6 +193,8 @@ inline const char *getFormatStr(const FrameFormat &format) {
             return "H264";
         case FRAME_FORMAT_H265:
             return "H265";
+        case FRAME_FORMAT_AV1:
+            return "AV1";
         case FRAME_FORMAT_PCM_48000_2:
             return "PCM_48000_2";
         case FRAME_FORMAT_PCMU:
@@ -169,29 +226,15 @@ inline const char *getFormatStr(const FrameFormat &format) {
     }
 }
 
+// The enum is laid out in ranges - raw and video formats in [I420, 800),
+// audio formats from PCM_48000_2 up - so the per-frame classification that
+// deliverFrame() runs on every frame is a range check, not a compare chain.
 inline bool isAudioFrame(const Frame& frame) {
-    return frame.format == FRAME_FORMAT_PCM_48000_2
-          || frame.format == FRAME_FORMAT_PCMU
-          || frame.format == FRAME_FORMAT_PCMA
-          || frame.format == FRAME_FORMAT_OPUS
-          || frame.format == FRAME_FORMAT_ISAC16
-          || frame.format == FRAME_FORMAT_ISAC32
-          || frame.format == FRAME_FORMAT_ILBC
-          || frame.format == FRAME_FORMAT_G722_16000_1
-          || frame.format == FRAME_FORMAT_G722_16000_2
-          || frame.format == FRAME_FORMAT_AAC
-          || frame.format == FRAME_FORMAT_AAC_48000_2
-          || frame.format == FRAME_FORMAT_AC3
-          || frame.format == FRAME_FORMAT_NELLYMOSER;
+    return frame.format >= FRAME_FORMAT_PCM_48000_2;
 }
 
 inline bool isVideoFrame(const Frame& frame) {
-    return frame.format == FRAME_FORMAT_I420
-          || frame.format ==FRAME_FORMAT_MSDK
-          || frame.format == FRAME_FORMAT_VP8
-          || frame.format == FRAME_FORMAT_VP9
-          || frame.format == FRAME_FORMAT_H264
-          || frame.format == FRAME_FORMAT_H265;
+    return frame.format >= FRAME_FORMAT_I420 && frame.format < FRAME_FORMAT_PCM_48000_2;
 }
 
 enum FeedbackType {
@@ -234,11 +277,26 @@ public:
 
 protected:
     void deliverFrame(const Frame&);
+    // Hands the frame off by move. With a single destination (the common
+    // transcoder chain) the frame - including its payload buffer reference -
+    // transfers with zero copies and zero refcount traffic; with several
+    // destinations this degrades to the shared const-ref delivery.
+    void deliverFrame(Frame&&);
+    // Delivers a homogeneous batch of frames (all audio or all video) with a
+    // single snapshot load and one onFrames() dispatch per destination, so
+    // 10ms-cadence producers amortize the per-frame fan-out overhead.
+    void deliverFrames(const Frame* frames, uint32_t count);
 
 private:
-    std::list<FrameDestination*> m_audio_dests;
+    typedef std::list<FrameDestination*> DestinationList;
+
+    // The destination lists are published as immutable snapshots. deliverFrame
+    // grabs the current snapshot with an atomic load and traverses it without
+    // taking any lock, so subscription churn (add/removeDestination, which
+    // copy-and-swap the snapshot under the mutex) never blocks frame fan-out.
+    std::shared_ptr<const DestinationList> m_audio_dests;
     boost::shared_mutex m_audio_dests_mutex;
-    std::list<FrameDestination*> m_video_dests;
+    std::shared_ptr<const DestinationList> m_video_dests;
     boost::shared_mutex m_video_dests_mutex;
 };
 
@@ -249,8 +307,30 @@ public:
     virtual ~FrameDestination() { }
 
     virtual void onFrame(const Frame&) = 0;
+    // Move-semantics counterpart of onFrame(): ownership of the frame's
+    // payload buffer reference (if any) transfers to the destination.
+    // Destinations that can adopt the frame outright (e.g. queueing stages)
+    // override this to avoid refcount traffic and copies; the default
+    // delegates to onFrame(const Frame&) and drops the transferred
+    // reference afterwards.
+    virtual void onFrame(Frame&& frame);
+    // Batched counterpart of onFrame(). Destinations that can take a whole
+    // batch in one go (single lock acquisition/wakeup) override this; the
+    // default just unbatches.
+    virtual void onFrames(const Frame* frames, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i) {
+            onFrame(frames[i]);
+        }
+    }
     virtual void onVideoSourceChanged() {}
 
+    // Time spent inside this destination's onFrame()/onFrames(), recorded by
+    // the delivering FrameSource. Always on; the addon layer reads it per
+    // stream via report().
+    const LatencyHistogram& onFrameLatency() const { return m_onFrameLatency; }
+    LatencyHistogram& onFrameLatency() { return m_onFrameLatency; }
+
     void setAudioSource(FrameSource*);
     void unsetAudioSource();
 
@@ -268,6 +348,7 @@ private:
     boost::shared_mutex m_audio_src_mutex;
     FrameSource* m_video_src;
     boost::shared_mutex m_video_src_mutex;
+    LatencyHistogram m_onFrameLatency;
 };
 
 class VideoFrameDecoder : public FrameSource, public FrameDestination {
@@ -284,10 +365,29 @@ public:
     virtual void clearText() = 0;
 };
 
+// Salient region reported by the analytics pipeline, in the pixel space of
+// the reporting stage's output frames (given alongside as width/height so
+// encoders can rescale). qpOffset is the quality bias for the region:
+// negative spends more bits there.
+struct RoiRegion {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    int8_t qpOffset;
+};
+
+class VideoFrameEncoder;
+
 class VideoFrameAnalyzer : public FrameSource, public FrameDestination {
 public:
     virtual ~VideoFrameAnalyzer() { }
     virtual bool init(FrameFormat format, const uint32_t width, const uint32_t height, const uint32_t frameRate, const std::string& pluginName) = 0;
+    // Encoders downstream of this analyzer register here to receive the
+    // plugin's detections as ROI hints; analyzers whose plugin reports no
+    // regions never call back.
+    virtual void addRoiConsumer(VideoFrameEncoder*) { }
+    virtual void removeRoiConsumer(VideoFrameEncoder*) { }
 };
 
 class VideoFrameEncoder : public FrameDestination {
@@ -296,7 +396,15 @@ public:
 
     virtual FrameFormat getInputFormat() = 0;
 
+    // ROI hints from an upstream analyzer: concentrate bits on the given
+    // regions via the codec's region-QP mechanism. An empty list clears
+    // previous hints; encoders without such a mechanism ignore the call.
+    virtual void setRoiRegions(const std::vector<RoiRegion>&, uint32_t width, uint32_t height) { }
+
     virtual bool canSimulcast(FrameFormat, uint32_t width, uint32_t height) = 0;
+    // Whether this encoder instance is already producing exactly this stream
+    // and can fan it out to one more subscriber without a second encode.
+    virtual bool canShareStream(FrameFormat, VideoCodecProfile, uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds) { return false; }
     virtual bool isIdle() = 0;
     virtual int32_t generateStream(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds, FrameDestination*) = 0;
     virtual void degenerateStream(int32_t streamId) = 0;
@@ -0,0 +1,198 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MemoryBudget.h"
+
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(MemoryBudget, "owt.MemoryBudget");
+
+// Watermarks as percent of the budget. The gap between them leaves room for
+// a level-1 trim to take effect before level 2 empties the warm caches.
+static const uint32_t kHighWatermarkPct = 80;
+static const uint32_t kCriticalWatermarkPct = 90;
+
+// Minimum seconds between trims: freed memory does not leave the RSS
+// instantly (the allocator may hold on to the pages), so back-to-back trims
+// would punish pools for reclamation that is already in flight.
+static const uint32_t kTrimIntervalSecs = 5;
+
+MemoryBudget& MemoryBudget::instance()
+{
+    static MemoryBudget budget;
+    return budget;
+}
+
+bool MemoryBudget::enabled()
+{
+    static bool enabled = []() {
+        const char* env = getenv("OWT_MEMORY_BUDGET_MB");
+        return env && env[0];
+    }();
+    return enabled;
+}
+
+MemoryBudget::MemoryBudget()
+    : m_budgetBytes(0)
+    , m_lastRssBytes(0)
+    , m_sinceTrimSecs(kTrimIntervalSecs)
+{
+    const char* env = getenv("OWT_MEMORY_BUDGET_MB");
+    if (env && env[0]) {
+        if (!strcmp(env, "auto")) {
+            m_budgetBytes = cgroupLimitBytes();
+            if (!m_budgetBytes)
+                ELOG_WARN("No cgroup memory limit found, budget disabled");
+        } else {
+            long mb = strtol(env, NULL, 10);
+            if (mb > 0)
+                m_budgetBytes = (size_t)mb * 1024 * 1024;
+        }
+    }
+
+    if (m_budgetBytes) {
+        ELOG_INFO("Memory budget %zuMB, trim at %u%%/%u%%",
+            m_budgetBytes / (1024 * 1024), kHighWatermarkPct, kCriticalWatermarkPct);
+        m_timer.reset(new JobTimer(1, this));
+    }
+}
+
+size_t MemoryBudget::cgroupLimitBytes()
+{
+    // v2 first, then v1. A v1 limit of (close to) max int64 means "no limit";
+    // treat anything over 1TB as unlimited either way.
+    static const char* kPaths[] = {
+        "/sys/fs/cgroup/memory.max",
+        "/sys/fs/cgroup/memory/memory.limit_in_bytes"
+    };
+
+    for (size_t i = 0; i < sizeof(kPaths) / sizeof(kPaths[0]); i++) {
+        FILE* fp = fopen(kPaths[i], "r");
+        if (!fp)
+            continue;
+
+        char buf[64] = {0};
+        size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+        fclose(fp);
+        if (!n)
+            continue;
+
+        if (!strncmp(buf, "max", 3))
+            return 0;
+
+        unsigned long long limit = strtoull(buf, NULL, 10);
+        if (limit && limit < (1ull << 40))
+            return (size_t)limit;
+    }
+    return 0;
+}
+
+size_t MemoryBudget::residentBytes()
+{
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if (!fp)
+        return 0;
+
+    unsigned long size = 0, resident = 0;
+    int matched = fscanf(fp, "%lu %lu", &size, &resident);
+    fclose(fp);
+    if (matched != 2)
+        return 0;
+
+    static const long kPageSize = sysconf(_SC_PAGESIZE);
+    return (size_t)resident * kPageSize;
+}
+
+void MemoryBudget::addTrimmer(const std::string& name, MemoryTrimmer* trimmer)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    PoolStats& stats = m_pools[name];
+    if (stats.trimmers.empty()) {
+        stats.trims = 0;
+        stats.trimmedBytes = 0;
+    }
+    stats.trimmers.insert(trimmer);
+}
+
+void MemoryBudget::removeTrimmer(MemoryTrimmer* trimmer)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (auto& p : m_pools)
+        p.second.trimmers.erase(trimmer);
+}
+
+void MemoryBudget::onTimeout()
+{
+    size_t rss = residentBytes();
+    if (!rss)
+        return;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_lastRssBytes = rss;
+
+    if (m_sinceTrimSecs < kTrimIntervalSecs) {
+        m_sinceTrimSecs++;
+        return;
+    }
+
+    uint32_t level = 0;
+    if (rss > m_budgetBytes / 100 * kCriticalWatermarkPct)
+        level = 2;
+    else if (rss > m_budgetBytes / 100 * kHighWatermarkPct)
+        level = 1;
+
+    if (!level)
+        return;
+
+    m_sinceTrimSecs = 0;
+
+    size_t released = 0;
+    for (auto& p : m_pools) {
+        if (p.second.trimmers.empty())
+            continue;
+
+        size_t bytes = 0;
+        for (auto trimmer : p.second.trimmers)
+            bytes += trimmer->onTrimMemory(level);
+        p.second.trims++;
+        p.second.trimmedBytes += bytes;
+        released += bytes;
+    }
+
+    ELOG_WARN("RSS %zuMB over %u%% of %zuMB budget, level-%u trim released %zuKB",
+        rss / (1024 * 1024), level == 2 ? kCriticalWatermarkPct : kHighWatermarkPct,
+        m_budgetBytes / (1024 * 1024), level, released / 1024);
+}
+
+std::string MemoryBudget::report()
+{
+    if (!enabled())
+        return "{\"enabled\":false}";
+
+    MemoryBudget& budget = instance();
+    boost::mutex::scoped_lock lock(budget.m_mutex);
+    return budget.reportLocked();
+}
+
+std::string MemoryBudget::reportLocked()
+{
+    std::ostringstream os;
+    os << "{\"enabled\":" << (m_budgetBytes ? "true" : "false")
+       << ",\"budgetBytes\":" << m_budgetBytes
+       << ",\"rssBytes\":" << m_lastRssBytes;
+    for (auto& p : m_pools) {
+        os << ",\"" << p.first << "\":{\"trims\":" << p.second.trims
+           << ",\"trimmedBytes\":" << p.second.trimmedBytes << "}";
+    }
+    os << "}";
+    return os.str();
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,93 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MemoryBudget_h
+#define MemoryBudget_h
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+
+#include <JobTimer.h>
+
+namespace owt_base {
+
+// Implemented by pools and caches that can give memory back under pressure.
+// Level 1 asks for idle reserves (shared free lists, cold cache entries);
+// level 2 means the process is close to its limit and everything reclaimable
+// should go, warm or not. Returns the bytes released, or 0 when the pool
+// cannot account for them. Called from the shared timer thread.
+class MemoryTrimmer {
+public:
+    virtual size_t onTrimMemory(uint32_t level) = 0;
+};
+
+/**
+ * Process-wide memory budget for the buffer pools. The pools individually
+ * bound their caches, but collectively they can still carry an agent past a
+ * container memory limit at peak and get it OOM-killed; this watches the
+ * process RSS against a budget and asks registered pools to trim before the
+ * kernel makes the choice, so agents degrade by shrinking caches instead of
+ * dying.
+ *
+ * Disabled unless OWT_MEMORY_BUDGET_MB is set: a number is the budget in MB
+ * (normally the container limit, from [memory_budget] in agent.toml), and
+ * "auto" reads the cgroup limit. RSS is sampled once a second; above 80% of
+ * the budget the pools get a level-1 trim, above 90% a level-2 trim, each
+ * repeated no more often than every few seconds so freed memory has a chance
+ * to leave the RSS before the next reading. Per-pool trim counts and bytes
+ * ride out through the addon stats surface next to the heap accounting (see
+ * InternalIn/InternalOut::getStats).
+ */
+class MemoryBudget : public JobTimerListener {
+    DECLARE_LOGGER();
+
+public:
+    static MemoryBudget& instance();
+    static bool enabled();
+
+    // Several registrants may share a name (one per converter instance, for
+    // example); their statistics aggregate under it.
+    void addTrimmer(const std::string& name, MemoryTrimmer* trimmer);
+    void removeTrimmer(MemoryTrimmer* trimmer);
+
+    // JSON snapshot: budget, last sampled RSS, and per-pool trim statistics.
+    // Safe to call when the budget is disabled; reports so without spinning
+    // up the sampler.
+    static std::string report();
+
+    // Implements JobTimerListener.
+    void onTimeout();
+
+private:
+    struct PoolStats {
+        std::set<MemoryTrimmer*> trimmers;
+        uint64_t trims;
+        uint64_t trimmedBytes;
+    };
+
+    MemoryBudget();
+
+    static size_t cgroupLimitBytes();
+    static size_t residentBytes();
+
+    std::string reportLocked();
+
+    size_t m_budgetBytes;
+    size_t m_lastRssBytes;
+    uint32_t m_sinceTrimSecs;
+
+    std::map<std::string, PoolStats> m_pools;
+    boost::mutex m_mutex;
+    boost::scoped_ptr<JobTimer> m_timer;
+};
+
+} /* namespace owt_base */
+#endif /* MemoryBudget_h */
@@ -6,7 +6,12 @@
 
 #include "MsdkBase.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <va/va.h>
 #include <va/va_drm.h>
 #include <vaapi_allocator.h>
@@ -19,6 +24,8 @@ boost::shared_mutex MsdkBase::sSingletonLock;
 MsdkBase *MsdkBase::sSingleton = NULL;
 std::vector<mfxU32> MsdkBase::sSupportedDecoders;
 std::vector<mfxU32> MsdkBase::sSupportedEncoders;
+bool MsdkBase::sPendingHevcEncoderGaccPlugin = false;
+uint32_t MsdkBase::sPendingMFETimeout = 0;
 
 static bool AreGuidsEqual(const mfxPluginUID *guid1, const mfxPluginUID *guid2)
 {
@@ -37,6 +44,115 @@ static bool isValidPluginUID(const mfxPluginUID *uid)
            );
 }
 
+/*
+ * Host-wide GPU session accounting, shared by every agent process that opens
+ * the device (videoMixer and videoTranscoder land on the same GPU). MFX
+ * sessions and a VADisplay are process-local - MFXJoinSession only joins
+ * sessions inside one process, and that join already happens in
+ * createSession() - so the cross-process piece is an accounting registry,
+ * not shared sessions: a small table in /dev/shm where each process claims
+ * a slot and keeps its live session count. Anyone on the host (including
+ * other agent processes via hostSessionCount()) can then size the GPU's
+ * total load as a single pool. Slots of dead processes are reclaimed by a
+ * pid liveness probe, so crashed agents do not leak capacity.
+ */
+class GpuSessionRegistry {
+public:
+    static GpuSessionRegistry& instance()
+    {
+        static GpuSessionRegistry registry;
+        return registry;
+    }
+
+    void adjust(int delta)
+    {
+        if (m_slot)
+            __sync_add_and_fetch(&m_slot->sessions, delta);
+    }
+
+    int hostSessionCount()
+    {
+        if (!m_table)
+            return -1;
+
+        int count = 0;
+        for (int i = 0; i < kSlots; i++) {
+            int32_t pid = m_table->slots[i].pid;
+            if (pid <= 0)
+                continue;
+            if (kill(pid, 0) != 0 && errno == ESRCH) {
+                // Reclaim the slot of a dead process.
+                if (__sync_bool_compare_and_swap(&m_table->slots[i].pid, pid, 0))
+                    m_table->slots[i].sessions = 0;
+                continue;
+            }
+            count += m_table->slots[i].sessions;
+        }
+        return count;
+    }
+
+private:
+    static const int kSlots = 64;
+
+    struct Slot {
+        int32_t pid;
+        int32_t sessions;
+    };
+
+    struct Table {
+        Slot slots[kSlots];
+    };
+
+    GpuSessionRegistry()
+        : m_table(NULL)
+        , m_slot(NULL)
+    {
+        // A plain file under /dev/shm rather than shm_open(), so no librt
+        // dependency on older glibc.
+        int fd = open("/dev/shm/owt-gpu-sessions", O_CREAT | O_RDWR, 0666);
+        if (fd < 0)
+            return;
+        // ftruncate on an already-sized segment is a no-op; zero-fill is
+        // guaranteed for the grow case, matching an unclaimed slot.
+        if (ftruncate(fd, sizeof(Table)) != 0) {
+            close(fd);
+            return;
+        }
+        void* map = mmap(NULL, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+            return;
+
+        m_table = reinterpret_cast<Table*>(map);
+
+        int32_t self = (int32_t)getpid();
+        for (int i = 0; i < kSlots; i++) {
+            int32_t pid = m_table->slots[i].pid;
+            if (pid > 0 && !(kill(pid, 0) != 0 && errno == ESRCH))
+                continue;
+            if (__sync_bool_compare_and_swap(&m_table->slots[i].pid, pid, self)) {
+                m_table->slots[i].sessions = 0;
+                m_slot = &m_table->slots[i];
+                return;
+            }
+        }
+        // Table full; run unaccounted rather than failing GPU bring-up.
+    }
+
+    ~GpuSessionRegistry()
+    {
+        if (m_slot) {
+            m_slot->sessions = 0;
+            m_slot->pid = 0;
+        }
+        if (m_table)
+            munmap(m_table, sizeof(Table));
+    }
+
+    Table* m_table;
+    Slot* m_slot;
+};
+
 MsdkBase::MsdkBase()
     : m_fd(-1)
     , m_vaDisp(NULL)
@@ -101,6 +217,7 @@ bool MsdkBase::init()
         m_fd = -1;
         return false;
     }
+    GpuSessionRegistry::instance().adjust(1);
 
     ELOG_INFO("MFX Version: %d, major(%d), minor(%d)", MFX_VERSION, MFX_VERSION_MAJOR, MFX_VERSION_MINOR);
 
@@ -191,6 +308,18 @@ MsdkBase::~MsdkBase()
 {
 }
 
+void MsdkBase::configure(bool hevcEncoderGaccPlugin, uint32_t MFETimeout)
+{
+    boost::unique_lock<boost::shared_mutex> lock(sSingletonLock);
+
+    sPendingHevcEncoderGaccPlugin = hevcEncoderGaccPlugin;
+    sPendingMFETimeout = MFETimeout;
+    if (sSingleton) {
+        sSingleton->m_configHevcEncoderGaccPlugin = hevcEncoderGaccPlugin;
+        sSingleton->m_configMFETimeout = MFETimeout;
+    }
+}
+
 MsdkBase *MsdkBase::get(void)
 {
     boost::upgrade_lock<boost::shared_mutex> lock(sSingletonLock);
@@ -205,6 +334,9 @@ MsdkBase *MsdkBase::get(void)
 
             delete sSingleton;
             sSingleton = NULL;
+        } else {
+            sSingleton->m_configHevcEncoderGaccPlugin = sPendingHevcEncoderGaccPlugin;
+            sSingleton->m_configMFETimeout = sPendingMFETimeout;
         }
     }
 
@@ -303,6 +435,8 @@ MFXVideoSession *MsdkBase::createSession()
         return NULL;
     }
 
+    GpuSessionRegistry::instance().adjust(1);
+    ELOG_DEBUG("Session created, %d live on this host", getHostSessionCount());
     return pSession;
 }
 
@@ -312,9 +446,15 @@ void MsdkBase::destroySession(MFXVideoSession *pSession)
         pSession->DisjoinSession();
         pSession->Close();
         delete pSession;
+        GpuSessionRegistry::instance().adjust(-1);
     }
 }
 
+int MsdkBase::getHostSessionCount()
+{
+    return GpuSessionRegistry::instance().hostSessionCount();
+}
+
 bool MsdkBase::loadDecoderPlugin(uint32_t codecId, MFXVideoSession *pSession, mfxPluginUID *pluginID)
 {
     mfxStatus sts = MFX_ERR_NONE;
@@ -33,6 +33,13 @@ public:
 
     static MsdkBase *get(void);
 
+    // Records agent-level configuration without instantiating the singleton.
+    // get() opens the DRM device and initializes VA plus the main MSDK
+    // session - seconds of work - so agents must not call it at startup just
+    // to push config; the values set here are applied when the first stream
+    // actually brings the GPU up.
+    static void configure(bool hevcEncoderGaccPlugin, uint32_t MFETimeout);
+
     bool isSupportedDecoder(mfxU32 codecId);
     bool isSupportedEncoder(mfxU32 codecId);
 
@@ -45,6 +52,13 @@ public:
     MFXVideoSession *createSession();
     void destroySession(MFXVideoSession *pSession);
 
+    // Live MFX sessions across every agent process on this host, from the
+    // shared-memory registry in MsdkBase.cpp; -1 when the registry could
+    // not be mapped. Sessions themselves stay process-local (MFXJoinSession
+    // cannot cross processes); this is the accounting that lets one GPU's
+    // capacity be sized as a single pool.
+    int getHostSessionCount();
+
     bool loadDecoderPlugin(uint32_t codecId, MFXVideoSession *pSession, mfxPluginUID *pluginID);
     bool loadEncoderPlugin(uint32_t codecId, MFXVideoSession *pSession, mfxPluginUID *pluginID);
     void unLoadPlugin(MFXVideoSession *pSession, mfxPluginUID *pluginID);
@@ -53,6 +67,7 @@ public:
     void destroyFrameAllocator(mfxFrameAllocator *pAlloc);
 
     MFXVideoSession *getMainSession() {return m_mainSession;};
+    void *getVaDisplay() {return m_vaDisp;};
 
     static void printfFrameInfo(mfxFrameInfo *pFrameInfo);
     static void printfVideoParam(mfxVideoParam *pVideoParam, DumpType type);
@@ -69,6 +84,8 @@ private:
     static boost::shared_mutex sSingletonLock;
     static std::vector<mfxU32> sSupportedDecoders;
     static std::vector<mfxU32> sSupportedEncoders;
+    static bool sPendingHevcEncoderGaccPlugin;
+    static uint32_t sPendingMFETimeout;
 
     int m_fd;
     void *m_vaDisp;
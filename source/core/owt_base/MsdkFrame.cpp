@@ -5,8 +5,13 @@
 #ifdef ENABLE_MSDK
 
 #include <malloc.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
 
 #include "FastCopy.h"
+#include "StagingBufferPool.h"
 
 #include "MsdkBase.h"
 #include "MsdkFrame.h"
@@ -400,9 +405,12 @@ bool MsdkFrame::nv12ConvertTo(mfxFrameInfo& pInfo, mfxFrameData& pData, webrtc::
     uint32_t h = getCropH();
 
     if (!m_nv12TBuffer.get()) {
-        m_nv12TBuffer.reset((uint8_t*) memalign(16, h * pData.Pitch * 3 / 2));
+        // Pinned, hugepage-backed staging: the readback streams a whole
+        // surface through this buffer, so page faults and 4KB TLB entries
+        // dominate a pageable allocation at 4K sizes.
+        m_nv12TBuffer = StagingBufferPool::instance().acquire(h * pData.Pitch * 3 / 2);
         if (!m_nv12TBuffer.get()) {
-            ELOG_ERROR("memalign failed, %p", m_nv12TBuffer.get());
+            ELOG_ERROR("staging buffer acquire failed");
 
             return false;
         }
@@ -415,8 +423,8 @@ bool MsdkFrame::nv12ConvertTo(mfxFrameInfo& pInfo, mfxFrameData& pData, webrtc::
     }
 
     boost::shared_ptr<uint8_t> uvPos(m_nv12TBuffer.get() + h * pData.Pitch, MockDelete());
-    memcpy_from_uswc_sse4(m_nv12TBuffer, pData.Y, h * pData.Pitch);
-    memcpy_from_uswc_sse4(uvPos, pData.UV, h * pData.Pitch / 2);
+    memcpy_from_uswc(m_nv12TBuffer, pData.Y, h * pData.Pitch);
+    memcpy_from_uswc(uvPos, pData.UV, h * pData.Pitch / 2);
 
     //uint32_t dstW, dstH;
     uint32_t dstStrideY, dstStrideU, dstStrideV;
@@ -526,7 +534,35 @@ bool MsdkFrame::convertTo(webrtc::I420Buffer *buffer)
 
 DEFINE_LOGGER(MsdkFramePool, "owt.MsdkFramePool");
 
+// Adaptive pool tuning: surfaces are added this many at a time under
+// starvation, and a fully idle chunk is released after this long.
+static const uint32_t kPoolGrowStep = 2;
+static const int64_t kPoolShrinkIdleMs = 10 * 1000;
+
+bool MsdkFramePool::adaptiveEnabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_MSDK_ADAPTIVE_SURFACES");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+int64_t MsdkFramePool::nowMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 MsdkFramePool::MsdkFramePool(const uint32_t width, const uint32_t height, const int32_t count, boost::shared_ptr<mfxFrameAllocator> allocator)
+    : m_adaptive(false)
+    , m_maxSurfaces(0)
+    , m_growCount(0)
+    , m_shrinkCount(0)
+    , m_starveCount(0)
+    , m_peakBusy(0)
 {
     for (int i = 0; i < count; i++) {
         boost::shared_ptr<MsdkFrame> frame(new MsdkFrame(width, height, allocator));
@@ -537,11 +573,31 @@ MsdkFramePool::MsdkFramePool(const uint32_t width, const uint32_t height, const
     }
 }
 
-MsdkFramePool::MsdkFramePool(mfxFrameAllocRequest &request, boost::shared_ptr<mfxFrameAllocator> allocator)
+MsdkFramePool::MsdkFramePool(mfxFrameAllocRequest &request, boost::shared_ptr<mfxFrameAllocator> allocator, bool adaptive)
     : m_allocator(allocator)
+    , m_adaptive(adaptive)
+    , m_request(request)
+    , m_maxSurfaces(request.NumFrameSuggested)
+    , m_growCount(0)
+    , m_shrinkCount(0)
+    , m_starveCount(0)
+    , m_peakBusy(0)
 {
     mfxStatus sts = MFX_ERR_NONE;
 
+    memset(&m_response, 0, sizeof(m_response));
+
+    if (m_adaptive) {
+        // Start at the codec's minimum and let demand pull the pool up to
+        // the suggested worst case; m_growCount counts the initial chunk.
+        uint32_t initial = request.NumFrameMin > 0 ? request.NumFrameMin : 1;
+        if (initial > m_maxSurfaces)
+            m_maxSurfaces = initial;
+        if (!growPool(initial))
+            ELOG_ERROR("Initial surface chunk allocation failed");
+        return;
+    }
+
     sts = m_allocator->Alloc(m_allocator->pthis, &request, &m_response);
     if (sts != MFX_ERR_NONE) {
         memset(&m_response, 0, sizeof(m_response));
@@ -569,18 +625,136 @@ MsdkFramePool::~MsdkFramePool()
             ELOG_ERROR("mfxFrameAllocator Free() failed, ret %d", sts);
         }
     }
+
+    for (auto& chunk : m_chunks) {
+        chunk.frames.clear();
+        if (m_allocator)
+            m_allocator->Free(m_allocator->pthis, &chunk.response);
+    }
+    m_chunks.clear();
+
+    if (m_adaptive) {
+        ELOG_DEBUG("Adaptive pool: peak %d surface(s) in flight, %d grow(s), %d shrink(s), %d starvation(s)"
+                , m_peakBusy, m_growCount, m_shrinkCount, m_starveCount);
+    }
+}
+
+bool MsdkFramePool::growPool(uint32_t count)
+{
+    mfxFrameAllocRequest request = m_request;
+    mfxStatus sts = MFX_ERR_NONE;
+    Chunk chunk;
+
+    request.NumFrameMin = count;
+    request.NumFrameSuggested = count;
+
+    memset(&chunk.response, 0, sizeof(chunk.response));
+    sts = m_allocator->Alloc(m_allocator->pthis, &request, &chunk.response);
+    if (sts != MFX_ERR_NONE) {
+        ELOG_WARN("Grow pool failed, ret %d", sts);
+        return false;
+    }
+
+    for (int i = 0; i < chunk.response.NumFrameActual; i++) {
+        boost::shared_ptr<MsdkFrame> frame(new MsdkFrame(m_request.Info, chunk.response.mids[i], m_allocator));
+        if (!frame->init()) {
+            continue;
+        }
+        chunk.frames.push_back(frame);
+    }
+    chunk.lastBusyMs = nowMs();
+
+    ELOG_DEBUG("Grow pool, +%d surface(s)", chunk.response.NumFrameActual);
+
+    m_chunks.push_back(chunk);
+    m_growCount++;
+    return true;
+}
+
+void MsdkFramePool::shrinkPool(int64_t nowMs)
+{
+    auto it = m_chunks.begin();
+    if (it == m_chunks.end())
+        return;
+
+    // The initial chunk carries the codec minimum and always stays.
+    ++it;
+    while (it != m_chunks.end()) {
+        bool idle = (nowMs - it->lastBusyMs > kPoolShrinkIdleMs);
+
+        for (auto& frame : it->frames) {
+            if (frame.use_count() != 1 || !frame->isFree()) {
+                idle = false;
+                break;
+            }
+        }
+
+        if (idle) {
+            ELOG_DEBUG("Shrink pool, -%d surface(s)", it->response.NumFrameActual);
+
+            it->frames.clear();
+            m_allocator->Free(m_allocator->pthis, &it->response);
+            it = m_chunks.erase(it);
+            m_shrinkCount++;
+        } else {
+            ++it;
+        }
+    }
 }
 
 boost::shared_ptr<MsdkFrame> MsdkFramePool::getFreeFrame()
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
-    for (auto& it : m_framePool) {
-        if(it.use_count() == 1 && it->isFree()) {
-            return it;
+    if (!m_adaptive) {
+        for (auto& it : m_framePool) {
+            if(it.use_count() == 1 && it->isFree()) {
+                return it;
+            }
+        }
+
+        return NULL;
+    }
+
+    int64_t now = nowMs();
+    uint32_t busy = 0;
+    boost::shared_ptr<MsdkFrame> freeFrame;
+
+    for (auto& chunk : m_chunks) {
+        bool chunkBusy = false;
+
+        for (auto& it : chunk.frames) {
+            if (it.use_count() == 1 && it->isFree()) {
+                if (!freeFrame)
+                    freeFrame = it;
+            } else {
+                busy++;
+                chunkBusy = true;
+            }
         }
+        if (chunkBusy)
+            chunk.lastBusyMs = now;
     }
+    if (busy > m_peakBusy)
+        m_peakBusy = busy;
 
+    if (freeFrame) {
+        // Our local reference keeps freeFrame's chunk busy in the scan
+        // below, so a shrink can never free the frame just handed out.
+        shrinkPool(now);
+        return freeFrame;
+    }
+
+    if (busy < m_maxSurfaces
+        && growPool(std::min(kPoolGrowStep, m_maxSurfaces - busy))) {
+        for (auto& it : m_chunks.back().frames) {
+            if (it.use_count() == 1 && it->isFree()) {
+                return it;
+            }
+        }
+    }
+
+    m_starveCount++;
     return NULL;
 }
 
@@ -594,6 +768,14 @@ boost::shared_ptr<MsdkFrame> MsdkFramePool::getFrame(mfxFrameSurface1 *pSurface)
         }
     }
 
+    for (auto& chunk : m_chunks) {
+        for (auto& it : chunk.frames) {
+            if(pSurface == it->getSurface()) {
+                return it;
+            }
+        }
+    }
+
     return NULL;
 }
 
@@ -608,6 +790,14 @@ void MsdkFramePool::dumpInfo()
                 , i, it.use_count(), it->isFree());
         i++;
     }
+
+    for (auto& chunk : m_chunks) {
+        for (auto& it : chunk.frames) {
+            ELOG_DEBUG("Frame(%d), use_count(%ld), isFree(%d)"
+                    , i, it.use_count(), it->isFree());
+            i++;
+        }
+    }
 }
 
 }//namespace owt_base
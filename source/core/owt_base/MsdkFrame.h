@@ -96,20 +96,52 @@ class MsdkFramePool {
 
 public:
     MsdkFramePool(const uint32_t width, const uint32_t height, const int32_t count, boost::shared_ptr<mfxFrameAllocator> allocator);
-    MsdkFramePool(mfxFrameAllocRequest &request, boost::shared_ptr<mfxFrameAllocator> allocator);
+    MsdkFramePool(mfxFrameAllocRequest &request, boost::shared_ptr<mfxFrameAllocator> allocator, bool adaptive = false);
 
     ~MsdkFramePool();
 
     boost::shared_ptr<MsdkFrame> getFreeFrame();
     boost::shared_ptr<MsdkFrame> getFrame(mfxFrameSurface1 *pSurface);
 
+    // Surface memory limits session density on dense GPU nodes before
+    // compute does; an adaptive pool (OWT_MSDK_ADAPTIVE_SURFACES=1) starts
+    // at the codec's minimum and grows/shrinks in chunks with the observed
+    // in-flight depth instead of holding worst case for the whole session.
+    static bool adaptiveEnabled();
+
     void dumpInfo();
 
 private:
+    // Both only called with m_mutex held.
+    bool growPool(uint32_t count);
+    void shrinkPool(int64_t nowMs);
+
+    static int64_t nowMs();
+
     boost::shared_ptr<mfxFrameAllocator> m_allocator;
     mfxFrameAllocResponse m_response;
 
     std::list<boost::shared_ptr<MsdkFrame>> m_framePool;
+
+    // Adaptive mode bookkeeping; each chunk is one allocator response and
+    // can only be released as a whole once every surface in it sat idle
+    // long enough. The initial chunk is never released.
+    struct Chunk {
+        mfxFrameAllocResponse response;
+        std::list<boost::shared_ptr<MsdkFrame>> frames;
+        int64_t lastBusyMs;
+    };
+    bool m_adaptive;
+    mfxFrameAllocRequest m_request;
+    uint32_t m_maxSurfaces;
+    std::list<Chunk> m_chunks;
+
+    // Pool pressure counters, summarized at teardown.
+    uint32_t m_growCount;
+    uint32_t m_shrinkCount;
+    uint32_t m_starveCount;
+    uint32_t m_peakBusy;
+
     boost::shared_mutex m_mutex;
 };
 
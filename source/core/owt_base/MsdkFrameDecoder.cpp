@@ -62,6 +62,7 @@ MsdkFrameDecoder::~MsdkFrameDecoder()
     m_framePool.reset();
 
     m_timeStamps.clear();
+    m_ingestTimes.clear();
 
     if (m_bsDumpfp) {
         fclose(m_bsDumpfp);
@@ -121,7 +122,10 @@ bool MsdkFrameDecoder::allocateFrames(void)
 
     ELOG_TRACE_T("mfx QueryIOSurf: Suggested(%d), Min(%d)", Request.NumFrameSuggested, Request.NumFrameMin);
 
-    m_framePool.reset(new MsdkFramePool(Request, m_allocator));
+    // An adaptive pool starts at the codec minimum and grows toward the
+    // suggested depth only under real in-flight demand, so dense GPU nodes
+    // are not capped by worst-case surface memory.
+    m_framePool.reset(new MsdkFramePool(Request, m_allocator, MsdkFramePool::adaptiveEnabled()));
     return true;
 }
 
@@ -400,6 +404,10 @@ retry:
         } else {
             ELOG_ERROR_T("No timeStamp available in queue");
         }
+        if (m_ingestTimes.size() > 0) {
+            frame.ingestTimeMs = m_ingestTimes.front();
+            m_ingestTimes.pop_front();
+        }
 
         deliverFrame(frame);
     }
@@ -481,11 +489,13 @@ void MsdkFrameDecoder::onFrame(const Frame& frame)
 retry:
     if (m_ready || decHeader(m_bitstream.get())) {
         m_timeStamps.push_back(frame.timeStamp);
+        m_ingestTimes.push_back(frame.ingestTimeMs);
         decFrame(m_bitstream.get());
 
         // if decFrame reset, retry decHeader w/ current bs (most likely SPS) and continuely decFrame
         if (!m_ready) {
             m_timeStamps.clear();
+            m_ingestTimes.clear();
             goto retry;
         }
     }
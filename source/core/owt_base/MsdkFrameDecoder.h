@@ -51,6 +51,9 @@ private:
     MFXVideoDECODE *m_dec;
 
     std::deque<uint32_t> m_timeStamps;
+    // Ingest stamps ride the same queue discipline as the timestamps, so a
+    // decode latency of N frames still pairs each output with its input.
+    std::deque<int64_t> m_ingestTimes;
 
     boost::shared_ptr<mfxFrameAllocator> m_allocator;
 
@@ -4,17 +4,21 @@
 
 #ifdef ENABLE_MSDK
 
+#include <atomic>
 #include <boost/make_shared.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 
+#include "HeapAccounting.h"
 #include "MediaUtilities.h"
+#include "PayloadBuffer.h"
 
 #include "MsdkBase.h"
 #include "MsdkFrameEncoder.h"
 #include "MsdkScaler.h"
+#include "PipelineTracer.h"
 #include <JobTimer.h>
 
 #define _MAX_BITSTREAM_BUFFER_ (100 * 1024 * 1024)
@@ -25,6 +29,16 @@ namespace owt_base {
 
 DEFINE_LOGGER(MsdkFrameEncoder, "owt.MsdkFrameEncoder");
 
+static bool ltrRecoveryEnabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_H264_LTR");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
 class StreamEncoder : public FrameSource, public JobTimerListener
 {
     DECLARE_LOGGER()
@@ -36,13 +50,29 @@ class StreamEncoder : public FrameSource, public JobTimerListener
         mfxSyncPoint syncp;
     } bsBufferSync_t;
 
-    const uint8_t NumOfAsyncEnc = 3;
+    // Depth of the encode pipeline: EncodeFrameAsync submissions allowed in
+    // flight before a SyncOperation must complete. The bitstream pool starts
+    // at this size and can grow to twice it when the drain thread lags.
+    const uint8_t NumOfAsyncEnc = 4;
+
+    // LTR-based loss recovery (H.264 with OWT_H264_LTR=1): a long-term
+    // reference is pinned every LtrMarkIntervalFrames, and a key frame
+    // request from a running subscriber is answered with a P-frame
+    // referencing it, a fraction of the size of an IDR at high resolutions.
+    // Escalates to a real IDR when the reference is younger than the
+    // round-trip, older than the window, or a recovery evidently failed
+    // (another request inside the escalate window).
+    const uint32_t LtrMarkIntervalFrames = 30;
+    const uint32_t LtrMinAgeFrames = 5;
+    const uint32_t LtrMaxAgeFrames = 300;
+    const uint32_t LtrEscalateWindowFrames = 60;
 
 public:
     StreamEncoder()
         : m_mode(ENCODER_MODE_NORMAL)
         , m_ready(false)
         , m_frameCount(0)
+        , m_lastIngestMs(0)
         , m_format(FRAME_FORMAT_UNKNOWN)
         , m_profile(PROFILE_UNKNOWN)
         , m_width(0)
@@ -51,8 +81,15 @@ public:
         , m_dest(NULL)
         , m_setBitRateFlag(false)
         , m_requestKeyFrameFlag(false)
+        , m_ltrEnabled(false)
+        , m_frameOrder(0)
+        , m_ltrFrameOrder(-1)
+        , m_lastLtrRecoveryOrder(-1)
+        , m_roiWidth(0)
+        , m_roiHeight(0)
         , m_encSession(NULL)
         , m_enc(NULL)
+        , m_bitstreamBufferSize(0)
         , m_pluginID()
         , m_lastWidth(0)
         , m_lastHeight(0)
@@ -176,6 +213,7 @@ public:
 
                 m_encParam->mfx.CodecId         = MFX_CODEC_AVC;
                 m_encParam->mfx.CodecProfile    = m_profile;
+                m_ltrEnabled                    = ltrRecoveryEnabled();
                 break;
             case FRAME_FORMAT_H265:
                 if (m_profile != PROFILE_UNKNOWN) {
@@ -282,6 +320,10 @@ public:
         m_enc->GetVideoParam(m_encParam.get());
         MsdkBase::printfVideoParam(m_encParam.get(), MFX_ENC);
 
+        // A reset drops encoder reference state, the old long-term frame can
+        // no longer be named.
+        m_ltrFrameOrder = -1;
+
         m_ready = true;
     }
 
@@ -323,6 +365,7 @@ public:
         }
 
         boost::shared_ptr<MsdkFrame> inFrame = convert(frame);
+        m_lastIngestMs.store(frame.ingestTimeMs, std::memory_order_relaxed);
 
         if (m_setBitRateFlag) {
             ELOG_DEBUG("(%p)Do set bitrate!", this);
@@ -336,13 +379,59 @@ public:
             ELOG_DEBUG("(%p)Do requeset key frame!", this);
 
             ctrl.reset(new mfxEncodeCtrl);
-
             memset(ctrl.get(), 0, sizeof(mfxEncodeCtrl));
-            ctrl->FrameType = MFX_FRAMETYPE_I | MFX_FRAMETYPE_IDR | MFX_FRAMETYPE_REF;
+
+            bool ltrUsable = m_ltrEnabled
+                && m_ltrFrameOrder >= 0
+                && (int64_t)m_frameOrder - m_ltrFrameOrder >= LtrMinAgeFrames
+                && (int64_t)m_frameOrder - m_ltrFrameOrder <= LtrMaxAgeFrames
+                && (m_lastLtrRecoveryOrder < 0
+                    || (int64_t)m_frameOrder - m_lastLtrRecoveryOrder > LtrEscalateWindowFrames);
+
+            if (ltrUsable) {
+                ELOG_DEBUG("(%p)Recover via LTR, frame %d references %ld", this, m_frameOrder, m_ltrFrameOrder);
+
+                resetRefListCtrl();
+                m_refListCtrl.PreferredRefList[0].FrameOrder = (mfxU32)m_ltrFrameOrder;
+                m_refListCtrl.PreferredRefList[0].PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+
+                m_ctrlExtParam[0] = (mfxExtBuffer *)&m_refListCtrl;
+                ctrl->ExtParam = m_ctrlExtParam;
+                ctrl->NumExtParam = 1;
+
+                m_lastLtrRecoveryOrder = m_frameOrder;
+            } else {
+                ctrl->FrameType = MFX_FRAMETYPE_I | MFX_FRAMETYPE_IDR | MFX_FRAMETYPE_REF;
+
+                // The IDR clears the receiver's reference buffer, previously
+                // marked long-term frames are gone with it.
+                m_ltrFrameOrder = -1;
+            }
 
             m_requestKeyFrameFlag = false;
+        } else if (m_ltrEnabled
+                   && (m_ltrFrameOrder < 0 || m_frameOrder - m_ltrFrameOrder >= LtrMarkIntervalFrames)) {
+            ELOG_TRACE("(%p)Mark frame %d as LTR", this, m_frameOrder);
+
+            ctrl.reset(new mfxEncodeCtrl);
+            memset(ctrl.get(), 0, sizeof(mfxEncodeCtrl));
+
+            resetRefListCtrl();
+            m_refListCtrl.LongTermRefList[0].FrameOrder = m_frameOrder;
+            m_refListCtrl.LongTermRefList[0].PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+
+            m_ctrlExtParam[0] = (mfxExtBuffer *)&m_refListCtrl;
+            ctrl->ExtParam = m_ctrlExtParam;
+            ctrl->NumExtParam = 1;
+
+            m_ltrFrameOrder = m_frameOrder;
         }
 
+        attachRoiCtrl(ctrl);
+
+        if (PipelineTracer::enabled())
+            PipelineTracer::instance().instant("video", "msdk_encode_submit", frame.timeStamp);
+
 retry:
         sts = m_enc->EncodeFrameAsync(ctrl.get(), inFrame->getSurface(), bsBuffer.get(), &syncp);
         if (sts == MFX_WRN_DEVICE_BUSY) {
@@ -368,6 +457,7 @@ retry:
                     , newSize
                     );
 
+            HeapAccounting::add(HeapAccounting::kEncoder, newSize - bsBuffer->MaxLength);
             bsBuffer->Data         = (mfxU8 *)realloc(bsBuffer->Data, newSize);
             bsBuffer->MaxLength    = newSize;
 
@@ -378,6 +468,10 @@ retry:
             return;
         }
 
+        // Track the display-order counter the encoder assigns internally so
+        // the ref list controls above can name frames by FrameOrder.
+        m_frameOrder++;
+
         boost::shared_ptr<bsBufferSync_t> bsBufferSync(new bsBufferSync_t);
         bsBufferSync->bsBuffer = bsBuffer;
         bsBufferSync->syncp = syncp;
@@ -400,7 +494,100 @@ retry:
         m_requestKeyFrameFlag = true;
     }
 
+    void setRoiRegions(const std::vector<owt_base::RoiRegion>& regions, uint32_t width, uint32_t height)
+    {
+        boost::lock_guard<boost::mutex> guard(m_roiMutex);
+
+        m_roiRegions = regions;
+        m_roiWidth = width;
+        m_roiHeight = height;
+    }
+
 protected:
+    void resetRefListCtrl()
+    {
+        memset(&m_refListCtrl, 0, sizeof(m_refListCtrl));
+        m_refListCtrl.Header.BufferId = MFX_EXTBUFF_AVC_REFLIST_CTRL;
+        m_refListCtrl.Header.BufferSz = sizeof(m_refListCtrl);
+
+        // Unused entries must carry the unknown marker, zero names frame 0.
+        for (size_t i = 0; i < sizeof(m_refListCtrl.PreferredRefList) / sizeof(m_refListCtrl.PreferredRefList[0]); ++i)
+            m_refListCtrl.PreferredRefList[i].FrameOrder = MFX_FRAMEORDER_UNKNOWN;
+        for (size_t i = 0; i < sizeof(m_refListCtrl.RejectedRefList) / sizeof(m_refListCtrl.RejectedRefList[0]); ++i)
+            m_refListCtrl.RejectedRefList[i].FrameOrder = MFX_FRAMEORDER_UNKNOWN;
+        for (size_t i = 0; i < sizeof(m_refListCtrl.LongTermRefList) / sizeof(m_refListCtrl.LongTermRefList[0]); ++i)
+            m_refListCtrl.LongTermRefList[i].FrameOrder = MFX_FRAMEORDER_UNKNOWN;
+    }
+
+    // Attaches the analytics ROI hints to this frame's encode control as an
+    // mfxExtEncoderROI, scaled from the hint space to the encode dimensions
+    // with the rectangles pinned to the 16-sample grid the API requires.
+    // AVC/HEVC only; the other codecs have no ROI support here.
+    void attachRoiCtrl(boost::scoped_ptr<mfxEncodeCtrl>& ctrl)
+    {
+        if (m_format != FRAME_FORMAT_H264 && m_format != FRAME_FORMAT_H265)
+            return;
+
+        boost::lock_guard<boost::mutex> guard(m_roiMutex);
+
+        if (m_roiRegions.empty() || !m_roiWidth || !m_roiHeight)
+            return;
+
+        memset(&m_roiCtrl, 0, sizeof(m_roiCtrl));
+        m_roiCtrl.Header.BufferId = MFX_EXTBUFF_ENCODER_ROI;
+        m_roiCtrl.Header.BufferSz = sizeof(m_roiCtrl);
+#if (MFX_VERSION >= 1022)
+        m_roiCtrl.ROIMode = MFX_ROI_MODE_QP_DELTA;
+#endif
+
+        size_t maxRois = sizeof(m_roiCtrl.ROI) / sizeof(m_roiCtrl.ROI[0]);
+        mfxU16 num = 0;
+        for (size_t i = 0; i < m_roiRegions.size() && num < maxRois; i++) {
+            const RoiRegion& r = m_roiRegions[i];
+
+            mfxU32 left   = ((mfxU32)r.x * m_width / m_roiWidth) & ~15;
+            mfxU32 top    = ((mfxU32)r.y * m_height / m_roiHeight) & ~15;
+            mfxU32 right  = ((((mfxU32)r.x + r.width) * m_width / m_roiWidth) + 15) & ~15;
+            mfxU32 bottom = ((((mfxU32)r.y + r.height) * m_height / m_roiHeight) + 15) & ~15;
+            if (right > (mfxU32)ALIGN16(m_width))
+                right = ALIGN16(m_width);
+            if (bottom > (mfxU32)ALIGN16(m_height))
+                bottom = ALIGN16(m_height);
+            if (left >= right || top >= bottom)
+                continue;
+
+            m_roiCtrl.ROI[num].Left   = left;
+            m_roiCtrl.ROI[num].Top    = top;
+            m_roiCtrl.ROI[num].Right  = right;
+            m_roiCtrl.ROI[num].Bottom = bottom;
+#if (MFX_VERSION >= 1022)
+            m_roiCtrl.ROI[num].DeltaQP = r.qpOffset;
+#else
+            // Older dispatchers only take a priority in [-3, 3], positive
+            // meaning better quality; fold the offset into that range.
+            int priority = -r.qpOffset;
+            if (priority > 3)
+                priority = 3;
+            else if (priority < -3)
+                priority = -3;
+            m_roiCtrl.ROI[num].Priority = priority;
+#endif
+            num++;
+        }
+
+        m_roiCtrl.NumROI = num;
+        if (!num)
+            return;
+
+        if (!ctrl) {
+            ctrl.reset(new mfxEncodeCtrl);
+            memset(ctrl.get(), 0, sizeof(mfxEncodeCtrl));
+        }
+        m_ctrlExtParam[ctrl->NumExtParam] = (mfxExtBuffer *)&m_roiCtrl;
+        ctrl->ExtParam = m_ctrlExtParam;
+        ctrl->NumExtParam++;
+    }
+
     boost::shared_ptr<MsdkFrame> convert(const owt_base::Frame& frame)
     {
         MsdkFrameHolder *holder = (MsdkFrameHolder *)frame.payload;
@@ -448,7 +635,9 @@ protected:
         m_encParam->mfx.FrameInfo.CropH           = 0;
 
         // mfxVideoParam Common
-        m_encParam->AsyncDepth                    = 1;
+        // Match the bitstream pool so submissions queue up in the GPU
+        // instead of serializing on each sync point.
+        m_encParam->AsyncDepth                    = NumOfAsyncEnc;
         m_encParam->IOPattern                     = MFX_IOPATTERN_IN_VIDEO_MEMORY;
 
         // mfx
@@ -642,22 +831,31 @@ protected:
 
     void initBitstreamBuffers(uint32_t bufferSize)
     {
+        m_bitstreamBufferSize = bufferSize;
         m_bitstreamBuffers.resize(NumOfAsyncEnc);
         for (auto& bsBuffer : m_bitstreamBuffers) {
-            bsBuffer.reset(new mfxBitstream);
-            memset((void *)bsBuffer.get(), 0, sizeof(mfxBitstream));
-
-            bsBuffer->Data         = (mfxU8 *)malloc(bufferSize);
-            bsBuffer->MaxLength    = bufferSize;
-            bsBuffer->DataOffset   = 0;
-            bsBuffer->DataLength   = 0;
+            bsBuffer = allocBitstreamBuffer();
         }
     }
 
+    boost::shared_ptr<mfxBitstream> allocBitstreamBuffer()
+    {
+        boost::shared_ptr<mfxBitstream> bsBuffer(new mfxBitstream);
+        memset((void *)bsBuffer.get(), 0, sizeof(mfxBitstream));
+
+        HeapAccounting::add(HeapAccounting::kEncoder, m_bitstreamBufferSize);
+        bsBuffer->Data         = (mfxU8 *)malloc(m_bitstreamBufferSize);
+        bsBuffer->MaxLength    = m_bitstreamBufferSize;
+        bsBuffer->DataOffset   = 0;
+        bsBuffer->DataLength   = 0;
+        return bsBuffer;
+    }
+
     void deinitBitstreamBuffers()
     {
         for (auto& bsBuffer : m_bitstreamBuffers) {
             if (bsBuffer && bsBuffer->Data) {
+                HeapAccounting::sub(HeapAccounting::kEncoder, bsBuffer->MaxLength);
                 free(bsBuffer->Data);
                 bsBuffer->Data = NULL;
             }
@@ -672,6 +870,15 @@ protected:
                 return bsBuffer;
             }
         }
+
+        // All buffers are in flight behind the drain thread; grow the pool
+        // (bounded) rather than dropping the frame.
+        if (m_bitstreamBuffers.size() < (size_t)(2 * NumOfAsyncEnc)) {
+            boost::shared_ptr<mfxBitstream> bsBuffer = allocBitstreamBuffer();
+            m_bitstreamBuffers.push_back(bsBuffer);
+            ELOG_DEBUG("(%p)Grow bitstream buffer pool to %zu", this, m_bitstreamBuffers.size());
+            return bsBuffer;
+        }
         return NULL;
     }
 
@@ -686,6 +893,8 @@ protected:
         mfxSyncPoint syncp = bsBufferSync->syncp;
         boost::shared_ptr<mfxBitstream> bsBuffer = bsBufferSync->bsBuffer;
 
+        int64_t syncStartUs = PipelineTracer::enabled() ? PipelineTracer::nowUs() : 0;
+
         sts = m_encSession->SyncOperation(syncp, MFX_INFINITE);
         if(sts != MFX_ERR_NONE) {
             ELOG_ERROR("(%p)SyncOperation failed, ret %d", this, sts);
@@ -706,12 +915,21 @@ protected:
         Frame outFrame;
         memset(&outFrame, 0, sizeof(outFrame));
         outFrame.format = m_format;
-        outFrame.payload = bsBuffer->Data + bsBuffer->DataOffset;
+        // One copy into a pooled refcounted buffer: the mfxBitstream goes
+        // back to the encode pool right away, and consumers that queue the
+        // frame retain the shared payload instead of copying it again.
+        PayloadBuffer* payload = PayloadBuffer::create(bsBuffer->DataLength);
+        memcpy(payload->data(), bsBuffer->Data + bsBuffer->DataOffset, bsBuffer->DataLength);
+        attachPayloadBuffer(outFrame, payload);
         outFrame.length = bsBuffer->DataLength;
         outFrame.additionalInfo.video.width = m_width;
         outFrame.additionalInfo.video.height = m_height;
         outFrame.additionalInfo.video.isKeyFrame = isKeyFrame(bsBuffer->FrameType);
         outFrame.timeStamp = (m_frameCount++) * 1000 / m_frameRate * 90;
+        outFrame.ingestTimeMs = m_lastIngestMs.load(std::memory_order_relaxed);
+
+        if (syncStartUs)
+            PipelineTracer::instance().complete("video", "msdk_encode_sync", syncStartUs, outFrame.timeStamp);
 
         ELOG_TRACE_T("deliverFrame, %s, %dx%d(%s), length(%d)",
                 getFormatStr(outFrame.format),
@@ -723,6 +941,7 @@ protected:
         dump(outFrame.payload, outFrame.length);
 
         deliverFrame(outFrame);
+        payload->release();
 
         bsBuffer->DataOffset   = 0;
         bsBuffer->DataLength   = 0;
@@ -733,6 +952,9 @@ private:
     bool m_ready;
     //format
     uint32_t m_frameCount;
+    // Ingest stamp of the last submitted picture; syncFrame runs on the
+    // sync worker and copies it onto the bitstream frame.
+    std::atomic<int64_t> m_lastIngestMs;
 
     FrameFormat m_format;
     VideoCodecProfile m_profile;
@@ -746,6 +968,21 @@ private:
     bool m_setBitRateFlag;
     bool m_requestKeyFrameFlag;
 
+    //ltr recovery
+    bool m_ltrEnabled;
+    uint32_t m_frameOrder;
+    int64_t m_ltrFrameOrder;
+    int64_t m_lastLtrRecoveryOrder;
+    mfxExtAVCRefListCtrl m_refListCtrl;
+    mfxExtBuffer *m_ctrlExtParam[2];
+
+    //roi hints
+    std::vector<owt_base::RoiRegion> m_roiRegions;
+    uint32_t m_roiWidth;
+    uint32_t m_roiHeight;
+    boost::mutex m_roiMutex;
+    mfxExtEncoderROI m_roiCtrl;
+
     //encoder
     MFXVideoSession *m_encSession;
     MFXVideoENCODE *m_enc;
@@ -765,6 +1002,7 @@ private:
     boost::scoped_ptr<mfxExtMultiFrameControl> m_encExtMultiFrameControl;
 #endif
 
+    uint32_t m_bitstreamBufferSize;
     std::vector<boost::shared_ptr<mfxBitstream>> m_bitstreamBuffers;
     mfxPluginUID m_pluginID;
 
@@ -895,6 +1133,17 @@ void MsdkFrameEncoder::requestKeyFrame(int id)
     }
 }
 
+void MsdkFrameEncoder::setRoiRegions(const std::vector<RoiRegion>& regions, uint32_t width, uint32_t height)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    ELOG_TRACE("setRoiRegions, %ld regions in %dx%d", regions.size(), width, height);
+
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+        it->second->setRoiRegions(regions, width, height);
+    }
+}
+
 void MsdkFrameEncoder::onFrame(const Frame& frame)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
@@ -39,6 +39,7 @@ public:
     void onFrame(const Frame&);
     void setBitrate(unsigned short kbps, int id = 0);
     void requestKeyFrame(int id = 0);
+    void setRoiRegions(const std::vector<RoiRegion>& regions, uint32_t width, uint32_t height) override;
 
 private:
     FrameFormat m_encodeFormat;
@@ -10,6 +10,8 @@ namespace owt_base {
 DEFINE_LOGGER(MsdkScaler, "owt.MsdkScaler");
 
 MsdkScaler::MsdkScaler()
+    : m_session(NULL)
+    , m_vpp(NULL)
 {
     initVppParam();
     createVpp();
@@ -23,6 +25,10 @@ MsdkScaler::~MsdkScaler()
 bool MsdkScaler::createVpp()
 {
     mfxStatus sts = MFX_ERR_NONE;
+    VppContext context;
+
+    context.session = NULL;
+    context.vpp = NULL;
 
     MsdkBase *msdkBase = MsdkBase::get();
     if(msdkBase == NULL) {
@@ -30,71 +36,97 @@ bool MsdkScaler::createVpp()
         return false;
     }
 
-    m_session = msdkBase->createSession();
-    if (!m_session ) {
+    context.session = msdkBase->createSession();
+    if (!context.session) {
         ELOG_ERROR("(%p)Create session failed.", this);
-
-        destroyVpp();
         return false;
     }
 
-    m_allocator = msdkBase->createFrameAllocator();
-    if (!m_allocator) {
+    context.allocator = msdkBase->createFrameAllocator();
+    if (!context.allocator) {
         ELOG_ERROR("(%p)Create frame allocator failed.", this);
 
-        destroyVpp();
+        destroyContext(context);
         return false;
     }
 
-    sts = m_session->SetFrameAllocator(m_allocator.get());
+    sts = context.session->SetFrameAllocator(context.allocator.get());
     if (sts != MFX_ERR_NONE) {
         ELOG_ERROR("(%p)Set frame allocator failed.", this);
 
-        destroyVpp();
+        destroyContext(context);
         return false;
     }
 
-    m_vpp = new MFXVideoVPP(*m_session);
-    if (!m_vpp) {
+    context.vpp = new MFXVideoVPP(*context.session);
+    if (!context.vpp) {
         ELOG_ERROR("(%p)Create vpp failed.", this);
 
-        destroyVpp();
+        destroyContext(context);
         return false;
     }
 
-    sts = m_vpp->Init(m_vppParam.get());
+    context.param = m_vppParam;
+
+    sts = context.vpp->Init(context.param.get());
     if (sts > 0) {
         ELOG_TRACE("(%p)Ignore mfx warning, ret %d", this, sts);
     }
     else if (sts != MFX_ERR_NONE) {
         ELOG_ERROR("(%p)mfx init failed, ret %d", this, sts);
 
-        MsdkBase::printfVideoParam(m_vppParam.get(), MFX_VPP);
+        MsdkBase::printfVideoParam(context.param.get(), MFX_VPP);
 
-        destroyVpp();
+        destroyContext(context);
         return false;
     }
 
-    MsdkBase::printfVideoParam(m_vppParam.get(), MFX_VPP);
+    MsdkBase::printfVideoParam(context.param.get(), MFX_VPP);
+
+    m_contexts.push_front(context);
+    m_session = context.session;
+    m_vpp = context.vpp;
+    m_allocator = context.allocator;
+    m_vppParam = context.param;
+
+    // Cap the pool; the least recently used geometry gets torn down.
+    while (m_contexts.size() > kMaxVppContexts) {
+        destroyContext(m_contexts.back());
+        m_contexts.pop_back();
+    }
+
     return true;
 }
 
-void MsdkScaler::destroyVpp()
+void MsdkScaler::destroyContext(VppContext& context)
 {
-    if (m_vpp) {
-        m_vpp->Close();
-        delete m_vpp;
-        m_vpp = NULL;
+    if (context.vpp) {
+        context.vpp->Close();
+        delete context.vpp;
+        context.vpp = NULL;
     }
 
-    if (m_session) {
+    if (context.session) {
         MsdkBase *msdkBase = MsdkBase::get();
         if (msdkBase) {
-            msdkBase->destroySession(m_session);
+            msdkBase->destroySession(context.session);
         }
-        m_session = NULL;
+        context.session = NULL;
+    }
+
+    context.allocator.reset();
+    context.param.reset();
+}
+
+void MsdkScaler::destroyVpp()
+{
+    for (std::list<VppContext>::iterator it = m_contexts.begin(); it != m_contexts.end(); ++it) {
+        destroyContext(*it);
     }
+    m_contexts.clear();
 
+    m_session = NULL;
+    m_vpp = NULL;
     m_allocator.reset();
     m_vppParam.reset();
 }
@@ -105,7 +137,9 @@ void MsdkScaler::initVppParam()
     memset(m_vppParam.get(), 0, sizeof(mfxVideoParam));
 
     // mfxVideoParam Common
-    m_vppParam->AsyncDepth              = 1;
+    // Sync is deferred onto the destination frame's sync point, so allow a
+    // few operations in flight to keep the VPP queue full.
+    m_vppParam->AsyncDepth              = 4;
     m_vppParam->IOPattern               = MFX_IOPATTERN_IN_VIDEO_MEMORY | MFX_IOPATTERN_OUT_VIDEO_MEMORY;
 
     // mfxVideoParam Vpp In
@@ -176,52 +210,65 @@ void MsdkScaler::updateVppParam(int inWidth, int inHeight, int inCropX, int inCr
     m_vppParam->vpp.Out.CropH           = outCropH;
 }
 
+static bool matchVppGeometry(const mfxVideoParam *param,
+        int inWidth, int inHeight, int inCropX, int inCropY, int inCropW, int inCropH,
+        int outWidth, int outHeight, int outCropX, int outCropY, int outCropW, int outCropH)
+{
+    return param->vpp.In.Width == inWidth
+            && param->vpp.In.Height == inHeight
+            && param->vpp.In.CropX == inCropX
+            && param->vpp.In.CropY == inCropY
+            && param->vpp.In.CropW == inCropW
+            && param->vpp.In.CropH == inCropH
+            && param->vpp.Out.Width == outWidth
+            && param->vpp.Out.Height == outHeight
+            && param->vpp.Out.CropX == outCropX
+            && param->vpp.Out.CropY == outCropY
+            && param->vpp.Out.CropW == outCropW
+            && param->vpp.Out.CropH == outCropH;
+}
+
 bool MsdkScaler::setupVpp(int inWidth, int inHeight, int inCropX, int inCropY, int inCropW, int inCropH,
             int outWidth, int outHeight, int outCropX, int outCropY, int outCropW, int outCropH)
 {
     if (!m_vpp)
         return false;
 
-    if (m_vppParam->vpp.In.Width != inWidth
-            || m_vppParam->vpp.In.Height != inHeight
-            || m_vppParam->vpp.In.CropX != inCropX
-            || m_vppParam->vpp.In.CropY != inCropY
-            || m_vppParam->vpp.In.CropW != inCropW
-            || m_vppParam->vpp.In.CropH != inCropH
-            || m_vppParam->vpp.Out.Width != outWidth
-            || m_vppParam->vpp.Out.Height != outHeight
-            || m_vppParam->vpp.Out.CropX != outCropX
-            || m_vppParam->vpp.Out.CropY != outCropY
-            || m_vppParam->vpp.Out.CropW != outCropW
-            || m_vppParam->vpp.Out.CropH != outCropH
-            ) {
-        updateVppParam(inWidth, inHeight, inCropX, inCropY, inCropW, inCropH
-            , outWidth, outHeight, outCropX, outCropY, outCropW, outCropH);
-
-        mfxStatus sts = m_vpp->Reset(m_vppParam.get());
-        if (sts > 0) {
-            ELOG_TRACE("Ignore mfx warning, ret %d", sts);
-        } else if (sts != MFX_ERR_NONE) {
-            ELOG_TRACE("mfx reset failed, ret %d. Try to reinitialize.", sts);
-
-            m_vpp->Close();
-            sts = m_vpp->Init(m_vppParam.get());
-            if (sts > 0) {
-                ELOG_TRACE("Ignore mfx warning, ret %d", sts);
-            } else if (sts != MFX_ERR_NONE) {
-                MsdkBase::printfVideoParam(m_vppParam.get(), MFX_VPP);
-
-                ELOG_ERROR("mfx init failed, ret %d", sts);
-
-                destroyVpp();
-                return false;
-            }
+    // Fast path, current pipeline already matches.
+    if (matchVppGeometry(m_vppParam.get()
+                , inWidth, inHeight, inCropX, inCropY, inCropW, inCropH
+                , outWidth, outHeight, outCropX, outCropY, outCropW, outCropH))
+        return true;
+
+    // A warm pipeline for this geometry, e.g. another rung of a scaling
+    // ladder served round-robin, moves to the front instead of Reset-ing.
+    for (std::list<VppContext>::iterator it = m_contexts.begin(); it != m_contexts.end(); ++it) {
+        if (matchVppGeometry(it->param.get()
+                    , inWidth, inHeight, inCropX, inCropY, inCropW, inCropH
+                    , outWidth, outHeight, outCropX, outCropY, outCropW, outCropH)) {
+            m_contexts.splice(m_contexts.begin(), m_contexts, it);
+
+            m_session = m_contexts.front().session;
+            m_vpp = m_contexts.front().vpp;
+            m_allocator = m_contexts.front().allocator;
+            m_vppParam = m_contexts.front().param;
+            return true;
         }
+    }
 
-        m_vpp->GetVideoParam(m_vppParam.get());
-        MsdkBase::printfVideoParam(m_vppParam.get(), MFX_VPP);
+    // New geometry, bring up a dedicated pipeline for it.
+    initVppParam();
+    updateVppParam(inWidth, inHeight, inCropX, inCropY, inCropW, inCropH
+            , outWidth, outHeight, outCropX, outCropY, outCropW, outCropH);
+
+    if (!createVpp()) {
+        ELOG_ERROR("Create vpp for new geometry failed.");
+        return false;
     }
 
+    m_vpp->GetVideoParam(m_vppParam.get());
+    MsdkBase::printfVideoParam(m_vppParam.get(), MFX_VPP);
+
     return true;
 }
 
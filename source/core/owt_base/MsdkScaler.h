@@ -5,6 +5,8 @@
 #ifndef MsdkScaler_h
 #define MsdkScaler_h
 
+#include <list>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -38,10 +40,28 @@ protected:
     bool doVppConvert(MsdkFrame *srcMsdkFrame, MsdkFrame *dstMsdkFrame);
 
 private:
+    // One initialized VPP pipeline per (src,dst) geometry, kept most
+    // recently used first, so a simulcast scaling ladder that alternates
+    // between targets every frame reuses warm pipelines instead of
+    // Reset-ing a single one per frame.
+    struct VppContext {
+        MFXVideoSession *session;
+        MFXVideoVPP *vpp;
+        boost::shared_ptr<mfxFrameAllocator> allocator;
+        boost::shared_ptr<mfxVideoParam> param;
+    };
+
+    static const size_t kMaxVppContexts = 8;
+
+    void destroyContext(VppContext& context);
+
+    std::list<VppContext> m_contexts;
+
+    // Shortcuts into the front (current) context.
     MFXVideoSession *m_session;
     MFXVideoVPP *m_vpp;
     boost::shared_ptr<mfxFrameAllocator> m_allocator;
-    boost::scoped_ptr<mfxVideoParam> m_vppParam;
+    boost::shared_ptr<mfxVideoParam> m_vppParam;
 };
 
 } /* namespace owt_base */
@@ -0,0 +1,122 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PacketPool_h
+#define PacketPool_h
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <MediaDefinitions.h>
+
+#include "MemoryBudget.h"
+
+namespace owt_base {
+
+// Process-wide recycler for erizo::DataPacket. Every packet carries its
+// payload in a ~1.5KB inline buffer, and the delivery paths allocate one
+// wrapper per RTP packet only to free it microseconds later when the
+// pipeline hop completes. Handing out pooled objects under a shared_ptr
+// whose deleter returns them keeps the steady-state allocation rate at
+// zero; the free list is bounded, so bursts simply fall back to the heap.
+//
+// Companion to PayloadBufferPool, which plays the same role for frame
+// payloads - the DataPacket buffer is inline, so the two cannot share an
+// arena.
+class PacketPool {
+public:
+    static std::shared_ptr<erizo::DataPacket> obtain(int comp, const char* data, int length, erizo::packetType type)
+    {
+        registerWithBudget();
+
+        erizo::DataPacket* packet = pop();
+        if (packet) {
+            // Rebuild in place; recycled packets are kept constructed on
+            // the free list so their storage stays warm.
+            packet->~DataPacket();
+        } else {
+            packet = static_cast<erizo::DataPacket*>(::operator new(sizeof(erizo::DataPacket)));
+        }
+        new (packet) erizo::DataPacket(comp, data, length, type);
+        return std::shared_ptr<erizo::DataPacket>(packet, recycle);
+    }
+
+    // Memory budget hook (see MemoryBudget): drops the whole free list and
+    // returns the bytes released. Outstanding packets are untouched; they
+    // just fall back to the heap deleter when recycled into a full list.
+    static size_t trim()
+    {
+        std::vector<erizo::DataPacket*> dropped;
+        {
+            boost::mutex::scoped_lock lock(mutex());
+            dropped.swap(freeList());
+        }
+        for (auto packet : dropped) {
+            packet->~DataPacket();
+            ::operator delete(packet);
+        }
+        return dropped.size() * sizeof(erizo::DataPacket);
+    }
+
+private:
+    static const size_t kMaxPooled = 512;
+
+    struct PoolTrimmer : MemoryTrimmer {
+        size_t onTrimMemory(uint32_t level) override { return trim(); }
+    };
+
+    static void registerWithBudget()
+    {
+        static bool once = []() {
+            if (MemoryBudget::enabled()) {
+                static PoolTrimmer trimmer;
+                MemoryBudget::instance().addTrimmer("packetPool", &trimmer);
+            }
+            return true;
+        }();
+        (void)once;
+    }
+
+    static boost::mutex& mutex()
+    {
+        static boost::mutex m;
+        return m;
+    }
+
+    static std::vector<erizo::DataPacket*>& freeList()
+    {
+        static std::vector<erizo::DataPacket*> list;
+        return list;
+    }
+
+    static erizo::DataPacket* pop()
+    {
+        boost::mutex::scoped_lock lock(mutex());
+        if (freeList().empty())
+            return nullptr;
+        erizo::DataPacket* packet = freeList().back();
+        freeList().pop_back();
+        return packet;
+    }
+
+    static void recycle(erizo::DataPacket* packet)
+    {
+        {
+            boost::mutex::scoped_lock lock(mutex());
+            if (freeList().size() < kMaxPooled) {
+                freeList().push_back(packet);
+                return;
+            }
+        }
+        packet->~DataPacket();
+        ::operator delete(packet);
+    }
+};
+
+} /* namespace owt_base */
+
+#endif /* PacketPool_h */
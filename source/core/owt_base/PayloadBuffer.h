@@ -0,0 +1,107 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PayloadBuffer_h
+#define PayloadBuffer_h
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+#include "MediaFramePipeline.h"
+#include "PayloadBufferPool.h"
+
+namespace owt_base {
+
+// Intrusively reference-counted storage for encoded frame payloads.
+//
+// A producer allocates one PayloadBuffer per frame and attaches it to the
+// Frame it delivers; any stage that needs the payload beyond the onFrame()
+// callback takes an additional reference instead of copying the bitstream.
+// Legacy producers keep filling Frame::payload with a raw pointer and leave
+// Frame::buffer null, in which case consumers fall back to copying as before.
+class PayloadBuffer {
+public:
+    static PayloadBuffer* create(uint32_t capacity)
+    {
+        return new PayloadBuffer(capacity);
+    }
+
+    uint8_t* data() { return m_data; }
+    uint32_t capacity() const { return m_capacity; }
+
+    void retain() { m_refCount.fetch_add(1, std::memory_order_relaxed); }
+    void release()
+    {
+        if (m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+private:
+    // Payload storage comes from the size-classed pool; m_capacity records
+    // the actual class size so the dtor recycles into the right class.
+    explicit PayloadBuffer(uint32_t capacity)
+        : m_refCount(1)
+    {
+        m_data = PayloadBufferPool::allocate(capacity, m_capacity);
+    }
+
+    ~PayloadBuffer() { PayloadBufferPool::recycle(m_data, m_capacity); }
+
+    std::atomic<uint32_t> m_refCount;
+    uint32_t m_capacity;
+    uint8_t* m_data;
+};
+
+// Attaches a buffer to a frame, transferring the caller's reference. The
+// frame's payload pointer is set to the start of the buffer; the producer may
+// still adjust payload/length to a sub-range (e.g. to skip an RTP header)
+// as long as it stays within the buffer.
+inline void attachPayloadBuffer(Frame& frame, PayloadBuffer* buffer)
+{
+    frame.buffer = buffer;
+    frame.payload = buffer->data();
+}
+
+// Takes an additional reference on the payload of a buffer-backed frame so it
+// can be held beyond the onFrame() callback. Returns null for legacy frames
+// carrying a raw payload pointer; the caller must copy the payload then.
+inline PayloadBuffer* retainFramePayload(const Frame& frame)
+{
+    if (frame.buffer)
+        frame.buffer->retain();
+    return frame.buffer;
+}
+
+// Returns a copy of `frame` that owns its payload through a PayloadBuffer
+// reference, so it can be queued beyond the onFrame() callback. Buffer-backed
+// frames are shared zero-copy; raw-payload frames get a one-time copy into a
+// pooled buffer. Pair with releaseOwnedFrame().
+inline Frame makeOwnedFrame(const Frame& frame)
+{
+    Frame owned = frame;
+    if (retainFramePayload(frame))
+        return owned;
+
+    if (frame.length > 0) {
+        PayloadBuffer* buffer = PayloadBuffer::create(frame.length);
+        memcpy(buffer->data(), frame.payload, frame.length);
+        owned.buffer = buffer;
+        owned.payload = buffer->data();
+    }
+    return owned;
+}
+
+inline void releaseOwnedFrame(Frame& frame)
+{
+    if (frame.buffer) {
+        frame.buffer->release();
+        frame.buffer = nullptr;
+        frame.payload = nullptr;
+    }
+}
+
+} /* namespace owt_base */
+
+#endif /* PayloadBuffer_h */
@@ -0,0 +1,177 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PayloadBufferPool.h"
+
+#include "HeapAccounting.h"
+#include "MemoryBudget.h"
+
+#include <atomic>
+#include <boost/thread/mutex.hpp>
+#include <stdio.h>
+#include <vector>
+
+namespace owt_base {
+
+namespace {
+
+// Size classes: 1KB .. 2MB in power-of-two steps. 2MB comfortably covers a
+// 4K keyframe; anything bigger is rare enough to leave to the system allocator.
+const uint32_t kMinClassShift = 10;
+const uint32_t kMaxClassShift = 21;
+const uint32_t kNumClasses = kMaxClassShift - kMinClassShift + 1;
+
+// Buffers kept per size class in each thread-local cache before spilling to
+// the shared free list.
+const size_t kThreadCacheDepth = 16;
+
+struct SharedFreeList {
+    boost::mutex mutex;
+    std::vector<uint8_t*> buffers;
+};
+
+SharedFreeList g_freeLists[kNumClasses];
+
+// Pressure counters, relaxed: a rising freshAllocations rate under steady
+// load means the classes are being outgrown; oversize means payloads beyond
+// the largest class.
+std::atomic<uint64_t> g_poolRequests(0);
+std::atomic<uint64_t> g_freshAllocations(0);
+std::atomic<uint64_t> g_oversizeAllocations(0);
+
+int classForSize(uint32_t size)
+{
+    for (uint32_t shift = kMinClassShift; shift <= kMaxClassShift; ++shift) {
+        if (size <= (1u << shift))
+            return shift - kMinClassShift;
+    }
+    return -1;
+}
+
+struct ThreadCache {
+    std::vector<uint8_t*> buffers[kNumClasses];
+
+    ~ThreadCache()
+    {
+        // Hand everything back to the shared lists when a worker thread exits.
+        for (uint32_t i = 0; i < kNumClasses; ++i) {
+            boost::mutex::scoped_lock lock(g_freeLists[i].mutex);
+            g_freeLists[i].buffers.insert(g_freeLists[i].buffers.end(),
+                buffers[i].begin(), buffers[i].end());
+        }
+    }
+};
+
+thread_local ThreadCache t_cache;
+
+// Registered with the budget manager on first use; any trim level empties
+// the shared lists, which are exactly the pool's idle reserve.
+struct PoolTrimmer : MemoryTrimmer {
+    size_t onTrimMemory(uint32_t level) override { return PayloadBufferPool::trim(); }
+};
+
+void registerWithBudget()
+{
+    static bool once = []() {
+        if (MemoryBudget::enabled()) {
+            static PoolTrimmer trimmer;
+            MemoryBudget::instance().addTrimmer("payloadBuffers", &trimmer);
+        }
+        return true;
+    }();
+    (void)once;
+}
+
+} /* anonymous namespace */
+
+uint8_t* PayloadBufferPool::allocate(uint32_t size, uint32_t& capacity)
+{
+    registerWithBudget();
+    g_poolRequests.fetch_add(1, std::memory_order_relaxed);
+
+    int cls = classForSize(size);
+    if (cls < 0) {
+        g_oversizeAllocations.fetch_add(1, std::memory_order_relaxed);
+        capacity = size;
+        HeapAccounting::add(HeapAccounting::kPayloadBuffers, size);
+        return new uint8_t[size];
+    }
+
+    capacity = 1u << (cls + kMinClassShift);
+
+    std::vector<uint8_t*>& cached = t_cache.buffers[cls];
+    if (!cached.empty()) {
+        uint8_t* data = cached.back();
+        cached.pop_back();
+        return data;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(g_freeLists[cls].mutex);
+        if (!g_freeLists[cls].buffers.empty()) {
+            uint8_t* data = g_freeLists[cls].buffers.back();
+            g_freeLists[cls].buffers.pop_back();
+            return data;
+        }
+    }
+
+    g_freshAllocations.fetch_add(1, std::memory_order_relaxed);
+    // Pooled buffers stay counted while cached: they are resident either way,
+    // which is exactly what RSS attribution needs.
+    HeapAccounting::add(HeapAccounting::kPayloadBuffers, capacity);
+    return new uint8_t[capacity];
+}
+
+size_t PayloadBufferPool::trim()
+{
+    size_t released = 0;
+    for (uint32_t cls = 0; cls < kNumClasses; ++cls) {
+        std::vector<uint8_t*> buffers;
+        {
+            boost::mutex::scoped_lock lock(g_freeLists[cls].mutex);
+            buffers.swap(g_freeLists[cls].buffers);
+        }
+
+        size_t capacity = 1u << (cls + kMinClassShift);
+        for (auto data : buffers) {
+            HeapAccounting::sub(HeapAccounting::kPayloadBuffers, capacity);
+            delete [] data;
+            released += capacity;
+        }
+    }
+    return released;
+}
+
+std::string PayloadBufferPool::report()
+{
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+        "{\"requests\":%llu,\"freshAllocations\":%llu,\"oversizeAllocations\":%llu}",
+        (unsigned long long)g_poolRequests.load(std::memory_order_relaxed),
+        (unsigned long long)g_freshAllocations.load(std::memory_order_relaxed),
+        (unsigned long long)g_oversizeAllocations.load(std::memory_order_relaxed));
+    return buf;
+}
+
+void PayloadBufferPool::recycle(uint8_t* data, uint32_t capacity)
+{
+    int cls = classForSize(capacity);
+    if (cls < 0 || (1u << (cls + kMinClassShift)) != capacity) {
+        // Over-sized or odd-sized buffer allocated outside the classes.
+        HeapAccounting::sub(HeapAccounting::kPayloadBuffers, capacity);
+        delete [] data;
+        return;
+    }
+
+    std::vector<uint8_t*>& cached = t_cache.buffers[cls];
+    if (cached.size() < kThreadCacheDepth) {
+        cached.push_back(data);
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(g_freeLists[cls].mutex);
+    g_freeLists[cls].buffers.push_back(data);
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,44 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PayloadBufferPool_h
+#define PayloadBufferPool_h
+
+#include <stdint.h>
+#include <string>
+
+namespace owt_base {
+
+// Process-wide size-classed pool for frame payload storage.
+//
+// Encoded frames are allocated and freed at a very high rate (one buffer per
+// frame per producer), so instead of hitting the system allocator every time,
+// payload memory is drawn from power-of-two size classes. Freed buffers go to
+// a small per-thread cache first and spill to a shared per-class free list,
+// keeping the common alloc/free path free of any locking. Requests larger
+// than the biggest class fall through to plain new/delete.
+class PayloadBufferPool {
+public:
+    // Returns a buffer of at least `size` bytes; `capacity` is set to the
+    // actual class size so the buffer can be recycled into the right class.
+    static uint8_t* allocate(uint32_t size, uint32_t& capacity);
+    static void recycle(uint8_t* data, uint32_t capacity);
+
+    // JSON snapshot of the pressure counters (fresh allocations that missed
+    // both the thread cache and the shared lists, and oversize fall-through),
+    // for the transport telemetry surface.
+    static std::string report();
+
+    // Memory budget hook (see MemoryBudget): frees the shared free lists and
+    // returns the bytes released. The per-thread caches stay - they are
+    // small, bounded, and only their owning threads may touch them.
+    static size_t trim();
+
+private:
+    PayloadBufferPool() = delete;
+};
+
+} /* namespace owt_base */
+
+#endif /* PayloadBufferPool_h */
@@ -0,0 +1,140 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PipelineTracer_h
+#define PipelineTracer_h
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace owt_base {
+
+// Chrome-trace (about:tracing / Perfetto UI) event writer for the media
+// pipeline. Disabled unless OWT_TRACE_DIR names a writable directory; each
+// process then appends to <dir>/owt-trace-<pid>.json and the per-process
+// files can be loaded together in the Perfetto UI. Events carry the frame's
+// RTP timestamp in args, which survives the internal transports unchanged,
+// so one frame's journey across agent processes lines up on a single
+// timeline without any wire-format change.
+//
+// Header-only on purpose: every addon that compiles owt_base sources picks
+// it up without binding.gyp churn, and when tracing is off the cost per
+// callsite is one predictable branch.
+class PipelineTracer {
+public:
+    static bool enabled()
+    {
+        static int state = -1;
+        if (state < 0) {
+            const char* dir = std::getenv("OWT_TRACE_DIR");
+            state = (dir && dir[0]) ? 1 : 0;
+        }
+        return state == 1;
+    }
+
+    static PipelineTracer& instance()
+    {
+        static PipelineTracer tracer;
+        return tracer;
+    }
+
+    static int64_t nowUs()
+    {
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * INT64_C(1000000) + t.tv_nsec / 1000;
+    }
+
+    // Instant event, global scope so cross-process lines match up.
+    void instant(const char* cat, const char* name, uint32_t rtpTs)
+    {
+        if (!m_file)
+            return;
+        std::lock_guard<std::mutex> guard(m_mutex);
+        fprintf(m_file, "{\"ph\":\"i\",\"s\":\"g\",\"pid\":%d,\"tid\":%ld,\"ts\":%lld,\"cat\":\"%s\",\"name\":\"%s\",\"args\":{\"rtp_ts\":%u}},\n",
+                m_pid, tid(), (long long)nowUs(), cat, name, rtpTs);
+    }
+
+    // Complete event covering [beginUs, now].
+    void complete(const char* cat, const char* name, int64_t beginUs, uint32_t rtpTs)
+    {
+        if (!m_file)
+            return;
+        int64_t end = nowUs();
+        std::lock_guard<std::mutex> guard(m_mutex);
+        fprintf(m_file, "{\"ph\":\"X\",\"pid\":%d,\"tid\":%ld,\"ts\":%lld,\"dur\":%lld,\"cat\":\"%s\",\"name\":\"%s\",\"args\":{\"rtp_ts\":%u}},\n",
+                m_pid, tid(), (long long)beginUs, (long long)(end - beginUs), cat, name, rtpTs);
+    }
+
+    // RAII span emitting a complete event; no-op when tracing is off.
+    class Span {
+    public:
+        Span(const char* cat, const char* name, uint32_t rtpTs)
+            : m_cat(cat)
+            , m_name(name)
+            , m_rtpTs(rtpTs)
+            , m_beginUs(enabled() ? nowUs() : 0)
+        {
+        }
+
+        ~Span()
+        {
+            if (m_beginUs)
+                instance().complete(m_cat, m_name, m_beginUs, m_rtpTs);
+        }
+
+    private:
+        const char* m_cat;
+        const char* m_name;
+        uint32_t m_rtpTs;
+        int64_t m_beginUs;
+    };
+
+private:
+    PipelineTracer()
+        : m_file(nullptr)
+        , m_pid(getpid())
+    {
+        const char* dir = std::getenv("OWT_TRACE_DIR");
+        if (dir && dir[0]) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/owt-trace-%d.json", dir, m_pid);
+            m_file = fopen(path, "w");
+            if (m_file)
+                fputs("[\n", m_file);
+        }
+    }
+
+    ~PipelineTracer()
+    {
+        // No closing bracket: the trailing comma plus truncated array is
+        // accepted by the trace viewers and survives crashes.
+        if (m_file)
+            fclose(m_file);
+    }
+
+    static long tid()
+    {
+#ifdef __linux__
+        return syscall(SYS_gettid);
+#else
+        return 0;
+#endif
+    }
+
+    FILE* m_file;
+    int m_pid;
+    std::mutex m_mutex;
+};
+
+} /* namespace owt_base */
+
+#endif /* PipelineTracer_h */
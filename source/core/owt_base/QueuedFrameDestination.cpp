@@ -0,0 +1,138 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "QueuedFrameDestination.h"
+
+#include <boost/bind.hpp>
+#include <utility>
+
+namespace owt_base {
+
+DEFINE_LOGGER(QueuedFrameDestination, "owt.QueuedFrameDestination");
+
+// Audio frames are tiny; the cap only exists to bound memory if the consumer
+// is wedged for seconds.
+static const size_t kMaxAudioFrames = 4096;
+
+QueuedFrameDestination::QueuedFrameDestination(FrameDestination* dest, bool isAudio, size_t maxVideoFrames)
+    : m_dest(dest)
+    , m_isAudio(isAudio)
+    , m_maxVideoFrames(maxVideoFrames)
+    , m_running(true)
+    , m_drainScheduled(false)
+    , m_strand(DeliveryThreadPool::instance().service())
+{
+    if (isAudio)
+        addAudioDestination(dest);
+    else
+        addVideoDestination(dest);
+}
+
+QueuedFrameDestination::~QueuedFrameDestination()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_running = false;
+    }
+    // Once m_running is false no new drain is posted and the pending one
+    // exits without touching us again, so waiting on the strand makes the
+    // teardown safe.
+    DeliveryThreadPool::instance().drain(m_strand);
+
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it)
+        releaseOwnedFrame(*it);
+    m_queue.clear();
+
+    if (m_isAudio)
+        removeAudioDestination(m_dest);
+    else
+        removeVideoDestination(m_dest);
+}
+
+void QueuedFrameDestination::onFrame(const Frame& frame)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_running)
+        return;
+
+    m_queue.push_back(makeOwnedFrame(frame));
+    shedLocked();
+    scheduleDrainLocked();
+}
+
+void QueuedFrameDestination::onFrame(Frame&& frame)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_running) {
+        releaseOwnedFrame(frame);
+        return;
+    }
+
+    // We were handed ownership; buffer-backed frames go straight into the
+    // queue, raw-payload ones still need a one-time copy.
+    m_queue.push_back(frame.buffer ? frame : makeOwnedFrame(frame));
+    shedLocked();
+    scheduleDrainLocked();
+}
+
+void QueuedFrameDestination::shedLocked()
+{
+    if (m_isAudio) {
+        while (m_queue.size() > kMaxAudioFrames) {
+            ELOG_WARN("audio queue wedged, dropping oldest frame");
+            releaseOwnedFrame(m_queue.front());
+            m_queue.pop_front();
+        }
+        return;
+    }
+
+    if (m_queue.size() <= m_maxVideoFrames)
+        return;
+
+    // Prefer dropping stale non-key frames; a key frame is only sacrificed
+    // when the queue is somehow full of them.
+    for (auto it = m_queue.begin(); it != m_queue.end() && m_queue.size() > m_maxVideoFrames;) {
+        if (!it->additionalInfo.video.isKeyFrame) {
+            releaseOwnedFrame(*it);
+            it = m_queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    while (m_queue.size() > m_maxVideoFrames) {
+        releaseOwnedFrame(m_queue.front());
+        m_queue.pop_front();
+    }
+}
+
+void QueuedFrameDestination::scheduleDrainLocked()
+{
+    if (m_drainScheduled)
+        return;
+    m_drainScheduled = true;
+    m_strand.post(boost::bind(&QueuedFrameDestination::drainJob, this));
+}
+
+void QueuedFrameDestination::drainJob()
+{
+    for (;;) {
+        Frame frame;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            if (!m_running || m_queue.empty()) {
+                m_drainScheduled = false;
+                return;
+            }
+            frame = m_queue.front();
+            m_queue.pop_front();
+        }
+        // Single wrapped destination: move the frame (and its buffer
+        // reference) straight through. Frames enqueued while we deliver
+        // are picked up by the same job; the shed cap bounds how long one
+        // destination can hold a pool worker.
+        deliverFrame(std::move(frame));
+    }
+}
+
+} /* namespace owt_base */
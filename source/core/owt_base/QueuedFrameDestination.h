@@ -0,0 +1,71 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef QueuedFrameDestination_h
+#define QueuedFrameDestination_h
+
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+
+#include <logger.h>
+
+#include "DeliveryThreadPool.h"
+#include "MediaFramePipeline.h"
+#include "PayloadBuffer.h"
+
+namespace owt_base {
+
+// Decouples one destination from the fan-out hot path with a bounded queue
+// drained on the shared DeliveryThreadPool, so a stalled subscriber
+// back-pressures only its own stream and 500 subscribers parallelize
+// delivery across the pool's workers instead of spawning 500 threads.
+//
+// Drop policy when the queue is over budget: stale non-key video frames go
+// first, then (as a last resort) the oldest video frame. Audio is never
+// dropped by policy; a hard cap merely guards against unbounded growth when
+// the consumer is wedged.
+//
+// The wrapper sits in the pipeline as both FrameDestination (registered with
+// the fanning-out source) and FrameSource (feeding the real destination), so
+// feedback messages from the wrapped destination keep flowing upstream.
+class QueuedFrameDestination : public FrameSource, public FrameDestination {
+    DECLARE_LOGGER();
+
+public:
+    QueuedFrameDestination(FrameDestination* dest, bool isAudio, size_t maxVideoFrames = 64);
+    virtual ~QueuedFrameDestination();
+
+    FrameDestination* wrapped() { return m_dest; }
+
+    // Implements FrameSource.
+    void onFeedback(const FeedbackMsg& msg) { deliverFeedbackMsg(msg); }
+
+    // Implements FrameDestination.
+    void onFrame(const Frame&);
+    // Adopts moved-in frames directly, skipping the retain/copy.
+    void onFrame(Frame&&);
+
+private:
+    // Runs on the pool via m_strand; drains the queue until empty.
+    void drainJob();
+    // Called with m_mutex held; enforces the drop policy.
+    void shedLocked();
+    // Called with m_mutex held; posts drainJob unless one is pending.
+    void scheduleDrainLocked();
+
+    FrameDestination* m_dest;
+    bool m_isAudio;
+    size_t m_maxVideoFrames;
+
+    std::deque<Frame> m_queue;
+    boost::mutex m_mutex;
+    bool m_running;
+    bool m_drainScheduled;
+    boost::asio::io_service::strand m_strand;
+};
+
+} /* namespace owt_base */
+
+#endif /* QueuedFrameDestination_h */
@@ -2,22 +2,110 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include "HostLoadGovernor.h"
+#include "IOServicePool.h"
 #include "RawTransport.h"
 
+#include <algorithm>
+#include <errno.h>
 #include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
 
 namespace owt_base {
 
 using boost::asio::ip::udp;
 using boost::asio::ip::tcp;
 
+// Datagrams moved per recvmmsg/sendmmsg syscall in batched UDP mode.
+static const int kUdpBatchSize = 32;
+
+// Fragmented large-frame framing for UDP. A legacy datagram starts with a
+// 4-byte payload length whose top bit is never set, so a set top bit marks a
+// fragment instead, carrying a 16-byte header in network order:
+//   word 0: kFragmentFlag | frame sequence number
+//   word 1: total reassembled length (frame header + payload)
+//   word 2: byte offset of this fragment within the reassembled frame
+//   word 3: fragment payload length
+// Both ends of an internal link run the same release, so there is no in-band
+// handshake; OWT_UDP_LARGE_FRAMES=0 keeps the legacy wire format during a
+// rolling upgrade. Frames small enough for one datagram are sent in the
+// legacy format either way.
+static const uint32_t kFragmentFlag = 0x80000000;
+static const size_t kFragmentHeaderSize = 16;
+
+// Upper bound for a reassembled frame; anything beyond it is corrupt input.
+static const uint32_t kMaxFragmentedFrameSize = 64 * 1024 * 1024;
+
+// Kernel socket buffers sized so a burst of fragments carrying a 4K keyframe
+// survives a scheduling hiccup; the net.core defaults (~208KB) do not.
+static const int kUdpKernelBufferSize = 4 * 1024 * 1024;
+
+static bool largeUdpFramesEnabled()
+{
+    const char* env = getenv("OWT_UDP_LARGE_FRAMES");
+    return !(env && env[0] == '0');
+}
+
+// Bytes one datagram may carry on the wire (framing plus payload), derived
+// from the link MTU. Standard ethernet by default; set OWT_UDP_MTU (e.g.
+// 9000) on jumbo-frame capable links.
+static size_t udpDatagramSize()
+{
+    static const size_t size = [] {
+        const char* env = getenv("OWT_UDP_MTU");
+        long mtu = env ? atol(env) : 0;
+        if (mtu < 576 || mtu > 65535)
+            mtu = 1500;
+        return (size_t)mtu - 28; // minus the IP and UDP headers
+    }();
+    return size;
+}
+
+// Send queue depth past which the socket is clearly not keeping up with the
+// media being queued; reported as host-wide pressure.
+static const size_t kSendQueueBackpressure = 64;
+
+static bool batchedUdpEnabled()
+{
+    const char* env = getenv("OWT_UDP_BATCH");
+    return !(env && env[0] == '0');
+}
+
+// Busy-poll window in microseconds for the internal UDP sockets. On a
+// dedicated relay host, spending a core spinning in the driver receive path
+// (SO_BUSY_POLL) removes the interrupt/softirq hop that becomes the ceiling
+// at high packet rates; combined with the recvmmsg batching above it is the
+// closest this tree gets to a kernel-bypass receive path. Off by default --
+// shared media nodes must not burn cores polling -- so only relay-style
+// deployments set OWT_UDP_BUSY_POLL (e.g. 50) in the agent environment.
+static int udpBusyPollUsec()
+{
+    static const int usec = [] {
+        const char* env = getenv("OWT_UDP_BUSY_POLL");
+        int value = env ? atoi(env) : 0;
+        return value > 0 ? value : 0;
+    }();
+    return usec;
+}
+
 DEFINE_TEMPLATE_LOGGER(template<Protocol prot>, RawTransport<prot>, "owt.RawTransport");
 
 template<Protocol prot>
 RawTransport<prot>::RawTransport(RawTransportListener* listener, size_t initialBufferSize, bool tag)
     : m_isClosing(false)
     , m_tag(tag)
-    , m_bufferSize(initialBufferSize)
+    , m_batchedUdp(prot == UDP && tag && batchedUdpEnabled())
+    , m_bufferSize(prot == UDP ? std::max(initialBufferSize, udpDatagramSize()) : initialBufferSize)
+    , m_sendFrameId(0)
+    , m_fragmentBufferSize(0)
+    , m_fragmentFrameId(0)
+    , m_fragmentTotal(0)
+    , m_fragmentReceived(0)
+    , m_sendingLane(0)
+    , m_latchedLane(-1)
+    , m_ioService(IOServicePool::instance().get())
     , m_listener(listener)
     , m_receivedBytes(0)
 {
@@ -36,29 +124,47 @@ void RawTransport<prot>::close()
     if (m_isClosing)
         return;
 
-    // We need to wait for the work thread to finish its job.
     m_isClosing = true;
-    m_ioService.stop();
-    m_workThread.join();
 
-    boost::system::error_code ec;
-    switch (prot) {
-    case TCP:
-        if (m_socket.tcp.acceptor)
-            m_socket.tcp.acceptor->close();
-        if (m_socket.tcp.socket) {
-            m_socket.tcp.socket->shutdown(tcp::socket::shutdown_both, ec);
-            m_socket.tcp.socket->close();
+    // Close the sockets on the service thread so it never races an in-flight
+    // handler, then drain twice: the first drain waits for the close to run
+    // (queueing the aborted-operation handlers behind it), the second waits
+    // for those handlers to finish. After that nothing can touch us anymore.
+    IOServicePool::instance().drain(m_ioService);
+    m_ioService.post([this]() {
+        boost::system::error_code ec;
+        switch (prot) {
+        case TCP:
+            if (m_socket.tcp.acceptor)
+                m_socket.tcp.acceptor->close();
+            if (m_socket.tcp.socket) {
+                m_socket.tcp.socket->shutdown(tcp::socket::shutdown_both, ec);
+                m_socket.tcp.socket->close();
+            }
+            break;
+        case UDP:
+            if (m_socket.udp.socket) {
+                m_socket.udp.socket->shutdown(udp::socket::shutdown_both, ec);
+                m_socket.udp.socket->close();
+            }
+            break;
+        default:
+            break;
         }
-        break;
-    case UDP:
-        if (m_socket.udp.socket) {
-            m_socket.udp.socket->shutdown(udp::socket::shutdown_both, ec);
-            m_socket.udp.socket->close();
+    });
+    IOServicePool::instance().drain(m_ioService);
+    IOServicePool::instance().drain(m_ioService);
+
+    {
+        boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
+        for (int lane = 0; lane < NUM_SEND_LANES; lane++) {
+            while (!m_sendQueues[lane].empty()) {
+                if (m_sendQueues[lane].front().payload)
+                    m_sendQueues[lane].front().payload->release();
+                m_sendQueues[lane].pop();
+            }
         }
-        break;
-    default:
-        break;
+        m_latchedLane = -1;
     }
     ELOG_DEBUG("Closed");
 }
@@ -103,9 +209,6 @@ void RawTransport<prot>::createConnection(const std::string& ip, uint32_t port)
     default:
         break;
     }
-
-    if (m_workThread.get_id() == boost::thread::id()) // Not-A-Thread
-        m_workThread = boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService));
 }
 
 template<Protocol prot>
@@ -126,6 +229,7 @@ void RawTransport<prot>::connectHandler(const boost::system::error_code& ec)
         case UDP:
             ELOG_DEBUG("Local UDP port: %d", m_socket.udp.socket->local_endpoint().port());
             m_socket.udp.connected = true;
+            configureUdpSocket();
             break;
         default:
             break;
@@ -193,6 +297,7 @@ void RawTransport<prot>::listenTo(uint32_t port)
             ELOG_WARN("UDP transport existed, ignoring the listening request for port %d\n", port);
         } else {
             m_socket.udp.socket.reset(new udp::socket(m_ioService, udp::endpoint(udp::v4(), port)));
+            configureUdpSocket();
             receiveData();
         }
         break;
@@ -200,9 +305,6 @@ void RawTransport<prot>::listenTo(uint32_t port)
     default:
         break;
     }
-
-    if (m_workThread.get_id() == boost::thread::id()) // Not-A-Thread
-        m_workThread = boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService));
 }
 
 template<Protocol prot>
@@ -261,6 +363,7 @@ void RawTransport<prot>::listenTo(uint32_t minPort, uint32_t maxPort)
         } else {
             ELOG_WARN("UDP transport does not support listening in specific range.");
             m_socket.udp.socket.reset(new udp::socket(m_ioService, udp::endpoint(udp::v4(), 0)));
+            configureUdpSocket();
             receiveData();
         }
         break;
@@ -268,9 +371,32 @@ void RawTransport<prot>::listenTo(uint32_t minPort, uint32_t maxPort)
     default:
         break;
     }
+}
+
+template<Protocol prot>
+void RawTransport<prot>::configureUdpSocket()
+{
+    boost::system::error_code ec;
+    m_socket.udp.socket->set_option(boost::asio::socket_base::receive_buffer_size(kUdpKernelBufferSize), ec);
+    if (ec)
+        ELOG_WARN("Failed to enlarge UDP receive buffer: %s", ec.message().c_str());
+    m_socket.udp.socket->set_option(boost::asio::socket_base::send_buffer_size(kUdpKernelBufferSize), ec);
+    if (ec)
+        ELOG_WARN("Failed to enlarge UDP send buffer: %s", ec.message().c_str());
 
-    if (m_workThread.get_id() == boost::thread::id()) // Not-A-Thread
-        m_workThread = boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService));
+#ifdef SO_BUSY_POLL
+    int busyPoll = udpBusyPollUsec();
+    if (busyPoll > 0) {
+        // Not exposed through boost::asio; needs CAP_NET_ADMIN on older
+        // kernels, so a refusal is logged and ignored.
+        if (setsockopt(m_socket.udp.socket->native_handle(), SOL_SOCKET, SO_BUSY_POLL,
+                       &busyPoll, sizeof(busyPoll)) < 0) {
+            ELOG_WARN("Failed to enable UDP busy polling (%d us): %s", busyPoll, strerror(errno));
+        } else {
+            ELOG_DEBUG("UDP busy polling enabled, %d us", busyPoll);
+        }
+    }
+#endif
 }
 
 template<Protocol prot>
@@ -305,7 +431,10 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
 
     if (!ec || ec == boost::asio::error::message_size) {
         if (!m_tag) {
-            m_listener->onTransportData(m_receiveData.buffer.get(), bytes);
+            m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+            m_stats.receivedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            m_listener->onTransportData(m_currentLease.get(), bytes, m_currentLease);
+            m_currentLease.reset();
             receiveData();
             return;
         }
@@ -328,12 +457,14 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
                 if (payloadlen > m_bufferSize) {
                     m_bufferSize = ((payloadlen * BUFFER_EXPANSION_MULTIPLIER + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT) * BUFFER_ALIGNMENT;
                     ELOG_DEBUG("Increasing the buffer size: %zu", m_bufferSize);
-                    m_receiveData.buffer.reset(new char[m_bufferSize]);
+                    // Outstanding leases keep the old pool alive until they drain.
+                    m_bufferPool.reset(new ReceiveBufferPool(m_bufferSize));
+                    m_currentLease = acquireLease(m_bufferPool);
                 }
                 ELOG_DEBUG("readHandler(%zu):[%x,%x,%x,%x], payloadlen:%u", bytes, m_readHeader[0], m_readHeader[1], (unsigned char)m_readHeader[2], (unsigned char)m_readHeader[3], payloadlen);
 
                 m_receivedBytes = 0;
-                m_socket.tcp.socket->async_read_some(boost::asio::buffer(m_receiveData.buffer.get(), payloadlen),
+                m_socket.tcp.socket->async_read_some(boost::asio::buffer(m_currentLease.get(), payloadlen),
                     boost::bind(&RawTransport::readPacketHandler, this,
                         boost::asio::placeholders::error,
                         boost::asio::placeholders::bytes_transferred));
@@ -342,14 +473,20 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
         case UDP:
             assert(m_socket.udp.socket);
 
-            payloadlen = ntohl(*(reinterpret_cast<uint32_t*>(m_receiveData.buffer.get())));
-            if (bytes != payloadlen + 4) {
-                // FIXME: Make UDP work with large packets.
+            payloadlen = ntohl(*(reinterpret_cast<uint32_t*>(m_currentLease.get())));
+            if ((payloadlen & kFragmentFlag) && bytes >= kFragmentHeaderSize) {
+                // Part of a frame too large for one datagram; the lease is
+                // reused once the fragment is folded into the reassembly.
+                handleFragment(m_currentLease.get(), bytes);
+            } else if (bytes != payloadlen + 4) {
                 ELOG_WARN("Packet incomplete. with payloadlen:%u, bytes:%zu", payloadlen, bytes);
             } else {
-                unsigned char *p = reinterpret_cast<unsigned char*>(&(m_receiveData.buffer.get())[4]);
+                unsigned char *p = reinterpret_cast<unsigned char*>(&(m_currentLease.get())[4]);
                 ELOG_DEBUG("readHandler(%zu): [%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x,%x...%x,%x,%x,%x]", bytes, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15], p[payloadlen-4], p[payloadlen-3], p[payloadlen-2], p[payloadlen-1]);
-                m_listener->onTransportData(m_receiveData.buffer.get() + 4, payloadlen);
+                m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+                m_stats.receivedBytes.fetch_add(payloadlen, std::memory_order_relaxed);
+                m_listener->onTransportData(m_currentLease.get() + 4, payloadlen, m_currentLease);
+                m_currentLease.reset();
             }
 
             receiveData();
@@ -379,13 +516,16 @@ void RawTransport<prot>::readPacketHandler(const boost::system::error_code& ec,
             if (expectedLen > m_receivedBytes) {
                 ELOG_DEBUG("Expect to receive %u bytes, but actually received %zu bytes.", expectedLen, bytes);
                 ELOG_DEBUG("Continue receiving %u bytes.", expectedLen - m_receivedBytes);
-                m_socket.tcp.socket->async_read_some(boost::asio::buffer(m_receiveData.buffer.get() + m_receivedBytes, expectedLen - m_receivedBytes),
+                m_socket.tcp.socket->async_read_some(boost::asio::buffer(m_currentLease.get() + m_receivedBytes, expectedLen - m_receivedBytes),
                         boost::bind(&RawTransport::readPacketHandler, this,
                             boost::asio::placeholders::error,
                             boost::asio::placeholders::bytes_transferred));
             } else {
                 m_receivedBytes = 0;
-                m_listener->onTransportData(m_receiveData.buffer.get(), expectedLen);
+                m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+                m_stats.receivedBytes.fetch_add(expectedLen, std::memory_order_relaxed);
+                m_listener->onTransportData(m_currentLease.get(), expectedLen, m_currentLease);
+                m_currentLease.reset();
                 receiveData();
             }
             break;
@@ -402,19 +542,160 @@ void RawTransport<prot>::readPacketHandler(const boost::system::error_code& ec,
     }
 }
 
+template<Protocol prot>
+void RawTransport<prot>::readBatchHandler(const boost::system::error_code& ec)
+{
+    if (m_isClosing)
+        return;
+
+    if (ec && ec != boost::asio::error::message_size) {
+        ELOG_DEBUG("Error receiving UDP data: %s", ec.message().c_str());
+        m_listener->onTransportError();
+        return;
+    }
+
+    if (!m_batchBuffer)
+        m_batchBuffer.reset(new char[kUdpBatchSize * m_bufferSize]);
+
+    struct mmsghdr msgs[kUdpBatchSize];
+    struct iovec iovs[kUdpBatchSize];
+    struct sockaddr_storage addrs[kUdpBatchSize];
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < kUdpBatchSize; i++) {
+        iovs[i].iov_base = m_batchBuffer.get() + i * m_bufferSize;
+        iovs[i].iov_len = m_bufferSize;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    }
+
+    int received = recvmmsg(m_socket.udp.socket->native_handle(), msgs, kUdpBatchSize, MSG_DONTWAIT, NULL);
+    for (int i = 0; i < received; i++) {
+        char* buf = m_batchBuffer.get() + i * m_bufferSize;
+        size_t bytes = msgs[i].msg_len;
+        uint32_t payloadlen = bytes >= 4 ? ntohl(*(reinterpret_cast<uint32_t*>(buf))) : 0;
+        if ((payloadlen & kFragmentFlag) && bytes >= kFragmentHeaderSize) {
+            handleFragment(buf, bytes);
+        } else if (bytes != payloadlen + 4) {
+            ELOG_WARN("Packet incomplete. with payloadlen:%u, bytes:%zu", payloadlen, bytes);
+        } else {
+            m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+            m_stats.receivedBytes.fetch_add(payloadlen, std::memory_order_relaxed);
+            m_listener->onTransportData(buf + 4, payloadlen);
+        }
+    }
+
+    receiveData();
+}
+
+template<Protocol prot>
+void RawTransport<prot>::handleFragment(const char* buf, size_t bytes)
+{
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(buf);
+    uint32_t frameId = ntohl(words[0]) & ~kFragmentFlag;
+    uint32_t totalLength = ntohl(words[1]);
+    uint32_t offset = ntohl(words[2]);
+    uint32_t payloadLength = ntohl(words[3]);
+
+    if (bytes != kFragmentHeaderSize + payloadLength
+        || offset + payloadLength > totalLength
+        || totalLength > kMaxFragmentedFrameSize) {
+        ELOG_WARN("Fragment invalid. frameId:%u, total:%u, offset:%u, payloadlen:%u, bytes:%zu",
+            frameId, totalLength, offset, payloadLength, bytes);
+        return;
+    }
+
+    if (totalLength > m_fragmentBufferSize) {
+        m_fragmentBufferSize = ((totalLength * BUFFER_EXPANSION_MULTIPLIER + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT) * BUFFER_ALIGNMENT;
+        ELOG_DEBUG("Increasing the reassembly buffer size: %zu", m_fragmentBufferSize);
+        m_fragmentBuffer.reset(new char[m_fragmentBufferSize]);
+    }
+
+    if (frameId != m_fragmentFrameId || totalLength != m_fragmentTotal) {
+        // A new frame started; an incomplete predecessor is dropped, same as
+        // a whole lost datagram in the legacy format.
+        if (m_fragmentReceived > 0 && m_fragmentReceived < m_fragmentTotal) {
+            ELOG_DEBUG("Dropping incomplete fragmented frame %u (%u of %u bytes)",
+                m_fragmentFrameId, m_fragmentReceived, m_fragmentTotal);
+            m_stats.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_fragmentFrameId = frameId;
+        m_fragmentTotal = totalLength;
+        m_fragmentReceived = 0;
+    }
+
+    memcpy(m_fragmentBuffer.get() + offset, buf + kFragmentHeaderSize, payloadLength);
+    m_fragmentReceived += payloadLength;
+
+    if (m_fragmentReceived == m_fragmentTotal) {
+        m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+        m_stats.receivedBytes.fetch_add(m_fragmentTotal, std::memory_order_relaxed);
+        // The reassembly buffer is reused for the next frame, so this goes
+        // through the copying entry point like the batched receive path.
+        m_listener->onTransportData(m_fragmentBuffer.get(), m_fragmentTotal);
+        m_fragmentTotal = 0;
+        m_fragmentReceived = 0;
+    }
+}
+
+template<Protocol prot>
+size_t RawTransport<prot>::totalQueuedLocked() const
+{
+    size_t total = 0;
+    for (int lane = 0; lane < NUM_SEND_LANES; lane++)
+        total += m_sendQueues[lane].size();
+    return total;
+}
+
+template<Protocol prot>
+int RawTransport<prot>::topLaneLocked() const
+{
+    // A fragmented frame's datagrams must stay contiguous on the wire: the
+    // receiver keeps a single reassembly context, so a keyframe preempting a
+    // half-sent delta frame would make the receiver drop the partial frame
+    // and the trailing fragments could never complete. The latch pins the
+    // lane until the frame's last fragment has been popped; its remaining
+    // fragments are already queued (sendFragmented enqueues a whole frame
+    // under one lock), so the pinned queue cannot be empty here.
+    if (m_latchedLane >= 0 && !m_sendQueues[m_latchedLane].empty())
+        return m_latchedLane;
+    for (int lane = 0; lane < NUM_SEND_LANES; lane++) {
+        if (!m_sendQueues[lane].empty())
+            return lane;
+    }
+    return -1;
+}
+
 template<Protocol prot>
 void RawTransport<prot>::doSend()
 {
     if (m_isClosing)
         return;
 
-    TransportData& data = m_sendQueue.front();
+    if (prot == UDP && m_batchedUdp && totalQueuedLocked() > 1) {
+        if (doSendBatchLocked())
+            return;
+    }
+
+    m_sendingLane = topLaneLocked();
+    if (m_sendingLane < 0)
+        return;
+
+    TransportData& data = m_sendQueues[m_sendingLane].front();
+
+    // Gather the (prefix+header) buffer and, for zero-copy frames, the
+    // payload owned by its PayloadBuffer reference.
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.push_back(boost::asio::buffer(data.buffer.get(), data.length));
+    if (data.payload)
+        buffers.push_back(boost::asio::buffer(data.payloadData, data.payloadLength));
 
     switch (prot) {
     case TCP:
         ELOG_DEBUG("Port#%d to send(%d)", m_socket.tcp.socket->local_endpoint().port(), data.length);
         assert(m_socket.tcp.socket);
-        boost::asio::async_write(*(m_socket.tcp.socket), boost::asio::buffer(data.buffer.get(), data.length),
+        boost::asio::async_write(*(m_socket.tcp.socket), buffers,
             boost::bind(&RawTransport::writeHandler, this,
                 boost::asio::placeholders::error,
                 boost::asio::placeholders::bytes_transferred));
@@ -422,14 +703,12 @@ void RawTransport<prot>::doSend()
     case UDP:
         assert(m_socket.udp.socket);
         if (!m_socket.udp.connected) {
-            boost::system::error_code ignored_error;
-            m_socket.udp.socket->async_send(boost::asio::buffer(data.buffer.get(), data.length),
+            m_socket.udp.socket->async_send(buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
-            boost::system::error_code ignored_error;
-            m_socket.udp.socket->async_send_to(boost::asio::buffer(data.buffer.get(), data.length),
+            m_socket.udp.socket->async_send_to(buffers,
                 m_socket.udp.remoteEndpoint,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
@@ -441,6 +720,85 @@ void RawTransport<prot>::doSend()
     }
 }
 
+template<Protocol prot>
+bool RawTransport<prot>::doSendBatchLocked()
+{
+    struct mmsghdr msgs[kUdpBatchSize];
+    struct iovec iovs[kUdpBatchSize][2];
+    memset(msgs, 0, sizeof(msgs));
+
+    int count = 0;
+    int lanes[kUdpBatchSize];
+    auto gather = [&](const TransportData& data, int lane) {
+        iovs[count][0].iov_base = data.buffer.get();
+        iovs[count][0].iov_len = data.length;
+        msgs[count].msg_hdr.msg_iov = iovs[count];
+        msgs[count].msg_hdr.msg_iovlen = 1;
+        if (data.payload) {
+            iovs[count][1].iov_base = const_cast<uint8_t*>(data.payloadData);
+            iovs[count][1].iov_len = data.payloadLength;
+            msgs[count].msg_hdr.msg_iovlen = 2;
+        }
+        if (m_socket.udp.connected) {
+            msgs[count].msg_hdr.msg_name = m_socket.udp.remoteEndpoint.data();
+            msgs[count].msg_hdr.msg_namelen = m_socket.udp.remoteEndpoint.size();
+        }
+        lanes[count] = lane;
+        count++;
+    };
+    // std::queue only exposes its front, so walk a cheap copy (buffers are
+    // shared_arrays) to build the message array without disturbing the queues
+    // until the syscall has told us how many actually went out. The rest of a
+    // half-sent fragmented frame comes first - its fragments must stay
+    // contiguous on the wire - then lanes are walked in strict priority
+    // order, matching the single-message path.
+    int pinned = 0;
+    if (m_latchedLane >= 0) {
+        std::queue<TransportData> pending = m_sendQueues[m_latchedLane];
+        while (count < kUdpBatchSize && !pending.empty()) {
+            bool lastFragment = !pending.front().moreFragments;
+            gather(pending.front(), m_latchedLane);
+            pinned++;
+            if (lastFragment)
+                break;
+            pending.pop();
+        }
+    }
+    for (int lane = 0; lane < NUM_SEND_LANES && count < kUdpBatchSize; lane++) {
+        std::queue<TransportData> pending = m_sendQueues[lane];
+        if (lane == m_latchedLane) {
+            for (int skip = 0; skip < pinned && !pending.empty(); skip++)
+                pending.pop();
+        }
+        while (count < kUdpBatchSize && !pending.empty()) {
+            gather(pending.front(), lane);
+            pending.pop();
+        }
+    }
+
+    int sent = sendmmsg(m_socket.udp.socket->native_handle(), msgs, count, MSG_DONTWAIT);
+    if (sent <= 0)
+        return false; // Not writable right now; fall back to the async path.
+
+    // sendmmsg may stop short of the batch, so re-derive the latch from what
+    // actually went out: a frame cut mid-batch keeps its lane pinned.
+    for (int i = 0; i < sent; i++) {
+        TransportData& data = m_sendQueues[lanes[i]].front();
+        if (data.payload)
+            data.payload->release();
+        m_stats.queuedMessages.fetch_sub(1, std::memory_order_relaxed);
+        m_stats.queuedBytes.fetch_sub(data.length + data.payloadLength, std::memory_order_relaxed);
+        m_stats.sentMessages.fetch_add(1, std::memory_order_relaxed);
+        m_stats.sentBytes.fetch_add(data.length + data.payloadLength, std::memory_order_relaxed);
+        m_latchedLane = data.moreFragments ? lanes[i] : -1;
+        m_sendQueues[lanes[i]].pop();
+    }
+
+    if (topLaneLocked() >= 0)
+        doSend();
+    return true;
+}
+
 template<Protocol prot>
 void RawTransport<prot>::writeHandler(const boost::system::error_code& ec, std::size_t bytes)
 {
@@ -454,10 +812,18 @@ void RawTransport<prot>::writeHandler(const boost::system::error_code& ec, std::
     ELOG_DEBUG("writeHandler(%zu)", bytes);
 
     boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-    assert(m_sendQueue.size() > 0);
-    m_sendQueue.pop();
+    assert(!m_sendQueues[m_sendingLane].empty());
+    TransportData& data = m_sendQueues[m_sendingLane].front();
+    if (data.payload)
+        data.payload->release();
+    m_stats.queuedMessages.fetch_sub(1, std::memory_order_relaxed);
+    m_stats.queuedBytes.fetch_sub(data.length + data.payloadLength, std::memory_order_relaxed);
+    m_stats.sentMessages.fetch_add(1, std::memory_order_relaxed);
+    m_stats.sentBytes.fetch_add(bytes, std::memory_order_relaxed);
+    m_latchedLane = data.moreFragments ? m_sendingLane : -1;
+    m_sendQueues[m_sendingLane].pop();
 
-    if (m_sendQueue.size() > 0)
+    if (topLaneLocked() >= 0)
         doSend();
 }
 
@@ -494,10 +860,28 @@ void RawTransport<prot>::dumpTcpSSLv3Header(const char* buf, int len)
     }
 }
 
+template<Protocol prot>
+void RawTransport<prot>::queueData(const TransportData& data, int lane)
+{
+    boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
+    m_stats.queuedMessages.fetch_add(1, std::memory_order_relaxed);
+    m_stats.queuedBytes.fetch_add(data.length + data.payloadLength, std::memory_order_relaxed);
+    m_sendQueues[lane].push(data);
+    // Report once per excursion past the watermark, not per message.
+    if (totalQueuedLocked() == kSendQueueBackpressure && HostLoadGovernor::enabled())
+        HostLoadGovernor::instance().reportBackpressure();
+    if (totalQueuedLocked() == 1)
+        doSend();
+}
+
 template<Protocol prot>
 void RawTransport<prot>::sendData(const char* buf, int len)
 {
     TransportData data;
+    data.payload = nullptr;
+    data.payloadData = nullptr;
+    data.payloadLength = 0;
+    data.moreFragments = false;
     if (m_tag) {
         data.buffer.reset(new char[len + 4]);
         *(reinterpret_cast<uint32_t*>(data.buffer.get())) = htonl(len);
@@ -509,16 +893,18 @@ void RawTransport<prot>::sendData(const char* buf, int len)
         data.length = len;
     }
 
-    boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-    m_sendQueue.push(data);
-    if (m_sendQueue.size() == 1)
-        doSend();
+    // Control and feedback messages ride the top-priority lane.
+    queueData(data, LANE_AUDIO);
 }
 
 template<Protocol prot>
-void RawTransport<prot>::sendData(const char* header, int headerLength, const char* payload, int payloadLength)
+void RawTransport<prot>::sendDataOnLane(const char* header, int headerLength, const char* payload, int payloadLength, int lane)
 {
     TransportData data;
+    data.payload = nullptr;
+    data.payloadData = nullptr;
+    data.payloadLength = 0;
+    data.moreFragments = false;
     if (m_tag) {
         data.buffer.reset(new char[headerLength + payloadLength + 4]);
         *(reinterpret_cast<uint32_t*>(data.buffer.get())) = htonl(headerLength + payloadLength);
@@ -532,17 +918,123 @@ void RawTransport<prot>::sendData(const char* header, int headerLength, const ch
         data.length = headerLength + payloadLength;
     }
 
+    queueData(data, lane);
+}
+
+template<Protocol prot>
+void RawTransport<prot>::sendData(const char* header, int headerLength, const char* payload, int payloadLength)
+{
+    sendDataOnLane(header, headerLength, payload, payloadLength, LANE_AUDIO);
+}
+
+template<Protocol prot>
+void RawTransport<prot>::sendFrame(const char* header, int headerLength, const Frame& frame)
+{
+    if (prot == UDP && m_tag && largeUdpFramesEnabled()
+        && (size_t)(4 + headerLength + frame.length) > udpDatagramSize()) {
+        sendFragmented(header, headerLength, frame);
+        return;
+    }
+
+    PayloadBuffer* payload = retainFramePayload(frame);
+    if (!payload) {
+        sendDataOnLane(header, headerLength,
+            reinterpret_cast<const char*>(frame.payload), frame.length, laneForFrame(frame));
+        return;
+    }
+
+    TransportData data;
+    data.payload = payload;
+    data.payloadData = frame.payload;
+    data.payloadLength = frame.length;
+    data.moreFragments = false;
+    if (m_tag) {
+        data.buffer.reset(new char[headerLength + 4]);
+        *(reinterpret_cast<uint32_t*>(data.buffer.get())) = htonl(headerLength + frame.length);
+        memcpy(data.buffer.get() + 4, header, headerLength);
+        data.length = headerLength + 4;
+    } else {
+        data.buffer.reset(new char[headerLength]);
+        memcpy(data.buffer.get(), header, headerLength);
+        data.length = headerLength;
+    }
+
+    queueData(data, laneForFrame(frame));
+}
+
+template<Protocol prot>
+void RawTransport<prot>::sendFragmented(const char* header, int headerLength, const Frame& frame)
+{
+    // Slice the logical message [frame header | payload] into MTU-sized
+    // fragments. The frame header rides in the first fragment; buffer-backed
+    // payloads are gathered from their own storage fragment by fragment, so
+    // the bitstream is still never copied on the way out.
+    PayloadBuffer* payload = retainFramePayload(frame);
+
+    const uint32_t maxChunk = udpDatagramSize() - kFragmentHeaderSize;
+    uint32_t totalLength = headerLength + frame.length;
+    uint32_t frameId = m_sendFrameId++ & ~kFragmentFlag;
+
+    std::vector<TransportData> fragments;
+    uint32_t payloadOffset = 0;
+    bool first = true;
+    while (first || payloadOffset < frame.length) {
+        uint32_t headBytes = first ? (uint32_t)headerLength : 0;
+        uint32_t chunk = std::min(maxChunk - headBytes, frame.length - payloadOffset);
+
+        TransportData data;
+        data.payload = nullptr;
+        data.payloadData = nullptr;
+        data.payloadLength = 0;
+        data.moreFragments = payloadOffset + chunk < frame.length;
+        data.length = kFragmentHeaderSize + headBytes + (payload ? 0 : chunk);
+        data.buffer.reset(new char[data.length]);
+
+        uint32_t* words = reinterpret_cast<uint32_t*>(data.buffer.get());
+        words[0] = htonl(kFragmentFlag | frameId);
+        words[1] = htonl(totalLength);
+        words[2] = htonl(first ? 0 : headerLength + payloadOffset);
+        words[3] = htonl(headBytes + chunk);
+        if (headBytes)
+            memcpy(data.buffer.get() + kFragmentHeaderSize, header, headBytes);
+        if (payload) {
+            payload->retain();
+            data.payload = payload;
+            data.payloadData = frame.payload + payloadOffset;
+            data.payloadLength = chunk;
+        } else {
+            memcpy(data.buffer.get() + kFragmentHeaderSize + headBytes, frame.payload + payloadOffset, chunk);
+        }
+        fragments.push_back(data);
+
+        payloadOffset += chunk;
+        first = false;
+    }
+    if (payload)
+        payload->release();
+
+    int lane = laneForFrame(frame);
     boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-    m_sendQueue.push(data);
-    if (m_sendQueue.size() == 1)
+    bool wasEmpty = totalQueuedLocked() == 0;
+    for (size_t i = 0; i < fragments.size(); i++) {
+        m_stats.queuedMessages.fetch_add(1, std::memory_order_relaxed);
+        m_stats.queuedBytes.fetch_add(fragments[i].length + fragments[i].payloadLength, std::memory_order_relaxed);
+        m_sendQueues[lane].push(fragments[i]);
+        // Report once per excursion past the watermark, not per message.
+        if (totalQueuedLocked() == kSendQueueBackpressure && HostLoadGovernor::enabled())
+            HostLoadGovernor::instance().reportBackpressure();
+    }
+    if (wasEmpty)
         doSend();
 }
 
 template<Protocol prot>
 void RawTransport<prot>::receiveData()
 {
-    if (!m_receiveData.buffer)
-        m_receiveData.buffer.reset(new char[m_bufferSize]);
+    if (!m_bufferPool || m_bufferPool->bufferSize() != m_bufferSize)
+        m_bufferPool.reset(new ReceiveBufferPool(m_bufferSize));
+    if (!m_currentLease)
+        m_currentLease = acquireLease(m_bufferPool);
 
     switch (prot) {
     case TCP:
@@ -553,7 +1045,7 @@ void RawTransport<prot>::receiveData()
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
-            m_socket.tcp.socket->async_read_some(boost::asio::buffer(m_receiveData.buffer.get(), m_bufferSize),
+            m_socket.tcp.socket->async_read_some(boost::asio::buffer(m_currentLease.get(), m_bufferSize),
                 boost::bind(&RawTransport::readHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
@@ -561,13 +1053,19 @@ void RawTransport<prot>::receiveData()
         break;
     case UDP:
         assert(m_socket.udp.socket);
-        if (!m_socket.udp.connected) {
-            m_socket.udp.socket->async_receive(boost::asio::buffer(m_receiveData.buffer.get(), m_bufferSize),
+        if (m_batchedUdp) {
+            // Wait for readability only; readBatchHandler drains everything
+            // available with a single recvmmsg.
+            m_socket.udp.socket->async_receive(boost::asio::null_buffers(),
+                boost::bind(&RawTransport::readBatchHandler, this,
+                    boost::asio::placeholders::error));
+        } else if (!m_socket.udp.connected) {
+            m_socket.udp.socket->async_receive(boost::asio::buffer(m_currentLease.get(), m_bufferSize),
                 boost::bind(&RawTransport::readHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
-            m_socket.udp.socket->async_receive_from(boost::asio::buffer(m_receiveData.buffer.get(), m_bufferSize),
+            m_socket.udp.socket->async_receive_from(boost::asio::buffer(m_currentLease.get(), m_bufferSize),
                 m_socket.udp.remoteEndpoint,
                 boost::bind(&RawTransport::readHandler, this,
                     boost::asio::placeholders::error,
@@ -5,6 +5,7 @@
 #ifndef RawTransport_h
 #define RawTransport_h
 
+#include <atomic>
 #include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
@@ -12,9 +13,78 @@
 #include <boost/thread/mutex.hpp>
 #include <logger.h>
 #include <queue>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "HeapAccounting.h"
+#include "PayloadBuffer.h"
 
 namespace owt_base {
 
+// Recycling pool for receive buffers of one fixed size. Leases returned to
+// listeners keep the buffer alive (and out of the pool) for as long as any
+// copy of the lease exists, so downstream consumers can hold received data
+// without copying it.
+class ReceiveBufferPool {
+public:
+    explicit ReceiveBufferPool(size_t bufferSize)
+        : m_bufferSize(bufferSize)
+    {
+    }
+
+    ~ReceiveBufferPool()
+    {
+        for (size_t i = 0; i < m_free.size(); ++i) {
+            HeapAccounting::sub(HeapAccounting::kTransport, m_bufferSize);
+            delete [] m_free[i];
+        }
+    }
+
+    size_t bufferSize() const { return m_bufferSize; }
+
+    char* acquire()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!m_free.empty()) {
+            char* buffer = m_free.back();
+            m_free.pop_back();
+            return buffer;
+        }
+        HeapAccounting::add(HeapAccounting::kTransport, m_bufferSize);
+        return new char[m_bufferSize];
+    }
+
+    void release(char* buffer)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_free.size() < kMaxPooled) {
+            m_free.push_back(buffer);
+        } else {
+            HeapAccounting::sub(HeapAccounting::kTransport, m_bufferSize);
+            delete [] buffer;
+        }
+    }
+
+private:
+    static const size_t kMaxPooled = 32;
+
+    size_t m_bufferSize;
+    std::vector<char*> m_free;
+    boost::mutex m_mutex;
+};
+
+// A leased receive buffer; the deleter hands the storage back to its pool.
+// The pool is captured by shared_ptr, so leases stay valid even if the
+// transport (and with it the pool's primary reference) goes away first.
+typedef boost::shared_ptr<char> BufferLease;
+
+inline BufferLease acquireLease(const boost::shared_ptr<ReceiveBufferPool>& pool)
+{
+    char* buffer = pool->acquire();
+    return BufferLease(buffer, [pool](char* p) { pool->release(p); });
+}
+
 const char TDT_FEEDBACK_MSG = 0x5A;
 const char TDT_MEDIA_FRAME = 0x8F;
 
@@ -23,14 +93,76 @@ enum Protocol {
     UDP
 };
 
+// Strict-priority send lanes. Audio (and the small control/feedback
+// messages) go ahead of video keyframes, which go ahead of deltas, so a
+// keyframe burst on a congested link never queues behind itself the audio
+// that was produced alongside it. Order is still FIFO within a lane.
+enum SendLane {
+    LANE_AUDIO = 0,
+    LANE_VIDEO_KEY,
+    LANE_VIDEO_DELTA,
+    NUM_SEND_LANES
+};
+
+inline int laneForFrame(const Frame& frame)
+{
+    if (!isVideoFrame(frame))
+        return LANE_AUDIO;
+    return frame.additionalInfo.video.isKeyFrame ? LANE_VIDEO_KEY : LANE_VIDEO_DELTA;
+}
+
 class RawTransportListener {
 public:
     virtual ~RawTransportListener() { }
     virtual void onTransportData(char*, int len) = 0;
+    // Lease-aware delivery: listeners that want to hold the buffer beyond
+    // the callback keep a copy of the lease instead of copying the bytes.
+    // The default forwards to the legacy entry point.
+    virtual void onTransportData(char* buf, int len, const BufferLease&)
+    {
+        onTransportData(buf, len);
+    }
     virtual void onTransportError() = 0;
     virtual void onTransportConnected() = 0;
 };
 
+// Lock-free per-connection counters for the telemetry surface. The hot path
+// bumps relaxed atomics; readers snapshot them through getStats().
+struct TransportStats {
+    TransportStats()
+        : sentMessages(0), sentBytes(0), receivedMessages(0), receivedBytes(0)
+        , droppedMessages(0), queuedMessages(0), queuedBytes(0)
+    {
+    }
+
+    std::atomic<uint64_t> sentMessages;
+    std::atomic<uint64_t> sentBytes;
+    std::atomic<uint64_t> receivedMessages;
+    std::atomic<uint64_t> receivedBytes;
+    std::atomic<uint64_t> droppedMessages;
+    // Current send queue occupancy, i.e. bytes in flight towards the socket.
+    std::atomic<uint64_t> queuedMessages;
+    std::atomic<uint64_t> queuedBytes;
+
+    std::string report() const
+    {
+        char buf[320];
+        snprintf(buf, sizeof(buf),
+            "{\"sentMessages\":%llu,\"sentBytes\":%llu,"
+            "\"receivedMessages\":%llu,\"receivedBytes\":%llu,"
+            "\"droppedMessages\":%llu,"
+            "\"queuedMessages\":%llu,\"queuedBytes\":%llu}",
+            (unsigned long long)sentMessages.load(std::memory_order_relaxed),
+            (unsigned long long)sentBytes.load(std::memory_order_relaxed),
+            (unsigned long long)receivedMessages.load(std::memory_order_relaxed),
+            (unsigned long long)receivedBytes.load(std::memory_order_relaxed),
+            (unsigned long long)droppedMessages.load(std::memory_order_relaxed),
+            (unsigned long long)queuedMessages.load(std::memory_order_relaxed),
+            (unsigned long long)queuedBytes.load(std::memory_order_relaxed));
+        return buf;
+    }
+};
+
 class RawTransportInterface {
 public:
     virtual ~RawTransportInterface() { }
@@ -39,9 +171,17 @@ public:
     virtual void listenTo(uint32_t minPort, uint32_t maxPort) = 0;
     virtual void sendData(const char*, int len) = 0;
     virtual void sendData(const char* header, int headerLength, const char* payload, int payloadLength) = 0;
+    // Vectored send of a framed media frame. Buffer-backed frames are queued
+    // with a payload reference and hit the socket zero-copy (framing prefix
+    // and header in one small buffer, payload gathered from its own); frames
+    // with a raw payload fall back to the flattened sendData path.
+    virtual void sendFrame(const char* header, int headerLength, const Frame& frame) = 0;
     virtual void close() = 0;
 
     virtual unsigned short getListeningPort() = 0;
+
+    // JSON counter snapshot; see TransportStats.
+    virtual std::string getStats() { return "{}"; }
 };
 
 template<Protocol prot>
@@ -56,19 +196,51 @@ public:
     void listenTo(uint32_t minPort, uint32_t maxPort);
     void sendData(const char*, int len);
     void sendData(const char* header, int headerLength, const char* payload, int payloadLength);
+    void sendFrame(const char* header, int headerLength, const Frame& frame);
     void close();
 
     unsigned short getListeningPort();
+    std::string getStats() { return m_stats.report(); }
 
 private:
     typedef struct {
         boost::shared_array<char> buffer;
         int length;
+        // Optional gathered payload: a retained reference released once the
+        // socket write completes, so the bitstream itself is never copied.
+        PayloadBuffer* payload;
+        const uint8_t* payloadData;
+        int payloadLength;
+        // True while more fragments of the same frame follow in this lane;
+        // they must leave the wire contiguously (the receiver keeps a single
+        // reassembly context), so the sender may not switch lanes mid-frame.
+        bool moreFragments;
     } TransportData;
 
     void doSend();
+    // Flushes up to a whole batch of queued UDP datagrams with one sendmmsg;
+    // returns true if the queue head was consumed. Called with
+    // m_sendQueueMutex held.
+    bool doSendBatchLocked();
+    // Splits a frame too large for one datagram into MTU-sized fragments;
+    // see the fragment framing notes in RawTransport.cpp.
+    void sendFragmented(const char* header, int headerLength, const Frame& frame);
+    // Reassembles one incoming fragment into m_fragmentBuffer and delivers
+    // the frame once all its bytes have arrived.
+    void handleFragment(const char* buf, size_t bytes);
+    // Enlarges the kernel socket buffers on an open UDP socket.
+    void configureUdpSocket();
+    // Flattens header+payload into one framed message on the given lane.
+    void sendDataOnLane(const char* header, int headerLength, const char* payload, int payloadLength, int lane);
+    // Enqueues one message on its lane and kicks the socket if idle.
+    void queueData(const TransportData& data, int lane);
+    // Lane bookkeeping; both called with m_sendQueueMutex held.
+    size_t totalQueuedLocked() const;
+    int topLaneLocked() const;
     void receiveData();
     void readHandler(const boost::system::error_code&, std::size_t);
+    // Drains all readable UDP datagrams with recvmmsg on one wakeup.
+    void readBatchHandler(const boost::system::error_code&);
     void readPacketHandler(const boost::system::error_code&, std::size_t);
     void writeHandler(const boost::system::error_code&, std::size_t);
     void connectHandler(const boost::system::error_code&);
@@ -77,24 +249,35 @@ private:
 
     bool m_isClosing;
     bool m_tag;
+    // Batched UDP mode (recvmmsg/sendmmsg); see OWT_UDP_BATCH.
+    bool m_batchedUdp;
+    TransportStats m_stats;
     char m_readHeader[4];
     size_t m_bufferSize;
-    TransportData m_receiveData;
-    std::queue<TransportData> m_sendQueue;
+    boost::shared_ptr<ReceiveBufferPool> m_bufferPool;
+    BufferLease m_currentLease;
+    boost::shared_array<char> m_batchBuffer;
+    // Fragmented large-frame state: outgoing frame sequence, and the one
+    // in-flight reassembly (grown to the largest frame observed so far).
+    uint32_t m_sendFrameId;
+    boost::shared_array<char> m_fragmentBuffer;
+    size_t m_fragmentBufferSize;
+    uint32_t m_fragmentFrameId;
+    uint32_t m_fragmentTotal;
+    uint32_t m_fragmentReceived;
+    std::queue<TransportData> m_sendQueues[NUM_SEND_LANES];
+    // Lane of the message currently being written by the async path.
+    int m_sendingLane;
+    // Lane pinned mid-fragmented-frame (-1 when none): a higher-priority
+    // lane must not preempt until the frame's last fragment is out.
+    int m_latchedLane;
     boost::mutex m_sendQueueMutex;
 
-    // We need to ensure the order of the object destructions. In this case the
-    // io_service object must be destructed after the socket objects, because in
-    // the destructor of the socket objects it will tell the io_service to do
-    // something like closing the descriptor, etc. In other words, the sockets
-    // depend on io_service.
-    // We ensure the order based on the C++ standard that the non-static members
-    // are destructed in the reverse order they were created, so DON'T change
-    // the order of the member declarations here.
-    // Alternatively, we may make the io_service object reference counted but it
-    // introduces unnecessary complexity.
-    boost::asio::io_service m_ioService;
-    boost::thread m_workThread;
+    // The io_service is owned by the process-wide IOServicePool and outlives
+    // this transport; each transport is bound to one pool service, which
+    // keeps its handlers single-threaded. close() drains queued handlers off
+    // the service before the sockets are destructed.
+    boost::asio::io_service& m_ioService;
     struct Socket {
         Socket() { }
         ~Socket() { }
@@ -0,0 +1,518 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SVTAV1Encoder.h"
+
+#include <webrtc/api/video/video_frame.h>
+#include <webrtc/api/video/video_frame_buffer.h>
+
+#include <libyuv/convert.h>
+#include <libyuv/planar_functions.h>
+#include <libyuv/scale.h>
+
+#include "MediaUtilities.h"
+#include "PayloadBuffer.h"
+
+namespace owt_base {
+
+DEFINE_LOGGER(SVTAV1Encoder, "owt.SVTAV1Encoder");
+
+SVTAV1Encoder::SVTAV1Encoder(FrameFormat format, VideoCodecProfile profile, bool useSimulcast)
+    : m_encoderReady(false)
+    , m_dest(NULL)
+    , m_width(0)
+    , m_height(0)
+    , m_frameRate(0)
+    , m_bitrateKbps(0)
+    , m_keyFrameIntervalSeconds(0)
+    , m_handle(NULL)
+    , m_forceIDR(false)
+    , m_lastIngestMs(0)
+    , m_frameCount(0)
+    , m_frameEncodedCount(0)
+    , m_enableBsDump(false)
+    , m_bsDumpfp(NULL)
+{
+    memset(&m_encParameters, 0, sizeof(m_encParameters));
+
+    m_srv       = boost::make_shared<boost::asio::io_service>();
+    m_srvWork   = boost::make_shared<boost::asio::io_service::work>(*m_srv);
+    m_thread    = boost::make_shared<boost::thread>(boost::bind(&boost::asio::io_service::run, m_srv));
+}
+
+SVTAV1Encoder::~SVTAV1Encoder()
+{
+    m_srvWork.reset();
+    m_srv->stop();
+    m_thread.reset();
+    m_srv.reset();
+
+    if (m_encoderReady) {
+        svt_av1_enc_deinit(m_handle);
+        svt_av1_enc_deinit_handle(m_handle);
+
+        deallocateBuffers();
+
+        if (m_bsDumpfp) {
+            fclose(m_bsDumpfp);
+            m_bsDumpfp = NULL;
+        }
+
+        m_encoderReady = false;
+    }
+
+    m_dest = NULL;
+}
+
+void SVTAV1Encoder::initDefaultParameters()
+{
+    // Encoding preset, tuned for live latency like the HEVC side's encMode 9
+    m_encParameters.enc_mode                = 9;
+
+    // GOP Structure: low delay, closed GOP driven by intra_period_length
+    m_encParameters.pred_structure          = SVT_AV1_PRED_LOW_DELAY_B;
+    m_encParameters.intra_period_length     = 255;
+    m_encParameters.intra_refresh_type      = SVT_AV1_KF_REFRESH;
+    m_encParameters.hierarchical_levels     = 0;
+
+    // Input Info
+    m_encParameters.source_width            = 0;
+    m_encParameters.source_height           = 0;
+    m_encParameters.frame_rate_numerator    = 0;
+    m_encParameters.frame_rate_denominator  = 1;
+    m_encParameters.encoder_bit_depth       = 8;
+
+    // Rate Control
+    m_encParameters.rate_control_mode       = SVT_AV1_RC_MODE_VBR;
+    m_encParameters.scene_change_detection  = 1;
+    m_encParameters.look_ahead_distance     = 0;
+    m_encParameters.target_bit_rate         = 0;
+    m_encParameters.max_qp_allowed          = 56;
+    m_encParameters.min_qp_allowed          = 10;
+
+    // requestKeyFrame relies on per-picture pic_type overrides
+    m_encParameters.force_key_frames        = 1;
+
+    // Threads management
+    m_encParameters.logical_processors      = 0;
+    m_encParameters.target_socket           = -1;
+}
+
+void SVTAV1Encoder::updateParameters(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds)
+{
+    //resolution
+    m_encParameters.source_width            = width;
+    m_encParameters.source_height           = height;
+
+    //gop, matches the HEVC side's short-period choice
+    m_encParameters.intra_period_length     = frameRate >> 1;
+
+    //framerate
+    m_encParameters.frame_rate_numerator    = frameRate;
+    m_encParameters.frame_rate_denominator  = 1;
+
+    //bitrate
+    m_encParameters.target_bit_rate         = bitrateKbps * 1000;
+}
+
+bool SVTAV1Encoder::canSimulcast(FrameFormat format, uint32_t width, uint32_t height)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    return false;
+}
+
+bool SVTAV1Encoder::isIdle()
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    return (m_dest == NULL);
+}
+
+bool SVTAV1Encoder::initEncoder(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds)
+{
+    EbErrorType return_error = EB_ErrorNone;
+
+    ELOG_DEBUG_T("initEncoder: width=%d, height=%d, frameRate=%d, bitrateKbps=%d, .keyFrameIntervalSeconds=%d}"
+            , width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds);
+
+    return_error = svt_av1_enc_init_handle(&m_handle, this, &m_encParameters);
+    if (return_error != EB_ErrorNone) {
+        ELOG_ERROR_T("InitHandle failed, ret 0x%x", return_error);
+        return false;
+    }
+
+    initDefaultParameters();
+    updateParameters(width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds);
+
+    return_error = svt_av1_enc_set_parameter(m_handle, &m_encParameters);
+    if (return_error != EB_ErrorNone) {
+        ELOG_ERROR_T("SetParameter failed, ret 0x%x", return_error);
+
+        svt_av1_enc_deinit_handle(m_handle);
+        return false;
+    }
+
+    return_error = svt_av1_enc_init(m_handle);
+    if (return_error != EB_ErrorNone) {
+        ELOG_ERROR_T("InitEncoder failed, ret 0x%x", return_error);
+
+        svt_av1_enc_deinit_handle(m_handle);
+        return false;
+    }
+
+    if (!allocateBuffers()) {
+        ELOG_ERROR_T("allocateBuffers failed");
+
+        deallocateBuffers();
+        svt_av1_enc_deinit(m_handle);
+        svt_av1_enc_deinit_handle(m_handle);
+        return false;
+    }
+
+    if (m_enableBsDump) {
+        char dumpFileName[128];
+
+        snprintf(dumpFileName, 128, "/tmp/svtAV1Encoder-%p.%s", this, "av1");
+        m_bsDumpfp = fopen(dumpFileName, "wb");
+        if (m_bsDumpfp) {
+            ELOG_DEBUG("Enable bitstream dump, %s", dumpFileName);
+        } else {
+            ELOG_DEBUG("Can not open dump file, %s", dumpFileName);
+        }
+    }
+
+    m_encoderReady = true;
+    return true;
+}
+
+bool SVTAV1Encoder::initEncoderAsync(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds)
+{
+    m_srv->post(boost::bind(&SVTAV1Encoder::InitEncoder, this, width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds));
+    return true;
+}
+
+int32_t SVTAV1Encoder::generateStream(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds, owt_base::FrameDestination* dest)
+{
+    boost::unique_lock<boost::shared_mutex> ulock(m_mutex);
+
+    ELOG_INFO_T("generateStream: {.width=%d, .height=%d, .frameRate=%d, .bitrateKbps=%d, .keyFrameIntervalSeconds=%d}"
+            , width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds);
+
+    if (m_dest) {
+        ELOG_ERROR_T("Only support one stream!");
+        return -1;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_frameRate = frameRate;
+    m_bitrateKbps = bitrateKbps;
+    m_keyFrameIntervalSeconds = keyFrameIntervalSeconds;
+
+    if (m_width != 0 && m_height != 0) {
+        if (!initEncoderAsync(m_width, m_height, m_frameRate, m_bitrateKbps, m_keyFrameIntervalSeconds))
+            return -1;
+    }
+
+    m_frameCount = 0;
+    m_frameEncodedCount = 0;
+    m_dest = dest;
+
+    return 0;
+}
+
+void SVTAV1Encoder::degenerateStream(int32_t streamId)
+{
+    boost::unique_lock<boost::shared_mutex> ulock(m_mutex);
+
+    ELOG_DEBUG_T("degenerateStream");
+
+    m_dest = NULL;
+}
+
+void SVTAV1Encoder::setBitrate(unsigned short kbps, int32_t streamId)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    ELOG_WARN_T("%s", __FUNCTION__);
+}
+
+void SVTAV1Encoder::requestKeyFrame(int32_t streamId)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    ELOG_DEBUG_T("%s", __FUNCTION__);
+
+    m_forceIDR = true;
+}
+
+void SVTAV1Encoder::onFrame(const Frame& frame)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    EbErrorType return_error = EB_ErrorNone;
+
+    if (m_dest == NULL) {
+        return;
+    }
+
+    if (m_width == 0 || m_height == 0) {
+        m_width = frame.additionalInfo.video.width;
+        m_height = frame.additionalInfo.video.height;
+
+        if (m_bitrateKbps == 0)
+            m_bitrateKbps = calcBitrate(m_width, m_height, m_frameRate);
+
+        if (!initEncoderAsync(m_width, m_height, m_frameRate, m_bitrateKbps, m_keyFrameIntervalSeconds)) {
+            return;
+        }
+    }
+
+    if (!m_encoderReady) {
+        ELOG_ERROR_T("Encoder not ready!");
+        return;
+    }
+
+    if (m_freeInputBuffers.empty()) {
+        ELOG_WARN_T("No free input buffer available!");
+        return;
+    }
+    EbBufferHeaderType *inputBufferHeader = m_freeInputBuffers.front();
+    if (!convert2InputBuffer(frame, inputBufferHeader)) {
+        return;
+    }
+
+    m_lastIngestMs.store(frame.ingestTimeMs, std::memory_order_relaxed);
+    inputBufferHeader->pts = m_frameCount++;
+    if (m_forceIDR) {
+        inputBufferHeader->pic_type = EB_AV1_KEY_PICTURE;
+        m_forceIDR = false;
+    } else {
+        inputBufferHeader->pic_type = EB_AV1_INVALID_PICTURE;
+    }
+
+    ELOG_TRACE_T("SendPicture, picType(%d)", inputBufferHeader->pic_type);
+
+    return_error = svt_av1_enc_send_picture(m_handle, inputBufferHeader);
+    if (return_error != EB_ErrorNone) {
+        ELOG_ERROR_T("SendPicture failed, ret 0x%x", return_error);
+        return;
+    }
+
+    ELOG_TRACE_T("frameCount %d, frameEncodedCount %d", m_frameCount, m_frameEncodedCount);
+
+    // Unlike SVT-HEVC there is no completion callback; drain whatever the
+    // encoder has finished without blocking on in-flight pictures.
+    while (true) {
+        EbBufferHeaderType *streamBufferHeader = NULL;
+
+        return_error = svt_av1_enc_get_packet(m_handle, &streamBufferHeader, 0);
+        if (return_error == EB_ErrorMax) {
+            ELOG_ERROR_T("Error while encoding, code 0x%x", streamBufferHeader->flags);
+            return;
+        } else if (return_error != EB_NoErrorEmptyQueue) {
+            fillPacketDone(streamBufferHeader);
+
+            svt_av1_enc_release_out_buffer(&streamBufferHeader);
+        } else {
+            break;
+        }
+    }
+}
+
+bool SVTAV1Encoder::convert2InputBuffer(const Frame& frame, EbBufferHeaderType *bufferHeader)
+{
+    EbSvtIOFormat* inputPtr = (EbSvtIOFormat*)bufferHeader->p_buffer;
+
+    switch (frame.format) {
+        case FRAME_FORMAT_I420: {
+            int ret;
+            webrtc::VideoFrame *videoFrame = reinterpret_cast<webrtc::VideoFrame*>(frame.payload);
+            rtc::scoped_refptr<webrtc::VideoFrameBuffer> videoBuffer = videoFrame->video_frame_buffer();
+
+            if ((uint32_t)videoBuffer->width() == m_encParameters.source_width
+                    && (uint32_t)videoBuffer->height() == m_encParameters.source_height) {
+                ret = libyuv::I420Copy(
+                        videoBuffer->DataY(), videoBuffer->StrideY(),
+                        videoBuffer->DataU(), videoBuffer->StrideU(),
+                        videoBuffer->DataV(), videoBuffer->StrideV(),
+                        inputPtr->luma, inputPtr->y_stride,
+                        inputPtr->cb,   inputPtr->cb_stride,
+                        inputPtr->cr,   inputPtr->cr_stride,
+                        m_encParameters.source_width,
+                        m_encParameters.source_height);
+                if (ret != 0) {
+                    ELOG_ERROR_T("Copy frame failed(%d), %dx%d", ret
+                            , m_encParameters.source_width
+                            , m_encParameters.source_height
+                            );
+                    return false;
+                }
+            } else {
+                ret = libyuv::I420Scale(
+                        videoBuffer->DataY(),   videoBuffer->StrideY(),
+                        videoBuffer->DataU(),   videoBuffer->StrideU(),
+                        videoBuffer->DataV(),   videoBuffer->StrideV(),
+                        videoBuffer->width(),   videoBuffer->height(),
+                        inputPtr->luma, inputPtr->y_stride,
+                        inputPtr->cb,   inputPtr->cb_stride,
+                        inputPtr->cr,   inputPtr->cr_stride,
+                        m_encParameters.source_width,
+                        m_encParameters.source_height,
+                        libyuv::kFilterBox);
+                if (ret != 0) {
+                    ELOG_ERROR_T("Convert frame failed(%d), %dx%d -> %dx%d", ret
+                            , videoBuffer->width()
+                            , videoBuffer->height()
+                            , m_encParameters.source_width
+                            , m_encParameters.source_height
+                            );
+                    return false;
+                }
+            }
+            break;
+        }
+
+        default:
+            ELOG_ERROR_T("Unspported video frame format %s(%d)", getFormatStr(frame.format), frame.format);
+            return false;
+    }
+
+    return true;
+}
+
+bool SVTAV1Encoder::allocateBuffers()
+{
+    // one buffer
+    uint32_t inputBufferFifoInitCount = 1;
+
+    // input buffers
+    const size_t luma8bitSize = m_encParameters.source_width * m_encParameters.source_height;
+    const size_t chroma8bitSize = luma8bitSize >> 2;
+
+    m_inputBufferPool.resize(inputBufferFifoInitCount);
+    memset(m_inputBufferPool.data(), 0, m_inputBufferPool.size() * sizeof(EbBufferHeaderType));
+    for (unsigned int bufferIndex = 0; bufferIndex < inputBufferFifoInitCount; ++bufferIndex) {
+        m_inputBufferPool[bufferIndex].size         = sizeof(EbBufferHeaderType);
+
+        m_inputBufferPool[bufferIndex].p_buffer     = (uint8_t *)calloc(1, sizeof(EbSvtIOFormat));
+        if (!m_inputBufferPool[bufferIndex].p_buffer) {
+            ELOG_ERROR_T("Can not alloc mem, size(%ld)", sizeof(EbSvtIOFormat));
+            return false;
+        }
+
+        // alloc frame
+        EbSvtIOFormat* inputPtr = (EbSvtIOFormat*)m_inputBufferPool[bufferIndex].p_buffer;
+        inputPtr->luma = (uint8_t *)malloc(luma8bitSize);
+        if (!inputPtr->luma) {
+            ELOG_ERROR_T("Can not alloc mem, size(%ld)", luma8bitSize);
+            return false;
+        }
+
+        inputPtr->cb = (uint8_t *)malloc(chroma8bitSize);
+        if (!inputPtr->cb) {
+            ELOG_ERROR_T("Can not alloc mem, size(%ld)", chroma8bitSize);
+            return false;
+        }
+
+        inputPtr->cr = (uint8_t *)malloc(chroma8bitSize);
+        if (!inputPtr->cr) {
+            ELOG_ERROR_T("Can not alloc mem, size(%ld)", chroma8bitSize);
+            return false;
+        }
+
+        inputPtr->y_stride  = m_encParameters.source_width;
+        inputPtr->cr_stride = m_encParameters.source_width >> 1;
+        inputPtr->cb_stride = m_encParameters.source_width >> 1;
+
+        m_inputBufferPool[bufferIndex].n_alloc_len  = luma8bitSize + chroma8bitSize + chroma8bitSize;
+        m_inputBufferPool[bufferIndex].p_app_private = NULL;
+        m_inputBufferPool[bufferIndex].pic_type     = EB_AV1_INVALID_PICTURE;
+
+        m_freeInputBuffers.push(&m_inputBufferPool[bufferIndex]);
+    }
+
+    // output buffers are owned by the library and handed back through
+    // svt_av1_enc_get_packet/svt_av1_enc_release_out_buffer.
+
+    return true;
+}
+
+void SVTAV1Encoder::deallocateBuffers()
+{
+    for (auto& bufferHeader : m_inputBufferPool) {
+        if (bufferHeader.p_buffer) {
+            EbSvtIOFormat* inputPtr = (EbSvtIOFormat*)bufferHeader.p_buffer;
+
+            if (inputPtr->luma) {
+                free(inputPtr->luma);
+                inputPtr->luma = NULL;
+            }
+
+            if (inputPtr->cb) {
+                free(inputPtr->cb);
+                inputPtr->cb = NULL;
+            }
+
+            if (inputPtr->cr) {
+                free(inputPtr->cr);
+                inputPtr->cr = NULL;
+            }
+
+            free(bufferHeader.p_buffer);
+            bufferHeader.p_buffer = NULL;
+        }
+    }
+    m_inputBufferPool.resize(0);
+}
+
+void SVTAV1Encoder::fillPacketDone(EbBufferHeaderType* pBufferHeader)
+{
+    ELOG_TRACE_T("Fill packet done, nFilledLen(%d), dts(%ld), pts(%ld), flags(0x%x), picType(%d)"
+            , pBufferHeader->n_filled_len
+            , pBufferHeader->dts
+            , pBufferHeader->pts
+            , pBufferHeader->flags
+            , pBufferHeader->pic_type
+            );
+
+    dump(pBufferHeader->p_buffer, pBufferHeader->n_filled_len);
+
+    Frame outFrame;
+    memset(&outFrame, 0, sizeof(outFrame));
+    outFrame.format     = FRAME_FORMAT_AV1;
+    // One copy into a pooled refcounted buffer, same trade as the HEVC side:
+    // the library's output buffer goes back immediately and queueing
+    // consumers retain this payload instead of copying again.
+    PayloadBuffer* payload = PayloadBuffer::create(pBufferHeader->n_filled_len);
+    memcpy(payload->data(), pBufferHeader->p_buffer, pBufferHeader->n_filled_len);
+    attachPayloadBuffer(outFrame, payload);
+    outFrame.length     = pBufferHeader->n_filled_len;
+    outFrame.timeStamp = (m_frameEncodedCount++) * 1000 / m_encParameters.frame_rate_numerator * 90;
+    outFrame.additionalInfo.video.width         = m_encParameters.source_width;
+    outFrame.additionalInfo.video.height        = m_encParameters.source_height;
+    outFrame.additionalInfo.video.isKeyFrame    = (pBufferHeader->pic_type == EB_AV1_KEY_PICTURE);
+    outFrame.ingestTimeMs = m_lastIngestMs.load(std::memory_order_relaxed);
+
+    ELOG_TRACE_T("frameCount %d, frameEncodedCount %d", m_frameCount, m_frameEncodedCount);
+
+    ELOG_TRACE_T("deliverFrame, %s, %dx%d(%s), length(%d)",
+            getFormatStr(outFrame.format),
+            outFrame.additionalInfo.video.width,
+            outFrame.additionalInfo.video.height,
+            outFrame.additionalInfo.video.isKeyFrame ? "key" : "delta",
+            outFrame.length);
+
+    m_dest->onFrame(outFrame);
+    payload->release();
+}
+
+void SVTAV1Encoder::dump(uint8_t *buf, int len)
+{
+    if (m_bsDumpfp) {
+        fwrite(buf, 1, len, m_bsDumpfp);
+    }
+}
+
+} // namespace owt_base
@@ -0,0 +1,133 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SVTCoreBudget.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(SVTCoreBudget, "owt.SVTCoreBudget");
+
+static uint32_t detectSocketCount()
+{
+    uint32_t count = 0;
+    char path[64];
+
+    for (;;) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u", count);
+        if (access(path, F_OK) != 0)
+            break;
+        count++;
+    }
+    return count > 0 ? count : 1;
+}
+
+bool SVTCoreBudget::enabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_SVT_CORE_BUDGET");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+SVTCoreBudget& SVTCoreBudget::instance()
+{
+    static SVTCoreBudget budget;
+    return budget;
+}
+
+SVTCoreBudget::SVTCoreBudget()
+    : m_cores(boost::thread::hardware_concurrency())
+    , m_sockets(detectSocketCount())
+{
+    if (m_cores == 0)
+        m_cores = 1;
+
+    ELOG_INFO("%d cores over %d sockets", m_cores, m_sockets);
+}
+
+void SVTCoreBudget::allocate(Listener* listener, uint64_t pixelRate,
+        uint32_t* logicalProcessors, int32_t* targetSocket)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    auto it = m_slots.find(listener);
+    if (it != m_slots.end()) {
+        it->second.pixelRate = pixelRate;
+    } else {
+        // Pin to the socket carrying the least pixel rate and never migrate:
+        // a migration would force a reinit of an otherwise unaffected
+        // encoder, and the shares within each socket rebalance anyway.
+        std::map<int32_t, uint64_t> socketLoad;
+        for (uint32_t s = 0; s < m_sockets; ++s)
+            socketLoad[s] = 0;
+        for (auto& slot : m_slots)
+            socketLoad[slot.second.socket] += slot.second.pixelRate;
+
+        int32_t socket = 0;
+        for (auto& load : socketLoad) {
+            if (load.second < socketLoad[socket])
+                socket = load.first;
+        }
+
+        m_slots[listener] = Slot{.pixelRate = pixelRate, .socket = socket, .logicalProcessors = 0};
+    }
+
+    rebalance(listener);
+
+    *logicalProcessors = m_slots[listener].logicalProcessors;
+    // A single-socket machine keeps SVT's default (-1, no pinning) so the
+    // scheduler stays free; pinning only pays off when it prevents
+    // cross-socket traffic.
+    *targetSocket = (m_sockets > 1) ? m_slots[listener].socket : -1;
+}
+
+void SVTCoreBudget::release(Listener* listener)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_slots.erase(listener) > 0)
+        rebalance(NULL);
+}
+
+void SVTCoreBudget::rebalance(Listener* skip)
+{
+    uint32_t coresPerSocket = m_cores / m_sockets;
+    if (coresPerSocket == 0)
+        coresPerSocket = 1;
+
+    std::map<int32_t, uint64_t> socketWeight;
+    for (auto& slot : m_slots)
+        socketWeight[slot.second.socket] += slot.second.pixelRate;
+
+    for (auto& slot : m_slots) {
+        uint64_t total = socketWeight[slot.second.socket];
+        uint32_t share = total
+            ? (uint32_t)((uint64_t)coresPerSocket * slot.second.pixelRate / total)
+            : coresPerSocket;
+        if (share < 1)
+            share = 1;
+        if (share > coresPerSocket)
+            share = coresPerSocket;
+
+        if (share == slot.second.logicalProcessors)
+            continue;
+
+        ELOG_DEBUG("Share changed, %d -> %d core(s) on socket %d",
+                slot.second.logicalProcessors, share, slot.second.socket);
+
+        slot.second.logicalProcessors = share;
+        if (slot.first != skip) {
+            int32_t socket = (m_sockets > 1) ? slot.second.socket : -1;
+            slot.first->onCoreBudget(share, socket);
+        }
+    }
+}
+
+} // namespace owt_base
@@ -0,0 +1,72 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SVTCoreBudget_h
+#define SVTCoreBudget_h
+
+#include <map>
+#include <stdint.h>
+
+#include <boost/thread.hpp>
+
+#include "logger.h"
+
+namespace owt_base {
+
+/**
+ * Divides the machine's core budget across live SVT encoder instances.
+ *
+ * Left at its defaults every SVT instance sizes its internal thread pools
+ * for the whole machine, so a handful of concurrent 4K encodes oversubscribe
+ * the cores and aggregate throughput collapses. With OWT_SVT_CORE_BUDGET=1
+ * each encoder registers here with its pixel rate and gets back a
+ * logicalProcessors/targetSocket pair: instances are pinned to the least
+ * loaded socket at registration and share that socket's cores in proportion
+ * to their pixel rates. When streams come and go the shares of the remaining
+ * instances change and each affected encoder is told to re-initialize with
+ * its new share (SVT only takes thread settings at init).
+ */
+class SVTCoreBudget {
+    DECLARE_LOGGER();
+
+public:
+    class Listener {
+    public:
+        virtual ~Listener() {}
+        // Called off the registration path when this listener's share
+        // changes; the encoder re-initializes with the new settings.
+        virtual void onCoreBudget(uint32_t logicalProcessors, int32_t targetSocket) = 0;
+    };
+
+    static SVTCoreBudget& instance();
+    static bool enabled();
+
+    // Registers the listener (or refreshes an existing registration after a
+    // resolution change) and returns its current share. Weight is the pixel
+    // rate (width * height * fps) the instance encodes.
+    void allocate(Listener* listener, uint64_t pixelRate,
+            uint32_t* logicalProcessors, int32_t* targetSocket);
+    void release(Listener* listener);
+
+private:
+    SVTCoreBudget();
+
+    // Recomputes every share and notifies listeners whose share changed,
+    // except `skip` (an allocate() caller picks its share up synchronously).
+    void rebalance(Listener* skip);
+
+    struct Slot {
+        uint64_t pixelRate;
+        int32_t socket;
+        uint32_t logicalProcessors;
+    };
+
+    uint32_t m_cores;
+    uint32_t m_sockets;
+    std::map<Listener*, Slot> m_slots;
+    boost::mutex m_mutex;
+};
+
+} /* namespace owt_base */
+#endif /* SVTCoreBudget_h */
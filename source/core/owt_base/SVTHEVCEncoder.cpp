@@ -4,6 +4,8 @@
 
 #include "SVTHEVCEncoder.h"
 
+#include <time.h>
+
 #include <webrtc/api/video/video_frame.h>
 #include <webrtc/api/video/video_frame_buffer.h>
 
@@ -12,6 +14,7 @@
 #include <libyuv/scale.h>
 
 #include "MediaUtilities.h"
+#include "PayloadBuffer.h"
 
 namespace owt_base {
 
@@ -27,8 +30,11 @@ SVTHEVCEncoder::SVTHEVCEncoder(FrameFormat format, VideoCodecProfile profile, bo
     , m_keyFrameIntervalSeconds(0)
     , m_handle(NULL)
     , m_forceIDR(false)
+    , m_lastIngestMs(0)
     , m_frameCount(0)
     , m_frameEncodedCount(0)
+    , m_encMode(9)
+    , m_reconfiguring(false)
     , m_enableBsDump(false)
     , m_bsDumpfp(NULL)
 {
@@ -41,6 +47,11 @@ SVTHEVCEncoder::SVTHEVCEncoder(FrameFormat format, VideoCodecProfile profile, bo
 
 SVTHEVCEncoder::~SVTHEVCEncoder()
 {
+    // Deregister first: after release() returns no more onCoreBudget calls
+    // arrive, and the remaining instances grow into the freed share.
+    if (SVTCoreBudget::enabled())
+        SVTCoreBudget::instance().release(this);
+
     m_srvWork.reset();
     m_srv->stop();
     m_thread.reset();
@@ -232,6 +243,21 @@ bool SVTHEVCEncoder::initEncoder(uint32_t width, uint32_t height, uint32_t frame
 
     initDefaultParameters();
     updateParameters(width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds);
+    m_encParameters.encMode = m_encMode;
+
+    // Take this instance's share of the machine instead of the default
+    // whole-machine thread pools; re-init after a budget change lands back
+    // here and reads the refreshed share.
+    if (SVTCoreBudget::enabled()) {
+        uint32_t logicalProcessors = 0;
+        int32_t targetSocket = -1;
+
+        SVTCoreBudget::instance().allocate(this,
+                (uint64_t)width * height * frameRate,
+                &logicalProcessors, &targetSocket);
+        m_encParameters.logicalProcessors = logicalProcessors;
+        m_encParameters.targetSocket = targetSocket;
+    }
 
     return_error = EbH265EncSetParameter(m_handle, &m_encParameters);
     if (return_error != EB_ErrorNone) {
@@ -370,6 +396,7 @@ void SVTHEVCEncoder::onFrame(const Frame& frame)
         return;
     }
 
+    m_lastIngestMs.store(frame.ingestTimeMs, std::memory_order_relaxed);
     inputBufferHeader->pts = m_frameCount++;
     if (m_forceIDR) {
         inputBufferHeader->sliceType = EB_IDR_PICTURE;
@@ -380,6 +407,9 @@ void SVTHEVCEncoder::onFrame(const Frame& frame)
 
     ELOG_TRACE_T("SendPicture, sliceType(%d)", inputBufferHeader->sliceType);
 
+    timespec encodeStart, encodeEnd;
+    clock_gettime(CLOCK_MONOTONIC, &encodeStart);
+
     return_error = EbH265EncSendPicture(m_handle, inputBufferHeader);
     if (return_error != EB_ErrorNone) {
         ELOG_ERROR_T("SendPicture failed, ret 0x%x", return_error);
@@ -403,6 +433,73 @@ void SVTHEVCEncoder::onFrame(const Frame& frame)
             break;
         }
     }
+
+    if (EncoderLoadGovernor::enabled() && !m_reconfiguring) {
+        clock_gettime(CLOCK_MONOTONIC, &encodeEnd);
+        // Send time includes the backpressure block when the encoder falls
+        // behind its internal queues, which is the overload signal here.
+        int64_t encodeTimeUs = (encodeEnd.tv_sec - encodeStart.tv_sec) * 1000000
+            + (encodeEnd.tv_nsec - encodeStart.tv_nsec) / 1000;
+
+        switch (m_loadGovernor.onEncodedFrame(encodeTimeUs, m_frameRate)) {
+        case EncoderLoadGovernor::ADAPT_FASTER:
+            if (m_encMode < 11) { // fastest SVT-HEVC preset
+                m_encMode++;
+                m_reconfiguring = true;
+                m_srv->post(boost::bind(&SVTHEVCEncoder::ReconfigEncoder, this));
+            }
+            break;
+        case EncoderLoadGovernor::ADAPT_SLOWER:
+            if (m_encMode > 9) { // configured default preset
+                m_encMode--;
+                m_reconfiguring = true;
+                m_srv->post(boost::bind(&SVTHEVCEncoder::ReconfigEncoder, this));
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void SVTHEVCEncoder::onCoreBudget(uint32_t logicalProcessors, int32_t targetSocket)
+{
+    // Arrives on another instance's thread when the set of live encoders
+    // changes; SVT only takes thread settings at init, so restart on our
+    // own service thread. initEncoder re-reads the share from the budget.
+    ELOG_DEBUG_T("Core budget changed, %d core(s), socket %d", logicalProcessors, targetSocket);
+
+    m_srv->post(boost::bind(&SVTHEVCEncoder::ReconfigEncoder, this));
+}
+
+void SVTHEVCEncoder::reconfigEncoder()
+{
+    boost::unique_lock<boost::shared_mutex> ulock(m_mutex);
+
+    if (!m_encoderReady) {
+        m_reconfiguring = false;
+        return;
+    }
+
+    ELOG_INFO_T("Reconfigure encoder, encMode %d", m_encMode);
+
+    EbDeinitEncoder(m_handle);
+    EbDeinitHandle(m_handle);
+    deallocateBuffers();
+    while (!m_freeInputBuffers.empty())
+        m_freeInputBuffers.pop();
+    m_encoderReady = false;
+
+    if (m_bsDumpfp) {
+        fclose(m_bsDumpfp);
+        m_bsDumpfp = NULL;
+    }
+
+    initEncoder(m_width, m_height, m_frameRate, m_bitrateKbps, m_keyFrameIntervalSeconds);
+
+    // Subscribers need a sync point after the restart.
+    m_forceIDR = true;
+    m_reconfiguring = false;
 }
 
 bool SVTHEVCEncoder::convert2BufferHeader(const Frame& frame, EB_BUFFERHEADERTYPE *bufferHeader)
@@ -591,12 +688,18 @@ void SVTHEVCEncoder::fillPacketDone(EB_BUFFERHEADERTYPE* pBufferHeader)
     Frame outFrame;
     memset(&outFrame, 0, sizeof(outFrame));
     outFrame.format     = FRAME_FORMAT_H265;
-    outFrame.payload    = pBufferHeader->pBuffer;
+    // One copy into a pooled refcounted buffer: the SVT output buffer can go
+    // straight back to the encoder, and consumers that queue the frame
+    // retain this payload instead of copying it again per destination.
+    PayloadBuffer* payload = PayloadBuffer::create(pBufferHeader->nFilledLen);
+    memcpy(payload->data(), pBufferHeader->pBuffer, pBufferHeader->nFilledLen);
+    attachPayloadBuffer(outFrame, payload);
     outFrame.length     = pBufferHeader->nFilledLen;
     outFrame.timeStamp = (m_frameEncodedCount++) * 1000 / m_encParameters.frameRate * 90;
     outFrame.additionalInfo.video.width         = m_encParameters.sourceWidth;
     outFrame.additionalInfo.video.height        = m_encParameters.sourceHeight;
     outFrame.additionalInfo.video.isKeyFrame    = (pBufferHeader->sliceType == EB_IDR_PICTURE);
+    outFrame.ingestTimeMs = m_lastIngestMs.load(std::memory_order_relaxed);
 
     ELOG_TRACE_T("frameCount %d, frameEncodedCount %d", m_frameCount, m_frameEncodedCount);
 
@@ -608,6 +711,7 @@ void SVTHEVCEncoder::fillPacketDone(EB_BUFFERHEADERTYPE* pBufferHeader)
             outFrame.length);
 
     m_dest->onFrame(outFrame);
+    payload->release();
 }
 
 void SVTHEVCEncoder::dump(uint8_t *buf, int len)
@@ -5,6 +5,7 @@
 #ifndef SVTHEVCEncoder_h
 #define SVTHEVCEncoder_h
 
+#include <atomic>
 #include <queue>
 
 #include <boost/make_shared.hpp>
@@ -14,19 +15,25 @@
 #include <boost/thread.hpp>
 
 #include "logger.h"
+#include "EncoderLoadGovernor.h"
 #include "MediaFramePipeline.h"
+#include "SVTCoreBudget.h"
 
 #include "svt-hevc/EbApi.h"
 
 namespace owt_base {
 
-class SVTHEVCEncoder : public VideoFrameEncoder {
+class SVTHEVCEncoder : public VideoFrameEncoder, public SVTCoreBudget::Listener {
     DECLARE_LOGGER();
 
 public:
     SVTHEVCEncoder(FrameFormat format, VideoCodecProfile profile, bool useSimulcast = false);
     ~SVTHEVCEncoder();
 
+    // Implements SVTCoreBudget::Listener: this instance's core share
+    // changed because another encoder came or went.
+    void onCoreBudget(uint32_t logicalProcessors, int32_t targetSocket);
+
     FrameFormat getInputFormat() {return FRAME_FORMAT_I420;}
 
     // Implements VideoFrameEncoder.
@@ -54,6 +61,13 @@ protected:
     bool initEncoder(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds);
     bool initEncoderAsync(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds);
 
+    static void ReconfigEncoder(SVTHEVCEncoder *This)
+    {
+        This->reconfigEncoder();
+    }
+
+    void reconfigEncoder();
+
     bool convert2BufferHeader(const Frame& frame, EB_BUFFERHEADERTYPE *bufferHeader);
 
     void fillPacketDone(EB_BUFFERHEADERTYPE* pBufferHeader);
@@ -79,8 +93,19 @@ private:
 
     bool m_forceIDR;
     uint32_t m_frameCount;
+    // Ingest stamp of the picture most recently sent to the encoder; the
+    // encoder callback thread copies it onto the bitstream frame, so under
+    // encode pipelining an output may carry its successor's stamp.
+    std::atomic<int64_t> m_lastIngestMs;
     uint32_t m_frameEncodedCount;
 
+    // Under sustained overload the governor steps encMode towards the
+    // fastest preset (and back when load recovers); SVT only takes the
+    // preset at init, so each step re-initializes on the service thread.
+    EncoderLoadGovernor m_loadGovernor;
+    uint8_t m_encMode;
+    bool m_reconfiguring;
+
     boost::shared_mutex m_mutex;
 
     boost::shared_ptr<boost::asio::io_service> m_srv;
@@ -0,0 +1,158 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SceneRateGovernor.h"
+
+#include "HostLoadGovernor.h"
+
+#include <stdlib.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(SceneRateGovernor, "owt.SceneRateGovernor");
+
+// Delta-frame bits per pixel of "typical" motion content; sources above it
+// are treated as busy, below it as quiet.
+static const double kNominalBitsPerPixel = 0.04;
+
+// How far a source's complexity may pull its rungs from their configured
+// bitrates before normalization.
+static const double kMinFactor = 0.5;
+static const double kMaxFactor = 1.5;
+
+// Skip a setBitrate call when the new target is within this fraction of the
+// last one; encoders resettle on every rate change.
+static const double kSetThreshold = 0.1;
+
+SceneRateGovernor& SceneRateGovernor::instance()
+{
+    static SceneRateGovernor governor;
+    return governor;
+}
+
+bool SceneRateGovernor::enabled()
+{
+    static bool on = []() {
+        const char* env = getenv("OWT_SCENE_RATE");
+        return env && env[0] == '1';
+    }();
+    return on;
+}
+
+SceneRateGovernor::SceneRateGovernor()
+    : m_nextHandle(0)
+{
+}
+
+void SceneRateGovernor::InputTap::onFrame(const Frame& frame)
+{
+    SceneRateGovernor::instance().addSample(m_sourceKey, frame);
+}
+
+void SceneRateGovernor::addSample(void* sourceKey, const Frame& frame)
+{
+    // Keyframes spike an order of magnitude above delta frames and would
+    // swamp the average; the delta-frame size is the steadier signal.
+    if (frame.additionalInfo.video.isKeyFrame)
+        return;
+
+    uint32_t pixels = (uint32_t)frame.additionalInfo.video.width * frame.additionalInfo.video.height;
+    if (pixels == 0 || frame.length == 0)
+        return;
+
+    double bpp = (double)frame.length * 8 / pixels;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    Source& source = m_sources[sourceKey];
+    if (!source.seeded) {
+        source.emaBitsPerPixel = bpp;
+        source.seeded = true;
+    } else {
+        source.emaBitsPerPixel += (bpp - source.emaBitsPerPixel) / 8;
+    }
+}
+
+double SceneRateGovernor::complexityFactor(const Source& source) const
+{
+    if (!source.seeded)
+        return 1.0;
+    double factor = source.emaBitsPerPixel / kNominalBitsPerPixel;
+    if (factor < kMinFactor)
+        return kMinFactor;
+    if (factor > kMaxFactor)
+        return kMaxFactor;
+    return factor;
+}
+
+int SceneRateGovernor::registerRung(void* sourceKey, VideoFrameEncoder* encoder, int32_t streamId, uint32_t configuredKbps)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    int handle = m_nextHandle++;
+    Rung rung{sourceKey, encoder, streamId, configuredKbps, configuredKbps};
+    m_rungs[handle] = rung;
+    m_sources[sourceKey].rungs++;
+    if (!m_timer)
+        m_timer.reset(new JobTimer(1, this));
+    return handle;
+}
+
+void SceneRateGovernor::unregisterRung(int handle)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    auto it = m_rungs.find(handle);
+    if (it == m_rungs.end())
+        return;
+
+    auto sit = m_sources.find(it->second.sourceKey);
+    if (sit != m_sources.end() && --sit->second.rungs == 0)
+        m_sources.erase(sit);
+    m_rungs.erase(it);
+}
+
+void SceneRateGovernor::onTimeout()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_rungs.empty())
+        return;
+
+    // Normalize so the complexity-weighted targets sum to the configured
+    // total: quiet sources fund busy ones, node bandwidth stays put.
+    double configuredSum = 0.0;
+    double weightedSum = 0.0;
+    for (auto it = m_rungs.begin(); it != m_rungs.end(); ++it) {
+        double factor = complexityFactor(m_sources[it->second.sourceKey]);
+        configuredSum += it->second.configuredKbps;
+        weightedSum += it->second.configuredKbps * factor;
+    }
+    if (weightedSum <= 0.0)
+        return;
+    double scale = configuredSum / weightedSum;
+
+    // Under host-wide shedding, pull every rung down together: the higher
+    // the shed level, the smaller the share each rung keeps of its
+    // configured rate.
+    uint32_t shedLevel = HostLoadGovernor::enabled()
+        ? HostLoadGovernor::instance().shedLevel() : 0;
+    if (shedLevel)
+        scale /= (shedLevel + 1);
+
+    for (auto it = m_rungs.begin(); it != m_rungs.end(); ++it) {
+        Rung& rung = it->second;
+        double factor = complexityFactor(m_sources[rung.sourceKey]);
+        uint32_t target = (uint32_t)(rung.configuredKbps * factor * scale + 0.5);
+        if (target == 0)
+            target = 1;
+
+        double deviation = (double)((int64_t)target - (int64_t)rung.lastSetKbps) / rung.lastSetKbps;
+        if (deviation < kSetThreshold && deviation > -kSetThreshold)
+            continue;
+
+        ELOG_DEBUG("rung %d: %u -> %u kbps (factor %.2f, scale %.2f)",
+            it->first, rung.lastSetKbps, target, factor, scale);
+        rung.encoder->setBitrate((unsigned short)target, rung.streamId);
+        rung.lastSetKbps = target;
+    }
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,90 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SceneRateGovernor_h
+#define SceneRateGovernor_h
+
+#include <map>
+#include <stdint.h>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+#include <JobTimer.h>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+/**
+ * Process-wide content-aware bitrate reallocation across transcoder rungs.
+ *
+ * Every encoder rung runs at its configured bitrate regardless of content,
+ * so a slide-share source wastes bits a sports source next to it could use.
+ * The governor taps each source's compressed input stream for a free
+ * complexity signal - delta-frame bits per pixel - and once a second scales
+ * every registered rung's target by its source's complexity, normalized so
+ * the sum over all rungs stays at the sum of the configured bitrates. Quiet
+ * sources release bits, busy sources absorb them, and total node bandwidth
+ * is untouched.
+ *
+ * Disabled unless OWT_SCENE_RATE=1, matching the other opt-in governors.
+ */
+class SceneRateGovernor : public JobTimerListener {
+    DECLARE_LOGGER();
+
+public:
+    static SceneRateGovernor& instance();
+    static bool enabled();
+
+    // A pass-through destination hung off a source alongside its decoder;
+    // it only reads frame sizes, never the payload.
+    class InputTap : public FrameDestination {
+    public:
+        explicit InputTap(void* sourceKey) : m_sourceKey(sourceKey) { }
+        void onFrame(const Frame& frame);
+
+    private:
+        void* m_sourceKey;
+    };
+
+    // Registers one encoder rung of the given source; returns a handle for
+    // unregisterRung(). The encoder must stay alive until unregistered.
+    int registerRung(void* sourceKey, VideoFrameEncoder* encoder, int32_t streamId, uint32_t configuredKbps);
+    void unregisterRung(int handle);
+
+    // Implements the JobTimerListener; runs the reallocation pass.
+    void onTimeout();
+
+private:
+    struct Source {
+        double emaBitsPerPixel = 0.0;
+        bool seeded = false;
+        uint32_t rungs = 0;
+    };
+
+    struct Rung {
+        void* sourceKey;
+        VideoFrameEncoder* encoder;
+        int32_t streamId;
+        uint32_t configuredKbps;
+        uint32_t lastSetKbps;
+    };
+
+    SceneRateGovernor();
+
+    void addSample(void* sourceKey, const Frame& frame);
+    double complexityFactor(const Source& source) const;
+
+    boost::mutex m_mutex;
+    std::map<void*, Source> m_sources;
+    std::map<int, Rung> m_rungs;
+    int m_nextHandle;
+
+    boost::scoped_ptr<JobTimer> m_timer;
+};
+
+} /* namespace owt_base */
+#endif /* SceneRateGovernor_h */
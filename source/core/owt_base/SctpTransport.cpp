@@ -5,6 +5,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#include "IOServicePool.h"
 #include "SctpTransport.h"
 
 namespace owt_base {
@@ -21,6 +22,19 @@ enum PreservedErrno {
 // Initialize with a large send space size currently
 const int MAX_MSGSIZE = 1024 * 1024;
 
+// Coalescing of sub-MTU messages: small framed records are concatenated into
+// one usrsctp_sendv call, which is what keeps audio-heavy rooms from being
+// bounded by SCTP message count. Off by default until every node in the
+// cluster parses multi-record messages (see processPacket).
+const int kCoalesceLimit = 1200;
+const int kCoalesceTarget = 8 * 1024;
+
+static bool sctpCoalesceEnabled()
+{
+    const char* env = getenv("OWT_SCTP_COALESCE");
+    return env && env[0] == '1';
+}
+
 int usrsctp_ref_count = 0;
 boost::mutex usrsctp_ref_mutex;
 
@@ -97,10 +111,19 @@ SctpTransport::SctpTransport(RawTransportListener* listener, size_t initialBuffe
     , m_fragBufferSize(initialBufferSize)
     , m_receivedBytes(0)
     , m_currentTsn(0)
+    , m_ioService(IOServicePool::instance().get())
     , m_sctpSocket(NULL)
     , m_sending(false)
+    , m_coalescedPending(false)
+    , m_drainScheduled(false)
+    , m_senderService(IOServicePool::instance().get())
     , m_listener(listener)
 {
+    for (int lane = 0; lane < NUM_SEND_LANES; lane++) {
+        m_sendListHead[lane] = &m_sendListStub[lane];
+        m_carryNode[lane] = nullptr;
+        m_sendListTail[lane].store(&m_sendListStub[lane], boost::memory_order_relaxed);
+    }
 }
 
 SctpTransport::~SctpTransport()
@@ -110,19 +133,23 @@ SctpTransport::~SctpTransport()
 
     destroySctpSocket();
 
-    m_ioService.stop();
-    // We need to wait for the work thread to finish its job.
-    m_workThread.join();
-
-    m_work.reset();
-    m_senderService.stop();
-    m_senderThread.join();
-
-    // Close the socket after it has no work left
+    // Cancel in-flight socket operations, then run the aborted handlers out
+    // of both shared io_services before releasing anything they touch; the
+    // services themselves belong to the pool and keep running.
     if (m_udpSocket && m_udpSocket->is_open()) {
         boost::system::error_code ec;
         m_udpSocket->shutdown(boost::asio::ip::udp::socket::shutdown_both, ec);
-        m_udpSocket->close();
+        m_udpSocket->close(ec);
+    }
+    IOServicePool::instance().drain(m_ioService);
+    IOServicePool::instance().drain(m_senderService);
+
+    // No drain can run anymore; release whatever was not sent.
+    for (int lane = 0; lane < NUM_SEND_LANES; lane++) {
+        delete m_carryNode[lane];
+        m_carryNode[lane] = nullptr;
+        for (SendNode* node = popSendNode(lane); node; node = popSendNode(lane))
+            delete node;
     }
 
     ELOG_DEBUG("SctpTransport Destructor END");
@@ -173,8 +200,7 @@ void SctpTransport::handleNotification(union sctp_notification *notif, size_t n)
         //ELOG_DEBUG("SCTP_SENDER_DRY_EVENT");
         if (!m_sending) {
             m_sending = true;
-            boost::lock_guard<boost::mutex> lock(m_sendBufferMutex);
-            trySending();
+            scheduleDrain();
         }
         break;
     case SCTP_NOTIFICATIONS_STOPPED_EVENT:
@@ -207,8 +233,7 @@ void SctpTransport::handleAssociationChangeEvent(struct sctp_assoc_change *sac)
         m_ready = true;
         if (!m_sending) {
             m_sending = true;
-            boost::lock_guard<boost::mutex> lock(m_sendBufferMutex);
-            trySending();
+            scheduleDrain();
         }
         break;
     case SCTP_COMM_LOST:
@@ -219,8 +244,7 @@ void SctpTransport::handleAssociationChangeEvent(struct sctp_assoc_change *sac)
         m_ready = true;
         if (!m_sending) {
             m_sending = true;
-            boost::lock_guard<boost::mutex> lock(m_sendBufferMutex);
-            trySending();
+            scheduleDrain();
         }
         break;
     case SCTP_SHUTDOWN_COMP:
@@ -460,13 +484,9 @@ void SctpTransport::startSctpConnection() {
         return;
     }
 
-    m_work.reset(new boost::asio::io_service::work(m_senderService));
     m_ready = true;
     m_sending = true;
 
-    if (m_senderThread.get_id() == boost::thread::id()) // Not-A-Thread
-        m_senderThread = boost::thread(boost::bind(&boost::asio::io_service::run, &m_senderService));
-
     // Set the MTU and disable MTU discovery.
     // We can only do this after usrsctp_connect or it has no effect.
     /*
@@ -490,11 +510,10 @@ void SctpTransport::startSctpConnection() {
         [this] (const boost::system::error_code& error) {
             // Start receving on udp port
             ELOG_DEBUG("Udp async connect callback");
+            if (m_isClosing)
+                return;
             receiveData();
         });
-
-    if (m_workThread.get_id() == boost::thread::id()) // Not-A-Thread
-        m_workThread = boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService));
 }
 
 void SctpTransport::postPacket(const char* buf, int len)
@@ -524,6 +543,10 @@ void SctpTransport::doSend()
 
     m_udpSocket->async_send(boost::asio::buffer(data.buffer.get(), data.length),
         [this] (const boost::system::error_code& ec, std::size_t bytes) {
+            // Aborted handlers run during the destructor drain; do nothing.
+            if (m_isClosing)
+                return;
+
             if (ec) {
                 ELOG_WARN("wrote data error: %s", ec.message().c_str());
                 m_listener->onTransportError();
@@ -551,6 +574,10 @@ void SctpTransport::receiveData()
 
     m_udpSocket->async_receive(boost::asio::buffer(m_receiveData.buffer.get(), m_bufferSize),
         [this] (const boost::system::error_code& ec, std::size_t bytes) {
+            // Aborted handlers run during the destructor drain; do nothing.
+            if (m_isClosing)
+                return;
+
             if (ec) {
                 ELOG_WARN("udp async receive error:%s", ec.message().c_str());
                 m_listener->onTransportError();
@@ -573,75 +600,62 @@ void SctpTransport::receiveData()
 
 void SctpTransport::processPacket(const char* data, int len, uint32_t tsn)
 {
-    // Called in usrsctp's receive callback thread
+    // Called in usrsctp's receive callback thread.
+    //
+    // The inbound bytes are a sequence of length-prefixed records. A legacy
+    // sender puts exactly one record in each SCTP message; a coalescing
+    // sender (OWT_SCTP_COALESCE) concatenates several small ones. Parsing
+    // the byte stream on the prefixes handles both, as well as large
+    // messages delivered across multiple callbacks.
+    const int INT_SIZE = sizeof(uint32_t);
+
     if (!m_fragments.buffer) {
         m_fragments.buffer.reset(new char[m_fragBufferSize]);
     }
 
-    const int INT_SIZE = sizeof(uint32_t);
-    if (len < INT_SIZE) {
-        ELOG_ERROR("Packet with length less than %d is incorrect, drop it, length:%d", INT_SIZE, len);
-        return;
+    uint32_t needed = m_receivedBytes + len;
+    if (needed > m_fragBufferSize) {
+        uint32_t newSize = m_fragBufferSize;
+        while (newSize < needed)
+            newSize *= 2;
+        ELOG_WARN("Increase the received buffer size %u", newSize);
+        boost::shared_array<char> grown(new char[newSize]);
+        if (m_receivedBytes)
+            memcpy(grown.get(), m_fragments.buffer.get(), m_receivedBytes);
+        m_fragments.buffer = grown;
+        m_fragBufferSize = newSize;
     }
 
-    if (m_currentTsn != tsn) {
-        if (m_receivedBytes) {
-            ELOG_WARN("SCTP received message not complete.");
-            // Deliver last message
-            m_listener->onTransportData(m_fragments.buffer.get(), m_receivedBytes);
-            m_receivedBytes = 0;
-        }
-        m_currentTsn = tsn;
-    }
+    memcpy(m_fragments.buffer.get() + m_receivedBytes, data, len);
+    m_receivedBytes += len;
 
-    if (!m_receivedBytes) {
-        // Read header & reset buffer if needed
+    uint32_t offset = 0;
+    while (m_receivedBytes - offset >= (uint32_t)INT_SIZE) {
         uint32_t msglen;
-        memcpy(&msglen, data, INT_SIZE);
+        memcpy(&msglen, m_fragments.buffer.get() + offset, INT_SIZE);
         msglen = ntohl(msglen);
 
-        if (msglen > m_fragBufferSize) {
-            while (msglen > m_fragBufferSize) {
-                m_fragBufferSize *= 2;
-                if (m_fragBufferSize > MAX_MSGSIZE) {
-                    ELOG_WARN("Assembled fragbuffersize %u becomes large than MAX_MSGSIZE", m_fragBufferSize);
-                    break;
-                }
-            }
-            ELOG_WARN("Increase the received buffer size %u", m_fragBufferSize);
-            m_fragments.buffer.reset(new char[m_fragBufferSize]);
-        }
-        m_fragments.length = msglen;
-
-        uint32_t bodylen = len - INT_SIZE;
-        if (m_fragments.length < bodylen) {
-            ELOG_WARN("SCTP packet msglen too small, not correct.");
-            return;
-        }
-
-        // Save to fragments
-        memcpy(m_fragments.buffer.get(), data + INT_SIZE, bodylen);
-        m_receivedBytes = bodylen;
-    } else {
-        if (m_fragments.length < m_receivedBytes + len) {
-            ELOG_WARN("SCTP packet msglen too small, not correct.");
+        if (msglen == 0 || msglen > (uint32_t)MAX_MSGSIZE) {
+            ELOG_ERROR("Corrupt record length %u in SCTP stream, resetting", msglen);
+            m_receivedBytes = 0;
             return;
         }
+        if (m_receivedBytes - offset - INT_SIZE < msglen)
+            break;
 
-        // Append to current buffer
-        memcpy(m_fragments.buffer.get() + m_receivedBytes, data, len);
-        m_receivedBytes += len;
+        // The listener may use this buffer directly; it is only overwritten
+        // by later packets, as before.
+        m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+        m_stats.receivedBytes.fetch_add(msglen, std::memory_order_relaxed);
+        m_listener->onTransportData(m_fragments.buffer.get() + offset + INT_SIZE, msglen);
+        offset += INT_SIZE + msglen;
     }
 
-    if (m_fragments.length == m_receivedBytes) {
-        // Received message successfully
-
-        // We cannot change m_fragments.buffer immediately after the onTransportData returns
-        // Because the listener may used this buffer directly
-        m_listener->onTransportData(m_fragments.buffer.get(), m_fragments.length);
-        m_receivedBytes = 0;
+    if (offset) {
+        if (m_receivedBytes > offset)
+            memmove(m_fragments.buffer.get(), m_fragments.buffer.get() + offset, m_receivedBytes - offset);
+        m_receivedBytes -= offset;
     }
-
 }
 
 void SctpTransport::open()
@@ -668,7 +682,7 @@ void SctpTransport::sendData(const char* data, int len)
     sendData(NULL, 0, data, len);
 }
 
-void SctpTransport::sendData(const char* header, int headerLength, const char* data, int len)
+void SctpTransport::sendData(const char* header, int headerLength, const char* data, int len, int lane)
 {
     const int INT_SIZE = sizeof(uint32_t);
 
@@ -687,94 +701,191 @@ void SctpTransport::sendData(const char* header, int headerLength, const char* d
         return;
     }
 
-    TransportData tData;
+    SendNode* node = new SendNode();
     if (m_tag) {
-        tData.buffer.reset(new char[headerLength + len + INT_SIZE]);
+        node->buffer.reset(new char[headerLength + len + INT_SIZE]);
         uint32_t msglen = htonl(headerLength + len);
-        memcpy(tData.buffer.get(), &msglen, INT_SIZE);
+        memcpy(node->buffer.get(), &msglen, INT_SIZE);
         if (headerLength) {
-            memcpy(tData.buffer.get() + INT_SIZE, header, headerLength);
+            memcpy(node->buffer.get() + INT_SIZE, header, headerLength);
         }
-        memcpy(tData.buffer.get() + INT_SIZE + headerLength, data, len);
-        tData.length = headerLength + len + INT_SIZE;
+        memcpy(node->buffer.get() + INT_SIZE + headerLength, data, len);
+        node->length = headerLength + len + INT_SIZE;
     } else {
-        tData.buffer.reset(new char[headerLength + len]);
+        node->buffer.reset(new char[headerLength + len]);
         if (headerLength) {
-            memcpy(tData.buffer.get(), header, headerLength);
+            memcpy(node->buffer.get(), header, headerLength);
         }
-        memcpy(tData.buffer.get() + headerLength, data, len);
-        memcpy(tData.buffer.get(), data, len);
-        tData.length = headerLength + len;
+        memcpy(node->buffer.get() + headerLength, data, len);
+        node->length = headerLength + len;
     }
 
-    ELOG_DEBUG("SCTP send length: %d", tData.length);
+    ELOG_DEBUG("SCTP send length: %d", node->length);
 
-    boost::lock_guard<boost::mutex> lock(m_sendBufferMutex);
-    m_sendBuffer.push(tData);
-    trySending();
+    m_stats.queuedMessages.fetch_add(1, std::memory_order_relaxed);
+    m_stats.queuedBytes.fetch_add(node->length, std::memory_order_relaxed);
+    pushSendNode(node, lane);
+    scheduleDrain();
 }
 
-void SctpTransport::trySending() {
-    // Need m_sendBufferMutex lock before calling
-    if (!m_sending || !m_ready || m_isClosing)
-        return;
+void SctpTransport::pushSendNode(SendNode* node, int lane)
+{
+    node->next.store(nullptr, boost::memory_order_relaxed);
+    SendNode* prev = m_sendListTail[lane].exchange(node, boost::memory_order_acq_rel);
+    prev->next.store(node, boost::memory_order_release);
+}
+
+SctpTransport::SendNode* SctpTransport::popSendNode(int lane)
+{
+    SendNode* head = m_sendListHead[lane];
+    SendNode* next = head->next.load(boost::memory_order_acquire);
+
+    if (head == &m_sendListStub[lane]) {
+        if (!next)
+            return nullptr;
+        m_sendListHead[lane] = next;
+        head = next;
+        next = head->next.load(boost::memory_order_acquire);
+    }
+    if (next) {
+        m_sendListHead[lane] = next;
+        return head;
+    }
+    if (head != m_sendListTail[lane].load(boost::memory_order_acquire)) {
+        // A producer has swapped the tail but not linked yet; try again on
+        // the next drain rather than spinning here.
+        return nullptr;
+    }
+    // Single element left: park the stub behind it so the list never empties.
+    pushSendNode(&m_sendListStub[lane], lane);
+    next = head->next.load(boost::memory_order_acquire);
+    if (next) {
+        m_sendListHead[lane] = next;
+        return head;
+    }
+    return nullptr;
+}
+
+void SctpTransport::scheduleDrain()
+{
+    if (!m_drainScheduled.exchange(true, boost::memory_order_acq_rel))
+        m_senderService.post(boost::bind(&SctpTransport::drainSendQueue, this));
+}
 
-    if (m_sendBuffer.empty())
+void SctpTransport::drainSendQueue()
+{
+    // Runs only on the sender thread. Clear the flag first so producers that
+    // push after this point schedule another drain.
+    m_drainScheduled.store(false, boost::memory_order_release);
+
+    if (!m_ready || m_isClosing)
         return;
 
-    TransportData& tData = m_sendBuffer.front();
-
-    // Make sending all in senderThread
-    m_senderService.post([this, tData]() {
-        // Send data using SCTP.
-        struct sctp_sndinfo sndinfo;
-        sndinfo.snd_sid = 1;
-        sndinfo.snd_flags = 0;
-        sndinfo.snd_ppid = htonl(233);
-        sndinfo.snd_context = 0;
-        sndinfo.snd_assoc_id = 0;
-
-        int send_res = usrsctp_sendv(
-            m_sctpSocket, tData.buffer.get(), static_cast<size_t>(tData.length), NULL, 0, &sndinfo,
-            static_cast<socklen_t>(sizeof(struct sctp_sndinfo)), SCTP_SENDV_SNDINFO, 0);
-        if (send_res < 0) {
-            if (errno == SCTP_EWOULDBLOCK) {
-                ELOG_WARN("usrsctp_sendv: EWOULDBLOCK returned");
-
-                m_sending = false;
-
-                // Double the send buffer size
-                int sndbufsize = MAX_MSGSIZE;
-                int intlen = sizeof(int);
-                if (usrsctp_getsockopt(m_sctpSocket, SOL_SOCKET, SO_SNDBUF, &sndbufsize,
-                                       (socklen_t *)&intlen) < 0) {
-                    ELOG_INFO("usrsctp_getsockopt: Can not get SNDBUF");
-                } else {
-                    ELOG_DEBUG("Send buffer size origin: %d", sndbufsize);
-                    if (sndbufsize < MAX_MSGSIZE * 16) {
-                        sndbufsize *= 2;
-                        if (usrsctp_setsockopt(m_sctpSocket, SOL_SOCKET, SO_SNDBUF, &sndbufsize,
-                                               sizeof(int)) < 0) {
-                            ELOG_WARN("SCTP set SO_SNDBUF fail.");
-                        }
-                    } else {
-                        ELOG_WARN("Send buffer size already max.");
-                    }
-                    ELOG_DEBUG("Send buffer size after: %d", sndbufsize);
-                }
+    while (m_sending) {
+        if (m_coalescedPending) {
+            if (!sendMessage(m_coalesced.buffer.get(), m_coalesced.length))
+                return;
+            m_coalescedPending = false;
+            continue;
+        }
 
-            } else {
-                ELOG_ERROR("usrsctp_sendv: %d", errno);
+        // Strict priority: take from the highest lane that has a carried or
+        // queued message; order stays FIFO within a lane.
+        int lane = 0;
+        SendNode* node = nullptr;
+        for (; lane < NUM_SEND_LANES; lane++) {
+            node = m_carryNode[lane] ? m_carryNode[lane] : popSendNode(lane);
+            if (node) {
+                m_carryNode[lane] = nullptr;
+                break;
+            }
+        }
+        if (!node)
+            return;
+
+        if (m_tag && sctpCoalesceEnabled() && node->length <= kCoalesceLimit) {
+            // Concatenate consecutive small framed records from the same
+            // lane into one SCTP message; the peer splits them on the
+            // length prefixes.
+            if (!m_coalesced.buffer)
+                m_coalesced.buffer.reset(new char[kCoalesceTarget]);
+            int total = 0;
+            while (node && node->length <= kCoalesceLimit && total + node->length <= kCoalesceTarget) {
+                memcpy(m_coalesced.buffer.get() + total, node->buffer.get(), node->length);
+                total += node->length;
+                m_stats.queuedMessages.fetch_sub(1, std::memory_order_relaxed);
+                m_stats.queuedBytes.fetch_sub(node->length, std::memory_order_relaxed);
+                delete node;
+                node = popSendNode(lane);
+            }
+            m_carryNode[lane] = node; // Too large to join, or null.
+            m_coalesced.length = total;
+            if (!sendMessage(m_coalesced.buffer.get(), total)) {
+                m_coalescedPending = true;
+                return;
             }
         } else {
-            boost::lock_guard<boost::mutex> lock(m_sendBufferMutex);
-            assert(m_sendBuffer.size() > 0);
-            m_sendBuffer.pop();
+            if (!sendMessage(node->buffer.get(), node->length)) {
+                m_carryNode[lane] = node;
+                return;
+            }
+            m_stats.queuedMessages.fetch_sub(1, std::memory_order_relaxed);
+            m_stats.queuedBytes.fetch_sub(node->length, std::memory_order_relaxed);
+            delete node;
+        }
+    }
+}
 
-            if (m_sendBuffer.size() > 0)
-                trySending();
+bool SctpTransport::sendMessage(const char* data, int length)
+{
+    struct sctp_sndinfo sndinfo;
+    sndinfo.snd_sid = 1;
+    sndinfo.snd_flags = 0;
+    sndinfo.snd_ppid = htonl(233);
+    sndinfo.snd_context = 0;
+    sndinfo.snd_assoc_id = 0;
+
+    int send_res = usrsctp_sendv(
+        m_sctpSocket, data, static_cast<size_t>(length), NULL, 0, &sndinfo,
+        static_cast<socklen_t>(sizeof(struct sctp_sndinfo)), SCTP_SENDV_SNDINFO, 0);
+    if (send_res >= 0) {
+        m_stats.sentMessages.fetch_add(1, std::memory_order_relaxed);
+        m_stats.sentBytes.fetch_add(length, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (errno == SCTP_EWOULDBLOCK) {
+        ELOG_WARN("usrsctp_sendv: EWOULDBLOCK returned");
+
+        // Back off until SCTP_SENDER_DRY_EVENT; the message stays queued.
+        m_sending = false;
+
+        // Double the send buffer size
+        int sndbufsize = MAX_MSGSIZE;
+        int intlen = sizeof(int);
+        if (usrsctp_getsockopt(m_sctpSocket, SOL_SOCKET, SO_SNDBUF, &sndbufsize,
+                               (socklen_t *)&intlen) < 0) {
+            ELOG_INFO("usrsctp_getsockopt: Can not get SNDBUF");
+        } else {
+            ELOG_DEBUG("Send buffer size origin: %d", sndbufsize);
+            if (sndbufsize < MAX_MSGSIZE * 16) {
+                sndbufsize *= 2;
+                if (usrsctp_setsockopt(m_sctpSocket, SOL_SOCKET, SO_SNDBUF, &sndbufsize,
+                                       sizeof(int)) < 0) {
+                    ELOG_WARN("SCTP set SO_SNDBUF fail.");
+                }
+            } else {
+                ELOG_WARN("Send buffer size already max.");
+            }
+            ELOG_DEBUG("Send buffer size after: %d", sndbufsize);
         }
-    });
+        return false;
+    }
+
+    // Other errors: drop this message and keep the queue moving.
+    ELOG_ERROR("usrsctp_sendv: %d", errno);
+    m_stats.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 
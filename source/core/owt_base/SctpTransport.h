@@ -26,7 +26,9 @@ public:
     ~SctpTransport();
 
     void sendData(const char*, int len);
-    void sendData(const char* header, int headerLength, const char* payload, int payloadLength);
+    // The lane (see SendLane in RawTransport.h) defaults to the top-priority
+    // one, which control and feedback messages share with audio.
+    void sendData(const char* header, int headerLength, const char* payload, int payloadLength, int lane = LANE_AUDIO);
 
     // Sctp connection
     void open();
@@ -34,6 +36,7 @@ public:
     void close();
 
     unsigned short getLocalUdpPort() { return m_localUdpPort; }
+    std::string getStats() { return m_stats.report(); }
     unsigned short getLocalSctpPort() { return m_localSctpPort; }
 
     static int onSctpInboundPacket(struct socket *sock, union sctp_sockstore addr, void *data,
@@ -55,7 +58,6 @@ private:
     void receiveData();
     void processPacket(const char* data, int len, uint32_t tsn);
 
-    void trySending();
 
     bool m_isClosing;
 
@@ -88,19 +90,43 @@ private:
     std::queue<TransportData> m_sendQueue;
     boost::mutex m_sendQueueMutex;
 
-    boost::thread m_workThread;
-
-    boost::asio::io_service m_ioService;
+    // Shared io_services from the process-wide pool (see IOServicePool.h):
+    // one carries the UDP socket I/O and usrsctp outbound packets, the other
+    // the sender-side drains. Each is serviced by a single pool thread, so
+    // the per-service single-threaded execution the handlers rely on is
+    // preserved while nodes with many SCTP links no longer pay two parked
+    // threads per connection.
+    boost::asio::io_service& m_ioService;
     boost::scoped_ptr<boost::asio::ip::udp::socket> m_udpSocket;
     struct socket* m_sctpSocket;
 
-    // Send queue data for buffer
+    // Outbound messages: one intrusive lock-free MPSC list (Vyukov style)
+    // per priority lane. Any thread pushes with two atomic operations; the
+    // sender thread is the single consumer and drains the lanes in strict
+    // priority order.
+    struct SendNode {
+        SendNode() : length(0) { next.store(nullptr, boost::memory_order_relaxed); }
+        boost::atomic<SendNode*> next;
+        int length;
+        boost::shared_array<char> buffer;
+    };
+
+    void pushSendNode(SendNode* node, int lane);
+    SendNode* popSendNode(int lane);
+    void scheduleDrain();
+    void drainSendQueue();
+    bool sendMessage(const char* data, int length);
+
     boost::atomic<bool> m_sending;
-    boost::thread m_senderThread;
-    std::queue<TransportData> m_sendBuffer;
-    boost::mutex m_sendBufferMutex;
-    boost::asio::io_service m_senderService;
-    boost::scoped_ptr<boost::asio::io_service::work> m_work;
+    boost::atomic<SendNode*> m_sendListTail[NUM_SEND_LANES];
+    SendNode* m_sendListHead[NUM_SEND_LANES];   // Sender thread only.
+    SendNode m_sendListStub[NUM_SEND_LANES];
+    SendNode* m_carryNode[NUM_SEND_LANES];      // Popped but not yet sent.
+    TransportData m_coalesced;      // Sender-thread scratch for coalesced sends.
+    bool m_coalescedPending;
+    boost::atomic<bool> m_drainScheduled;
+    TransportStats m_stats;
+    boost::asio::io_service& m_senderService;
 
     RawTransportListener* m_listener;
 };
@@ -0,0 +1,281 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShmTransport.h"
+
+#include <ThreadAffinity.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace owt_base {
+
+DEFINE_LOGGER(ShmTransport, "owt.ShmTransport");
+
+static const uint32_t kShmMagic = 0x4F575453; // "OWTS"
+static const uint32_t kShmVersion = 1;
+// Media frames flow forward; only small feedback messages flow back.
+static const uint32_t kForwardCapacity = 4 * 1024 * 1024;
+static const uint32_t kReverseCapacity = 256 * 1024;
+// Largest record either ring accepts (4-byte length prefix excluded).
+static const uint32_t kMaxRecord = 2 * 1024 * 1024;
+
+ShmTransport::ShmTransport(RawTransportListener* listener)
+    : m_isListener(false)
+    , m_isClosing(false)
+    , m_fd(-1)
+    , m_segmentSize(sizeof(SegmentHeader) + kForwardCapacity + kReverseCapacity)
+    , m_segment(nullptr)
+    , m_listener(listener)
+{
+}
+
+ShmTransport::~ShmTransport()
+{
+    close();
+}
+
+bool ShmTransport::mapSegment(const std::string& name, bool create)
+{
+    int flags = create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR;
+    m_fd = shm_open(name.c_str(), flags, 0600);
+    if (m_fd < 0) {
+        if (create)
+            ELOG_WARN("shm_open(%s) failed: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (create && ftruncate(m_fd, m_segmentSize) < 0) {
+        ELOG_WARN("ftruncate(%s) failed: %s", name.c_str(), strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* addr = mmap(nullptr, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (addr == MAP_FAILED) {
+        ELOG_WARN("mmap(%s) failed: %s", name.c_str(), strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        if (create)
+            shm_unlink(name.c_str());
+        return false;
+    }
+
+    m_segment = reinterpret_cast<SegmentHeader*>(addr);
+    m_name = name;
+
+    if (create) {
+        memset(m_segment, 0, sizeof(SegmentHeader));
+
+        pthread_mutexattr_t mattr;
+        pthread_mutexattr_init(&mattr);
+        pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+        pthread_mutex_init(&m_segment->mutex, &mattr);
+        pthread_mutexattr_destroy(&mattr);
+
+        pthread_condattr_t cattr;
+        pthread_condattr_init(&cattr);
+        pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+        pthread_cond_init(&m_segment->cond, &cattr);
+        pthread_condattr_destroy(&cattr);
+
+        m_segment->forward.capacity = kForwardCapacity;
+        m_segment->forward.dataOffset = sizeof(SegmentHeader);
+        m_segment->reverse.capacity = kReverseCapacity;
+        m_segment->reverse.dataOffset = sizeof(SegmentHeader) + kForwardCapacity;
+
+        // Publish magic last so attachers never see a half-initialized segment.
+        m_segment->version = kShmVersion;
+        __sync_synchronize();
+        m_segment->magic = kShmMagic;
+    } else if (m_segment->magic != kShmMagic || m_segment->version != kShmVersion) {
+        ELOG_WARN("segment %s has unexpected magic/version", name.c_str());
+        munmap(m_segment, m_segmentSize);
+        m_segment = nullptr;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool ShmTransport::listenTo(const std::string& name)
+{
+    // A stale segment from a crashed predecessor would fail O_EXCL; clear it.
+    shm_unlink(name.c_str());
+    if (!mapSegment(name, true))
+        return false;
+
+    m_isListener = true;
+    m_readThread = boost::thread([this]() {
+        ThreadAffinity::applyRole("transport");
+        readLoop(m_segment->forward);
+    });
+    ELOG_DEBUG("listening on shm segment %s", name.c_str());
+    return true;
+}
+
+bool ShmTransport::connectTo(const std::string& name)
+{
+    if (!mapSegment(name, false))
+        return false;
+
+    m_isListener = false;
+    m_segment->attached.store(1, std::memory_order_release);
+    m_readThread = boost::thread([this]() {
+        ThreadAffinity::applyRole("transport");
+        readLoop(m_segment->reverse);
+    });
+    ELOG_DEBUG("connected to shm segment %s", name.c_str());
+    m_listener->onTransportConnected();
+    return true;
+}
+
+void ShmTransport::copyIn(RingHeader& ring, uint64_t pos, const char* data, uint32_t len)
+{
+    char* base = reinterpret_cast<char*>(m_segment) + ring.dataOffset;
+    uint32_t offset = pos % ring.capacity;
+    uint32_t firstChunk = std::min(len, ring.capacity - offset);
+    memcpy(base + offset, data, firstChunk);
+    if (firstChunk < len)
+        memcpy(base, data + firstChunk, len - firstChunk);
+}
+
+void ShmTransport::copyOut(RingHeader& ring, uint64_t pos, char* data, uint32_t len)
+{
+    char* base = reinterpret_cast<char*>(m_segment) + ring.dataOffset;
+    uint32_t offset = pos % ring.capacity;
+    uint32_t firstChunk = std::min(len, ring.capacity - offset);
+    memcpy(data, base + offset, firstChunk);
+    if (firstChunk < len)
+        memcpy(data + firstChunk, base, len - firstChunk);
+}
+
+bool ShmTransport::writeRecord(RingHeader& ring, const char* header, int headerLength, const char* payload, int payloadLength)
+{
+    uint32_t recordLength = headerLength + payloadLength;
+    uint32_t need = 4 + recordLength;
+    if (recordLength > kMaxRecord || need > ring.capacity)
+        return false;
+
+    // The reverse ring has concurrent writers - feedback arrives on every
+    // destination's thread - and two unserialized writers would claim the
+    // same writePos and corrupt the ring. RawTransport serializes sends under
+    // m_sendQueueMutex; this is the equivalent.
+    boost::lock_guard<boost::mutex> guard(m_writeMutex);
+
+    uint64_t readPos = ring.readPos.load(std::memory_order_acquire);
+    uint64_t writePos = ring.writePos.load(std::memory_order_relaxed);
+    if (need > ring.capacity - (writePos - readPos)) {
+        // Ring full: the consumer is not keeping up; drop like a full socket
+        // buffer would.
+        return false;
+    }
+
+    uint32_t lengthPrefix = recordLength;
+    copyIn(ring, writePos, reinterpret_cast<const char*>(&lengthPrefix), 4);
+    copyIn(ring, writePos + 4, header, headerLength);
+    if (payloadLength > 0)
+        copyIn(ring, writePos + 4 + headerLength, payload, payloadLength);
+    ring.writePos.store(writePos + need, std::memory_order_release);
+
+    pthread_mutex_lock(&m_segment->mutex);
+    pthread_cond_broadcast(&m_segment->cond);
+    pthread_mutex_unlock(&m_segment->mutex);
+    return true;
+}
+
+void ShmTransport::readLoop(RingHeader& ring)
+{
+    m_readBuffer.reset(new char[kMaxRecord]);
+
+    while (!m_isClosing) {
+        uint64_t readPos = ring.readPos.load(std::memory_order_relaxed);
+        uint64_t writePos = ring.writePos.load(std::memory_order_acquire);
+
+        if (readPos == writePos) {
+            timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 10 * 1000 * 1000; // 10ms guard against lost wakeups.
+            if (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000;
+            }
+            pthread_mutex_lock(&m_segment->mutex);
+            if (ring.writePos.load(std::memory_order_acquire) == readPos)
+                pthread_cond_timedwait(&m_segment->cond, &m_segment->mutex, &deadline);
+            pthread_mutex_unlock(&m_segment->mutex);
+            continue;
+        }
+
+        uint32_t recordLength = 0;
+        copyOut(ring, readPos, reinterpret_cast<char*>(&recordLength), 4);
+        if (recordLength > kMaxRecord) {
+            // The ring is unrecoverable; tell the listener so it can tear the
+            // connection down rather than leave a silently dead transport.
+            ELOG_ERROR("corrupt record length %u on segment %s", recordLength, m_name.c_str());
+            if (!m_isClosing)
+                m_listener->onTransportError();
+            break;
+        }
+        copyOut(ring, readPos + 4, m_readBuffer.get(), recordLength);
+        ring.readPos.store(readPos + 4 + recordLength, std::memory_order_release);
+
+        if (!m_isClosing)
+            m_listener->onTransportData(m_readBuffer.get(), recordLength);
+    }
+}
+
+void ShmTransport::sendData(const char* buf, int len)
+{
+    sendData(buf, len, nullptr, 0);
+}
+
+void ShmTransport::sendData(const char* header, int headerLength, const char* payload, int payloadLength)
+{
+    if (!m_segment || m_isClosing)
+        return;
+
+    RingHeader& ring = m_isListener ? m_segment->reverse : m_segment->forward;
+    if (!writeRecord(ring, header, headerLength, payload, payloadLength))
+        ELOG_DEBUG("ring full on segment %s, record dropped", m_name.c_str());
+}
+
+void ShmTransport::close()
+{
+    if (m_isClosing.exchange(true))
+        return;
+
+    if (m_segment && !m_isListener)
+        m_segment->attached.store(0, std::memory_order_release);
+
+    if (m_segment) {
+        // Kick the reader out of its wait.
+        pthread_mutex_lock(&m_segment->mutex);
+        pthread_cond_broadcast(&m_segment->cond);
+        pthread_mutex_unlock(&m_segment->mutex);
+    }
+    if (m_readThread.joinable())
+        m_readThread.join();
+
+    if (m_segment) {
+        munmap(m_segment, m_segmentSize);
+        m_segment = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    if (m_isListener && !m_name.empty())
+        shm_unlink(m_name.c_str());
+}
+
+} /* namespace owt_base */
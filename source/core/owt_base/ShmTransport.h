@@ -0,0 +1,96 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ShmTransport_h
+#define ShmTransport_h
+
+#include <atomic>
+#include <boost/thread.hpp>
+#include <logger.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+
+#include "RawTransport.h"
+
+namespace owt_base {
+
+// Same-host internal transport over a shared-memory segment.
+//
+// The segment holds two length-prefixed byte rings guarded by one
+// process-shared mutex/condvar pair: a wide forward ring for media frames
+// (out-agent writes, in-agent reads) and a narrow reverse ring for feedback
+// messages. Frames cross process boundaries with a single copy into the ring
+// and no syscalls on the fast path, instead of two copies plus a loopback
+// TCP round-trip per frame.
+//
+// The in side creates a segment named after its listening port; the out side
+// attaches when the connection factory has determined both endpoints share a
+// host, and falls back to RawTransport otherwise.
+class ShmTransport {
+    DECLARE_LOGGER();
+
+public:
+    explicit ShmTransport(RawTransportListener* listener);
+    ~ShmTransport();
+
+    // In side: creates the segment and starts reading the forward ring.
+    bool listenTo(const std::string& name);
+    // Out side: attaches to an existing segment and starts reading the
+    // reverse ring. Fails (false) if the segment does not exist.
+    bool connectTo(const std::string& name);
+
+    // Writes one framed record (same TDT framing as RawTransport). The
+    // record is dropped if the ring stays full; internal streams recover the
+    // way they do from UDP loss.
+    void sendData(const char* buf, int len);
+    void sendData(const char* header, int headerLength, const char* payload, int payloadLength);
+
+    void close();
+
+    // In side: whether a same-host sender is attached to the segment.
+    bool hasPeer() const { return m_segment && m_segment->attached.load(std::memory_order_acquire); }
+
+private:
+    struct RingHeader {
+        std::atomic<uint64_t> writePos;
+        std::atomic<uint64_t> readPos;
+        uint32_t capacity;
+        uint32_t dataOffset; // From segment start.
+    };
+
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> attached; // A writer is connected.
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        RingHeader forward;
+        RingHeader reverse;
+    };
+
+    bool mapSegment(const std::string& name, bool create);
+    bool writeRecord(RingHeader& ring, const char* header, int headerLength, const char* payload, int payloadLength);
+    void readLoop(RingHeader& ring);
+    void copyIn(RingHeader& ring, uint64_t pos, const char* data, uint32_t len);
+    void copyOut(RingHeader& ring, uint64_t pos, char* data, uint32_t len);
+
+    bool m_isListener;
+    std::atomic<bool> m_isClosing;
+    std::string m_name;
+    int m_fd;
+    size_t m_segmentSize;
+    SegmentHeader* m_segment;
+    RawTransportListener* m_listener;
+    // Serializes writers on this side's ring. All of a ring's writers live in
+    // one process and go through this object, so the lock stays process-local
+    // instead of joining the shared segment.
+    boost::mutex m_writeMutex;
+    boost::thread m_readThread;
+    boost::shared_array<char> m_readBuffer;
+};
+
+} /* namespace owt_base */
+
+#endif /* ShmTransport_h */
@@ -0,0 +1,162 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SimulcastLayerSelector.h"
+
+#include <chrono>
+
+namespace owt_base {
+
+DEFINE_LOGGER(SimulcastLayerSelector, "owt.SimulcastLayerSelector");
+
+static int64_t nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SimulcastLayerSelector::SimulcastLayerSelector()
+    : m_activeLayer(-1)
+    , m_pendingLayer(-1)
+    , m_tsOffset(0)
+    , m_lastForwardedTs(0)
+    , m_lastForwardedMs(0)
+    , m_forwardedFrames(0)
+    , m_droppedFrames(0)
+{
+    for (int i = 0; i < kMaxLayers; ++i) {
+        m_layers[i].seenKeyFrame = false;
+        m_layers[i].width = 0;
+        m_layers[i].height = 0;
+    }
+}
+
+SimulcastLayerSelector::~SimulcastLayerSelector()
+{
+    if (m_forwardedFrames > 0 || m_droppedFrames > 0) {
+        ELOG_DEBUG("Forwarded %zu frames, dropped %zu (other layers)",
+            (size_t)m_forwardedFrames, (size_t)m_droppedFrames);
+    }
+}
+
+FrameDestination* SimulcastLayerSelector::getLayerSink(int layerId)
+{
+    if (layerId < 0 || layerId >= kMaxLayers) {
+        ELOG_WARN("Layer id %d out of range", layerId);
+        return nullptr;
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_layers[layerId].sink)
+        m_layers[layerId].sink.reset(new LayerSink(this, layerId));
+    return m_layers[layerId].sink.get();
+}
+
+void SimulcastLayerSelector::selectLayer(int layerId)
+{
+    if (layerId < 0 || layerId >= kMaxLayers)
+        return;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (layerId == m_activeLayer) {
+        m_pendingLayer = -1;
+        return;
+    }
+
+    // Both directions wait for the target's next key frame: simulcast layers
+    // are independent streams, so the subscriber's decoder cannot join the
+    // new one mid-GOP no matter which way the switch goes.
+    m_pendingLayer = layerId;
+    ELOG_DEBUG("Switch to layer %d pending (active %d, target %s)",
+        layerId, m_activeLayer,
+        m_layers[layerId].seenKeyFrame ? "seen a key frame before" : "not yet decodable");
+}
+
+int SimulcastLayerSelector::activeLayer()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_activeLayer;
+}
+
+bool SimulcastLayerSelector::isLayerDecodable(int layerId)
+{
+    if (layerId < 0 || layerId >= kMaxLayers)
+        return false;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_layers[layerId].seenKeyFrame;
+}
+
+void SimulcastLayerSelector::onLayerFrame(int layerId, const Frame& frame)
+{
+    Frame outFrame;
+    bool forward = false;
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        LayerState& layer = m_layers[layerId];
+
+        if (frame.additionalInfo.video.isKeyFrame) {
+            layer.seenKeyFrame = true;
+            layer.width = frame.additionalInfo.video.width;
+            layer.height = frame.additionalInfo.video.height;
+
+            if (m_activeLayer < 0) {
+                // First decodable frame on any layer starts the stream;
+                // prefer a pending selection if one raced ahead of us.
+                if (m_pendingLayer < 0 || m_pendingLayer == layerId) {
+                    m_activeLayer = layerId;
+                    m_pendingLayer = -1;
+                }
+            } else if (m_pendingLayer == layerId) {
+                // The clean point: the target layer restarts decodability
+                // here, so flip without involving the publisher.
+                ELOG_DEBUG("Switched layer %d -> %d at key frame", m_activeLayer, layerId);
+                m_activeLayer = layerId;
+                m_pendingLayer = -1;
+
+                // Rebase so the forwarded timestamp line stays monotonic
+                // across the per-stream offset jump, spaced by wall time
+                // since the last forwarded frame.
+                if (m_forwardedFrames > 0) {
+                    int64_t gapMs = nowMs() - m_lastForwardedMs;
+                    if (gapMs < 1)
+                        gapMs = 1;
+                    m_tsOffset = m_lastForwardedTs + (uint32_t)(gapMs * 90) - frame.timeStamp;
+                }
+            }
+        }
+
+        forward = (layerId == m_activeLayer);
+        if (forward) {
+            outFrame = frame;
+            outFrame.timeStamp = frame.timeStamp + m_tsOffset;
+            m_lastForwardedTs = outFrame.timeStamp;
+            m_lastForwardedMs = nowMs();
+            ++m_forwardedFrames;
+        } else {
+            ++m_droppedFrames;
+        }
+    }
+
+    if (forward)
+        deliverFrame(outFrame);
+}
+
+void SimulcastLayerSelector::onFeedback(const FeedbackMsg& msg)
+{
+    // Feedback concerns the stream the subscriber is watching; a key frame
+    // request or bitrate cap for the active layer must not fan out to the
+    // others, or every switch degenerates into a keyframe storm.
+    boost::shared_ptr<LayerSink> sink;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_activeLayer >= 0)
+            sink = m_layers[m_activeLayer].sink;
+    }
+    if (sink)
+        sink->forwardFeedback(msg);
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,106 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SimulcastLayerSelector_h
+#define SimulcastLayerSelector_h
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <logger.h>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+/**
+ * Per-subscriber layer switching across independent simulcast streams.
+ * Unlike VP9LayerFilter, which filters layers inside one SVC bitstream,
+ * each simulcast layer is a self-contained encoded stream arriving through
+ * its own VideoFrameConstructor, so the selector exposes one FrameDestination
+ * sink per layer and forwards exactly one of them downstream.
+ *
+ * Switching never asks the publisher for a key frame: selectLayer() records
+ * the target and the flip happens at the target layer's next naturally
+ * occurring key frame (the only clean point a fresh decoder can join an
+ * independent stream at). Until that point the subscriber keeps receiving
+ * the current layer, so a pending switch costs latency, not a picture gap
+ * or a publisher-side bitrate spike. Forwarded timestamps are rebased onto
+ * a continuous line so the downstream packetizer never sees the per-stream
+ * timestamp jump.
+ *
+ * Subscriber feedback (key frame requests, bitrate) is routed to the active
+ * layer's source only.
+ */
+class SimulcastLayerSelector : public FrameSource {
+    DECLARE_LOGGER();
+
+public:
+    static const int kMaxLayers = 4;
+
+    SimulcastLayerSelector();
+    virtual ~SimulcastLayerSelector();
+
+    // The sink the given layer's VideoFrameConstructor output should be
+    // wired to. Layer ids are dense, 0 = lowest quality. Returns null for
+    // out-of-range ids.
+    FrameDestination* getLayerSink(int layerId);
+
+    // Requests forwarding the given layer; takes effect at that layer's
+    // next key frame. Selecting the active layer cancels a pending switch.
+    void selectLayer(int layerId);
+
+    int activeLayer();
+
+    // Whether a key frame has been seen on the layer, i.e. a switch to it
+    // can complete.
+    bool isLayerDecodable(int layerId);
+
+    // Implements FrameSource.
+    void onFeedback(const FeedbackMsg&);
+
+private:
+    // Tags incoming frames with their layer id; onFrame() carries no source
+    // identity on its own.
+    class LayerSink : public FrameDestination {
+    public:
+        LayerSink(SimulcastLayerSelector* owner, int layerId)
+            : m_owner(owner)
+            , m_layerId(layerId)
+        {
+        }
+        void onFrame(const Frame& frame) { m_owner->onLayerFrame(m_layerId, frame); }
+        void forwardFeedback(const FeedbackMsg& msg) { deliverFeedbackMsg(msg); }
+
+    private:
+        SimulcastLayerSelector* m_owner;
+        int m_layerId;
+    };
+
+    struct LayerState {
+        boost::shared_ptr<LayerSink> sink;
+        bool seenKeyFrame;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    void onLayerFrame(int layerId, const Frame& frame);
+
+    boost::mutex m_mutex;
+    LayerState m_layers[kMaxLayers];
+
+    int m_activeLayer; // -1 until the first key frame on any layer.
+    int m_pendingLayer; // -1 when no switch is pending.
+
+    // Timestamp rebasing across switches (90kHz domain).
+    uint32_t m_tsOffset;
+    uint32_t m_lastForwardedTs;
+    int64_t m_lastForwardedMs;
+
+    uint64_t m_forwardedFrames;
+    uint64_t m_droppedFrames;
+};
+
+} /* namespace owt_base */
+
+#endif /* SimulcastLayerSelector_h */
@@ -0,0 +1,158 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SnapshotEncoder.h"
+
+namespace owt_base {
+
+DEFINE_LOGGER(SnapshotEncoder, "owt.SnapshotEncoder");
+
+SnapshotEncoder::SnapshotEncoder()
+    : m_jpegCtx(NULL)
+    , m_width(0)
+    , m_height(0)
+{
+    m_bufferManager.reset(new I420BufferManager(2));
+    // Thumbnails are tiny; never burn a GPU VPP session on them.
+    m_converter.reset(new FrameConverter(false));
+}
+
+SnapshotEncoder::~SnapshotEncoder()
+{
+    closeEncoder();
+}
+
+char *SnapshotEncoder::ff_err2str(int errRet)
+{
+    av_strerror(errRet, (char*)(&m_errbuff), 500);
+    return m_errbuff;
+}
+
+bool SnapshotEncoder::openEncoder(uint32_t width, uint32_t height)
+{
+    if (m_jpegCtx && m_width == width && m_height == height)
+        return true;
+
+    closeEncoder();
+
+    AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        ELOG_ERROR("Could not find ffmpeg mjpeg encoder");
+        return false;
+    }
+
+    m_jpegCtx = avcodec_alloc_context3(codec);
+    if (!m_jpegCtx) {
+        ELOG_ERROR("Could not alloc mjpeg encoder context");
+        return false;
+    }
+
+    m_jpegCtx->width = width;
+    m_jpegCtx->height = height;
+    m_jpegCtx->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    m_jpegCtx->time_base = (AVRational){1, 30};
+    // Fixed mid-range quality; previews favour small payloads over fidelity.
+    m_jpegCtx->flags |= AV_CODEC_FLAG_QSCALE;
+    m_jpegCtx->global_quality = 4 * FF_QP2LAMBDA;
+
+    int ret = avcodec_open2(m_jpegCtx, codec, NULL);
+    if (ret < 0) {
+        ELOG_ERROR("Could not open mjpeg encoder context, %s", ff_err2str(ret));
+        avcodec_free_context(&m_jpegCtx);
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+void SnapshotEncoder::closeEncoder()
+{
+    if (m_jpegCtx)
+        avcodec_free_context(&m_jpegCtx);
+    m_width = 0;
+    m_height = 0;
+}
+
+bool SnapshotEncoder::encode(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer,
+        uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg)
+{
+    if (!buffer || !maxWidth || !maxHeight)
+        return false;
+
+    boost::lock_guard<boost::mutex> guard(m_mutex);
+
+    // Fit within the requested bounds, aspect preserved, dimensions even
+    // for 4:2:0; don't upscale a source smaller than the bounds.
+    uint32_t srcWidth = buffer->width();
+    uint32_t srcHeight = buffer->height();
+    uint32_t dstWidth = srcWidth;
+    uint32_t dstHeight = srcHeight;
+    if (dstWidth > maxWidth) {
+        dstHeight = dstHeight * maxWidth / dstWidth;
+        dstWidth = maxWidth;
+    }
+    if (dstHeight > maxHeight) {
+        dstWidth = dstWidth * maxHeight / dstHeight;
+        dstHeight = maxHeight;
+    }
+    dstWidth &= ~1;
+    dstHeight &= ~1;
+    if (!dstWidth || !dstHeight)
+        return false;
+
+    rtc::scoped_refptr<webrtc::I420Buffer> scaledBuffer = m_bufferManager->getFreeBuffer(dstWidth, dstHeight);
+    if (!scaledBuffer) {
+        ELOG_ERROR("No free buffer for %dx%d snapshot", dstWidth, dstHeight);
+        return false;
+    }
+
+    if (!m_converter->convert(buffer.get(), scaledBuffer.get())) {
+        ELOG_ERROR("Convert(%dx%d -> %dx%d) failed", srcWidth, srcHeight, dstWidth, dstHeight);
+        return false;
+    }
+
+    if (!openEncoder(dstWidth, dstHeight))
+        return false;
+
+    AVFrame* frame = av_frame_alloc();
+    if (!frame)
+        return false;
+
+    frame->format = AV_PIX_FMT_YUVJ420P;
+    frame->width = dstWidth;
+    frame->height = dstHeight;
+    frame->data[0] = scaledBuffer->MutableDataY();
+    frame->data[1] = scaledBuffer->MutableDataU();
+    frame->data[2] = scaledBuffer->MutableDataV();
+    frame->linesize[0] = scaledBuffer->StrideY();
+    frame->linesize[1] = scaledBuffer->StrideU();
+    frame->linesize[2] = scaledBuffer->StrideV();
+    frame->quality = m_jpegCtx->global_quality;
+
+    bool ok = false;
+    int ret = avcodec_send_frame(m_jpegCtx, frame);
+    if (ret < 0) {
+        ELOG_ERROR("avcodec_send_frame, %s", ff_err2str(ret));
+    } else {
+        AVPacket packet;
+        av_init_packet(&packet);
+        ret = avcodec_receive_packet(m_jpegCtx, &packet);
+        if (ret < 0) {
+            ELOG_ERROR("avcodec_receive_packet, %s", ff_err2str(ret));
+        } else {
+            jpeg.assign(packet.data, packet.data + packet.size);
+            ok = true;
+        }
+        av_packet_unref(&packet);
+    }
+
+    av_frame_free(&frame);
+
+    ELOG_TRACE("Snapshot %dx%d -> %dx%d, %ld bytes", srcWidth, srcHeight, dstWidth, dstHeight, jpeg.size());
+    return ok;
+}
+
+} /* namespace owt_base */
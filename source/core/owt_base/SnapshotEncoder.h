@@ -0,0 +1,68 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SnapshotEncoder_h
+#define SnapshotEncoder_h
+
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <webrtc/api/video/video_frame_buffer.h>
+
+#include <logger.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "FrameConverter.h"
+#include "I420BufferManager.h"
+
+namespace owt_base {
+
+/**
+ * On-demand JPEG thumbnails from raw frames already flowing through the
+ * pipeline. The owner retains its most recent composed or decoded buffer (a
+ * refcount bump on the hot path) and hands it here when a preview is polled;
+ * scaling draws from a pooled buffer set and the MJPEG encoder context stays
+ * open across snapshots of one size, so a dashboard polling previews costs
+ * one downscale plus one JPEG encode per request instead of a video
+ * subscription per tile.
+ */
+class SnapshotEncoder {
+    DECLARE_LOGGER();
+
+public:
+    SnapshotEncoder();
+    ~SnapshotEncoder();
+
+    // Scales the buffer to fit within maxWidth x maxHeight with the aspect
+    // ratio preserved and encodes it as a JPEG into `jpeg`. Serialized
+    // internally; safe to call from any polling thread.
+    bool encode(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer,
+            uint32_t maxWidth, uint32_t maxHeight, std::vector<uint8_t>& jpeg);
+
+protected:
+    bool openEncoder(uint32_t width, uint32_t height);
+    void closeEncoder();
+
+private:
+    boost::mutex m_mutex;
+
+    boost::scoped_ptr<I420BufferManager> m_bufferManager;
+    boost::scoped_ptr<FrameConverter> m_converter;
+
+    AVCodecContext* m_jpegCtx;
+    uint32_t m_width;
+    uint32_t m_height;
+
+    char m_errbuff[500];
+    char *ff_err2str(int errRet);
+};
+
+} /* namespace owt_base */
+
+#endif /* SnapshotEncoder_h */
@@ -0,0 +1,97 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StagingBufferPool.h"
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+
+namespace owt_base {
+
+DEFINE_LOGGER(StagingBufferPool, "owt.StagingBufferPool");
+
+static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+static size_t roundToHugePages(size_t size)
+{
+    return (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+}
+
+StagingBufferPool& StagingBufferPool::instance()
+{
+    static StagingBufferPool pool;
+    return pool;
+}
+
+StagingBufferPool::StagingBufferPool()
+    : m_pooledBytes(0)
+    , m_maxPooledBytes(256 * 1024 * 1024)
+{
+    const char* env = getenv("OWT_STAGING_POOL_MB");
+    if (env && env[0]) {
+        long mb = strtol(env, NULL, 10);
+        if (mb >= 0)
+            m_maxPooledBytes = (size_t)mb * 1024 * 1024;
+    }
+}
+
+boost::shared_ptr<uint8_t> StagingBufferPool::acquire(size_t size)
+{
+    size_t bytes = roundToHugePages(size);
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_free.find(bytes);
+        if (it != m_free.end() && !it->second.empty()) {
+            uint8_t* ptr = it->second.back();
+            it->second.pop_back();
+            m_pooledBytes -= bytes;
+            return boost::shared_ptr<uint8_t>(ptr,
+                [this, bytes](uint8_t* p) { release(p, bytes); });
+        }
+    }
+
+    // Prefer the explicit hugepage reserve; hosts without one still get
+    // huge mappings from THP via madvise, and at worst plain 4KB pages.
+    void* map = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (map == MAP_FAILED) {
+        map = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) {
+            ELOG_ERROR("mmap of %zu staging bytes failed", bytes);
+            return boost::shared_ptr<uint8_t>();
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(map, bytes, MADV_HUGEPAGE);
+#endif
+    }
+
+    // Pin so the streaming copy never takes a fault mid-transfer;
+    // best-effort, RLIMIT_MEMLOCK may say no.
+    if (mlock(map, bytes) != 0)
+        ELOG_DEBUG("mlock of %zu staging bytes declined", bytes);
+
+    return boost::shared_ptr<uint8_t>(reinterpret_cast<uint8_t*>(map),
+        [this, bytes](uint8_t* p) { release(p, bytes); });
+}
+
+void StagingBufferPool::release(uint8_t* ptr, size_t bytes)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_pooledBytes + bytes <= m_maxPooledBytes) {
+            m_free[bytes].push_back(ptr);
+            m_pooledBytes += bytes;
+            return;
+        }
+    }
+    munmap(ptr, bytes);
+}
+
+} /* namespace owt_base */
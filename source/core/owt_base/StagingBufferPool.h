@@ -0,0 +1,57 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef StagingBufferPool_h
+#define StagingBufferPool_h
+
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+
+namespace owt_base {
+
+/**
+ * Pool of pinned, hugepage-backed staging buffers for GPU surface readback
+ * and upload. A 4K NV12 surface is ~12MB; copying it through a fresh
+ * pageable allocation pays a fault per page and a TLB miss per 4KB line,
+ * which caps memcpy_from_uswc well below memory bandwidth. Buffers here are
+ * 2MB-rounded anonymous mappings backed by huge pages (MAP_HUGETLB when the
+ * host has a reserve, transparent hugepages otherwise), mlock()ed so the
+ * transfer never faults, and recycled by size class through the returned
+ * shared_ptr's deleter.
+ *
+ * OWT_STAGING_POOL_MB bounds the bytes kept cached for reuse (default 256);
+ * buffers beyond the cap are unmapped on release instead of pooled.
+ */
+class StagingBufferPool {
+    DECLARE_LOGGER();
+
+public:
+    static StagingBufferPool& instance();
+
+    // At least `size` bytes, page-aligned (so also 16-aligned for the
+    // streaming copy kernels). Falls back to plain mappings if hugepages
+    // are unavailable; only returns null when mmap itself fails.
+    boost::shared_ptr<uint8_t> acquire(size_t size);
+
+private:
+    StagingBufferPool();
+
+    void release(uint8_t* ptr, size_t bytes);
+
+    boost::mutex m_mutex;
+    // Free buffers by mapping size.
+    std::map<size_t, std::vector<uint8_t*>> m_free;
+    size_t m_pooledBytes;
+    size_t m_maxPooledBytes;
+};
+
+} /* namespace owt_base */
+#endif /* StagingBufferPool_h */
@@ -0,0 +1,448 @@
+// Throughput/latency benchmark harness for the internal transports.
+//
+// Drives RawTransport TCP/UDP and SctpTransport either in-process
+// (loopback, the default) or cross-host (--mode server on one node,
+// --mode client on the other), with a configurable frame-size
+// distribution. The server echoes every frame; the client embeds a
+// monotonic timestamp in each payload and measures round-trip time, so
+// no clock synchronization is needed cross-host. Reported per run:
+// throughput (msgs/s and Mbps), RTT p50/p90/p99/max, and CPU cost
+// normalized per Gbps (from getrusage), which is the number to watch
+// across batching/io_uring style transport changes.
+//
+// Examples:
+//   TransportBench --transport tcp --duration 10
+//   TransportBench --transport udp --sizes 160:0.7,1200:0.25,8000:0.05
+//   TransportBench --transport tcp --mode server --port 18000
+//   TransportBench --transport tcp --mode client --ip 10.0.0.2 --port 18000
+//   TransportBench --transport sctp                  (loopback only)
+//
+// QuicTransport lives behind the quicIO addon and its SDK; it is not
+// driven here.
+//
+// Build: uncomment the TransportBench target in
+// source/agent/addons/internalIO/binding.gyp.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "RawTransport.h"
+#include "SctpTransport.h"
+
+using namespace owt_base;
+
+static int64_t monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t cpuUs()
+{
+    rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (int64_t)ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec
+         + (int64_t)ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec;
+}
+
+// Frame-size distribution parsed from "size:weight,size:weight,...".
+// pick() samples it; the default mix approximates a conference stream
+// (mostly audio-sized frames, some video deltas, occasional keyframes).
+class SizeDist {
+public:
+    bool parse(const std::string& spec)
+    {
+        m_sizes.clear();
+        m_cumulative.clear();
+        double total = 0;
+        const char* p = spec.c_str();
+        while (*p) {
+            char* end = NULL;
+            long size = strtol(p, &end, 10);
+            if (end == p || *end != ':')
+                return false;
+            p = end + 1;
+            double weight = strtod(p, &end);
+            if (end == p || size < (long)sizeof(int64_t) || weight <= 0)
+                return false;
+            p = end;
+            if (*p == ',')
+                ++p;
+            total += weight;
+            m_sizes.push_back(size);
+            m_cumulative.push_back(total);
+        }
+        if (m_sizes.empty())
+            return false;
+        for (size_t i = 0; i < m_cumulative.size(); ++i)
+            m_cumulative[i] /= total;
+        return true;
+    }
+
+    size_t pick(std::mt19937& rng)
+    {
+        double r = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        for (size_t i = 0; i < m_cumulative.size(); ++i) {
+            if (r <= m_cumulative[i])
+                return m_sizes[i];
+        }
+        return m_sizes.back();
+    }
+
+    size_t maxSize() const
+    {
+        size_t m = 0;
+        for (size_t i = 0; i < m_sizes.size(); ++i)
+            m = std::max(m, m_sizes[i]);
+        return m;
+    }
+
+private:
+    std::vector<size_t> m_sizes;
+    std::vector<double> m_cumulative;
+};
+
+// Minimal adapter so the bench drives RawTransport and SctpTransport
+// through one surface; the two classes do not share a base for send.
+class BenchLink {
+public:
+    virtual ~BenchLink() { }
+    virtual void sendData(const char* buf, int len) = 0;
+};
+
+// One endpoint of the bench. As the echo side it bounces every payload
+// straight back; as the measuring side it reads the embedded send
+// timestamp out of each returned payload and records the RTT.
+class BenchEndpoint : public RawTransportListener {
+public:
+    BenchEndpoint(bool echo)
+        : m_echo(echo)
+        , m_link(NULL)
+        , m_connected(false)
+        , m_receivedMessages(0)
+        , m_receivedBytes(0)
+    {
+        m_rtts.reserve(1 << 20);
+    }
+
+    void setLink(BenchLink* link) { m_link = link; }
+
+    void onTransportData(char* buf, int len)
+    {
+        m_receivedMessages++;
+        m_receivedBytes += len;
+
+        if (m_echo) {
+            if (m_link)
+                m_link->sendData(buf, len);
+            return;
+        }
+
+        if (len >= (int)sizeof(int64_t)) {
+            int64_t sentAt;
+            memcpy(&sentAt, buf, sizeof(sentAt));
+            int64_t rtt = monotonicUs() - sentAt;
+            // Cap the sample store; past this the distribution is settled.
+            if (m_rtts.size() < (8u << 20))
+                m_rtts.push_back((uint32_t)std::max<int64_t>(rtt, 0));
+        }
+    }
+
+    void onTransportError() { fprintf(stderr, "transport error\n"); }
+    void onTransportConnected() { m_connected = true; }
+
+    bool waitConnected(int timeoutMs)
+    {
+        int waited = 0;
+        while (!m_connected && waited < timeoutMs) {
+            usleep(10000);
+            waited += 10;
+        }
+        return m_connected;
+    }
+
+    uint64_t receivedMessages() const { return m_receivedMessages; }
+    uint64_t receivedBytes() const { return m_receivedBytes; }
+
+    void report(uint64_t sentMessages, uint64_t sentBytes, int64_t elapsedUs, int64_t usedCpuUs)
+    {
+        double seconds = elapsedUs / 1e6;
+        double mbps = (m_receivedBytes * 8.0) / elapsedUs; // bytes/us == Mbps
+        double gbps = mbps / 1000.0;
+
+        printf("sent      : %llu msgs, %llu bytes\n",
+                (unsigned long long)sentMessages, (unsigned long long)sentBytes);
+        printf("received  : %llu msgs, %llu bytes (%.2f%% of sent)\n",
+                (unsigned long long)m_receivedMessages, (unsigned long long)m_receivedBytes,
+                sentMessages ? 100.0 * m_receivedMessages / sentMessages : 0.0);
+        printf("throughput: %.0f msgs/s, %.1f Mbps (echoed)\n",
+                m_receivedMessages / seconds, mbps);
+
+        if (!m_rtts.empty()) {
+            std::sort(m_rtts.begin(), m_rtts.end());
+            printf("rtt       : p50 %uus, p90 %uus, p99 %uus, max %uus (%zu samples)\n",
+                    percentile(50), percentile(90), percentile(99),
+                    m_rtts.back(), m_rtts.size());
+        }
+
+        double cpuShare = (double)usedCpuUs / elapsedUs;
+        printf("cpu       : %.1f%% of one core", cpuShare * 100.0);
+        if (gbps > 0.001)
+            printf(", %.2f core-s per Gbit transferred", (usedCpuUs / 1e6) / (gbps * seconds));
+        printf("\n");
+    }
+
+private:
+    uint32_t percentile(int p)
+    {
+        size_t idx = (m_rtts.size() * p) / 100;
+        if (idx >= m_rtts.size())
+            idx = m_rtts.size() - 1;
+        return m_rtts[idx];
+    }
+
+    bool m_echo;
+    BenchLink* m_link;
+    volatile bool m_connected;
+    uint64_t m_receivedMessages;
+    uint64_t m_receivedBytes;
+    std::vector<uint32_t> m_rtts;
+};
+
+class RawLink : public BenchLink {
+public:
+    RawLink(RawTransportInterface* transport) : m_transport(transport) { }
+    void sendData(const char* buf, int len) { m_transport->sendData(buf, len); }
+private:
+    RawTransportInterface* m_transport;
+};
+
+class SctpLink : public BenchLink {
+public:
+    SctpLink(SctpTransport* transport) : m_transport(transport) { }
+    void sendData(const char* buf, int len) { m_transport->sendData(buf, len); }
+private:
+    SctpTransport* m_transport;
+};
+
+struct BenchConfig {
+    std::string transport;
+    std::string mode;
+    std::string ip;
+    uint32_t port;
+    uint32_t durationSec;
+    uint32_t rate; // frames per second, 0 = unpaced
+    SizeDist sizes;
+
+    BenchConfig()
+        : transport("tcp")
+        , mode("loopback")
+        , ip("127.0.0.1")
+        , port(18000)
+        , durationSec(10)
+        , rate(2000)
+    {
+        sizes.parse("160:0.70,1200:0.25,15000:0.05");
+    }
+};
+
+// Paced send loop shared by all transports; returns sent counts.
+static void runSender(BenchLink* link, BenchEndpoint* endpoint, const BenchConfig& config,
+        uint64_t* sentMessages, uint64_t* sentBytes)
+{
+    std::mt19937 rng(12345);
+    SizeDist sizes = config.sizes;
+    std::vector<char> payload(sizes.maxSize(), 0x5A);
+
+    int64_t start = monotonicUs();
+    int64_t cpuStart = cpuUs();
+    int64_t endAt = start + (int64_t)config.durationSec * 1000000;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+
+    while (monotonicUs() < endAt) {
+        size_t size = sizes.pick(rng);
+        int64_t now = monotonicUs();
+        memcpy(&payload[0], &now, sizeof(now));
+        link->sendData(&payload[0], size);
+        messages++;
+        bytes += size;
+
+        if (config.rate) {
+            // Re-pace against the wall clock rather than sleeping a fixed
+            // interval, so slow sends do not silently lower the rate.
+            int64_t due = start + (int64_t)(messages * 1000000ull / config.rate);
+            int64_t ahead = due - monotonicUs();
+            if (ahead > 1000)
+                usleep(ahead);
+        }
+    }
+
+    // Let the tail of the echo traffic come home before reporting.
+    usleep(300000);
+
+    *sentMessages = messages;
+    *sentBytes = bytes;
+    endpoint->report(messages, bytes, monotonicUs() - start, cpuUs() - cpuStart);
+}
+
+template <Protocol prot>
+static int runRaw(const BenchConfig& config)
+{
+    size_t bufferSize = config.sizes.maxSize() + 64;
+    uint64_t sentMessages = 0, sentBytes = 0;
+
+    if (config.mode == "server") {
+        BenchEndpoint echoEndpoint(true);
+        RawTransport<prot> transport(&echoEndpoint, bufferSize);
+        RawLink link(&transport);
+        echoEndpoint.setLink(&link);
+        transport.listenTo(config.port);
+        printf("echo server on port %u, ctrl-c to stop\n", transport.getListeningPort());
+        while (true)
+            sleep(60);
+        return 0;
+    }
+
+    if (config.mode == "client") {
+        BenchEndpoint endpoint(false);
+        RawTransport<prot> transport(&endpoint, bufferSize);
+        RawLink link(&transport);
+        transport.createConnection(config.ip, config.port);
+        if (!endpoint.waitConnected(5000)) {
+            fprintf(stderr, "cannot connect to %s:%u\n", config.ip.c_str(), config.port);
+            return 1;
+        }
+        runSender(&link, &endpoint, config, &sentMessages, &sentBytes);
+        transport.close();
+        return 0;
+    }
+
+    // loopback: echo listener and measuring sender in one process.
+    BenchEndpoint echoEndpoint(true);
+    RawTransport<prot> echoTransport(&echoEndpoint, bufferSize);
+    RawLink echoLink(&echoTransport);
+    echoEndpoint.setLink(&echoLink);
+    echoTransport.listenTo(0);
+
+    BenchEndpoint endpoint(false);
+    RawTransport<prot> transport(&endpoint, bufferSize);
+    RawLink link(&transport);
+    transport.createConnection("127.0.0.1", echoTransport.getListeningPort());
+    if (!endpoint.waitConnected(5000)) {
+        fprintf(stderr, "loopback connect failed\n");
+        return 1;
+    }
+
+    runSender(&link, &endpoint, config, &sentMessages, &sentBytes);
+
+    transport.close();
+    echoTransport.close();
+    return 0;
+}
+
+// SctpTransport exchanges ports rather than listening, so only the
+// in-process loopback is wired; cross-host would need out-of-band port
+// signaling.
+static int runSctp(const BenchConfig& config)
+{
+    if (config.mode != "loopback") {
+        fprintf(stderr, "sctp supports loopback mode only\n");
+        return 1;
+    }
+
+    BenchEndpoint echoEndpoint(true);
+    boost::scoped_ptr<SctpTransport> echoTransport(new SctpTransport(&echoEndpoint, config.sizes.maxSize() + 64));
+    SctpLink echoLink(echoTransport.get());
+    echoEndpoint.setLink(&echoLink);
+    echoTransport->open();
+
+    BenchEndpoint endpoint(false);
+    boost::scoped_ptr<SctpTransport> transport(new SctpTransport(&endpoint, config.sizes.maxSize() + 64));
+    SctpLink link(transport.get());
+    transport->open();
+
+    echoTransport->connect("127.0.0.1", transport->getLocalUdpPort(), transport->getLocalSctpPort());
+    transport->connect("127.0.0.1", echoTransport->getLocalUdpPort(), echoTransport->getLocalSctpPort());
+    if (!endpoint.waitConnected(5000)) {
+        fprintf(stderr, "sctp loopback connect failed\n");
+        return 1;
+    }
+
+    uint64_t sentMessages = 0, sentBytes = 0;
+    runSender(&link, &endpoint, config, &sentMessages, &sentBytes);
+
+    transport->close();
+    echoTransport->close();
+    return 0;
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "usage: %s [--transport tcp|udp|sctp] [--mode loopback|server|client]\n"
+        "          [--ip addr] [--port n] [--duration sec] [--rate fps|0]\n"
+        "          [--sizes size:weight,...]\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (arg == "--transport" && value) {
+            config.transport = value; ++i;
+        } else if (arg == "--mode" && value) {
+            config.mode = value; ++i;
+        } else if (arg == "--ip" && value) {
+            config.ip = value; ++i;
+        } else if (arg == "--port" && value) {
+            config.port = atoi(value); ++i;
+        } else if (arg == "--duration" && value) {
+            config.durationSec = atoi(value); ++i;
+        } else if (arg == "--rate" && value) {
+            config.rate = atoi(value); ++i;
+        } else if (arg == "--sizes" && value) {
+            if (!config.sizes.parse(value)) {
+                fprintf(stderr, "bad --sizes spec: %s\n", value);
+                return 1;
+            }
+            ++i;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.transport == "udp" && config.sizes.maxSize() > 60000) {
+        fprintf(stderr, "udp frames cannot exceed 60000 bytes\n");
+        return 1;
+    }
+
+    printf("transport %s, mode %s, duration %us, rate %u/s\n",
+            config.transport.c_str(), config.mode.c_str(), config.durationSec, config.rate);
+
+    if (config.transport == "tcp")
+        return runRaw<TCP>(config);
+    if (config.transport == "udp")
+        return runRaw<UDP>(config);
+    if (config.transport == "sctp")
+        return runSctp(config);
+
+    usage(argv[0]);
+    return 1;
+}
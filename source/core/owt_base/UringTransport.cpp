@@ -0,0 +1,508 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "UringTransport.h"
+
+#include <ThreadAffinity.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define OWT_HAS_IOURING 1
+#endif
+#endif
+
+namespace owt_base {
+
+DEFINE_LOGGER(UringTransport, "owt.UringTransport");
+
+// Large enough for the 64KB UDP datagram limit plus the 4-byte TDT prefix.
+static const uint32_t kSlotSize = 64 * 1024 + 64;
+static const uint32_t kRecvSlots = 16;
+static const uint32_t kSendSlots = 64;
+static const uint32_t kRingDepth = 256;
+
+#ifdef OWT_HAS_IOURING
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nrArgs)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+// user_data layout: operation kind in the high word, slot index in the low.
+static const uint64_t kOpRecv = 1;
+static const uint64_t kOpSend = 2;
+static const uint64_t kOpWakeup = 3;
+
+UringTransport::UringTransport(RawTransportListener* listener)
+    : m_isClosing(false)
+    , m_socketFd(-1)
+    , m_ringFd(-1)
+    , m_listener(listener)
+    , m_sqRing(nullptr)
+    , m_sqRingSize(0)
+    , m_cqRing(nullptr)
+    , m_cqRingSize(0)
+    , m_sqes(nullptr)
+    , m_sqesSize(0)
+    , m_sqHead(nullptr)
+    , m_sqTail(nullptr)
+    , m_sqMask(nullptr)
+    , m_sqArray(nullptr)
+    , m_cqHead(nullptr)
+    , m_cqTail(nullptr)
+    , m_cqMask(nullptr)
+    , m_cqes(nullptr)
+    , m_buffers(nullptr)
+{
+}
+
+UringTransport::~UringTransport()
+{
+    close();
+}
+
+bool UringTransport::enabled()
+{
+    static int cached = -1;
+    if (cached >= 0)
+        return cached;
+
+    const char* env = getenv("OWT_UDP_IOURING");
+    if (!env || env[0] != '1') {
+        cached = 0;
+        return false;
+    }
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = ioUringSetup(4, &p);
+    if (fd < 0) {
+        ELOG_WARN("OWT_UDP_IOURING set but the kernel rejected io_uring_setup: %s", strerror(errno));
+        cached = 0;
+        return false;
+    }
+    ::close(fd);
+    cached = 1;
+    return true;
+}
+
+char* UringTransport::slotAt(uint32_t index)
+{
+    return m_buffers + (size_t)index * kSlotSize;
+}
+
+bool UringTransport::openSocket(uint32_t minPort, uint32_t maxPort)
+{
+    m_socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socketFd < 0)
+        return false;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (minPort == 0) {
+        addr.sin_port = 0;
+        return bind(m_socketFd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+
+    for (uint32_t port = minPort; port <= maxPort; ++port) {
+        addr.sin_port = htons(port);
+        if (bind(m_socketFd, (struct sockaddr*)&addr, sizeof(addr)) == 0)
+            return true;
+    }
+    ELOG_WARN("no free port in [%u, %u]", minPort, maxPort);
+    return false;
+}
+
+bool UringTransport::setupRing()
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    m_ringFd = ioUringSetup(kRingDepth, &p);
+    if (m_ringFd < 0) {
+        ELOG_ERROR("io_uring_setup failed: %s", strerror(errno));
+        return false;
+    }
+
+    m_sqRingSize = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    m_cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+    m_sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (m_sqRing == MAP_FAILED || m_cqRing == MAP_FAILED || m_sqes == MAP_FAILED) {
+        ELOG_ERROR("io_uring ring mmap failed: %s", strerror(errno));
+        return false;
+    }
+
+    char* sq = reinterpret_cast<char*>(m_sqRing);
+    m_sqHead = reinterpret_cast<uint32_t*>(sq + p.sq_off.head);
+    m_sqTail = reinterpret_cast<uint32_t*>(sq + p.sq_off.tail);
+    m_sqMask = reinterpret_cast<uint32_t*>(sq + p.sq_off.ring_mask);
+    m_sqArray = reinterpret_cast<uint32_t*>(sq + p.sq_off.array);
+
+    char* cq = reinterpret_cast<char*>(m_cqRing);
+    m_cqHead = reinterpret_cast<uint32_t*>(cq + p.cq_off.head);
+    m_cqTail = reinterpret_cast<uint32_t*>(cq + p.cq_off.tail);
+    m_cqMask = reinterpret_cast<uint32_t*>(cq + p.cq_off.ring_mask);
+    m_cqes = cq + p.cq_off.cqes;
+
+    // Register every buffer once; READ_FIXED/WRITE_FIXED then skip the
+    // per-call pin/unpin of user memory.
+    m_buffers = reinterpret_cast<char*>(mmap(nullptr, (size_t)(kRecvSlots + kSendSlots) * kSlotSize,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0));
+    if (m_buffers == MAP_FAILED) {
+        m_buffers = nullptr;
+        return false;
+    }
+    std::vector<struct iovec> iovs(kRecvSlots + kSendSlots);
+    for (uint32_t i = 0; i < kRecvSlots + kSendSlots; ++i) {
+        iovs[i].iov_base = slotAt(i);
+        iovs[i].iov_len = kSlotSize;
+    }
+    if (ioUringRegister(m_ringFd, IORING_REGISTER_BUFFERS, iovs.data(), iovs.size()) < 0) {
+        ELOG_ERROR("IORING_REGISTER_BUFFERS failed: %s", strerror(errno));
+        return false;
+    }
+
+    for (uint32_t i = 0; i < kSendSlots; ++i)
+        m_freeSendSlots.push_back(kRecvSlots + i);
+    return true;
+}
+
+// Appends one SQE under m_sqMutex. The caller batches the matching
+// submitLocked() so several queued sends go down in one syscall.
+static void prepareSqe(struct io_uring_sqe* sqe, uint8_t opcode, int fd, void* addr, uint32_t len, uint16_t bufIndex, uint64_t userData)
+{
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(addr);
+    sqe->len = len;
+    sqe->buf_index = bufIndex;
+    sqe->user_data = userData;
+}
+
+void UringTransport::queueReceive(uint32_t index)
+{
+    uint32_t tail = *m_sqTail;
+    uint32_t slot = tail & *m_sqMask;
+    struct io_uring_sqe* sqe = reinterpret_cast<struct io_uring_sqe*>(m_sqes) + slot;
+    prepareSqe(sqe, IORING_OP_READ_FIXED, m_socketFd, slotAt(index), kSlotSize, index, (kOpRecv << 32) | index);
+    m_sqArray[slot] = slot;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void UringTransport::queueSend(uint32_t index, uint32_t length)
+{
+    uint32_t tail = *m_sqTail;
+    uint32_t slot = tail & *m_sqMask;
+    struct io_uring_sqe* sqe = reinterpret_cast<struct io_uring_sqe*>(m_sqes) + slot;
+    prepareSqe(sqe, IORING_OP_WRITE_FIXED, m_socketFd, slotAt(index), length, index, (kOpSend << 32) | index);
+    m_sqArray[slot] = slot;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void UringTransport::submitLocked(uint32_t count)
+{
+    if (ioUringEnter(m_ringFd, count, 0, 0) < 0)
+        ELOG_WARN("io_uring_enter failed: %s", strerror(errno));
+}
+
+void UringTransport::createConnection(const std::string& ip, uint32_t port)
+{
+    if (!openSocket(0, 0) || !setupRing()) {
+        m_listener->onTransportError();
+        return;
+    }
+
+    struct sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(port);
+    inet_pton(AF_INET, ip.c_str(), &remote.sin_addr);
+    if (connect(m_socketFd, (struct sockaddr*)&remote, sizeof(remote)) < 0) {
+        ELOG_ERROR("connect to %s:%u failed: %s", ip.c_str(), port, strerror(errno));
+        m_listener->onTransportError();
+        return;
+    }
+
+    startLoop(false);
+    m_listener->onTransportConnected();
+}
+
+void UringTransport::listenTo(uint32_t port)
+{
+    listenTo(port, port == 0 ? 0 : port);
+}
+
+void UringTransport::listenTo(uint32_t minPort, uint32_t maxPort)
+{
+    if (!openSocket(minPort, maxPort) || !setupRing()) {
+        m_listener->onTransportError();
+        return;
+    }
+    // The peer is learned from its first datagram, like RawTransport<UDP>.
+    startLoop(true);
+}
+
+void UringTransport::startLoop(bool awaitPeer)
+{
+    m_loopThread = boost::thread([this, awaitPeer]() {
+        ThreadAffinity::applyRole("transport");
+        loop(awaitPeer);
+    });
+}
+
+bool UringTransport::awaitFirstPeer()
+{
+    struct pollfd pfd = { m_socketFd, POLLIN, 0 };
+    while (!m_isClosing) {
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        struct sockaddr_in peer;
+        socklen_t peerLen = sizeof(peer);
+        char probe;
+        if (recvfrom(m_socketFd, &probe, 1, MSG_PEEK, (struct sockaddr*)&peer, &peerLen) < 0)
+            continue;
+        if (connect(m_socketFd, (struct sockaddr*)&peer, peerLen) < 0) {
+            ELOG_ERROR("connect to first peer failed: %s", strerror(errno));
+            return false;
+        }
+        m_listener->onTransportConnected();
+        return true;
+    }
+    return false;
+}
+
+void UringTransport::loop(bool awaitPeer)
+{
+    if (awaitPeer && !awaitFirstPeer())
+        return;
+
+    {
+        boost::mutex::scoped_lock lock(m_sqMutex);
+        for (uint32_t i = 0; i < kRecvSlots; ++i)
+            queueReceive(i);
+        submitLocked(kRecvSlots);
+    }
+
+    while (!m_isClosing) {
+        if (ioUringEnter(m_ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+            if (errno == EINTR)
+                continue;
+            ELOG_WARN("io_uring_enter(GETEVENTS) failed: %s", strerror(errno));
+            break;
+        }
+        processCompletions();
+    }
+}
+
+void UringTransport::processCompletions()
+{
+    uint32_t head = *m_cqHead;
+    uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        struct io_uring_cqe* cqe = reinterpret_cast<struct io_uring_cqe*>(m_cqes) + (head & *m_cqMask);
+        uint64_t kind = cqe->user_data >> 32;
+        uint32_t index = cqe->user_data & 0xffffffff;
+        int32_t res = cqe->res;
+        ++head;
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+        if (kind == kOpRecv) {
+            if (res > 4 && !m_isClosing) {
+                char* buf = slotAt(index);
+                uint32_t payloadlen = ntohl(*(reinterpret_cast<uint32_t*>(buf)));
+                if (payloadlen + 4 == (uint32_t)res) {
+                    m_stats.receivedMessages.fetch_add(1, std::memory_order_relaxed);
+                    m_stats.receivedBytes.fetch_add(payloadlen, std::memory_order_relaxed);
+                    m_listener->onTransportData(buf + 4, payloadlen);
+                }
+                else
+                    ELOG_DEBUG("length mismatch in datagram: prefix %u, received %d", payloadlen, res);
+            } else if (res < 0 && res != -EAGAIN && res != -EINTR && !m_isClosing) {
+                ELOG_DEBUG("receive completion error %d", res);
+            }
+            if (!m_isClosing) {
+                boost::mutex::scoped_lock lock(m_sqMutex);
+                queueReceive(index);
+                submitLocked(1);
+            }
+        } else if (kind == kOpSend) {
+            if (res < 0 && !m_isClosing) {
+                ELOG_DEBUG("send completion error %d", res);
+                m_stats.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+            } else if (res > 0) {
+                m_stats.sentMessages.fetch_add(1, std::memory_order_relaxed);
+                m_stats.sentBytes.fetch_add(res, std::memory_order_relaxed);
+            }
+            boost::mutex::scoped_lock lock(m_sqMutex);
+            m_freeSendSlots.push_back(index);
+            m_stats.queuedMessages.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+    }
+}
+
+void UringTransport::sendData(const char* data, int len)
+{
+    sendData(data, len, nullptr, 0);
+}
+
+void UringTransport::sendData(const char* header, int headerLength, const char* payload, int payloadLength)
+{
+    uint32_t total = headerLength + payloadLength;
+    if (total + 4 > kSlotSize) {
+        ELOG_WARN("datagram too large (%u bytes), dropped", total);
+        return;
+    }
+    if (m_isClosing)
+        return;
+
+    boost::mutex::scoped_lock lock(m_sqMutex);
+    if (m_freeSendSlots.empty()) {
+        // All slots in flight: the link is saturated; drop like a full
+        // socket buffer would.
+        ELOG_DEBUG("no free send slot, datagram dropped");
+        m_stats.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t index = m_freeSendSlots.back();
+    m_freeSendSlots.pop_back();
+
+    char* slot = slotAt(index);
+    *(reinterpret_cast<uint32_t*>(slot)) = htonl(total);
+    memcpy(slot + 4, header, headerLength);
+    if (payloadLength > 0)
+        memcpy(slot + 4 + headerLength, payload, payloadLength);
+    m_stats.queuedMessages.fetch_add(1, std::memory_order_relaxed);
+    queueSend(index, total + 4);
+    submitLocked(1);
+}
+
+void UringTransport::sendFrame(const char* header, int headerLength, const Frame& frame)
+{
+    // The payload is copied into the registered slot either way, so the
+    // zero-copy queueing of RawTransport::sendFrame has no equivalent here.
+    sendData(header, headerLength, reinterpret_cast<const char*>(frame.payload), frame.length);
+}
+
+void UringTransport::close()
+{
+    if (m_isClosing.exchange(true))
+        return;
+
+    if (m_ringFd >= 0 && m_loopThread.joinable()) {
+        // A NOP completion wakes the loop out of GETEVENTS.
+        boost::mutex::scoped_lock lock(m_sqMutex);
+        uint32_t tail = *m_sqTail;
+        uint32_t slot = tail & *m_sqMask;
+        struct io_uring_sqe* sqe = reinterpret_cast<struct io_uring_sqe*>(m_sqes) + slot;
+        prepareSqe(sqe, IORING_OP_NOP, -1, nullptr, 0, 0, kOpWakeup << 32);
+        m_sqArray[slot] = slot;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        submitLocked(1);
+    }
+    if (m_loopThread.joinable())
+        m_loopThread.join();
+
+    if (m_sqes)
+        munmap(m_sqes, m_sqesSize);
+    if (m_sqRing)
+        munmap(m_sqRing, m_sqRingSize);
+    if (m_cqRing && m_cqRing != m_sqRing)
+        munmap(m_cqRing, m_cqRingSize);
+    m_sqes = m_sqRing = m_cqRing = nullptr;
+    if (m_buffers) {
+        munmap(m_buffers, (size_t)(kRecvSlots + kSendSlots) * kSlotSize);
+        m_buffers = nullptr;
+    }
+    if (m_ringFd >= 0) {
+        ::close(m_ringFd);
+        m_ringFd = -1;
+    }
+    if (m_socketFd >= 0) {
+        ::close(m_socketFd);
+        m_socketFd = -1;
+    }
+}
+
+unsigned short UringTransport::getListeningPort()
+{
+    if (m_socketFd < 0)
+        return 0;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(m_socketFd, (struct sockaddr*)&addr, &len) < 0)
+        return 0;
+    return ntohs(addr.sin_port);
+}
+
+#else /* !OWT_HAS_IOURING */
+
+UringTransport::UringTransport(RawTransportListener* listener)
+    : m_isClosing(false)
+    , m_socketFd(-1)
+    , m_ringFd(-1)
+    , m_listener(listener)
+    , m_sqRing(nullptr)
+    , m_sqRingSize(0)
+    , m_cqRing(nullptr)
+    , m_cqRingSize(0)
+    , m_sqes(nullptr)
+    , m_sqesSize(0)
+    , m_sqHead(nullptr)
+    , m_sqTail(nullptr)
+    , m_sqMask(nullptr)
+    , m_sqArray(nullptr)
+    , m_cqHead(nullptr)
+    , m_cqTail(nullptr)
+    , m_cqMask(nullptr)
+    , m_cqes(nullptr)
+    , m_buffers(nullptr)
+{
+}
+
+UringTransport::~UringTransport() { }
+
+bool UringTransport::enabled() { return false; }
+
+void UringTransport::createConnection(const std::string&, uint32_t) { m_listener->onTransportError(); }
+void UringTransport::listenTo(uint32_t) { m_listener->onTransportError(); }
+void UringTransport::listenTo(uint32_t, uint32_t) { m_listener->onTransportError(); }
+void UringTransport::sendData(const char*, int) { }
+void UringTransport::sendData(const char*, int, const char*, int) { }
+void UringTransport::sendFrame(const char*, int, const Frame&) { }
+void UringTransport::close() { }
+unsigned short UringTransport::getListeningPort() { return 0; }
+
+#endif /* OWT_HAS_IOURING */
+
+} /* namespace owt_base */
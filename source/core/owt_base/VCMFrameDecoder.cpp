@@ -3,8 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "VCMFrameDecoder.h"
-
-#include <boost/shared_array.hpp>
+#include "PayloadBuffer.h"
 
 #include <webrtc/modules/video_coding/codecs/h264/include/h264.h>
 #include <webrtc/modules/video_coding/codecs/vp8/include/vp8.h>
@@ -25,6 +24,7 @@ DEFINE_LOGGER(VCMFrameDecoder, "owt.VCMFrameDecoder");
 VCMFrameDecoder::VCMFrameDecoder(FrameFormat format)
     : m_needDecode(false)
     , m_needKeyFrame(true)
+    , m_lastIngestMs(0)
 {
     memset(&m_codecInfo, 0, sizeof(m_codecInfo));
 }
@@ -95,6 +95,7 @@ int32_t VCMFrameDecoder::Decoded(VideoFrame& decodedImage)
     frame.timeStamp = decodedImage.timestamp();
     frame.additionalInfo.video.width = decodedImage.width();
     frame.additionalInfo.video.height = decodedImage.height();
+    frame.ingestTimeMs = m_lastIngestMs;
 
     ELOG_TRACE_T("deliverFrame, %dx%d",
             frame.additionalInfo.video.width,
@@ -138,24 +139,25 @@ void VCMFrameDecoder::onFrame(const Frame& frame)
     size_t length       = frame.length;
     size_t padding      = EncodedImage::GetBufferPaddingBytes(m_codecInfo.codecType);
     size_t size         = length + padding;
-    boost::shared_array<uint8_t> buffer;
+    PayloadBuffer *buffer = NULL;
 
     if (padding > 0) {
-        buffer.reset(new uint8_t[size]);
-        if (buffer.get()) {
-            memcpy(buffer.get(), frame.payload, length);
-            memset(buffer.get() + length, 0, padding);
-        } else {
-            return;
-        }
+        // Pool-backed: H264 pads every frame and this copy used to heap
+        // allocate once per decoded frame.
+        buffer = PayloadBuffer::create(size);
+        memcpy(buffer->data(), frame.payload, length);
+        memset(buffer->data() + length, 0, padding);
     }
 
-    payload = buffer.get() ? buffer.get() : frame.payload;
+    payload = buffer ? buffer->data() : frame.payload;
+    m_lastIngestMs = frame.ingestTimeMs;
     EncodedImage image(payload, length, size);
     image._frameType = frame.additionalInfo.video.isKeyFrame ? kVideoFrameKey : kVideoFrameDelta;
     image._completeFrame = true;
     image._timeStamp = frame.timeStamp;
     int ret = m_decoder->Decode(image, false, nullptr, &m_codecInfo);
+    if (buffer)
+        buffer->release();
     if (ret != 0) {
         ELOG_ERROR_T("Decode frame error: %d", ret);
 
@@ -36,6 +36,10 @@ public:
 private:
     bool m_needDecode;
     bool m_needKeyFrame;
+    // Ingest stamp of the frame most recently handed to Decode(); Decoded()
+    // copies it onto the raw output. A decoder that pipelines may attribute
+    // an output to its neighbour's stamp, which is within a frame interval.
+    int64_t m_lastIngestMs;
     webrtc::CodecSpecificInfo m_codecInfo;
     boost::scoped_ptr<webrtc::VideoDecoder> m_decoder;
 };
@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <time.h>
+
 #include <boost/make_shared.hpp>
 
 #include <webrtc/system_wrappers/include/cpu_info.h>
@@ -9,12 +11,19 @@
 
 #include "VCMFrameEncoder.h"
 
+#include "EncodeThreadPool.h"
+#include "HostLoadGovernor.h"
 #include "MediaUtilities.h"
+#include "PipelineTracer.h"
 
 #ifdef ENABLE_MSDK
 #include "MsdkFrame.h"
 #endif
 
+#ifdef ENABLE_X264_ENCODER
+#include "X264VideoEncoder.h"
+#endif
+
 using namespace webrtc;
 
 namespace owt_base {
@@ -25,30 +34,35 @@ VCMFrameEncoder::VCMFrameEncoder(FrameFormat format, VideoCodecProfile profile,
     : m_streamId(0)
     , m_encodeFormat(format)
     , m_profile(profile)
+    , m_useSimulcast(useSimulcast)
+    , m_x264Encoder(NULL)
+    , m_strand(EncodeThreadPool::instance().service())
     , m_requestKeyFrame(false)
     , m_updateBitrateKbps(0)
+    , m_lastIngestMs(0)
     , m_isAdaptiveMode(false)
     , m_width(0)
     , m_height(0)
     , m_frameRate(0)
     , m_bitrateKbps(0)
+    , m_keyFrameIntervalSeconds(0)
+    , m_decimationFactor(1)
+    , m_decimationCount(0)
+    , m_screenContentMode(false)
+    , m_lastEncodeMs(0)
     , m_enableBsDump(false)
     , m_bsDumpfp(NULL)
 {
+    memset(&m_codecSettings, 0, sizeof(m_codecSettings));
+
     m_bufferManager.reset(new I420BufferManager(3));
     m_converter.reset(new FrameConverter());
-
-    m_srv       = boost::make_shared<boost::asio::io_service>();
-    m_srvWork   = boost::make_shared<boost::asio::io_service::work>(*m_srv);
-    m_thread    = boost::make_shared<boost::thread>(boost::bind(&boost::asio::io_service::run, m_srv));
 }
 
 VCMFrameEncoder::~VCMFrameEncoder()
 {
-    m_srvWork.reset();
-    m_srv->stop();
-    m_thread.reset();
-    m_srv.reset();
+    // Let jobs already queued for this encoder finish before tearing down.
+    EncodeThreadPool::instance().drain(m_strand);
 
     m_streamId = 0;
 
@@ -64,15 +78,30 @@ VCMFrameEncoder::~VCMFrameEncoder()
 
 bool VCMFrameEncoder::canSimulcast(FrameFormat format, uint32_t width, uint32_t height)
 {
-#if 0
-    VideoCodec videoCodec;
-    videoCodec = m_vcm->GetSendCodec();
-    return false
-           &&webrtc::VP8EncoderFactoryConfig::use_simulcast_adapter()
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    return m_useSimulcast
+           && m_encodeFormat == FRAME_FORMAT_VP8
            && m_encodeFormat == format
-           && videoCodec.width * height == videoCodec.height * width;
-#endif
-    return false;
+           && m_encoder
+           && !m_streams.empty()
+           && !m_isAdaptiveMode
+           && m_codecSettings.numberOfSimulcastStreams < kMaxSimulcastStreams
+           && m_width * (int32_t)height == m_height * (int32_t)width;
+}
+
+bool VCMFrameEncoder::canShareStream(FrameFormat format, VideoCodecProfile profile, uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    return m_encoder
+           && !m_streams.empty()
+           && !m_isAdaptiveMode
+           && m_encodeFormat == format
+           && m_profile == profile
+           && m_width == (int32_t)width
+           && m_height == (int32_t)height
+           && m_frameRate == frameRate
+           && m_bitrateKbps == bitrateKbps
+           && m_keyFrameIntervalSeconds == keyFrameIntervalSeconds;
 }
 
 bool VCMFrameEncoder::isIdle()
@@ -91,6 +120,121 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
     int ret;
 
     assert(frameRate != 0);
+
+    // An encoder already running with exactly these settings serves the new
+    // subscriber directly: OnEncodedImage fans each encoded image out to
+    // every registered stream, so identical ladder rungs cost one encode
+    // instead of one per subscriber.
+    if (m_encoder && !m_streams.empty() && !m_isAdaptiveMode && !m_useSimulcast
+        && m_width == (int32_t)width && m_height == (int32_t)height
+        && m_frameRate == frameRate && m_bitrateKbps == bitrateKbps
+        && m_keyFrameIntervalSeconds == keyFrameIntervalSeconds) {
+        boost::shared_ptr<EncodeOut> encodeOut;
+        encodeOut.reset(new EncodeOut(m_streamId, this, dest));
+        OutStream stream = {.width = width, .height = height, .simulcastId = 0, .encodeOut = encodeOut};
+        boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+        m_streams[m_streamId] = stream;
+        // The new subscriber joins mid-GOP and can't decode until the next
+        // key frame.
+        m_requestKeyFrame = true;
+        ELOG_DEBUG_T("generateStream: sharing encoder, {.width=%d, .height=%d, .frameRate=%d, .bitrateKbps=%d}"
+                , width, height, frameRate, bitrateKbps);
+        return m_streamId++;
+    }
+
+    // Single-pass simulcast: with simulcast enabled, a request matching the
+    // running VP8 encoder's aspect ratio becomes another layer of the same
+    // encode instead of a second encoder.
+    if (m_useSimulcast && m_encoder && !m_streams.empty() && !m_isAdaptiveMode
+        && m_encodeFormat == FRAME_FORMAT_VP8
+        && m_width * (int32_t)height == m_height * (int32_t)width) {
+        // A layer at this resolution already exists: attach to it.
+        for (uint8_t i = 0; i < m_codecSettings.numberOfSimulcastStreams; ++i) {
+            if (m_codecSettings.simulcastStream[i].width == width) {
+                boost::shared_ptr<EncodeOut> encodeOut;
+                encodeOut.reset(new EncodeOut(m_streamId, this, dest));
+                OutStream stream = {.width = width, .height = height, .simulcastId = i, .encodeOut = encodeOut};
+                boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+                m_streams[m_streamId] = stream;
+                m_requestKeyFrame = true;
+                ELOG_DEBUG_T("generateStream: attach to simulcast layer %d, {.width=%d, .height=%d}", i, width, height);
+                return m_streamId++;
+            }
+        }
+
+        if (m_codecSettings.numberOfSimulcastStreams < kMaxSimulcastStreams) {
+            VideoCodec newSettings = m_codecSettings;
+
+            // Layers are kept in ascending width order as libvpx requires.
+            uint8_t pos = 0;
+            for (; pos < newSettings.numberOfSimulcastStreams; ++pos) {
+                if (newSettings.simulcastStream[pos].width > width)
+                    break;
+            }
+            for (uint8_t j = newSettings.numberOfSimulcastStreams; j > pos; --j)
+                newSettings.simulcastStream[j] = newSettings.simulcastStream[j - 1];
+
+            newSettings.simulcastStream[pos] = SimulcastStream{
+                .width = static_cast<short unsigned>(width),
+                .height = static_cast<short unsigned>(height),
+                .numberOfTemporalLayers = 0,
+                .maxBitrate = targetKbps,
+                .targetBitrate = targetKbps,
+                .minBitrate = targetKbps / 4,
+                .qpMax = newSettings.qpMax
+            };
+            ++newSettings.numberOfSimulcastStreams;
+
+            if ((int32_t)width > m_width) {
+                newSettings.width = width;
+                newSettings.height = height;
+            }
+
+            uint32_t newTargetBitrate = 0, newMaxBitrate = 0, newMinBitrate = 0;
+            for (uint8_t i = 0; i < newSettings.numberOfSimulcastStreams; ++i) {
+                newTargetBitrate += newSettings.simulcastStream[i].targetBitrate;
+                newMaxBitrate += newSettings.simulcastStream[i].maxBitrate;
+                newMinBitrate += newSettings.simulcastStream[i].minBitrate;
+            }
+            newSettings.startBitrate = newTargetBitrate;
+            newSettings.targetBitrate = newTargetBitrate;
+            newSettings.maxBitrate = newMaxBitrate;
+            newSettings.minBitrate = newMinBitrate;
+
+            // Reinitializing tears down the running libvpx instance while
+            // encode() holds a shared lock across Encode(); upgrading first
+            // waits out any in-flight encode before the teardown.
+            boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+            m_encoder->Release();
+            ret = m_encoder->InitEncode(&newSettings, webrtc::CpuInfo::DetectNumberOfCores(), 0);
+            if (ret) {
+                ELOG_ERROR_T("Add simulcast layer failed: %d, restoring previous configuration", ret);
+                m_encoder->InitEncode(&m_codecSettings, webrtc::CpuInfo::DetectNumberOfCores(), 0);
+                m_encoder->RegisterEncodeCompleteCallback(this);
+                return -1;
+            }
+            m_encoder->RegisterEncodeCompleteCallback(this);
+
+            m_codecSettings = newSettings;
+            for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+                if (it->second.simulcastId >= pos)
+                    it->second.simulcastId++;
+            }
+            if ((int32_t)width > m_width) {
+                m_width = width;
+                m_height = height;
+            }
+
+            boost::shared_ptr<EncodeOut> encodeOut;
+            encodeOut.reset(new EncodeOut(m_streamId, this, dest));
+            OutStream stream = {.width = width, .height = height, .simulcastId = pos, .encodeOut = encodeOut};
+            m_streams[m_streamId] = stream;
+            m_requestKeyFrame = true;
+            ELOG_DEBUG_T("generateStream: new simulcast layer %d, {.width=%d, .height=%d, .bitrateKbps=%d}", pos, width, height, targetKbps);
+            return m_streamId++;
+        }
+    }
+
     if (width == 0 || height == 0) {
         m_isAdaptiveMode = true;
         width = 3840;
@@ -150,11 +294,22 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
             codecSettings.VP9()->keyFrameInterval = frameRate * keyFrameIntervalSeconds;
             break;
         case FRAME_FORMAT_H264:
-            if (m_profile != PROFILE_AVC_CONSTRAINED_BASELINE) {
-                ELOG_WARN_T("Only support profile (Constrained Baseline), required (%d)", m_profile);
-            }
+#ifdef ENABLE_X264_ENCODER
+            // x264 yields notably better quality-per-cycle than the OpenH264
+            // wrapper at our operating points; GPL-accepting builds compile
+            // it in and OWT_H264_X264=1 switches new streams over.
+            if (X264VideoEncoder::enabled()) {
+                m_x264Encoder = new X264VideoEncoder(m_profile);
+                m_encoder.reset(m_x264Encoder);
+            } else
+#endif
+            {
+                if (m_profile != PROFILE_AVC_CONSTRAINED_BASELINE) {
+                    ELOG_WARN_T("Only support profile (Constrained Baseline), required (%d)", m_profile);
+                }
 
-            m_encoder.reset(H264Encoder::Create(cricket::VideoCodec(cricket::kH264CodecName)));
+                m_encoder.reset(H264Encoder::Create(cricket::VideoCodec(cricket::kH264CodecName)));
+            }
 
             VCMCodecDataBase::Codec(kVideoCodecH264, &codecSettings);
             codecSettings.H264()->frameDroppingOn = true;
@@ -174,6 +329,21 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
     codecSettings.width         = width;
     codecSettings.height        = height;
 
+    if (m_useSimulcast && m_encodeFormat == FRAME_FORMAT_VP8) {
+        // Seed the simulcast configuration with this first layer; later
+        // matching requests extend the array above.
+        codecSettings.numberOfSimulcastStreams = 1;
+        codecSettings.simulcastStream[0] = SimulcastStream{
+            .width = static_cast<short unsigned>(width),
+            .height = static_cast<short unsigned>(height),
+            .numberOfTemporalLayers = 0,
+            .maxBitrate = targetKbps,
+            .targetBitrate = targetKbps,
+            .minBitrate = targetKbps / 4,
+            .qpMax = codecSettings.qpMax
+        };
+    }
+
     ret = m_encoder->InitEncode(&codecSettings, webrtc::CpuInfo::DetectNumberOfCores(), 0);
     if (ret) {
         ELOG_ERROR_T("Video encoder init faild.\n");
@@ -181,6 +351,7 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
     }
 
     m_encoder->RegisterEncodeCompleteCallback(this);
+    m_codecSettings = codecSettings;
 
 #if 0
     for (; simulcastId < videoCodec.numberOfSimulcastStreams; ++simulcastId) {
@@ -251,6 +422,7 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
     m_height = height;
     m_frameRate = frameRate;
     m_bitrateKbps = bitrateKbps;
+    m_keyFrameIntervalSeconds = keyFrameIntervalSeconds;
 
     if (m_enableBsDump) {
         char dumpFileName[128];
@@ -304,6 +476,21 @@ void VCMFrameEncoder::requestKeyFrame(int32_t streamId)
     }
 }
 
+void VCMFrameEncoder::setRoiRegions(const std::vector<RoiRegion>& regions, uint32_t width, uint32_t height)
+{
+#ifdef ENABLE_X264_ENCODER
+    // Of the wrappers here only the x264 backend has a region-QP mechanism
+    // (per-MB quant offsets); the M59 VP8/VP9/OpenH264 wrappers expose none,
+    // so hints are dropped on those paths.
+    if (m_x264Encoder) {
+        m_x264Encoder->SetRoiRegions(regions, width, height);
+        return;
+    }
+#endif
+    ELOG_TRACE_T("Drop ROI hints(%ld), no region-QP support in %s encoder",
+            regions.size(), getFormatStr(m_encodeFormat));
+}
+
 void VCMFrameEncoder::onFrame(const Frame& frame)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
@@ -317,7 +504,8 @@ void VCMFrameEncoder::onFrame(const Frame& frame)
         return;
     }
 
-    m_srv->post(boost::bind(&VCMFrameEncoder::Encode, this, videoFrame));
+    m_lastIngestMs.store(frame.ingestTimeMs, std::memory_order_relaxed);
+    m_strand.post(boost::bind(&VCMFrameEncoder::Encode, this, videoFrame));
 }
 
 boost::shared_ptr<webrtc::VideoFrame> VCMFrameEncoder::frameConvert(const Frame& frame)
@@ -396,6 +584,12 @@ void VCMFrameEncoder::encode(boost::shared_ptr<webrtc::VideoFrame> frame)
         m_updateBitrateKbps = calcBitrate(m_width, m_height, m_frameRate);
     }
 
+    if (m_updateBitrateKbps && m_codecSettings.numberOfSimulcastStreams > 1) {
+        // Layered encodes keep their per-layer configured rates; a single
+        // subscriber's feedback must not retune all layers.
+        m_updateBitrateKbps = 0;
+    }
+
     if (m_updateBitrateKbps) {
         ELOG_DEBUG_T("Update encoder bitrate %d(kbps)->%d(kbps)", m_bitrateKbps, m_updateBitrateKbps.load());
 
@@ -412,16 +606,110 @@ void VCMFrameEncoder::encode(boost::shared_ptr<webrtc::VideoFrame> frame)
         m_updateBitrateKbps = 0;
     }
 
+    if (ContentClassifier::enabled() && m_codecSettings.numberOfSimulcastStreams <= 1) {
+        m_classifier.analyze(frame->video_frame_buffer().get());
+        updateContentMode();
+
+        // Screen shares are static most of the time; unchanged frames are
+        // not worth the cycles or the bits. One encode per second stays as
+        // a heartbeat for the rate controller and late joiners.
+        if (m_screenContentMode && m_classifier.lastFrameStatic() && !m_requestKeyFrame) {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            int64_t nowMs = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+            if (nowMs - m_lastEncodeMs < 1000)
+                return;
+        }
+    }
+
+    // An overloaded node encodes every Nth frame instead of dropping the
+    // stream; key frame requests always go through.
+    if (m_decimationFactor > 1 && !m_requestKeyFrame
+        && (m_decimationCount++ % m_decimationFactor) != 0) {
+        return;
+    }
+
     std::vector<FrameType> types;
     if (m_requestKeyFrame) {
         types.push_back(kVideoFrameKey);
         m_requestKeyFrame = false;
     }
 
-    ret = m_encoder->Encode(*frame.get(), NULL, types.size() ? &types : NULL);
+    timespec encodeStart, encodeEnd;
+    clock_gettime(CLOCK_MONOTONIC, &encodeStart);
+
+    {
+        PipelineTracer::Span span("video", "vcm_encode", frame->timestamp());
+        ret = m_encoder->Encode(*frame.get(), NULL, types.size() ? &types : NULL);
+    }
     if (ret != 0) {
         ELOG_ERROR_T("Encode frame error: %d", ret);
+    } else {
+        m_lastEncodeMs = encodeStart.tv_sec * 1000 + encodeStart.tv_nsec / 1000000;
     }
+
+    if (EncoderLoadGovernor::enabled()) {
+        clock_gettime(CLOCK_MONOTONIC, &encodeEnd);
+        int64_t encodeTimeUs = (encodeEnd.tv_sec - encodeStart.tv_sec) * 1000000
+            + (encodeEnd.tv_nsec - encodeStart.tv_nsec) / 1000;
+
+        // An encode that overran its interval also counts toward host-wide
+        // pressure, so other agents on this machine shed with us.
+        if (HostLoadGovernor::enabled()
+            && encodeTimeUs * (m_frameRate / m_decimationFactor) > 1000000)
+            HostLoadGovernor::instance().reportOverrun();
+
+        // Skipped frames leave the budget untouched, so measure against the
+        // effective encode rate.
+        switch (m_loadGovernor.onEncodedFrame(encodeTimeUs, m_frameRate / m_decimationFactor)) {
+        case EncoderLoadGovernor::ADAPT_FASTER:
+            if (m_decimationFactor < 4) {
+                m_decimationFactor++;
+                ELOG_INFO_T("Overloaded, encode every %d frames", m_decimationFactor);
+            }
+            break;
+        case EncoderLoadGovernor::ADAPT_SLOWER:
+            if (m_decimationFactor > 1) {
+                m_decimationFactor--;
+                ELOG_INFO_T("Load recovered, encode every %d frames", m_decimationFactor);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void VCMFrameEncoder::updateContentMode()
+{
+    bool screen = m_classifier.isScreenContent();
+    if (screen == m_screenContentMode || !m_encoder)
+        return;
+
+    VideoCodec settings = m_codecSettings;
+    settings.mode = screen ? kScreensharing : kRealtimeVideo;
+
+    // Screen-content rate control trades frame rate for QP stability:
+    // libvpx holds quality through detail bursts (scrolls, page flips)
+    // instead of blurring text to hit the per-frame budget. H264 has no
+    // such mode in this wrapper; those streams still benefit from the
+    // static-frame dropping.
+    ELOG_INFO_T("Switching to %s mode", screen ? "screen-content" : "realtime-video");
+
+    m_encoder->Release();
+    int ret = m_encoder->InitEncode(&settings, webrtc::CpuInfo::DetectNumberOfCores(), 0);
+    if (ret) {
+        ELOG_WARN_T("Mode switch re-init failed: %d, restoring previous configuration", ret);
+        m_encoder->InitEncode(&m_codecSettings, webrtc::CpuInfo::DetectNumberOfCores(), 0);
+        m_encoder->RegisterEncodeCompleteCallback(this);
+        return;
+    }
+    m_encoder->RegisterEncodeCompleteCallback(this);
+
+    m_codecSettings = settings;
+    m_screenContentMode = screen;
+    // Subscribers need a key frame to pick up after the re-init.
+    m_requestKeyFrame = true;
 }
 
 webrtc::EncodedImageCallback::Result VCMFrameEncoder::OnEncodedImage(const EncodedImage& encoded_frame,
@@ -440,6 +728,7 @@ webrtc::EncodedImageCallback::Result VCMFrameEncoder::OnEncodedImage(const Encod
         frame.additionalInfo.video.width = encoded_frame._encodedWidth;
         frame.additionalInfo.video.height = encoded_frame._encodedHeight;
         frame.additionalInfo.video.isKeyFrame = (encoded_frame._frameType == kVideoFrameKey);
+        frame.ingestTimeMs = m_lastIngestMs.load(std::memory_order_relaxed);
 
         ELOG_TRACE_T("SendData, %s, %dx%d, %s, length(%d), timestamp %d",
                 getFormatStr(frame.format),
@@ -452,9 +741,16 @@ webrtc::EncodedImageCallback::Result VCMFrameEncoder::OnEncodedImage(const Encod
 
         dump(frame.payload, frame.length);
 
+        // With simulcast each encoded image belongs to one layer; route it
+        // to the streams attached to that layer. Without simulcast every
+        // image carries index 0, which matches every stream.
+        uint8_t simulcastIdx = 0;
+        if (codec_specific_info && codec_specific_info->codecType == kVideoCodecVP8)
+            simulcastIdx = codec_specific_info->codecSpecific.VP8.simulcastIdx;
+
         auto it = m_streams.begin();
         for (; it != m_streams.end(); ++it) {
-            if (it->second.encodeOut.get() && it->second.simulcastId == 0)
+            if (it->second.encodeOut.get() && it->second.simulcastId == simulcastIdx)
                 it->second.encodeOut->onEncoded(frame);
         }
     }
@@ -20,6 +20,8 @@
 #include <webrtc/modules/video_coding/codecs/i420/include/i420.h>
 
 #include "logger.h"
+#include "ContentClassifier.h"
+#include "EncoderLoadGovernor.h"
 #include "I420BufferManager.h"
 #include "MediaFramePipeline.h"
 #include "FrameConverter.h"
@@ -28,6 +30,8 @@ using namespace webrtc;
 
 namespace owt_base {
 
+class X264VideoEncoder;
+
 class EncodeOut : public FrameSource {
 public:
     EncodeOut(int32_t streamId, owt_base::VideoFrameEncoder* owner, owt_base::FrameDestination* dest)
@@ -84,11 +88,13 @@ public:
     // Implements VideoFrameEncoder.
     void onFrame(const Frame&);
     bool canSimulcast(FrameFormat format, uint32_t width, uint32_t height);
+    bool canShareStream(FrameFormat format, VideoCodecProfile profile, uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds) override;
     bool isIdle();
     int32_t generateStream(uint32_t width, uint32_t height, uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds, FrameDestination* dest);
     void degenerateStream(int32_t streamId);
     void setBitrate(unsigned short kbps, int32_t streamId);
     void requestKeyFrame(int32_t streamId);
+    void setRoiRegions(const std::vector<RoiRegion>& regions, uint32_t width, uint32_t height) override;
 
 protected:
     static void Encode(VCMFrameEncoder *This, boost::shared_ptr<webrtc::VideoFrame> videoFrame) {This->encode(videoFrame);};
@@ -96,6 +102,10 @@ protected:
 
     boost::shared_ptr<webrtc::VideoFrame> frameConvert(const Frame& frame);
 
+    // Re-inits the encoder in screen-content or realtime mode when the
+    // classifier's verdict flips; runs on the encode strand.
+    void updateContentMode();
+
     void dump(uint8_t *buf, int len);
 
 private:
@@ -112,27 +122,54 @@ private:
     FrameFormat m_encodeFormat;
     VideoCodecProfile m_profile;
     boost::scoped_ptr<webrtc::VideoEncoder> m_encoder;
+    // Set when m_encoder is the x264 backend: the only wrapper here with a
+    // region-QP mechanism, so ROI hints are forwarded to it directly.
+    X264VideoEncoder* m_x264Encoder;
     webrtc::TemporalLayersFactory tl_factory_;
+    // Current encoder configuration; with simulcast enabled the layers live
+    // in its simulcastStream array and grow as outputs are added.
+    webrtc::VideoCodec m_codecSettings;
+    bool m_useSimulcast;
 
     boost::scoped_ptr<I420BufferManager> m_bufferManager;
 
     boost::shared_mutex m_mutex;
 
-    boost::shared_ptr<boost::asio::io_service> m_srv;
-    boost::shared_ptr<boost::asio::io_service::work> m_srvWork;
-    boost::shared_ptr<boost::thread> m_thread;
+    // Jobs go through a strand on the shared encode pool: ordered and
+    // non-concurrent per encoder, load-balanced across pool workers.
+    boost::asio::io_service::strand m_strand;
 
     std::atomic<bool> m_requestKeyFrame;
     std::atomic<uint32_t> m_updateBitrateKbps;
+    // Ingest stamp of the raw frame most recently submitted for encode;
+    // OnEncodedImage copies it onto the bitstream frame. The strand keeps
+    // submissions and outputs in order, so at worst a queued frame's output
+    // carries the stamp of the one behind it.
+    std::atomic<int64_t> m_lastIngestMs;
 
     bool m_isAdaptiveMode;
     int32_t m_width;
     int32_t m_height;
     uint32_t m_frameRate;
     uint32_t m_bitrateKbps;
+    uint32_t m_keyFrameIntervalSeconds;
 
     boost::scoped_ptr<FrameConverter> m_converter;
 
+    // Under sustained overload the governor steps the encode rate down by
+    // skipping input frames; the M59 encoder wrappers fix their speed
+    // setting at init, so this is the runtime lever that degrades smoothly.
+    EncoderLoadGovernor m_loadGovernor;
+    uint32_t m_decimationFactor;
+    uint32_t m_decimationCount;
+
+    // Flips detected screen shares into the codec's screen-content mode
+    // and drops static repeat frames, spending neither bits nor cycles on
+    // re-encoding an unchanged desktop at camera frame rates.
+    ContentClassifier m_classifier;
+    bool m_screenContentMode;
+    int64_t m_lastEncodeMs;
+
     bool m_enableBsDump;
     FILE *m_bsDumpfp;
 };
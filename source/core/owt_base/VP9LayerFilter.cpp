@@ -0,0 +1,101 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VP9LayerFilter.h"
+
+namespace owt_base {
+
+DEFINE_LOGGER(VP9LayerFilter, "owt.VP9LayerFilter");
+
+VP9LayerFilter::VP9LayerFilter()
+    : m_targetSpatial(-1)
+    , m_targetTemporal(-1)
+    , m_activeSpatial(-1)
+    , m_activeTemporal(-1)
+    , m_forwardedFrames(0)
+    , m_droppedFrames(0)
+{
+}
+
+VP9LayerFilter::~VP9LayerFilter()
+{
+    if (m_droppedFrames > 0) {
+        ELOG_DEBUG("Forwarded %zu frames, filtered out %zu",
+            (size_t)m_forwardedFrames, (size_t)m_droppedFrames);
+    }
+}
+
+void VP9LayerFilter::setPreferredLayers(int8_t spatialId, int8_t temporalId)
+{
+    bool needKeyFrame = false;
+
+    ELOG_DEBUG("setPreferredLayers spatial %d, temporal %d", spatialId, temporalId);
+
+    if (spatialId != m_targetSpatial) {
+        if (spatialId >= 0 && (m_activeSpatial < 0 || spatialId <= m_activeSpatial)) {
+            // Dropping upper spatial layers is always safe.
+            m_activeSpatial = spatialId;
+        } else {
+            // Raising (or lifting the cap) needs a key frame to decode from.
+            needKeyFrame = true;
+        }
+        m_targetSpatial = spatialId;
+    }
+
+    if (temporalId != m_targetTemporal) {
+        if (temporalId >= 0 && (m_activeTemporal < 0 || temporalId <= m_activeTemporal)) {
+            m_activeTemporal = temporalId;
+        }
+        // Raising waits for the next temporal up-switch point in onFrame.
+        m_targetTemporal = temporalId;
+    }
+
+    if (needKeyFrame) {
+        FeedbackMsg msg(VIDEO_FEEDBACK, REQUEST_KEY_FRAME);
+        deliverFeedbackMsg(msg);
+    }
+}
+
+void VP9LayerFilter::onFrame(const Frame& frame)
+{
+    if (frame.format != FRAME_FORMAT_VP9
+        || (m_targetSpatial < 0 && m_targetTemporal < 0
+            && m_activeSpatial < 0 && m_activeTemporal < 0)) {
+        deliverFrame(frame);
+        return;
+    }
+
+    const VideoFrameSpecificInfo& video = frame.additionalInfo.video;
+
+    // A key frame is a full resync point for both dimensions.
+    if (video.isKeyFrame) {
+        m_activeSpatial = m_targetSpatial;
+        m_activeTemporal = m_targetTemporal;
+    }
+
+    // Pending temporal raise completes at an up-switch frame within reach.
+    if (m_activeTemporal != m_targetTemporal && video.temporalUpSwitch
+        && (m_targetTemporal < 0 || video.temporalLayerId <= (uint8_t)m_targetTemporal)) {
+        m_activeTemporal = m_targetTemporal;
+    }
+
+    if ((m_activeSpatial >= 0 && video.spatialLayerId > (uint8_t)m_activeSpatial)
+        || (m_activeTemporal >= 0 && video.temporalLayerId > (uint8_t)m_activeTemporal)) {
+        ++m_droppedFrames;
+        ELOG_TRACE("Filtered frame, layer S%uT%u, active S%dT%d",
+            video.spatialLayerId, video.temporalLayerId,
+            m_activeSpatial, m_activeTemporal);
+        return;
+    }
+
+    ++m_forwardedFrames;
+    deliverFrame(frame);
+}
+
+void VP9LayerFilter::onFeedback(const FeedbackMsg& msg)
+{
+    deliverFeedbackMsg(msg);
+}
+
+} /* namespace owt_base */
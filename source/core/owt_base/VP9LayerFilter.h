@@ -0,0 +1,57 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VP9LayerFilter_h
+#define VP9LayerFilter_h
+
+#include <logger.h>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+/**
+ * Per-subscriber selective forwarding for VP9 SVC streams. Sits between the
+ * stream fan-out and one subscriber and forwards only the spatial/temporal
+ * layers that subscriber can afford, using the layer ids
+ * VideoFrameConstructor stamps on each frame — no transcode involved.
+ *
+ * Layer switching follows the usual SVC rules: dropping layers takes effect
+ * immediately (lower layers never depend on upper ones), raising the spatial
+ * target waits for the next key frame (and requests one), and raising the
+ * temporal target waits for a frame marked as a temporal up-switch point.
+ * Non-VP9 frames and unrestricted filters pass everything through untouched.
+ */
+class VP9LayerFilter : public FrameSource, public FrameDestination {
+    DECLARE_LOGGER();
+
+public:
+    VP9LayerFilter();
+    virtual ~VP9LayerFilter();
+
+    // -1 means unrestricted for either dimension.
+    void setPreferredLayers(int8_t spatialId, int8_t temporalId);
+
+    // Implements FrameDestination.
+    void onFrame(const Frame&);
+
+    // Implements FrameSource.
+    void onFeedback(const FeedbackMsg&);
+
+private:
+    int8_t m_targetSpatial;
+    int8_t m_targetTemporal;
+
+    // Layers currently being forwarded; trail the targets until a valid
+    // switch point goes by.
+    int8_t m_activeSpatial;
+    int8_t m_activeTemporal;
+
+    uint64_t m_forwardedFrames;
+    uint64_t m_droppedFrames;
+};
+
+} /* namespace owt_base */
+
+#endif /* VP9LayerFilter_h */
@@ -4,6 +4,7 @@
 
 #include "VideoFrameConstructor.h"
 
+#include "PayloadBuffer.h"
 #include "WebRTCTaskRunner.h"
 #include <rtputils.h>
 #include <webrtc/common_types.h>
@@ -16,22 +17,22 @@ namespace owt_base {
 
 DEFINE_LOGGER(VideoFrameConstructor, "owt.VideoFrameConstructor");
 
-VideoFrameConstructor::VideoFrameConstructor(VideoInfoListener* vil, uint32_t transportccExtId)
+VideoFrameConstructor::VideoFrameConstructor(VideoInfoListener* vil, uint32_t transportccExtId, bool lowLatency)
     : m_enabled(true)
     , m_enableDump(false)
+    , m_lowLatency(lowLatency)
     , m_format(FRAME_FORMAT_UNKNOWN)
     , m_width(0)
     , m_height(0)
     , m_ssrc(0)
+    , m_maxKeyFrameSize(0)
     , m_video_receiver(nullptr)
     , m_transport(nullptr)
-    , m_pendingKeyFrameRequests(0)
     , m_videoInfoListener(vil)
 {
     m_videoTransport.reset(new WebRTCTransport<erizoExtra::VIDEO>(nullptr, nullptr));
     sink_fb_source_ = m_videoTransport.get();
-    m_taskRunner.reset(new owt_base::WebRTCTaskRunner("VideoFrameConstructor"));
-    m_taskRunner->Start();
+    m_taskRunner = WebRTCTaskRunner::SharedInstance("VideoFrameConstructor");
     m_feedbackTimer.reset(new JobTimer(1, this));
     init(transportccExtId);
 }
@@ -49,7 +50,6 @@ VideoFrameConstructor::~VideoFrameConstructor()
         m_taskRunner->DeRegisterModule(m_video_receiver.get());;
         m_taskRunner->DeRegisterModule(m_remoteBitrateEstimator.get());
     }
-    m_taskRunner->Stop();
     boost::unique_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
 }
 
@@ -129,6 +129,14 @@ bool VideoFrameConstructor::init(uint32_t transportccExtId)
     m_video_receiver->SetNackSettings(kMaxNackListSize, kMaxPacketAgeToNack, 0);
     m_video_receiver->RegisterPacketRequestCallback(this);
 
+    if (m_lowLatency) {
+        // Low-latency streams give the jitter buffer nothing extra to sit
+        // on: no render-delay allowance and no minimum receive delay, so a
+        // complete frame is handed over the moment it assembles.
+        m_video_receiver->SetRenderDelay(0);
+        m_video_receiver->SetMinReceiveDelay(0);
+    }
+
     // Register the key frame request callback.
     m_video_receiver->RegisterFrameTypeCallback(this);
     m_video_receiver->RegisterReceiveCallback(this);
@@ -168,6 +176,18 @@ void VideoFrameConstructor::enable(bool enabled)
     }
 }
 
+void VideoFrameConstructor::setRtxInfo(uint32_t rtxSsrc, int rtxPayloadType, int associatedPayloadType)
+{
+    // Retransmissions then arrive on their own ssrc/payload pair and are
+    // restored before they reach the jitter buffer, so they stop skewing
+    // the loss and bitrate figures of the media ssrc.
+    ELOG_DEBUG("setRtxInfo ssrc %u, pt %d, apt %d", rtxSsrc, rtxPayloadType, associatedPayloadType);
+    if (rtxSsrc)
+        m_videoReceiver->SetRtxSsrc(rtxSsrc);
+    if (rtxPayloadType > 0 && associatedPayloadType > 0)
+        m_videoReceiver->SetRtxPayloadType(rtxPayloadType, associatedPayloadType);
+}
+
 bool VideoFrameConstructor::setBitrate(uint32_t kbps)
 {
     // At present we do not react on this request
@@ -318,10 +338,39 @@ int32_t VideoFrameConstructor::Decode(const webrtc::EncodedImage& encodedImage,
         frame.additionalInfo.video.width = m_width;
         frame.additionalInfo.video.height = m_height;
         frame.additionalInfo.video.isKeyFrame = (encodedImage._frameType == webrtc::kVideoFrameKey);
+        // Assembly completion is the closest thing to an ingest instant the
+        // constructor has; the packets behind it arrived within a jitter
+        // window of this.
+        frame.ingestTimeMs = ingestWallClockMs();
+
+        if (format == FRAME_FORMAT_VP9) {
+            // Surface the SVC layer structure so downstream stages can drop
+            // layers instead of transcoding (see VP9LayerFilter).
+            const webrtc::CodecSpecificInfoVP9& vp9 = codecSpecificInfo->codecSpecific.VP9;
+            frame.additionalInfo.video.spatialLayerId =
+                (vp9.spatial_idx == webrtc::kNoSpatialIdx) ? 0 : vp9.spatial_idx;
+            frame.additionalInfo.video.temporalLayerId =
+                (vp9.temporal_idx == webrtc::kNoTemporalIdx) ? 0 : vp9.temporal_idx;
+            frame.additionalInfo.video.temporalUpSwitch = vp9.temporal_up_switch;
+        }
 
         if (m_enabled) {
-            // ELOG_INFO("DELIVER FRAME !!!");
-            deliverFrame(frame);
+            // Copy the assembled bitstream once into a pooled, refcounted
+            // buffer so fan-out destinations share it instead of each taking
+            // its own copy. Keyframe buffers are requested at the largest
+            // keyframe size seen on this stream, which keeps them in one
+            // stable pool class instead of hopping classes as sizes vary.
+            uint32_t request = frame.length;
+            if (frame.additionalInfo.video.isKeyFrame) {
+                if (frame.length > m_maxKeyFrameSize)
+                    m_maxKeyFrameSize = frame.length;
+                request = m_maxKeyFrameSize;
+            }
+            Frame owned = frame;
+            PayloadBuffer* buffer = PayloadBuffer::create(request);
+            memcpy(buffer->data(), frame.payload, frame.length);
+            attachPayloadBuffer(owned, buffer);
+            deliverFrame(std::move(owned));
         }
 
         if (m_enableDump && (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265)) {
@@ -373,20 +422,18 @@ int VideoFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket>
 
 void VideoFrameConstructor::onTimeout()
 {
-    if (m_pendingKeyFrameRequests > 1) {
+    if (m_keyFrameGovernor.onTick()) {
         this->RequestKeyFrame();
     }
-    m_pendingKeyFrameRequests = 0;
 }
 
 void VideoFrameConstructor::onFeedback(const FeedbackMsg& msg)
 {
     if (msg.type == owt_base::VIDEO_FEEDBACK) {
         if (msg.cmd == REQUEST_KEY_FRAME) {
-            if (!m_pendingKeyFrameRequests) {
+            if (m_keyFrameGovernor.onRequest()) {
                 this->RequestKeyFrame();
             }
-            ++m_pendingKeyFrameRequests;
         } else if (msg.cmd == SET_BITRATE) {
             this->setBitrate(msg.data.kbps);
         }
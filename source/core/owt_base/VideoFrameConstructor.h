@@ -5,6 +5,7 @@
 #ifndef VideoFrameConstructor_h
 #define VideoFrameConstructor_h
 
+#include "KeyFrameRequestGovernor.h"
 #include "WebRTCTaskRunner.h"
 #include "WebRTCTransport.h"
 #include "MediaFramePipeline.h"
@@ -52,13 +53,19 @@ class VideoFrameConstructor : public erizo::MediaSink,
     DECLARE_LOGGER();
 
 public:
-    VideoFrameConstructor(VideoInfoListener*, uint32_t transportccExtId = 0);
+    // lowLatency shrinks the receive side's buffering (render delay, nack
+    // wait) for streams that trade resilience for glass-to-glass latency.
+    VideoFrameConstructor(VideoInfoListener*, uint32_t transportccExtId = 0, bool lowLatency = false);
     virtual ~VideoFrameConstructor();
 
     void bindTransport(erizo::MediaSource* source, erizo::FeedbackSink* fbSink);
     void unbindTransport();
     void enable(bool enabled);
 
+    // Registers the publisher's RFC 4588 retransmission stream (from the
+    // negotiated SDP) so RTX packets are unwrapped instead of dropped.
+    void setRtxInfo(uint32_t rtxSsrc, int rtxPayloadType, int associatedPayloadType);
+
     // Implements the JobTimerListener.
     void onTimeout();
 
@@ -109,10 +116,14 @@ private:
 
     bool m_enabled;
     bool m_enableDump;
+    bool m_lowLatency;
     FrameFormat m_format;
     uint16_t m_width;
     uint16_t m_height;
     uint32_t m_ssrc;
+    // Largest keyframe seen on this stream; keyframe payload buffers are
+    // requested at this size so they stay in one pool class.
+    uint32_t m_maxKeyFrameSize;
 
     boost::scoped_ptr<webrtc::vcm::VideoReceiver> m_video_receiver;
     boost::scoped_ptr<webrtc::VieRemb> m_remoteBitrateObserver;
@@ -128,7 +139,7 @@ private:
     erizo::MediaSource* m_transport;
     boost::shared_mutex m_transport_mutex;
     boost::scoped_ptr<JobTimer> m_feedbackTimer;
-    uint32_t m_pendingKeyFrameRequests;
+    KeyFrameRequestGovernor m_keyFrameGovernor;
 
     ////////////// NEW INTERFACE ///////////
     int deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet) override;
@@ -4,6 +4,7 @@
 
 #include "VideoFramePacketizer.h"
 #include "MediaUtilities.h"
+#include "PacketPool.h"
 #include <rtputils.h>
 
 namespace owt_base {
@@ -14,21 +15,41 @@ static const int TRANSMISSION_MAXBITRATE_MULTIPLIER = 2;
 
 DEFINE_LOGGER(VideoFramePacketizer, "owt.VideoFramePacketizer");
 
+// Pacing is on by default; OWT_DISABLE_VIDEO_PACING=1 restores the old
+// direct emission for debugging.
+static bool pacingDisabled()
+{
+    static int disabled = -1;
+    if (disabled < 0) {
+        const char* env = getenv("OWT_DISABLE_VIDEO_PACING");
+        disabled = (env && env[0] && env[0] != '0') ? 1 : 0;
+    }
+    return disabled == 1;
+}
+
 VideoFramePacketizer::VideoFramePacketizer(
     bool enableRed,
     bool enableUlpfec,
     bool enableTransportcc,
     bool selfRequestKeyframe,
-    uint32_t transportccExtId)
+    uint32_t transportccExtId,
+    uint32_t playoutDelayExtId,
+    int rtxPayloadType)
     : m_enabled(true)
     , m_enableDump(false)
     , m_keyFrameArrived(false)
     , m_selfRequestKeyframe(selfRequestKeyframe)
+    , m_fecCapable(false)
+    , m_fecActive(false)
+    , m_playoutDelayExtId(playoutDelayExtId)
+    , m_sendingPadding(false)
     , m_frameFormat(FRAME_FORMAT_UNKNOWN)
     , m_frameWidth(0)
     , m_frameHeight(0)
     , m_random(rtc::TimeMicros())
     , m_ssrc(0)
+    , m_rtxSsrc(0)
+    , m_rtxPayloadType(rtxPayloadType)
     , m_ssrc_generator(SsrcGenerator::GetSsrcGenerator())
     , m_sendFrameCount(0)
     , m_clock(nullptr)
@@ -37,17 +58,21 @@ VideoFramePacketizer::VideoFramePacketizer(
     video_sink_ = nullptr;
     m_ssrc = m_ssrc_generator->CreateSsrc();
     m_ssrc_generator->RegisterSsrc(m_ssrc);
+    if (m_rtxPayloadType > 0) {
+        m_rtxSsrc = m_ssrc_generator->CreateSsrc();
+        m_ssrc_generator->RegisterSsrc(m_rtxSsrc);
+    }
     m_videoTransport.reset(new WebRTCTransport<erizoExtra::VIDEO>(this, nullptr));
-    m_taskRunner.reset(new owt_base::WebRTCTaskRunner("VideoFramePacketizer"));
-    m_taskRunner->Start();
+    m_taskRunner = WebRTCTaskRunner::SharedInstance("VideoFramePacketizer");
     init(enableRed, enableUlpfec, enableTransportcc, transportccExtId);
 }
 
 VideoFramePacketizer::~VideoFramePacketizer()
 {
     close();
-    m_taskRunner->Stop();
     m_ssrc_generator->ReturnSsrc(m_ssrc);
+    if (m_rtxSsrc)
+        m_ssrc_generator->ReturnSsrc(m_rtxSsrc);
     SsrcGenerator::ReturnSsrcGenerator();
     boost::unique_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
 }
@@ -128,8 +153,29 @@ bool VideoFramePacketizer::setSendCodec(FrameFormat frameFormat, unsigned int wi
     m_bitrateController->SetStartBitrate(targetKbps * 1000);
     m_bitrateController->SetMinMaxBitrate(minKbps * 1000, TRANSMISSION_MAXBITRATE_MULTIPLIER * targetKbps * 1000);
 
+    if (m_transportCcEstimator) {
+        m_transportCcEstimator->SetStartBitrate(targetKbps * 1000);
+        m_transportCcEstimator->SetMinMaxBitrate(minKbps * 1000, TRANSMISSION_MAXBITRATE_MULTIPLIER * targetKbps * 1000);
+    }
+
+    if (m_pacer)
+        m_pacer->setPacingRate(targetKbps * 1000);
+
+    // New subscriber or layer switch: probe toward the transmission cap so
+    // the estimate converges within the first second instead of ramping
+    // multiplicatively from the conservative start bitrate. Only useful
+    // when transport-cc feedback is there to observe the padding.
+    if (m_pacer && m_transportCcEstimator) {
+        static const int64_t kProbeDurationMs = 1000;
+        m_pacer->startProbe(TRANSMISSION_MAXBITRATE_MULTIPLIER * targetKbps * 1000, kProbeDurationMs);
+    }
+
     boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-    return m_rtpRtcp && m_rtpRtcp->RegisterSendPayload(codec) != -1;
+    if (!m_rtpRtcp || m_rtpRtcp->RegisterSendPayload(codec) == -1)
+        return false;
+    if (m_rtxPayloadType > 0)
+        m_rtpRtcp->SetRtxSendPayloadType(m_rtxPayloadType, codec.plType);
+    return true;
 }
 
 void VideoFramePacketizer::OnReceivedIntraFrameRequest(uint32_t ssrc)
@@ -142,6 +188,14 @@ void VideoFramePacketizer::OnReceivedIntraFrameRequest(uint32_t ssrc)
 int VideoFramePacketizer::deliverFeedback_(std::shared_ptr<erizo::DataPacket> data_packet)
 {
     // ELOG_INFO("deliverFeedback_ %p", this);
+    // Transport-cc feedback is consumed here; the rtp_rtcp module of this
+    // webrtc drop does not act on it without the full call machinery.
+    if (m_transportCcEstimator
+        && m_transportCcEstimator->IncomingTransportFeedback(
+                reinterpret_cast<uint8_t*>(data_packet->data), data_packet->length)) {
+        return data_packet->length;
+    }
+
     boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
     if (m_rtpRtcp) {
         return m_rtpRtcp->IncomingRtcpPacket(reinterpret_cast<uint8_t*>(data_packet->data), data_packet->length) == -1 ? 0 : data_packet->length;
@@ -158,14 +212,134 @@ void VideoFramePacketizer::receiveRtpData(char* buf, int len, erizoExtra::DataTy
 
     assert(type == erizoExtra::VIDEO);
 
+    bool isRtcp = false;
+    if (len >= 2) {
+        const uint8_t pt = reinterpret_cast<uint8_t*>(buf)[1];
+        const uint8_t rtcpMinPt = 194, rtcpMaxPt = 223;
+        isRtcp = (pt >= rtcpMinPt && pt <= rtcpMaxPt);
+    }
+
+    // Bind the wire size to the transport-wide sequence number the rtp
+    // sender just allocated for this packet. RTCP (SR) also lands here
+    // and must not consume the pending allocation. This stays ahead of the
+    // pacer: the single pending allocation would be overwritten by the next
+    // packet before a delayed bind could claim it.
+    if (m_transportCcEstimator && !isRtcp)
+        m_transportCcEstimator->OnPacketSent(len);
+
     ELOG_DEBUG("receiveRtpData %p", buf);
-    video_sink_->deliverVideoData(std::make_shared<erizo::DataPacket>(0, buf, len, erizo::VIDEO_PACKET));
+
+    // RTCP carries timing (SR) and skips the pacer; media goes through the
+    // budget so key frame bursts are spread over the frame interval. Drop
+    // the transport lock first: a bypass-eligible packet is delivered
+    // synchronously through sendPacedPacket, which takes it again.
+    // Probe padding originates from the pacer's own tick and must not
+    // re-enter the queue (it would consume budget meant for media).
+    if (m_pacer && !isRtcp && !m_sendingPadding) {
+        auto packet = PacketPool::obtain(0, buf, len, erizo::VIDEO_PACKET);
+        lock.unlock();
+        m_pacer->enqueuePacket(packet);
+        return;
+    }
+    video_sink_->deliverVideoData(PacketPool::obtain(0, buf, len, erizo::VIDEO_PACKET));
+}
+
+void VideoFramePacketizer::sendPacedPacket(std::shared_ptr<erizo::DataPacket> packet)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_transport_mutex);
+    if (video_sink_)
+        video_sink_->deliverVideoData(packet);
+}
+
+size_t VideoFramePacketizer::generatePadding(size_t bytes)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    if (!m_rtpRtcp)
+        return 0;
+    // The generated packets come back synchronously through receiveRtpData;
+    // they carry transport-wide sequence numbers, so the estimator sees
+    // them like media.
+    m_sendingPadding = true;
+    size_t generated = m_rtpRtcp->TimeToSendPadding(bytes, webrtc::PacedPacketInfo());
+    m_sendingPadding = false;
+    return generated;
 }
 
 void VideoFramePacketizer::OnNetworkChanged(const uint32_t target_bitrate, const uint8_t fraction_loss, const int64_t rtt)
 {
     // Receiver's network change detected. But we do not deliver feedback to
     // sender because sender may adjust sending bitrate for a specific receiver.
+    // The receiver report stats do drive the per-connection loss recovery
+    // strategy, though.
+    updateLossRecoveryStrategy(fraction_loss, rtt);
+}
+
+void VideoFramePacketizer::updateLossRecoveryStrategy(uint8_t fractionLoss, int64_t rttMs)
+{
+    // NACK repairs cost one RTT per attempt, which is fine nearby and
+    // hopeless trans-continentally; FEC costs constant overhead but repairs
+    // in zero round trips. Shift between them per connection: protection
+    // turns on when the RTT makes retransmission slow and loss is actually
+    // present (or loss is heavy regardless of RTT), and off again with
+    // hysteresis so a jittery path does not flap the overhead.
+    static const int64_t kFecEnterRttMs = 150;
+    static const int64_t kFecExitRttMs = 120;
+    static const uint8_t kFecEnterLoss = 5;   // ~2% of 255
+    static const uint8_t kFecHeavyLoss = 26;  // ~10%
+    static const uint8_t kFecExitLoss = 3;    // ~1%
+
+    if (!m_fecCapable)
+        return;
+
+    bool wantFec = m_fecActive;
+    if (!m_fecActive) {
+        wantFec = (rttMs >= kFecEnterRttMs && fractionLoss >= kFecEnterLoss)
+            || fractionLoss >= kFecHeavyLoss;
+    } else if (rttMs < kFecExitRttMs && fractionLoss < kFecExitLoss) {
+        wantFec = false;
+    }
+
+    webrtc::FecProtectionParams deltaParams;
+    webrtc::FecProtectionParams keyParams;
+    if (wantFec) {
+        // Protection proportional to measured loss; key frames get more
+        // since losing one costs a freeze-recover cycle.
+        int deltaRate = fractionLoss * 2;
+        deltaParams.fec_rate = deltaRate < 32 ? 32 : (deltaRate > 160 ? 160 : deltaRate);
+        deltaParams.max_fec_frames = 1;
+        deltaParams.fec_mask_type = webrtc::kFecMaskRandom;
+
+        int keyRate = fractionLoss * 3;
+        keyParams.fec_rate = keyRate < 48 ? 48 : (keyRate > 200 ? 200 : keyRate);
+        keyParams.max_fec_frames = 1;
+        keyParams.fec_mask_type = webrtc::kFecMaskRandom;
+    } else {
+        deltaParams.fec_rate = 0;
+        deltaParams.max_fec_frames = 0;
+        deltaParams.fec_mask_type = webrtc::kFecMaskRandom;
+        keyParams = deltaParams;
+    }
+
+    if (wantFec != m_fecActive) {
+        ELOG_DEBUG("Loss recovery now %s-dominant (loss %u/255, rtt %ldms)",
+            wantFec ? "FEC" : "NACK", fractionLoss, rttMs);
+        m_fecActive = wantFec;
+    }
+
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    if (m_rtpRtcp)
+        m_rtpRtcp->SetFecParameters(deltaParams, keyParams);
+}
+
+void VideoFramePacketizer::OnTransportCcEstimate(uint32_t bitrate_bps, uint8_t fraction_loss, int64_t rtt_ms)
+{
+    ELOG_DEBUG("transport-cc estimate %u bps, loss %u/255, rtt %ldms", bitrate_bps, fraction_loss, rtt_ms);
+    if (m_pacer)
+        m_pacer->setPacingRate(bitrate_bps);
+    updateLossRecoveryStrategy(fraction_loss, rtt_ms);
+    FeedbackMsg feedback = {.type = VIDEO_FEEDBACK, .cmd = SET_BITRATE};
+    feedback.data.kbps = bitrate_bps / 1000;
+    deliverFeedbackMsg(feedback);
 }
 
 
@@ -305,8 +479,25 @@ void VideoFramePacketizer::onFrame(const Frame& frame)
     // Recalculate timestamp for stream substitution
     uint32_t timeStamp = frame.timeStamp + m_timeStampOffset;//kMsToRtpTimestamp * m_clock->TimeInMilliseconds();
 
+    if (frame.ingestTimeMs > 0) {
+        int64_t ageMs = ingestWallClockMs() - frame.ingestTimeMs;
+        if (ageMs >= 0)
+            m_e2eLatency.record(ageMs * 1000);
+    }
+
     webrtc::RTPVideoHeader h;
     memset(&h, 0, sizeof(webrtc::RTPVideoHeader));
+    if (m_playoutDelayExtId > 0) {
+        // Ask the receiver to render with minimal buffering; the max bound
+        // still leaves it a little room to absorb network jitter.
+        h.playout_delay.min_ms = 0;
+        h.playout_delay.max_ms = 50;
+    } else {
+        // -1/-1 means "not specified"; zeroes would actively request a
+        // zero-delay render.
+        h.playout_delay.min_ms = -1;
+        h.playout_delay.max_ms = -1;
+    }
     uint32_t transport_frame_id_out = 0;
 
     if (frame.format != m_frameFormat
@@ -400,6 +591,12 @@ bool VideoFramePacketizer::init(bool enableRed, bool enableUlpfec, bool enableTr
     m_bitrateController->SetStartBitrate(300*1000);
     m_bitrateController->SetMinMaxBitrate(0, 0);
 
+    if (enableTransportcc)
+        m_transportCcEstimator.reset(new TransportCcEstimator(Clock::GetRealTimeClock(), this));
+
+    if (!pacingDisabled())
+        m_pacer.reset(new VideoPacketPacer(Clock::GetRealTimeClock(), this));
+
     RtpRtcp::Configuration configuration;
     configuration.outgoing_transport = m_videoTransport.get();
     configuration.audio = false;  // Video.
@@ -407,6 +604,9 @@ bool VideoFramePacketizer::init(bool enableRed, bool enableUlpfec, bool enableTr
     configuration.event_log = &m_rtcEventLog;
     configuration.bandwidth_callback = m_bandwidthObserver.get();
     configuration.retransmission_rate_limiter = m_retransmissionRateLimiter.get();
+    // Without an allocator the rtp sender registers the transport-cc
+    // extension but never stamps it, so receivers get no sequence to ack.
+    configuration.transport_sequence_number_allocator = m_transportCcEstimator.get();
     m_rtpRtcp.reset(RtpRtcp::CreateRtpRtcp(configuration));
     m_rtpRtcp->SetSSRC(m_ssrc);
 
@@ -415,8 +615,15 @@ bool VideoFramePacketizer::init(bool enableRed, bool enableUlpfec, bool enableTr
     int red_pl_type = enableRed? RED_90000_PT : -1;
     int ulpfec_pl_type = enableUlpfec? ULP_90000_PT : -1;
     m_rtpRtcp->SetUlpfecConfig(red_pl_type, ulpfec_pl_type);
+    // FEC stays dormant (rate 0) until updateLossRecoveryStrategy turns it
+    // on for a high-RTT or lossy connection.
+    m_fecCapable = enableRed && enableUlpfec;
     if (enableTransportcc)
         m_rtpRtcp->RegisterSendRtpHeaderExtension(RTPExtensionType::kRtpExtensionTransportSequenceNumber, transportccExtId);
+    // Low-latency mode: tell the receiver how little to buffer. Only
+    // registered when the subscriber negotiated the extension.
+    if (m_playoutDelayExtId > 0)
+        m_rtpRtcp->RegisterSendRtpHeaderExtension(RTPExtensionType::kRtpExtensionPlayoutDelay, m_playoutDelayExtId);
     m_rtpRtcp->SetREMBStatus(true);
 
     // Enable NACK.
@@ -424,14 +631,28 @@ bool VideoFramePacketizer::init(bool enableRed, bool enableUlpfec, bool enableTr
     m_rtpRtcp->SetStorePacketsStatus(true, 600);
     m_rtpRtcp->SetMaxRtpPacketSize(1200);
 
+    // RFC 4588: retransmissions leave on the paired SSRC so they stay out
+    // of the receiver's bandwidth estimate for the media SSRC.
+    if (m_rtxPayloadType > 0) {
+        m_rtpRtcp->SetRtxSendStatus(kRtxRetransmitted);
+        m_rtpRtcp->SetRtxSsrc(m_rtxSsrc);
+    }
+
     m_taskRunner->RegisterModule(m_rtpRtcp.get());
+    if (m_pacer)
+        m_taskRunner->RegisterModule(m_pacer.get());
 
     return true;
 }
 
 void VideoFramePacketizer::close()
 {
+    if (m_e2eLatency.count())
+        ELOG_INFO("ingest-to-egress latency %s", m_e2eLatency.report().c_str());
+
     unbindTransport();
+    if (m_pacer)
+        m_taskRunner->DeRegisterModule(m_pacer.get());
     // M53 does not support removing observer
     //if (m_bitrateController)
     //   m_bitrateController->RemoveBitrateObserver(this);
@@ -7,8 +7,11 @@
 
 #include "WebRTCTaskRunner.h"
 #include "WebRTCTransport.h"
+#include "LatencyHistogram.h"
 #include "MediaFramePipeline.h"
 #include "SsrcGenerator.h"
+#include "TransportCcEstimator.h"
+#include "VideoPacketPacer.h"
 
 #include <MediaDefinitions.h>
 #include <MediaDefinitionExtra.h>
@@ -36,21 +39,34 @@ class VideoFramePacketizer : public FrameDestination,
                              public erizo::FeedbackSink,
                              public erizoExtra::RTPDataReceiver,
                              public webrtc::BitrateObserver,
-                             public webrtc::RtcpIntraFrameObserver {
+                             public webrtc::RtcpIntraFrameObserver,
+                             public webrtc::TransportCcEstimator::Observer,
+                             public VideoPacketPacer::PacketSender {
     DECLARE_LOGGER();
 
 public:
+    // A non-zero playoutDelayExt opts this stream into low-latency mode:
+    // the playout-delay header extension (negotiated under that id) is
+    // stamped on every frame asking the receiver for minimal buffering.
+    // A non-zero rtxPayloadType enables RFC 4588: retransmissions go out
+    // on a paired SSRC under that payload type instead of replaying the
+    // media SSRC.
     VideoFramePacketizer(bool enableRed,
                          bool enableUlpfec,
                          bool enableTransportcc = true,
                          bool selfRequestKeyframe = false,
-                         uint32_t transportccExt = 2);
+                         uint32_t transportccExt = 2,
+                         uint32_t playoutDelayExt = 0,
+                         int rtxPayloadType = 0);
     ~VideoFramePacketizer();
 
     void bindTransport(erizo::MediaSink* sink);
     void unbindTransport();
     void enable(bool enabled);
     uint32_t getSsrc() { return m_ssrc; }
+    // 0 unless RTX is enabled; the JS layer announces it in the answer's
+    // FID ssrc-group.
+    uint32_t getRtxSsrc() { return m_rtxSsrc; }
 
     // Implements FrameDestination.
     void onFrame(const Frame&);
@@ -74,18 +90,43 @@ public:
     // Implements webrtc::BitrateObserver.
     void OnNetworkChanged(const uint32_t target_bitrate, const uint8_t fraction_loss, const int64_t rtt);
 
+    // Implements webrtc::TransportCcEstimator::Observer.
+    void OnTransportCcEstimate(uint32_t bitrate_bps, uint8_t fraction_loss, int64_t rtt_ms) override;
+
+    // Implements VideoPacketPacer::PacketSender.
+    void sendPacedPacket(std::shared_ptr<erizo::DataPacket> packet) override;
+    size_t generatePadding(size_t bytes) override;
+
 private:
     bool init(bool enableRed, bool enableUlpfec, bool enableTransportcc, uint32_t transportccExt);
     void close();
     bool setSendCodec(FrameFormat, unsigned int width, unsigned int height);
+    // Shifts loss recovery between NACK-dominant and FEC-dominant per the
+    // RTT/loss the receiver reports; see the implementation for thresholds.
+    void updateLossRecoveryStrategy(uint8_t fractionLoss, int64_t rttMs);
 
     bool m_enabled;
     bool m_enableDump;
     bool m_keyFrameArrived;
     bool m_selfRequestKeyframe;
+    // True when the subscriber negotiated RED+ULPFEC, i.e. we can actually
+    // emit FEC; m_fecActive tracks whether the adaptive controller currently
+    // has protection turned on.
+    bool m_fecCapable;
+    bool m_fecActive;
+    // Non-zero when this stream runs in low-latency mode; the negotiated
+    // id of the playout-delay header extension.
+    uint32_t m_playoutDelayExtId;
+    // Set for the duration of a synchronous padding generation call so
+    // receiveRtpData can tell probe padding from media. Only the pacer's
+    // process thread writes it; a racing media packet at most skips the
+    // pacer once, which is harmless.
+    volatile bool m_sendingPadding;
     std::unique_ptr<webrtc::RateLimiter> m_retransmissionRateLimiter;
     boost::scoped_ptr<webrtc::BitrateController> m_bitrateController;
     boost::scoped_ptr<webrtc::RtcpBandwidthObserver> m_bandwidthObserver;
+    boost::scoped_ptr<webrtc::TransportCcEstimator> m_transportCcEstimator;
+    boost::scoped_ptr<VideoPacketPacer> m_pacer;
     boost::scoped_ptr<webrtc::RtpRtcp> m_rtpRtcp;
     // Use dummy event logger
     webrtc::RtcEventLogNullImpl m_rtcEventLog;
@@ -98,6 +139,9 @@ private:
     uint16_t m_frameHeight;
     webrtc::Random m_random;
     uint32_t m_ssrc;
+    // RFC 4588 retransmission pair; m_rtxSsrc stays 0 when RTX is off.
+    uint32_t m_rtxSsrc;
+    int m_rtxPayloadType;
     SsrcGenerator* const m_ssrc_generator;
 
     boost::shared_mutex m_transport_mutex;
@@ -106,6 +150,10 @@ private:
     const webrtc::Clock *m_clock;
     int64_t m_timeStampOffset;
 
+    // Ingest-to-egress latency of frames carrying an ingest stamp
+    // (see Frame::ingestTimeMs); dumped at close().
+    LatencyHistogram m_e2eLatency;
+
     ///// NEW INTERFACE ///////////
     int deliverFeedback_(std::shared_ptr<erizo::DataPacket> data_packet);
     int sendPLI();
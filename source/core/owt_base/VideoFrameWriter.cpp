@@ -16,7 +16,6 @@ DEFINE_LOGGER(VideoFrameWriter, "owt.VideoFrameWriter");
 
 VideoFrameWriter::VideoFrameWriter(const std::string& name)
     : m_name(name)
-    , m_fp(NULL)
     , m_index(0)
     , m_width(0)
     , m_height(0)
@@ -25,37 +24,32 @@ VideoFrameWriter::VideoFrameWriter(const std::string& name)
 
 VideoFrameWriter::~VideoFrameWriter()
 {
-    if (m_fp) {
-        fclose(m_fp);
-        m_fp = NULL;
-    }
+    if (m_file.droppedBytes())
+        ELOG_WARN_T("Disk could not keep up, dropped %lu dump bytes", m_file.droppedBytes());
 }
 
-FILE *VideoFrameWriter::getVideoFp(webrtc::VideoFrameBuffer *i420Buffer)
+bool VideoFrameWriter::ensureVideoFile(webrtc::VideoFrameBuffer *i420Buffer)
 {
     if (m_width != i420Buffer->width() || m_height != i420Buffer->height()) {
-        if (m_fp) {
-            fclose(m_fp);
-            m_fp = NULL;
-        }
-
         m_index++;
 
         char fileName[128];
         snprintf(fileName, 128, "/tmp/%s-%d-%dx%d.i420", m_name.c_str(), m_index, i420Buffer->width(), i420Buffer->height());
-        m_fp = fopen(fileName, "wb");
-        if (!m_fp) {
+        FILE *fp = fopen(fileName, "wb");
+        if (!fp) {
             ELOG_ERROR_T("Can not open dump file, %s", fileName);
-            return NULL;
+            m_file.reset(NULL);
+            return false;
         }
 
         ELOG_INFO_T("Dump: %s", fileName);
+        m_file.reset(fp);
 
         m_width = i420Buffer->width();
         m_height = i420Buffer->height();
     }
 
-    return m_fp;
+    return m_file.isOpen();
 }
 
 void VideoFrameWriter::write(webrtc::VideoFrameBuffer *videoFrameBuffer)
@@ -70,9 +64,8 @@ void VideoFrameWriter::write(webrtc::VideoFrameBuffer *videoFrameBuffer)
         return;
     }
 
-    FILE *fp = getVideoFp(videoFrameBuffer);
-    if (!fp) {
-        ELOG_ERROR_T("NULL fp");
+    if (!ensureVideoFile(videoFrameBuffer)) {
+        ELOG_ERROR_T("No dump file");
         return;
     }
 
@@ -89,9 +82,9 @@ void VideoFrameWriter::write(webrtc::VideoFrameBuffer *videoFrameBuffer)
         return;
     }
 
-    fwrite(videoFrameBuffer->DataY(), 1, videoFrameBuffer->height() * videoFrameBuffer->StrideY() , fp);
-    fwrite(videoFrameBuffer->DataU(), 1, videoFrameBuffer->height() * videoFrameBuffer->StrideU() / 2, fp);
-    fwrite(videoFrameBuffer->DataV(), 1, videoFrameBuffer->height() * videoFrameBuffer->StrideV() / 2, fp);
+    m_file.write(videoFrameBuffer->DataY(), videoFrameBuffer->height() * videoFrameBuffer->StrideY());
+    m_file.write(videoFrameBuffer->DataU(), videoFrameBuffer->height() * videoFrameBuffer->StrideU() / 2);
+    m_file.write(videoFrameBuffer->DataV(), videoFrameBuffer->height() * videoFrameBuffer->StrideV() / 2);
 }
 
 void VideoFrameWriter::write(const Frame& frame)
@@ -12,6 +12,7 @@
 #include <webrtc/api/video/video_frame.h>
 #include <webrtc/api/video/video_frame_buffer.h>
 
+#include "AsyncDumpWriter.h"
 #include "MediaFramePipeline.h"
 
 #ifdef ENABLE_MSDK
@@ -30,13 +31,13 @@ public:
     void write(const Frame& frame);
 
 protected:
-    FILE *getVideoFp(webrtc::VideoFrameBuffer *videoFrameBuffer);
+    bool ensureVideoFile(webrtc::VideoFrameBuffer *videoFrameBuffer);
     void write(webrtc::VideoFrameBuffer *videoFrameBuffer);
 
 private:
     std::string m_name;
 
-    FILE *m_fp;
+    AsyncDumpWriter m_file;
     uint32_t m_index;
 
     int32_t m_width;
@@ -0,0 +1,165 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VideoPacketPacer.h"
+
+#include <vector>
+
+namespace owt_base {
+
+DEFINE_LOGGER(VideoPacketPacer, "owt.VideoPacketPacer");
+
+static const int64_t kProcessIntervalMs = 5;
+// Same headroom the webrtc pacer uses: draining at 2.5x the media rate keeps
+// steady-state packets out of the queue while still flattening key frame
+// bursts to a few frame intervals at most.
+static const double kPacingFactor = 2.5;
+// Budget banked while idle is capped so a quiet period cannot fund a
+// full-size burst in one tick.
+static const int64_t kMaxBudgetWindowMs = 40;
+// A packet never waits longer than this; when the oldest packet hits the
+// cap the queue drains regardless of budget, trading a controlled burst for
+// bounded latency.
+static const int64_t kMaxQueueDelayMs = 250;
+// Used until the congestion controller provides an estimate.
+static const uint32_t kDefaultBitrateBps = 300000;
+// Padding per tick is capped so a high probe target cannot burst; at 5ms
+// ticks this still supports probing beyond 7Mbps.
+static const int64_t kMaxPaddingPerTick = 4500;
+
+VideoPacketPacer::VideoPacketPacer(webrtc::Clock* clock, PacketSender* sender)
+    : m_clock(clock)
+    , m_sender(sender)
+    , m_pacingRateBps(kDefaultBitrateBps)
+    , m_budgetBytes(0)
+    , m_lastRefreshMs(clock->TimeInMilliseconds())
+    , m_lastProcessMs(clock->TimeInMilliseconds())
+    , m_pacedPackets(0)
+    , m_bypassedPackets(0)
+    , m_probeRateBps(0)
+    , m_probeEndMs(0)
+    , m_lastProbeMs(0)
+    , m_sentSinceProbeTick(0)
+    , m_probedBytes(0)
+{
+}
+
+VideoPacketPacer::~VideoPacketPacer()
+{
+    if (m_pacedPackets > 0) {
+        ELOG_DEBUG("Paced %zu packets, %zu bypassed with spare budget",
+            (size_t)m_pacedPackets, (size_t)m_bypassedPackets);
+    }
+}
+
+void VideoPacketPacer::setPacingRate(uint32_t bitrateBps)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_pacingRateBps = bitrateBps > 0 ? bitrateBps : kDefaultBitrateBps;
+}
+
+void VideoPacketPacer::replenishBudget(int64_t nowMs)
+{
+    int64_t elapsedMs = nowMs - m_lastRefreshMs;
+    if (elapsedMs <= 0)
+        return;
+    m_lastRefreshMs = nowMs;
+
+    double paceBps = m_pacingRateBps * kPacingFactor;
+    m_budgetBytes += (int64_t)(paceBps * elapsedMs / 8000);
+    int64_t cap = (int64_t)(paceBps * kMaxBudgetWindowMs / 8000);
+    if (m_budgetBytes > cap)
+        m_budgetBytes = cap;
+}
+
+void VideoPacketPacer::enqueuePacket(std::shared_ptr<erizo::DataPacket> packet)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        replenishBudget(m_clock->TimeInMilliseconds());
+        if (!m_queue.empty() || m_budgetBytes < packet->length) {
+            m_queue.push_back(QueuedPacket{ packet, m_clock->TimeInMilliseconds() });
+            return;
+        }
+        m_budgetBytes -= packet->length;
+        m_sentSinceProbeTick += packet->length;
+        ++m_bypassedPackets;
+    }
+    m_sender->sendPacedPacket(packet);
+}
+
+int64_t VideoPacketPacer::TimeUntilNextProcess()
+{
+    int64_t elapsedMs = m_clock->TimeInMilliseconds() - m_lastProcessMs;
+    return elapsedMs >= kProcessIntervalMs ? 0 : kProcessIntervalMs - elapsedMs;
+}
+
+void VideoPacketPacer::startProbe(uint32_t bitrateBps, int64_t durationMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    int64_t nowMs = m_clock->TimeInMilliseconds();
+    m_probeRateBps = bitrateBps;
+    m_probeEndMs = nowMs + durationMs;
+    m_lastProbeMs = nowMs;
+    m_sentSinceProbeTick = 0;
+    ELOG_DEBUG("Probing at %u bps for %ldms", bitrateBps, durationMs);
+}
+
+void VideoPacketPacer::Process()
+{
+    int64_t nowMs = m_clock->TimeInMilliseconds();
+    m_lastProcessMs = nowMs;
+
+    std::vector<std::shared_ptr<erizo::DataPacket>> toSend;
+    int64_t paddingBytes = 0;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        replenishBudget(nowMs);
+        while (!m_queue.empty()) {
+            const QueuedPacket& front = m_queue.front();
+            bool overdue = (nowMs - front.enqueueMs) >= kMaxQueueDelayMs;
+            if (!overdue && m_budgetBytes < front.packet->length)
+                break;
+            m_budgetBytes -= front.packet->length;
+            if (m_budgetBytes < 0)
+                m_budgetBytes = 0;
+            m_sentSinceProbeTick += front.packet->length;
+            toSend.push_back(front.packet);
+            m_queue.pop_front();
+        }
+        m_pacedPackets += toSend.size();
+
+        if (m_probeEndMs > 0) {
+            if (nowMs >= m_probeEndMs) {
+                ELOG_DEBUG("Probe finished, %zu padding bytes sent",
+                    (size_t)m_probedBytes);
+                m_probeEndMs = 0;
+            } else {
+                int64_t elapsedMs = nowMs - m_lastProbeMs;
+                m_lastProbeMs = nowMs;
+                int64_t wantBytes = (int64_t)m_probeRateBps * elapsedMs / 8000;
+                paddingBytes = wantBytes - m_sentSinceProbeTick;
+                m_sentSinceProbeTick = 0;
+                if (paddingBytes > kMaxPaddingPerTick)
+                    paddingBytes = kMaxPaddingPerTick;
+            }
+        }
+    }
+
+    // Delivered outside the lock so enqueuing threads never block on the
+    // transport write.
+    for (size_t i = 0; i < toSend.size(); ++i)
+        m_sender->sendPacedPacket(toSend[i]);
+
+    // Padding tops the tick up to the probe rate; it is generated last so
+    // it never delays media, and bypasses the budget by design - probing
+    // deliberately sends beyond the current estimate.
+    if (paddingBytes > 0) {
+        size_t generated = m_sender->generatePadding((size_t)paddingBytes);
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_probedBytes += generated;
+    }
+}
+
+} /* namespace owt_base */
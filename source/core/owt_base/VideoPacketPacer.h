@@ -0,0 +1,101 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VideoPacketPacer_h
+#define VideoPacketPacer_h
+
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <logger.h>
+#include <memory>
+
+#include <MediaDefinitions.h>
+#include <webrtc/modules/include/module.h>
+#include <webrtc/system_wrappers/include/clock.h>
+
+namespace owt_base {
+
+/**
+ * Budget-based smoothing stage between RTP packetization and the transport.
+ * A packetized key frame arrives as a burst of hundreds of packets; emitting
+ * them back-to-back overflows shallow home-router queues and the resulting
+ * loss is repaired expensively. The pacer banks send budget at a multiple of
+ * the target bitrate (so steady-state media never queues) and spreads bursts
+ * over the following ticks.
+ *
+ * Runs as a webrtc::Module on the packetizer's task runner, same as the
+ * rtp_rtcp module it follows. Packets that fit the current budget while the
+ * queue is empty bypass the queue entirely, so pacing adds no latency until
+ * a burst actually needs smoothing; a queue-delay cap bounds the latency a
+ * burst can ever pay.
+ */
+class VideoPacketPacer : public webrtc::Module {
+    DECLARE_LOGGER();
+
+public:
+    class PacketSender {
+    public:
+        virtual ~PacketSender() {}
+        virtual void sendPacedPacket(std::shared_ptr<erizo::DataPacket> packet) = 0;
+        // Asks the rtp layer to emit up to `bytes` of RTP padding for
+        // bandwidth probing. Returns the bytes actually generated.
+        virtual size_t generatePadding(size_t bytes) = 0;
+    };
+
+    VideoPacketPacer(webrtc::Clock* clock, PacketSender* sender);
+    virtual ~VideoPacketPacer();
+
+    // Target media bitrate; the pacer drains at a multiple of it.
+    void setPacingRate(uint32_t bitrateBps);
+
+    // Sends immediately when the budget allows and nothing is queued,
+    // otherwise queues for the next tick.
+    void enqueuePacket(std::shared_ptr<erizo::DataPacket> packet);
+
+    // Probes toward `bitrateBps` for `durationMs` by topping the media up
+    // with padding on every tick. A fresh subscriber's estimate starts
+    // conservative and ramps at a few percent per feedback interval; one
+    // second of padding at the target lets the acked bitrate demonstrate
+    // the real capacity within the first feedback round trips instead.
+    void startProbe(uint32_t bitrateBps, int64_t durationMs);
+
+    // Implements webrtc::Module.
+    int64_t TimeUntilNextProcess() override;
+    void Process() override;
+
+private:
+    struct QueuedPacket {
+        std::shared_ptr<erizo::DataPacket> packet;
+        int64_t enqueueMs;
+    };
+
+    // Refreshes the byte budget for the wall time elapsed since the last
+    // refresh. Called with m_mutex held.
+    void replenishBudget(int64_t nowMs);
+
+    webrtc::Clock* m_clock;
+    PacketSender* m_sender;
+
+    boost::mutex m_mutex;
+    std::deque<QueuedPacket> m_queue;
+    uint32_t m_pacingRateBps;
+    int64_t m_budgetBytes;
+    int64_t m_lastRefreshMs;
+    int64_t m_lastProcessMs;
+
+    uint64_t m_pacedPackets;
+    uint64_t m_bypassedPackets;
+
+    // Probe state; media bytes sent since the last tick count against the
+    // probe rate so padding only fills what the encoder leaves unused.
+    uint32_t m_probeRateBps;
+    int64_t m_probeEndMs;
+    int64_t m_lastProbeMs;
+    int64_t m_sentSinceProbeTick;
+    uint64_t m_probedBytes;
+};
+
+} /* namespace owt_base */
+
+#endif /* VideoPacketPacer_h */
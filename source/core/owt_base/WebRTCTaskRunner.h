@@ -5,6 +5,15 @@
 #ifndef WebRTCTaskRunner_h
 #define WebRTCTaskRunner_h
 
+#include <map>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <webrtc/base/location.h>
 #include <webrtc/modules/utility/include/process_thread.h>
 
@@ -27,12 +36,30 @@ public:
 
     webrtc::ProcessThread* unwrap();
 
+    // Returns a process-wide runner for task_name, creating and starting it
+    // on first use. A ProcessThread drives any number of registered modules
+    // serially, so per-module ordering is kept; giving every packetizer and
+    // constructor instance its own runner cost a thread per call leg on
+    // call-dense nodes.
+    //
+    // Each task_name is backed by a small fixed-size pool of ProcessThreads
+    // (OWT_TASKRUNNER_THREADS, default 2) and successive calls are dealt out
+    // round-robin, so module timer work spreads across the pool instead of
+    // serializing hundreds of streams behind one thread. Shared runners live
+    // for the process lifetime and are never stopped.
+    static boost::shared_ptr<WebRTCTaskRunner> SharedInstance(const char* task_name);
+
 private:
+    // ProcessThread keeps the name pointer rather than copying it; hold the
+    // string for the runner's lifetime. Declared before m_processThread so it
+    // is constructed first.
+    std::string m_name;
     std::unique_ptr<webrtc::ProcessThread> m_processThread;
 };
 
 inline WebRTCTaskRunner::WebRTCTaskRunner(const char* task_name)
-    : m_processThread(webrtc::ProcessThread::Create(task_name))
+    : m_name(task_name)
+    , m_processThread(webrtc::ProcessThread::Create(m_name.c_str()))
 {
 }
 
@@ -65,6 +92,44 @@ inline webrtc::ProcessThread* WebRTCTaskRunner::unwrap()
     return m_processThread.get();
 }
 
+inline boost::shared_ptr<WebRTCTaskRunner> WebRTCTaskRunner::SharedInstance(const char* task_name)
+{
+    struct RunnerPool {
+        std::vector<boost::shared_ptr<WebRTCTaskRunner>> runners;
+        size_t next = 0;
+    };
+
+    static boost::mutex runnersMutex;
+    // Leaked on purpose: module owners may be torn down during static
+    // destruction, after a static map would already have been destroyed.
+    static std::map<std::string, RunnerPool>* pools
+        = new std::map<std::string, RunnerPool>();
+
+    static const size_t poolSize = []() -> size_t {
+        const char* env = getenv("OWT_TASKRUNNER_THREADS");
+        if (env && env[0]) {
+            long n = strtol(env, NULL, 10);
+            if (n > 0 && n <= 16)
+                return n;
+        }
+        return 2;
+    }();
+
+    boost::lock_guard<boost::mutex> guard(runnersMutex);
+    RunnerPool& pool = (*pools)[task_name];
+    if (pool.runners.size() < poolSize) {
+        std::string name = std::string(task_name) + "/" + std::to_string(pool.runners.size());
+        boost::shared_ptr<WebRTCTaskRunner> runner(new WebRTCTaskRunner(name.c_str()));
+        runner->Start();
+        pool.runners.push_back(runner);
+        return runner;
+    }
+
+    boost::shared_ptr<WebRTCTaskRunner> runner = pool.runners[pool.next];
+    pool.next = (pool.next + 1) % pool.runners.size();
+    return runner;
+}
+
 } /* namespace owt_base */
 
 #endif /* WebRTCTaskRunner_h */
@@ -7,6 +7,7 @@
 
 #include <MediaDefinitions.h>
 #include <MediaDefinitionExtra.h>
+#include "PacketPool.h"
 #include <rtputils.h>
 #include <webrtc/common_types.h>
 #include <webrtc/api/call/transport.h>
@@ -66,7 +67,7 @@ inline bool WebRTCTransport<dataType>::SendRtcp(const uint8_t* data, size_t len)
     }
 
     erizo::packetType p = (dataType == erizoExtra::AUDIO) ? erizo::AUDIO_PACKET : erizo::VIDEO_PACKET;
-    return fb_sink_ ? fb_sink_->deliverFeedback(std::make_shared<erizo::DataPacket>(0, reinterpret_cast<char*>(const_cast<uint8_t*>(data)), len, p)) : 0;
+    return fb_sink_ ? fb_sink_->deliverFeedback(PacketPool::obtain(0, reinterpret_cast<char*>(const_cast<uint8_t*>(data)), len, p)) : 0;
 }
 
 }
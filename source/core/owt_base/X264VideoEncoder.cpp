@@ -0,0 +1,311 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+#include <webrtc/modules/include/module_common_types.h>
+#include <webrtc/modules/video_coding/include/video_codec_interface.h>
+
+#include "X264VideoEncoder.h"
+
+namespace owt_base {
+
+DEFINE_LOGGER(X264VideoEncoder, "owt.X264VideoEncoder");
+
+bool X264VideoEncoder::enabled()
+{
+    static int enabled = -1;
+    if (enabled < 0) {
+        const char* env = getenv("OWT_H264_X264");
+        enabled = (env && atoi(env) != 0) ? 1 : 0;
+    }
+    return enabled == 1;
+}
+
+X264VideoEncoder::X264VideoEncoder(VideoCodecProfile profile)
+    : m_profile(profile)
+    , m_encoder(NULL)
+    , m_callback(NULL)
+    , m_width(0)
+    , m_height(0)
+    , m_frameRate(0)
+    , m_bitrateKbps(0)
+    , m_keyFrameInterval(0)
+    , m_forceIDR(false)
+    , m_roiWidth(0)
+    , m_roiHeight(0)
+{
+}
+
+X264VideoEncoder::~X264VideoEncoder()
+{
+    closeEncoder();
+}
+
+const char* X264VideoEncoder::profileName() const
+{
+    switch (m_profile) {
+    case PROFILE_AVC_MAIN:
+        return "main";
+    case PROFILE_AVC_HIGH:
+        return "high";
+    case PROFILE_AVC_CONSTRAINED_BASELINE:
+    case PROFILE_AVC_BASELINE:
+    default:
+        // Matches what the OpenH264 path produces, so a deployment can flip
+        // backends without renegotiating its subscribers.
+        return "baseline";
+    }
+}
+
+bool X264VideoEncoder::openEncoder(int width, int height)
+{
+    const char* preset = getenv("OWT_X264_PRESET");
+    if (!preset || !preset[0])
+        preset = "veryfast";
+
+    if (x264_param_default_preset(&m_param, preset, "zerolatency") < 0) {
+        ELOG_WARN("Unknown preset(%s), falling back to veryfast", preset);
+        x264_param_default_preset(&m_param, "veryfast", "zerolatency");
+    }
+
+    m_param.i_csp = X264_CSP_I420;
+    m_param.i_width = width;
+    m_param.i_height = height;
+    m_param.i_fps_num = m_frameRate;
+    m_param.i_fps_den = 1;
+    m_param.b_vfr_input = 0;
+
+    // One software thread per encoder: parallelism comes from the shared
+    // encode pool running many encoders, and frame/slice threading here
+    // would add latency without helping aggregate throughput.
+    m_param.i_threads = 1;
+
+    m_param.i_keyint_max = m_keyFrameInterval ? m_keyFrameInterval : X264_KEYINT_MAX_INFINITE;
+    m_param.b_intra_refresh = 0;
+
+    // ABR with one second of VBV keeps the output rate honest for
+    // congestion control without the hard per-frame caps of stricter
+    // low-delay settings.
+    m_param.rc.i_rc_method = X264_RC_ABR;
+    m_param.rc.i_bitrate = m_bitrateKbps;
+    m_param.rc.i_vbv_max_bitrate = m_bitrateKbps;
+    m_param.rc.i_vbv_buffer_size = m_bitrateKbps;
+
+    // Annex-B with in-band SPS/PPS on every IDR, matching what the
+    // packetizer and the recorder expect from the OpenH264 path.
+    m_param.b_annexb = 1;
+    m_param.b_repeat_headers = 1;
+
+    m_param.i_log_level = X264_LOG_NONE;
+
+    if (x264_param_apply_profile(&m_param, profileName()) < 0)
+        ELOG_WARN("Profile(%s) rejected under preset(%s)", profileName(), preset);
+
+    m_encoder = x264_encoder_open(&m_param);
+    if (!m_encoder) {
+        ELOG_ERROR("x264_encoder_open failed, %dx%d, %d(kbps)", width, height, m_bitrateKbps);
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    ELOG_DEBUG("Open x264 encoder, %dx%d, %d(fps), %d(kbps), preset(%s), profile(%s)"
+            , width, height, m_frameRate, m_bitrateKbps, preset, profileName());
+    return true;
+}
+
+void X264VideoEncoder::closeEncoder()
+{
+    if (m_encoder) {
+        x264_encoder_close(m_encoder);
+        m_encoder = NULL;
+    }
+}
+
+int32_t X264VideoEncoder::InitEncode(const webrtc::VideoCodec* codecSettings, int32_t numberOfCores, size_t maxPayloadSize)
+{
+    if (!codecSettings || codecSettings->codecType != webrtc::kVideoCodecH264)
+        return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+
+    closeEncoder();
+
+    m_frameRate = codecSettings->maxFramerate;
+    m_bitrateKbps = codecSettings->startBitrate;
+    m_keyFrameInterval = codecSettings->H264().keyFrameInterval;
+
+    if (!openEncoder(codecSettings->width, codecSettings->height))
+        return WEBRTC_VIDEO_CODEC_ERROR;
+
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+int32_t X264VideoEncoder::RegisterEncodeCompleteCallback(webrtc::EncodedImageCallback* callback)
+{
+    m_callback = callback;
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+int32_t X264VideoEncoder::Release()
+{
+    closeEncoder();
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+int32_t X264VideoEncoder::SetChannelParameters(uint32_t packetLoss, int64_t rtt)
+{
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+int32_t X264VideoEncoder::SetRateAllocation(const webrtc::BitrateAllocation& allocation, uint32_t framerate)
+{
+    uint32_t kbps = allocation.get_sum_kbps();
+
+    if (!m_encoder || !kbps)
+        return WEBRTC_VIDEO_CODEC_OK;
+
+    if (kbps != m_bitrateKbps || (framerate && framerate != m_frameRate)) {
+        m_bitrateKbps = kbps;
+        if (framerate)
+            m_frameRate = framerate;
+
+        m_param.rc.i_bitrate = m_bitrateKbps;
+        m_param.rc.i_vbv_max_bitrate = m_bitrateKbps;
+        m_param.rc.i_vbv_buffer_size = m_bitrateKbps;
+        m_param.i_fps_num = m_frameRate;
+        if (x264_encoder_reconfig(m_encoder, &m_param) < 0) {
+            ELOG_WARN("Update bitrate %d(kbps) failed", m_bitrateKbps);
+            return WEBRTC_VIDEO_CODEC_ERROR;
+        }
+    }
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+int32_t X264VideoEncoder::SetResolution(uint32_t width, uint32_t height)
+{
+    if (m_width == (int)width && m_height == (int)height)
+        return WEBRTC_VIDEO_CODEC_OK;
+
+    // x264 cannot change dimensions on the fly; reopen and start the new
+    // size on an IDR so decoders resynchronize immediately.
+    closeEncoder();
+    m_forceIDR = true;
+    if (!openEncoder(width, height))
+        return WEBRTC_VIDEO_CODEC_ERROR;
+
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+void X264VideoEncoder::SetRoiRegions(const std::vector<RoiRegion>& regions, uint32_t width, uint32_t height)
+{
+    boost::lock_guard<boost::mutex> guard(m_roiMutex);
+    m_roiRegions = regions;
+    m_roiWidth = width;
+    m_roiHeight = height;
+}
+
+void X264VideoEncoder::applyRoiMap(x264_picture_t& pic)
+{
+    boost::lock_guard<boost::mutex> guard(m_roiMutex);
+
+    if (m_roiRegions.empty() || !m_roiWidth || !m_roiHeight)
+        return;
+
+    const int mbW = (m_width + 15) / 16;
+    const int mbH = (m_height + 15) / 16;
+    m_quantOffsets.assign((size_t)mbW * mbH, 0.0f);
+
+    for (size_t i = 0; i < m_roiRegions.size(); i++) {
+        const RoiRegion& r = m_roiRegions[i];
+
+        // Scale from the hint space to encode dimensions, then take every
+        // macroblock the region touches.
+        int mbX0 = (int)r.x * m_width / (int)m_roiWidth / 16;
+        int mbY0 = (int)r.y * m_height / (int)m_roiHeight / 16;
+        int mbX1 = (((int)r.x + r.width) * m_width / (int)m_roiWidth + 15) / 16;
+        int mbY1 = (((int)r.y + r.height) * m_height / (int)m_roiHeight + 15) / 16;
+        mbX1 = std::min(mbX1, mbW);
+        mbY1 = std::min(mbY1, mbH);
+
+        for (int mbY = mbY0; mbY < mbY1; mbY++)
+            for (int mbX = mbX0; mbX < mbX1; mbX++)
+                m_quantOffsets[mbY * mbW + mbX] = (float)r.qpOffset;
+    }
+
+    pic.prop.quant_offsets = m_quantOffsets.data();
+}
+
+int32_t X264VideoEncoder::Encode(const webrtc::VideoFrame& frame,
+        const webrtc::CodecSpecificInfo* codecSpecificInfo,
+        const std::vector<webrtc::FrameType>* frameTypes)
+{
+    if (!m_encoder || !m_callback)
+        return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer = frame.video_frame_buffer();
+
+    x264_picture_t picIn, picOut;
+    x264_picture_init(&picIn);
+    picIn.img.i_csp = X264_CSP_I420;
+    picIn.img.i_plane = 3;
+    picIn.img.plane[0] = const_cast<uint8_t*>(buffer->DataY());
+    picIn.img.plane[1] = const_cast<uint8_t*>(buffer->DataU());
+    picIn.img.plane[2] = const_cast<uint8_t*>(buffer->DataV());
+    picIn.img.i_stride[0] = buffer->StrideY();
+    picIn.img.i_stride[1] = buffer->StrideU();
+    picIn.img.i_stride[2] = buffer->StrideV();
+    picIn.i_pts = frame.timestamp();
+
+    applyRoiMap(picIn);
+
+    bool keyRequested = m_forceIDR
+        || (frameTypes && !frameTypes->empty() && (*frameTypes)[0] == webrtc::kVideoFrameKey);
+    picIn.i_type = keyRequested ? X264_TYPE_IDR : X264_TYPE_AUTO;
+    m_forceIDR = false;
+
+    x264_nal_t* nals = NULL;
+    int numNals = 0;
+    int size = x264_encoder_encode(m_encoder, &nals, &numNals, &picIn, &picOut);
+    if (size < 0) {
+        ELOG_ERROR("x264_encoder_encode failed");
+        return WEBRTC_VIDEO_CODEC_ERROR;
+    }
+    if (size == 0 || !numNals)
+        return WEBRTC_VIDEO_CODEC_OK;
+
+    // x264 lays the NALs out back to back, so the first payload pointer
+    // covers the whole access unit; the buffer stays valid until the next
+    // encode call and the callback copies it out synchronously.
+    webrtc::EncodedImage image(nals[0].p_payload, size, size);
+    image._encodedWidth = m_width;
+    image._encodedHeight = m_height;
+    image._timeStamp = frame.timestamp();
+    image._frameType = picOut.b_keyframe ? webrtc::kVideoFrameKey : webrtc::kVideoFrameDelta;
+    image._completeFrame = true;
+
+    webrtc::RTPFragmentationHeader fragmentation;
+    fragmentation.VerifyAndAllocateFragmentationHeader(numNals);
+    for (int i = 0; i < numNals; i++) {
+        // i_payload includes the Annex-B start code; each fragment points at
+        // the NAL itself as the packetizer expects.
+        int startCode = (nals[i].p_payload[2] == 0x01) ? 3 : 4;
+        fragmentation.fragmentationOffset[i] =
+            nals[i].p_payload - nals[0].p_payload + startCode;
+        fragmentation.fragmentationLength[i] = nals[i].i_payload - startCode;
+        fragmentation.fragmentationPlType[i] = 0;
+        fragmentation.fragmentationTimeDiff[i] = 0;
+    }
+
+    webrtc::CodecSpecificInfo info;
+    memset(&info, 0, sizeof(info));
+    info.codecType = webrtc::kVideoCodecH264;
+    info.codecSpecific.H264.packetization_mode = webrtc::H264PacketizationMode::NonInterleaved;
+
+    m_callback->OnEncodedImage(image, &info, &fragmentation);
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+} // namespace owt_base
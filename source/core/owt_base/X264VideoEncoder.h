@@ -0,0 +1,91 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef X264VideoEncoder_h
+#define X264VideoEncoder_h
+
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include <webrtc/common_types.h>
+#include <webrtc/video_encoder.h>
+
+#include "logger.h"
+#include "MediaFramePipeline.h"
+
+extern "C" {
+#include <x264.h>
+}
+
+namespace owt_base {
+
+/**
+ * webrtc::VideoEncoder backed by libx264, used by VCMFrameEncoder in place
+ * of the OpenH264 wrapper when the build compiles it in (ENABLE_X264_ENCODER)
+ * and OWT_H264_X264=1. x264 delivers notably better quality-per-cycle at our
+ * operating points; the build opt-in exists because linking libx264 makes
+ * the result GPL.
+ */
+class X264VideoEncoder : public webrtc::VideoEncoder {
+    DECLARE_LOGGER();
+
+public:
+    explicit X264VideoEncoder(VideoCodecProfile profile);
+    ~X264VideoEncoder() override;
+
+    // Runtime opt-in on top of the build opt-in: [video] h264_x264 in
+    // agent.toml (OWT_H264_X264=1). New streams pick the backend when their
+    // encoder is created, so both backends can coexist on one node.
+    static bool enabled();
+
+    int32_t InitEncode(const webrtc::VideoCodec* codecSettings, int32_t numberOfCores, size_t maxPayloadSize) override;
+    int32_t RegisterEncodeCompleteCallback(webrtc::EncodedImageCallback* callback) override;
+    int32_t Release() override;
+    int32_t Encode(const webrtc::VideoFrame& frame,
+            const webrtc::CodecSpecificInfo* codecSpecificInfo,
+            const std::vector<webrtc::FrameType>* frameTypes) override;
+    int32_t SetChannelParameters(uint32_t packetLoss, int64_t rtt) override;
+    int32_t SetRateAllocation(const webrtc::BitrateAllocation& allocation, uint32_t framerate) override;
+    int32_t SetResolution(uint32_t width, uint32_t height) override;
+
+    // ROI hints from the analytics pipeline, applied through x264's
+    // per-macroblock quant offsets. Regions are in the given hint space and
+    // rescaled to the encode dimensions each frame; an empty list clears.
+    void SetRoiRegions(const std::vector<RoiRegion>& regions, uint32_t width, uint32_t height);
+
+private:
+    bool openEncoder(int width, int height);
+    void closeEncoder();
+    // Fills the per-MB offset map from the current ROI hints and hangs it
+    // off the input picture; no-op while no hints are set.
+    void applyRoiMap(x264_picture_t& pic);
+    // Maps the stream's VideoCodecProfile onto x264's profile restriction;
+    // preset/tune come from OWT_X264_PRESET (default veryfast) + zerolatency.
+    const char* profileName() const;
+
+    VideoCodecProfile m_profile;
+    x264_t* m_encoder;
+    x264_param_t m_param;
+    webrtc::EncodedImageCallback* m_callback;
+
+    int m_width;
+    int m_height;
+    uint32_t m_frameRate;
+    uint32_t m_bitrateKbps;
+    uint32_t m_keyFrameInterval;
+    bool m_forceIDR;
+
+    // ROI hints arrive from the analyzer's plugin thread while Encode()
+    // runs on the encode pool, hence the lock. The offset map is a member
+    // so it stays valid for the duration of the encode call.
+    std::vector<RoiRegion> m_roiRegions;
+    uint32_t m_roiWidth;
+    uint32_t m_roiHeight;
+    boost::mutex m_roiMutex;
+    std::vector<float> m_quantOffsets;
+};
+
+} /* namespace owt_base */
+#endif /* X264VideoEncoder_h */
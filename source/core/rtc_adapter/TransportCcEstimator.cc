@@ -0,0 +1,319 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TransportCcEstimator.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace webrtc {
+
+namespace {
+
+// draft-holmer-rmcat-transport-wide-cc-extensions-01
+const uint8_t kTransportFeedbackPt = 205;
+const uint8_t kTransportFeedbackFmt = 15;
+
+// Queue growth beyond this, seen in two consecutive feedback packets,
+// is treated as overuse. Matches the order of magnitude the goog-cc
+// overuse detector settles on for its adaptive threshold.
+const double kOveruseThresholdMs = 12.5;
+
+const double kBackoffFactor = 0.85;
+const double kIncreasePerSecond = 0.08;
+// When probing padding pushes the acked bitrate well past the estimate
+// without queue growth, jump to just under the demonstrated rate instead
+// of ramping to it multiplicatively.
+const double kProbeConvergenceFactor = 0.9;
+const double kHighLossRatio = 0.10;
+const double kLowLossRatio = 0.02;
+
+const int64_t kHoldAfterDecreaseMs = 500;
+const int64_t kNotifyIntervalMs = 300;
+const int64_t kAckedWindowMs = 1000;
+const int64_t kSentHistoryMs = 10000;
+
+const uint32_t kDefaultStartBitrateBps = 300000;
+const uint32_t kDefaultMinBitrateBps = 50000;
+
+uint16_t Read16(const uint8_t* data) {
+  return (static_cast<uint16_t>(data[0]) << 8) | data[1];
+}
+
+}  // namespace
+
+TransportCcEstimator::TransportCcEstimator(Clock* clock, Observer* observer)
+    : clock_(clock),
+      observer_(observer),
+      next_sequence_number_(0),
+      pending_allocation_(false),
+      last_unwrapped_seq_(-1),
+      has_last_acked_(false),
+      last_acked_send_ms_(0),
+      last_acked_recv_ms_(0),
+      queue_delay_ms_(0),
+      overuse_count_(0),
+      acked_bytes_(0),
+      bitrate_bps_(kDefaultStartBitrateBps),
+      min_bitrate_bps_(kDefaultMinBitrateBps),
+      max_bitrate_bps_(0),
+      last_increase_ms_(-1),
+      last_decrease_ms_(-1),
+      last_notified_bps_(0),
+      last_notify_ms_(-1) {
+}
+
+TransportCcEstimator::~TransportCcEstimator() {
+}
+
+uint16_t TransportCcEstimator::AllocateSequenceNumber() {
+  rtc::CritScope lock(&crit_);
+  uint16_t seq = next_sequence_number_++;
+  last_unwrapped_seq_++;
+  SentPacket sent = {clock_->TimeInMilliseconds(), 0};
+  sent_packets_[last_unwrapped_seq_] = sent;
+
+  // Drop records the receiver will never report on anymore.
+  int64_t prune_before_ms = sent.send_time_ms - kSentHistoryMs;
+  while (!sent_packets_.empty() &&
+         sent_packets_.begin()->second.send_time_ms < prune_before_ms) {
+    sent_packets_.erase(sent_packets_.begin());
+  }
+
+  pending_allocation_ = true;
+  return seq;
+}
+
+void TransportCcEstimator::OnPacketSent(size_t length) {
+  rtc::CritScope lock(&crit_);
+  if (!pending_allocation_)
+    return;
+  pending_allocation_ = false;
+  std::map<int64_t, SentPacket>::iterator it =
+      sent_packets_.find(last_unwrapped_seq_);
+  if (it != sent_packets_.end())
+    it->second.size = length;
+}
+
+void TransportCcEstimator::SetStartBitrate(uint32_t bitrate_bps) {
+  rtc::CritScope lock(&crit_);
+  bitrate_bps_ = bitrate_bps;
+}
+
+void TransportCcEstimator::SetMinMaxBitrate(uint32_t min_bitrate_bps,
+                                            uint32_t max_bitrate_bps) {
+  rtc::CritScope lock(&crit_);
+  if (min_bitrate_bps > 0)
+    min_bitrate_bps_ = min_bitrate_bps;
+  max_bitrate_bps_ = max_bitrate_bps;
+}
+
+bool TransportCcEstimator::IncomingTransportFeedback(const uint8_t* packet,
+                                                     size_t length) {
+  // 4-byte common header, two SSRCs, base seq + status count,
+  // 24-bit reference time and feedback packet count.
+  if (length < 20)
+    return false;
+  if ((packet[0] >> 6) != 2 || (packet[0] & 0x1f) != kTransportFeedbackFmt ||
+      packet[1] != kTransportFeedbackPt)
+    return false;
+
+  uint16_t base_seq = Read16(&packet[12]);
+  uint16_t status_count = Read16(&packet[14]);
+  int32_t ref_time = (static_cast<int32_t>(packet[16]) << 16) |
+                     (static_cast<int32_t>(packet[17]) << 8) | packet[18];
+  if (ref_time & 0x800000)
+    ref_time |= 0xff000000;  // Sign-extend the 24-bit field.
+  int64_t ref_time_ms = static_cast<int64_t>(ref_time) * 64;
+
+  if (status_count == 0)
+    return true;
+
+  // First pass: expand packet chunks into one status symbol per packet.
+  // 0 = not received, 1 = received w/ small delta, 2 = received w/ large
+  // or negative delta.
+  std::vector<uint8_t> symbols;
+  symbols.reserve(status_count);
+  size_t pos = 20;
+  while (symbols.size() < status_count) {
+    if (pos + 2 > length)
+      return true;  // Truncated; ignore the rest.
+    uint16_t chunk = Read16(&packet[pos]);
+    pos += 2;
+    if (!(chunk & 0x8000)) {
+      // Run-length chunk.
+      uint8_t symbol = (chunk >> 13) & 0x3;
+      uint16_t run = chunk & 0x1fff;
+      for (uint16_t i = 0; i < run && symbols.size() < status_count; ++i)
+        symbols.push_back(symbol);
+    } else if (!(chunk & 0x4000)) {
+      // Status vector chunk, 14 one-bit symbols.
+      for (int i = 13; i >= 0 && symbols.size() < status_count; --i)
+        symbols.push_back((chunk >> i) & 0x1);
+    } else {
+      // Status vector chunk, 7 two-bit symbols.
+      for (int i = 12; i >= 0 && symbols.size() < status_count; i -= 2)
+        symbols.push_back((chunk >> i) & 0x3);
+    }
+  }
+
+  rtc::CritScope lock(&crit_);
+
+  // Unwrap the base sequence against the newest allocation.
+  int64_t unwrapped_base = last_unwrapped_seq_ +
+      static_cast<int16_t>(base_seq -
+                           static_cast<uint16_t>(last_unwrapped_seq_));
+
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  int64_t recv_accum_us = 0;
+  uint32_t received = 0;
+  uint32_t lost = 0;
+  int64_t newest_acked_send_ms = -1;
+  double gradient_sum_ms = 0;
+
+  // Second pass: walk the receive deltas and compare arrival spacing
+  // against send spacing packet by packet.
+  for (uint16_t i = 0; i < status_count; ++i) {
+    uint8_t symbol = symbols[i];
+    if (symbol == 0) {
+      lost++;
+      continue;
+    }
+
+    int64_t delta_us;
+    if (symbol == 1) {
+      if (pos + 1 > length)
+        break;
+      delta_us = static_cast<int64_t>(packet[pos]) * 250;
+      pos += 1;
+    } else {
+      if (pos + 2 > length)
+        break;
+      delta_us = static_cast<int64_t>(static_cast<int16_t>(Read16(&packet[pos]))) * 250;
+      pos += 2;
+    }
+    recv_accum_us += delta_us;
+    received++;
+
+    std::map<int64_t, SentPacket>::iterator it =
+        sent_packets_.find(unwrapped_base + i);
+    if (it == sent_packets_.end())
+      continue;
+
+    int64_t send_ms = it->second.send_time_ms;
+    int64_t recv_ms = ref_time_ms + recv_accum_us / 1000;
+
+    if (has_last_acked_) {
+      // Positive gradient: the path delivered this packet later than the
+      // send spacing accounts for, i.e. queue is building.
+      gradient_sum_ms += static_cast<double>(
+          (recv_ms - last_acked_recv_ms_) - (send_ms - last_acked_send_ms_));
+    }
+    has_last_acked_ = true;
+    last_acked_send_ms_ = send_ms;
+    last_acked_recv_ms_ = recv_ms;
+    newest_acked_send_ms = send_ms;
+
+    acked_history_.push_back({recv_ms, it->second.size});
+    acked_bytes_ += it->second.size;
+    sent_packets_.erase(it);
+  }
+
+  while (!acked_history_.empty() &&
+         acked_history_.front().recv_time_ms <
+             last_acked_recv_ms_ - kAckedWindowMs) {
+    acked_bytes_ -= acked_history_.front().size;
+    acked_history_.pop_front();
+  }
+
+  uint32_t acked_bitrate_bps = 0;
+  if (acked_history_.size() > 1) {
+    int64_t span_ms = last_acked_recv_ms_ - acked_history_.front().recv_time_ms;
+    if (span_ms > 0)
+      acked_bitrate_bps = static_cast<uint32_t>(
+          acked_bytes_ * 8 * 1000 / static_cast<uint64_t>(span_ms));
+  }
+
+  double loss_ratio = (received + lost) > 0
+      ? static_cast<double>(lost) / (received + lost) : 0;
+
+  // Round trip seen through the feedback channel; includes up to one
+  // feedback interval of slack, which is fine for the hold-time logic.
+  int64_t rtt_ms = newest_acked_send_ms >= 0 ? now_ms - newest_acked_send_ms : 0;
+
+  UpdateEstimate(now_ms, gradient_sum_ms, loss_ratio, acked_bitrate_bps);
+  MaybeNotify(now_ms, static_cast<uint8_t>(loss_ratio * 255), rtt_ms);
+  return true;
+}
+
+void TransportCcEstimator::UpdateEstimate(int64_t now_ms,
+                                          double delay_gradient_ms,
+                                          double loss_ratio,
+                                          uint32_t acked_bitrate_bps) {
+  // Accumulated positive gradient approximates standing queue depth;
+  // it drains naturally when the path delivers faster than we send.
+  queue_delay_ms_ = std::max(0.0, queue_delay_ms_ + delay_gradient_ms);
+
+  bool overusing = queue_delay_ms_ > kOveruseThresholdMs;
+  if (overusing)
+    overuse_count_++;
+  else
+    overuse_count_ = 0;
+
+  if (overuse_count_ >= 2 || loss_ratio > kHighLossRatio) {
+    // Back off to a fraction of what the path demonstrably delivered,
+    // and let the queue drain before probing upwards again.
+    uint32_t base = acked_bitrate_bps > 0 ? acked_bitrate_bps : bitrate_bps_;
+    bitrate_bps_ = static_cast<uint32_t>(base * kBackoffFactor);
+    queue_delay_ms_ = 0;
+    overuse_count_ = 0;
+    last_decrease_ms_ = now_ms;
+    last_increase_ms_ = now_ms;
+  } else if (!overusing && loss_ratio < kLowLossRatio &&
+             (last_decrease_ms_ < 0 ||
+              now_ms - last_decrease_ms_ > kHoldAfterDecreaseMs)) {
+    int64_t elapsed_ms = last_increase_ms_ >= 0
+        ? std::min<int64_t>(now_ms - last_increase_ms_, 1000) : 100;
+    bitrate_bps_ += static_cast<uint32_t>(
+        bitrate_bps_ * kIncreasePerSecond * elapsed_ms / 1000);
+    // Media alone never acks much above the send rate, so an acked
+    // bitrate far past the estimate means probe padding demonstrated
+    // spare capacity; claim it in one step.
+    if (acked_bitrate_bps > bitrate_bps_ + bitrate_bps_ / 4) {
+      bitrate_bps_ = static_cast<uint32_t>(
+          acked_bitrate_bps * kProbeConvergenceFactor);
+    }
+    last_increase_ms_ = now_ms;
+  }
+
+  if (bitrate_bps_ < min_bitrate_bps_)
+    bitrate_bps_ = min_bitrate_bps_;
+  if (max_bitrate_bps_ > 0 && bitrate_bps_ > max_bitrate_bps_)
+    bitrate_bps_ = max_bitrate_bps_;
+}
+
+void TransportCcEstimator::MaybeNotify(int64_t now_ms,
+                                       uint8_t fraction_loss,
+                                       int64_t rtt_ms) {
+  if (!observer_)
+    return;
+
+  bool decreased = bitrate_bps_ < last_notified_bps_;
+  bool significant = last_notified_bps_ == 0 ||
+      bitrate_bps_ > last_notified_bps_ + last_notified_bps_ / 32 ||
+      bitrate_bps_ + last_notified_bps_ / 32 < last_notified_bps_;
+
+  // Decreases go out immediately; increases are rate limited so the
+  // encoder is not reconfigured on every feedback packet.
+  if (!decreased &&
+      (!significant ||
+       (last_notify_ms_ >= 0 && now_ms - last_notify_ms_ < kNotifyIntervalMs)))
+    return;
+
+  last_notified_bps_ = bitrate_bps_;
+  last_notify_ms_ = now_ms;
+  observer_->OnTransportCcEstimate(bitrate_bps_, fraction_loss, rtt_ms);
+}
+
+}  // namespace webrtc
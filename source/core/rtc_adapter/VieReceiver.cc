@@ -112,6 +112,12 @@ void ViEReceiver::SetRtxPayloadType(int payload_type) {
   rtp_payload_registry_->SetRtxPayloadType(rtp_payload_registry_->red_payload_type(), payload_type);
 }
 
+void ViEReceiver::SetRtxPayloadType(int payload_type,
+                                    int associated_payload_type) {
+  rtp_payload_registry_->SetRtxPayloadType(payload_type,
+                                           associated_payload_type);
+}
+
 void ViEReceiver::SetRtxSsrc(uint32_t ssrc) {
   rtp_payload_registry_->SetRtxSsrc(ssrc);
 }
@@ -196,6 +202,75 @@ int ViEReceiver::ReceivedRTPPacket(const void* rtp_packet,
                          rtp_packet_length, packet_time);
 }
 
+int ViEReceiver::ReceivedRTPPacketBatch(const ReceivedPacket* packets,
+                                        size_t count) {
+  if (count == 0)
+    return 0;
+  {
+    rtc::CritScope lock(&receive_cs_);
+    if (!receiving_) {
+      return -1;
+    }
+  }
+
+  // Shared across the batch: one clock read and one log-throttle check
+  // instead of one per packet. The bitrate estimator and the receive
+  // statistics have per-packet interfaces in this webrtc drop, so they
+  // are fed back-to-back within the single pass below; grouping the
+  // calls keeps their internal locks hot instead of interleaving them
+  // with transport work.
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  int ret = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    const uint8_t* rtp_packet = packets[i].data;
+    size_t rtp_packet_length = packets[i].length;
+
+    RTPHeader header;
+    if (!rtp_header_parser_->Parse(rtp_packet, rtp_packet_length, &header)) {
+      ret = -1;
+      continue;
+    }
+    size_t payload_length = rtp_packet_length - header.headerLength;
+    int64_t arrival_time_ms;
+    if (packets[i].time.timestamp != -1)
+      arrival_time_ms = (packets[i].time.timestamp + 500) / 1000;
+    else
+      arrival_time_ms = now_ms;
+
+    if (i == 0 && now_ms - last_packet_log_ms_ > kPacketLogIntervalMs) {
+      // Periodically log the RTP header of incoming packets.
+      rtc::CritScope lock(&receive_cs_);
+      std::stringstream ss;
+      ss << "Packet received on SSRC: " << header.ssrc << " with payload type: "
+         << static_cast<int>(header.payloadType) << ", timestamp: "
+         << header.timestamp << ", sequence number: " << header.sequenceNumber
+         << ", arrival time: " << arrival_time_ms;
+      if (header.extension.hasTransmissionTimeOffset)
+        ss << ", toffset: " << header.extension.transmissionTimeOffset;
+      if (header.extension.hasAbsoluteSendTime)
+        ss << ", abs send time: " << header.extension.absoluteSendTime;
+      last_packet_log_ms_ = now_ms;
+    }
+
+    remote_bitrate_estimator_->IncomingPacket(arrival_time_ms,
+                                              payload_length, header);
+    header.payload_type_frequency = kVideoPayloadTypeFrequency;
+
+    bool in_order = IsPacketInOrder(header);
+    rtp_payload_registry_->SetIncomingPayloadType(header);
+
+    if (!ReceivePacket(rtp_packet, rtp_packet_length, header, in_order))
+      ret = -1;
+    // Update receive statistics after ReceivePacket.
+    // Receive statistics will be reset if the payload type changes (make sure
+    // that the first packet is included in the stats).
+    rtp_receive_statistics_->IncomingPacket(
+        header, rtp_packet_length, IsPacketRetransmitted(header, in_order));
+  }
+  return ret;
+}
+
 int ViEReceiver::ReceivedRTCPPacket(const void* rtcp_packet,
                                     size_t rtcp_packet_length) {
   return InsertRTCPPacket(static_cast<const uint8_t*>(rtcp_packet),
@@ -242,60 +317,10 @@ void ViEReceiver::ReceivedBWEPacket(
 int ViEReceiver::InsertRTPPacket(const uint8_t* rtp_packet,
                                  size_t rtp_packet_length,
                                  const PacketTime& packet_time) {
-  {
-    rtc::CritScope lock(&receive_cs_);
-    if (!receiving_) {
-      return -1;
-    }
-  }
-
-  RTPHeader header;
-  if (!rtp_header_parser_->Parse(rtp_packet, rtp_packet_length,
-                                 &header)) {
-    return -1;
-  }
-  size_t payload_length = rtp_packet_length - header.headerLength;
-  int64_t arrival_time_ms;
-  int64_t now_ms = clock_->TimeInMilliseconds();
-  if (packet_time.timestamp != -1)
-    arrival_time_ms = (packet_time.timestamp + 500) / 1000;
-  else
-    arrival_time_ms = now_ms;
-
-  {
-    // Periodically log the RTP header of incoming packets.
-    rtc::CritScope lock(&receive_cs_);
-    if (now_ms - last_packet_log_ms_ > kPacketLogIntervalMs) {
-      std::stringstream ss;
-      ss << "Packet received on SSRC: " << header.ssrc << " with payload type: "
-         << static_cast<int>(header.payloadType) << ", timestamp: "
-         << header.timestamp << ", sequence number: " << header.sequenceNumber
-         << ", arrival time: " << arrival_time_ms;
-      if (header.extension.hasTransmissionTimeOffset)
-        ss << ", toffset: " << header.extension.transmissionTimeOffset;
-      if (header.extension.hasAbsoluteSendTime)
-        ss << ", abs send time: " << header.extension.absoluteSendTime;
-      last_packet_log_ms_ = now_ms;
-    }
-  }
-
-  remote_bitrate_estimator_->IncomingPacket(arrival_time_ms,
-                                            payload_length, header);
-  header.payload_type_frequency = kVideoPayloadTypeFrequency;
-
-  bool in_order = IsPacketInOrder(header);
-  rtp_payload_registry_->SetIncomingPayloadType(header);
-
-
-  int ret = ReceivePacket(rtp_packet, rtp_packet_length, header, in_order)
-      ? 0
-      : -1;
-  // Update receive statistics after ReceivePacket.
-  // Receive statistics will be reset if the payload type changes (make sure
-  // that the first packet is included in the stats).
-  rtp_receive_statistics_->IncomingPacket(
-      header, rtp_packet_length, IsPacketRetransmitted(header, in_order));
-  return ret;
+  // Single-packet entry shares the batched path so there is only one
+  // ingestion code path to maintain.
+  ReceivedPacket packet = {rtp_packet, rtp_packet_length, packet_time};
+  return ReceivedRTPPacketBatch(&packet, 1);
 }
 
 bool ViEReceiver::ReceivePacket(const uint8_t* packet,
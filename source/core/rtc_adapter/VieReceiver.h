@@ -55,6 +55,9 @@ class ViEReceiver : public RtpData {
 
   void SetNackStatus(bool enable, int max_nack_reordering_threshold);
   void SetRtxPayloadType(int payload_type);
+  // RFC 4588 mapping: packets arriving under |payload_type| are restored
+  // to |associated_payload_type| after the RTX header is stripped.
+  void SetRtxPayloadType(int payload_type, int associated_payload_type);
   void SetRtxSsrc(uint32_t ssrc);
   bool GetRtxSsrc(uint32_t* ssrc) const;
 
@@ -76,9 +79,21 @@ class ViEReceiver : public RtpData {
   void StartReceive();
   void StopReceive();
 
+  // One entry of a receive batch handed over by the transport.
+  struct ReceivedPacket {
+    const uint8_t* data;
+    size_t length;
+    PacketTime time;
+  };
+
   // Receives packets from external transport.
   int ReceivedRTPPacket(const void* rtp_packet, size_t rtp_packet_length,
                         const PacketTime& packet_time);
+  // Batched variant for transports that drain several packets per socket
+  // wakeup: the receiving state, clock and log throttle are checked once
+  // per batch instead of once per packet. Returns -1 if any packet in the
+  // batch failed, 0 otherwise.
+  int ReceivedRTPPacketBatch(const ReceivedPacket* packets, size_t count);
   int ReceivedRTCPPacket(const void* rtcp_packet, size_t rtcp_packet_length);
 
   // Implements RtpData.
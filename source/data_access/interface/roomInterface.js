@@ -69,6 +69,27 @@ function updateAudioOnlyViews(labels, room, callback) {
   });
 }
 
+/*
+ * In-memory cache of processed room configurations, so steady-state joins
+ * are served without a database round-trip and join latency no longer
+ * tracks MongoDB health. Writes through this module update or invalidate
+ * the entry immediately; entries also expire after CONFIG_CACHE_TTL so
+ * processes that did not see a write (each process has its own cache)
+ * converge within the TTL.
+ */
+var CONFIG_CACHE_TTL = (global.config && global.config.mongo
+    && global.config.mongo.configCacheTTL) || 60 * 1000;
+
+var config_cache = {}; // {roomId: {config: Object, expire: Number}}
+
+var cacheConfig = function (roomId, config) {
+  config_cache[roomId.toString()] = {config: config, expire: Date.now() + CONFIG_CACHE_TTL};
+};
+
+var invalidateConfig = function (roomId) {
+  delete config_cache[roomId.toString()];
+};
+
 const removeNull = (obj) => {
   Object.keys(obj).forEach(key => {
     if (obj[key] && typeof obj[key] === 'object')
@@ -167,6 +188,7 @@ exports.get = function (serviceId, roomId, callback) {
  * Delete Room. Removes a determined room from the data base.
  */
 exports.delete = function (serviceId, roomId, callback) {
+  invalidateConfig(roomId);
   Room.remove({_id: roomId}, function(err0) {
     Service.findByIdAndUpdate(serviceId, { '$pull' : { 'rooms' : roomId } },
       function (err1, service) {
@@ -190,8 +212,11 @@ exports.update = function (serviceId, roomId, updates, callback) {
     return newRoom.save();
   }).then((saved) => {
     if (labels.length > 0) {
+      // The audio-only rewrite saves again; let the next config() refetch.
+      invalidateConfig(roomId);
       updateAudioOnlyViews(labels, saved, callback);
     } else {
+      cacheConfig(roomId, Room.processLayout(saved.toObject()));
       callback(null, saved.toObject());
     }
   }).catch((err) => {
@@ -201,14 +226,22 @@ exports.update = function (serviceId, roomId, updates, callback) {
 
 /*
  * Get a room's configuration. Called by conference.
+ * Served from the cache when a fresh entry exists; only cache misses and
+ * expired entries touch the database.
  */
 exports.config = function (roomId) {
+  var cached = config_cache[roomId.toString()];
+  if (cached && Date.now() < cached.expire) {
+    return Promise.resolve(cached.config);
+  }
   return new Promise((resolve, reject) => {
     Room.findById(roomId, function (err, room) {
       if (err || !room) {
+        invalidateConfig(roomId);
         reject(err);
       } else {
         var config = Room.processLayout(room.toObject());
+        cacheConfig(roomId, config);
         resolve(config);
       }
     });
@@ -50,6 +50,7 @@ var app = express();
 var serverAuthenticator = require('./auth/serverAuthenticator');
 var servicesResource = require('./resource/servicesResource');
 var serviceResource = require('./resource/serviceResource');
+var clusterStatsResource = require('./resource/clusterStatsResource');
 
 // parse application/x-www-form-urlencoded
 app.use(bodyParser.urlencoded({ extended: true }))
@@ -81,6 +82,11 @@ app.get('/services', servicesResource.represent);
 app.get('/services/:service', serviceResource.represent);
 app.delete('/services/:service', serviceResource.deleteService);
 
+// Cluster-wide statistics: poll the snapshot once, or follow the SSE feed
+// for incremental deltas.
+app.get('/cluster/stats', clusterStatsResource.represent);
+app.get('/cluster/stats/feed', clusterStatsResource.feed);
+
 // API for version 1.0.
 var routerV1 = require('./resource/v1');
 app.use('/v1', routerV1);
@@ -0,0 +1,45 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+var statsAggregator = require('../statsAggregator');
+var logger = require('./../logger').logger;
+
+// Logger
+var log = logger.getLogger('ClusterStatsResource');
+
+exports.represent = function (req, res) {
+    statsAggregator.getSnapshot(function (snapshot) {
+        res.send(snapshot);
+    });
+};
+
+// Server-sent events: a full snapshot on connect, then incremental deltas
+// as the aggregate moves. All followers share the same per-process refresh
+// loop, so high-resolution dashboards cost the control plane one refresh
+// per interval instead of one query chain per poll.
+exports.feed = function (req, res) {
+    log.debug('Stats feed attached from', req.ip);
+    res.writeHead(200, {
+        'Content-Type': 'text/event-stream',
+        'Cache-Control': 'no-cache',
+        'Connection': 'keep-alive'
+    });
+    res.write('retry: 3000\n\n');
+
+    var subscription = statsAggregator.subscribe(function (event, data) {
+        res.write('event: ' + event + '\ndata: ' + JSON.stringify(data) + '\n\n');
+    });
+
+    // Comment lines keep idle proxies from reaping the connection.
+    var heartbeat = setInterval(function () {
+        res.write(':\n\n');
+    }, 15000);
+
+    req.on('close', function () {
+        log.debug('Stats feed detached from', req.ip);
+        clearInterval(heartbeat);
+        statsAggregator.unsubscribe(subscription);
+    });
+};
@@ -0,0 +1,134 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+
+var rpc = require('./rpc/rpc');
+var log = require('./logger').logger.getLogger('StatsAggregator');
+
+var cluster_name = ((global.config || {}).cluster || {}).name || 'owt-cluster';
+var refresh_interval = (((global.config || {}).stats || {}).interval) || 1000;
+
+// One in-memory aggregate per worker process, refreshed from the cluster
+// manager on a fixed interval while at least one subscriber is attached.
+// Every refresh answers from the cluster manager's own tables, so the cost
+// is independent of how many dashboards follow the feed.
+var snapshot = {seq: 0, updatedAt: 0, workers: {}};
+var subscribers = {};
+var nextSubscriberId = 0;
+var timer = null;
+var refreshing = false;
+
+var callRpc = function (method, args) {
+    return new Promise(function (resolve) {
+        rpc.callRpc(cluster_name, method, args, {callback: function (result) {
+            resolve((result === 'timeout' || result === 'error') ? null : result);
+        }});
+    });
+};
+
+// A worker entry only makes it into the delta when something a dashboard
+// would render actually moved.
+var entryChanged = function (a, b) {
+    return !a || a.purpose !== b.purpose || a.state !== b.state || a.load !== b.load || a.tasks !== b.tasks;
+};
+
+var publish = function (workers) {
+    var delta = {added: {}, updated: {}, removed: []};
+    var dirty = false;
+
+    for (var id in workers) {
+        if (!snapshot.workers[id]) {
+            delta.added[id] = workers[id];
+            dirty = true;
+        } else if (entryChanged(snapshot.workers[id], workers[id])) {
+            delta.updated[id] = workers[id];
+            dirty = true;
+        }
+    }
+    for (var old_id in snapshot.workers) {
+        if (!workers[old_id]) {
+            delta.removed.push(old_id);
+            dirty = true;
+        }
+    }
+
+    snapshot = {seq: snapshot.seq + 1, updatedAt: Date.now(), workers: workers};
+
+    if (dirty) {
+        delta.seq = snapshot.seq;
+        delta.updatedAt = snapshot.updatedAt;
+        for (var sub_id in subscribers) {
+            subscribers[sub_id]('delta', delta);
+        }
+    }
+};
+
+var refresh = function (done) {
+    // RPC timeouts longer than the refresh interval must not stack.
+    if (refreshing) {
+        return done && done();
+    }
+    refreshing = true;
+
+    callRpc('getWorkers', ['all']).then(function (list) {
+        return Promise.all((list || []).map(function (id) {
+            return callRpc('getWorkerAttr', [id]).then(function (attr) {
+                return attr && {id: id,
+                               purpose: attr.purpose,
+                               state: attr.state,
+                               load: attr.load,
+                               tasks: attr.tasks};
+            });
+        }));
+    }).then(function (entries) {
+        var workers = {};
+        entries.forEach(function (e) {
+            if (e) {
+                workers[e.id] = {purpose: e.purpose, state: e.state, load: e.load, tasks: e.tasks};
+            }
+        });
+        publish(workers);
+    }).catch(function (err) {
+        log.debug('Stats refresh failed:', err);
+    }).then(function () {
+        refreshing = false;
+        done && done();
+    });
+};
+
+// The callback receives ('snapshot', fullState) right away, then
+// ('delta', {seq, updatedAt, added, updated, removed}) whenever the
+// aggregate moves. Returns the id to pass to unsubscribe.
+exports.subscribe = function (onUpdate) {
+    var id = nextSubscriberId++;
+    subscribers[id] = onUpdate;
+
+    if (!timer) {
+        refresh();
+        timer = setInterval(refresh, refresh_interval);
+    }
+    onUpdate('snapshot', snapshot);
+
+    return id;
+};
+
+exports.unsubscribe = function (id) {
+    delete subscribers[id];
+    if (timer && Object.keys(subscribers).length === 0) {
+        clearInterval(timer);
+        timer = null;
+    }
+};
+
+// One-shot view for plain GET clients; refreshes first when nobody is
+// keeping the aggregate warm.
+exports.getSnapshot = function (callback) {
+    if (timer) {
+        return callback(snapshot);
+    }
+    refresh(function () {
+        callback(snapshot);
+    });
+};
@@ -226,6 +226,10 @@ var rpcPublic = {
     var notifyFail = (err) => {};
     socketio_server && socketio_server.notify(participantId, event, data).catch(notifyFail);
     callback('callback', 'ok');
+  },
+  broadcast: function(participantIds, event, data, callback) {
+    socketio_server && socketio_server.broadcast(participantIds, event, data);
+    callback('callback', 'ok');
   }
 };
 
@@ -7,6 +7,7 @@
 var path = require('path');
 var log = require('./logger').logger.getLogger('SocketIOServer');
 var crypto = require('crypto');
+var sioParser = require('socket.io-parser');
 var vsprintf = require("sprintf-js").vsprintf;
 
 var LegacyClient = require('./legacyClient');
@@ -323,6 +324,27 @@ var Connection = function(spec, socket, reconnectionKey, portal, dock) {
     }
   };
 
+  that.getProtocol = function () {
+    return protocol_version;
+  };
+
+  // Used by the broadcast path: write an already-encoded packet straight to
+  // engine.io, skipping the per-socket serialization socket.emit would do.
+  // Returns false when the connection cannot take it (still connecting or
+  // waiting for reconnecting) so the caller can fall back to sendMessage
+  // and land the event in pending_messages.
+  that.sendPreEncoded = function (encodedPackets) {
+    if (state !== 'connected') {
+      return false;
+    }
+    try {
+      socket.packet(encodedPackets, {preEncoded: true});
+    } catch (e) {
+      log.error('socket.packet error:', e.message);
+    }
+    return true;
+  };
+
   that.close = (ifLeave) => {
     log.debug('close it, client_id:', client_id);
     ifLeave && forceClientLeave();
@@ -448,6 +470,69 @@ var SocketIOServer = function(spec, portal, observer) {
     }
   };
 
+  // Broadcast fan-out. Events for many recipients are queued and flushed
+  // once per tick, and each event is encoded exactly once with the shared
+  // buffers handed to every eligible socket, so a join storm costs
+  // O(events) serializations instead of O(events x participants).
+  var sio_encoder = new sioParser.Encoder();
+  var pending_broadcasts = [];
+  var broadcast_flush_scheduled = false;
+
+  // A shared pre-encoded packet can only go to clients whose protocol
+  // delivers the event verbatim; the legacy protocol rewrites every event
+  // and 1.0 rewrites 'stream' events, so those keep the per-client path.
+  var canShareEncoding = function (client, event) {
+    var protocol = client.connection.getProtocol();
+    return (protocol === '1.1') || (protocol === '1.0' && event !== 'stream');
+  };
+
+  var deliverBroadcast = function (item) {
+    var shared = [];
+    item.recipients.forEach(function (id) {
+      var client = clients[id];
+      if (!client) {
+        return;
+      }
+      if (canShareEncoding(client, item.event)) {
+        shared.push(client);
+      } else {
+        client.notify(item.event, item.data);
+      }
+    });
+
+    if (shared.length === 0) {
+      return;
+    }
+
+    sio_encoder.encode({type: sioParser.EVENT, data: [item.event, item.data], nsp: '/'}, function (encodedPackets) {
+      shared.forEach(function (client) {
+        if (!client.connection.sendPreEncoded(encodedPackets)) {
+          // Not currently connected - go through the normal path so the
+          // event is queued for the reconnecting client.
+          client.notify(item.event, item.data);
+        }
+      });
+    });
+  };
+
+  var flushBroadcasts = function () {
+    broadcast_flush_scheduled = false;
+    var batch = pending_broadcasts;
+    pending_broadcasts = [];
+    batch.forEach(deliverBroadcast);
+  };
+
+  that.broadcast = function(participantIds, event, data) {
+    log.debug('broadcast participants:', participantIds, 'event:', event);
+    var recipients = (participantIds === 'all') ? Object.keys(clients) : participantIds;
+    pending_broadcasts.push({recipients: recipients, event: event, data: data});
+    if (!broadcast_flush_scheduled) {
+      broadcast_flush_scheduled = true;
+      setImmediate(flushBroadcasts);
+    }
+    return Promise.resolve('ok');
+  };
+
   that.drop = function(participantId) {
     if (participantId === 'all') {
       for(var pid in clients) {
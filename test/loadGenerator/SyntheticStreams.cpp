@@ -0,0 +1,167 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SyntheticStreams.h"
+
+#include <cstring>
+#include <unistd.h>
+
+namespace owt_load {
+
+DEFINE_LOGGER(SyntheticPublisher, "owt.SyntheticPublisher");
+
+// Leading bytes of every synthetic payload; lets StatsSubscriber tell
+// harness frames (with an embedded send time) from anything else.
+struct PayloadHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint64_t sendUs;
+};
+
+static const uint32_t kPayloadMagic = 0x4f57544c; // "OWTL"
+
+// Rough shape of real encoder output: key frames carry several times the
+// bits of a delta frame at the same target bitrate.
+static const uint32_t kKeyFrameSizeFactor = 4;
+
+SyntheticPublisher::SyntheticPublisher(const std::string& codec, uint32_t width, uint32_t height,
+    uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds)
+    : m_format(owt_base::getFormat(codec))
+    , m_width(width)
+    , m_height(height)
+    , m_frameRate(frameRate ? frameRate : 30)
+    , m_bitrateKbps(bitrateKbps ? bitrateKbps : 1000)
+    , m_keyFrameIntervalSeconds(keyFrameIntervalSeconds ? keyFrameIntervalSeconds : 2)
+    , m_seq(0)
+    , m_timeStamp(0)
+    , m_running(true)
+{
+    owt_base::Frame probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.format = m_format;
+    m_isAudio = owt_base::isAudioFrame(probe);
+
+    if (m_isAudio)
+        m_frameRate = 50; // 20ms packets, the rate every audio path here runs at
+
+    size_t deltaSize = m_bitrateKbps * 1000 / 8 / m_frameRate;
+    m_payloadSize = (m_isAudio ? deltaSize : deltaSize * kKeyFrameSizeFactor) + sizeof(PayloadHeader);
+    m_payload.reset(new uint8_t[m_payloadSize]);
+    // Incompressible-ish filler so any stage that copies pays a realistic cost.
+    for (size_t i = 0; i < m_payloadSize; ++i)
+        m_payload[i] = (uint8_t)(i * 2654435761u >> 24);
+
+    m_thread = boost::thread(&SyntheticPublisher::generateLoop, this);
+}
+
+SyntheticPublisher::~SyntheticPublisher()
+{
+    m_running = false;
+    m_thread.join();
+}
+
+void SyntheticPublisher::generateLoop()
+{
+    const uint64_t intervalUs = 1000000 / m_frameRate;
+    uint64_t nextUs = owt_base::LatencyHistogram::nowUs();
+
+    while (m_running) {
+        uint64_t now = owt_base::LatencyHistogram::nowUs();
+        if (now < nextUs) {
+            usleep(nextUs - now);
+            continue;
+        }
+        // A generator that fell behind (oversubscribed node) skips ahead
+        // instead of bursting to catch up.
+        if (now > nextUs + intervalUs * 10)
+            nextUs = now;
+        nextUs += intervalUs;
+
+        bool keyFrame = !m_isAudio && (m_seq % (m_frameRate * m_keyFrameIntervalSeconds) == 0);
+        size_t deltaSize = m_bitrateKbps * 1000 / 8 / m_frameRate;
+        size_t size = sizeof(PayloadHeader) + (keyFrame ? deltaSize * kKeyFrameSizeFactor : deltaSize);
+        if (size > m_payloadSize)
+            size = m_payloadSize;
+
+        PayloadHeader* header = reinterpret_cast<PayloadHeader*>(m_payload.get());
+        header->magic = kPayloadMagic;
+        header->seq = m_seq;
+        header->sendUs = owt_base::LatencyHistogram::nowUs();
+
+        owt_base::Frame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.format = m_format;
+        frame.payload = m_payload.get();
+        frame.length = size;
+        frame.timeStamp = m_timeStamp;
+        if (m_isAudio) {
+            frame.additionalInfo.audio.sampleRate = 48000;
+            frame.additionalInfo.audio.channels = 2;
+            frame.additionalInfo.audio.nbSamples = 48000 / m_frameRate;
+            m_timeStamp += 48000 / m_frameRate;
+        } else {
+            frame.additionalInfo.video.width = m_width;
+            frame.additionalInfo.video.height = m_height;
+            frame.additionalInfo.video.isKeyFrame = keyFrame;
+            m_timeStamp += 90000 / m_frameRate;
+        }
+
+        deliverFrame(frame);
+        m_seq++;
+    }
+}
+
+StatsSubscriber::StatsSubscriber()
+    : m_frames(0)
+    , m_bytes(0)
+    , m_keyFrames(0)
+    , m_windowStartUs(owt_base::LatencyHistogram::nowUs())
+{
+}
+
+void StatsSubscriber::onFrame(const owt_base::Frame& frame)
+{
+    if (frame.length >= sizeof(PayloadHeader)) {
+        const PayloadHeader* header = reinterpret_cast<const PayloadHeader*>(frame.payload);
+        if (header->magic == kPayloadMagic)
+            m_latency.record(owt_base::LatencyHistogram::nowUs() - header->sendUs);
+    }
+
+    boost::lock_guard<boost::mutex> guard(m_mutex);
+    m_frames++;
+    m_bytes += frame.length;
+    if (!owt_base::isAudioFrame(frame) && frame.additionalInfo.video.isKeyFrame)
+        m_keyFrames++;
+}
+
+std::string StatsSubscriber::getStats()
+{
+    uint64_t frames, bytes, keyFrames, windowUs;
+    {
+        boost::lock_guard<boost::mutex> guard(m_mutex);
+        uint64_t now = owt_base::LatencyHistogram::nowUs();
+        frames = m_frames;
+        bytes = m_bytes;
+        keyFrames = m_keyFrames;
+        windowUs = now - m_windowStartUs;
+        m_frames = 0;
+        m_bytes = 0;
+        m_keyFrames = 0;
+        m_windowStartUs = now;
+    }
+
+    if (!windowUs)
+        windowUs = 1;
+
+    std::ostringstream os;
+    os << "{\"frames\":" << frames
+       << ",\"keyFrames\":" << keyFrames
+       << ",\"fps\":" << (frames * 1000000 / windowUs)
+       << ",\"kbps\":" << (bytes * 8 * 1000 / windowUs)
+       << ",\"latency\":" << m_latency.report()
+       << "}";
+    return os.str();
+}
+
+} /* namespace owt_load */
@@ -0,0 +1,111 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SyntheticStreams_h
+#define SyntheticStreams_h
+
+#include <string>
+
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <logger.h>
+
+#include "LatencyHistogram.h"
+#include "MediaFramePipeline.h"
+
+namespace owt_load {
+
+// Emits a stream of synthetic encoded frames shaped like a real publisher:
+// configured codec, frame rate, bitrate and key-frame interval, with key
+// frames sized a few times larger than deltas. Payload bytes are garbage
+// except for a small header carrying the send timestamp, which
+// StatsSubscriber reads to measure end-to-end latency through whatever
+// stages are wired in between.
+//
+// Each publisher paces on its own thread rather than the shared JobTimer
+// service: the harness exists to find per-node ceilings, so N generators
+// must be able to spread over cores instead of serializing on one timing
+// thread the way agent-internal periodic jobs do.
+class SyntheticPublisher : public owt_base::FrameSource {
+    DECLARE_LOGGER();
+
+public:
+    SyntheticPublisher(const std::string& codec, uint32_t width, uint32_t height,
+        uint32_t frameRate, uint32_t bitrateKbps, uint32_t keyFrameIntervalSeconds);
+    ~SyntheticPublisher();
+
+    void onFeedback(const owt_base::FeedbackMsg&) {}
+
+private:
+    void generateLoop();
+
+    owt_base::FrameFormat m_format;
+    bool m_isAudio;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_frameRate;
+    uint32_t m_bitrateKbps;
+    uint32_t m_keyFrameIntervalSeconds;
+
+    uint32_t m_seq;
+    uint32_t m_timeStamp;
+    boost::scoped_array<uint8_t> m_payload;
+    size_t m_payloadSize;
+
+    bool m_running;
+    boost::thread m_thread;
+};
+
+// Pass-through stage dropping a configured permille of frames, so subscriber
+// side numbers can be taken under emulated transport loss.
+class LossInjector : public owt_base::FrameSource, public owt_base::FrameDestination {
+public:
+    explicit LossInjector(uint32_t lossPermille)
+        : m_lossPermille(lossPermille)
+        , m_count(0)
+    {
+    }
+
+    void onFrame(const owt_base::Frame& frame)
+    {
+        // Deterministic spread instead of rand(): every run with the same
+        // config drops the same frames, so runs are comparable.
+        uint64_t n = m_count++;
+        if (((n * m_lossPermille) % 1000) + m_lossPermille > 1000)
+            return;
+        deliverFrame(frame);
+    }
+
+    void onFeedback(const owt_base::FeedbackMsg& msg) { deliverFeedbackMsg(msg); }
+
+private:
+    uint32_t m_lossPermille;
+    uint64_t m_count;
+};
+
+// Terminal stage standing in for a subscriber: counts frames/bytes and
+// records end-to-end latency from the timestamp SyntheticPublisher embeds
+// in the payload. getStats() reports rates over the window since the last
+// call, so a driver polling it periodically gets per-interval numbers.
+class StatsSubscriber : public owt_base::FrameDestination {
+public:
+    StatsSubscriber();
+
+    void onFrame(const owt_base::Frame& frame);
+
+    std::string getStats();
+
+private:
+    boost::mutex m_mutex;
+    uint64_t m_frames;
+    uint64_t m_bytes;
+    uint64_t m_keyFrames;
+    uint64_t m_windowStartUs;
+    owt_base::LatencyHistogram m_latency;
+};
+
+} /* namespace owt_load */
+
+#endif /* SyntheticStreams_h */
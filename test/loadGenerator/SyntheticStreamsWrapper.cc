@@ -0,0 +1,190 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BUILDING_NODE_EXTENSION
+#define BUILDING_NODE_EXTENSION
+#endif
+
+#include "SyntheticStreamsWrapper.h"
+
+using namespace v8;
+
+Persistent<Function> SyntheticPublisher::constructor;
+
+void SyntheticPublisher::Init(Local<Object> exports) {
+  Isolate* isolate = exports->GetIsolate();
+  Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+  tpl->SetClassName(String::NewFromUtf8(isolate, "SyntheticPublisher"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
+
+  constructor.Reset(isolate, tpl->GetFunction());
+  exports->Set(String::NewFromUtf8(isolate, "SyntheticPublisher"), tpl->GetFunction());
+}
+
+void SyntheticPublisher::New(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string codec = std::string(*param0);
+  uint32_t width = args[1]->Uint32Value();
+  uint32_t height = args[2]->Uint32Value();
+  uint32_t frameRate = args[3]->Uint32Value();
+  uint32_t bitrateKbps = args[4]->Uint32Value();
+  uint32_t keyFrameInterval = args[5]->Uint32Value();
+
+  SyntheticPublisher* obj = new SyntheticPublisher();
+  obj->me = new owt_load::SyntheticPublisher(codec, width, height, frameRate, bitrateKbps, keyFrameInterval);
+
+  obj->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+void SyntheticPublisher::close(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  SyntheticPublisher* obj = ObjectWrap::Unwrap<SyntheticPublisher>(args.Holder());
+  delete obj->me;
+  obj->me = nullptr;
+}
+
+void SyntheticPublisher::addDestination(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  SyntheticPublisher* obj = ObjectWrap::Unwrap<SyntheticPublisher>(args.Holder());
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string track = std::string(*param0);
+
+  FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject());
+  owt_base::FrameDestination* dest = param->dest;
+
+  if (track == "audio") {
+    obj->me->addAudioDestination(dest);
+  } else if (track == "video") {
+    obj->me->addVideoDestination(dest);
+  }
+}
+
+void SyntheticPublisher::removeDestination(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  SyntheticPublisher* obj = ObjectWrap::Unwrap<SyntheticPublisher>(args.Holder());
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string track = std::string(*param0);
+
+  FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject());
+  owt_base::FrameDestination* dest = param->dest;
+
+  if (track == "audio") {
+    obj->me->removeAudioDestination(dest);
+  } else if (track == "video") {
+    obj->me->removeVideoDestination(dest);
+  }
+}
+
+Persistent<Function> LossInjector::constructor;
+
+void LossInjector::Init(Local<Object> exports) {
+  Isolate* isolate = exports->GetIsolate();
+  Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+  tpl->SetClassName(String::NewFromUtf8(isolate, "LossInjector"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
+
+  constructor.Reset(isolate, tpl->GetFunction());
+  exports->Set(String::NewFromUtf8(isolate, "LossInjector"), tpl->GetFunction());
+}
+
+void LossInjector::New(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  uint32_t lossPermille = args[0]->Uint32Value();
+
+  LossInjector* obj = new LossInjector();
+  obj->me = new owt_load::LossInjector(lossPermille);
+  obj->dest = obj->me;
+
+  obj->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+void LossInjector::close(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  LossInjector* obj = ObjectWrap::Unwrap<LossInjector>(args.Holder());
+  delete obj->me;
+  obj->me = nullptr;
+  obj->dest = nullptr;
+}
+
+void LossInjector::addDestination(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  LossInjector* obj = ObjectWrap::Unwrap<LossInjector>(args.Holder());
+
+  String::Utf8Value param0(args[0]->ToString());
+  std::string track = std::string(*param0);
+
+  FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject());
+  owt_base::FrameDestination* dest = param->dest;
+
+  if (track == "audio") {
+    obj->me->addAudioDestination(dest);
+  } else if (track == "video") {
+    obj->me->addVideoDestination(dest);
+  }
+}
+
+Persistent<Function> StatsSubscriber::constructor;
+
+void StatsSubscriber::Init(Local<Object> exports) {
+  Isolate* isolate = exports->GetIsolate();
+  Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+  tpl->SetClassName(String::NewFromUtf8(isolate, "StatsSubscriber"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
+
+  constructor.Reset(isolate, tpl->GetFunction());
+  exports->Set(String::NewFromUtf8(isolate, "StatsSubscriber"), tpl->GetFunction());
+}
+
+void StatsSubscriber::New(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  StatsSubscriber* obj = new StatsSubscriber();
+  obj->me = new owt_load::StatsSubscriber();
+  obj->dest = obj->me;
+
+  obj->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+void StatsSubscriber::close(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  StatsSubscriber* obj = ObjectWrap::Unwrap<StatsSubscriber>(args.Holder());
+  delete obj->me;
+  obj->me = nullptr;
+  obj->dest = nullptr;
+}
+
+void StatsSubscriber::getStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  StatsSubscriber* obj = ObjectWrap::Unwrap<StatsSubscriber>(args.Holder());
+  std::string stats = obj->me->getStats();
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
@@ -0,0 +1,68 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SYNTHETICSTREAMSWRAPPER_H
+#define SYNTHETICSTREAMSWRAPPER_H
+
+#include "../../source/agent/addons/common/MediaFramePipelineWrapper.h"
+#include "SyntheticStreams.h"
+#include <node.h>
+#include <node_object_wrap.h>
+
+/*
+ * Wrapper class of owt_load::SyntheticPublisher
+ */
+class SyntheticPublisher : public node::ObjectWrap {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+  owt_load::SyntheticPublisher* me;
+
+ private:
+  SyntheticPublisher() {}
+  ~SyntheticPublisher() {}
+  static v8::Persistent<v8::Function> constructor;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void removeDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+};
+
+/*
+ * Wrapper class of owt_load::LossInjector
+ */
+class LossInjector : public FrameDestination {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+  owt_load::LossInjector* me;
+
+ private:
+  LossInjector() {}
+  ~LossInjector() {}
+  static v8::Persistent<v8::Function> constructor;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+};
+
+/*
+ * Wrapper class of owt_load::StatsSubscriber
+ */
+class StatsSubscriber : public FrameDestination {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+  owt_load::StatsSubscriber* me;
+
+ private:
+  StatsSubscriber() {}
+  ~StatsSubscriber() {}
+  static v8::Persistent<v8::Function> constructor;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+};
+
+#endif
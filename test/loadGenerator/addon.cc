@@ -0,0 +1,16 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SyntheticStreamsWrapper.h"
+#include <node.h>
+
+using namespace v8;
+
+void InitAll(Local<Object> exports) {
+  SyntheticPublisher::Init(exports);
+  LossInjector::Init(exports);
+  StatsSubscriber::Init(exports);
+}
+
+NODE_MODULE(addon, InitAll)
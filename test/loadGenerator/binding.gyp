@@ -0,0 +1,33 @@
+{
+  'targets': [{
+    'target_name': 'loadGenerator',
+    'sources': [
+      'addon.cc',
+      'SyntheticStreamsWrapper.cc',
+      'SyntheticStreams.cpp',
+      '../../source/core/owt_base/MediaFramePipeline.cpp',
+      '../../source/core/owt_base/PayloadBufferPool.cpp',
+    ],
+    'include_dirs': [
+      '../../source/core/common',
+      '../../source/core/owt_base',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-llog4cxx',
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions']
+      }],
+    ]
+  }]
+}
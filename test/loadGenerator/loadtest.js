@@ -0,0 +1,117 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Synthetic conference load driver: wires N SyntheticPublishers to M
+// StatsSubscribers (round-robin, optionally through a LossInjector) and
+// prints per-interval throughput and end-to-end latency per subscriber
+// group, so per-node stream ceilings can be established without a browser
+// farm. Build the addon first: node-gyp configure build
+//
+// Usage:
+//   node loadtest.js [--publishers N] [--subscribers M] [--codec vp8]
+//                    [--width 1280] [--height 720] [--fps 30]
+//                    [--bitrate 1000] [--keyInterval 2] [--loss 0]
+//                    [--duration 60] [--interval 5]
+//
+// codec is an owt frame format name: vp8, vp9, h264, h265, opus_48000_2...
+// loss is in permille, duration/interval in seconds.
+'use strict';
+
+var loadGen = require('./build/Release/loadGenerator');
+
+var options = {
+  publishers: 1,
+  subscribers: 1,
+  codec: 'vp8',
+  width: 1280,
+  height: 720,
+  fps: 30,
+  bitrate: 1000,
+  keyInterval: 2,
+  loss: 0,
+  duration: 60,
+  interval: 5
+};
+
+for (var i = 2; i < process.argv.length; i += 2) {
+  var key = process.argv[i].replace(/^--/, '');
+  if (!(key in options) || process.argv[i + 1] === undefined) {
+    console.error('Unknown option:', process.argv[i]);
+    process.exit(1);
+  }
+  options[key] = (key === 'codec') ? process.argv[i + 1] : Number(process.argv[i + 1]);
+}
+
+var track = options.codec.indexOf('vp') === 0 || options.codec.indexOf('h2') === 0 || options.codec.indexOf('av1') === 0 ? 'video' : 'audio';
+
+console.log('Load config:', JSON.stringify(options));
+
+var publishers = [];
+var subscribers = [];
+var injectors = [];
+
+for (var p = 0; p < options.publishers; p++) {
+  publishers.push(new loadGen.SyntheticPublisher(
+    options.codec, options.width, options.height, options.fps,
+    options.bitrate, options.keyInterval));
+}
+
+for (var s = 0; s < options.subscribers; s++) {
+  var sub = new loadGen.StatsSubscriber();
+  var pub = publishers[s % publishers.length];
+  if (options.loss > 0) {
+    var injector = new loadGen.LossInjector(options.loss);
+    pub.addDestination(track, injector);
+    injector.addDestination(track, sub);
+    injectors.push(injector);
+  } else {
+    pub.addDestination(track, sub);
+  }
+  subscribers.push(sub);
+}
+
+function aggregate() {
+  var total = {frames: 0, fps: 0, kbps: 0, latencyAvgUs: 0, worst: null};
+  subscribers.forEach(function(sub) {
+    var stats = JSON.parse(sub.getStats());
+    total.frames += stats.frames;
+    total.fps += stats.fps;
+    total.kbps += stats.kbps;
+    total.latencyAvgUs += stats.latency.avgUs;
+    if (!total.worst || stats.latency.avgUs > total.worst.latency.avgUs) {
+      total.worst = stats;
+    }
+  });
+  total.latencyAvgUs = Math.round(total.latencyAvgUs / subscribers.length);
+  return total;
+}
+
+var ticks = 0;
+var poller = setInterval(function() {
+  ticks++;
+  var total = aggregate();
+  console.log('[' + (ticks * options.interval) + 's]',
+      'fps(total):', total.fps,
+      'kbps(total):', total.kbps,
+      'latency(avg):', (total.latencyAvgUs / 1000).toFixed(2) + 'ms',
+      'worst-subscriber:', JSON.stringify(total.worst));
+
+  if (ticks * options.interval >= options.duration) {
+    clearInterval(poller);
+    shutdown();
+  }
+}, options.interval * 1000);
+
+function shutdown() {
+  publishers.forEach(function(pub) { pub.close(); });
+  injectors.forEach(function(injector) { injector.close(); });
+  subscribers.forEach(function(sub) { sub.close(); });
+  console.log('Done.');
+  process.exit(0);
+}
+
+process.on('SIGINT', function() {
+  clearInterval(poller);
+  shutdown();
+});